@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+#
+# ZeroDark.cloud
+#
+# Homepage      : https://www.zerodark.cloud
+# GitHub        : https://github.com/4th-ATechnologies/ZeroDark.cloud
+# Documentation : https://zerodarkcloud.readthedocs.io/en/latest/
+# API Reference : https://apis.zerodark.cloud
+#
+# Compiles frequency_lists.json (used by ZDCPasswordStrengthCalculator) into a compact binary file,
+# which the framework memory-maps & searches directly (see ZDCPackedDictionary).
+#
+# Only the compiled file ships with the framework (ZeroDark.cloud/Resources/frequency_lists.zdcdict).
+# The source JSON lives with the unit tests, which verify the compiled file against it.
+#
+# Re-run this script whenever frequency_lists.json changes, and check in the output:
+#
+#   Scripts/compile_frequency_lists.py
+#
+# File format (all integers are little-endian uint32 unless noted):
+#
+#   header:
+#     magic         : 8 bytes, "ZDCDICT\0"
+#     version       : 1
+#     dictCount
+#   dictionary table (dictCount entries):
+#     nameOffset    : offset of UTF-8 name (not NUL-terminated)
+#     nameLength
+#     wordCount
+#     maxWordLength : length (in UTF-8 bytes) of the longest word
+#     indexOffset   : offset of (wordCount + 1) uint32 word offsets
+#     ranksOffset   : offset of (wordCount) uint16 ranks
+#   data:
+#     Words are stored sorted (bytewise), each followed by a NUL byte.
+#     The index holds the offset of each word, plus a trailing sentinel,
+#     so the length of word[i] is (index[i+1] - index[i] - 1).
+#     The rank of word[i] is ranks[i] (1-based position within the original list).
+#
+# Ranks mirror the original NSDictionary-based loader exactly:
+# if a word appears more than once in a list, its last position wins.
+
+import json
+import os
+import struct
+import sys
+
+MAGIC = b'ZDCDICT\0'
+VERSION = 1
+
+def align(buf, alignment=4):
+	while len(buf) % alignment:
+		buf.append(0)
+
+def compile_lists(lists):
+	names = list(lists.keys())
+
+	header_size = len(MAGIC) + 8
+	table_size = len(names) * 24
+
+	data = bytearray()
+	table = []
+
+	base = header_size + table_size
+
+	for name in names:
+		ranks = {}
+		for i, word in enumerate(lists[name]):
+			ranks[word] = i + 1 # last occurrence wins
+
+		if len(ranks) > 0xFFFF or max(ranks.values(), default=0) > 0xFFFF:
+			raise ValueError('Dictionary too large for uint16 ranks: %s' % name)
+
+		words = sorted(ranks.keys(), key=lambda w: w.encode('utf-8'))
+
+		name_bytes = name.encode('utf-8')
+		name_offset = base + len(data)
+		data += name_bytes
+		align(data)
+
+		offsets = []
+		for word in words:
+			offsets.append(base + len(data))
+			data += word.encode('utf-8') + b'\0'
+		offsets.append(base + len(data)) # sentinel
+		align(data)
+
+		index_offset = base + len(data)
+		for offset in offsets:
+			data += struct.pack('<I', offset)
+
+		ranks_offset = base + len(data)
+		for word in words:
+			data += struct.pack('<H', ranks[word])
+		align(data)
+
+		max_length = max((len(w.encode('utf-8')) for w in words), default=0)
+
+		table.append((name_offset, len(name_bytes), len(words), max_length, index_offset, ranks_offset))
+
+	out = bytearray(MAGIC)
+	out += struct.pack('<II', VERSION, len(names))
+	for entry in table:
+		out += struct.pack('<IIIIII', *entry)
+	out += data
+	return bytes(out)
+
+def verify(blob, lists):
+	assert blob[:8] == MAGIC
+	version, count = struct.unpack_from('<II', blob, 8)
+	assert version == VERSION and count == len(lists)
+
+	for d in range(count):
+		name_offset, name_length, word_count, max_length, index_offset, ranks_offset = \
+			struct.unpack_from('<IIIIII', blob, 16 + d * 24)
+		name = blob[name_offset:name_offset + name_length].decode('utf-8')
+
+		expected = {}
+		for i, word in enumerate(lists[name]):
+			expected[word] = i + 1
+
+		actual = {}
+		for i in range(word_count):
+			start, end = struct.unpack_from('<II', blob, index_offset + i * 4)
+			word = blob[start:end - 1].decode('utf-8')
+			actual[word] = struct.unpack_from('<H', blob, ranks_offset + i * 2)[0]
+
+		assert actual == expected, 'Mismatch in dictionary: %s' % name
+
+def main():
+	root = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+
+	default_input = os.path.join(root, 'Testing', 'UnitTests', 'frequency_lists.json')
+	default_output = os.path.join(root, 'ZeroDark.cloud', 'Resources', 'frequency_lists.zdcdict')
+
+	input_path = sys.argv[1] if len(sys.argv) > 1 else default_input
+	output_path = sys.argv[2] if len(sys.argv) > 2 else default_output
+
+	with open(input_path, 'r', encoding='utf-8') as f:
+		lists = json.load(f)
+
+	blob = compile_lists(lists)
+	verify(blob, lists)
+
+	with open(output_path, 'wb') as f:
+		f.write(blob)
+
+	print('Wrote %s (%d bytes, %d dictionaries)' % (output_path, len(blob), len(lists)))
+
+if __name__ == '__main__':
+	main()
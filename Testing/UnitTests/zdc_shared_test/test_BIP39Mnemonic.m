@@ -185,4 +185,64 @@
 
 }
 
+- (void)test_matching
+{
+	for (NSString *language in [BIP39Mnemonic availableLanguages])
+	{
+		NSLocale *locale = [NSLocale localeWithLocaleIdentifier:language];
+
+		NSError *error = nil;
+		NSArray<NSString*> *wordList = [BIP39Mnemonic wordListForLanguageID:language error:&error];
+		XCTAssert(error == nil);
+		XCTAssert(wordList.count == 2048);
+
+		for (NSUInteger i = 0; i < wordList.count; i += 97)
+		{
+			NSString *word = wordList[i];
+
+			// Exact match
+			NSString *match = [BIP39Mnemonic matchingMnemonicForString:word languageID:language error:&error];
+			XCTAssert(error == nil);
+			XCTAssert([match isEqualToString:word]);
+
+			if (word.length <= 4) continue;
+
+			// Prefix match: should be the first word in the list with the same (folded) prefix
+			NSString *prefix = [[word substringToIndex:4] uppercaseStringWithLocale:locale];
+			NSString *folded = [prefix stringByFoldingWithOptions:(NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch)
+			                                                locale:locale];
+
+			NSUInteger expected = [wordList indexOfObjectPassingTest:^BOOL(NSString *entry, NSUInteger idx, BOOL *stop) {
+
+				NSString *test = [entry stringByFoldingWithOptions:(NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch)
+				                                            locale:locale];
+				return [test hasPrefix:folded];
+			}];
+
+			match = [BIP39Mnemonic matchingMnemonicForString:prefix languageID:language error:&error];
+			XCTAssert(error == nil);
+
+			if (expected == NSNotFound)
+				XCTAssert(match == nil);
+			else
+				XCTAssert([match isEqualToString:wordList[expected]]);
+		}
+
+		// Round trip (every valid entropy size)
+		for (NSUInteger length = 16; length <= 32; length += 4)
+		{
+			NSMutableData *data = [NSMutableData dataWithLength:length];
+			arc4random_buf(data.mutableBytes, length);
+
+			NSArray<NSString*> *mnemonic = [BIP39Mnemonic mnemonicFromData:data languageID:language error:&error];
+			XCTAssert(error == nil);
+			XCTAssert(mnemonic.count == (length * 8 + length / 4) / 11);
+
+			NSData *result = [BIP39Mnemonic dataFromMnemonic:mnemonic languageID:language error:&error];
+			XCTAssert(error == nil);
+			XCTAssert([result isEqual:data]);
+		}
+	}
+}
+
 @end
@@ -0,0 +1,405 @@
+/**
+ * ZeroDark.cloud
+ * <GitHub wiki link goes here>
+**/
+
+#import <XCTest/XCTest.h>
+
+#import "EthereumRPCPrivate.h"
+#import "NSData+AWSUtilities.h"
+#import "NSData+S4.h"
+
+static NSString *const kStubHost = @"zdc-ethereum-rpc.test";
+
+static NSString *const kEmptyMerkleTreeRoot = @"0000000000000000000000000000000000000000000000000000000000000000";
+
+/**
+ * A local JSON-RPC stub.
+ *
+ * Every eth_call in a batch is answered with a merkleTreeRoot derived from the queried userID:
+ * the 20 byte userID, followed by 12 zero bytes.
+ * Users registered via `failUserID:` are answered with a JSON-RPC error,
+ * and users registered via `emptyUserID:` are answered with the empty merkleTreeRoot.
+ */
+@interface EthereumRPCStubProtocol : NSURLProtocol
+
++ (void)reset;
++ (void)failUserID:(NSString *)userID;
++ (void)emptyUserID:(NSString *)userID;
+
+/** The number of eth_call's in each HTTP request received (in order). */
++ (NSArray<NSNumber *> *)batchSizes;
+
+@end
+
+@implementation EthereumRPCStubProtocol
+
+static NSMutableArray<NSNumber *> *stub_batchSizes = nil;
+static NSMutableSet<NSString *> *stub_failUserIDHexes = nil;
+static NSMutableSet<NSString *> *stub_emptyUserIDHexes = nil;
+
++ (void)reset
+{
+	@synchronized(self)
+	{
+		stub_batchSizes = [[NSMutableArray alloc] init];
+		stub_failUserIDHexes = [[NSMutableSet alloc] init];
+		stub_emptyUserIDHexes = [[NSMutableSet alloc] init];
+	}
+}
+
++ (void)failUserID:(NSString *)userID
+{
+	@synchronized(self) {
+		[stub_failUserIDHexes addObject:[[NSData dataFromZBase32String:userID] lowercaseHexString]];
+	}
+}
+
++ (void)emptyUserID:(NSString *)userID
+{
+	@synchronized(self) {
+		[stub_emptyUserIDHexes addObject:[[NSData dataFromZBase32String:userID] lowercaseHexString]];
+	}
+}
+
++ (NSArray<NSNumber *> *)batchSizes
+{
+	@synchronized(self) {
+		return [stub_batchSizes copy];
+	}
+}
+
++ (BOOL)canInitWithRequest:(NSURLRequest *)request
+{
+	return [request.URL.host isEqualToString:kStubHost];
+}
+
++ (NSURLRequest *)canonicalRequestForRequest:(NSURLRequest *)request
+{
+	return request;
+}
+
+/**
+ * NSURLSession moves the HTTPBody into a stream before handing the request to the protocol.
+ */
+- (NSData *)requestBody
+{
+	if (self.request.HTTPBody) {
+		return self.request.HTTPBody;
+	}
+	
+	NSInputStream *stream = self.request.HTTPBodyStream;
+	if (stream == nil) {
+		return nil;
+	}
+	
+	NSMutableData *body = [NSMutableData data];
+	uint8_t buffer[4096];
+	
+	[stream open];
+	NSInteger read;
+	while ((read = [stream read:buffer maxLength:sizeof(buffer)]) > 0) {
+		[body appendBytes:buffer length:read];
+	}
+	[stream close];
+	
+	return body;
+}
+
+- (void)startLoading
+{
+	NSArray<NSDictionary *> *calls = [NSJSONSerialization JSONObjectWithData:[self requestBody] options:0 error:nil];
+	NSMutableArray<NSDictionary *> *responses = [NSMutableArray arrayWithCapacity:calls.count];
+	
+	@synchronized([self class])
+	{
+		[stub_batchSizes addObject:@(calls.count)];
+		
+		for (NSDictionary *call in calls)
+		{
+			// data: 0x + functionSig (8) + userID (40) + padding (24)
+			
+			NSString *data = call[@"params"][0][@"data"];
+			NSString *userIDHex = [data substringWithRange:NSMakeRange(2 + 8, 40)];
+			
+			if ([stub_failUserIDHexes containsObject:userIDHex])
+			{
+				[responses addObject:@{
+					@"jsonrpc" : @"2.0",
+					@"id"      : call[@"id"],
+					@"error"   : @{ @"code": @(-32000), @"message": @"execution reverted" }
+				}];
+			}
+			else
+			{
+				NSString *result = [stub_emptyUserIDHexes containsObject:userIDHex]
+				  ? kEmptyMerkleTreeRoot
+				  : [userIDHex stringByAppendingString:@"000000000000000000000000"];
+				
+				[responses addObject:@{
+					@"jsonrpc" : @"2.0",
+					@"id"      : call[@"id"],
+					@"result"  : [@"0x" stringByAppendingString:result]
+				}];
+			}
+		}
+	}
+	
+	// JSON-RPC allows batch responses in any order
+	NSArray *reversed = [[responses reverseObjectEnumerator] allObjects];
+	NSData *body = [NSJSONSerialization dataWithJSONObject:reversed options:0 error:nil];
+	
+	NSHTTPURLResponse *response =
+	  [[NSHTTPURLResponse alloc] initWithURL: self.request.URL
+	                              statusCode: 200
+	                             HTTPVersion: @"HTTP/1.1"
+	                            headerFields: @{ @"Content-Type": @"application/json" }];
+	
+	[self.client URLProtocol:self didReceiveResponse:response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+	[self.client URLProtocol:self didLoadData:body];
+	[self.client URLProtocolDidFinishLoading:self];
+}
+
+- (void)stopLoading
+{
+	// Nothing to cancel
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Tests the batching & caching of EthereumRPC merkleTreeRoot queries, against a local JSON-RPC stub.
+ */
+@interface test_EthereumRPC : XCTestCase
+@end
+
+@implementation test_EthereumRPC {
+	
+	NSTimeInterval originalTTL;
+}
+
+- (void)setUp
+{
+	[super setUp];
+	
+	[EthereumRPCStubProtocol reset];
+	
+	NSURLSessionConfiguration *config = [NSURLSessionConfiguration ephemeralSessionConfiguration];
+	config.protocolClasses = @[ [EthereumRPCStubProtocol class] ];
+	
+	[EthereumRPC setSessionConfiguration:config];
+	[EthereumRPC setRPCURL:[NSURL URLWithString:[NSString stringWithFormat:@"https://%@/", kStubHost]]];
+	[EthereumRPC flushMerkleTreeRootCache];
+	
+	originalTTL = [EthereumRPC merkleTreeRootCacheTTL];
+}
+
+- (void)tearDown
+{
+	[EthereumRPC setMerkleTreeRootCacheTTL:originalTTL];
+	[EthereumRPC setRPCURL:nil];
+	[EthereumRPC setSessionConfiguration:nil];
+	
+	[super tearDown];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Utilities
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Returns a random (but valid) userID: 32 zBase32 characters.
+ */
+- (NSString *)randomUserID
+{
+	NSString *const alphabet = @"ybndrfg8ejkmcpqxot1uwisza345h769";
+	
+	NSMutableString *userID = [NSMutableString stringWithCapacity:32];
+	for (NSUInteger i = 0; i < 32; i++)
+	{
+		unichar c = [alphabet characterAtIndex:arc4random_uniform((uint32_t)alphabet.length)];
+		[userID appendFormat:@"%C", c];
+	}
+	
+	return userID;
+}
+
+- (NSString *)expectedMerkleTreeRootForUserID:(NSString *)userID
+{
+	NSString *userIDHex = [[NSData dataFromZBase32String:userID] lowercaseHexString];
+	return [userIDHex stringByAppendingString:@"000000000000000000000000"];
+}
+
+/**
+ * Fetches the merkleTreeRoot for each of the given userIDs (concurrently),
+ * and waits for all the completionBlocks.
+ */
+- (void)fetch:(NSArray<NSString *> *)userIDs
+   completion:(void (^)(NSString *userID, NSError *error, NSString *merkleTreeRoot))completion
+{
+	for (NSString *userID in userIDs)
+	{
+		XCTestExpectation *expectation = [self expectationWithDescription:userID];
+		
+		[EthereumRPC fetchMerkleTreeRootForUserID: userID
+		                          completionQueue: dispatch_get_main_queue()
+		                          completionBlock:^(NSError *error, NSString *merkleTreeRoot)
+		{
+			completion(userID, error, merkleTreeRoot);
+			[expectation fulfill];
+		}];
+	}
+	
+	[self waitForExpectationsWithTimeout:5.0 handler:nil];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_batching
+{
+	NSMutableArray<NSString *> *userIDs = [NSMutableArray array];
+	for (NSUInteger i = 0; i < 5; i++) {
+		[userIDs addObject:[self randomUserID]];
+	}
+	
+	[self fetch:userIDs completion:^(NSString *userID, NSError *error, NSString *merkleTreeRoot) {
+		
+		XCTAssertNil(error);
+		XCTAssertEqualObjects(merkleTreeRoot, [self expectedMerkleTreeRootForUserID:userID]);
+	}];
+	
+	XCTAssertEqualObjects([EthereumRPCStubProtocol batchSizes], @[ @5 ]);
+}
+
+- (void)test_maxBatchSize
+{
+	// Batches are capped at 32 queries
+	
+	NSMutableArray<NSString *> *userIDs = [NSMutableArray array];
+	for (NSUInteger i = 0; i < 40; i++) {
+		[userIDs addObject:[self randomUserID]];
+	}
+	
+	[self fetch:userIDs completion:^(NSString *userID, NSError *error, NSString *merkleTreeRoot) {
+		
+		XCTAssertNil(error);
+		XCTAssertEqualObjects(merkleTreeRoot, [self expectedMerkleTreeRootForUserID:userID]);
+	}];
+	
+	NSArray<NSNumber *> *batchSizes = [EthereumRPCStubProtocol batchSizes];
+	
+	XCTAssert(batchSizes.count == 2);
+	XCTAssertEqual([[batchSizes valueForKeyPath:@"@sum.self"] integerValue], 40);
+	XCTAssertEqual([[batchSizes valueForKeyPath:@"@max.self"] integerValue], 32);
+}
+
+- (void)test_coalescing
+{
+	// Concurrent queries for the same user share a single eth_call
+	
+	NSString *sharedUserID = [self randomUserID];
+	
+	[self fetch:@[ sharedUserID, sharedUserID, sharedUserID ] completion:^(NSString *userID, NSError *error, NSString *merkleTreeRoot) {
+		
+		XCTAssertNil(error);
+		XCTAssertEqualObjects(merkleTreeRoot, [self expectedMerkleTreeRootForUserID:userID]);
+	}];
+	
+	XCTAssertEqualObjects([EthereumRPCStubProtocol batchSizes], @[ @1 ]);
+}
+
+- (void)test_cache
+{
+	NSString *cachedUserID = [self randomUserID];
+	
+	void (^check)(NSString*, NSError*, NSString*) = ^(NSString *userID, NSError *error, NSString *merkleTreeRoot) {
+		
+		XCTAssertNil(error);
+		XCTAssertEqualObjects(merkleTreeRoot, [self expectedMerkleTreeRootForUserID:userID]);
+	};
+	
+	[self fetch:@[ cachedUserID ] completion:check];
+	XCTAssertEqualObjects([EthereumRPCStubProtocol batchSizes], @[ @1 ]);
+	
+	// Served from the cache
+	
+	[self fetch:@[ cachedUserID ] completion:check];
+	XCTAssertEqualObjects([EthereumRPCStubProtocol batchSizes], @[ @1 ]);
+	
+	// Flushing the cache requires a new query
+	
+	[EthereumRPC flushMerkleTreeRootCache];
+	
+	[self fetch:@[ cachedUserID ] completion:check];
+	XCTAssertEqualObjects([EthereumRPCStubProtocol batchSizes], (@[ @1, @1 ]));
+	
+	// As does disabling the cache
+	
+	[EthereumRPC setMerkleTreeRootCacheTTL:0];
+	
+	[self fetch:@[ cachedUserID ] completion:check];
+	[self fetch:@[ cachedUserID ] completion:check];
+	XCTAssertEqualObjects([EthereumRPCStubProtocol batchSizes], (@[ @1, @1, @1, @1 ]));
+}
+
+- (void)test_emptyMerkleTreeRoot
+{
+	// A user without a blockchain entry isn't an error, and the (missing) answer is cached.
+	
+	NSString *emptyUserID = [self randomUserID];
+	[EthereumRPCStubProtocol emptyUserID:emptyUserID];
+	
+	for (NSUInteger i = 0; i < 2; i++)
+	{
+		[self fetch:@[ emptyUserID ] completion:^(NSString *userID, NSError *error, NSString *merkleTreeRoot) {
+			
+			XCTAssertNil(error);
+			XCTAssertNil(merkleTreeRoot);
+		}];
+	}
+	
+	XCTAssertEqualObjects([EthereumRPCStubProtocol batchSizes], @[ @1 ]);
+}
+
+- (void)test_errorsNotCached
+{
+	// An error for one query doesn't affect the others in the same batch.
+	
+	NSString *goodUserID = [self randomUserID];
+	NSString *badUserID = [self randomUserID];
+	
+	[EthereumRPCStubProtocol failUserID:badUserID];
+	
+	[self fetch:@[ goodUserID, badUserID ] completion:^(NSString *userID, NSError *error, NSString *merkleTreeRoot) {
+		
+		if ([userID isEqualToString:badUserID])
+		{
+			XCTAssertNotNil(error);
+			XCTAssertNil(merkleTreeRoot);
+		}
+		else
+		{
+			XCTAssertNil(error);
+			XCTAssertEqualObjects(merkleTreeRoot, [self expectedMerkleTreeRootForUserID:userID]);
+		}
+	}];
+	
+	XCTAssertEqualObjects([EthereumRPCStubProtocol batchSizes], @[ @2 ]);
+	
+	// The good result is cached, the error isn't
+	
+	[self fetch:@[ goodUserID, badUserID ] completion:^(NSString *userID, NSError *error, NSString *merkleTreeRoot) {
+		
+		XCTAssert([userID isEqualToString:badUserID] == (error != nil));
+	}];
+	
+	XCTAssertEqualObjects([EthereumRPCStubProtocol batchSizes], (@[ @2, @1 ]));
+}
+
+@end
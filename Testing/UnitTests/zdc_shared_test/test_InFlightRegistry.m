@@ -0,0 +1,180 @@
+/**
+ * ZeroDark.cloud
+ * <GitHub wiki link goes here>
+**/
+
+#import <XCTest/XCTest.h>
+
+#import "ZDCInFlightRegistry.h"
+
+/**
+ * The PushManager registers every in-flight context under the (operationUUID, requestID) of its request.
+ * These tests check that entries for different requests of the same operation are kept apart,
+ * so the stale context of a previous request can't collide with the context of a retry.
+ */
+@interface test_InFlightRegistry : XCTestCase
+@end
+
+@implementation test_InFlightRegistry
+
+- (void)test_addRemove
+{
+	ZDCInFlightRegistry<NSObject *> *registry = [[ZDCInFlightRegistry alloc] init];
+	
+	NSUUID *opUUID = [NSUUID UUID];
+	NSString *requestID = opUUID.UUIDString;
+	NSObject *context = [[NSObject alloc] init];
+	
+	[registry addObject:context forOperationUUID:opUUID requestID:requestID];
+	[registry addObject:context forOperationUUID:opUUID requestID:requestID]; // no effect
+	
+	XCTAssertEqualObjects([registry objectsForOperationUUID:opUUID requestID:requestID], @[ context ]);
+	XCTAssertEqualObjects([registry objectsForOperationUUID:opUUID], @[ context ]);
+	
+	[registry removeObject:context forOperationUUID:opUUID requestID:requestID];
+	
+	XCTAssertEqual([registry objectsForOperationUUID:opUUID requestID:requestID].count, 0);
+	XCTAssertEqual([registry objectsForOperationUUID:opUUID].count, 0);
+}
+
+- (void)test_identity
+{
+	ZDCInFlightRegistry<NSString *> *registry = [[ZDCInFlightRegistry alloc] init];
+	
+	NSUUID *opUUID = [NSUUID UUID];
+	NSString *requestID = opUUID.UUIDString;
+	
+	// Equal, but not identical
+	NSString *context_a = [NSMutableString stringWithString:@"context"];
+	NSString *context_b = [NSMutableString stringWithString:@"context"];
+	
+	[registry addObject:context_a forOperationUUID:opUUID requestID:requestID];
+	[registry addObject:context_b forOperationUUID:opUUID requestID:requestID];
+	
+	XCTAssertEqual([registry objectsForOperationUUID:opUUID requestID:requestID].count, 2);
+	
+	[registry removeObject:context_a forOperationUUID:opUUID requestID:requestID];
+	
+	NSArray<NSString *> *remaining = [registry objectsForOperationUUID:opUUID requestID:requestID];
+	XCTAssertEqual(remaining.count, 1);
+	XCTAssertTrue(remaining.firstObject == context_b);
+}
+
+- (void)test_retry
+{
+	ZDCInFlightRegistry<NSObject *> *registry = [[ZDCInFlightRegistry alloc] init];
+	
+	NSUUID *opUUID = [NSUUID UUID];
+	NSString *requestID_1 = opUUID.UUIDString;
+	NSString *requestID_2 = [NSUUID UUID].UUIDString; // e.g. the postResolveUUID
+	
+	NSObject *staleContext = [[NSObject alloc] init];
+	NSObject *retryContext = [[NSObject alloc] init];
+	
+	[registry addObject:staleContext forOperationUUID:opUUID requestID:requestID_1];
+	[registry addObject:retryContext forOperationUUID:opUUID requestID:requestID_2];
+	
+	XCTAssertEqualObjects([registry objectsForOperationUUID:opUUID requestID:requestID_1], @[ staleContext ]);
+	XCTAssertEqualObjects([registry objectsForOperationUUID:opUUID requestID:requestID_2], @[ retryContext ]);
+	XCTAssertEqual([registry objectsForOperationUUID:opUUID].count, 2);
+	
+	// Removing an object under the wrong request has no effect
+	
+	[registry removeObject:retryContext forOperationUUID:opUUID requestID:requestID_1];
+	XCTAssertEqualObjects([registry objectsForOperationUUID:opUUID requestID:requestID_2], @[ retryContext ]);
+	
+	// The stale request completes, which doesn't affect the retry
+	
+	[registry removeObject:staleContext forOperationUUID:opUUID requestID:requestID_1];
+	
+	XCTAssertEqual([registry objectsForOperationUUID:opUUID requestID:requestID_1].count, 0);
+	XCTAssertEqualObjects([registry objectsForOperationUUID:opUUID requestID:requestID_2], @[ retryContext ]);
+	XCTAssertEqualObjects([registry objectsForOperationUUID:opUUID], @[ retryContext ]);
+}
+
+- (void)test_removeFromEveryRequest
+{
+	ZDCInFlightRegistry<NSObject *> *registry = [[ZDCInFlightRegistry alloc] init];
+	
+	NSUUID *opUUID = [NSUUID UUID];
+	NSString *requestID_1 = opUUID.UUIDString;
+	NSString *requestID_2 = [NSUUID UUID].UUIDString;
+	
+	NSObject *context = [[NSObject alloc] init];
+	NSObject *otherContext = [[NSObject alloc] init];
+	
+	[registry addObject:context forOperationUUID:opUUID requestID:requestID_1];
+	[registry addObject:context forOperationUUID:opUUID requestID:requestID_2];
+	[registry addObject:otherContext forOperationUUID:opUUID requestID:requestID_2];
+	
+	// A nil requestID removes the object from every request of the operation
+	
+	[registry removeObject:context forOperationUUID:opUUID requestID:nil];
+	
+	XCTAssertEqual([registry objectsForOperationUUID:opUUID requestID:requestID_1].count, 0);
+	XCTAssertEqualObjects([registry objectsForOperationUUID:opUUID requestID:requestID_2], @[ otherContext ]);
+}
+
+- (void)test_operationsAreIndependent
+{
+	// A single shard, so every operation shares the same table
+	ZDCInFlightRegistry<NSObject *> *registry = [[ZDCInFlightRegistry alloc] initWithShardCount:1];
+	
+	NSUUID *opUUID_a = [NSUUID UUID];
+	NSUUID *opUUID_b = [NSUUID UUID];
+	NSString *requestID = [NSUUID UUID].UUIDString; // same requestID for both (shouldn't happen, but still)
+	
+	NSObject *context_a = [[NSObject alloc] init];
+	NSObject *context_b = [[NSObject alloc] init];
+	
+	[registry addObject:context_a forOperationUUID:opUUID_a requestID:requestID];
+	[registry addObject:context_b forOperationUUID:opUUID_b requestID:requestID];
+	
+	[registry removeObject:context_a forOperationUUID:opUUID_a requestID:requestID];
+	
+	XCTAssertEqual([registry objectsForOperationUUID:opUUID_a].count, 0);
+	XCTAssertEqualObjects([registry objectsForOperationUUID:opUUID_b requestID:requestID], @[ context_b ]);
+}
+
+- (void)test_concurrency
+{
+	ZDCInFlightRegistry<NSObject *> *registry = [[ZDCInFlightRegistry alloc] init];
+	
+	NSUInteger const count = 1000;
+	
+	NSMutableArray<NSUUID *> *opUUIDs = [NSMutableArray arrayWithCapacity:count];
+	for (NSUInteger i = 0; i < count; i++) {
+		[opUUIDs addObject:[NSUUID UUID]];
+	}
+	
+	dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+	
+	// Every operation has an original request & a retry.
+	// The contexts of the original requests are removed, and those of the retries are kept.
+	
+	dispatch_apply(count, queue, ^(size_t i) {
+		
+		NSUUID *opUUID = opUUIDs[i];
+		NSString *requestID_1 = opUUID.UUIDString;
+		NSString *requestID_2 = [NSString stringWithFormat:@"%@:retry", opUUID.UUIDString];
+		
+		NSObject *staleContext = [[NSObject alloc] init];
+		NSObject *retryContext = [[NSObject alloc] init];
+		
+		[registry addObject:staleContext forOperationUUID:opUUID requestID:requestID_1];
+		[registry addObject:retryContext forOperationUUID:opUUID requestID:requestID_2];
+		[registry removeObject:staleContext forOperationUUID:opUUID requestID:requestID_1];
+	});
+	
+	for (NSUUID *opUUID in opUUIDs)
+	{
+		NSString *requestID_1 = opUUID.UUIDString;
+		NSString *requestID_2 = [NSString stringWithFormat:@"%@:retry", opUUID.UUIDString];
+		
+		XCTAssertEqual([registry objectsForOperationUUID:opUUID requestID:requestID_1].count, 0);
+		XCTAssertEqual([registry objectsForOperationUUID:opUUID requestID:requestID_2].count, 1);
+		XCTAssertEqual([registry objectsForOperationUUID:opUUID].count, 1);
+	}
+}
+
+@end
@@ -0,0 +1,308 @@
+/**
+ * ZeroDark.cloud
+ * <GitHub wiki link goes here>
+**/
+
+#import <XCTest/XCTest.h>
+
+#import <ZeroDarkCloud/ZeroDarkCloud.h>
+#import "ZDCLogging.h"
+
+/**
+ * Each expansion gets its own static site, just like the ZDCLog macros.
+ */
+#define TestLog(flg, frmt, ...)                                                                 \
+        do {                                                                                    \
+          static ZDCLogSite testLogSite = { __FILE__, __PRETTY_FUNCTION__, __LINE__, NULL };    \
+          ZDCLogEnqueue(&testLogSite, ZDCLogLevelAll, flg, (frmt), ## __VA_ARGS__);             \
+        } while(0)
+
+/**
+ * Logs the format & arguments, and asserts the delivered message matches [NSString stringWithFormat:].
+ */
+#define AssertLogFormat(frmt, ...)                                                              \
+        do {                                                                                    \
+          TestLog(ZDCLogFlagInfo, frmt, ## __VA_ARGS__);                                        \
+          ZDCLogFlush();                                                                        \
+          NSString *expected = [NSString stringWithFormat:frmt, ## __VA_ARGS__];                \
+          XCTAssertEqualObjects([self lastMessage], expected, @"format: %@", frmt);             \
+        } while(0)
+
+@interface test_LogBuffer_Object : NSObject
+@property (atomic, strong, readwrite) NSThread *describedOnThread;
+@property (atomic, copy, readwrite) NSString *value;
+@end
+
+@implementation test_LogBuffer_Object
+
+- (NSString *)description
+{
+	self.describedOnThread = [NSThread currentThread];
+	return self.value;
+}
+
+@end
+
+@interface test_LogBuffer : XCTestCase
+@end
+
+@implementation test_LogBuffer {
+	
+	NSMutableArray<ZDCLogMessage*> *messages; // only modified by the log handler
+}
+
+- (void)setUp
+{
+	[super setUp];
+	
+	messages = [[NSMutableArray alloc] init];
+	
+	__weak typeof(self) weakSelf = self;
+	[ZeroDarkCloud setLogHandler:^(ZDCLogMessage *logMessage) {
+		
+		__strong typeof(self) strongSelf = weakSelf;
+		if (strongSelf) {
+			[strongSelf->messages addObject:logMessage];
+		}
+	}];
+}
+
+- (void)tearDown
+{
+	ZDCLogFlush();
+	[ZeroDarkCloud setLogHandler:nil];
+	
+	[super tearDown];
+}
+
+- (NSString *)lastMessage
+{
+	return [messages lastObject].message;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Format Parsing
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_formatParsing_integers
+{
+	AssertLogFormat(@"plain text, no specs");
+	AssertLogFormat(@"%d %i %u", -42, 7, 42u);
+	AssertLogFormat(@"%x %X %o", 0xbeef, 0xBEEF, 8);
+	AssertLogFormat(@"%ld %lu", (long)-1234567890, (unsigned long)1234567890);
+	AssertLogFormat(@"%lld %llu %qd", (long long)INT64_MIN, (unsigned long long)UINT64_MAX, (long long)12);
+	AssertLogFormat(@"%zu %td %jd", (size_t)1024, (ptrdiff_t)-8, (intmax_t)99);
+	AssertLogFormat(@"%hhd %hd", (char)65, (short)-3);
+	AssertLogFormat(@"%c", 'z');
+}
+
+- (void)test_formatParsing_flagsWidthPrecision
+{
+	AssertLogFormat(@"[%5d] [%-5d] [%05d] [%+d] [% d]", 42, 42, 42, 42, 42);
+	AssertLogFormat(@"[%#x] [%#o]", 255, 8);
+	AssertLogFormat(@"[%.3f] [%10.2f] [%-10.2f]", 3.14159, 2.5, 2.5);
+	AssertLogFormat(@"[%*d] [%-*d]", 6, 42, 6, 42);
+	AssertLogFormat(@"[%.*f] [%*.*f]", 2, 3.14159, 8, 3, 3.14159);
+	AssertLogFormat(@"100%% done, %d%% left", 0);
+}
+
+- (void)test_formatParsing_floatingPoint
+{
+	AssertLogFormat(@"%f %F %e %E %g %G", 1.5, 2.5, 12345.678, 12345.678, 0.0001, 1e20);
+	AssertLogFormat(@"%a", 1.0);
+}
+
+- (void)test_formatParsing_pointersAndStrings
+{
+	int local = 0;
+	AssertLogFormat(@"%p", &local);
+	AssertLogFormat(@"%s %s", "utf8 string", __FUNCTION__);
+	AssertLogFormat(@"%@ %@", @"object", @(42));
+	AssertLogFormat(@"[%10s] [%-10@]", "abc", @"def");
+}
+
+- (void)test_formatParsing_nilArguments
+{
+	TestLog(ZDCLogFlagInfo, @"%@ - %s", nil, NULL);
+	ZDCLogFlush();
+	
+	XCTAssertEqualObjects([self lastMessage], @"(null) - (null)");
+}
+
+- (void)test_formatParsing_eager
+{
+	// These aren't supported by the deferred formatter, and fall back to being formatted immediately.
+	
+	AssertLogFormat(@"%2$@ %1$@", @"world", @"hello");
+	AssertLogFormat(@"%Lf", (long double)1.25);
+	AssertLogFormat(@"%lc", (wint_t)'w');
+	
+	// More args than a slot can hold
+	AssertLogFormat(@"%d %d %d %d %d %d %d %d %d", 1, 2, 3, 4, 5, 6, 7, 8, 9);
+}
+
+- (void)test_formatParsing_siteMetadata
+{
+	TestLog(ZDCLogFlagWarning, @"metadata"); NSUInteger line = __LINE__;
+	ZDCLogFlush();
+	
+	ZDCLogMessage *logMessage = [messages lastObject];
+	
+	XCTAssertEqualObjects(logMessage.message, @"metadata");
+	XCTAssertEqual(logMessage.flag, ZDCLogFlagWarning);
+	XCTAssertEqual(logMessage.line, line);
+	XCTAssertEqualObjects(logMessage.fileName, @"test_LogBuffer");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Argument Capture
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_argumentCapture_mutableString
+{
+	NSMutableString *str = [NSMutableString stringWithString:@"before"];
+	char cstr[] = "before";
+	
+	TestLog(ZDCLogFlagInfo, @"%@ %s", str, cstr);
+	
+	[str setString:@"after"];
+	strcpy(cstr, "after!");
+	
+	ZDCLogFlush();
+	XCTAssertEqualObjects([self lastMessage], @"before before");
+}
+
+- (void)test_argumentCapture_objectDescribedImmediately
+{
+	// Arbitrary objects may be mutated right after being logged,
+	// so they're described on the logging thread (not the drain queue).
+	
+	test_LogBuffer_Object *obj = [[test_LogBuffer_Object alloc] init];
+	obj.value = @"before";
+	
+	TestLog(ZDCLogFlagInfo, @"%@", obj);
+	
+	XCTAssertEqualObjects(obj.describedOnThread, [NSThread currentThread]);
+	obj.value = @"after";
+	
+	ZDCLogFlush();
+	XCTAssertEqualObjects([self lastMessage], @"before");
+}
+
+- (void)test_argumentCapture_mutableCollection
+{
+	NSMutableArray *array = [NSMutableArray arrayWithObject:@"before"];
+	NSMutableData *data = [NSMutableData dataWithBytes:"abc" length:3];
+	
+	NSString *expected = [NSString stringWithFormat:@"%@ %@", array, data];
+	
+	TestLog(ZDCLogFlagInfo, @"%@ %@", array, data);
+	
+	[array removeAllObjects];
+	[data setLength:0];
+	
+	ZDCLogFlush();
+	XCTAssertEqualObjects([self lastMessage], expected);
+}
+
+- (void)test_argumentCapture_objectNotRetained
+{
+	__weak test_LogBuffer_Object *weakObj = nil;
+	
+	@autoreleasepool {
+		
+		test_LogBuffer_Object *obj = [[test_LogBuffer_Object alloc] init];
+		obj.value = @"described";
+		weakObj = obj;
+		
+		TestLog(ZDCLogFlagInfo, @"%@", obj);
+	}
+	
+	// Only the description is buffered, not the object itself.
+	XCTAssertNil(weakObj);
+	
+	ZDCLogFlush();
+	XCTAssertEqualObjects([self lastMessage], @"described");
+}
+
+- (void)test_argumentCapture_immutableObjects
+{
+	NSUUID *uuid = [NSUUID UUID];
+	NSDate *date = [NSDate dateWithTimeIntervalSince1970:0];
+	
+	NSString *expected = [NSString stringWithFormat:@"%@ %@ %@", @(42), uuid, date];
+	
+	TestLog(ZDCLogFlagInfo, @"%@ %@ %@", @(42), uuid, date);
+	ZDCLogFlush();
+	
+	XCTAssertEqualObjects([self lastMessage], expected);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Delivery
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_ordering_warningsNeverDropped
+{
+	// More than fit in the ring.
+	// Warnings are never dropped, and must arrive in order.
+	
+	const NSUInteger count = 1000;
+	for (NSUInteger i = 0; i < count; i++)
+	{
+		TestLog(ZDCLogFlagWarning, @"%lu", (unsigned long)i);
+	}
+	
+	ZDCLogFlush();
+	
+	XCTAssertEqual(messages.count, count);
+	for (NSUInteger i = 0; i < MIN(messages.count, count); i++)
+	{
+		XCTAssertEqual([messages[i].message integerValue], (NSInteger)i);
+	}
+}
+
+- (void)test_flushFromLogHandler
+{
+	__block NSUInteger delivered = 0;
+	
+	[ZeroDarkCloud setLogHandler:^(ZDCLogMessage *logMessage) {
+		
+		// Must not deadlock
+		[ZeroDarkCloud flushLogs];
+		delivered++;
+	}];
+	
+	TestLog(ZDCLogFlagInfo, @"one");
+	TestLog(ZDCLogFlagInfo, @"two");
+	ZDCLogFlush();
+	
+	XCTAssertEqual(delivered, (NSUInteger)2);
+}
+
+- (void)test_deprecatedLogMethod
+{
+	// The legacy entry point goes through the same buffer, so ordering is preserved.
+	
+	TestLog(ZDCLogFlagInfo, @"first");
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+	
+	[ZeroDarkCloud log: ZDCLogLevelAll
+	              flag: ZDCLogFlagInfo
+	              file: __FILE__
+	          function: __FUNCTION__
+	              line: __LINE__
+	            format: @"%@", @"second"];
+
+#pragma clang diagnostic pop
+	
+	ZDCLogFlush();
+	
+	XCTAssertEqual(messages.count, (NSUInteger)2);
+	XCTAssertEqualObjects(messages.firstObject.message, @"first");
+	XCTAssertEqualObjects(messages.lastObject.message, @"second");
+}
+
+@end
@@ -50,4 +50,56 @@
 	}
 }
 
+- (void)testProof
+{
+	NSURL *merkleFilesURL = [[NSBundle bundleForClass:[self class]] URLForResource:@"Merkle Files" withExtension:nil];
+	
+	NSDirectoryEnumerator<NSURL *> *enumerator =
+	  [[NSFileManager defaultManager] enumeratorAtURL: merkleFilesURL
+	                       includingPropertiesForKeys: nil
+	                                          options: NSDirectoryEnumerationSkipsSubdirectoryDescendants
+	                                     errorHandler: nil];
+	
+	for (NSURL *fileURL in enumerator)
+	{
+		NSData *fileData = [NSData dataWithContentsOfURL:fileURL];
+		NSDictionary *fileDict = [NSJSONSerialization JSONObjectWithData:fileData options:0 error:nil];
+		
+		NSError *error = nil;
+		ZDCMerkleTree *merkleTree = [ZDCMerkleTree parseFile:fileDict error:&error];
+		
+		XCTAssert(merkleTree != nil, @"Error parsing fileDict: %@", error);
+		
+		for (NSString *userID in [merkleTree userIDs])
+		{
+			BOOL success = [merkleTree verifyProofForUserID:userID error:&error];
+			
+			XCTAssert(success, @"Error verifying proof: %@: %@: %@", [fileURL lastPathComponent], userID, error);
+		}
+		
+		XCTAssert(![merkleTree verifyProofForUserID:@"not_a_user" error:nil]);
+		
+		// Tamper with a value, and make sure it's detected.
+		
+		NSMutableDictionary *tamperedDict = [fileDict mutableCopy];
+		NSMutableArray *values = [fileDict[@"values"] mutableCopy];
+		values[0] = [values[0] stringByAppendingString:@" "];
+		tamperedDict[@"values"] = values;
+		
+		ZDCMerkleTree *tamperedTree = [ZDCMerkleTree parseFile:tamperedDict error:nil];
+		
+		XCTAssert(![tamperedTree hashAndVerify:nil], @"Tampering not detected: %@", [fileURL lastPathComponent]);
+		
+		for (NSString *userID in [tamperedTree userIDs])
+		{
+			NSUInteger idx = [fileDict[@"lookup"][userID] unsignedIntegerValue];
+			if (idx == 0)
+			{
+				XCTAssert(![tamperedTree verifyProofForUserID:userID error:nil],
+				          @"Tampering not detected: %@: %@", [fileURL lastPathComponent], userID);
+			}
+		}
+	}
+}
+
 @end
@@ -6,8 +6,63 @@
 #import <XCTest/XCTest.h>
 
 #import "ZDCNode.h"
+#import "ZDCNodePrivate.h"
 #import "ZDCShareList.h"
 #import "ZDCShareItem.h"
+#import "ZDCCompactCoder.h"
+#import "ZDCCloudDataManifest.h"
+#import "ZDCChangeList.h"
+#import "ZDCCloudOperation.h"
+
+/**
+ * Encodes a string, but decodes expecting a number.
+ * (Uses the ZDC prefix so the compact coder encodes it inline.)
+ */
+@interface ZDCTest_ClassMismatch : NSObject <NSCoding>
+@end
+
+@implementation ZDCTest_ClassMismatch
+
+- (id)initWithCoder:(NSCoder *)decoder
+{
+	if ((self = [super init]))
+	{
+		(void)[decoder decodeObjectOfClass:[NSNumber class] forKey:@"value"];
+	}
+	return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder
+{
+	[coder encodeObject:@"not a number" forKey:@"value"];
+}
+
+@end
+
+/**
+ * Substitutes itself when archived.
+ */
+@interface ZDCTest_Replaced : NSObject <NSCoding>
+@end
+
+@implementation ZDCTest_Replaced
+
+- (id)initWithCoder:(NSCoder *)decoder
+{
+	return [super init];
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder
+{
+	// Nothing to encode
+}
+
+- (id)replacementObjectForKeyedArchiver:(NSKeyedArchiver *)archiver
+{
+	return @"replaced";
+}
+
+@end
 
 @interface test_Models : XCTestCase
 @end
@@ -681,4 +736,319 @@ static NSString *const userC = @"jag15iacxneuco7owmegke63msbgyuyx";
 	XCTAssert([_itemB.key isEqual:newKey_remote] == YES);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Compact Coder
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (ZDCNode *)sampleNode
+{
+	ZDCNode *node = [[ZDCNode alloc] initWithLocalUserID:userA];
+	node.parentID = [[NSUUID UUID] UUIDString];
+	node.name = @"Sample Document.pdf";
+	node.senderID = userB;
+	node.pendingRecipients = [NSSet setWithObjects:userB, userC, nil];
+	node.cloudID = @"0123456789abcdef0123456789abcdef";
+	node.eTag_rcrd = @"2d7d6ad3a1b4c5e6f708192a3b4c5d6e";
+	node.eTag_data = @"9f8e7d6c5b4a39281706f5e4d3c2b1a0";
+	node.lastModified_rcrd = [NSDate dateWithTimeIntervalSinceReferenceDate:600000000.25];
+	node.lastModified_data = [NSDate dateWithTimeIntervalSinceReferenceDate:600000001.5];
+	node.explicitCloudName = @"bsjx7wqg3hmjkzpbwc5yxj54ctd1dfsw";
+	
+	ZDCShareList *shareList = [[ZDCShareList alloc] initWithDictionary:[self sampleKeysDict]];
+	[node.shareList mergeCloudVersion:shareList withPendingChangesets:nil error:nil];
+	
+	[node clearChangeTracking];
+	return node;
+}
+
+- (void)test_compactCoder_roundTrip
+{
+	ZDCNode *node = [self sampleNode];
+	
+	NSData *data = [ZDCCompactCoder archivedDataWithRootObject:node];
+	
+	XCTAssert(data != nil);
+	XCTAssert([ZDCCompactCoder isCompactData:data]);
+	
+	ZDCNode *decoded = [ZDCCompactCoder unarchiveObjectWithData:data];
+	
+	XCTAssert([decoded isKindOfClass:[ZDCNode class]]);
+	
+	XCTAssert([decoded.uuid isEqualToString:node.uuid]);
+	XCTAssert([decoded.localUserID isEqualToString:node.localUserID]);
+	XCTAssert([decoded.parentID isEqualToString:node.parentID]);
+	XCTAssert([decoded.name isEqualToString:node.name]);
+	XCTAssert([decoded.senderID isEqualToString:node.senderID]);
+	XCTAssert([decoded.pendingRecipients isEqualToSet:node.pendingRecipients]);
+	XCTAssert([decoded.encryptionKey isEqualToData:node.encryptionKey]);
+	XCTAssert([decoded.dirSalt isEqualToData:node.dirSalt]);
+	XCTAssert([decoded.dirPrefix isEqualToString:node.dirPrefix]);
+	XCTAssert([decoded.cloudID isEqualToString:node.cloudID]);
+	XCTAssert([decoded.eTag_rcrd isEqualToString:node.eTag_rcrd]);
+	XCTAssert([decoded.eTag_data isEqualToString:node.eTag_data]);
+	XCTAssert([decoded.lastModified_rcrd isEqualToDate:node.lastModified_rcrd]);
+	XCTAssert([decoded.lastModified_data isEqualToDate:node.lastModified_data]);
+	XCTAssert([decoded.explicitCloudName isEqualToString:node.explicitCloudName]);
+	
+	XCTAssert([decoded.shareList.rawDictionary isEqualToDictionary:node.shareList.rawDictionary]);
+	
+	ZDCShareItem *itemA = [decoded.shareList shareItemForUserID:userA];
+	XCTAssert([itemA hasPermission:ZDCSharePermission_Write]);
+}
+
+- (void)test_compactCoder_legacyData
+{
+	ZDCNode *node = [self sampleNode];
+	
+	NSData *keyed = [NSKeyedArchiver archivedDataWithRootObject:node];
+	
+	XCTAssert([ZDCCompactCoder isCompactData:keyed] == NO);
+	XCTAssert([ZDCCompactCoder unarchiveObjectWithData:keyed] == nil);
+	
+	NSData *compact = [ZDCCompactCoder archivedDataWithRootObject:node];
+	NSData *truncated = [compact subdataWithRange:NSMakeRange(0, compact.length / 2)];
+	
+	XCTAssert([ZDCCompactCoder unarchiveObjectWithData:truncated] == nil);
+}
+
+- (void)test_compactCoder_cloudOperation
+{
+	ZDCCloudPath *cloudPath =
+	  [[ZDCCloudPath alloc] initWithTreeID: @"com.4th-a.ZeroDarkTodo"
+	                             dirPrefix: @"00000000000000000000000000000000"
+	                              fileName: @"bsjx7wqg3hmjkzpbwc5yxj54ctd1dfsw"];
+	
+	ZDCCloudLocator *cloudLocator =
+	  [[ZDCCloudLocator alloc] initWithRegion: AWSRegion_US_West_2
+	                                   bucket: @"com.4th-a.user.z55tqmfr9kix1p1gntotqpwkacpuoyno-3f3a4d6c"
+	                                cloudPath: cloudPath];
+	
+	ZDCCloudOperation *op =
+	  [[ZDCCloudOperation alloc] initWithLocalUserID: userA
+	                                          treeID: @"com.4th-a.ZeroDarkTodo"
+	                                         putType: ZDCCloudOperationPutType_Node_Rcrd];
+	
+	op.nodeID = [[NSUUID UUID] UUIDString];
+	op.cloudLocator = cloudLocator;
+	op.eTag = @"2d7d6ad3a1b4c5e6f708192a3b4c5d6e";
+	op.priority = 42;
+	op.dependencies = [NSSet setWithObject:[NSUUID UUID]];
+	
+	NSData *data = [ZDCCompactCoder archivedDataWithRootObject:op];
+	
+	XCTAssert(data != nil);
+	XCTAssert([ZDCCompactCoder isCompactData:data]);
+	
+	ZDCCloudOperation *decoded = [ZDCCompactCoder unarchiveObjectWithData:data];
+	
+	XCTAssert([decoded isKindOfClass:[ZDCCloudOperation class]]);
+	
+	XCTAssert([decoded.uuid isEqual:op.uuid]);
+	XCTAssert([decoded.localUserID isEqualToString:op.localUserID]);
+	XCTAssert([decoded.treeID isEqualToString:op.treeID]);
+	XCTAssert(decoded.type == op.type);
+	XCTAssert(decoded.putType == op.putType);
+	XCTAssert([decoded.nodeID isEqualToString:op.nodeID]);
+	XCTAssert([decoded.cloudLocator isEqualToCloudLocator:op.cloudLocator]);
+	XCTAssert([decoded.eTag isEqualToString:op.eTag]);
+	XCTAssert(decoded.priority == op.priority);
+	XCTAssert([decoded.dependencies isEqualToSet:op.dependencies]);
+}
+
+- (void)test_compactCoder_classMismatch
+{
+	// A value that doesn't match `decodeObjectOfClass:forKey:` fails the whole decode,
+	// rather than silently handing back a partially decoded object.
+	
+	NSData *data = [ZDCCompactCoder archivedDataWithRootObject:[[ZDCTest_ClassMismatch alloc] init]];
+	
+	XCTAssert(data != nil);
+	XCTAssert([ZDCCompactCoder unarchiveObjectWithData:data] == nil);
+}
+
+- (void)test_compactCoder_replacement
+{
+	// Same as NSKeyedArchiver, `replacementObjectForKeyedArchiver:` is honored.
+	
+	NSData *data = [ZDCCompactCoder archivedDataWithRootObject:[[ZDCTest_Replaced alloc] init]];
+	id decoded = [ZDCCompactCoder unarchiveObjectWithData:data];
+	
+	XCTAssertEqualObjects(decoded, @"replaced");
+}
+
+- (void)test_compactCoder_benchmark_size
+{
+	ZDCNode *node = [self sampleNode];
+	
+	NSData *keyed = [NSKeyedArchiver archivedDataWithRootObject:node];
+	NSData *compact = [ZDCCompactCoder archivedDataWithRootObject:node];
+	
+	XCTAssert(compact.length < keyed.length,
+	          @"keyed(%lu) compact(%lu)", (unsigned long)keyed.length, (unsigned long)compact.length);
+}
+
+- (void)test_compactCoder_benchmark_encode
+{
+	ZDCNode *node = [self sampleNode];
+	
+	[self measureBlock:^{
+		
+		for (NSUInteger i = 0; i < 1000; i++) { @autoreleasepool {
+			
+			(void)[ZDCCompactCoder archivedDataWithRootObject:node];
+		}}
+	}];
+}
+
+- (void)test_compactCoder_benchmark_decode
+{
+	NSData *data = [ZDCCompactCoder archivedDataWithRootObject:[self sampleNode]];
+	
+	[self measureBlock:^{
+		
+		for (NSUInteger i = 0; i < 1000; i++) { @autoreleasepool {
+			
+			(void)[ZDCCompactCoder unarchiveObjectWithData:data];
+		}}
+	}];
+}
+
+- (void)test_keyedArchiver_benchmark_encode
+{
+	ZDCNode *node = [self sampleNode];
+	
+	[self measureBlock:^{
+		
+		for (NSUInteger i = 0; i < 1000; i++) { @autoreleasepool {
+			
+			(void)[NSKeyedArchiver archivedDataWithRootObject:node];
+		}}
+	}];
+}
+
+- (void)test_keyedArchiver_benchmark_decode
+{
+	NSData *data = [NSKeyedArchiver archivedDataWithRootObject:[self sampleNode]];
+	
+	[self measureBlock:^{
+		
+		for (NSUInteger i = 0; i < 1000; i++) { @autoreleasepool {
+			
+			(void)[NSKeyedUnarchiver unarchiveObjectWithData:data];
+		}}
+	}];
+}
+
+- (void)test_cloudDataManifest
+{
+	uint64_t chunkSize = (1024 * 1024 * 5);
+	
+	NSDictionary<NSNumber*, NSString*> *oldChecksums = @{
+		@(0): @"aaaa",
+		@(1): @"bbbb",
+		@(2): @"cccc",
+		@(3): @"dddd"
+	};
+	
+	ZDCCloudDataManifest *manifest =
+	  [[ZDCCloudDataManifest alloc] initWithNodeID: @"node"
+	                                          eTag: @"e6d4760605217f69a35b0dcf960ca9e3"
+	                                 cloudFileSize: (chunkSize * 3) + 1024
+	                                     chunkSize: chunkSize
+	                                     checksums: oldChecksums];
+	
+	// Header changed (part 0), middle unchanged, last part grew (appended data)
+	
+	NSDictionary<NSNumber*, NSString*> *newChecksums = @{
+		@(0): @"0000",
+		@(1): @"bbbb",
+		@(2): @"cccc",
+		@(3): @"eeee",
+		@(4): @"ffff"
+	};
+	
+	NSIndexSet *reusable = [manifest reusablePartsWithChunkSize:chunkSize checksums:newChecksums];
+	
+	XCTAssert(reusable.count == 2);
+	XCTAssert([reusable containsIndex:1]);
+	XCTAssert([reusable containsIndex:2]);
+	
+	// Different chunkSize means the parts don't line up
+	
+	reusable = [manifest reusablePartsWithChunkSize:(chunkSize * 2) checksums:oldChecksums];
+	XCTAssert(reusable.count == 0);
+	
+	// NSCoding
+	
+	NSData *data = [NSKeyedArchiver archivedDataWithRootObject:manifest];
+	ZDCCloudDataManifest *decoded = [NSKeyedUnarchiver unarchiveObjectWithData:data];
+	
+	XCTAssert([decoded.nodeID isEqualToString:manifest.nodeID]);
+	XCTAssert([decoded.eTag isEqualToString:manifest.eTag]);
+	XCTAssert(decoded.cloudFileSize == manifest.cloudFileSize);
+	XCTAssert(decoded.chunkSize == manifest.chunkSize);
+	XCTAssert([decoded.checksums isEqualToDictionary:oldChecksums]);
+}
+
+- (ZDCChangeItem *)changeWithID:(NSString *)changeID fileID:(NSString *)fileID path:(NSString *)path eTag:(NSString *)eTag
+{
+	return [ZDCChangeItem parseChangeInfo:@{
+		@"id"     : changeID,
+		@"command": @"put-if-match",
+		@"fileID" : fileID,
+		@"path"   : path,
+		@"eTag"   : eTag
+	}];
+}
+
+- (void)test_changeList_coalescing
+{
+	NSArray<ZDCChangeItem *> *changes = @[
+		[self changeWithID:@"c1" fileID:@"fileA" path:@"app/a.rcrd" eTag:@"e1"],
+		[self changeWithID:@"c2" fileID:@"fileB" path:@"app/b.rcrd" eTag:@"e2"],
+		[self changeWithID:@"c3" fileID:@"fileA" path:@"app/a.rcrd" eTag:@"e3"],
+		[self changeWithID:@"c4" fileID:@"fileA" path:@"app/a.data" eTag:@"e4"]
+	];
+	
+	ZDCChangeList *changeList = [[ZDCChangeList alloc] initWithLatestChangeID_remote:@"c0"];
+	[changeList didCompleteFullPull];
+	[changeList didFetchChanges:changes since:@"c0" latest:@"c4"];
+	
+	// put-if-match + put-if-match (same fileID & path) => merged
+	
+	NSOrderedSet<NSString *> *changeIDs = nil;
+	ZDCChangeItem *change = [changeList popNextPendingChange:&changeIDs];
+	
+	XCTAssert([change.uuid isEqualToString:@"c1"]);
+	XCTAssert([change.eTag isEqualToString:@"e3"]);
+	XCTAssert([changeIDs isEqualToOrderedSet:[NSOrderedSet orderedSetWithArray:@[ @"c1", @"c3" ]]]);
+	
+	[changeList didProcessChangeIDs:[changeIDs set]];
+	XCTAssert([changeList.latestChangeID_local isEqualToString:@"c1"]);
+	
+	// NSCoding (c3 was processed out-of-order, and must survive the round trip)
+	
+	NSData *data = [NSKeyedArchiver archivedDataWithRootObject:changeList];
+	ZDCChangeList *decoded = [NSKeyedUnarchiver unarchiveObjectWithData:data];
+	
+	for (ZDCChangeList *list in @[ changeList, decoded ])
+	{
+		ZDCChangeList *copy = [list copy];
+		
+		change = [copy popNextPendingChange:&changeIDs];
+		XCTAssert([change.uuid isEqualToString:@"c2"]);
+		XCTAssert(changeIDs.count == 1);
+		
+		[copy didProcessChangeIDs:[changeIDs set]];
+		XCTAssert([copy.latestChangeID_local isEqualToString:@"c3"]);
+		
+		change = [copy popNextPendingChange:&changeIDs];
+		XCTAssert([change.uuid isEqualToString:@"c4"]);
+		
+		[copy didProcessChangeIDs:[changeIDs set]];
+		XCTAssert([copy.latestChangeID_local isEqualToString:@"c4"]);
+		XCTAssert(![copy hasPendingChange]);
+	}
+}
+
 @end
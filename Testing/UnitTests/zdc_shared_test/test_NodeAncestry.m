@@ -0,0 +1,271 @@
+/**
+ * ZeroDark.cloud
+ * <GitHub wiki link goes here>
+**/
+
+#import <XCTest/XCTest.h>
+
+#import <ZeroDarkCloud/ZeroDarkCloud.h>
+#import <YapDatabase/YapDatabase.h>
+#import <YapDatabase/YapDatabaseHooks.h>
+
+#import "ZDCDatabaseManagerPrivate.h"
+#import "ZDCTrunkNodePrivate.h"
+
+/**
+ * The NodeManager caches the ancestry of nodes (path components, parentIDs & trunk).
+ * These tests check that the cached ancestry is invalidated when an ancestor is renamed, moved or deleted,
+ * both within the read-write transaction (via the hooks extension) and after the commit (via the snapshot change).
+ *
+ * The tree used by every test:
+ *
+ * home
+ * ├── a
+ * │   └── b
+ * │       └── leaf
+ * └── c
+ */
+@interface test_NodeAncestry : XCTestCase
+@end
+
+@implementation test_NodeAncestry {
+	
+	NSURL *databaseURL;
+	YapDatabase *database;
+	YapDatabaseConnection *rwConnection;
+	YapDatabaseConnection *roConnection;
+	
+	ZDCTrunkNode *home;
+	ZDCNode *a;
+	ZDCNode *b;
+	ZDCNode *c;
+	ZDCNode *leaf;
+}
+
+- (void)setUp
+{
+	[super setUp];
+	
+	// Make sure the NodeManager is observing YapDatabaseModifiedNotification before the database exists.
+	[ZDCNodeManager sharedInstance];
+	
+	NSString *fileName = [NSString stringWithFormat:@"test_NodeAncestry-%@.sqlite", [[NSUUID UUID] UUIDString]];
+	databaseURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+	
+	database = [[YapDatabase alloc] initWithURL:databaseURL];
+	XCTAssert([database registerExtension:[ZDCDatabaseManager hooksExtension] withName:Ext_Hooks]);
+	
+	rwConnection = [database newConnection];
+	roConnection = [database newConnection];
+	
+	NSString *localUserID = @"z55tqmfr9kix1p1gntotqpwkacpuoyno";
+	
+	home = [[ZDCTrunkNode alloc] initWithLocalUserID: localUserID
+	                                          treeID: @"com.4th-a.unittests"
+	                                           trunk: ZDCTreesystemTrunk_Home];
+	
+	a    = [self nodeWithName:@"a"    parent:home localUserID:localUserID];
+	b    = [self nodeWithName:@"b"    parent:a    localUserID:localUserID];
+	c    = [self nodeWithName:@"c"    parent:home localUserID:localUserID];
+	leaf = [self nodeWithName:@"leaf" parent:b    localUserID:localUserID];
+	
+	[self commit:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		for (ZDCNode *node in @[ home, a, b, c, leaf ]) {
+			[transaction setObject:node forKey:node.uuid inCollection:kZDCCollection_Nodes];
+		}
+	}];
+	
+	// Warm up the cache
+	
+	[roConnection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		[self assertPath:@[ @"a", @"b", @"leaf" ] trunk:ZDCTreesystemTrunk_Home transaction:transaction];
+		[self assertParentIDs:@[ home.uuid, a.uuid, b.uuid ] transaction:transaction];
+	}];
+}
+
+- (void)tearDown
+{
+	rwConnection = nil;
+	roConnection = nil;
+	database = nil;
+	
+	NSString *path = databaseURL.path;
+	for (NSString *suffix in @[ @"", @"-wal", @"-shm" ])
+	{
+		[[NSFileManager defaultManager] removeItemAtPath:[path stringByAppendingString:suffix] error:nil];
+	}
+	
+	[super tearDown];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Utilities
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (ZDCNode *)nodeWithName:(NSString *)name parent:(ZDCNode *)parent localUserID:(NSString *)localUserID
+{
+	ZDCNode *node = [[ZDCNode alloc] initWithLocalUserID:localUserID];
+	node.name = name;
+	node.parentID = parent.uuid;
+	
+	return node;
+}
+
+/**
+ * Executes the read-write transaction,
+ * and then waits for the NodeManager to receive the corresponding YapDatabaseModifiedNotification.
+ */
+- (void)commit:(void (^)(YapDatabaseReadWriteTransaction *transaction))block
+{
+	[rwConnection readWriteWithBlock:block];
+	
+	uint64_t snapshot = rwConnection.snapshot;
+	
+	[self expectationForNotification: YapDatabaseModifiedNotification
+	                          object: database
+	                         handler:^BOOL(NSNotification *notification)
+	{
+		return [notification.userInfo[YapDatabaseSnapshotKey] unsignedLongLongValue] >= snapshot;
+	}];
+	
+	[self waitForExpectationsWithTimeout:5.0 handler:nil];
+}
+
+- (void)assertPath:(NSArray<NSString *> *)pathComponents
+             trunk:(ZDCTreesystemTrunk)trunk
+       transaction:(YapDatabaseReadTransaction *)transaction
+{
+	ZDCTreesystemPath *path = [[ZDCNodeManager sharedInstance] pathForNode:leaf transaction:transaction];
+	
+	XCTAssertEqualObjects(path.pathComponents, pathComponents);
+	XCTAssert(path.trunk == trunk);
+}
+
+- (void)assertParentIDs:(NSArray<NSString *> *)parentIDs transaction:(YapDatabaseReadTransaction *)transaction
+{
+	NSArray<NSString *> *result = [[ZDCNodeManager sharedInstance] parentNodeIDsForNode:leaf transaction:transaction];
+	
+	XCTAssertEqualObjects(result, parentIDs);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_renameAncestor
+{
+	[self commit:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		ZDCNode *renamed = [[transaction objectForKey:a.uuid inCollection:kZDCCollection_Nodes] copy];
+		renamed.name = @"a2";
+		[transaction setObject:renamed forKey:renamed.uuid inCollection:kZDCCollection_Nodes];
+		
+		// Uncommitted change: reported via the hooks extension
+		[self assertPath:@[ @"a2", @"b", @"leaf" ] trunk:ZDCTreesystemTrunk_Home transaction:transaction];
+	}];
+	
+	// Committed change: reported via YapDatabaseModifiedNotification
+	[roConnection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		[self assertPath:@[ @"a2", @"b", @"leaf" ] trunk:ZDCTreesystemTrunk_Home transaction:transaction];
+	}];
+}
+
+- (void)test_moveAncestor
+{
+	[self commit:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		ZDCNode *moved = [[transaction objectForKey:b.uuid inCollection:kZDCCollection_Nodes] copy];
+		moved.parentID = c.uuid;
+		[transaction setObject:moved forKey:moved.uuid inCollection:kZDCCollection_Nodes];
+		
+		[self assertPath:@[ @"c", @"b", @"leaf" ] trunk:ZDCTreesystemTrunk_Home transaction:transaction];
+		[self assertParentIDs:@[ home.uuid, c.uuid, b.uuid ] transaction:transaction];
+		
+		XCTAssertFalse([[ZDCNodeManager sharedInstance] isNode:leaf.uuid aDescendantOf:a.uuid transaction:transaction]);
+		XCTAssertTrue([[ZDCNodeManager sharedInstance] isNode:leaf.uuid aDescendantOf:c.uuid transaction:transaction]);
+	}];
+	
+	[roConnection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		[self assertPath:@[ @"c", @"b", @"leaf" ] trunk:ZDCTreesystemTrunk_Home transaction:transaction];
+		[self assertParentIDs:@[ home.uuid, c.uuid, b.uuid ] transaction:transaction];
+		
+		XCTAssertFalse([[ZDCNodeManager sharedInstance] isNode:leaf.uuid aDescendantOf:a.uuid transaction:transaction]);
+		XCTAssertTrue([[ZDCNodeManager sharedInstance] isNode:leaf.uuid aDescendantOf:c.uuid transaction:transaction]);
+	}];
+}
+
+- (void)test_deleteAncestor
+{
+	// Without its parent, "b" is detached from the tree.
+	
+	[self commit:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction removeObjectForKey:a.uuid inCollection:kZDCCollection_Nodes];
+		
+		[self assertPath:@[ @"b", @"leaf" ] trunk:ZDCTreesystemTrunk_Detached transaction:transaction];
+		[self assertParentIDs:@[ b.uuid ] transaction:transaction];
+	}];
+	
+	[roConnection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		[self assertPath:@[ @"b", @"leaf" ] trunk:ZDCTreesystemTrunk_Detached transaction:transaction];
+		[self assertParentIDs:@[ b.uuid ] transaction:transaction];
+	}];
+}
+
+- (void)test_removeAllNodes
+{
+	[self commit:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[transaction removeAllObjectsInCollection:kZDCCollection_Nodes];
+		
+		[self assertPath:@[ @"leaf" ] trunk:ZDCTreesystemTrunk_Detached transaction:transaction];
+		[self assertParentIDs:@[] transaction:transaction];
+	}];
+	
+	[roConnection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		[self assertPath:@[ @"leaf" ] trunk:ZDCTreesystemTrunk_Detached transaction:transaction];
+	}];
+}
+
+- (void)test_snapshotChange
+{
+	// A transaction only uses the cache if it's at the same snapshot as the cache.
+	// So a connection that's still on an older snapshot keeps seeing the old ancestry,
+	// even after the cache has been advanced (and re-populated) for the newer snapshot.
+	
+	YapDatabaseConnection *oldConnection = [database newConnection];
+	[oldConnection beginLongLivedReadTransaction];
+	
+	[self commit:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		ZDCNode *renamed = [[transaction objectForKey:a.uuid inCollection:kZDCCollection_Nodes] copy];
+		renamed.name = @"a2";
+		[transaction setObject:renamed forKey:renamed.uuid inCollection:kZDCCollection_Nodes];
+	}];
+	
+	[roConnection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		[self assertPath:@[ @"a2", @"b", @"leaf" ] trunk:ZDCTreesystemTrunk_Home transaction:transaction];
+	}];
+	
+	[oldConnection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		[self assertPath:@[ @"a", @"b", @"leaf" ] trunk:ZDCTreesystemTrunk_Home transaction:transaction];
+	}];
+	
+	// And once the connection catches up, so does the ancestry.
+	
+	[oldConnection beginLongLivedReadTransaction];
+	[oldConnection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		[self assertPath:@[ @"a2", @"b", @"leaf" ] trunk:ZDCTreesystemTrunk_Home transaction:transaction];
+	}];
+}
+
+@end
@@ -0,0 +1,154 @@
+/**
+ * ZeroDark.cloud
+ * <GitHub wiki link goes here>
+**/
+
+#import <XCTest/XCTest.h>
+
+#import <ZeroDarkCloud/ZeroDarkCloud.h>
+#import <ZeroDarkCloud/ZDCPackedDictionary.h>
+#import <ZeroDarkCloud/BBDictionaryMatcher.h>
+#import <ZeroDarkCloud/BBPattern.h>
+
+#import "ZDCPasswordStrengthCalculatorPrivate.h"
+
+/**
+ * The framework only ships the compiled frequency_lists.zdcdict.
+ * These tests compare it against the source frequency_lists.json (which is only copied into the test bundle).
+ */
+@interface test_PasswordStrength : XCTestCase
+@end
+
+@implementation test_PasswordStrength
+
+- (NSDictionary<NSString*, NSArray<NSString*>*> *)jsonLists
+{
+	NSURL *jsonURL = [[NSBundle bundleForClass:[self class]] URLForResource:@"frequency_lists" withExtension:@"json"];
+	
+	NSData *jsonData = [NSData dataWithContentsOfURL:jsonURL];
+	XCTAssert(jsonData != nil);
+	
+	return [NSJSONSerialization JSONObjectWithData:jsonData options:0 error:nil];
+}
+
+- (NSArray<ZDCPackedDictionary *> *)packedDictionaries
+{
+	NSURL *packedURL = [[ZeroDarkCloud frameworkBundle] URLForResource:@"frequency_lists" withExtension:@"zdcdict"];
+	XCTAssert(packedURL != nil);
+	
+	NSError *error = nil;
+	NSArray<ZDCPackedDictionary *> *dicts = [ZDCPackedDictionary dictionariesWithContentsOfURL:packedURL error:&error];
+	
+	XCTAssert(dicts != nil, @"error: %@", error);
+	return dicts;
+}
+
+- (NSArray<NSString *> *)samplePasswords
+{
+	return @[
+		@"password",
+		@"Password1",
+		@"p@ssw0rd",
+		@"correcthorsebatterystaple",
+		@"Tr0ub4dor&3",
+		@"qwertyuiop",
+		@"jennifer2010",
+		@"zxcvbn",
+		@"iloveyou!!",
+		@"DragonBallZ",
+		@"schöneGrüße",
+		@"d8f#Kq!2vLx9"
+	];
+}
+
+- (void)test_packedDictionary_ranks
+{
+	NSDictionary<NSString*, NSArray<NSString*>*> *lists = [self jsonLists];
+	NSArray<ZDCPackedDictionary *> *dicts = [self packedDictionaries];
+	
+	XCTAssert(dicts.count == lists.count);
+	
+	for (ZDCPackedDictionary *dict in dicts)
+	{
+		NSArray<NSString*> *list = lists[dict.name];
+		XCTAssert(list != nil, @"Unexpected dictionary: %@", dict.name);
+		
+		// Same as the original loader: if a word repeats, its last position wins.
+		NSMutableDictionary<NSString*, NSNumber*> *expected = [NSMutableDictionary dictionaryWithCapacity:list.count];
+		NSUInteger rank = 1;
+		for (NSString *word in list)
+		{
+			expected[word] = @(rank);
+			rank++;
+		}
+		
+		XCTAssert(dict.count == expected.count, @"Count mismatch in dictionary: %@", dict.name);
+		
+		[expected enumerateKeysAndObjectsUsingBlock:^(NSString *word, NSNumber *expectedRank, BOOL *stop) {
+			
+			NSUInteger actualRank = [dict rankOfWord:word];
+			if (actualRank != expectedRank.unsignedIntegerValue)
+			{
+				XCTFail(@"Rank mismatch in dictionary %@ for word: %@", dict.name, word);
+				*stop = YES;
+			}
+		}];
+		
+		XCTAssert([dict rankOfWord:@"d8f#kq!2vlx9"] == 0);
+		XCTAssert([dict rankOfWord:@""] == 0);
+	}
+}
+
+- (void)test_packedDictionary_matchesAndScores
+{
+	NSDictionary<NSString*, NSArray<NSString*>*> *lists = [self jsonLists];
+	NSArray<ZDCPackedDictionary *> *dicts = [self packedDictionaries];
+	
+	// Use the same (dictionary) order for both, so the match lists line up.
+	
+	NSMutableArray<BBDictionaryMatcher *> *packedMatchers = [NSMutableArray array];
+	NSMutableArray<BBDictionaryMatcher *> *jsonMatchers = [NSMutableArray array];
+	
+	for (ZDCPackedDictionary *dict in dicts)
+	{
+		[packedMatchers addObject:[[BBDictionaryMatcher alloc] initWithPackedDictionary:dict]];
+		[jsonMatchers addObject:[[BBDictionaryMatcher alloc] initWithDictionaryName: dict.name
+		                                                                    andList: lists[dict.name]]];
+	}
+	
+	for (NSString *password in [self samplePasswords])
+	{
+		for (NSUInteger i = 0; i < dicts.count; i++)
+		{
+			NSArray<BBPattern *> *packedMatches = [packedMatchers[i] match:password];
+			NSArray<BBPattern *> *jsonMatches = [jsonMatchers[i] match:password];
+			
+			XCTAssert(packedMatches.count == jsonMatches.count, @"password: %@", password);
+			
+			for (NSUInteger m = 0; m < MIN(packedMatches.count, jsonMatches.count); m++)
+			{
+				BBPattern *packed = packedMatches[m];
+				BBPattern *json = jsonMatches[m];
+				
+				XCTAssert(packed.begin == json.begin);
+				XCTAssert(packed.end == json.end);
+				XCTAssertEqualObjects(packed.token, json.token);
+				XCTAssertEqualObjects(packed.userInfo, json.userInfo);
+			}
+		}
+		
+		ZDCPasswordStrength *packedStrength =
+		  [ZDCPasswordStrengthCalculator strengthForPassword:password dictionaryMatchers:packedMatchers];
+		
+		ZDCPasswordStrength *jsonStrength =
+		  [ZDCPasswordStrengthCalculator strengthForPassword:password dictionaryMatchers:jsonMatchers];
+		
+		XCTAssert(packedStrength.score == jsonStrength.score, @"password: %@", password);
+		XCTAssert(packedStrength.entropy == jsonStrength.entropy, @"password: %@", password);
+		
+		// And the public API uses the packed dictionaries.
+		XCTAssert([ZDCPasswordStrengthCalculator strengthForPassword:password].score == jsonStrength.score);
+	}
+}
+
+@end
@@ -0,0 +1,315 @@
+/**
+ * ZeroDark.cloud
+ * <GitHub wiki link goes here>
+**/
+
+#import <XCTest/XCTest.h>
+
+#import "ZDCChangeItem.h"
+#import "ZDCChangeList.h"
+#import "ZDCPullState.h"
+
+@interface ZDCPullState ()
+- (instancetype)initWithLocalUserID:(NSString *)localUserID treeID:(NSString *)treeID;
+@end
+
+static NSString *const kTreeID = @"com.4th-a.unittests";
+
+/**
+ * Tests the quick-pull scheduler:
+ * which pending changes may be processed concurrently, and which must wait.
+ */
+@interface test_PullScheduler : XCTestCase
+@end
+
+@implementation test_PullScheduler
+
+/**
+ * Returns a valid cloud path (treeID/dirPrefix/fileName).
+ * The dirPrefix & fileName are derived from the given indexes.
+ */
+- (NSString *)pathWithDir:(NSUInteger)dirIndex file:(NSUInteger)fileIndex
+{
+	// dirPrefix : 32 hex characters
+	// fileName  : 32 zBase32 characters (+ extension)
+	
+	NSString *dirPrefix = [NSString stringWithFormat:@"%032lX", (unsigned long)dirIndex];
+	
+	NSString *const alphabet = @"ybndrfg8ejkmcpqxot1uwisza345h769";
+	NSUInteger i = fileIndex % alphabet.length;
+	
+	NSString *fileName = [[alphabet substringFromIndex:i] stringByAppendingString:[alphabet substringToIndex:i]];
+	
+	return [NSString stringWithFormat:@"%@/%@/%@.rcrd", kTreeID, dirPrefix, fileName];
+}
+
+- (ZDCChangeItem *)change:(NSString *)changeID command:(NSString *)command path:(NSString *)path
+{
+	return [ZDCChangeItem parseChangeInfo:@{
+		@"id"      : changeID,
+		@"command" : command,
+		@"fileID"  : [@"file-" stringByAppendingString:changeID],
+		@"path"    : path
+	}];
+}
+
+- (ZDCChangeItem *)moveChange:(NSString *)changeID srcPath:(NSString *)srcPath dstPath:(NSString *)dstPath
+{
+	return [ZDCChangeItem parseChangeInfo:@{
+		@"id"      : changeID,
+		@"command" : @"move",
+		@"fileID"  : [@"file-" stringByAppendingString:changeID],
+		@"srcPath" : srcPath,
+		@"dstPath" : dstPath
+	}];
+}
+
+- (ZDCChangeList *)changeListWithChanges:(NSArray<ZDCChangeItem *> *)changes
+{
+	ZDCChangeList *changeList = [[ZDCChangeList alloc] initWithLatestChangeID_remote:@"c0"];
+	[changeList didCompleteFullPull];
+	
+	[changeList didFetchChanges:changes since:@"c0" latest:[changes lastObject].uuid];
+	
+	XCTAssertEqualObjects(changeList.latestChangeID_local, @"c0");
+	return changeList;
+}
+
+- (ZDCPullState *)pullState
+{
+	return [[ZDCPullState alloc] initWithLocalUserID:@"z55tqmfr9kix1p1gntotqpwkacpuoyno" treeID:kTreeID];
+}
+
+/**
+ * Starts whatever can be started, and returns the uuids of the started changes.
+ * The changeIDs of the started changes are added to the given dictionary (keyed by uuid).
+ */
+- (NSArray<NSString *> *)startChangesInList:(ZDCChangeList *)changeList
+                                  pullState:(ZDCPullState *)pullState
+                                  changeIDs:(NSMutableDictionary<NSString*, NSOrderedSet<NSString*>*> *)changeIDsDict
+{
+	NSArray<NSOrderedSet<NSString *> *> *changeIDsList = nil;
+	
+	NSArray<ZDCChangeItem *> *changes =
+	  [pullState startPendingChangesInList: changeList
+	                              maxCount: 8
+	                             lookahead: 64
+	                             changeIDs: &changeIDsList
+	                      hasPendingChange: NULL];
+	
+	XCTAssert(changes.count == changeIDsList.count);
+	
+	NSMutableArray<NSString *> *uuids = [NSMutableArray arrayWithCapacity:changes.count];
+	for (NSUInteger i = 0; i < changes.count; i++)
+	{
+		NSString *uuid = changes[i].uuid;
+		
+		[uuids addObject:uuid];
+		changeIDsDict[uuid] = changeIDsList[i];
+	}
+	
+	return uuids;
+}
+
+/**
+ * Simulates the completion of a change: updates both the change list & the pull state.
+ */
+- (void)finishChange:(NSString *)uuid
+              inList:(ZDCChangeList *)changeList
+           pullState:(ZDCPullState *)pullState
+           changeIDs:(NSDictionary<NSString*, NSOrderedSet<NSString*>*> *)changeIDsDict
+{
+	NSOrderedSet<NSString *> *changeIDs = changeIDsDict[uuid];
+	XCTAssert(changeIDs != nil);
+	
+	[changeList didProcessChangeIDs:[changeIDs set]];
+	[pullState finishChangeIDs:changeIDs];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Dependency Keys
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_keyOverlap
+{
+	// c1 & c2 are in the same directory, c3 is elsewhere.
+	
+	ZDCChangeList *changeList = [self changeListWithChanges:@[
+		[self change:@"c1" command:@"put-if-match" path:[self pathWithDir:1 file:1]],
+		[self change:@"c2" command:@"put-if-match" path:[self pathWithDir:1 file:2]],
+		[self change:@"c3" command:@"put-if-match" path:[self pathWithDir:2 file:3]]
+	]];
+	
+	ZDCPullState *pullState = [self pullState];
+	NSMutableDictionary *changeIDs = [NSMutableDictionary dictionary];
+	
+	NSArray<NSString *> *started = [self startChangesInList:changeList pullState:pullState changeIDs:changeIDs];
+	XCTAssertEqualObjects(started, (@[ @"c1", @"c3" ]));
+	
+	// c2 has to wait for c1, even if c3 completes first.
+	
+	[self finishChange:@"c3" inList:changeList pullState:pullState changeIDs:changeIDs];
+	
+	started = [self startChangesInList:changeList pullState:pullState changeIDs:changeIDs];
+	XCTAssert(started.count == 0);
+	
+	[self finishChange:@"c1" inList:changeList pullState:pullState changeIDs:changeIDs];
+	
+	started = [self startChangesInList:changeList pullState:pullState changeIDs:changeIDs];
+	XCTAssertEqualObjects(started, (@[ @"c2" ]));
+}
+
+- (void)test_creationsAreOrdered
+{
+	// The parent of a new node may have been created by an earlier change.
+	// So node creations are never processed concurrently.
+	
+	ZDCChangeList *changeList = [self changeListWithChanges:@[
+		[self change:@"c1" command:@"put-if-nonexistent" path:[self pathWithDir:1 file:1]],
+		[self change:@"c2" command:@"put-if-nonexistent" path:[self pathWithDir:2 file:2]],
+		[self change:@"c3" command:@"put-if-match"       path:[self pathWithDir:3 file:3]]
+	]];
+	
+	ZDCPullState *pullState = [self pullState];
+	NSMutableDictionary *changeIDs = [NSMutableDictionary dictionary];
+	
+	NSArray<NSString *> *started = [self startChangesInList:changeList pullState:pullState changeIDs:changeIDs];
+	XCTAssertEqualObjects(started, (@[ @"c1", @"c3" ]));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Exclusive Barriers
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_exclusiveBarrier_deleteNode
+{
+	ZDCChangeItem *deleteNode = [self change:@"c2" command:@"delete-node" path:[self pathWithDir:2 file:2]];
+	XCTAssertNil([ZDCPullState dependencyKeysForChange:deleteNode originalChange:deleteNode]);
+	
+	[self checkExclusiveBarrier:deleteNode];
+}
+
+- (void)test_exclusiveBarrier_move
+{
+	// A directory move changes the path of its entire subtree,
+	// so it can't be keyed on the src/dst directories alone.
+	
+	ZDCChangeItem *move = [self moveChange: @"c2"
+	                               srcPath: [self pathWithDir:2 file:2]
+	                               dstPath: [self pathWithDir:5 file:2]];
+	
+	XCTAssertNil([ZDCPullState dependencyKeysForChange:move originalChange:move]);
+	
+	[self checkExclusiveBarrier:move];
+}
+
+- (void)checkExclusiveBarrier:(ZDCChangeItem *)exclusiveChange
+{
+	// c1 & c3 are unrelated to each other, and to c2 (as far as their paths go).
+	
+	ZDCChangeList *changeList = [self changeListWithChanges:@[
+		[self change:@"c1" command:@"put-if-match" path:[self pathWithDir:1 file:1]],
+		exclusiveChange,
+		[self change:@"c3" command:@"put-if-match" path:[self pathWithDir:3 file:3]]
+	]];
+	
+	ZDCPullState *pullState = [self pullState];
+	NSMutableDictionary *changeIDs = [NSMutableDictionary dictionary];
+	
+	// c2 waits for everything before it, and nothing after it may start.
+	
+	NSArray<NSString *> *started = [self startChangesInList:changeList pullState:pullState changeIDs:changeIDs];
+	XCTAssertEqualObjects(started, (@[ @"c1" ]));
+	
+	[self finishChange:@"c1" inList:changeList pullState:pullState changeIDs:changeIDs];
+	
+	// c2 runs alone.
+	
+	started = [self startChangesInList:changeList pullState:pullState changeIDs:changeIDs];
+	XCTAssertEqualObjects(started, (@[ @"c2" ]));
+	XCTAssert(pullState.activeChangesCount == 1);
+	
+	started = [self startChangesInList:changeList pullState:pullState changeIDs:changeIDs];
+	XCTAssert(started.count == 0);
+	
+	[self finishChange:@"c2" inList:changeList pullState:pullState changeIDs:changeIDs];
+	
+	started = [self startChangesInList:changeList pullState:pullState changeIDs:changeIDs];
+	XCTAssertEqualObjects(started, (@[ @"c3" ]));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Completion
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_outOfOrderCompletion
+{
+	ZDCChangeList *changeList = [self changeListWithChanges:@[
+		[self change:@"c1" command:@"put-if-match" path:[self pathWithDir:1 file:1]],
+		[self change:@"c2" command:@"put-if-match" path:[self pathWithDir:2 file:2]],
+		[self change:@"c3" command:@"delete-leaf"  path:[self pathWithDir:3 file:3]]
+	]];
+	
+	ZDCPullState *pullState = [self pullState];
+	NSMutableDictionary *changeIDs = [NSMutableDictionary dictionary];
+	
+	NSArray<NSString *> *started = [self startChangesInList:changeList pullState:pullState changeIDs:changeIDs];
+	XCTAssertEqualObjects(started, (@[ @"c1", @"c2", @"c3" ]));
+	
+	// Completing c3 & c2 doesn't move latestChangeID_local past c1 (which is still being processed).
+	
+	[self finishChange:@"c3" inList:changeList pullState:pullState changeIDs:changeIDs];
+	XCTAssertEqualObjects(changeList.latestChangeID_local, @"c0");
+	
+	[self finishChange:@"c2" inList:changeList pullState:pullState changeIDs:changeIDs];
+	XCTAssertEqualObjects(changeList.latestChangeID_local, @"c0");
+	XCTAssert([changeList hasPendingChange]);
+	
+	// The completed changes aren't handed out again.
+	
+	NSMutableArray<NSString *> *pending = [NSMutableArray array];
+	[changeList enumeratePendingChangesUsingBlock:^(ZDCChangeItem *change, BOOL *stop) {
+		[pending addObject:change.uuid];
+	}];
+	XCTAssertEqualObjects(pending, (@[ @"c1" ]));
+	
+	// Once c1 completes, we jump ahead to the last change.
+	
+	[self finishChange:@"c1" inList:changeList pullState:pullState changeIDs:changeIDs];
+	XCTAssertEqualObjects(changeList.latestChangeID_local, @"c3");
+	XCTAssertFalse([changeList hasPendingChange]);
+	XCTAssert(pullState.activeChangesCount == 0);
+}
+
+- (void)test_haltOnFallback
+{
+	ZDCChangeList *changeList = [self changeListWithChanges:@[
+		[self change:@"c1" command:@"put-if-match" path:[self pathWithDir:1 file:1]],
+		[self change:@"c2" command:@"put-if-match" path:[self pathWithDir:2 file:2]]
+	]];
+	
+	ZDCPullState *pullState = [self pullState];
+	NSMutableDictionary *changeIDs = [NSMutableDictionary dictionary];
+	
+	// Falling back to a full pull halts the quick pull.
+	// The changes that are still active may complete, but nothing new is started.
+	
+	pullState.isQuickPullHalted = YES;
+	
+	BOOL hasPendingChange = NO;
+	NSArray<ZDCChangeItem *> *changes =
+	  [pullState startPendingChangesInList: changeList
+	                              maxCount: 8
+	                             lookahead: 64
+	                             changeIDs: NULL
+	                      hasPendingChange: &hasPendingChange];
+	
+	XCTAssert(changes.count == 0);
+	XCTAssert(hasPendingChange);
+	XCTAssert(pullState.activeChangesCount == 0);
+	
+	NSArray<NSString *> *started = [self startChangesInList:changeList pullState:pullState changeIDs:changeIDs];
+	XCTAssert(started.count == 0);
+}
+
+@end
@@ -0,0 +1,384 @@
+/**
+ * ZeroDark.cloud
+ * <GitHub wiki link goes here>
+**/
+
+#import <XCTest/XCTest.h>
+
+#import <ZeroDarkCloud/ZeroDarkCloud.h>
+#import <YapDatabase/YapDatabase.h>
+
+#import "ZDCResponseCache.h"
+
+static NSString *const kStubHost = @"zdc-response-cache.test";
+
+/**
+ * A local HTTP stub.
+ * Every request to kStubHost is answered (after a short delay) with the configured status code & body.
+ * If the request's "If-None-Match" matches the configured eTag, the answer is a 304.
+ */
+@interface ZDCStubURLProtocol : NSURLProtocol
+
++ (void)resetWithStatusCode:(NSInteger)statusCode body:(NSData *)body eTag:(NSString *)eTag;
+
++ (NSUInteger)requestCount;
++ (NSArray<NSString *> *)ifNoneMatchHeaders;
+
+@end
+
+@implementation ZDCStubURLProtocol
+
+static NSInteger stub_statusCode = 200;
+static NSData *stub_body = nil;
+static NSString *stub_eTag = nil;
+static NSUInteger stub_requestCount = 0;
+static NSMutableArray<NSString *> *stub_ifNoneMatchHeaders = nil;
+
++ (void)resetWithStatusCode:(NSInteger)statusCode body:(NSData *)body eTag:(NSString *)eTag
+{
+	@synchronized(self)
+	{
+		stub_statusCode = statusCode;
+		stub_body = [body copy];
+		stub_eTag = [eTag copy];
+		stub_requestCount = 0;
+		stub_ifNoneMatchHeaders = [[NSMutableArray alloc] init];
+	}
+}
+
++ (NSUInteger)requestCount
+{
+	@synchronized(self) {
+		return stub_requestCount;
+	}
+}
+
++ (NSArray<NSString *> *)ifNoneMatchHeaders
+{
+	@synchronized(self) {
+		return [stub_ifNoneMatchHeaders copy];
+	}
+}
+
++ (BOOL)canInitWithRequest:(NSURLRequest *)request
+{
+	return [request.URL.host isEqualToString:kStubHost];
+}
+
++ (NSURLRequest *)canonicalRequestForRequest:(NSURLRequest *)request
+{
+	return request;
+}
+
+- (void)startLoading
+{
+	NSString *ifNoneMatch = [self.request valueForHTTPHeaderField:@"If-None-Match"];
+	
+	NSInteger statusCode;
+	NSData *body;
+	NSString *eTag;
+	
+	@synchronized([self class])
+	{
+		stub_requestCount++;
+		if (ifNoneMatch) {
+			[stub_ifNoneMatchHeaders addObject:ifNoneMatch];
+		}
+		
+		statusCode = stub_statusCode;
+		body = stub_body;
+		eTag = stub_eTag;
+	}
+	
+	if (ifNoneMatch && [ifNoneMatch isEqualToString:eTag])
+	{
+		statusCode = 304;
+		body = nil;
+	}
+	
+	NSMutableDictionary *headers = [NSMutableDictionary dictionary];
+	if (eTag) {
+		headers[@"ETag"] = [NSString stringWithFormat:@"\"%@\"", eTag];
+	}
+	
+	NSHTTPURLResponse *response =
+	  [[NSHTTPURLResponse alloc] initWithURL: self.request.URL
+	                              statusCode: statusCode
+	                             HTTPVersion: @"HTTP/1.1"
+	                            headerFields: headers];
+	
+	// The delay gives concurrent requests a chance to pile up.
+	// The client must be notified on the thread that invoked startLoading.
+	
+	CFRunLoopRef runLoop = CFRunLoopGetCurrent();
+	
+	dispatch_time_t delay = dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.1 * NSEC_PER_SEC));
+	dispatch_after(delay, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+		
+		CFRunLoopPerformBlock(runLoop, kCFRunLoopCommonModes, ^{
+			
+			[self.client URLProtocol:self didReceiveResponse:response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+			if (body) {
+				[self.client URLProtocol:self didLoadData:body];
+			}
+			[self.client URLProtocolDidFinishLoading:self];
+		});
+		CFRunLoopWakeUp(runLoop);
+	});
+}
+
+- (void)stopLoading
+{
+	// Nothing to cancel
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Tests the shared response cache used by ZDCRestManager,
+ * against a standalone database & a local HTTP stub.
+ */
+@interface test_ResponseCache : XCTestCase
+@end
+
+@implementation test_ResponseCache {
+	
+	NSURL *databaseURL;
+	YapDatabase *database;
+	YapDatabaseConnection *roConnection;
+	YapDatabaseConnection *rwConnection;
+	
+	NSURLSession *session;
+	ZDCResponseCache *responseCache;
+}
+
+- (void)setUp
+{
+	[super setUp];
+	
+	NSString *fileName = [NSString stringWithFormat:@"test_ResponseCache-%@.sqlite", [[NSUUID UUID] UUIDString]];
+	databaseURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+	
+	database = [[YapDatabase alloc] initWithURL:databaseURL];
+	roConnection = [database newConnection];
+	rwConnection = [database newConnection];
+	
+	responseCache = [[ZDCResponseCache alloc] initWithReadConnection:roConnection writeConnection:rwConnection];
+	
+	NSURLSessionConfiguration *config = [NSURLSessionConfiguration ephemeralSessionConfiguration];
+	config.protocolClasses = @[ [ZDCStubURLProtocol class] ];
+	
+	session = [NSURLSession sessionWithConfiguration:config];
+	
+	[ZDCStubURLProtocol resetWithStatusCode: 200
+	                                   body: [@"{\"answer\":42}" dataUsingEncoding:NSUTF8StringEncoding]
+	                                   eTag: @"v1"];
+}
+
+- (void)tearDown
+{
+	[session invalidateAndCancel];
+	
+	responseCache = nil;
+	roConnection = nil;
+	rwConnection = nil;
+	database = nil;
+	
+	NSString *path = databaseURL.path;
+	for (NSString *suffix in @[ @"", @"-wal", @"-shm" ])
+	{
+		[[NSFileManager defaultManager] removeItemAtPath:[path stringByAppendingString:suffix] error:nil];
+	}
+	
+	[super tearDown];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Utilities
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Fetches the response for the given key (via the stub, if needed),
+ * and waits for the completionBlock & the database write (if any) to finish.
+ *
+ * @param outFromCache
+ *   Set to YES if the data was served from the cache (i.e. no response was handed to the completionBlock).
+ */
+- (NSData *)fetchKey:(NSString *)key
+                 ttl:(NSTimeInterval)ttl
+         isCacheable:(BOOL (^)(NSData *data))isCacheable
+           fromCache:(BOOL *)outFromCache
+{
+	XCTestExpectation *expectation = [self expectationWithDescription:key];
+	
+	__block NSData *result = nil;
+	__block BOOL fromCache = NO;
+	
+	[self fetchKey:key ttl:ttl isCacheable:isCacheable completion:^(NSURLResponse *response, NSData *data, NSError *error) {
+		
+		XCTAssertNil(error);
+		
+		result = data;
+		fromCache = (response == nil);
+		[expectation fulfill];
+	}];
+	
+	[self waitForExpectationsWithTimeout:5.0 handler:nil];
+	
+	// The cache writes asynchronously (on the rwConnection).
+	// An empty transaction on the same connection waits for it.
+	[rwConnection readWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {}];
+	
+	if (outFromCache) *outFromCache = fromCache;
+	return result;
+}
+
+- (void)fetchKey:(NSString *)key
+             ttl:(NSTimeInterval)ttl
+     isCacheable:(BOOL (^)(NSData *data))isCacheable
+      completion:(void (^)(NSURLResponse *response, NSData *data, NSError *error))completion
+{
+	NSURLSession *stubSession = session;
+	
+	[responseCache cachedResponseForKey: key
+	                                ttl: ttl
+	                        isCacheable: isCacheable
+	                       networkBlock:^(NSString *eTag, void (^done)(NSURLResponse*, NSData*, NSError*))
+	{
+		NSURLComponents *urlComponents = [[NSURLComponents alloc] init];
+		urlComponents.scheme = @"https";
+		urlComponents.host = kStubHost;
+		urlComponents.path = [@"/" stringByAppendingString:key];
+		
+		NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:[urlComponents URL]];
+		request.HTTPMethod = @"GET";
+		
+		if (eTag) {
+			[request setValue:eTag forHTTPHeaderField:@"If-None-Match"];
+		}
+		
+		NSURLSessionDataTask *task =
+		  [stubSession dataTaskWithRequest:request
+		                 completionHandler:^(NSData *data, NSURLResponse *response, NSError *error)
+		{
+			done(response, data, error);
+		}];
+		
+		[task resume];
+	}
+	                    completionBlock: completion];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Tests
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_coalescing
+{
+	NSUInteger const count = 5;
+	NSMutableArray<NSData *> *results = [NSMutableArray arrayWithCapacity:count];
+	
+	for (NSUInteger i = 0; i < count; i++)
+	{
+		XCTestExpectation *expectation = [self expectationWithDescription:[NSString stringWithFormat:@"request %lu", (unsigned long)i]];
+		
+		[self fetchKey:@"coalesce" ttl:60 isCacheable:nil completion:^(NSURLResponse *response, NSData *data, NSError *error) {
+			
+			XCTAssertNil(error);
+			XCTAssert([(NSHTTPURLResponse *)response statusCode] == 200);
+			
+			@synchronized(results) {
+				[results addObject:data];
+			}
+			[expectation fulfill];
+		}];
+	}
+	
+	[self waitForExpectationsWithTimeout:5.0 handler:nil];
+	
+	XCTAssert([ZDCStubURLProtocol requestCount] == 1);
+	XCTAssert(results.count == count);
+	
+	for (NSData *data in results) {
+		XCTAssertEqualObjects(data, results[0]);
+	}
+}
+
+- (void)test_freshEntry
+{
+	BOOL fromCache = NO;
+	NSData *first = [self fetchKey:@"fresh" ttl:60 isCacheable:nil fromCache:&fromCache];
+	
+	XCTAssertFalse(fromCache);
+	XCTAssert([ZDCStubURLProtocol requestCount] == 1);
+	
+	NSData *second = [self fetchKey:@"fresh" ttl:60 isCacheable:nil fromCache:&fromCache];
+	
+	XCTAssertTrue(fromCache);
+	XCTAssertEqualObjects(first, second);
+	XCTAssert([ZDCStubURLProtocol requestCount] == 1);
+	
+	// Different key: separate entry
+	
+	[self fetchKey:@"fresh-other" ttl:60 isCacheable:nil fromCache:&fromCache];
+	
+	XCTAssertFalse(fromCache);
+	XCTAssert([ZDCStubURLProtocol requestCount] == 2);
+}
+
+- (void)test_staleEntry_revalidated
+{
+	// With a zero ttl, the entry is stale immediately.
+	// But it has an eTag, so it's kept around & revalidated via "If-None-Match".
+	
+	BOOL fromCache = NO;
+	NSData *first = [self fetchKey:@"stale" ttl:0 isCacheable:nil fromCache:&fromCache];
+	
+	XCTAssertFalse(fromCache);
+	XCTAssert([ZDCStubURLProtocol ifNoneMatchHeaders].count == 0);
+	
+	NSData *second = [self fetchKey:@"stale" ttl:0 isCacheable:nil fromCache:&fromCache];
+	
+	XCTAssertTrue(fromCache); // 304: served from the cache
+	XCTAssertEqualObjects(first, second);
+	XCTAssert([ZDCStubURLProtocol requestCount] == 2);
+	XCTAssertEqualObjects([ZDCStubURLProtocol ifNoneMatchHeaders], (@[ @"v1" ]));
+	
+	// Once the server's version changes, the new data replaces the old.
+	
+	NSData *updated = [@"{\"answer\":43}" dataUsingEncoding:NSUTF8StringEncoding];
+	[ZDCStubURLProtocol resetWithStatusCode:200 body:updated eTag:@"v2"];
+	
+	NSData *third = [self fetchKey:@"stale" ttl:0 isCacheable:nil fromCache:&fromCache];
+	
+	XCTAssertFalse(fromCache);
+	XCTAssertEqualObjects(third, updated);
+}
+
+- (void)test_notCacheable
+{
+	BOOL (^isCacheable)(NSData *) = ^BOOL (NSData *data) {
+		return NO;
+	};
+	
+	[self fetchKey:@"uncacheable" ttl:60 isCacheable:isCacheable fromCache:NULL];
+	[self fetchKey:@"uncacheable" ttl:60 isCacheable:isCacheable fromCache:NULL];
+	
+	XCTAssert([ZDCStubURLProtocol requestCount] == 2);
+}
+
+- (void)test_errorNotCached
+{
+	[ZDCStubURLProtocol resetWithStatusCode:500 body:[NSData data] eTag:nil];
+	
+	[self fetchKey:@"error" ttl:60 isCacheable:nil fromCache:NULL];
+	[self fetchKey:@"error" ttl:60 isCacheable:nil fromCache:NULL];
+	
+	XCTAssert([ZDCStubURLProtocol requestCount] == 2);
+}
+
+@end
@@ -1386,6 +1386,95 @@ abort:
 	}
 }
 
+- (void)test_nodeReader_5
+{
+	NSURL *testFilesURL = [[NSBundle bundleForClass:[self class]] URLForResource:@"Test Files" withExtension:nil];
+	
+	NSDirectoryEnumerator<NSURL *> *enumerator =
+	  [[NSFileManager defaultManager] enumeratorAtURL:testFilesURL
+	                       includingPropertiesForKeys:nil
+	                                          options:NSDirectoryEnumerationSkipsSubdirectoryDescendants
+	                                     errorHandler:nil];
+	
+	for (NSURL *cleartextFileURL in enumerator)
+	{
+		// Fetch size of cleartext file
+		
+		uint64_t cleartextFileSize = 0;
+		
+		NSNumber *number = nil;
+		if ([cleartextFileURL getResourceValue:&number forKey:NSURLFileSizeKey error:nil])
+		{
+			cleartextFileSize = [number unsignedLongLongValue];
+		}
+		
+		if (cleartextFileSize == 0) continue;
+		
+		// Convert cleartext to cache file
+		
+		ZDCNode *node = [[ZDCNode alloc] initWithLocalUserID:@"abc123"];
+		
+		NSError *error = nil;
+		NSURL *cacheFileURL = nil;
+		
+		cacheFileURL = [self _convertCleartextFile:cleartextFileURL toCacheFileFor:node error:&error];
+		XCTAssert(cacheFileURL != nil);
+		
+		// Setup ZDCFileReader
+		
+		ZDCFileReader *reader =
+		  [[ZDCFileReader alloc] initWithFileURL: cacheFileURL
+		                                  format: ZDCCryptoFileFormat_CacheFile
+		                           encryptionKey: node.encryptionKey
+		                             retainToken: nil];
+		
+		BOOL openResult = [reader openFileWithError:&error];
+		XCTAssert(openResult);
+		
+		// Scattered small reads (like a media scrubber or a file parser would do).
+		// These exercise: block straddling, repeated (cached) ranges, backwards seeks, and the tail of the file.
+		
+		for (NSUInteger i = 0; i < 200; i++)
+		{
+			NSUInteger location = (NSUInteger)arc4random_uniform((uint32_t)MIN(cleartextFileSize, UINT32_MAX));
+			NSUInteger length = 1 + (NSUInteger)arc4random_uniform(3000);
+			
+			if (i % 10 == 0) {
+				location = (NSUInteger)(cleartextFileSize - MIN(cleartextFileSize, length));
+			}
+			
+			length = (NSUInteger)MIN((uint64_t)length, cleartextFileSize - location);
+			NSRange range = NSMakeRange(location, length);
+			
+			BOOL rangeReadMatches = [self compareRange:range ofRawFile:cleartextFileURL withReader:reader];
+			XCTAssert(rangeReadMatches, @"ZDCFileReader: random read mismatch: %@", NSStringFromRange(range));
+			
+			// Read the same range again (should be serviced from cache)
+			
+			rangeReadMatches = [self compareRange:range ofRawFile:cleartextFileURL withReader:reader];
+			XCTAssert(rangeReadMatches, @"ZDCFileReader: cached read mismatch: %@", NSStringFromRange(range));
+		}
+		
+		// Small sequential reads (triggers read-ahead)
+		
+		NSRange range = NSMakeRange(0, 700);
+		while (range.location < cleartextFileSize)
+		{
+			range.length = (NSUInteger)MIN((uint64_t)700, cleartextFileSize - range.location);
+			
+			BOOL rangeReadMatches = [self compareRange:range ofRawFile:cleartextFileURL withReader:reader];
+			XCTAssert(rangeReadMatches, @"ZDCFileReader: sequential read mismatch: %@", NSStringFromRange(range));
+			
+			if (!rangeReadMatches) break;
+			range.location += range.length;
+		}
+		
+		if (cacheFileURL) {
+			[[NSFileManager defaultManager] removeItemAtURL:cacheFileURL error:nil];
+		}
+	}
+}
+
 - (BOOL)compareRange:(NSRange)range
            ofRawFile:(NSURL *)rawFileURL
           withStream:(ZDCInputStream *)zdcInputStream
@@ -3275,6 +3364,64 @@ abort:
 	}
 }
 
+- (void)test_reEncrypt_inPlace
+{
+	NSURL *testFilesURL = [[NSBundle bundleForClass:[self class]] URLForResource:@"Test Files" withExtension:nil];
+	
+	NSDirectoryEnumerator<NSURL *> *enumerator =
+	  [[NSFileManager defaultManager] enumeratorAtURL:testFilesURL
+	                       includingPropertiesForKeys:nil
+	                                          options:NSDirectoryEnumerationSkipsSubdirectoryDescendants
+	                                     errorHandler:nil];
+	
+	for (NSURL *cleartextFileURL in enumerator)
+	{
+		NSData *encryptionKey1 = [ZDCNode randomEncryptionKey];
+		NSData *encryptionKey2 = [ZDCNode randomEncryptionKey];
+		
+		Cleartext2CacheFileInputStream *encryptionStream =
+		  [[Cleartext2CacheFileInputStream alloc] initWithCleartextFileURL:cleartextFileURL
+		                                                     encryptionKey:encryptionKey1];
+		
+		NSURL *cacheFileURL = [self writeStream:encryptionStream error:nil];
+		XCTAssert(cacheFileURL != nil);
+		
+		// Out-of-place & in-place should produce identical output
+		
+		NSURL *expectedFileURL = [self _reEncryptFile:cacheFileURL fromKey:encryptionKey1 toKey:encryptionKey2 error:nil];
+		XCTAssert(expectedFileURL != nil);
+		
+		NSError *error = nil;
+		BOOL result = [ZDCFileConversion reEncryptFileInPlace: cacheFileURL
+		                                              fromKey: encryptionKey1
+		                                                toKey: encryptionKey2
+		                                                error: &error];
+		XCTAssert(result && error == nil);
+		
+		BOOL same =
+		  [[NSFileManager defaultManager] contentsEqualAtPath:[cacheFileURL path]
+		                                              andPath:[expectedFileURL path]];
+		
+		XCTAssert(same, @"File diff: %@", [cleartextFileURL lastPathComponent]);
+		
+		CacheFile2CleartextInputStream *decryptStream =
+		  [[CacheFile2CleartextInputStream alloc] initWithCacheFileURL:cacheFileURL encryptionKey:encryptionKey2];
+		
+		NSURL *decryptedFileURL = [self writeStream:decryptStream error:nil];
+		XCTAssert(decryptedFileURL != nil);
+		
+		BOOL matches =
+		  [[NSFileManager defaultManager] contentsEqualAtPath:[cleartextFileURL path]
+		                                              andPath:[decryptedFileURL path]];
+		
+		XCTAssert(matches, @"File diff: %@", [cleartextFileURL lastPathComponent]);
+		
+		[[NSFileManager defaultManager] removeItemAtURL:cacheFileURL error:nil];
+		[[NSFileManager defaultManager] removeItemAtURL:expectedFileURL error:nil];
+		[[NSFileManager defaultManager] removeItemAtURL:decryptedFileURL error:nil];
+	}
+}
+
 - (void)test_reEncrypt_cloudFiles
 {
 	NSURL *testFilesURL = [[NSBundle bundleForClass:[self class]] URLForResource:@"Test Files" withExtension:nil];
@@ -3568,4 +3715,245 @@ abort:
 	}
 }
 
+- (void)test_compressedCloudFile
+{
+	// Generate compressible cleartext (spanning several compression blocks)
+	
+	NSMutableString *json = [NSMutableString string];
+	for (NSUInteger i = 0; json.length < (1024 * 300); i++)
+	{
+		[json appendFormat:@"{\"id\":%lu,\"name\":\"message %lu\",\"body\":\"Lorem ipsum dolor sit amet\"},\n",
+		  (unsigned long)i, (unsigned long)i];
+	}
+	
+	NSData *cleartext = [json dataUsingEncoding:NSUTF8StringEncoding];
+	NSData *metadata = [self generateRandomData:100];
+	
+	NSArray<NSNumber*> *compressions = @[
+		@(ZDCCloudFileCompression_LZ4),
+		@(ZDCCloudFileCompression_ZLIB),
+		@(ZDCCloudFileCompression_LZFSE)
+	];
+	
+	for (NSNumber *compression in compressions)
+	{
+		ZDCNode *node = [[ZDCNode alloc] initWithLocalUserID:@"abc123"];
+		
+		Cleartext2CloudFileInputStream *stream =
+		  [[Cleartext2CloudFileInputStream alloc] initWithCleartextData: cleartext
+		                                                  encryptionKey: node.encryptionKey];
+		
+		stream.rawMetadata = metadata;
+		stream.compression = (ZDCCloudFileCompression)[compression unsignedCharValue];
+		
+		XCTAssert(stream.compression == [compression unsignedCharValue]);
+		XCTAssert([stream.encryptedFileSize unsignedLongLongValue] < cleartext.length);
+		
+		NSError *error = nil;
+		NSURL *cloudFileURL = [self writeStream:stream error:&error];
+		
+		XCTAssert(cloudFileURL != nil);
+		XCTAssert(error == nil);
+		
+		// Header
+		
+		ZDCCloudFileHeader header;
+		NSData *outMetadata = nil;
+		
+		BOOL result =
+		  [CloudFile2CleartextInputStream decryptCloudFileURL: cloudFileURL
+		                                    withEncryptionKey: node.encryptionKey
+		                                               header: &header
+		                                          rawMetadata: &outMetadata
+		                                         rawThumbnail: NULL
+		                                                error: &error];
+		
+		XCTAssert(result);
+		XCTAssert(header.version == 1);
+		XCTAssert(header.compression == [compression unsignedCharValue]);
+		XCTAssert(header.uncompressedDataSize == cleartext.length);
+		XCTAssert(header.dataSize < cleartext.length);
+		XCTAssert([outMetadata isEqualToData:metadata]);
+		
+		// Sequential read
+		
+		NSData *decrypted =
+		  [ZDCFileConversion decryptCloudFileIntoMemory: cloudFileURL
+		                                  encryptionKey: node.encryptionKey
+		                                    retainToken: nil
+		                                          error: &error];
+		
+		XCTAssert(error == nil);
+		XCTAssert([decrypted isEqualToData:cleartext]);
+		
+		// Random access
+		
+		ZDCFileReader *reader =
+		  [[ZDCFileReader alloc] initWithFileURL: cloudFileURL
+		                                  format: ZDCCryptoFileFormat_CloudFile
+		                           encryptionKey: node.encryptionKey
+		                             retainToken: nil];
+		
+		for (NSUInteger i = 0; i < 20; i++)
+		{
+			NSRange range = [self randomRangeForFileSize:cleartext.length withMaxLength:(1024 * 100)];
+			
+			NSData *rangeData = [self readRange:range ofReader:reader error:&error];
+			
+			XCTAssert(error == nil);
+			XCTAssert([rangeData isEqualToData:[cleartext subdataWithRange:range]],
+			          @"Random access broken for range(%@)", NSStringFromRange(range));
+		}
+		
+		XCTAssert([reader.cleartextFileSize unsignedLongLongValue] == cleartext.length);
+		[reader close];
+		
+		[[NSFileManager defaultManager] removeItemAtURL:cloudFileURL error:nil];
+	}
+	
+	// Same thing, via ZDCFileConversion (used for in-memory uploads when ZDCConfig.cloudFileCompression is set)
+	
+	{
+		ZDCNode *node = [[ZDCNode alloc] initWithLocalUserID:@"abc123"];
+		
+		NSError *error = nil;
+		NSData *cloudFileData =
+		  [ZDCFileConversion encryptCleartextData: cleartext
+		                       toCloudFileWithKey: node.encryptionKey
+		                                 metadata: metadata
+		                                thumbnail: nil
+		                              compression: ZDCCloudFileCompression_LZFSE
+		                                    error: &error];
+		
+		XCTAssert(error == nil);
+		XCTAssert(cloudFileData.length < cleartext.length);
+		
+		NSURL *cloudFileURL = [self randomFileURL];
+		[cloudFileData writeToURL:cloudFileURL atomically:NO];
+		
+		NSData *decrypted =
+		  [ZDCFileConversion decryptCloudFileIntoMemory: cloudFileURL
+		                                  encryptionKey: node.encryptionKey
+		                                    retainToken: nil
+		                                          error: &error];
+		
+		XCTAssert(error == nil);
+		XCTAssert([decrypted isEqualToData:cleartext]);
+		
+		[[NSFileManager defaultManager] removeItemAtURL:cloudFileURL error:nil];
+	}
+	
+	// Incompressible data falls back to a standard (version 0) cloud file
+	
+	{
+		ZDCNode *node = [[ZDCNode alloc] initWithLocalUserID:@"abc123"];
+		NSData *random = [self generateRandomData:(1024 * 100)];
+		
+		Cleartext2CloudFileInputStream *stream =
+		  [[Cleartext2CloudFileInputStream alloc] initWithCleartextData: random
+		                                                  encryptionKey: node.encryptionKey];
+		
+		stream.compression = ZDCCloudFileCompression_LZ4;
+		XCTAssert(stream.compression == ZDCCloudFileCompression_None);
+	}
+}
+
+- (void)test_compressedCloudFile_dataInfo
+{
+	NSMutableString *json = [NSMutableString string];
+	for (NSUInteger i = 0; json.length < (1024 * 200); i++)
+	{
+		[json appendFormat:@"{\"id\":%lu,\"name\":\"message %lu\"},\n", (unsigned long)i, (unsigned long)i];
+	}
+	
+	NSData *cleartext = [json dataUsingEncoding:NSUTF8StringEncoding];
+	NSData *metadata = [self generateRandomData:100];
+	
+	ZDCNode *node = [[ZDCNode alloc] initWithLocalUserID:@"abc123"];
+	
+	Cleartext2CloudFileInputStream *stream =
+	  [[Cleartext2CloudFileInputStream alloc] initWithCleartextData: cleartext
+	                                                  encryptionKey: node.encryptionKey];
+	
+	stream.rawMetadata = metadata;
+	stream.compression = ZDCCloudFileCompression_LZ4;
+	
+	NSError *error = nil;
+	NSURL *cloudFileURL = [self writeStream:stream error:&error];
+	NSData *cloudFileData = [NSData dataWithContentsOfURL:cloudFileURL];
+	
+	XCTAssert(cloudFileData != nil);
+	
+	ZDCCloudFileHeader header;
+	BOOL result =
+	  [CloudFile2CleartextInputStream decryptCloudFileData: cloudFileData
+	                                     withEncryptionKey: node.encryptionKey
+	                                                header: &header
+	                                           rawMetadata: NULL
+	                                          rawThumbnail: NULL
+	                                                 error: &error];
+	XCTAssert(result);
+	
+	ZDCCloudDataInfo *info =
+	  [[ZDCCloudDataInfo alloc] initWithCloudFileHeader: header
+	                                               eTag: @"eTag"
+	                                       lastModified: [NSDate date]];
+	
+	// dataSize is the size of the app's data, not the size of the compressed section.
+	
+	XCTAssert(info.dataSize == cleartext.length);
+	XCTAssert(info.compression == ZDCCloudFileCompression_LZ4);
+	XCTAssert(info.compressionBlockShift == header.compressionBlockShift);
+	XCTAssert(info.compressedDataSize == header.dataSize);
+	XCTAssert(info.compressedDataSize < info.dataSize);
+	
+	// Survives archiving (i.e. storage in the database).
+	
+	NSData *archived = [NSKeyedArchiver archivedDataWithRootObject:info];
+	ZDCCloudDataInfo *unarchived = [NSKeyedUnarchiver unarchiveObjectWithData:archived];
+	
+	for (ZDCCloudDataInfo *i in @[ info, unarchived ])
+	{
+		ZDCCloudFileHeader raw = [i rawHeader];
+		
+		XCTAssert(raw.magic                 == header.magic);
+		XCTAssert(raw.metadataSize          == header.metadataSize);
+		XCTAssert(raw.thumbnailSize         == header.thumbnailSize);
+		XCTAssert(raw.dataSize              == header.dataSize);
+		XCTAssert(raw.thumbnailxxHash64     == header.thumbnailxxHash64);
+		XCTAssert(raw.version               == header.version);
+		XCTAssert(raw.compression           == header.compression);
+		XCTAssert(raw.compressionBlockShift == header.compressionBlockShift);
+		XCTAssert(raw.uncompressedDataSize  == header.uncompressedDataSize);
+	}
+	
+	// Same as ZDCDownloadManager: re-encrypt the header from rawHeader,
+	// and decrypt the rest of the file (which was downloaded without the header).
+	
+	NSData *prefix =
+	  [Cleartext2CloudFileInputStream encryptCloudFileHeader: [unarchived rawHeader]
+	                                       withEncryptionKey: node.encryptionKey
+	                                                   error: &error];
+	XCTAssert(prefix.length == sizeof(ZDCCloudFileHeader));
+	
+	NSMutableData *rebuilt = [prefix mutableCopy];
+	[rebuilt appendData:[cloudFileData subdataWithRange:NSMakeRange(prefix.length, cloudFileData.length - prefix.length)]];
+	
+	XCTAssert([rebuilt isEqualToData:cloudFileData]);
+	
+	NSData *outMetadata = nil;
+	result =
+	  [CloudFile2CleartextInputStream decryptCloudFileData: rebuilt
+	                                     withEncryptionKey: node.encryptionKey
+	                                                header: NULL
+	                                           rawMetadata: &outMetadata
+	                                          rawThumbnail: NULL
+	                                                 error: &error];
+	
+	XCTAssert(result);
+	XCTAssert([outMetadata isEqualToData:metadata]);
+	
+	[[NSFileManager defaultManager] removeItemAtURL:cloudFileURL error:nil];
+}
+
 @end
@@ -0,0 +1,360 @@
+/**
+ * ZeroDark.cloud
+ * <GitHub wiki link goes here>
+**/
+
+#import <XCTest/XCTest.h>
+
+#import <ZeroDarkCloud/ZeroDarkCloud.h>
+#import <YapDatabase/YapDatabaseCloudCore.h>
+
+#import "ZDCSyncingNodeTracker.h"
+
+static NSString *const kLocalUserID = @"z55tqmfr9kix1p1gntotqpwkacpuoyno";
+static NSString *const kTreeID = @"com.4th-a.unittests";
+
+/**
+ * Tests the reference counting behind ZDCSyncManager.syncingNodeIDs.
+ * Every retain (operation enqueued, download started) must be balanced by a release
+ * (operation completed/skipped/removed, download stopped), and a moved node must swap its ancestry.
+ *
+ * The tree used by every test:
+ *
+ * home
+ * ├── a
+ * │   └── b
+ * │       └── leaf
+ * └── c
+ *     └── other
+ */
+@interface test_SyncingNodes : XCTestCase
+@end
+
+@implementation test_SyncingNodes {
+	
+	ZDCSyncingNodeTracker *tracker;
+	NSMutableDictionary<NSUUID *, NSNumber *> *statuses;
+	
+	NSArray<NSString *> *leafAncestry;
+	NSArray<NSString *> *otherAncestry;
+}
+
+- (void)setUp
+{
+	[super setUp];
+	
+	tracker = [[ZDCSyncingNodeTracker alloc] init];
+	statuses = [NSMutableDictionary dictionary];
+	
+	leafAncestry  = @[ @"leaf", @"b", @"a", @"home" ];
+	otherAncestry = @[ @"other", @"c", @"home" ];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Utilities
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (ZDCCloudOperation *)operationForNodeID:(NSString *)nodeID
+{
+	ZDCCloudOperation *op =
+	  [[ZDCCloudOperation alloc] initWithLocalUserID: kLocalUserID
+	                                          treeID: kTreeID
+	                                         putType: ZDCCloudOperationPutType_Node_Data];
+	op.nodeID = nodeID;
+	
+	statuses[op.uuid] = @(YDBCloudOperationStatus_Pending);
+	return op;
+}
+
+/**
+ * Simulates a pipeline change: returns the operations that need to be resolved.
+ */
+- (NSDictionary<NSUUID *, NSString *> *)updateWithOperations:(NSArray<ZDCCloudOperation *> *)operations
+{
+	return [tracker updateWithOperations: operations
+	                         statusBlock:^YDBCloudCoreOperationStatus (NSUUID *opUUID)
+	{
+		return (YDBCloudCoreOperationStatus)[self->statuses[opUUID] integerValue];
+		
+	} changed:NULL];
+}
+
+- (void)assertCounts:(NSDictionary<NSString *, NSNumber *> *)expected
+{
+	NSSet<NSString *> *expectedNodeIDs = [NSSet setWithArray:[expected allKeys]];
+	XCTAssertEqualObjects(tracker.syncingNodeIDs, expectedNodeIDs);
+	
+	for (NSString *nodeID in @[ @"home", @"a", @"b", @"c", @"leaf", @"other" ])
+	{
+		NSUInteger expectedCount = [expected[nodeID] unsignedIntegerValue];
+		XCTAssertEqual([tracker referenceCountForNodeID:nodeID], expectedCount, @"nodeID: %@", nodeID);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Operations
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_enqueueComplete
+{
+	ZDCCloudOperation *op = [self operationForNodeID:@"leaf"];
+	NSArray *ops = @[ op ];
+	
+	NSDictionary *added = [self updateWithOperations:ops];
+	XCTAssertEqualObjects(added, @{ op.uuid: @"leaf" });
+	
+	// Nothing is retained until the ancestry is resolved
+	[self assertCounts:@{}];
+	
+	XCTAssertTrue([tracker resolveOperations:@{ op.uuid: leafAncestry }]);
+	[self assertCounts:@{ @"leaf": @1, @"b": @1, @"a": @1, @"home": @1 }];
+	
+	// Unchanged pipeline: nothing to resolve, nothing retained twice
+	XCTAssert([self updateWithOperations:ops].count == 0);
+	[self assertCounts:@{ @"leaf": @1, @"b": @1, @"a": @1, @"home": @1 }];
+	
+	statuses[op.uuid] = @(YDBCloudOperationStatus_Completed);
+	
+	BOOL changed = NO;
+	[tracker updateWithOperations: ops
+	                  statusBlock:^YDBCloudCoreOperationStatus (NSUUID *opUUID)
+	{
+		return (YDBCloudCoreOperationStatus)[self->statuses[opUUID] integerValue];
+		
+	} changed:&changed];
+	
+	XCTAssertTrue(changed);
+	[self assertCounts:@{}];
+}
+
+- (void)test_enqueueSkip
+{
+	ZDCCloudOperation *op1 = [self operationForNodeID:@"leaf"];
+	ZDCCloudOperation *op2 = [self operationForNodeID:@"other"];
+	NSArray *ops = @[ op1, op2 ];
+	
+	[self updateWithOperations:ops];
+	[tracker resolveOperations:@{ op1.uuid: leafAncestry, op2.uuid: otherAncestry }];
+	
+	[self assertCounts:@{ @"leaf": @1, @"b": @1, @"a": @1, @"other": @1, @"c": @1, @"home": @2 }];
+	
+	statuses[op1.uuid] = @(YDBCloudOperationStatus_Skipped);
+	[self updateWithOperations:ops];
+	
+	[self assertCounts:@{ @"other": @1, @"c": @1, @"home": @1 }];
+	
+	statuses[op2.uuid] = @(YDBCloudOperationStatus_Skipped);
+	[self updateWithOperations:ops];
+	
+	[self assertCounts:@{}];
+}
+
+- (void)test_enqueueRemove
+{
+	ZDCCloudOperation *op1 = [self operationForNodeID:@"leaf"];
+	ZDCCloudOperation *op2 = [self operationForNodeID:@"leaf"];
+	
+	[self updateWithOperations:@[ op1, op2 ]];
+	[tracker resolveOperations:@{ op1.uuid: leafAncestry, op2.uuid: leafAncestry }];
+	
+	[self assertCounts:@{ @"leaf": @2, @"b": @2, @"a": @2, @"home": @2 }];
+	
+	// Removed from the pipeline (without being marked completed/skipped)
+	
+	[self updateWithOperations:@[ op2 ]];
+	[self assertCounts:@{ @"leaf": @1, @"b": @1, @"a": @1, @"home": @1 }];
+	
+	[self updateWithOperations:@[]];
+	[self assertCounts:@{}];
+}
+
+- (void)test_completeWhilePending
+{
+	ZDCCloudOperation *op = [self operationForNodeID:@"leaf"];
+	
+	[self updateWithOperations:@[ op ]];
+	
+	// The operation completes before its ancestry is resolved
+	
+	statuses[op.uuid] = @(YDBCloudOperationStatus_Completed);
+	[self updateWithOperations:@[ op ]];
+	
+	XCTAssertFalse([tracker resolveOperations:@{ op.uuid: leafAncestry }]);
+	[self assertCounts:@{}];
+}
+
+- (void)test_operationWithoutNode
+{
+	ZDCCloudOperation *op = [self operationForNodeID:nil];
+	
+	XCTAssert([self updateWithOperations:@[ op ]].count == 0);
+	[self assertCounts:@{}];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Downloads
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_downloadStartStop
+{
+	XCTAssertTrue([tracker startDownloadForNodeID:@"leaf"]);
+	XCTAssertFalse([tracker startDownloadForNodeID:@"leaf"]); // already pending
+	
+	XCTAssertTrue([tracker resolveDownloadForNodeID:@"leaf" ancestry:leafAncestry]);
+	XCTAssertFalse([tracker startDownloadForNodeID:@"leaf"]); // already tracked
+	
+	[self assertCounts:@{ @"leaf": @1, @"b": @1, @"a": @1, @"home": @1 }];
+	
+	XCTAssertTrue([tracker stopDownloadForNodeID:@"leaf"]);
+	XCTAssertFalse([tracker stopDownloadForNodeID:@"leaf"]); // not tracked anymore
+	
+	[self assertCounts:@{}];
+}
+
+- (void)test_downloadStopWhilePending
+{
+	XCTAssertTrue([tracker startDownloadForNodeID:@"leaf"]);
+	XCTAssertFalse([tracker stopDownloadForNodeID:@"leaf"]);
+	
+	XCTAssertFalse([tracker resolveDownloadForNodeID:@"leaf" ancestry:leafAncestry]);
+	[self assertCounts:@{}];
+}
+
+- (void)test_downloadAndOperation
+{
+	ZDCCloudOperation *op = [self operationForNodeID:@"leaf"];
+	
+	[self updateWithOperations:@[ op ]];
+	[tracker resolveOperations:@{ op.uuid: leafAncestry }];
+	
+	[tracker startDownloadForNodeID:@"other"];
+	[tracker resolveDownloadForNodeID:@"other" ancestry:otherAncestry];
+	
+	[self assertCounts:@{ @"leaf": @1, @"b": @1, @"a": @1, @"other": @1, @"c": @1, @"home": @2 }];
+	
+	// Stopping the download doesn't change the nodes the operation references
+	
+	XCTAssertTrue([tracker stopDownloadForNodeID:@"other"]);
+	[self assertCounts:@{ @"leaf": @1, @"b": @1, @"a": @1, @"home": @1 }];
+	
+	[self updateWithOperations:@[]];
+	[self assertCounts:@{}];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Moves
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_moveAncestor
+{
+	ZDCCloudOperation *op = [self operationForNodeID:@"leaf"];
+	
+	[self updateWithOperations:@[ op ]];
+	[tracker resolveOperations:@{ op.uuid: leafAncestry }];
+	
+	[tracker startDownloadForNodeID:@"leaf"];
+	[tracker resolveDownloadForNodeID:@"leaf" ancestry:leafAncestry];
+	
+	// Unrelated changes don't affect anything
+	XCTAssert([tracker nodeIDsAffectedByChangedNodeIDs:[NSSet setWithObject:@"other"]].count == 0);
+	
+	// Move "b" from "a" to "c"
+	
+	NSSet *affected = [tracker nodeIDsAffectedByChangedNodeIDs:[NSSet setWithObject:@"b"]];
+	XCTAssertEqualObjects(affected, [NSSet setWithObject:@"leaf"]);
+	
+	NSArray<NSString *> *movedAncestry = @[ @"leaf", @"b", @"c", @"home" ];
+	
+	XCTAssertTrue([tracker updateAncestries:@{ @"leaf": movedAncestry }]);
+	[self assertCounts:@{ @"leaf": @2, @"b": @2, @"c": @2, @"home": @2 }];
+	
+	// Releases are balanced against the new ancestry
+	
+	[tracker stopDownloadForNodeID:@"leaf"];
+	[self updateWithOperations:@[]];
+	
+	[self assertCounts:@{}];
+}
+
+- (void)test_renameAncestor
+{
+	ZDCCloudOperation *op = [self operationForNodeID:@"leaf"];
+	
+	[self updateWithOperations:@[ op ]];
+	[tracker resolveOperations:@{ op.uuid: leafAncestry }];
+	
+	// "a" was modified, but not moved: the re-resolved ancestry is the same
+	
+	NSSet *affected = [tracker nodeIDsAffectedByChangedNodeIDs:[NSSet setWithObject:@"a"]];
+	XCTAssertEqualObjects(affected, [NSSet setWithObject:@"leaf"]);
+	
+	XCTAssertFalse([tracker updateAncestries:@{ @"leaf": leafAncestry }]);
+	[self assertCounts:@{ @"leaf": @1, @"b": @1, @"a": @1, @"home": @1 }];
+}
+
+- (void)test_deleteAncestor
+{
+	ZDCCloudOperation *op = [self operationForNodeID:@"leaf"];
+	
+	[self updateWithOperations:@[ op ]];
+	[tracker resolveOperations:@{ op.uuid: leafAncestry }];
+	
+	// Without "a", the "b" node is detached
+	
+	XCTAssertTrue([tracker updateAncestries:@{ @"leaf": @[ @"leaf", @"b" ] }]);
+	[self assertCounts:@{ @"leaf": @1, @"b": @1 }];
+	
+	[self updateWithOperations:@[]];
+	[self assertCounts:@{}];
+}
+
+- (void)test_moveWhilePending
+{
+	// The resolution that's in flight may have read the ancestry from before the move.
+	// So pending sources are always reported as affected.
+	
+	ZDCCloudOperation *op = [self operationForNodeID:@"leaf"];
+	
+	[self updateWithOperations:@[ op ]];
+	[tracker startDownloadForNodeID:@"other"];
+	
+	NSSet *affected = [tracker nodeIDsAffectedByChangedNodeIDs:[NSSet setWithObject:@"b"]];
+	XCTAssertEqualObjects(affected, ([NSSet setWithObjects:@"leaf", @"other", nil]));
+	
+	[tracker resolveOperations:@{ op.uuid: leafAncestry }];
+	[tracker resolveDownloadForNodeID:@"other" ancestry:otherAncestry];
+	
+	NSArray<NSString *> *movedAncestry = @[ @"leaf", @"b", @"c", @"home" ];
+	
+	[tracker updateAncestries:@{ @"leaf": movedAncestry, @"other": otherAncestry }];
+	[self assertCounts:@{ @"leaf": @1, @"b": @1, @"other": @1, @"c": @2, @"home": @2 }];
+	
+	[tracker stopDownloadForNodeID:@"other"];
+	[self updateWithOperations:@[]];
+	
+	[self assertCounts:@{}];
+}
+
+- (void)test_removeAllNodes
+{
+	ZDCCloudOperation *op = [self operationForNodeID:@"leaf"];
+	
+	[self updateWithOperations:@[ op ]];
+	[tracker resolveOperations:@{ op.uuid: leafAncestry }];
+	
+	[tracker startDownloadForNodeID:@"other"];
+	[tracker resolveDownloadForNodeID:@"other" ancestry:otherAncestry];
+	
+	NSSet *affected = [tracker nodeIDsAffectedByChangedNodeIDs:nil];
+	XCTAssertEqualObjects(affected, ([NSSet setWithObjects:@"leaf", @"other", nil]));
+	
+	[tracker updateAncestries:@{ @"leaf": @[ @"leaf" ], @"other": @[ @"other" ] }];
+	[self assertCounts:@{ @"leaf": @1, @"other": @1 }];
+	
+	[tracker stopDownloadForNodeID:@"other"];
+	[self updateWithOperations:@[]];
+	
+	[self assertCounts:@{}];
+}
+
+@end
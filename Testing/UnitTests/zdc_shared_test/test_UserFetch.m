@@ -0,0 +1,479 @@
+/**
+ * ZeroDark.cloud
+ * <GitHub wiki link goes here>
+**/
+
+#import <XCTest/XCTest.h>
+
+#import <ZeroDarkCloud/ZeroDarkCloud.h>
+#import <YapDatabase/YapDatabase.h>
+
+#import "ZDCBlockchainManager.h"
+#import "ZDCUserManagerPrivate.h"
+#import "ZDCUserProfile.h"
+
+static NSString *const kLocalUserID = @"z55tqmfr9kix1p1gntotqpwkacpuoyno";
+
+static NSString *const kStep_User   = @"user";
+static NSString *const kStep_Auth0  = @"auth0";
+static NSString *const kStep_PubKey = @"pubKey";
+
+/**
+ * A UserManager that performs the network operations locally.
+ *
+ * Each step succeeds, unless the user is listed in `failures` for that step.
+ * The blockchain step always reports that there's no blockchain entry (which isn't an error).
+ */
+@interface test_UserFetch_Manager : ZDCUserManager
+
+@property (atomic, copy) NSDictionary<NSString*, NSString*> *failures; // userID => step
+@property (atomic, copy) NSSet<NSString*> *deletedUserIDs;
+
+/** The first network operation is held for these users, until `releaseUserID:` is invoked. */
+@property (atomic, copy) NSSet<NSString*> *heldUserIDs;
+
+/** Invoked when the first network operation starts for a user. */
+@property (atomic, copy) void (^fetchStartedBlock)(NSString *userID);
+
+- (void)releaseUserID:(NSString *)userID;
+
+- (NSUInteger)fetchCountForStep:(NSString *)step userID:(NSString *)userID;
+
+@end
+
+@implementation test_UserFetch_Manager {
+	
+	NSCountedSet<NSString *> *fetches; // "step|userID"
+	NSMutableDictionary<NSString*, dispatch_block_t> *heldFetches;
+}
+
+- (instancetype)initWithOwner:(ZeroDarkCloud *)owner
+                 roConnection:(YapDatabaseConnection *)roConnection
+                 rwConnection:(YapDatabaseConnection *)rwConnection
+{
+	if ((self = [super initWithOwner:owner roConnection:roConnection rwConnection:rwConnection]))
+	{
+		fetches = [[NSCountedSet alloc] init];
+		heldFetches = [[NSMutableDictionary alloc] init];
+	}
+	return self;
+}
+
+- (NSUInteger)fetchCountForStep:(NSString *)step userID:(NSString *)userID
+{
+	@synchronized (self) {
+		return [fetches countForObject:[NSString stringWithFormat:@"%@|%@", step, userID]];
+	}
+}
+
+/**
+ * Records the fetch, and returns an error if the step should fail.
+ */
+- (NSError *)didFetchStep:(NSString *)step userID:(NSString *)userID
+{
+	@synchronized (self) {
+		[fetches addObject:[NSString stringWithFormat:@"%@|%@", step, userID]];
+	}
+	
+	if (![self.failures[userID] isEqualToString:step]) {
+		return nil;
+	}
+	
+	NSString *description = [NSString stringWithFormat:@"Simulated %@ failure", step];
+	return [NSError errorWithDomain: NSStringFromClass([self class])
+	                           code: 500
+	                       userInfo: @{ NSLocalizedDescriptionKey: description }];
+}
+
+- (void)releaseUserID:(NSString *)userID
+{
+	dispatch_block_t block = nil;
+	@synchronized (self) {
+		block = heldFetches[userID];
+		heldFetches[userID] = nil;
+	}
+	
+	if (block) {
+		block();
+	}
+}
+
+- (void)_fetchRemoteUser:(NSString *)remoteUserID
+             requesterID:(NSString *)localUserID
+         completionQueue:(dispatch_queue_t)completionQueue
+         completionBlock:(void (^)(ZDCUser *user, NSError *error))completionBlock
+{
+	NSError *error = [self didFetchStep:kStep_User userID:remoteUserID];
+	
+	ZDCUser *user = nil;
+	if (!error)
+	{
+		user = [[ZDCUser alloc] initWithUUID:remoteUserID];
+		user.accountDeleted = [self.deletedUserIDs containsObject:remoteUserID];
+	}
+	
+	dispatch_block_t complete = ^{
+		dispatch_async(completionQueue, ^{
+			completionBlock(user, error);
+		});
+	};
+	
+	if ([self.heldUserIDs containsObject:remoteUserID])
+	{
+		@synchronized (self) {
+			heldFetches[remoteUserID] = complete;
+		}
+	}
+	else
+	{
+		complete();
+	}
+	
+	void (^startedBlock)(NSString *) = self.fetchStartedBlock;
+	if (startedBlock) {
+		startedBlock(remoteUserID);
+	}
+}
+
+- (void)_fetchFilteredAuth0Profile:(NSString *)remoteUserID
+                       requesterID:(NSString *)localUserID
+                   completionQueue:(dispatch_queue_t)completionQueue
+                   completionBlock:(void (^)(ZDCUserProfile *profile, NSError *error))completionBlock
+{
+	NSError *error = [self didFetchStep:kStep_Auth0 userID:remoteUserID];
+	ZDCUserProfile *profile = error ? nil : [[ZDCUserProfile alloc] initWithDictionary:@{}];
+	
+	dispatch_async(completionQueue, ^{
+		completionBlock(profile, error);
+	});
+}
+
+- (void)_fetchPubKeyForUser:(ZDCUser *)user
+                requesterID:(NSString *)localUserID
+            completionQueue:(dispatch_queue_t)completionQueue
+            completionBlock:(void (^)(ZDCPublicKey *pubKey, NSError *error))completionBlock
+{
+	NSError *error = [self didFetchStep:kStep_PubKey userID:user.uuid];
+	ZDCPublicKey *pubKey = error ? nil : [[ZDCPublicKey alloc] initWithUserID:user.uuid pubKeyJSON:@"{}"];
+	
+	dispatch_async(completionQueue, ^{
+		completionBlock(pubKey, error);
+	});
+}
+
+- (void)_fetchBlockchainProofForUserID:(NSString *)userID
+                       completionQueue:(dispatch_queue_t)completionQueue
+                       completionBlock:(void (^)(ZDCBlockchainProof *proof, NSError *error))completionBlock
+{
+	NSError *error = [NSError errorWithDomain: NSStringFromClass([self class])
+	                                     code: BlockchainErrorCode_NoBlockchainEntry
+	                                 userInfo: nil];
+	
+	dispatch_async(completionQueue, ^{
+		completionBlock(nil, error);
+	});
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Tests the download flow shared by `fetchUserWithID:::` & `fetchUsersWithIDs:::`.
+ * In particular, that every user either succeeds or fails the same way (whichever method is used),
+ * and that failed users aren't stored in the database.
+ */
+@interface test_UserFetch : XCTestCase
+@end
+
+@implementation test_UserFetch {
+	
+	NSURL *databaseURL;
+	YapDatabase *database;
+	YapDatabaseConnection *rwConnection;
+	YapDatabaseConnection *roConnection;
+	
+	test_UserFetch_Manager *userManager;
+}
+
+- (void)setUp
+{
+	[super setUp];
+	
+	NSString *fileName = [NSString stringWithFormat:@"test_UserFetch-%@.sqlite", [[NSUUID UUID] UUIDString]];
+	databaseURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+	
+	database = [[YapDatabase alloc] initWithURL:databaseURL];
+	
+	rwConnection = [database newConnection];
+	roConnection = [database newConnection];
+	
+	userManager = [[test_UserFetch_Manager alloc] initWithOwner: nil
+	                                               roConnection: roConnection
+	                                               rwConnection: rwConnection];
+}
+
+- (void)tearDown
+{
+	userManager = nil;
+	rwConnection = nil;
+	roConnection = nil;
+	database = nil;
+	
+	NSString *path = databaseURL.path;
+	for (NSString *suffix in @[ @"", @"-wal", @"-shm" ])
+	{
+		[[NSFileManager defaultManager] removeItemAtPath:[path stringByAppendingString:suffix] error:nil];
+	}
+	
+	[super tearDown];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Utilities
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)fetchUserWithID:(NSString *)userID user:(ZDCUser **)userPtr error:(NSError **)errorPtr
+{
+	__block ZDCUser *result = nil;
+	__block NSError *resultError = nil;
+	
+	XCTestExpectation *expectation = [self expectationWithDescription:@"fetchUserWithID"];
+	
+	[userManager fetchUserWithID: userID
+	                 requesterID: kLocalUserID
+	             completionQueue: dispatch_get_main_queue()
+	             completionBlock:^(ZDCUser *remoteUser, NSError *error)
+	{
+		result = remoteUser;
+		resultError = error;
+		[expectation fulfill];
+	}];
+	
+	[self waitForExpectationsWithTimeout:5.0 handler:nil];
+	
+	if (userPtr) *userPtr = result;
+	if (errorPtr) *errorPtr = resultError;
+}
+
+- (void)fetchUsersWithIDs:(NSArray<NSString *> *)userIDs
+                    users:(NSDictionary<NSString*, ZDCUser*> **)usersPtr
+                   errors:(NSDictionary<NSString*, NSError*> **)errorsPtr
+{
+	__block NSDictionary<NSString*, ZDCUser*> *results = nil;
+	__block NSDictionary<NSString*, NSError*> *resultErrors = nil;
+	
+	XCTestExpectation *expectation = [self expectationWithDescription:@"fetchUsersWithIDs"];
+	
+	[userManager fetchUsersWithIDs: userIDs
+	                   requesterID: kLocalUserID
+	               completionQueue: dispatch_get_main_queue()
+	               completionBlock:^(NSDictionary<NSString*, ZDCUser*> *remoteUsers,
+	                                 NSDictionary<NSString*, NSError*> *errors)
+	{
+		results = remoteUsers;
+		resultErrors = errors;
+		[expectation fulfill];
+	}];
+	
+	[self waitForExpectationsWithTimeout:5.0 handler:nil];
+	
+	if (usersPtr) *usersPtr = results;
+	if (errorsPtr) *errorsPtr = resultErrors;
+}
+
+- (ZDCUser *)databaseUserWithID:(NSString *)userID pubKey:(ZDCPublicKey **)pubKeyPtr
+{
+	__block ZDCUser *user = nil;
+	__block ZDCPublicKey *pubKey = nil;
+	
+	[roConnection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		user = [transaction objectForKey:userID inCollection:kZDCCollection_Users];
+		if (user.publicKeyID) {
+			pubKey = [transaction objectForKey:user.publicKeyID inCollection:kZDCCollection_PublicKeys];
+		}
+	}];
+	
+	if (pubKeyPtr) *pubKeyPtr = pubKey;
+	return user;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Single User
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_single_success
+{
+	NSString *userID = @"kqkc1w9gawgkbxscr9tgmcz6mapz9gqc";
+	
+	ZDCUser *user = nil;
+	NSError *error = nil;
+	[self fetchUserWithID:userID user:&user error:&error];
+	
+	XCTAssertNil(error);
+	XCTAssertNotNil(user.publicKeyID);
+	XCTAssertNotNil(user.lastRefresh_blockchain);
+	
+	ZDCPublicKey *pubKey = nil;
+	ZDCUser *databaseUser = [self databaseUserWithID:userID pubKey:&pubKey];
+	
+	XCTAssertNotNil(databaseUser);
+	XCTAssertEqualObjects(pubKey.userID, userID);
+	
+	// Fetching again reads from the database
+	
+	[self fetchUserWithID:userID user:&user error:&error];
+	
+	XCTAssertNotNil(user);
+	XCTAssertEqual([userManager fetchCountForStep:kStep_User userID:userID], 1);
+}
+
+- (void)test_single_pubKeyFailure
+{
+	NSString *userID = @"kqkc1w9gawgkbxscr9tgmcz6mapz9gqc";
+	userManager.failures = @{ userID: kStep_PubKey };
+	
+	ZDCUser *user = nil;
+	NSError *error = nil;
+	[self fetchUserWithID:userID user:&user error:&error];
+	
+	XCTAssertNil(user);
+	XCTAssertNotNil(error);
+	XCTAssertNil([self databaseUserWithID:userID pubKey:NULL]);
+}
+
+- (void)test_single_auth0Failure
+{
+	NSString *userID = @"kqkc1w9gawgkbxscr9tgmcz6mapz9gqc";
+	userManager.failures = @{ userID: kStep_Auth0 };
+	
+	ZDCUser *user = nil;
+	NSError *error = nil;
+	[self fetchUserWithID:userID user:&user error:&error];
+	
+	XCTAssertNil(user);
+	XCTAssertNotNil(error);
+	XCTAssertEqual([userManager fetchCountForStep:kStep_PubKey userID:userID], 0);
+	XCTAssertNil([self databaseUserWithID:userID pubKey:NULL]);
+}
+
+- (void)test_single_accountDeleted
+{
+	NSString *userID = @"kqkc1w9gawgkbxscr9tgmcz6mapz9gqc";
+	userManager.deletedUserIDs = [NSSet setWithObject:userID];
+	
+	ZDCUser *user = nil;
+	NSError *error = nil;
+	[self fetchUserWithID:userID user:&user error:&error];
+	
+	XCTAssertNil(error);
+	XCTAssertTrue(user.accountDeleted);
+	XCTAssertNil(user.publicKeyID);
+	
+	XCTAssertEqual([userManager fetchCountForStep:kStep_Auth0 userID:userID], 0);
+	XCTAssertEqual([userManager fetchCountForStep:kStep_PubKey userID:userID], 0);
+	XCTAssertNotNil([self databaseUserWithID:userID pubKey:NULL]);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Multiple Users
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)test_batch_pubKeyFailure
+{
+	NSString *userID_a = @"kqkc1w9gawgkbxscr9tgmcz6mapz9gqc";
+	NSString *userID_b = @"w4xpbqjx5zrjnbc7t9mbwtko3ycpsjhd";
+	NSString *userID_c = @"a4wqcwd3n9odqwjeq8cdfqj1r8pd9oc3";
+	
+	userManager.failures = @{ userID_b: kStep_PubKey };
+	
+	NSDictionary<NSString*, ZDCUser*> *users = nil;
+	NSDictionary<NSString*, NSError*> *errors = nil;
+	[self fetchUsersWithIDs:@[ userID_a, userID_b, userID_c ] users:&users errors:&errors];
+	
+	XCTAssertEqualObjects([NSSet setWithArray:users.allKeys], ([NSSet setWithObjects:userID_a, userID_c, nil]));
+	XCTAssertEqualObjects(errors.allKeys, @[ userID_b ]);
+	
+	XCTAssertNotNil(users[userID_a].publicKeyID);
+	XCTAssertNotNil(users[userID_c].publicKeyID);
+	
+	XCTAssertNotNil([self databaseUserWithID:userID_a pubKey:NULL]);
+	XCTAssertNil([self databaseUserWithID:userID_b pubKey:NULL]);
+	XCTAssertNotNil([self databaseUserWithID:userID_c pubKey:NULL]);
+	
+	// The failed user is downloaded again (and fails the same way) when fetched individually
+	
+	ZDCUser *user = nil;
+	NSError *error = nil;
+	[self fetchUserWithID:userID_b user:&user error:&error];
+	
+	XCTAssertNil(user);
+	XCTAssertNotNil(error);
+	XCTAssertEqual([userManager fetchCountForStep:kStep_PubKey userID:userID_b], 2);
+}
+
+- (void)test_batch_sharesInFlightSingleFetch
+{
+	NSString *userID_a = @"kqkc1w9gawgkbxscr9tgmcz6mapz9gqc";
+	NSString *userID_b = @"w4xpbqjx5zrjnbc7t9mbwtko3ycpsjhd";
+	
+	userManager.heldUserIDs = [NSSet setWithObject:userID_a];
+	
+	XCTestExpectation *started_a = [self expectationWithDescription:@"started a"];
+	XCTestExpectation *started_b = [self expectationWithDescription:@"started b"];
+	
+	userManager.fetchStartedBlock = ^(NSString *userID){
+		if ([userID isEqualToString:userID_a]) [started_a fulfill];
+		if ([userID isEqualToString:userID_b]) [started_b fulfill];
+	};
+	
+	// Start the single fetch, and hold it in flight.
+	
+	__block ZDCUser *singleUser = nil;
+	XCTestExpectation *singleDone = [self expectationWithDescription:@"single"];
+	
+	[userManager fetchUserWithID: userID_a
+	                 requesterID: kLocalUserID
+	             completionQueue: dispatch_get_main_queue()
+	             completionBlock:^(ZDCUser *remoteUser, NSError *error)
+	{
+		singleUser = remoteUser;
+		[singleDone fulfill];
+	}];
+	
+	[self waitForExpectations:@[ started_a ] timeout:5.0];
+	
+	// The batch only downloads the user that isn't already in flight.
+	// Once that download has started, the batch is also waiting on the in-flight single fetch.
+	
+	__block NSDictionary<NSString*, ZDCUser*> *batchUsers = nil;
+	XCTestExpectation *batchDone = [self expectationWithDescription:@"batch"];
+	
+	[userManager fetchUsersWithIDs: @[ userID_a, userID_b ]
+	                   requesterID: kLocalUserID
+	               completionQueue: dispatch_get_main_queue()
+	               completionBlock:^(NSDictionary<NSString*, ZDCUser*> *remoteUsers,
+	                                 NSDictionary<NSString*, NSError*> *errors)
+	{
+		batchUsers = remoteUsers;
+		[batchDone fulfill];
+	}];
+	
+	[self waitForExpectations:@[ started_b ] timeout:5.0];
+	
+	[userManager releaseUserID:userID_a];
+	
+	[self waitForExpectations:@[ singleDone, batchDone ] timeout:5.0];
+	
+	XCTAssertNotNil(singleUser);
+	XCTAssertEqual(batchUsers.count, 2);
+	XCTAssertEqualObjects(batchUsers[userID_a].publicKeyID, singleUser.publicKeyID);
+	
+	XCTAssertEqual([userManager fetchCountForStep:kStep_User userID:userID_a], 1);
+	XCTAssertEqual([userManager fetchCountForStep:kStep_User userID:userID_b], 1);
+}
+
+@end
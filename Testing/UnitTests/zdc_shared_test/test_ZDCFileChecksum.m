@@ -12,6 +12,7 @@
 typedef NS_ENUM(NSInteger, ZDCFileChecksumTest) {
 	
 	ZDCFileChecksumTest_File,
+	ZDCFileChecksumTest_FileParallel,
 	ZDCFileChecksumTest_Stream
 };
 
@@ -37,8 +38,9 @@ typedef NS_ENUM(NSInteger, ZDCFileChecksumTest) {
 		@"Tiny File.txt"                         : @"0759b479c10bcd5eddfdfc4629b0f1888f2bfd65"
 	};
 	
-	[self _testType:ZDCFileChecksumTest_File   withAlgorithm:algorithm expected:expected];
-	[self _testType:ZDCFileChecksumTest_Stream withAlgorithm:algorithm expected:expected];
+	[self _testType:ZDCFileChecksumTest_File         withAlgorithm:algorithm expected:expected];
+	[self _testType:ZDCFileChecksumTest_FileParallel withAlgorithm:algorithm expected:expected];
+	[self _testType:ZDCFileChecksumTest_Stream       withAlgorithm:algorithm expected:expected];
 }
 
 - (void)test_SHA1_chunks
@@ -75,6 +77,13 @@ typedef NS_ENUM(NSInteger, ZDCFileChecksumTest) {
 	          range:nil
 	      chunkSize:@(chunkSize)
 	       expected:expected];
+
+	[self _testType:ZDCFileChecksumTest_FileParallel
+	  withAlgorithm:algorithm
+	           file:fileURL
+	          range:nil
+	      chunkSize:@(chunkSize)
+	       expected:expected];
 	
 	[self _testType:ZDCFileChecksumTest_Stream
 	  withAlgorithm:algorithm
@@ -152,6 +161,13 @@ typedef NS_ENUM(NSInteger, ZDCFileChecksumTest) {
 	      chunkSize:@(chunkSize)
 	       expected:expected];
 	
+	[self _testType:ZDCFileChecksumTest_FileParallel
+	  withAlgorithm:algorithm
+	           file:fileURL
+	          range:[NSValue valueWithRange:range]
+	      chunkSize:@(chunkSize)
+	       expected:expected];
+	
 	[self _testType:ZDCFileChecksumTest_Stream
 	  withAlgorithm:algorithm
 	           file:fileURL
@@ -203,8 +219,9 @@ typedef NS_ENUM(NSInteger, ZDCFileChecksumTest) {
 		@"Tiny File.txt"                         : @"c12de51b11fab773ce4f45558309b6f0"
 	};
 	
-	[self _testType:ZDCFileChecksumTest_File   withAlgorithm:algorithm expected:expected];
-	[self _testType:ZDCFileChecksumTest_Stream withAlgorithm:algorithm expected:expected];
+	[self _testType:ZDCFileChecksumTest_File         withAlgorithm:algorithm expected:expected];
+	[self _testType:ZDCFileChecksumTest_FileParallel withAlgorithm:algorithm expected:expected];
+	[self _testType:ZDCFileChecksumTest_Stream       withAlgorithm:algorithm expected:expected];
 }
 
 - (void)test_MD5_chunks
@@ -241,6 +258,13 @@ typedef NS_ENUM(NSInteger, ZDCFileChecksumTest) {
 	          range:nil
 	      chunkSize:@(chunkSize)
 	       expected:expected];
+
+	[self _testType:ZDCFileChecksumTest_FileParallel
+	  withAlgorithm:algorithm
+	           file:fileURL
+	          range:nil
+	      chunkSize:@(chunkSize)
+	       expected:expected];
 	
 	[self _testType:ZDCFileChecksumTest_Stream
 	  withAlgorithm:algorithm
@@ -318,6 +342,13 @@ typedef NS_ENUM(NSInteger, ZDCFileChecksumTest) {
 	      chunkSize:@(chunkSize)
 	       expected:expected];
 	
+	[self _testType:ZDCFileChecksumTest_FileParallel
+	  withAlgorithm:algorithm
+	           file:fileURL
+	          range:[NSValue valueWithRange:range]
+	      chunkSize:@(chunkSize)
+	       expected:expected];
+	
 	[self _testType:ZDCFileChecksumTest_Stream
 	  withAlgorithm:algorithm
 	           file:fileURL
@@ -352,6 +383,84 @@ typedef NS_ENUM(NSInteger, ZDCFileChecksumTest) {
 	}
 }
 
+- (void)test_parallel_multipleInstructions
+{
+	// The parallel mode must produce the exact same results as the sequential mode.
+	// Including the (somewhat subtle) chunk boundaries when multiple instructions have different ranges.
+	
+	NSURL *testFilesURL = [[NSBundle bundleForClass:[self class]] URLForResource:@"Test Files" withExtension:nil];
+	NSURL *fileURL = [testFilesURL URLByAppendingPathComponent:@"Declaration of Independence.jpg"];
+	
+	NSArray<NSArray *> *configs = @[
+		@[ @(kHASH_Algorithm_SHA256),   [NSNull null],                                        [NSNull null] ],
+		@[ @(kHASH_Algorithm_SHA1),     [NSNull null],                                        @(1024 * 256) ],
+		@[ @(kHASH_Algorithm_MD5),      [NSValue valueWithRange:NSMakeRange(12345, 800000)],  @(100000)     ],
+		@[ @(kHASH_Algorithm_SKEIN256), [NSValue valueWithRange:NSMakeRange(658764, 99999)],  [NSNull null] ],
+		@[ @(kHASH_Algorithm_xxHash64), [NSValue valueWithRange:NSMakeRange(999999, 65536)],  @(4096)       ],
+	];
+	
+	NSDictionary *sequential = [self _resultsForFile:fileURL configs:configs mode:ZDCFileChecksumMode_Sequential];
+	NSDictionary *parallel   = [self _resultsForFile:fileURL configs:configs mode:ZDCFileChecksumMode_Parallel];
+	
+	XCTAssert(sequential.count == configs.count);
+	XCTAssert([sequential isEqualToDictionary:parallel], @"Parallel results differ from sequential results");
+}
+
+/**
+ * Returns: instructionIndex -> array of lowercase hex checksums (ordered by chunkIndex).
+ */
+- (NSDictionary<NSNumber*, NSArray<NSString*>*> *)_resultsForFile:(NSURL *)fileURL
+                                                          configs:(NSArray<NSArray *> *)configs
+                                                             mode:(ZDCFileChecksumMode)mode
+{
+	dispatch_group_t group = dispatch_group_create();
+	dispatch_queue_t queue = dispatch_queue_create("", DISPATCH_QUEUE_SERIAL);
+	
+	NSMutableDictionary<NSNumber*, NSMutableArray<NSString*>*> *results = [NSMutableDictionary dictionary];
+	NSMutableArray<ZDCFileChecksumInstruction *> *instructions = [NSMutableArray array];
+	
+	[configs enumerateObjectsUsingBlock:^(NSArray *config, NSUInteger idx, BOOL *stop) {
+		
+		NSMutableArray<NSString*> *checksums = [NSMutableArray array];
+		results[@(idx)] = checksums;
+		
+		ZDCFileChecksumInstruction *instruction = [[ZDCFileChecksumInstruction alloc] init];
+		instruction.algorithm = (HASH_Algorithm)[config[0] integerValue];
+		instruction.range = (config[1] != [NSNull null]) ? config[1] : nil;
+		instruction.chunkSize = (config[2] != [NSNull null]) ? config[2] : nil;
+		instruction.callbackQueue = queue;
+		
+		dispatch_group_enter(group);
+		instruction.callbackBlock = ^(NSData *hash, uint64_t chunkIndex, BOOL done, NSError *error) {
+			
+			XCTAssert(error == nil);
+			
+			if (hash)
+			{
+				XCTAssert(chunkIndex == checksums.count);
+				[checksums addObject:[hash lowercaseHexString]];
+			}
+			
+			if (done) {
+				dispatch_group_leave(group);
+			}
+		};
+		
+		[instructions addObject:instruction];
+	}];
+	
+	NSError *error = nil;
+	[ZDCFileChecksum checksumFileURL: fileURL
+	                withInstructions: instructions
+	                            mode: mode
+	                           error: &error];
+	
+	XCTAssert(error == nil);
+	
+	dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+	return results;
+}
+
 - (void)_testType:(ZDCFileChecksumTest)testType
     withAlgorithm:(HASH_Algorithm)algorithm
          expected:(NSDictionary<NSString*, NSString*> *)expected
@@ -411,6 +520,14 @@ typedef NS_ENUM(NSInteger, ZDCFileChecksumTest) {
 		{
 			[ZDCFileChecksum checksumFileURL: fileURL
 			                withInstructions: @[instruction]
+			                            mode: ZDCFileChecksumMode_Sequential
+			                           error: &error];
+		}
+		else if (testType == ZDCFileChecksumTest_FileParallel)
+		{
+			[ZDCFileChecksum checksumFileURL: fileURL
+			                withInstructions: @[instruction]
+			                            mode: ZDCFileChecksumMode_Parallel
 			                           error: &error];
 		}
 		else
@@ -487,6 +604,14 @@ typedef NS_ENUM(NSInteger, ZDCFileChecksumTest) {
 	{
 		[ZDCFileChecksum checksumFileURL: fileURL
 		                withInstructions: @[instruction]
+		                            mode: ZDCFileChecksumMode_Sequential
+		                           error: &error];
+	}
+	else if (testType == ZDCFileChecksumTest_FileParallel)
+	{
+		[ZDCFileChecksum checksumFileURL: fileURL
+		                withInstructions: @[instruction]
+		                            mode: ZDCFileChecksumMode_Parallel
 		                           error: &error];
 	}
 	else
@@ -84,6 +84,33 @@ NS_ASSUME_NONNULL_BEGIN
                                   region:(AWSRegion)region
                         outUrlComponents:(NSURLComponents *_Nonnull *_Nullable)outUrlComponents;
 
+/**
+ * Generates an UploadPartCopy request.
+ * That is, the content of the part is copied server-side from an existing object (or a range within it),
+ * instead of being uploaded by the client.
+ *
+ * AWS Docs: https://docs.aws.amazon.com/AmazonS3/latest/API/API_UploadPartCopy.html
+ *
+ * @param srcPath
+ *   The key of the existing object (within the same bucket).
+ *
+ * @param srcRange
+ *   The byte range (within the existing object) to copy.
+ *
+ * @param srcETag
+ *   If non-nil, the copy is only performed if the existing object still has this eTag.
+ *   Otherwise S3 responds with 412 (Precondition Failed).
+ */
++ (NSMutableURLRequest *)multipartCopy:(NSString *)key
+                          withUploadID:(NSString *)uploadID
+                                  part:(NSUInteger)partNumber
+                            fromSource:(NSString *)srcPath
+                                 range:(NSRange)srcRange
+                               ifMatch:(nullable NSString *)srcETag
+                              inBucket:(NSString *)bucket
+                                region:(AWSRegion)region
+                      outUrlComponents:(NSURLComponents *_Nonnull *_Nullable)outUrlComponents;
+
 + (NSMutableURLRequest *)multipartComplete:(NSString *)key
                               withUploadID:(NSString *)uploadID
                                      eTags:(NSArray<NSString*> *)eTags
@@ -291,6 +291,40 @@
 	                    outUrlComponents:outUrlComponents];
 }
 
++ (NSMutableURLRequest *)multipartCopy:(NSString *)key
+                          withUploadID:(NSString *)uploadID
+                                  part:(NSUInteger)partNumber
+                            fromSource:(NSString *)srcPath
+                                 range:(NSRange)srcRange
+                               ifMatch:(NSString *)srcETag
+                              inBucket:(NSString *)bucket
+                                region:(AWSRegion)region
+                      outUrlComponents:(NSURLComponents **)outUrlComponents
+{
+	NSMutableURLRequest *request =
+	  [self multipartUpload: key
+	           withUploadID: uploadID
+	                   part: partNumber
+	               inBucket: bucket
+	                 region: region
+	       outUrlComponents: outUrlComponents];
+	
+	NSString *src = [[@"/" stringByAppendingString:bucket] stringByAppendingPathComponent:srcPath];
+	[request setValue:src forHTTPHeaderField:@"x-amz-copy-source"];
+	
+	// Note: the range is inclusive (just like the standard HTTP Range header)
+	NSString *range = [NSString stringWithFormat:@"bytes=%llu-%llu",
+	  (unsigned long long)srcRange.location,
+	  (unsigned long long)(NSMaxRange(srcRange) - 1)];
+	[request setValue:range forHTTPHeaderField:@"x-amz-copy-source-range"];
+	
+	if (srcETag) {
+		[request setValue:srcETag forHTTPHeaderField:@"x-amz-copy-source-if-match"];
+	}
+	
+	return request;
+}
+
 + (NSMutableURLRequest *)multipartComplete:(NSString *)key
                               withUploadID:(NSString *)uploadID
                                      eTags:(NSArray<NSString*> *)eTags
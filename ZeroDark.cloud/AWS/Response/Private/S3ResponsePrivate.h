@@ -9,6 +9,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (nonatomic, strong, readwrite) S3Response_ListBucket *listBucket;
 @property (nonatomic, strong, readwrite) S3Response_InitiateMultipartUpload *initiateMultipartUpload;
+@property (nonatomic, strong, readwrite) S3Response_UploadPartCopy *uploadPartCopy;
 
 @end
 
@@ -46,6 +47,17 @@ NS_ASSUME_NONNULL_BEGIN
 #pragma mark -
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+@interface S3Response_UploadPartCopy ()
+
+@property (nonatomic, readwrite, copy, nullable) NSString *eTag;
+@property (nonatomic, readwrite, copy, nullable) NSDate *lastModified;
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 @interface S3ObjectInfo ()
 
 @property (nonatomic, readwrite, copy, nullable) NSString *key;
@@ -2,12 +2,14 @@
 
 #import "S3Response_ListBucket.h"
 #import "S3Response_InitiateMultipartUpload.h"
+#import "S3Response_UploadPartCopy.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
 typedef NS_ENUM(NSInteger, S3ResponseType) {
 	S3ResponseType_ListBucket,
 	S3ResponseType_InitiateMultipartUpload,
+	S3ResponseType_UploadPartCopy,
 	
 	S3ResponseType_Unknown = NSIntegerMax
 };
@@ -19,6 +21,7 @@ typedef NS_ENUM(NSInteger, S3ResponseType) {
 
 @property (nonatomic, readonly) S3Response_ListBucket *listBucket;
 @property (nonatomic, readonly) S3Response_InitiateMultipartUpload *initiateMultipartUpload;
+@property (nonatomic, readonly) S3Response_UploadPartCopy *uploadPartCopy;
 
 @end
 
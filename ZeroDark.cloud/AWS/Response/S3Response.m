@@ -8,12 +8,14 @@ static int const kCurrentVersion = 0;
 static NSString *const k_version                 = @"version";
 static NSString *const k_listBucket              = @"listBucket";
 static NSString *const k_initiateMultipartUpload = @"initiateMultipartUpload";
+static NSString *const k_uploadPartCopy          = @"uploadPartCopy";
 
 
 @implementation S3Response
 
 @synthesize listBucket = listBucket;
 @synthesize initiateMultipartUpload = initiateMultipartUpload;
+@synthesize uploadPartCopy = uploadPartCopy;
 
 - (id)initWithCoder:(NSCoder *)decoder
 {
@@ -21,6 +23,7 @@ static NSString *const k_initiateMultipartUpload = @"initiateMultipartUpload";
 	{
 		listBucket = [decoder decodeObjectForKey:k_listBucket];
 		initiateMultipartUpload = [decoder decodeObjectForKey:k_initiateMultipartUpload];
+		uploadPartCopy = [decoder decodeObjectForKey:k_uploadPartCopy];
 	}
 	return self;
 }
@@ -33,6 +36,7 @@ static NSString *const k_initiateMultipartUpload = @"initiateMultipartUpload";
 	
 	[coder encodeObject:listBucket forKey:k_listBucket];
 	[coder encodeObject:initiateMultipartUpload forKey:k_initiateMultipartUpload];
+	[coder encodeObject:uploadPartCopy forKey:k_uploadPartCopy];
 }
 
 - (id)copyWithZone:(NSZone *)zone
@@ -41,6 +45,7 @@ static NSString *const k_initiateMultipartUpload = @"initiateMultipartUpload";
 	
 	copy->listBucket = [listBucket copy];
 	copy->initiateMultipartUpload = [initiateMultipartUpload copy];
+	copy->uploadPartCopy = [uploadPartCopy copy];
 	
 	return copy;
 }
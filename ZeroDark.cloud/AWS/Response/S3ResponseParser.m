@@ -32,6 +32,10 @@
 		{
 			result = [self parseDict_InitiateMultipartUploadResult:dict];
 		}
+		else if ([type isEqualToString:@"CopyPartResult"])
+		{
+			result = [self parseDict_CopyPartResult:dict];
+		}
 	}
 	
 	return result;
@@ -64,6 +68,10 @@
 	{
 		result = [self parseDict_InitiateMultipartUploadResult:dict];
 	}
+	else if (type == S3ResponseType_UploadPartCopy)
+	{
+		result = [self parseDict_CopyPartResult:dict];
+	}
 	
 	return result;
 }
@@ -229,6 +237,42 @@
 	return response;
 }
 
+// PUT /key?partNumber=N&uploadId=X (with x-amz-copy-source header)
+//
+//   <?xml version="1.0" encoding="UTF-8"?>
+//   <CopyPartResult>
+//     <LastModified>2019-09-27T16:02:45.000Z</LastModified>
+//     <ETag>&quot;b54357faf0632cce46e942fa68356b38&quot;</ETag>
+//   </CopyPartResult>
+
++ (S3Response *)parseDict_CopyPartResult:(NSDictionary *)dict
+{
+	S3Response_UploadPartCopy *result = [[S3Response_UploadPartCopy alloc] init];
+	
+	id value;
+	
+	value = dict[@"ETag"];
+	if (value && [value isKindOfClass:[NSString class]])
+	{
+		NSString *eTag = [(NSString *)value stringByRemovingPercentEncoding];
+		
+		NSCharacterSet *quotes = [NSCharacterSet characterSetWithCharactersInString:@"\""];
+		result.eTag = [eTag stringByTrimmingCharactersInSet:quotes];
+	}
+	
+	value = dict[@"LastModified"];
+	if (value && [value isKindOfClass:[NSString class]])
+	{
+		result.lastModified = [AWSDate parseISO8601Timestamp:(NSString *)value];
+	}
+	
+	S3Response *response = [[S3Response alloc] init];
+	response.type = S3ResponseType_UploadPartCopy;
+	response.uploadPartCopy = result;
+	
+	return response;
+}
+
 + (nullable S3ObjectInfo *)parseObjectInfo:(NSDictionary *)dict
 {
 	id value = nil;
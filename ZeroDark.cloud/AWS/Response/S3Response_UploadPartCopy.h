@@ -0,0 +1,9 @@
+#import <Foundation/Foundation.h>
+
+
+@interface S3Response_UploadPartCopy : NSObject <NSCoding, NSCopying>
+
+@property (nonatomic, readonly, copy, nullable) NSString *eTag;
+@property (nonatomic, readonly, copy, nullable) NSDate *lastModified;
+
+@end
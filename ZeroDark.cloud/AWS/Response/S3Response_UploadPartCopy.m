@@ -0,0 +1,48 @@
+#import "S3Response_UploadPartCopy.h"
+#import "S3ResponsePrivate.h" // For readwrite properties
+
+
+static int const kCurrentVersion = 0;
+#pragma unused(kCurrentVersion)
+
+static NSString *const k_version      = @"version";
+static NSString *const k_eTag         = @"eTag";
+static NSString *const k_lastModified = @"lastModified";
+
+
+@implementation S3Response_UploadPartCopy
+
+@synthesize eTag = eTag;
+@synthesize lastModified = lastModified;
+
+- (id)initWithCoder:(NSCoder *)decoder
+{
+	if ((self = [super init]))
+	{
+		eTag         = [decoder decodeObjectForKey:k_eTag];
+		lastModified = [decoder decodeObjectForKey:k_lastModified];
+	}
+	return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder
+{
+	if (kCurrentVersion != 0) {
+		[coder encodeInt:kCurrentVersion forKey:@"version"];
+	}
+	
+	[coder encodeObject:eTag         forKey:k_eTag];
+	[coder encodeObject:lastModified forKey:k_lastModified];
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+	S3Response_UploadPartCopy *copy = [[[self class] alloc] init];
+	
+	copy->eTag         = eTag;
+	copy->lastModified = lastModified;
+	
+	return copy;
+}
+
+@end
@@ -20,11 +20,37 @@ NS_ASSUME_NONNULL_BEGIN
  * 
  * Detailed information about the smart contract can be found here:
  * https://zerodarkcloud.readthedocs.io/en/latest/overview/ethereum/
+ *
+ * Queries that arrive close together (e.g. when verifying many users at once)
+ * are combined into a single JSON-RPC batch request, sent over a shared (keep-alive) session.
+ * Results are cached per userID for `merkleTreeRootCacheTTL` seconds. Errors are never cached.
  */
 +  (void)fetchMerkleTreeRootForUserID:(NSString *)userID
                       completionQueue:(nullable dispatch_queue_t)completionQueue
                       completionBlock:(void (^)(NSError *error, NSString *merkleTreeRoot))completionBlock;
 
+/**
+ * The JSON-RPC endpoint that's queried.
+ * Defaults to Infura (ethereum mainnet). Set to nil to restore the default.
+ *
+ * This can be pointed at a local JSON-RPC node (or stub) for testing.
+ * Changing the URL flushes the cache.
+ */
++ (NSURL *)rpcURL;
++ (void)setRPCURL:(nullable NSURL *)url;
+
+/**
+ * How long (in seconds) a fetched merkleTreeRoot is cached.
+ * The default value is 5 minutes. Set to zero to disable caching.
+ */
++ (NSTimeInterval)merkleTreeRootCacheTTL;
++ (void)setMerkleTreeRootCacheTTL:(NSTimeInterval)ttl;
+
+/**
+ * Removes all cached merkleTreeRoot values.
+ */
++ (void)flushMerkleTreeRootCache;
+
 @end
 
 NS_ASSUME_NONNULL_END
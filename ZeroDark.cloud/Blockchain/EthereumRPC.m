@@ -7,7 +7,7 @@
  * API Reference : https://apis.zerodark.cloud
  **/
 
-#import "EthereumRPC.h"
+#import "EthereumRPCPrivate.h"
 
 #import "ZDCAsyncCompletionDispatch.h"
 #import "ZDCUserPrivate.h"
@@ -26,19 +26,174 @@ static NSString *const CONTRACT_ADDRESS_V3 = @"0x997715D0eb47A50D7521ed0D2D02362
 
 static NSString *const EMPTY_MERKLE_TREE_ROOT = @"0000000000000000000000000000000000000000000000000000000000000000";
 
+static NSString *const DEFAULT_RPC_URL = @"https://mainnet.infura.io/94cbbe9f44574c19af2335390473a778";
+
+static NSTimeInterval const kDefaultMerkleTreeRootCacheTTL = (60 * 5); // in seconds
+
+static NSTimeInterval const kBatchCoalesceInterval = 0.05; // in seconds
+static NSUInteger const kMaxBatchSize = 32;
+
+/**
+ * Cached result of a merkleTreeRoot query.
+ */
+@interface EthereumRPCCacheItem : NSObject
+
+@property (nonatomic, copy, readwrite) NSString *merkleTreeRoot;
+@property (nonatomic, strong, readwrite) NSDate *timestamp;
+
+@end
+
+@implementation EthereumRPCCacheItem
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 @implementation EthereumRPC
 
 static ZDCAsyncCompletionDispatch *pendingRequests;
 
+// All of the following variables are protected by the rpcQueue.
+static dispatch_queue_t rpcQueue;
+static NSURL *rpcURL;
+static NSTimeInterval merkleTreeRootCacheTTL;
+static NSMutableDictionary<NSString*, EthereumRPCCacheItem*> *merkleTreeRootCache;
+static NSMutableArray<NSString*> *batchedUserIDs;
+static BOOL isBatchScheduled;
+static NSURLSession *session;
+
 + (void)initialize
 {
 	static dispatch_once_t onceToken;
 	dispatch_once(&onceToken, ^{
 		
 		pendingRequests = [[ZDCAsyncCompletionDispatch alloc] init];
+		
+		rpcQueue = dispatch_queue_create("EthereumRPC", DISPATCH_QUEUE_SERIAL);
+		rpcURL = [NSURL URLWithString:DEFAULT_RPC_URL];
+		merkleTreeRootCacheTTL = kDefaultMerkleTreeRootCacheTTL;
+		merkleTreeRootCache = [[NSMutableDictionary alloc] init];
+		batchedUserIDs = [[NSMutableArray alloc] init];
+		
+		// A single long-lived session.
+		// This allows the underlying connection to be kept alive & reused,
+		// instead of performing a new TCP/TLS handshake for every query.
+		
+		session = [NSURLSession sessionWithConfiguration:[self defaultSessionConfiguration]];
 	});
 }
 
++ (NSURLSessionConfiguration *)defaultSessionConfiguration
+{
+	NSURLSessionConfiguration *sessionConfig = [NSURLSessionConfiguration ephemeralSessionConfiguration];
+	sessionConfig.HTTPMaximumConnectionsPerHost = 2;
+	sessionConfig.HTTPCookieStorage = nil;
+	sessionConfig.URLCache = nil;
+	sessionConfig.requestCachePolicy = NSURLRequestReloadIgnoringLocalCacheData;
+	
+	return sessionConfig;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Configuration
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * See header file for description.
+ */
++ (NSURL *)rpcURL
+{
+	__block NSURL *result = nil;
+	dispatch_sync(rpcQueue, ^{
+		result = rpcURL;
+	});
+	
+	return result;
+}
+
+/**
+ * See header file for description.
+ */
++ (void)setRPCURL:(NSURL *)url
+{
+	NSURL *newURL = [url copy] ?: [NSURL URLWithString:DEFAULT_RPC_URL];
+	
+	dispatch_sync(rpcQueue, ^{
+		
+		if (![rpcURL isEqual:newURL])
+		{
+			rpcURL = newURL;
+			
+			// Cached values came from a different node (or network).
+			[merkleTreeRootCache removeAllObjects];
+		}
+	});
+}
+
+/**
+ * See header file for description.
+ */
++ (NSTimeInterval)merkleTreeRootCacheTTL
+{
+	__block NSTimeInterval result = 0;
+	dispatch_sync(rpcQueue, ^{
+		result = merkleTreeRootCacheTTL;
+	});
+	
+	return result;
+}
+
+/**
+ * See header file for description.
+ */
++ (void)setMerkleTreeRootCacheTTL:(NSTimeInterval)ttl
+{
+	dispatch_sync(rpcQueue, ^{
+		
+		merkleTreeRootCacheTTL = MAX(ttl, 0);
+		if (merkleTreeRootCacheTTL == 0) {
+			[merkleTreeRootCache removeAllObjects];
+		}
+	});
+}
+
+/**
+ * See header file for description.
+ */
++ (void)flushMerkleTreeRootCache
+{
+	dispatch_sync(rpcQueue, ^{
+		[merkleTreeRootCache removeAllObjects];
+	});
+}
+
+/**
+ * See header file for description.
+ */
++ (void)setSessionConfiguration:(NSURLSessionConfiguration *)sessionConfig
+{
+	NSURLSession *newSession =
+	  [NSURLSession sessionWithConfiguration:(sessionConfig ?: [self defaultSessionConfiguration])];
+	
+	__block NSURLSession *oldSession = nil;
+	dispatch_sync(rpcQueue, ^{
+		
+		oldSession = session;
+		session = newSession;
+	});
+	
+	// Allows in-flight tasks to complete
+	[oldSession finishTasksAndInvalidate];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Public API
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * See header file for description.
+ */
 + (void)fetchMerkleTreeRootForUserID:(NSString *)inUserID
                      completionQueue:(dispatch_queue_t)inCompletionQueue
                      completionBlock:(void (^)(NSError *error, NSString *merkleTreeRoot))inCompletionBlock
@@ -65,6 +220,30 @@ static ZDCAsyncCompletionDispatch *pendingRequests;
 	
 	NSString *userID = [inUserID copy]; // mutable string protection
 	
+	// Check the cache
+	
+	__block EthereumRPCCacheItem *cacheItem = nil;
+	dispatch_sync(rpcQueue, ^{
+		
+		cacheItem = merkleTreeRootCache[userID];
+		if (cacheItem && (-[cacheItem.timestamp timeIntervalSinceNow] >= merkleTreeRootCacheTTL))
+		{
+			[merkleTreeRootCache removeObjectForKey:userID];
+			cacheItem = nil;
+		}
+	});
+	
+	if (cacheItem)
+	{
+		NSString *merkleTreeRoot = cacheItem.merkleTreeRoot;
+		
+		dispatch_async(inCompletionQueue ?: dispatch_get_main_queue(), ^{ @autoreleasepool {
+			
+			inCompletionBlock(nil, merkleTreeRoot);
+		}});
+		return;
+	}
+	
 	// Network request consolidation
 	
 	NSUInteger requestCount =
@@ -79,41 +258,204 @@ static ZDCAsyncCompletionDispatch *pendingRequests;
 		return;
 	}
 
-	void (^completionBlock)(NSError*, NSString*) = ^(NSError *error, NSString *merkleTreeRoot) {
+	// Request batching:
+	//
+	// When many users are being verified at once (e.g. ZDCUserManager refreshing several users),
+	// we combine their queries into a single JSON-RPC batch request.
 		
-		if ([merkleTreeRoot isEqualToString:EMPTY_MERKLE_TREE_ROOT]) {
-			merkleTreeRoot = nil;
-		}
+	dispatch_async(rpcQueue, ^{ @autoreleasepool {
 		
-		NSArray<dispatch_queue_t> * completionQueues = nil;
-		NSArray<id>               * completionBlocks = nil;
-		[pendingRequests popCompletionQueues: &completionQueues
-		                    completionBlocks: &completionBlocks
-		                              forKey: userID];
+		[batchedUserIDs addObject:userID];
 		
-		for (NSUInteger i = 0; i < completionBlocks.count; i++)
+		if (batchedUserIDs.count >= kMaxBatchSize)
 		{
-			dispatch_queue_t completionQueue = completionQueues[i];
-			void (^completionBlock)(NSError*, NSString*) = completionBlocks[i];
+			[self flushBatch];
+		}
+		else if (!isBatchScheduled)
+		{
+			isBatchScheduled = YES;
 			
-			dispatch_async(completionQueue, ^{ @autoreleasepool {
+			dispatch_time_t delay = dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kBatchCoalesceInterval * NSEC_PER_SEC));
+			dispatch_after(delay, rpcQueue, ^{ @autoreleasepool {
 				
-				completionBlock(error, merkleTreeRoot);
+				[self flushBatch];
 			}});
 		}
-	};
+	}});
+}
+
+/**
+ * Sends all the batched queries.
+ * Must be invoked on the rpcQueue.
+ */
++ (void)flushBatch
+{
+	isBatchScheduled = NO;
 	
-	// Send network request
+	while (batchedUserIDs.count > 0)
+	{
+		NSRange range = NSMakeRange(0, MIN(batchedUserIDs.count, kMaxBatchSize));
+		
+		NSArray<NSString *> *userIDs = [batchedUserIDs subarrayWithRange:range];
+		[batchedUserIDs removeObjectsInRange:range];
+		
+		[self fetchMerkleTreeRootsForUserIDs:userIDs url:rpcURL];
+	}
+}
+
+/**
+ * Invokes all the pending completionBlocks for the given userID.
+ */
++ (void)finishRequestForUserID:(NSString *)userID
+                         error:(NSError *)error
+                merkleTreeRoot:(NSString *)merkleTreeRoot
+{
+	if ([merkleTreeRoot isEqualToString:EMPTY_MERKLE_TREE_ROOT]) {
+		merkleTreeRoot = nil;
+	}
 	
-	NSString *userIDHex = [[NSData dataFromZBase32String:userID] lowercaseHexString];
+	if (error == nil)
+	{
+		dispatch_async(rpcQueue, ^{ @autoreleasepool {
+			
+			if (merkleTreeRootCacheTTL > 0)
+			{
+				EthereumRPCCacheItem *cacheItem = [[EthereumRPCCacheItem alloc] init];
+				cacheItem.merkleTreeRoot = merkleTreeRoot;
+				cacheItem.timestamp = [NSDate date];
+				
+				merkleTreeRootCache[userID] = cacheItem;
+			}
+		}});
+	}
 	
-#if (ETHEREUM_CONTRACT_VERSION == 3)
-	[self v3_fetchMerkleTreeRootForUserIDHex:userIDHex completionBlock:completionBlock];
-#elif (ETHEREUM_CONTRACT_VERSION == 2)
-	[self v2_fetchMerkleTreeRootForUserIDHex:userIDHex completionBlock:completionBlock];
-#else
-	#error ETHEREUM_CONTRACT_VERSION has invalid version number !
-#endif
+	NSArray<dispatch_queue_t> * completionQueues = nil;
+	NSArray<id>               * completionBlocks = nil;
+	[pendingRequests popCompletionQueues: &completionQueues
+	                    completionBlocks: &completionBlocks
+	                              forKey: userID];
+	
+	for (NSUInteger i = 0; i < completionBlocks.count; i++)
+	{
+		dispatch_queue_t completionQueue = completionQueues[i];
+		void (^completionBlock)(NSError*, NSString*) = completionBlocks[i];
+			
+		dispatch_async(completionQueue, ^{ @autoreleasepool {
+				
+			completionBlock(error, merkleTreeRoot);
+		}});
+	}
+}
+	
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Batch
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Sends a single JSON-RPC batch request, containing an eth_call for each userID.
+ */
++ (void)fetchMerkleTreeRootsForUserIDs:(NSArray<NSString *> *)userIDs url:(NSURL *)url
+{
+	NSMutableArray<NSDictionary *> *body_json = [NSMutableArray arrayWithCapacity:userIDs.count];
+	
+	[userIDs enumerateObjectsUsingBlock:^(NSString *userID, NSUInteger idx, BOOL *stop) {
+	
+		NSString *userIDHex = [[NSData dataFromZBase32String:userID] lowercaseHexString];
+	
+	#if (ETHEREUM_CONTRACT_VERSION == 3)
+		NSArray *eth_call_params = [self v3_callParamsForUserIDHex:userIDHex];
+	#elif (ETHEREUM_CONTRACT_VERSION == 2)
+		NSArray *eth_call_params = [self v2_callParamsForUserIDHex:userIDHex];
+	#else
+		#error ETHEREUM_CONTRACT_VERSION has invalid version number !
+	#endif
+		
+		[body_json addObject:@{
+			@"jsonrpc" : @"2.0",
+			@"method"  : @"eth_call",
+			@"id"      : @(idx),
+			@"params"  : eth_call_params,
+		}];
+	}];
+	
+	[self sendRequestWithBody: body_json
+	                      url: url
+	          completionBlock:^(NSData *data, NSURLResponse *response, NSError *error)
+	{
+		NSMutableDictionary<NSNumber*, NSString*> *results = [NSMutableDictionary dictionaryWithCapacity:userIDs.count];
+		NSMutableDictionary<NSNumber*, NSError*> *errors = [NSMutableDictionary dictionary];
+		
+		if (data && !error)
+		{
+			id obj = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+			
+			// Per the JSON-RPC 2.0 spec, a batch response is an array of response objects (in any order).
+			// However, if the server can't process the batch as a whole, it returns a single response object.
+			
+			if ([obj isKindOfClass:[NSDictionary class]]) {
+				obj = @[ obj ];
+			}
+			
+			if ([obj isKindOfClass:[NSArray class]])
+			{
+				for (id item in (NSArray *)obj)
+				{
+					if (![item isKindOfClass:[NSDictionary class]]) continue;
+					NSDictionary *dict = (NSDictionary *)item;
+					
+					NSNumber *rpcID = dict[@"id"];
+					if (![rpcID isKindOfClass:[NSNumber class]]) continue;
+					
+					NSString *result = dict[@"result"];
+					if ([result isKindOfClass:[NSString class]])
+					{
+						NSData *resultData = [NSData dataFromHexString:result];
+						if (resultData)
+						{
+						#if (ETHEREUM_CONTRACT_VERSION == 3)
+							NSString *merkleTreeRoot = [self v3_merkleTreeRootFromResponse:resultData];
+						#elif (ETHEREUM_CONTRACT_VERSION == 2)
+							NSString *merkleTreeRoot = [self v2_merkleTreeRootFromResponse:resultData];
+						#endif
+							if (merkleTreeRoot) {
+								results[rpcID] = merkleTreeRoot;
+							}
+						}
+					}
+					else if (dict[@"error"])
+					{
+						NSString *message = nil;
+						
+						NSDictionary *rpcError = dict[@"error"];
+						if ([rpcError isKindOfClass:[NSDictionary class]] &&
+						    [rpcError[@"message"] isKindOfClass:[NSString class]])
+						{
+							message = rpcError[@"message"];
+						}
+						
+						errors[rpcID] = [self errorWithDescription:(message ?: @"JSON-RPC error")];
+					}
+				}
+			}
+		}
+		
+		[userIDs enumerateObjectsUsingBlock:^(NSString *userID, NSUInteger idx, BOOL *stop) {
+			
+			NSString *merkleTreeRoot = results[@(idx)];
+			NSError *itemError = error ?: errors[@(idx)];
+			
+			if (!itemError && !merkleTreeRoot)
+			{
+				// Don't confuse a bad response with a missing blockchain entry (which gets cached).
+				itemError = [self errorWithDescription:@"Invalid response from JSON-RPC server"];
+			}
+			if (itemError) {
+				merkleTreeRoot = nil;
+			}
+			
+			[self finishRequestForUserID:userID error:itemError merkleTreeRoot:merkleTreeRoot];
+		}];
+	}];
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -121,11 +463,12 @@ static ZDCAsyncCompletionDispatch *pendingRequests;
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #if (ETHEREUM_CONTRACT_VERSION == 2)
 
-+ (void)v2_fetchMerkleTreeRootForUserIDHex:(NSString *)userIDHex
-                           completionBlock:(void (^)(NSError *error, NSString *merkleTreeRoot))completionBlock
+/**
+ * Returns the params for an eth_call that queries the merkleTreeRoot of the given user.
+ */
++ (NSArray *)v2_callParamsForUserIDHex:(NSString *)userIDHex
 {
 	NSParameterAssert(userIDHex != nil);
-	NSParameterAssert(completionBlock != nil);
 	
 	NSData *transactionData = [self v2_transactionDataForUserIDHex:userIDHex];
 	
@@ -142,38 +485,7 @@ static ZDCAsyncCompletionDispatch *pendingRequests;
 		@"latest"
 	];
 	
-	NSDictionary *body_json = @{
-		@"jsonrpc" : @"2.0",
-		@"method"  : @"eth_call",
-		@"id"      : @(1),
-		@"params"  : eth_call_params,
-	};
-	
-	[self sendRequestWithBody: body_json
-	          completionBlock:^(NSData *data, NSURLResponse *response, NSError *error)
-	{
-		NSString *merkleTreeRoot = nil;
-		if (data)
-		{
-			id obj = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
-			if ([obj isKindOfClass:[NSDictionary class]])
-			{
-				NSDictionary *dict = (NSDictionary *)obj;
-				
-				NSString *result = dict[@"result"];
-				if ([result isKindOfClass:[NSString class]])
-				{
-					NSData *resultData = [NSData dataFromHexString:result];
-					if (resultData)
-					{
-						merkleTreeRoot = [self v2_merkleTreeRootFromResponse:resultData];
-					}
-				}
-			}
-		}
-		
-		completionBlock(error, merkleTreeRoot);
-	}];
+	return eth_call_params;
 }
 
 + (NSData *)v2_transactionDataForUserIDHex:(NSString *)userIDHex
@@ -289,11 +601,12 @@ static ZDCAsyncCompletionDispatch *pendingRequests;
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #if (ETHEREUM_CONTRACT_VERSION == 3)
 
-+ (void)v3_fetchMerkleTreeRootForUserIDHex:(NSString *)userIDHex
-                        completionBlock:(void (^)(NSError *error, NSString *merkleTreeRoot))completionBlock
+/**
+ * Returns the params for an eth_call that queries the merkleTreeRoot of the given user.
+ */
++ (NSArray *)v3_callParamsForUserIDHex:(NSString *)userIDHex
 {
 	NSParameterAssert(userIDHex != nil);
-	NSParameterAssert(completionBlock != nil);
 	
 	NSData *transactionData = [self v3_transactionDataForUserIDHex:userIDHex];
 	
@@ -310,38 +623,7 @@ static ZDCAsyncCompletionDispatch *pendingRequests;
 		@"latest"
 	];
 	
-	NSDictionary *body_json = @{
-		@"jsonrpc" : @"2.0",
-		@"method"  : @"eth_call",
-		@"id"      : @(1),
-		@"params"  : eth_call_params,
-	};
-	
-	[self sendRequestWithBody: body_json
-	          completionBlock:^(NSData *data, NSURLResponse *response, NSError *error)
-	{
-		NSString *merkleTreeRoot = nil;
-		if (data)
-		{
-			id obj = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
-			if ([obj isKindOfClass:[NSDictionary class]])
-			{
-				NSDictionary *dict = (NSDictionary *)obj;
-				
-				NSString *result = dict[@"result"];
-				if ([result isKindOfClass:[NSString class]])
-				{
-					NSData *resultData = [NSData dataFromHexString:result];
-					if (resultData)
-					{
-						merkleTreeRoot = [self v3_merkleTreeRootFromResponse:resultData];
-					}
-				}
-			}
-		}
-		
-		completionBlock(error, merkleTreeRoot);
-	}];
+	return eth_call_params;
 }
 
 + (NSData *)v3_transactionDataForUserIDHex:(NSString *)userIDHex
@@ -412,7 +694,11 @@ static ZDCAsyncCompletionDispatch *pendingRequests;
 #pragma mark HTTPS
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-+ (void)sendRequestWithBody:(NSDictionary *)body_json
+/**
+ * Must be invoked on the rpcQueue.
+ */
++ (void)sendRequestWithBody:(id)body_json
+                        url:(NSURL *)url
             completionBlock:(void (^)(NSData *data, NSURLResponse *response, NSError *error))completionBlock
 {
 	NSError *error = nil;
@@ -425,18 +711,11 @@ static ZDCAsyncCompletionDispatch *pendingRequests;
 		return;
 	}
 	
-	NSString *const accessToken = @"94cbbe9f44574c19af2335390473a778";
-	NSString *const urlStr = [NSString stringWithFormat:@"https://mainnet.infura.io/%@", accessToken];
-	
-	NSURL *url = [NSURL URLWithString:urlStr];
-	
 	NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
 	[request setHTTPMethod:@"POST"];
+	[request setValue:@"application/json" forHTTPHeaderField:@"Content-Type"];
 	[request setHTTPBody:body_data];
 	
-	NSURLSessionConfiguration *sessionConfig = [NSURLSessionConfiguration ephemeralSessionConfiguration];
-	NSURLSession *session = [NSURLSession sessionWithConfiguration:sessionConfig];
-	
 	NSURLSessionDataTask *task = [session dataTaskWithRequest:request completionHandler:completionBlock];
 	[task resume];
 }
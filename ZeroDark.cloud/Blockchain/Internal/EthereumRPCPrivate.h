@@ -0,0 +1,27 @@
+/**
+ * ZeroDark.cloud
+ *
+ * Homepage      : https://www.zerodark.cloud
+ * GitHub        : https://github.com/4th-ATechnologies/ZeroDark.cloud
+ * Documentation : https://zerodarkcloud.readthedocs.io/en/latest/
+ * API Reference : https://apis.zerodark.cloud
+**/
+
+#import "EthereumRPC.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface EthereumRPC ()
+
+/**
+ * Replaces the shared session with one created from the given configuration.
+ * Pass nil to restore the default configuration.
+ *
+ * Used by the unit tests to install a stub NSURLProtocol
+ * (custom sessions ignore protocols registered via `+[NSURLProtocol registerClass:]`).
+ */
++ (void)setSessionConfiguration:(nullable NSURLSessionConfiguration *)sessionConfig;
+
+@end
+
+NS_ASSUME_NONNULL_END
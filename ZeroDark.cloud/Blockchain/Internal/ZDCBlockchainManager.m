@@ -182,7 +182,7 @@
 			}
 			
 			NSError *verifyError = nil;
-			BOOL isVerified = [merkleTree hashAndVerify:&verifyError];
+			BOOL isVerified = [merkleTree verifyProofForUserID:userID error:&verifyError];
 			
 			if (!isVerified || verifyError)
 			{
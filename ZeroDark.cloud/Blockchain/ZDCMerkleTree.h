@@ -33,6 +33,17 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (BOOL)hashAndVerify:(NSError *_Nullable *_Nullable)outError;
 
+/**
+ * Verifies that the given user's entry is included in the tree.
+ *
+ * Rather than rebuilding the entire tree, this method only hashes the nodes along the path
+ * from the user's leaf to the root (i.e. log(n) hashes), and verifies each one against the file.
+ * It then verifies that the path ends at the root hash value.
+ *
+ * This is sufficient to prove the user's entry is committed to by the `rootHash`.
+ */
+- (BOOL)verifyProofForUserID:(NSString *)userID error:(NSError *_Nullable *_Nullable)outError;
+
 /**
  * Returns the merkleTree root value, as specified within the JSON.
  * This value is only valid IF the `hashAndVerify` method returns true.
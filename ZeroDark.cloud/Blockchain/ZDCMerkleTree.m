@@ -9,9 +9,8 @@
 
 #import "ZDCMerkleTree.h"
 
-#import "NSData+AWSUtilities.h"
+#import "NSError+S4.h"
 #import "NSError+ZeroDark.h"
-#import "NSString+S4.h"
 
 #import <S4Crypto/S4Crypto.h>
 
@@ -78,6 +77,84 @@
 //   };
 // }
 
+// Levels with fewer nodes than this are hashed serially.
+// Larger levels are split into chunks of this size, and hashed concurrently.
+static NSUInteger const kMerkleParallelChunkSize = 512;
+
+/**
+ * Hashes the input, and writes the lowercase hex string of the result to `hexOut`.
+ * The hexOut buffer must have room for (2 * hashSize) bytes.
+ *
+ * Note: Interior nodes of the tree are the hash of the concatenated hex strings of their children.
+ * So the hex representation is part of the format, and this is what we feed into the next level.
+ */
+static S4Err MerkleHashToHex(HASH_Algorithm hashAlgo, size_t hashSize, const void *in, size_t inLen, char *hexOut)
+{
+	static const char hexChars[] = "0123456789abcdef";
+	uint8_t hashBuf[512/8];
+	
+	S4Err err = HASH_DO(hashAlgo, in, inLen, hashBuf, hashSize);
+	if (IsS4Err(err)) return err;
+	
+	for (size_t i = 0; i < hashSize; i++)
+	{
+		hexOut[(i * 2)    ] = hexChars[hashBuf[i] >> 4];
+		hexOut[(i * 2) + 1] = hexChars[hashBuf[i] & 0x0F];
+	}
+	
+	return kS4Err_NoErr;
+}
+
+/**
+ * Invokes the block for every index in [0, count).
+ * Large ranges are split into chunks, and processed concurrently.
+ *
+ * Returns the first error encountered (if any).
+ */
+static S4Err MerkleApply(NSUInteger count, S4Err (^block)(NSUInteger idx))
+{
+	if (count <= kMerkleParallelChunkSize)
+	{
+		for (NSUInteger idx = 0; idx < count; idx++)
+		{
+			S4Err err = block(idx);
+			if (IsS4Err(err)) return err;
+		}
+		
+		return kS4Err_NoErr;
+	}
+	
+	NSUInteger chunkCount = (count + kMerkleParallelChunkSize - 1) / kMerkleParallelChunkSize;
+	S4Err *chunkErrs = malloc(chunkCount * sizeof(S4Err)); // every chunk writes its own entry
+	
+	dispatch_apply(chunkCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t chunk) {
+		
+		NSUInteger start = chunk * kMerkleParallelChunkSize;
+		NSUInteger end = MIN(start + kMerkleParallelChunkSize, count);
+		
+		S4Err err = kS4Err_NoErr;
+		for (NSUInteger idx = start; idx < end && !IsS4Err(err); idx++)
+		{
+			err = block(idx);
+		}
+		
+		chunkErrs[chunk] = err;
+	});
+	
+	S4Err result = kS4Err_NoErr;
+	for (NSUInteger chunk = 0; chunk < chunkCount; chunk++)
+	{
+		if (IsS4Err(chunkErrs[chunk]))
+		{
+			result = chunkErrs[chunk];
+			break;
+		}
+	}
+	
+	free(chunkErrs);
+	return result;
+}
+
 @implementation ZDCMerkleTree {
 	NSDictionary *file;
 }
@@ -170,107 +247,285 @@ done:
 }
 
 /**
- * See header file for description.
+ * Returns the hash algorithm specified within the JSON,
+ * or kHASH_Algorithm_Invalid if it's missing or unsupported.
  */
-- (BOOL)hashAndVerify:(NSError **)outError
+- (HASH_Algorithm)hashAlgorithm:(size_t *)outHashSize
 {
-	NSError *error = nil;
-	NSString *errMsg = nil;
-	
-	NSDictionary *merkle = file[@"merkle"];
+	NSDictionary *merkle = file[@"merkle"]; // we already know this is a valid dictionary
 	NSString *hashName = merkle[@"hashalgo"];
 	
 	HASH_Algorithm hashAlgo = kHASH_Algorithm_Invalid;
-	NSArray<NSString *> *values = nil;
-	NSMutableArray<NSString *> *queue;
-	NSMutableArray<NSString *> *nextLevel;
+	size_t hashSize = 0;
 	
 	if ([hashName isKindOfClass:[NSString class]])
 	{
-		if([hashName isEqualToString:@"sha256"])
+		if ([hashName isEqualToString:@"sha256"])
 		{
 			hashAlgo = kHASH_Algorithm_SHA256;
+			hashSize = (256 / 8);
 		}
 		else if ([hashName isEqualToString:@"sha512"])
 		{
 			hashAlgo = kHASH_Algorithm_SHA512;
+			hashSize = (512 / 8);
 		}
 	}
+	
+	if (outHashSize) *outHashSize = hashSize;
+	return hashAlgo;
+}
 
-	if (hashAlgo == kHASH_Algorithm_Invalid)
+/**
+ * Rebuilds the tree from the values, and returns the calculated root.
+ *
+ * Each level is stored as a contiguous buffer of hex strings.
+ * Thus a pair of siblings is already the concatenated input for their parent,
+ * and large levels can be hashed concurrently without any intermediate objects.
+ */
+- (NSString *)calculateRootWithAlgorithm:(HASH_Algorithm)hashAlgo hashSize:(size_t)hashSize error:(S4Err *)outErr
+{
+	NSArray<NSString *> *values = file[@"values"];
+	NSUInteger count = values.count;
+	
+	if (count == 0)
 	{
-		errMsg = @"Unsupported hash algorithm";
-		goto done;
+		if (outErr) *outErr = kS4Err_NoErr;
+		return nil;
 	}
 	
-	values = file[@"values"];
-	queue = [NSMutableArray arrayWithCapacity:values.count];
+	const size_t hexLen = hashSize * 2;
+	
+	// Room for (count + 1) nodes:
+	// If there are an odd number of nodes in a level, the last one is paired with itself.
+	// We copy it to the end of the buffer, so every pair is contiguous.
+	
+	NSMutableData *levelData = [NSMutableData dataWithLength:((count + 1) * hexLen)];
+	NSMutableData *nextData  = [NSMutableData dataWithLength:((count + 1) * hexLen)];
+	
+	char *const leaves = (char *)levelData.mutableBytes;
+	
+	S4Err err = MerkleApply(count, ^S4Err (NSUInteger idx) { @autoreleasepool {
+		
+		NSData *value = [values[idx] dataUsingEncoding:NSUTF8StringEncoding];
+		
+		return MerkleHashToHex(hashAlgo, hashSize, value.bytes, value.length, leaves + (idx * hexLen));
+	}});
 	
-	for (NSString *value in values)
+	// When there's only 1 value, the root hash is simply the hash of the single item.
+	// When there's more than 1 value, we need to build the tree.
+	
+	NSUInteger levelCount = count;
+	while ((levelCount > 1) && !IsS4Err(err))
 	{
-		NSData *hash = [value hashWithAlgorithm:hashAlgo error:&error];
-		if (error) goto done;
-
-		[queue addObject:[hash lowercaseHexString]];
+		char *const level = (char *)levelData.mutableBytes;
+		char *const next = (char *)nextData.mutableBytes;
+		
+		if (levelCount % 2)
+		{
+			memcpy(level + (levelCount * hexLen), level + ((levelCount - 1) * hexLen), hexLen);
+		}
+		
+		NSUInteger nextCount = (levelCount + 1) / 2;
+		
+		err = MerkleApply(nextCount, ^S4Err (NSUInteger idx) {
+			
+			return MerkleHashToHex(hashAlgo, hashSize, level + (idx * 2 * hexLen), (2 * hexLen), next + (idx * hexLen));
+		});
+		
+		NSMutableData *temp = levelData;
+		levelData = nextData;
+		nextData = temp;
+		
+		levelCount = nextCount;
 	}
 	
-	nextLevel = [NSMutableArray arrayWithCapacity:queue.count];
+	if (outErr) *outErr = err;
+	if (IsS4Err(err)) return nil;
+	
+	return [[NSString alloc] initWithBytes:levelData.bytes length:hexLen encoding:NSASCIIStringEncoding];
+}
+
+/**
+ * See header file for description.
+ */
+- (BOOL)hashAndVerify:(NSError **)outError
+{
+	NSError *error = nil;
+	NSString *errMsg = nil;
+	
+	size_t hashSize = 0;
+	HASH_Algorithm hashAlgo = [self hashAlgorithm:&hashSize];
 	
-	if (queue.count == 1)
+	if (hashAlgo == kHASH_Algorithm_Invalid)
 	{
-		// When there's only 1 value, the root hash is simply the hash of the single item
+		errMsg = @"Unsupported hash algorithm";
 	}
 	else
 	{
-		// When there's more than 1 value, we need to build the tree
+		S4Err err = kS4Err_NoErr;
+		NSString *calculatedRoot = [self calculateRootWithAlgorithm:hashAlgo hashSize:hashSize error:&err];
 		
-		while (queue.count > 0)
+		if (IsS4Err(err))
 		{
-			NSString *left = [queue firstObject];
-			[queue removeObjectAtIndex:0];
-	
-			NSString *right = [queue firstObject];
-			if (right) {
-				[queue removeObjectAtIndex:0];
-			} else {
-				// If there are an odd number of leaves (only one left),
-				// concatenate it with itself, and hash that.
-				right = left;
-			}
-		
-			NSData *hash = [[left stringByAppendingString:right] hashWithAlgorithm:hashAlgo error:&error];
-			if (error) goto done;
+			error = [NSError errorWithS4Error:err];
+		}
+		else
+		{
+			NSString *reportedRoot = [self rootHash];
 			
-			[nextLevel addObject:[hash lowercaseHexString]];
-		
-			// Maybe go to the next level of the tree.
-			//
-			if ((queue.count == 0) && (nextLevel.count >= 2))
+			if (![calculatedRoot isEqual:reportedRoot])
 			{
-				NSMutableArray *temp = queue;
-				[temp removeAllObjects];
-		
-				queue = nextLevel;
-				nextLevel = temp;
+				errMsg = [NSString stringWithFormat:
+					@"Calculated root (%@) doesn't match file root (%@)", calculatedRoot, reportedRoot];
 			}
 		}
 	}
 	
-	{ // scoping
+	if (errMsg)
+	{
+		error = [NSError errorWithClass:[self class] code:0 description:errMsg];
+	}
+	
+	if (outError) *outError = error;
+	return (error == nil);
+}
+
+/**
+ * See header file for description.
+ */
+- (BOOL)verifyProofForUserID:(NSString *)userID error:(NSError **)outError
+{
+	NSError *error = nil;
+	NSString *errMsg = nil;
+	
+	NSDictionary *merkle = file[@"merkle"];
+	NSDictionary *lookup = file[@"lookup"];
+	NSArray<NSString *> *values = file[@"values"];
+	
+	size_t hashSize = 0;
+	HASH_Algorithm hashAlgo = [self hashAlgorithm:&hashSize];
+	
+	const size_t hexLen = hashSize * 2;
+	char hexBuf[(2 * (512/8) * 2) + 1]; // room for 2 concatenated sha512 hex strings (+ NULL terminator)
+	
+	NSNumber *idxNum = nil;
+	NSUInteger idx = 0;
+	NSData *value = nil;
+	
+	NSString *current = nil;
+	NSDictionary *node = nil;
+	NSUInteger maxDepth = 0;
+	S4Err err = kS4Err_NoErr;
+	
+	if (hashAlgo == kHASH_Algorithm_Invalid)
+	{
+		errMsg = @"Unsupported hash algorithm";
+		goto done;
+	}
+	
+	idxNum = lookup[userID];
+	idx = [idxNum unsignedIntegerValue];
+	
+	if (idxNum == nil || idx >= values.count)
+	{
+		errMsg = @"Merkle tree doesn't contain an entry for user";
+		goto done;
+	}
+	
+	// Hash the leaf.
+	
+	value = [values[idx] dataUsingEncoding:NSUTF8StringEncoding];
+	
+	err = MerkleHashToHex(hashAlgo, hashSize, value.bytes, value.length, hexBuf);
+	if (IsS4Err(err)) goto done;
+	
+	current = [[NSString alloc] initWithBytes:hexBuf length:hexLen encoding:NSASCIIStringEncoding];
+	node = merkle[current];
+	
+	// Walk up the tree, verifying each parent along the way.
+	// The depth is bounded so a malformed file (e.g. a cycle) can't keep us looping.
+	
+	maxDepth = values.count + 1;
+	for (NSUInteger depth = 0; depth <= maxDepth; depth++)
+	{
+		if (![node isKindOfClass:[NSDictionary class]])
+		{
+			errMsg = @"Merkle tree is missing a node along the user's path";
+			goto done;
+		}
+		
+		NSString *parent = node[@"parent"];
+		if (![parent isKindOfClass:[NSString class]])
+		{
+			errMsg = @"Merkle tree node has missing/invalid 'parent'";
+			goto done;
+		}
+		
+		if ([parent isEqualToString:@"root"])
+		{
+			if (![current isEqual:[self rootHash]])
+			{
+				errMsg = [NSString stringWithFormat:
+					@"Calculated root (%@) doesn't match file root (%@)", current, [self rootHash]];
+			}
+			goto done;
+		}
 		
-		NSString *calculatedRoot = [nextLevel firstObject] ?: [queue firstObject];
-		NSString *reportedRoot = [self rootHash];
+		NSDictionary *parentNode = merkle[parent];
+		NSString *left = nil;
+		NSString *right = nil;
 		
-		if (![calculatedRoot isEqual:reportedRoot])
+		if ([parentNode isKindOfClass:[NSDictionary class]])
+		{
+			left = parentNode[@"left"];
+			right = parentNode[@"right"];
+		}
+		
+		if (![left isKindOfClass:[NSString class]] || ![right isKindOfClass:[NSString class]] ||
+		    (left.length != hexLen) || (right.length != hexLen))
+		{
+			errMsg = @"Merkle tree node has missing/invalid children";
+			goto done;
+		}
+		
+		if (![current isEqualToString:left] && ![current isEqualToString:right])
+		{
+			errMsg = @"Merkle tree node doesn't reference its child";
+			goto done;
+		}
+		
+		if (![left getCString:hexBuf maxLength:(hexLen + 1) encoding:NSASCIIStringEncoding] ||
+		    ![right getCString:(hexBuf + hexLen) maxLength:(hexLen + 1) encoding:NSASCIIStringEncoding])
+		{
+			errMsg = @"Merkle tree node has missing/invalid children";
+			goto done;
+		}
+		
+		err = MerkleHashToHex(hashAlgo, hashSize, hexBuf, (2 * hexLen), hexBuf);
+		if (IsS4Err(err)) goto done;
+		
+		current = [[NSString alloc] initWithBytes:hexBuf length:hexLen encoding:NSASCIIStringEncoding];
+		
+		if (![current isEqualToString:parent])
 		{
 			errMsg = [NSString stringWithFormat:
-				@"Calculated root (%@) doesn't match file root (%@)", calculatedRoot, reportedRoot];
+				@"Calculated node (%@) doesn't match file node (%@)", current, parent];
+			goto done;
 		}
+		
+		node = parentNode;
 	}
 	
+	errMsg = @"Merkle tree path exceeds the size of the tree";
+	
 done:
 	
-	if (errMsg)
+	if (IsS4Err(err))
+	{
+		error = [NSError errorWithS4Error:err];
+	}
+	else if (errMsg)
 	{
 		error = [NSError errorWithClass:[self class] code:0 description:errMsg];
 	}
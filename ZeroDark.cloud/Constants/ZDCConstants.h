@@ -52,6 +52,8 @@ extern NSString *const kZDCCollection_CachedResponse;
 /** Name of collection in YapDatabase. All ZeroDark collection constants start with "ZDC" */
 extern NSString *const kZDCCollection_CloudNodes;
 /** Name of collection in YapDatabase. All ZeroDark collection constants start with "ZDC" */
+extern NSString *const kZDCCollection_CloudDataManifests;
+/** Name of collection in YapDatabase. All ZeroDark collection constants start with "ZDC" */
 extern NSString *const kZDCCollection_Nodes;
 /** Name of collection in YapDatabase. All ZeroDark collection constants start with "ZDC" */
 extern NSString *const kZDCCollection_Prefs;
@@ -13,6 +13,7 @@
 
 /* extern */ NSString *const kZDCCollection_CachedResponse  = @"ZDCCachedResponse";
 /* extern */ NSString *const kZDCCollection_CloudNodes      = @"ZDCCloudNodes";
+/* extern */ NSString *const kZDCCollection_CloudDataManifests = @"ZDCCloudDataManifests";
 /* extern */ NSString *const kZDCCollection_Nodes           = @"ZDCNodes";
 /* extern */ NSString *const kZDCCollection_Prefs           = @"ZDCPrefs";
 /* extern */ NSString *const kZDCCollection_PublicKeys      = @"ZDCPublicKeys";
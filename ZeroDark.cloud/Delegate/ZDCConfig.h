@@ -9,6 +9,8 @@
 
 #import <Foundation/Foundation.h>
 
+#import "ZDCCloudFileHeader.h"
+
 NS_ASSUME_NONNULL_BEGIN
 	
 /**
@@ -60,6 +62,22 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, copy, readwrite) NSString *databaseName;
 
+/**
+ * Allows the framework to compress the data section of uploaded files (prior to encryption).
+ * This is worthwhile for compressible content, such as JSON, text & message bodies.
+ *
+ * Compression is applied when uploading data that was handed to the framework in memory (`-[ZDCData data]`),
+ * and is small enough to be uploaded in a single request. (Files & multipart uploads aren't compressed.)
+ * If the data doesn't shrink, it's uploaded uncompressed.
+ *
+ * This version of the framework (and every later version) reads compressed files transparently.
+ * But older versions of the framework can't read them.
+ * So only enable this once every client that reads your treeID understands compressed files.
+ *
+ * The default value is ZDCCloudFileCompression_None.
+ */
+@property (nonatomic, assign, readwrite) ZDCCloudFileCompression cloudFileCompression;
+
 /**
  * Adds a treeID to the list of application containers you're requesting access to.
  */
@@ -14,6 +14,7 @@
 }
 
 @synthesize databaseName = databaseName;
+@synthesize cloudFileCompression = cloudFileCompression;
 @dynamic primaryTreeID;
 
 - (instancetype)initWithPrimaryTreeID:(NSString *)inTreeID
@@ -55,6 +55,18 @@ typedef void (^YapDatabaseConfigHook)(YapDatabase *database);
  */
 @property (nonatomic, readwrite, nullable) YapDatabaseConfigHook configHook;
 
+/**
+ * If YES, nodes & cloud operations are written using a compact binary format,
+ * which is considerably smaller & faster to read/write than NSKeyedArchiver.
+ *
+ * This version of the framework (and every later version) reads both formats, regardless of this setting.
+ * But older versions of the framework can only read NSKeyedArchiver rows.
+ * So only enable this once your app no longer needs to support downgrading to a version prior to this one.
+ *
+ * The default value is NO.
+ */
+@property (nonatomic, readwrite) BOOL compactSerialization;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -13,6 +13,7 @@
 
 @synthesize encryptionKey = encryptionKey;
 @synthesize configHook;
+@synthesize compactSerialization;
 
 - (instancetype)initWithEncryptionKey:(NSData *)inEncryptionKey
 {
@@ -38,6 +38,9 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (nonatomic, readonly, nullable) S4KeyContextRef storageKey;
 
+/** The value from `-[ZDCConfig cloudFileCompression]`. */
+@property (nonatomic, readonly) ZDCCloudFileCompression cloudFileCompression;
+
 - (void)registerPushTokenForLocalUsersIfNeeded;
 
 /**
@@ -0,0 +1,63 @@
+/**
+ * ZeroDark.cloud
+ *
+ * Homepage      : https://www.zerodark.cloud
+ * GitHub        : https://github.com/4th-ATechnologies/ZeroDark.cloud
+ * Documentation : https://zerodarkcloud.readthedocs.io/en/latest/
+ * API Reference : https://apis.zerodark.cloud
+**/
+
+#import <Foundation/Foundation.h>
+
+#import "ZDCLogMessage.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Every ZDCLog statement has its own (static) log site.
+ * It's created by the macros in ZDCLogging.h, and should not be touched directly.
+ *
+ * The site doubles as the "format ID" for the log statement:
+ * the format string is parsed once (on first use), and the result is cached within the site.
+ */
+typedef struct {
+	const char *file;
+	const char *function;
+	NSUInteger line;
+	_Atomic(void *) parsedFormat; // Managed by ZDCLogBuffer
+} ZDCLogSite;
+
+/**
+ * Records a log message into the calling thread's ring buffer.
+ *
+ * The hot path is cheap:
+ * - the raw arguments are copied into a pre-allocated slot (no formatting, no locks, no allocations*)
+ * - formatting & delivery to the log handler happens later, on a background serial queue
+ *
+ * (*) Immutable objects (%@) such as NSString, NSNumber, NSData, NSDate & NSUUID are retained,
+ *     and described later on the background queue (mutable strings & data are copied).
+ *     Any other object is described immediately, since it may be mutated after the call.
+ *     C strings (%s) are duplicated.
+ *
+ * If the ring buffer is full, the message is dropped (and the drop is reported later).
+ * The exception is errors & warnings, which are never dropped: the calling thread blocks until the
+ * queued messages have been delivered, and then the message is queued (so ordering is preserved).
+ */
+extern void ZDCLogEnqueue(ZDCLogSite *site, ZDCLogLevel level, ZDCLogFlag flag, NSString *format, ...)
+  NS_FORMAT_FUNCTION(4,5);
+
+/**
+ * Records an already formatted log message.
+ * Same rules as ZDCLogEnqueue, minus the deferred formatting.
+ */
+extern void ZDCLogEnqueueMessage(ZDCLogMessage *logMessage);
+
+/**
+ * Blocks until every message that's been enqueued (by any thread) has been delivered to the log handler.
+ *
+ * When invoked from within the log handler, this function returns immediately (rather than deadlocking).
+ * The remaining messages are delivered once the handler returns.
+ */
+extern void ZDCLogFlush(void);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,816 @@
+/**
+ * ZeroDark.cloud
+ *
+ * Homepage      : https://www.zerodark.cloud
+ * GitHub        : https://github.com/4th-ATechnologies/ZeroDark.cloud
+ * Documentation : https://zerodarkcloud.readthedocs.io/en/latest/
+ * API Reference : https://apis.zerodark.cloud
+**/
+
+#import "ZDCLogBuffer.h"
+#import "ZDCLogging.h"
+
+#import <YapDatabase/YapDatabaseAtomic.h>
+
+#import <pthread.h>
+#import <stdatomic.h>
+
+/**
+ * Each thread that logs gets its own single-producer/single-consumer ring.
+ * The producer is the thread itself, and the consumer is the drainer (a background serial queue).
+ * So the hot path doesn't need any locks, just a couple atomic loads & stores.
+ */
+enum {
+	kZDCLogRingCapacity = 256, // Must be power of 2
+	kZDCLogMaxArgs      = 8,
+	kZDCLogMaxSpecs     = 16,
+};
+
+typedef NS_ENUM(uint8_t, ZDCLogArgType) {
+	ZDCLogArgType_Int,      // %d, %u, %x, ... (also used for '*' width & precision)
+	ZDCLogArgType_Long,     // %ld, %lu, ...
+	ZDCLogArgType_LongLong, // %lld, %llu, %qd, ...
+	ZDCLogArgType_Size,     // %zu, ...
+	ZDCLogArgType_PtrDiff,  // %td, ...
+	ZDCLogArgType_IntMax,   // %jd, ...
+	ZDCLogArgType_Double,   // %f, %g, %e, ...
+	ZDCLogArgType_Pointer,  // %p
+	ZDCLogArgType_Object,   // %@
+	ZDCLogArgType_CString,  // %s
+};
+
+/**
+ * A single conversion specification within a format string. E.g. "%5lu" or "%@".
+ */
+typedef struct {
+	NSRange range;      // Range of the spec within the format string
+	uint8_t argIndex;   // Index of the first argument consumed by this spec
+	uint8_t argCount;   // Zero for "%%". Otherwise 1, plus 1 for each '*'
+	ZDCLogArgType type; // Type of the (final) argument
+} ZDCLogSpec;
+
+typedef struct {
+	void *format;       // NSString (retained)
+	BOOL eager;         // YES if the format uses something we don't support (must be formatted immediately)
+	uint8_t argCount;
+	uint8_t specCount;
+	ZDCLogArgType argTypes[kZDCLogMaxArgs];
+	ZDCLogSpec specs[kZDCLogMaxSpecs];
+} ZDCLogFormat;
+
+typedef union {
+	int64_t i;
+	double d;
+	void *p;
+} ZDCLogArg;
+
+typedef struct {
+	ZDCLogSite *site;     // NULL if enqueued via ZDCLogEnqueueMessage (in which case args[0] is the ZDCLogMessage)
+	ZDCLogFormat *format; // NULL if message was preformatted (in which case args[0] is the NSString)
+	ZDCLogLevel level;
+	ZDCLogFlag flag;
+	ZDCLogArg args[kZDCLogMaxArgs];
+} ZDCLogEntry;
+
+typedef struct {
+	_Atomic(uint32_t) head; // Next slot to write (only modified by producer)
+	_Atomic(uint32_t) tail; // Next slot to read  (only modified by consumer)
+	_Atomic(uint32_t) dropped;
+	_Atomic(bool) abandoned; // Set when the owning thread exits
+	ZDCLogEntry entries[kZDCLogRingCapacity];
+} ZDCLogRing;
+
+static dispatch_queue_t drainQueue;
+static void *IsOnDrainQueueKey = &IsOnDrainQueueKey;
+static _Atomic(bool) drainScheduled;
+
+static YAPUnfairLock ringsLock = YAP_UNFAIR_LOCK_INIT;
+static ZDCLogRing **rings = NULL;     // must be accessed within ringsLock
+static NSUInteger ringsCount = 0;     // must be accessed within ringsLock
+static NSUInteger ringsCapacity = 0;  // must be accessed within ringsLock
+
+static pthread_key_t ringKey;
+
+static void ZDCLogScheduleDrain(void);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Rings
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void ZDCLogRingThreadExit(void *value)
+{
+	ZDCLogRing *ring = (ZDCLogRing *)value;
+	if (ring == NULL) return;
+	
+	// Note: pthread has already cleared the thread's value for the key.
+	// So if something logs after this point, a new ring is created (and this destructor is invoked again).
+	//
+	// The drainer frees the ring once it's been emptied.
+	atomic_store_explicit(&ring->abandoned, true, memory_order_release);
+	ZDCLogScheduleDrain();
+}
+
+static void ZDCLogInitialize(void)
+{
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		
+		dispatch_queue_attr_t attr =
+		  dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0);
+		
+		drainQueue = dispatch_queue_create("ZDCLogBuffer", attr);
+		dispatch_queue_set_specific(drainQueue, IsOnDrainQueueKey, IsOnDrainQueueKey, NULL);
+		
+		pthread_key_create(&ringKey, ZDCLogRingThreadExit);
+	});
+}
+
+static ZDCLogRing* ZDCLogCurrentRing(void)
+{
+	ZDCLogInitialize();
+	
+	ZDCLogRing *ring = (ZDCLogRing *)pthread_getspecific(ringKey);
+	if (ring) return ring;
+	
+	ring = (ZDCLogRing *)calloc(1, sizeof(ZDCLogRing));
+	if (ring == NULL) return NULL;
+	
+	YAPUnfairLockLock(&ringsLock);
+	{
+		if (ringsCount == ringsCapacity)
+		{
+			NSUInteger newCapacity = MAX(ringsCapacity * 2, (NSUInteger)16);
+			ZDCLogRing **newRings = (ZDCLogRing **)realloc(rings, sizeof(ZDCLogRing *) * newCapacity);
+			
+			if (newRings)
+			{
+				rings = newRings;
+				ringsCapacity = newCapacity;
+			}
+		}
+		
+		if (ringsCount < ringsCapacity)
+		{
+			rings[ringsCount] = ring;
+			ringsCount++;
+		}
+		else
+		{
+			free(ring);
+			ring = NULL;
+		}
+	}
+	YAPUnfairLockUnlock(&ringsLock);
+	
+	if (ring)
+	{
+		pthread_setspecific(ringKey, ring);
+	}
+	
+	return ring;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Formats
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static ZDCLogFormat* ZDCLogFormatParse(NSString *format)
+{
+	ZDCLogFormat *parsed = (ZDCLogFormat *)calloc(1, sizeof(ZDCLogFormat));
+	if (parsed == NULL) return NULL;
+	
+	parsed->format = (void *)CFBridgingRetain(format);
+	
+	NSUInteger const length = format.length;
+	unichar *chars = (unichar *)malloc(sizeof(unichar) * (length + 1));
+	if (chars == NULL)
+	{
+		parsed->eager = YES;
+		return parsed;
+	}
+	
+	[format getCharacters:chars range:NSMakeRange(0, length)];
+	chars[length] = 0;
+	
+	NSUInteger i = 0;
+	while (i < length && !parsed->eager)
+	{
+		if (chars[i] != '%') {
+			i++;
+			continue;
+		}
+		
+		NSUInteger const start = i;
+		i++;
+		
+		uint8_t stars = 0;
+		
+		// Flags
+		while (chars[i] == '-' || chars[i] == '+' || chars[i] == ' ' || chars[i] == '#' || chars[i] == '0') {
+			i++;
+		}
+		
+		// Width
+		if (chars[i] == '*') {
+			stars++;
+			i++;
+		}
+		else {
+			while (chars[i] >= '0' && chars[i] <= '9') i++;
+		}
+		
+		if (chars[i] == '$') {
+			parsed->eager = YES; // Positional arguments aren't supported
+			break;
+		}
+		
+		// Precision
+		if (chars[i] == '.')
+		{
+			i++;
+			if (chars[i] == '*') {
+				stars++;
+				i++;
+			}
+			else {
+				while (chars[i] >= '0' && chars[i] <= '9') i++;
+			}
+		}
+		
+		// Length modifier
+		ZDCLogArgType type = ZDCLogArgType_Int;
+		BOOL hasLengthModifier = YES;
+		
+		switch (chars[i])
+		{
+			case 'h' : i++; if (chars[i] == 'h') i++; break;
+			case 'l' : i++; if (chars[i] == 'l') { i++; type = ZDCLogArgType_LongLong; }
+			                else { type = ZDCLogArgType_Long; }
+			           break;
+			case 'q' : i++; type = ZDCLogArgType_LongLong; break;
+			case 'z' : i++; type = ZDCLogArgType_Size;     break;
+			case 't' : i++; type = ZDCLogArgType_PtrDiff;  break;
+			case 'j' : i++; type = ZDCLogArgType_IntMax;   break;
+			case 'L' : parsed->eager = YES;                break;
+			default  : hasLengthModifier = NO;             break;
+		}
+		
+		if (parsed->eager) break;
+		
+		// Conversion
+		uint8_t argCount = 1 + stars;
+		
+		switch (chars[i])
+		{
+			case '%':
+				argCount = 0;
+				break;
+			case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+				break;
+			case 'c':
+				if (hasLengthModifier) parsed->eager = YES; // wide chars
+				break;
+			case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+				type = ZDCLogArgType_Double;
+				break;
+			case 'p':
+				type = ZDCLogArgType_Pointer;
+				break;
+			case '@':
+				type = ZDCLogArgType_Object;
+				break;
+			case 's':
+				type = ZDCLogArgType_CString;
+				if (hasLengthModifier) parsed->eager = YES; // wide strings
+				break;
+			default:
+				parsed->eager = YES; // %n, %S, %C, etc
+				break;
+		}
+		
+		if (parsed->eager) break;
+		i++;
+		
+		if ((parsed->specCount >= kZDCLogMaxSpecs) || ((parsed->argCount + argCount) > kZDCLogMaxArgs))
+		{
+			parsed->eager = YES;
+			break;
+		}
+		
+		ZDCLogSpec *spec = &parsed->specs[parsed->specCount];
+		spec->range = NSMakeRange(start, i - start);
+		spec->argIndex = parsed->argCount;
+		spec->argCount = argCount;
+		spec->type = type;
+		
+		for (uint8_t s = 0; s < stars; s++) {
+			parsed->argTypes[parsed->argCount++] = ZDCLogArgType_Int;
+		}
+		if (argCount > 0) {
+			parsed->argTypes[parsed->argCount++] = type;
+		}
+		
+		parsed->specCount++;
+	}
+	
+	free(chars);
+	return parsed;
+}
+
+static void ZDCLogFormatFree(ZDCLogFormat *parsed)
+{
+	if (parsed == NULL) return;
+	
+	if (parsed->format) {
+		CFRelease(parsed->format);
+	}
+	free(parsed);
+}
+
+/**
+ * Returns the parsed format for the site, or NULL if the message must be formatted eagerly.
+ *
+ * The format is parsed once per site, and then cached forever (there's a fixed number of log statements).
+ * The parsed format retains the format string, so a pointer comparison is enough to validate the cache.
+ */
+static ZDCLogFormat* ZDCLogFormatForSite(ZDCLogSite *site, NSString *format)
+{
+	ZDCLogFormat *parsed = (ZDCLogFormat *)atomic_load_explicit(&site->parsedFormat, memory_order_acquire);
+	if (parsed == NULL)
+	{
+		ZDCLogFormat *newParsed = ZDCLogFormatParse(format);
+		if (newParsed == NULL) return NULL;
+		
+		void *expected = NULL;
+		if (atomic_compare_exchange_strong_explicit(&site->parsedFormat, &expected, newParsed,
+		                                            memory_order_acq_rel, memory_order_acquire))
+		{
+			parsed = newParsed;
+		}
+		else
+		{
+			// Another thread beat us to it
+			ZDCLogFormatFree(newParsed);
+			parsed = (ZDCLogFormat *)expected;
+		}
+	}
+	
+	if (parsed->format != (__bridge void *)format) {
+		return NULL; // Non-literal format string that changed
+	}
+	if (parsed->eager) {
+		return NULL;
+	}
+	
+	return parsed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Arguments
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Only immutable objects are described later (on the drain queue), so the hot path only has to retain them.
+ * For NSString & NSData, copy == retain (unless it's the mutable variant, in which case we snapshot it).
+ *
+ * Anything else may be mutated (or deallocated) right after being logged, so it's described now.
+ */
+static id ZDCLogCaptureObject(id obj)
+{
+	if ([obj isKindOfClass:[NSString class]] ||
+	    [obj isKindOfClass:[NSData class]])
+	{
+		return [obj copy];
+	}
+	
+	if ([obj isKindOfClass:[NSNumber class]] ||
+	    [obj isKindOfClass:[NSDate class]]   ||
+	    [obj isKindOfClass:[NSUUID class]]   ||
+	    [obj isKindOfClass:[NSURL class]]    ||
+	    [obj isKindOfClass:[NSNull class]])
+	{
+		return obj;
+	}
+	
+	return [[obj description] copy];
+}
+
+static void ZDCLogCaptureArgs(ZDCLogFormat *parsed, ZDCLogArg *out, va_list args)
+{
+	for (uint8_t i = 0; i < parsed->argCount; i++)
+	{
+		switch (parsed->argTypes[i])
+		{
+			case ZDCLogArgType_Int      : out[i].i = va_arg(args, int);       break;
+			case ZDCLogArgType_Long     : out[i].i = va_arg(args, long);      break;
+			case ZDCLogArgType_LongLong : out[i].i = va_arg(args, long long); break;
+			case ZDCLogArgType_Size     : out[i].i = (int64_t)va_arg(args, size_t);   break;
+			case ZDCLogArgType_PtrDiff  : out[i].i = (int64_t)va_arg(args, ptrdiff_t); break;
+			case ZDCLogArgType_IntMax   : out[i].i = (int64_t)va_arg(args, intmax_t);  break;
+			case ZDCLogArgType_Double   : out[i].d = va_arg(args, double);    break;
+			case ZDCLogArgType_Pointer  : out[i].p = va_arg(args, void *);    break;
+			case ZDCLogArgType_Object   :
+			{
+				id obj = va_arg(args, id);
+				out[i].p = obj ? (void *)CFBridgingRetain(ZDCLogCaptureObject(obj)) : NULL;
+				break;
+			}
+			case ZDCLogArgType_CString  :
+			{
+				const char *str = va_arg(args, const char *);
+				out[i].p = str ? strdup(str) : NULL;
+				break;
+			}
+		}
+	}
+}
+
+static void ZDCLogReleaseArgs(ZDCLogFormat *parsed, ZDCLogArg *args)
+{
+	for (uint8_t i = 0; i < parsed->argCount; i++)
+	{
+		if (args[i].p == NULL) continue;
+		
+		if (parsed->argTypes[i] == ZDCLogArgType_Object) {
+			CFRelease(args[i].p);
+		}
+		else if (parsed->argTypes[i] == ZDCLogArgType_CString) {
+			free(args[i].p);
+		}
+	}
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wformat-nonliteral"
+
+static NSString* ZDCLogFormatSpec(NSString *specFormat, ZDCLogSpec *spec, ZDCLogArg *args)
+{
+	uint8_t const stars = spec->argCount - 1;
+	ZDCLogArg const v = args[stars];
+	
+	#define ZDC_FORMAT_SPEC(value)                                                                   \
+	  (stars == 0) ? [NSString stringWithFormat:specFormat, value] :                                 \
+	  (stars == 1) ? [NSString stringWithFormat:specFormat, (int)args[0].i, value] :                 \
+	                 [NSString stringWithFormat:specFormat, (int)args[0].i, (int)args[1].i, value]
+	
+	switch (spec->type)
+	{
+		case ZDCLogArgType_Int      : return ZDC_FORMAT_SPEC((int)v.i);
+		case ZDCLogArgType_Long     : return ZDC_FORMAT_SPEC((long)v.i);
+		case ZDCLogArgType_LongLong : return ZDC_FORMAT_SPEC((long long)v.i);
+		case ZDCLogArgType_Size     : return ZDC_FORMAT_SPEC((size_t)v.i);
+		case ZDCLogArgType_PtrDiff  : return ZDC_FORMAT_SPEC((ptrdiff_t)v.i);
+		case ZDCLogArgType_IntMax   : return ZDC_FORMAT_SPEC((intmax_t)v.i);
+		case ZDCLogArgType_Double   : return ZDC_FORMAT_SPEC(v.d);
+		case ZDCLogArgType_Pointer  : return ZDC_FORMAT_SPEC(v.p);
+		case ZDCLogArgType_Object   : return ZDC_FORMAT_SPEC((__bridge id)v.p);
+		case ZDCLogArgType_CString  : return ZDC_FORMAT_SPEC((const char *)v.p);
+	}
+	
+	#undef ZDC_FORMAT_SPEC
+	
+	return @"";
+}
+
+#pragma clang diagnostic pop
+
+static NSString* ZDCLogFormatMessage(ZDCLogFormat *parsed, ZDCLogArg *args)
+{
+	NSString *format = (__bridge NSString *)parsed->format;
+	NSMutableString *message = [NSMutableString stringWithCapacity:(format.length + 32)];
+	
+	NSUInteger offset = 0;
+	for (uint8_t i = 0; i < parsed->specCount; i++)
+	{
+		ZDCLogSpec *spec = &parsed->specs[i];
+		
+		if (spec->range.location > offset) {
+			[message appendString:[format substringWithRange:NSMakeRange(offset, spec->range.location - offset)]];
+		}
+		
+		if (spec->argCount == 0)
+		{
+			[message appendString:@"%"];
+		}
+		else
+		{
+			NSString *specFormat = [format substringWithRange:spec->range];
+			[message appendString:ZDCLogFormatSpec(specFormat, spec, args + spec->argIndex)];
+		}
+		
+		offset = NSMaxRange(spec->range);
+	}
+	
+	if (offset < format.length) {
+		[message appendString:[format substringFromIndex:offset]];
+	}
+	
+	return message;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Delivery
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void ZDCLogDeliver(ZDCLogSite *site, ZDCLogLevel level, ZDCLogFlag flag, NSString *message)
+{
+	ZDCLogMessage *logMessage =
+	  [[ZDCLogMessage alloc] initWithMessage: message
+	                                   level: level
+	                                    flag: flag
+	                                    file: [NSString stringWithUTF8String:site->file]
+	                                function: [NSString stringWithUTF8String:site->function]
+	                                    line: site->line];
+	
+	[ZeroDarkCloud logMessage:logMessage];
+}
+
+static void ZDCLogDrainRing(ZDCLogRing *ring)
+{
+	uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+	
+	while (tail != head)
+	{
+		@autoreleasepool {
+			
+			ZDCLogEntry *entry = &ring->entries[tail & (kZDCLogRingCapacity - 1)];
+			
+			if (entry->site == NULL)
+			{
+				ZDCLogMessage *logMessage = (ZDCLogMessage *)CFBridgingRelease(entry->args[0].p);
+				entry->args[0].p = NULL;
+				
+				[ZeroDarkCloud logMessage:logMessage];
+			}
+			else
+			{
+				NSString *message = nil;
+				if (entry->format)
+				{
+					message = ZDCLogFormatMessage(entry->format, entry->args);
+					ZDCLogReleaseArgs(entry->format, entry->args);
+				}
+				else
+				{
+					message = (NSString *)CFBridgingRelease(entry->args[0].p);
+				}
+				
+				entry->args[0].p = NULL;
+				
+				ZDCLogDeliver(entry->site, entry->level, entry->flag, message);
+			}
+		}
+		
+		tail++;
+		atomic_store_explicit(&ring->tail, tail, memory_order_release); // frees up the slot for the producer
+		
+		if (tail == head) {
+			head = atomic_load_explicit(&ring->head, memory_order_acquire);
+		}
+	}
+	
+	uint32_t dropped = atomic_exchange_explicit(&ring->dropped, 0, memory_order_relaxed);
+	if (dropped > 0)
+	{
+		static ZDCLogSite site = { __FILE__, __PRETTY_FUNCTION__, __LINE__, NULL };
+		
+		NSString *message = [NSString stringWithFormat:@"Log buffer overflow: dropped %u message(s)", dropped];
+		ZDCLogDeliver(&site, ZDCLogLevelWarning, ZDCLogFlagWarning, message);
+	}
+}
+
+static void ZDCLogDrain(void)
+{
+	atomic_store_explicit(&drainScheduled, false, memory_order_release);
+	
+	ZDCLogRing **snapshot = NULL;
+	NSUInteger snapshotCount = 0;
+	
+	YAPUnfairLockLock(&ringsLock);
+	{
+		if (ringsCount > 0)
+		{
+			snapshot = (ZDCLogRing **)malloc(sizeof(ZDCLogRing *) * ringsCount);
+			if (snapshot)
+			{
+				memcpy(snapshot, rings, sizeof(ZDCLogRing *) * ringsCount);
+				snapshotCount = ringsCount;
+			}
+		}
+	}
+	YAPUnfairLockUnlock(&ringsLock);
+	
+	// Only the drainer frees rings, so the pointers in our snapshot remain valid.
+	
+	for (NSUInteger i = 0; i < snapshotCount; i++)
+	{
+		ZDCLogRing *ring = snapshot[i];
+		ZDCLogDrainRing(ring);
+		
+		if (atomic_load_explicit(&ring->abandoned, memory_order_acquire))
+		{
+			// The owning thread has exited, so nothing else will be written.
+			// Drain anything written before the flag was set, and then free the ring.
+			
+			ZDCLogDrainRing(ring);
+			
+			YAPUnfairLockLock(&ringsLock);
+			{
+				for (NSUInteger r = 0; r < ringsCount; r++)
+				{
+					if (rings[r] == ring)
+					{
+						rings[r] = rings[ringsCount - 1];
+						ringsCount--;
+						break;
+					}
+				}
+			}
+			YAPUnfairLockUnlock(&ringsLock);
+			
+			free(ring);
+		}
+	}
+	
+	if (snapshot) {
+		free(snapshot);
+	}
+}
+
+static void ZDCLogDrainCallback(void *context)
+{
+	ZDCLogDrain();
+}
+
+static void ZDCLogScheduleDrain(void)
+{
+	if (!atomic_exchange_explicit(&drainScheduled, true, memory_order_acq_rel))
+	{
+		dispatch_async_f(drainQueue, NULL, ZDCLogDrainCallback);
+	}
+}
+
+/**
+ * Reserves the next slot in the calling thread's ring.
+ *
+ * If the ring is full, info/verbose/trace messages are dropped (and the drop is reported later).
+ * Errors & warnings are never dropped. Instead we apply backpressure:
+ * the calling thread blocks until the drainer has delivered everything that's already queued,
+ * and then the message is queued behind it (so ordering is preserved).
+ *
+ * Backpressure isn't possible on the drain queue itself (i.e. when the log handler is logging),
+ * in which case `deliverNow` is set, and the caller should deliver the message synchronously.
+ */
+static ZDCLogEntry* ZDCLogReserveEntry(ZDCLogFlag flag, ZDCLogRing **ringOut, uint32_t *headOut, BOOL *deliverNow)
+{
+	*deliverNow = NO;
+	
+	ZDCLogRing *ring = ZDCLogCurrentRing();
+	if (ring == NULL)
+	{
+		*deliverNow = (flag & (ZDCLogFlagError | ZDCLogFlagWarning)) ? YES : NO;
+		return NULL;
+	}
+	
+	uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+	
+	if ((head - tail) >= kZDCLogRingCapacity)
+	{
+		if ((flag & (ZDCLogFlagError | ZDCLogFlagWarning)) == 0)
+		{
+			atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+			ZDCLogScheduleDrain();
+			return NULL;
+		}
+		
+		if (dispatch_get_specific(IsOnDrainQueueKey))
+		{
+			*deliverNow = YES;
+			return NULL;
+		}
+		
+		// Only this thread writes to the ring, so once the drain completes, the ring is empty.
+		dispatch_sync_f(drainQueue, NULL, ZDCLogDrainCallback);
+		
+		tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+		if ((head - tail) >= kZDCLogRingCapacity)
+		{
+			*deliverNow = YES;
+			return NULL;
+		}
+	}
+	
+	*ringOut = ring;
+	*headOut = head;
+	return &ring->entries[head & (kZDCLogRingCapacity - 1)];
+}
+
+static void ZDCLogCommitEntry(ZDCLogRing *ring, uint32_t head)
+{
+	atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+	ZDCLogScheduleDrain();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Public API
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * See header file for description.
+ */
+void ZDCLogEnqueue(ZDCLogSite *site, ZDCLogLevel level, ZDCLogFlag flag, NSString *format, ...)
+{
+	if (format == nil) return;
+	
+	ZDCLogFormat *parsed = ZDCLogFormatForSite(site, format);
+	
+	ZDCLogRing *ring = NULL;
+	uint32_t head = 0;
+	BOOL deliverNow = NO;
+	
+	ZDCLogEntry *entry = ZDCLogReserveEntry(flag, &ring, &head, &deliverNow);
+	if (entry == NULL)
+	{
+		if (deliverNow)
+		{
+			va_list args;
+			va_start(args, format);
+			NSString *message = [[NSString alloc] initWithFormat:format arguments:args];
+			va_end(args);
+			
+			ZDCLogDeliver(site, level, flag, message);
+		}
+		return;
+	}
+	
+	entry->site = site;
+	entry->level = level;
+	entry->flag = flag;
+	entry->format = parsed;
+	
+	va_list args;
+	va_start(args, format);
+	
+	if (parsed)
+	{
+		ZDCLogCaptureArgs(parsed, entry->args, args);
+	}
+	else
+	{
+		NSString *message = [[NSString alloc] initWithFormat:format arguments:args];
+		entry->args[0].p = (void *)CFBridgingRetain(message);
+	}
+	
+	va_end(args);
+	
+	ZDCLogCommitEntry(ring, head);
+}
+
+/**
+ * See header file for description.
+ */
+void ZDCLogEnqueueMessage(ZDCLogMessage *logMessage)
+{
+	if (logMessage == nil) return;
+	
+	ZDCLogRing *ring = NULL;
+	uint32_t head = 0;
+	BOOL deliverNow = NO;
+	
+	ZDCLogEntry *entry = ZDCLogReserveEntry(logMessage.flag, &ring, &head, &deliverNow);
+	if (entry == NULL)
+	{
+		if (deliverNow) {
+			[ZeroDarkCloud logMessage:logMessage];
+		}
+		return;
+	}
+	
+	entry->site = NULL;
+	entry->level = logMessage.level;
+	entry->flag = logMessage.flag;
+	entry->format = NULL;
+	entry->args[0].p = (void *)CFBridgingRetain(logMessage);
+	
+	ZDCLogCommitEntry(ring, head);
+}
+
+/**
+ * See header file for description.
+ */
+void ZDCLogFlush(void)
+{
+	ZDCLogInitialize();
+	
+	if (dispatch_get_specific(IsOnDrainQueueKey))
+	{
+		// Invoked from within the log handler (i.e. in the middle of a drain).
+		// A dispatch_sync here would deadlock.
+		// Everything that's still queued gets delivered as soon as the handler returns.
+		return;
+	}
+	
+	dispatch_sync_f(drainQueue, NULL, ZDCLogDrainCallback);
+}
@@ -2,6 +2,7 @@
 
 #import "ZeroDarkCloud.h"
 #import "ZDCLogMessage.h"
+#import "ZDCLogBuffer.h"
 
 /**
  * Logging plays a very important role in open-source libraries.
@@ -18,25 +19,51 @@
 
 @interface ZeroDarkCloud ()
 
+/**
+ * Formats the message and queues it for delivery to the configured log handler.
+ *
+ * The ZDCLog macros no longer go through this method.
+ * It's kept (for code that invokes it directly), and is routed through the same log buffer.
+ */
 + (void)log:(ZDCLogLevel)level
        flag:(ZDCLogFlag)flag
        file:(const char *)file
    function:(const char *)function
        line:(NSUInteger)line
-     format:(NSString *)format, ... NS_FORMAT_FUNCTION(6,7);
+     format:(NSString *)format, ... NS_FORMAT_FUNCTION(6,7)
+  __attribute__((deprecated("Use the ZDCLog macros instead")));
+
+/**
+ * Delivers the message to the configured log handler.
+ * Invoked by ZDCLogBuffer (typically from its background queue).
+ */
++ (void)logMessage:(ZDCLogMessage *)logMessage;
 
 @end
 
-#define ZDC_LOG_MACRO(lvl, flg, frmt, ...)           \
-        [ZeroDarkCloud log : lvl                     \
-                      flag : flg                     \
-                      file : __FILE__                \
-                  function : __PRETTY_FUNCTION__     \
-                      line : __LINE__                \
-                    format : (frmt), ## __VA_ARGS__]
+/**
+ * Compile-time ceiling for log messages.
+ *
+ * Log statements for flags not included in this mask are compiled out entirely,
+ * regardless of the zdcLogLevel configured within the file.
+ * For example, to strip all trace statements from a build: `-DZDC_LOG_LEVEL_MAX=ZDCLogLevelVerbose`
+ */
+#ifndef ZDC_LOG_LEVEL_MAX
+#define ZDC_LOG_LEVEL_MAX ZDCLogLevelAll
+#endif
+
+/**
+ * Each log statement gets its own static ZDCLogSite,
+ * which allows the format string to be parsed once, and the message to be formatted later (on a background thread).
+ */
+#define ZDC_LOG_MACRO(lvl, flg, frmt, ...)                                                  \
+        do {                                                                                \
+          static ZDCLogSite zdcLogSite = { __FILE__, __PRETTY_FUNCTION__, __LINE__, NULL }; \
+          ZDCLogEnqueue(&zdcLogSite, lvl, flg, (frmt), ## __VA_ARGS__);                     \
+        } while(0)
 
 #define ZDC_LOG_MAYBE(lvl, flg, frmt, ...) \
-        do { if(lvl & flg) ZDC_LOG_MACRO(lvl, flg, frmt, ##__VA_ARGS__); } while(0)
+        do { if((ZDC_LOG_LEVEL_MAX & flg) && (lvl & flg)) ZDC_LOG_MACRO(lvl, flg, frmt, ##__VA_ARGS__); } while(0)
 
 #define ZDCLogError(frmt, ...)   ZDC_LOG_MAYBE(zdcLogLevel, ZDCLogFlagError,   frmt, ##__VA_ARGS__)
 #define ZDCLogWarn(frmt, ...)    ZDC_LOG_MAYBE(zdcLogLevel, ZDCLogFlagWarning, frmt, ##__VA_ARGS__)
@@ -0,0 +1,65 @@
+/**
+ * ZeroDark.cloud
+ *
+ * Homepage      : https://www.zerodark.cloud
+ * GitHub        : https://github.com/4th-ATechnologies/ZeroDark.cloud
+ * Documentation : https://zerodarkcloud.readthedocs.io/en/latest/
+ * API Reference : https://apis.zerodark.cloud
+**/
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * A compact binary alternative to NSKeyedArchiver, used by the database serializer for hot model classes.
+ *
+ * Objects are encoded via their existing NSCoding implementation (encodeWithCoder: / initWithCoder:),
+ * so there's no per-class serialization code to maintain. But the output is a flat binary stream:
+ *
+ * - strings are interned (repeated keys & values are written once, and then referenced by index)
+ * - integers & lengths are varints
+ * - doubles, dates & uuids are fixed-width
+ *
+ * Framework classes (ZDC prefix) are encoded inline.
+ * Any other (unknown) class, or a class that overrides `replacementObjectForKeyedArchiver:`,
+ * is embedded as a keyed archive, so the output is always complete.
+ *
+ * The format is versioned via a short header.
+ * Data without the header (e.g. rows written with NSKeyedArchiver) is reported via `isCompactData:`,
+ * allowing the caller to fall back to NSKeyedUnarchiver.
+ *
+ * Writing the compact format is opt-in (see `-[ZDCDatabaseConfig compactSerialization]`),
+ * since older versions of the framework can't read it.
+ */
+@interface ZDCCompactCoder : NSObject
+
+/**
+ * Returns YES if the object is a root class that should be stored in the compact format.
+ * Currently: ZDCNode (including ZDCTrunkNode) & ZDCCloudOperation.
+ */
++ (BOOL)supportsRootObject:(nullable id)object;
+
+/**
+ * Returns YES if the data starts with the compact header (any version).
+ */
++ (BOOL)isCompactData:(nullable NSData *)data;
+
+/**
+ * Encodes the given object.
+ * Returns nil if the object (or something within it) couldn't be encoded in the compact format
+ * (e.g. it uses non-keyed coding). The caller should fall back to NSKeyedArchiver.
+ */
++ (nullable NSData *)archivedDataWithRootObject:(id)object;
+
+/**
+ * Decodes data previously created via `archivedDataWithRootObject:`.
+ *
+ * Returns nil (and logs an error) if the data is malformed, uses an unsupported version,
+ * or a class decodes a value via `decodeObjectOfClass:forKey:` that doesn't match the expected class.
+ */
++ (nullable id)unarchiveObjectWithData:(NSData *)data;
+
+@end
+
+NS_ASSUME_NONNULL_END
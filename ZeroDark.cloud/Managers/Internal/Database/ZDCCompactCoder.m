@@ -0,0 +1,957 @@
+/**
+ * ZeroDark.cloud
+ *
+ * Homepage      : https://www.zerodark.cloud
+ * GitHub        : https://github.com/4th-ATechnologies/ZeroDark.cloud
+ * Documentation : https://zerodarkcloud.readthedocs.io/en/latest/
+ * API Reference : https://apis.zerodark.cloud
+**/
+
+#import "ZDCCompactCoder.h"
+
+#import "ZDCCloudOperation.h"
+#import "ZDCLogging.h"
+#import "ZDCNode.h"
+
+// Log Levels: off, error, warning, info, verbose
+// Log Flags : trace
+#if DEBUG
+  static const int zdcLogLevel = ZDCLogLevelVerbose;
+#else
+  static const int zdcLogLevel = ZDCLogLevelWarning;
+#endif
+
+/**
+ * Header: 'z' 'd' 'c' <version>
+ *
+ * Legacy rows (NSKeyedArchiver) start with "bplist00", so there's no ambiguity.
+ */
+static const uint8_t kHeader[3] = { 'z', 'd', 'c' };
+static const uint8_t kCurrentVersion = 1;
+
+/**
+ * Every value in the stream is prefixed with a single-byte tag.
+ */
+typedef NS_ENUM(uint8_t, ZDCCompactTag) {
+	ZDCCompactTag_Nil        = 0x00,
+	ZDCCompactTag_Null       = 0x01, // NSNull
+	ZDCCompactTag_False      = 0x02,
+	ZDCCompactTag_True       = 0x03,
+	ZDCCompactTag_Int        = 0x04, // zigzag varint
+	ZDCCompactTag_UInt       = 0x05, // varint (only for values > INT64_MAX)
+	ZDCCompactTag_Double     = 0x06, // 8 bytes
+	ZDCCompactTag_String     = 0x07, // varint length + utf8 (appended to string table)
+	ZDCCompactTag_StringRef  = 0x08, // varint index (into string table)
+	ZDCCompactTag_Data       = 0x09, // varint length + bytes
+	ZDCCompactTag_Date       = 0x0A, // 8 bytes (timeIntervalSinceReferenceDate)
+	ZDCCompactTag_UUID       = 0x0B, // 16 bytes
+	ZDCCompactTag_Array      = 0x0C, // varint count + values
+	ZDCCompactTag_Set        = 0x0D, // varint count + values
+	ZDCCompactTag_Dictionary = 0x0E, // varint count + (key, value) pairs
+	ZDCCompactTag_Object     = 0x0F, // className + (key, value) pairs + End
+	ZDCCompactTag_Archive    = 0x10, // varint length + NSKeyedArchiver data
+	ZDCCompactTag_End        = 0x11,
+	
+	ZDCCompactTag_MutableFlag = 0x80 // OR'd with: String, StringRef, Data, Array, Set, Dictionary
+};
+
+/**
+ * NSKeyedArchiver gives objects a chance to substitute themselves via `replacementObjectForKeyedArchiver:`.
+ * We can't invoke that method ourselves (we're not an NSKeyedArchiver).
+ * So classes that override it are embedded as a keyed archive, which applies the replacement for us.
+ */
+static BOOL ZDCOverridesKeyedArchiverReplacement(Class cls)
+{
+	SEL sel = @selector(replacementObjectForKeyedArchiver:);
+	return ([cls instanceMethodForSelector:sel] != [NSObject instanceMethodForSelector:sel]);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@interface ZDCCompactArchiver : NSCoder
+- (instancetype)initWithData:(NSMutableData *)data;
+- (void)writeValue:(nullable id)value;
+
+/** Set if something couldn't be encoded. The output is incomplete, and must be discarded. */
+@property (nonatomic, copy, readonly, nullable) NSString *failureReason;
+@end
+
+@implementation ZDCCompactArchiver {
+	NSMutableData *buffer;
+	NSMutableDictionary<NSString*, NSNumber*> *stringTable;
+}
+
+@synthesize failureReason = failureReason;
+
+- (instancetype)initWithData:(NSMutableData *)data
+{
+	if ((self = [super init]))
+	{
+		buffer = data;
+		stringTable = [[NSMutableDictionary alloc] init];
+	}
+	return self;
+}
+
+- (BOOL)allowsKeyedCoding
+{
+	return YES;
+}
+
+- (BOOL)requiresSecureCoding
+{
+	return NO;
+}
+
+#pragma mark Primitives
+
+- (void)failWithReason:(NSString *)reason
+{
+	if (failureReason == nil) {
+		failureReason = [reason copy];
+	}
+}
+
+- (void)writeTag:(uint8_t)tag
+{
+	[buffer appendBytes:&tag length:1];
+}
+
+- (void)writeVarint:(uint64_t)value
+{
+	uint8_t bytes[10];
+	NSUInteger count = 0;
+	
+	while (value >= 0x80)
+	{
+		bytes[count++] = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	bytes[count++] = (uint8_t)value;
+	
+	[buffer appendBytes:bytes length:count];
+}
+
+- (void)writeInt:(int64_t)value
+{
+	[self writeTag:ZDCCompactTag_Int];
+	[self writeVarint:(((uint64_t)value << 1) ^ (uint64_t)(value >> 63))]; // zigzag
+}
+
+- (void)writeDouble:(double)value withTag:(uint8_t)tag
+{
+	[self writeTag:tag];
+	
+	CFSwappedFloat64 swapped = CFConvertDoubleHostToSwapped(value); // big endian
+	[buffer appendBytes:&swapped length:sizeof(swapped)];
+}
+
+- (void)writeString:(NSString *)string mutable:(BOOL)isMutable
+{
+	uint8_t flag = isMutable ? ZDCCompactTag_MutableFlag : 0;
+	
+	NSNumber *index = stringTable[string];
+	if (index)
+	{
+		[self writeTag:(ZDCCompactTag_StringRef | flag)];
+		[self writeVarint:index.unsignedLongLongValue];
+		return;
+	}
+	
+	stringTable[string] = @(stringTable.count);
+	
+	NSUInteger length = [string lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+	
+	[self writeTag:(ZDCCompactTag_String | flag)];
+	[self writeVarint:length];
+	
+	NSUInteger offset = buffer.length;
+	[buffer increaseLengthBy:length];
+	
+	[string getBytes: ((uint8_t *)buffer.mutableBytes + offset)
+	       maxLength: length
+	      usedLength: NULL
+	        encoding: NSUTF8StringEncoding
+	         options: 0
+	           range: NSMakeRange(0, string.length)
+	  remainingRange: NULL];
+}
+
+- (void)writeKey:(NSString *)key
+{
+	[self writeString:key mutable:NO];
+}
+
+#pragma mark Values
+
+- (void)writeNumber:(NSNumber *)number
+{
+	if (number == (id)kCFBooleanTrue) {
+		[self writeTag:ZDCCompactTag_True];
+		return;
+	}
+	if (number == (id)kCFBooleanFalse) {
+		[self writeTag:ZDCCompactTag_False];
+		return;
+	}
+	
+	const char *type = number.objCType;
+	switch (type[0])
+	{
+		case 'f':
+		case 'd':
+		{
+			[self writeDouble:number.doubleValue withTag:ZDCCompactTag_Double];
+			break;
+		}
+		case 'Q':
+		{
+			unsigned long long value = number.unsignedLongLongValue;
+			if (value > INT64_MAX)
+			{
+				[self writeTag:ZDCCompactTag_UInt];
+				[self writeVarint:value];
+				break;
+			}
+			// Fall through
+		}
+		default:
+		{
+			[self writeInt:number.longLongValue];
+			break;
+		}
+	}
+}
+
+- (void)writeValue:(nullable id)value
+{
+	if (failureReason) return;
+	
+	// Same as NSKeyedArchiver, give the object a chance to substitute itself.
+	value = [value replacementObjectForCoder:self];
+	
+	if (value == nil)
+	{
+		[self writeTag:ZDCCompactTag_Nil];
+		return;
+	}
+	
+	// We match the class used by NSKeyedArchiver.
+	// This is how mutability is preserved (e.g. __NSArrayM => NSMutableArray).
+	
+	Class cls = [value classForKeyedArchiver] ?: [value class];
+	
+	if (cls == [NSString class] || cls == [NSMutableString class])
+	{
+		[self writeString:(NSString *)value mutable:(cls == [NSMutableString class])];
+	}
+	else if (cls == [NSNumber class])
+	{
+		[self writeNumber:(NSNumber *)value];
+	}
+	else if (cls == [NSData class] || cls == [NSMutableData class])
+	{
+		uint8_t flag = (cls == [NSMutableData class]) ? ZDCCompactTag_MutableFlag : 0;
+		NSData *data = (NSData *)value;
+		
+		[self writeTag:(ZDCCompactTag_Data | flag)];
+		[self writeVarint:data.length];
+		[buffer appendData:data];
+	}
+	else if (cls == [NSDate class])
+	{
+		[self writeDouble:[(NSDate *)value timeIntervalSinceReferenceDate] withTag:ZDCCompactTag_Date];
+	}
+	else if (cls == [NSUUID class])
+	{
+		uuid_t bytes;
+		[(NSUUID *)value getUUIDBytes:bytes];
+		
+		[self writeTag:ZDCCompactTag_UUID];
+		[buffer appendBytes:bytes length:sizeof(uuid_t)];
+	}
+	else if (cls == [NSNull class])
+	{
+		[self writeTag:ZDCCompactTag_Null];
+	}
+	else if (cls == [NSArray class] || cls == [NSMutableArray class]
+	      || cls == [NSSet class]   || cls == [NSMutableSet class])
+	{
+		BOOL isSet = (cls == [NSSet class] || cls == [NSMutableSet class]);
+		BOOL isMutable = (cls == [NSMutableArray class] || cls == [NSMutableSet class]);
+		uint8_t tag = isSet ? ZDCCompactTag_Set : ZDCCompactTag_Array;
+		
+		[self writeTag:(tag | (isMutable ? ZDCCompactTag_MutableFlag : 0))];
+		[self writeVarint:[value count]];
+		
+		for (id item in (id<NSFastEnumeration>)value)
+		{
+			[self writeValue:item];
+		}
+	}
+	else if (cls == [NSDictionary class] || cls == [NSMutableDictionary class])
+	{
+		NSDictionary *dict = (NSDictionary *)value;
+		BOOL isMutable = (cls == [NSMutableDictionary class]);
+		
+		[self writeTag:(ZDCCompactTag_Dictionary | (isMutable ? ZDCCompactTag_MutableFlag : 0))];
+		[self writeVarint:dict.count];
+		
+		[dict enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
+			
+			[self writeValue:key];
+			[self writeValue:obj];
+		}];
+	}
+	else if ([NSStringFromClass(cls) hasPrefix:@"ZDC"]
+	      && [value conformsToProtocol:@protocol(NSCoding)]
+	      && !ZDCOverridesKeyedArchiverReplacement([value class]))
+	{
+		[self writeTag:ZDCCompactTag_Object];
+		[self writeString:NSStringFromClass(cls) mutable:NO];
+		
+		[(id<NSCoding>)value encodeWithCoder:self];
+		
+		[self writeTag:ZDCCompactTag_End];
+	}
+	else
+	{
+		// Unknown class (or one with a custom keyed-archiver replacement): embed a keyed archive
+		
+		NSData *archive = [NSKeyedArchiver archivedDataWithRootObject:value];
+		
+		[self writeTag:ZDCCompactTag_Archive];
+		[self writeVarint:archive.length];
+		[buffer appendData:archive];
+	}
+}
+
+#pragma mark NSCoder
+
+- (void)encodeObject:(nullable id)object forKey:(NSString *)key
+{
+	[self writeKey:key];
+	[self writeValue:object];
+}
+
+- (void)encodeConditionalObject:(nullable id)object forKey:(NSString *)key
+{
+	[self encodeObject:object forKey:key];
+}
+
+- (void)encodeBool:(BOOL)value forKey:(NSString *)key
+{
+	[self writeKey:key];
+	[self writeTag:(value ? ZDCCompactTag_True : ZDCCompactTag_False)];
+}
+
+- (void)encodeInt:(int)value forKey:(NSString *)key
+{
+	[self writeKey:key];
+	[self writeInt:value];
+}
+
+- (void)encodeInt32:(int32_t)value forKey:(NSString *)key
+{
+	[self writeKey:key];
+	[self writeInt:value];
+}
+
+- (void)encodeInt64:(int64_t)value forKey:(NSString *)key
+{
+	[self writeKey:key];
+	[self writeInt:value];
+}
+
+- (void)encodeInteger:(NSInteger)value forKey:(NSString *)key
+{
+	[self writeKey:key];
+	[self writeInt:value];
+}
+
+- (void)encodeFloat:(float)value forKey:(NSString *)key
+{
+	[self writeKey:key];
+	[self writeDouble:value withTag:ZDCCompactTag_Double];
+}
+
+- (void)encodeDouble:(double)value forKey:(NSString *)key
+{
+	[self writeKey:key];
+	[self writeDouble:value withTag:ZDCCompactTag_Double];
+}
+
+- (void)encodeBytes:(nullable const uint8_t *)bytes length:(NSUInteger)length forKey:(NSString *)key
+{
+	[self writeKey:key];
+	[self writeTag:ZDCCompactTag_Data];
+	[self writeVarint:length];
+	if (length > 0) {
+		[buffer appendBytes:bytes length:length];
+	}
+}
+
+- (void)encodeValueOfObjCType:(const char *)type at:(const void *)addr
+{
+	// Only keyed coding is supported.
+	// The caller checks the failureReason, and falls back to NSKeyedArchiver.
+	
+	[self failWithReason:@"Non-keyed coding is not supported"];
+}
+
+- (void)encodeDataObject:(NSData *)data
+{
+	[self failWithReason:@"Non-keyed coding is not supported"];
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@interface ZDCCompactUnarchiver : NSCoder
+- (instancetype)initWithData:(NSData *)data offset:(NSUInteger)offset;
+- (nullable id)readValue;
+
+/** Set if the data is malformed, or doesn't match what the decoded classes expect. */
+@property (nonatomic, copy, readonly, nullable) NSString *failureReason;
+@end
+
+@implementation ZDCCompactUnarchiver {
+	NSData *data;
+	const uint8_t *bytes;
+	NSUInteger length;
+	NSUInteger offset;
+	
+	NSMutableArray<NSString*> *stringTable;
+	
+	NSMutableArray<NSDictionary*> *fieldsStack;
+	NSMutableArray<NSDictionary*> *retainedFields; // keeps decodeBytesForKey: pointers valid
+}
+
+@synthesize failureReason = failureReason;
+
+/**
+ * Stored in the fields dictionary for keys explicitly encoded as nil.
+ * (This way `containsValueForKey:` matches NSKeyedUnarchiver.)
+ */
+static id NilMarker(void)
+{
+	static id marker = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		marker = [[NSObject alloc] init];
+	});
+	
+	return marker;
+}
+
+- (instancetype)initWithData:(NSData *)inData offset:(NSUInteger)inOffset
+{
+	if ((self = [super init]))
+	{
+		data = inData;
+		bytes = (const uint8_t *)inData.bytes;
+		length = inData.length;
+		offset = inOffset;
+		
+		stringTable = [[NSMutableArray alloc] init];
+		
+		fieldsStack = [[NSMutableArray alloc] init];
+		retainedFields = [[NSMutableArray alloc] init];
+	}
+	return self;
+}
+
+- (BOOL)allowsKeyedCoding
+{
+	return YES;
+}
+
+- (BOOL)requiresSecureCoding
+{
+	return NO;
+}
+
+#pragma mark Primitives
+
+/**
+ * Once a failure has been recorded, every read returns a zero value (and tags read as End),
+ * so the decoding unwinds without touching the data again.
+ */
+- (void)failWithReason:(NSString *)reason
+{
+	if (failureReason == nil) {
+		failureReason = [reason copy];
+	}
+}
+
+- (BOOL)requireLength:(NSUInteger)count
+{
+	if (failureReason) {
+		return NO;
+	}
+	if (count > (length - offset)) {
+		[self failWithReason:@"Unexpected end of data"];
+		return NO;
+	}
+	return YES;
+}
+
+- (uint8_t)readTag
+{
+	if (![self requireLength:1]) return ZDCCompactTag_End;
+	return bytes[offset++];
+}
+
+- (uint8_t)peekTag
+{
+	if (![self requireLength:1]) return ZDCCompactTag_End;
+	return bytes[offset];
+}
+
+- (uint64_t)readVarint
+{
+	uint64_t value = 0;
+	NSUInteger shift = 0;
+	
+	while (YES)
+	{
+		if (shift >= 64) {
+			[self failWithReason:@"Malformed varint"];
+		}
+		
+		uint8_t byte = [self readTag];
+		if (failureReason) return 0;
+		
+		value |= ((uint64_t)(byte & 0x7F) << shift);
+		
+		if ((byte & 0x80) == 0) break;
+		shift += 7;
+	}
+	
+	return value;
+}
+
+- (NSUInteger)readLength
+{
+	uint64_t value = [self readVarint];
+	if (![self requireLength:value]) {
+		return 0;
+	}
+	
+	return (NSUInteger)value;
+}
+
+- (double)readDouble
+{
+	CFSwappedFloat64 swapped;
+	
+	if (![self requireLength:sizeof(swapped)]) return 0;
+	memcpy(&swapped, bytes + offset, sizeof(swapped));
+	offset += sizeof(swapped);
+	
+	return CFConvertDoubleSwappedToHost(swapped);
+}
+
+- (NSString *)readStringWithTag:(uint8_t)tag
+{
+	NSString *string = nil;
+	
+	if ((tag & ~ZDCCompactTag_MutableFlag) == ZDCCompactTag_String)
+	{
+		NSUInteger len = [self readLength];
+		if (failureReason) return nil;
+		
+		string = [[NSString alloc] initWithBytes:(bytes + offset) length:len encoding:NSUTF8StringEncoding];
+		offset += len;
+		
+		if (string == nil) {
+			[self failWithReason:@"Invalid string"];
+			return nil;
+		}
+		
+		[stringTable addObject:string];
+	}
+	else if ((tag & ~ZDCCompactTag_MutableFlag) == ZDCCompactTag_StringRef)
+	{
+		uint64_t index = [self readVarint];
+		if (failureReason) return nil;
+		
+		if (index >= stringTable.count) {
+			[self failWithReason:@"Invalid string reference"];
+			return nil;
+		}
+		
+		string = stringTable[(NSUInteger)index];
+	}
+	else
+	{
+		[self failWithReason:[NSString stringWithFormat:@"Expected string, found tag: %u", tag]];
+		return nil;
+	}
+	
+	if (tag & ZDCCompactTag_MutableFlag) {
+		return [string mutableCopy];
+	}
+	return string;
+}
+
+#pragma mark Values
+
+- (nullable id)readObject
+{
+	NSString *className = [self readStringWithTag:[self readTag]];
+	if (failureReason) return nil;
+	
+	Class cls = NSClassFromString(className);
+	if (cls == nil || ![cls conformsToProtocol:@protocol(NSCoding)])
+	{
+		[self failWithReason:[NSString stringWithFormat:@"Unknown class: %@", className]];
+		return nil;
+	}
+	
+	NSMutableDictionary<NSString*, id> *fields = [[NSMutableDictionary alloc] init];
+	
+	while ([self peekTag] != ZDCCompactTag_End)
+	{
+		NSString *key = [self readStringWithTag:[self readTag]];
+		id value = [self readValue];
+		
+		if (failureReason) return nil;
+		fields[key] = value ?: NilMarker();
+	}
+	
+	if (failureReason) return nil;
+	offset++; // End
+	
+	[fieldsStack addObject:fields];
+	[retainedFields addObject:fields];
+	
+	id object = [(id<NSCoding>)[cls alloc] initWithCoder:self];
+	object = [object awakeAfterUsingCoder:self];
+	
+	[fieldsStack removeLastObject];
+	return object;
+}
+
+- (nullable id)readValue
+{
+	if (failureReason) return nil;
+	
+	uint8_t tag = [self readTag];
+	BOOL isMutable = (tag & ZDCCompactTag_MutableFlag) != 0;
+	
+	switch (tag & ~ZDCCompactTag_MutableFlag)
+	{
+		case ZDCCompactTag_Nil    : return nil;
+		case ZDCCompactTag_Null   : return [NSNull null];
+		case ZDCCompactTag_False  : return @NO;
+		case ZDCCompactTag_True   : return @YES;
+		case ZDCCompactTag_Double : return @([self readDouble]);
+		case ZDCCompactTag_Date   : return [NSDate dateWithTimeIntervalSinceReferenceDate:[self readDouble]];
+		
+		case ZDCCompactTag_Int:
+		{
+			uint64_t zigzag = [self readVarint];
+			int64_t value = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+			
+			return @(value);
+		}
+		case ZDCCompactTag_UInt:
+		{
+			return @([self readVarint]);
+		}
+		case ZDCCompactTag_String:
+		case ZDCCompactTag_StringRef:
+		{
+			return [self readStringWithTag:tag];
+		}
+		case ZDCCompactTag_Data:
+		{
+			NSUInteger len = [self readLength];
+			if (failureReason) return nil;
+			
+			NSData *result = isMutable
+			  ? [NSMutableData dataWithBytes:(bytes + offset) length:len]
+			  : [NSData dataWithBytes:(bytes + offset) length:len];
+			offset += len;
+			
+			return result;
+		}
+		case ZDCCompactTag_UUID:
+		{
+			if (![self requireLength:sizeof(uuid_t)]) return nil;
+			NSUUID *uuid = [[NSUUID alloc] initWithUUIDBytes:(bytes + offset)];
+			offset += sizeof(uuid_t);
+			
+			return uuid;
+		}
+		case ZDCCompactTag_Array:
+		case ZDCCompactTag_Set:
+		{
+			NSUInteger count = [self readLength]; // each item is at least 1 byte
+			NSMutableArray *items = [NSMutableArray arrayWithCapacity:count];
+			
+			for (NSUInteger i = 0; i < count && !failureReason; i++)
+			{
+				id item = [self readValue];
+				if (item) {
+					[items addObject:item];
+				}
+			}
+			
+			if ((tag & ~ZDCCompactTag_MutableFlag) == ZDCCompactTag_Set) {
+				return isMutable ? [NSMutableSet setWithArray:items] : [NSSet setWithArray:items];
+			}
+			return isMutable ? items : [items copy];
+		}
+		case ZDCCompactTag_Dictionary:
+		{
+			NSUInteger count = [self readLength];
+			NSMutableDictionary *dict = [NSMutableDictionary dictionaryWithCapacity:count];
+			
+			for (NSUInteger i = 0; i < count && !failureReason; i++)
+			{
+				id key = [self readValue];
+				id value = [self readValue];
+				
+				if (key && value) {
+					dict[key] = value;
+				}
+			}
+			
+			return isMutable ? dict : [dict copy];
+		}
+		case ZDCCompactTag_Object:
+		{
+			return [self readObject];
+		}
+		case ZDCCompactTag_Archive:
+		{
+			NSUInteger len = [self readLength];
+			if (failureReason) return nil;
+			
+			NSData *archive = [data subdataWithRange:NSMakeRange(offset, len)];
+			offset += len;
+			
+			// Unlike `unarchiveObjectWithData:`, this reports problems via the error (instead of raising).
+			NSError *error = nil;
+			id result = [NSKeyedUnarchiver unarchiveTopLevelObjectWithData:archive error:&error];
+			
+			if (error) {
+				[self failWithReason:[NSString stringWithFormat:@"Invalid embedded archive: %@", error]];
+			}
+			return result;
+		}
+		default:
+		{
+			[self failWithReason:[NSString stringWithFormat:@"Unknown tag: %u", tag]];
+			return nil;
+		}
+	}
+}
+
+#pragma mark NSCoder
+
+- (nullable id)fieldForKey:(NSString *)key
+{
+	id value = [fieldsStack lastObject][key];
+	if (value == NilMarker()) {
+		return nil;
+	}
+	return value;
+}
+
+- (BOOL)containsValueForKey:(NSString *)key
+{
+	return ([fieldsStack lastObject][key] != nil);
+}
+
+- (nullable id)decodeObjectForKey:(NSString *)key
+{
+	return [self fieldForKey:key];
+}
+
+/**
+ * A class mismatch means the stored data doesn't match what the class expects.
+ * Silently returning nil would hand back a partially decoded object,
+ * so instead the whole decode fails (and the failure is logged by the caller).
+ */
+- (nullable id)decodeObjectOfClass:(Class)cls forKey:(NSString *)key
+{
+	return [self decodeObjectOfClasses:(cls ? [NSSet setWithObject:cls] : nil) forKey:key];
+}
+
+- (nullable id)decodeObjectOfClasses:(nullable NSSet<Class> *)classes forKey:(NSString *)key
+{
+	id value = [self fieldForKey:key];
+	if (value == nil) {
+		return nil;
+	}
+	
+	for (Class cls in classes)
+	{
+		if ([value isKindOfClass:cls]) {
+			return value;
+		}
+	}
+	
+	[self failWithReason:[NSString stringWithFormat:
+	  @"Class mismatch for key '%@': expected one of %@, found %@", key, classes, [value class]]];
+	
+	return nil;
+}
+
+- (NSNumber *)numberForKey:(NSString *)key
+{
+	id value = [self fieldForKey:key];
+	return [value isKindOfClass:[NSNumber class]] ? (NSNumber *)value : nil;
+}
+
+- (BOOL)decodeBoolForKey:(NSString *)key
+{
+	return [[self numberForKey:key] boolValue];
+}
+
+- (int)decodeIntForKey:(NSString *)key
+{
+	return [[self numberForKey:key] intValue];
+}
+
+- (int32_t)decodeInt32ForKey:(NSString *)key
+{
+	return [[self numberForKey:key] intValue];
+}
+
+- (int64_t)decodeInt64ForKey:(NSString *)key
+{
+	return [[self numberForKey:key] longLongValue];
+}
+
+- (NSInteger)decodeIntegerForKey:(NSString *)key
+{
+	return [[self numberForKey:key] integerValue];
+}
+
+- (float)decodeFloatForKey:(NSString *)key
+{
+	return [[self numberForKey:key] floatValue];
+}
+
+- (double)decodeDoubleForKey:(NSString *)key
+{
+	return [[self numberForKey:key] doubleValue];
+}
+
+- (nullable const uint8_t *)decodeBytesForKey:(NSString *)key returnedLength:(nullable NSUInteger *)lengthp
+{
+	id value = [self fieldForKey:key];
+	
+	if ([value isKindOfClass:[NSData class]])
+	{
+		if (lengthp) *lengthp = [(NSData *)value length];
+		return (const uint8_t *)[(NSData *)value bytes];
+	}
+	
+	if (lengthp) *lengthp = 0;
+	return NULL;
+}
+
+- (void)decodeValueOfObjCType:(const char *)type at:(void *)data
+{
+	[self failWithReason:@"Non-keyed coding is not supported"];
+}
+
+- (nullable NSData *)decodeDataObject
+{
+	[self failWithReason:@"Non-keyed coding is not supported"];
+	return nil;
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation ZDCCompactCoder
+
+/**
+ * See header file for description.
+ */
++ (BOOL)supportsRootObject:(nullable id)object
+{
+	return [object isKindOfClass:[ZDCNode class]]
+	    || [object isKindOfClass:[ZDCCloudOperation class]];
+}
+
+/**
+ * See header file for description.
+ */
++ (BOOL)isCompactData:(nullable NSData *)data
+{
+	if (data.length < (sizeof(kHeader) + 1)) {
+		return NO;
+	}
+	
+	return (memcmp(data.bytes, kHeader, sizeof(kHeader)) == 0);
+}
+
+/**
+ * See header file for description.
+ */
++ (nullable NSData *)archivedDataWithRootObject:(id)object
+{
+	NSMutableData *data = [NSMutableData dataWithCapacity:512];
+	
+	[data appendBytes:kHeader length:sizeof(kHeader)];
+	[data appendBytes:&kCurrentVersion length:1];
+	
+	ZDCCompactArchiver *archiver = [[ZDCCompactArchiver alloc] initWithData:data];
+	[archiver writeValue:object];
+	
+	if (archiver.failureReason)
+	{
+		ZDCLogWarn(@"Unable to compact encode %@: %@", NSStringFromClass([object class]), archiver.failureReason);
+		return nil;
+	}
+	
+	return data;
+}
+
+/**
+ * See header file for description.
+ */
++ (nullable id)unarchiveObjectWithData:(NSData *)data
+{
+	if (![self isCompactData:data]) {
+		return nil;
+	}
+	
+	uint8_t version = ((const uint8_t *)data.bytes)[sizeof(kHeader)];
+	if (version != kCurrentVersion)
+	{
+		ZDCLogWarn(@"Unsupported compact encoding version: %u", version);
+		return nil;
+	}
+	
+	ZDCCompactUnarchiver *unarchiver =
+	  [[ZDCCompactUnarchiver alloc] initWithData:data offset:(sizeof(kHeader) + 1)];
+	
+	id object = [unarchiver readValue];
+	
+	if (unarchiver.failureReason)
+	{
+		ZDCLogError(@"Unable to compact decode: %@", unarchiver.failureReason);
+		
+		return nil;
+	}
+	
+	return object;
+}
+
+@end
@@ -15,6 +15,9 @@
 #import "ZDCLocalUserPrivate.h"
 #import "ZeroDarkCloudPrivate.h"
 
+// Libraries
+#import <YapDatabase/YapDatabaseAtomic.h>
+
 // Categories
 #import "NSError+Auth0API.h"
 #import "NSError+ZeroDark.h"
@@ -24,9 +27,12 @@
 @private
 	
 	__weak ZeroDarkCloud *zdc;
-	dispatch_queue_t serialQueue;
 	
-	NSMutableDictionary *recentRequestDict;  // must access through serialQueue
+	// Tracks the most recent requestIDs (per localUserID), in insertion order.
+	// The ordered set gives us constant-time lookups.
+	//
+	YAPUnfairLock recentRequestLock;
+	NSMutableDictionary<NSString*, NSMutableOrderedSet<NSString*>*> *recentRequestDict; // must access within lock
 }
 
 - (instancetype)init
@@ -39,8 +45,8 @@
 	if ((self = [super init]))
 	{
 		zdc = inOwner;
-		serialQueue = dispatch_queue_create("ZDCNetworkTools", DISPATCH_QUEUE_SERIAL);
 		
+		recentRequestLock = YAP_UNFAIR_LOCK_INIT;
 		recentRequestDict = [[NSMutableDictionary alloc] init];
 	}
 	return self;
@@ -70,28 +76,25 @@
 	if (requestID == nil) return;
 	if (localUserID == nil) return;
 	
-	dispatch_sync(serialQueue, ^{ @autoreleasepool {
-	#pragma clang diagnostic push
-	#pragma clang diagnostic ignored "-Wimplicit-retain-self"
-		
-		NSMutableArray *recents = recentRequestDict[localUserID];
+	YAPUnfairLockLock(&recentRequestLock);
+	{
+		NSMutableOrderedSet<NSString*> *recents = recentRequestDict[localUserID];
 		if (recents == nil)
 		{
-			recents = recentRequestDict[localUserID] = [[NSMutableArray alloc] init];
+			recents = recentRequestDict[localUserID] = [[NSMutableOrderedSet alloc] init];
 		}
 		
 		if (![recents containsObject:requestID])
 		{
-			[recents insertObject:requestID atIndex:0];
+			[recents addObject:requestID];
 			
 			while (recents.count > 100)
 			{
-				[recents removeLastObject];
+				[recents removeObjectAtIndex:0];
 			}
 		}
-		
-	#pragma clang diagnostic pop
-	}});
+	}
+	YAPUnfairLockUnlock(&recentRequestLock);
 }
 
 - (BOOL)isRecentRequestID:(NSString *)requestID forUser:(NSString *)localUserID
@@ -99,20 +102,13 @@
 	if (requestID == nil) return NO;
 	if (localUserID == nil) return NO;
 	
-	__block BOOL result = NO;
+	BOOL result = NO;
 	
-	dispatch_sync(serialQueue, ^{ @autoreleasepool {
-	#pragma clang diagnostic push
-	#pragma clang diagnostic ignored "-Wimplicit-retain-self"
-		
-		NSMutableArray *recents = recentRequestDict[localUserID];
-		if (recents)
-		{
-			result = [recents containsObject:requestID];
-		}
-		
-	#pragma clang diagnostic pop
-	}});
+	YAPUnfairLockLock(&recentRequestLock);
+	{
+		result = [recentRequestDict[localUserID] containsObject:requestID];
+	}
+	YAPUnfairLockUnlock(&recentRequestLock);
 	
 	return result;
 }
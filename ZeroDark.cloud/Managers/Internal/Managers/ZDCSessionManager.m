@@ -179,6 +179,7 @@ static NSString *const kSessionDescriptionPrefix_Foreground = @"fg";
 	}});
 	
 	__block NSMutableArray *missingUserIDs = nil;
+	__block NSMutableDictionary<NSString*, ZDCSessionUserInfo*> *refreshedUserInfo = nil;
 	
 	[internal_roConnection asyncReadWithBlock:^(YapDatabaseReadTransaction *transaction) {
 	#pragma clang diagnostic push
@@ -188,6 +189,10 @@ static NSString *const kSessionDescriptionPrefix_Foreground = @"fg";
 		//
 		// I.E.: The user deleted the local account, so we should cleanup all associated resources.
 		//       Doing so will automatically cancel all uploads too.
+		//
+		// For users that still exist, we rebuild the userInfo snapshot here, in the background.
+		// Otherwise the next call to `sessionInfoForUserID:` would be forced to perform
+		// a synchronous database read on whatever thread is building a request.
 		
 		NSMutableArray *userIDs = [NSMutableArray array];
 		
@@ -211,13 +216,25 @@ static NSString *const kSessionDescriptionPrefix_Foreground = @"fg";
 		if (userIDs.count == 0) return;
 		
 		missingUserIDs = [NSMutableArray arrayWithCapacity:[userIDs count]];
+		refreshedUserInfo = [NSMutableDictionary dictionaryWithCapacity:[userIDs count]];
 		
 		for (NSString *userID in userIDs)
 		{
-			if (![transaction hasObjectForKey:userID inCollection:kZDCCollection_Users])
+			ZDCLocalUser *user = [transaction objectForKey:userID inCollection:kZDCCollection_Users];
+			if (user == nil)
 			{
 				[missingUserIDs addObject:userID];
 			}
+			else if ([user isKindOfClass:[ZDCLocalUser class]])
+			{
+				ZDCSessionUserInfo *userInfo = [[ZDCSessionUserInfo alloc] init];
+				
+				userInfo.region = user.aws_region;
+				userInfo.bucket = user.aws_bucket;
+				userInfo.stage  = user.aws_stage;
+				
+				refreshedUserInfo[userID] = userInfo;
+			}
 		}
 		
 	#pragma clang diagnostic pop
@@ -225,6 +242,26 @@ static NSString *const kSessionDescriptionPrefix_Foreground = @"fg";
 	#pragma clang diagnostic push
 	#pragma clang diagnostic ignored "-Wimplicit-retain-self"
 		
+		[refreshedUserInfo enumerateKeysAndObjectsUsingBlock:
+		  ^(NSString *userID, ZDCSessionUserInfo *userInfo, BOOL *stop)
+		{
+			// Only entries that have already been configured (userInfo != nil) can be refreshed here.
+			// Anything else goes through the standard path in `sessionInfoForUserID:`,
+			// which handles the one-time session configuration.
+			
+			ZDCSessionInfo *sessionInfo = sessionDict[userID];
+			if (sessionInfo == nil)
+				sessionInfo = staleSessionDict[userID];
+			
+			if (sessionInfo.userInfo)
+			{
+				sessionInfo.userInfo = userInfo;
+				
+				sessionDict[userID] = sessionInfo;
+				staleSessionDict[userID] = nil;
+			}
+		}];
+		
 		if (missingUserIDs.count == 0) return;
 		
 		for (NSString *userID in missingUserIDs)
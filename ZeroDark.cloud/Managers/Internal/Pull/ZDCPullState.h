@@ -10,6 +10,7 @@
 #import <Foundation/Foundation.h>
 
 #import "S3ObjectInfo.h"
+#import "ZDCChangeList.h"
 #import "ZDCPullItem.h"
 
 @interface ZDCPullState : NSObject
@@ -25,6 +26,11 @@
 @property (atomic, strong, readonly) NSArray<NSURLSessionTask *> *tasks;
 @property (atomic, assign, readonly) NSUInteger tasksCount;
 
+@property (atomic, strong, readwrite) ZDCChangeList *changeList;
+@property (atomic, assign, readwrite) BOOL isQuickPullHalted;
+
+@property (atomic, assign, readonly) NSUInteger activeChangesCount;
+
 @property (atomic, strong, readonly) NSSet<NSString *>* unprocessedNodeIDs;
 @property (atomic, strong, readonly) NSSet<NSString *>* unprocessedIdentityIDs;
 @property (atomic, strong, readonly) NSSet<NSString *>* unknownUserIDs;
@@ -49,6 +55,80 @@
 
 - (ZDCPullItem *)dequeueItemWithPreferredNodeIDs:(NSSet<NSString *> *)preferredNodeIDs;
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Change Tracking
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * During a quick pull, independent changes are processed concurrently.
+ *
+ * Each change (or group of merged changes) is registered along with its dependency keys.
+ * A change cannot be started if any of its keys overlap with an active change.
+ * If the keys are nil, the change is exclusive: it requires that no other change be active.
+ *
+ * @return YES if the change was started (and is now active), NO if it conflicts with an active change.
+**/
+- (BOOL)startChangeIDs:(NSOrderedSet<NSString *> *)changeIDs dependencyKeys:(NSSet<NSString *> *)keys;
+
+/**
+ * Removes the change from the active list.
+ * Pass the same changeIDs instance that was passed to `startChangeIDs:dependencyKeys:`.
+**/
+- (void)finishChangeIDs:(NSOrderedSet<NSString *> *)changeIDs;
+
+/**
+ * Returns YES if the change is currently being processed (possibly merged into another change).
+**/
+- (BOOL)isActiveChangeID:(NSString *)changeID;
+
+/**
+ * Returns the keys that the given change depends on.
+ * Changes with overlapping keys are processed in order. Other changes may be processed concurrently.
+ *
+ * - every change depends on its fileID, and on the parent directory of every path it touches
+ * - node creation (put-if-nonexistent) depends on other node creations,
+ *   since the parent of a new node may have been created by an earlier change
+ *
+ * Returns nil if the change must be processed exclusively.
+ * For example, delete-node & move may affect an entire subtree, whose paths we don't know.
+ *
+ * @param change
+ *   The change to be processed (possibly the result of merging several changes).
+ *
+ * @param originalChange
+ *   The first change that was merged (i.e. the pending change that the merge started from).
+**/
++ (NSSet<NSString *> *)dependencyKeysForChange:(ZDCChangeItem *)change originalChange:(ZDCChangeItem *)originalChange;
+
+/**
+ * Scans the pending changes (in order), and starts each change that doesn't depend on
+ * any change before it that's still pending or active.
+ * An exclusive change is only started once everything before it has completed,
+ * and nothing after it is started until it completes.
+ *
+ * Nothing is started once the quick pull has been halted (see `isQuickPullHalted`).
+ *
+ * @param maxCount
+ *   The max number of changes to start.
+ *
+ * @param lookahead
+ *   The max number of pending (non-active) changes to scan.
+ *
+ * @param outChangeIDs
+ *   For each returned change, the changeIDs it represents (a change may be the result of merging several).
+ *   Pass these to `finishChangeIDs:` & `[ZDCChangeList didProcessChangeIDs:]`.
+ *
+ * @param outHasPendingChange
+ *   Set to YES if the list contains a pending change that isn't active.
+ *
+ * @return The changes that were started (now active).
+**/
+- (NSArray<ZDCChangeItem *> *)startPendingChangesInList:(ZDCChangeList *)changeList
+                                               maxCount:(NSUInteger)maxCount
+                                              lookahead:(NSUInteger)lookahead
+                                              changeIDs:(NSArray<NSOrderedSet<NSString *> *> **)outChangeIDs
+                                       hasPendingChange:(BOOL *)outHasPendingChange;
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Task Tracking
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -8,6 +8,7 @@
 **/
 
 #import "ZDCPullState.h"
+#import "ZDCCloudPath.h"
 #import "ZDCNode.h"
 
 #import "NSDate+ZeroDark.h"
@@ -26,6 +27,11 @@
 	NSMutableSet<NSString*> *unprocessedIdentityIDs;
 	NSMutableSet<NSString*> *unknownUserIDs;
 	
+	NSMutableDictionary<NSOrderedSet<NSString*>*, id> *activeChanges; // value: NSSet (keys) or NSNull (exclusive)
+	NSMutableSet<NSString*> *activeChangeIDs;
+	NSCountedSet<NSString*> *activeDependencyKeys;
+	NSUInteger activeExclusiveCount;
+	
 	BOOL changeDetected;
 	BOOL authFailed;
 }
@@ -37,7 +43,10 @@
 @synthesize hasProcessedChanges;
 @synthesize needsFetchMoreChanges;
 @synthesize isFullPull;
+@synthesize changeList;
+@synthesize isQuickPullHalted;
 
+@dynamic activeChangesCount;
 @dynamic tasks;
 @dynamic tasksCount;
 @dynamic unprocessedNodeIDs;
@@ -63,6 +72,10 @@
 		unprocessedIdentityIDs = [[NSMutableSet alloc] init];
 		unknownUserIDs         = [[NSMutableSet alloc] init];
 		
+		activeChanges        = [[NSMutableDictionary alloc] init];
+		activeChangeIDs      = [[NSMutableSet alloc] init];
+		activeDependencyKeys = [[NSCountedSet alloc] init];
+		
 		authFailed = NO;
 	}
 	return self;
@@ -279,6 +292,266 @@
 	return nextItem;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Change Tracking
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (BOOL)startChangeIDs:(NSOrderedSet<NSString *> *)changeIDs dependencyKeys:(NSSet<NSString *> *)keys
+{
+	if (changeIDs.count == 0) return NO;
+	
+	__block BOOL started = NO;
+	
+	dispatch_sync(queue, ^{ @autoreleasepool {
+	#pragma clang diagnostic push
+	#pragma clang diagnostic ignored "-Wimplicit-retain-self"
+		
+		if (activeExclusiveCount > 0) {
+			return; // an exclusive change is active
+		}
+		
+		if (keys == nil && activeChanges.count > 0) {
+			return; // exclusive change requires that nothing else be active
+		}
+		
+		for (NSString *changeID in changeIDs)
+		{
+			if ([activeChangeIDs containsObject:changeID]) {
+				return;
+			}
+		}
+		
+		for (NSString *key in keys)
+		{
+			if ([activeDependencyKeys countForObject:key] > 0) {
+				return;
+			}
+		}
+		
+		if (keys)
+		{
+			activeChanges[changeIDs] = keys;
+			for (NSString *key in keys) {
+				[activeDependencyKeys addObject:key];
+			}
+		}
+		else
+		{
+			activeChanges[changeIDs] = [NSNull null];
+			activeExclusiveCount++;
+		}
+		
+		[activeChangeIDs addObjectsFromArray:[changeIDs array]];
+		started = YES;
+		
+	#pragma clang diagnostic pop
+	}});
+	
+	return started;
+}
+
+- (void)finishChangeIDs:(NSOrderedSet<NSString *> *)changeIDs
+{
+	if (changeIDs == nil) return;
+	
+	dispatch_sync(queue, ^{ @autoreleasepool {
+	#pragma clang diagnostic push
+	#pragma clang diagnostic ignored "-Wimplicit-retain-self"
+		
+		id keys = activeChanges[changeIDs];
+		if (keys == nil) {
+			return;
+		}
+		
+		if ([keys isKindOfClass:[NSSet class]])
+		{
+			for (NSString *key in (NSSet<NSString *> *)keys) {
+				[activeDependencyKeys removeObject:key];
+			}
+		}
+		else
+		{
+			activeExclusiveCount--;
+		}
+		
+		for (NSString *changeID in changeIDs) {
+			[activeChangeIDs removeObject:changeID];
+		}
+		
+		[activeChanges removeObjectForKey:changeIDs];
+		
+	#pragma clang diagnostic pop
+	}});
+}
+
+- (BOOL)isActiveChangeID:(NSString *)changeID
+{
+	__block BOOL result = NO;
+	
+	dispatch_sync(queue, ^{ @autoreleasepool {
+	#pragma clang diagnostic push
+	#pragma clang diagnostic ignored "-Wimplicit-retain-self"
+		
+		result = [activeChangeIDs containsObject:changeID];
+		
+	#pragma clang diagnostic pop
+	}});
+	
+	return result;
+}
+
+/**
+ * See header file for description.
+ */
++ (NSSet<NSString *> *)dependencyKeysForChange:(ZDCChangeItem *)change originalChange:(ZDCChangeItem *)originalChange
+{
+	NSString *command = change.command;
+	
+	if ([command isEqualToString:@"update-avatar"])
+	{
+		NSString *path = change.path;
+		if (path == nil) return nil;
+		
+		return [NSSet setWithObject:[@"avatar:" stringByAppendingString:path]];
+	}
+	
+	if ([command isEqualToString:@"move"] || [originalChange.command isEqualToString:@"move"])
+	{
+		// Moving a directory changes the path of every node in its subtree.
+		// And a change within the subtree may refer to either the old or new path.
+		return nil;
+	}
+	
+	NSString *fileID = change.fileID;
+	if (fileID == nil) return nil;
+	
+	NSMutableSet<NSString *> *keys = [NSMutableSet setWithCapacity:4];
+	NSMutableArray<NSString *> *paths = [NSMutableArray arrayWithCapacity:2];
+	
+	[keys addObject:[@"file:" stringByAppendingString:fileID]];
+	
+	if ([command isEqualToString:@"put-if-match"] ||
+	    [command isEqualToString:@"put-if-nonexistent"] ||
+	    [command isEqualToString:@"delete-leaf"])
+	{
+		if (change.path) [paths addObject:change.path];
+	}
+	else
+	{
+		// delete-node, update-auth0, unknown commands
+		return nil;
+	}
+	
+	if ([command isEqualToString:@"put-if-nonexistent"] ||
+	    [originalChange.command isEqualToString:@"put-if-nonexistent"])
+	{
+		[keys addObject:@"create"];
+	}
+	
+	if (originalChange.path) [paths addObject:originalChange.path];
+	if (paths.count == 0) return nil;
+	
+	for (NSString *path in paths)
+	{
+		ZDCCloudPath *cloudPath = [[ZDCCloudPath alloc] initWithPath:path];
+		if (cloudPath == nil) return nil;
+		
+		[keys addObject:[NSString stringWithFormat:@"dir:%@/%@", cloudPath.treeID, cloudPath.dirPrefix]];
+	}
+	
+	return keys;
+}
+
+/**
+ * See header file for description.
+ */
+- (NSArray<ZDCChangeItem *> *)startPendingChangesInList:(ZDCChangeList *)inChangeList
+                                               maxCount:(NSUInteger)maxCount
+                                              lookahead:(NSUInteger)maxLookahead
+                                              changeIDs:(NSArray<NSOrderedSet<NSString *> *> **)outChangeIDs
+                                       hasPendingChange:(BOOL *)outHasPendingChange
+{
+	NSMutableArray<ZDCChangeItem *> *changes = [NSMutableArray arrayWithCapacity:maxCount];
+	NSMutableArray<NSOrderedSet<NSString *> *> *changeIDsList = [NSMutableArray arrayWithCapacity:maxCount];
+	
+	NSMutableSet<NSString *> *blockedKeys = [NSMutableSet set];
+	__block BOOL hasBlockedChange = NO;
+	__block BOOL hasPendingChange = NO;
+	__block NSUInteger lookahead = 0;
+	
+	[inChangeList enumeratePendingChangesUsingBlock:^(ZDCChangeItem *pendingChange, BOOL *stop) {
+		
+		if ([self isActiveChangeID:pendingChange.uuid])
+		{
+			// Already being processed (possibly merged into another change).
+			return;
+		}
+		
+		hasPendingChange = YES;
+		
+		if (self.isQuickPullHalted || changes.count >= maxCount || lookahead++ >= maxLookahead)
+		{
+			*stop = YES;
+			return;
+		}
+		
+		NSOrderedSet<NSString *> *changeIDs = nil;
+		ZDCChangeItem *change = [inChangeList popPendingChange:pendingChange changeIDs:&changeIDs];
+		
+		NSSet<NSString *> *keys = [[self class] dependencyKeysForChange:change originalChange:pendingChange];
+		
+		BOOL canStart;
+		if (keys == nil)
+			canStart = !hasBlockedChange; // exclusive: everything before it must be complete
+		else
+			canStart = ![keys intersectsSet:blockedKeys];
+		
+		if (canStart) {
+			canStart = [self startChangeIDs:changeIDs dependencyKeys:keys];
+		}
+		
+		if (canStart)
+		{
+			[changes addObject:change];
+			[changeIDsList addObject:changeIDs];
+		}
+		else
+		{
+			hasBlockedChange = YES;
+			
+			if (keys == nil)
+			{
+				// Nothing after an exclusive change can be started.
+				*stop = YES;
+			}
+			else
+			{
+				[blockedKeys unionSet:keys];
+			}
+		}
+	}];
+	
+	if (outChangeIDs) *outChangeIDs = changeIDsList;
+	if (outHasPendingChange) *outHasPendingChange = hasPendingChange;
+	return changes;
+}
+
+- (NSUInteger)activeChangesCount
+{
+	__block NSUInteger result = 0;
+	
+	dispatch_sync(queue, ^{ @autoreleasepool {
+	#pragma clang diagnostic push
+	#pragma clang diagnostic ignored "-Wimplicit-retain-self"
+		
+		result = activeChanges.count;
+		
+	#pragma clang diagnostic pop
+	}});
+	
+	return result;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Task Tracking
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,69 @@
+/**
+ * ZeroDark.cloud
+ * 
+ * Homepage      : https://www.zerodark.cloud
+ * GitHub        : https://github.com/4th-ATechnologies/ZeroDark.cloud
+ * Documentation : https://zerodarkcloud.readthedocs.io/en/latest/
+ * API Reference : https://apis.zerodark.cloud
+**/
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * A thread-safe registry, designed for tracking in-flight network contexts.
+ *
+ * Each entry is keyed by the (operationUUID, requestID) tuple.
+ * So when an operation is retried (with a new requestID), the context of the retry is tracked separately
+ * from any stale context of the previous request.
+ *
+ * Each key maps to a set of objects, which are compared by identity (not by `isEqual:`).
+ * Insert, lookup & removal are constant time.
+ *
+ * The registry is split into shards (selected by the hash of the operationUUID),
+ * each protected by its own unfair lock.
+ * So threads working with different operations rarely contend,
+ * and no method ever hops onto a dispatch queue.
+ */
+@interface ZDCInFlightRegistry<ObjectType> : NSObject
+
+/**
+ * Creates a registry with the default number of shards (16).
+ */
+- (instancetype)init;
+
+/**
+ * Creates a registry with the given number of shards.
+ * The value is rounded up to the next power of 2.
+ */
+- (instancetype)initWithShardCount:(NSUInteger)shardCount;
+
+/**
+ * Adds the object to the set of objects for the given (operationUUID, requestID) tuple.
+ * Adding the same object (identity) twice has no effect.
+ */
+- (void)addObject:(ObjectType)object forOperationUUID:(NSUUID *)operationUUID requestID:(NSString *)requestID;
+
+/**
+ * Removes the object (identity) from the set of objects for the given (operationUUID, requestID) tuple.
+ *
+ * If the requestID is nil, the object is removed from every request of the operation.
+ */
+- (void)removeObject:(ObjectType)object
+    forOperationUUID:(NSUUID *)operationUUID
+           requestID:(nullable NSString *)requestID;
+
+/**
+ * Returns a snapshot of the objects registered for the given (operationUUID, requestID) tuple.
+ */
+- (NSArray<ObjectType> *)objectsForOperationUUID:(NSUUID *)operationUUID requestID:(NSString *)requestID;
+
+/**
+ * Returns a snapshot of the objects registered for every request of the given operation.
+ */
+- (NSArray<ObjectType> *)objectsForOperationUUID:(NSUUID *)operationUUID;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,207 @@
+/**
+ * ZeroDark.cloud
+ * 
+ * Homepage      : https://www.zerodark.cloud
+ * GitHub        : https://github.com/4th-ATechnologies/ZeroDark.cloud
+ * Documentation : https://zerodarkcloud.readthedocs.io/en/latest/
+ * API Reference : https://apis.zerodark.cloud
+**/
+
+#import "ZDCInFlightRegistry.h"
+
+#import <YapDatabase/YapDatabaseAtomic.h>
+
+static NSUInteger const kDefaultShardCount = 16;
+
+/**
+ * A single shard of the registry.
+ * The table must only be accessed while holding the lock.
+ *
+ * table[operationUUID][requestID] => objects
+ */
+@interface ZDCInFlightRegistryShard : NSObject
+{
+@public
+	
+	YAPUnfairLock lock;
+	NSMutableDictionary<NSUUID *, NSMutableDictionary<NSString *, NSHashTable *> *> *table;
+}
+@end
+
+@implementation ZDCInFlightRegistryShard
+
+- (instancetype)init
+{
+	if ((self = [super init]))
+	{
+		lock = YAP_UNFAIR_LOCK_INIT;
+		table = [[NSMutableDictionary alloc] init];
+	}
+	return self;
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation ZDCInFlightRegistry
+{
+	NSArray<ZDCInFlightRegistryShard *> *shards;
+	NSUInteger shardMask;
+}
+
+- (instancetype)init
+{
+	return [self initWithShardCount:kDefaultShardCount];
+}
+
+- (instancetype)initWithShardCount:(NSUInteger)inShardCount
+{
+	if ((self = [super init]))
+	{
+		NSUInteger shardCount = 1;
+		while (shardCount < inShardCount) {
+			shardCount <<= 1;
+		}
+		
+		NSMutableArray<ZDCInFlightRegistryShard *> *_shards = [NSMutableArray arrayWithCapacity:shardCount];
+		for (NSUInteger i = 0; i < shardCount; i++)
+		{
+			[_shards addObject:[[ZDCInFlightRegistryShard alloc] init]];
+		}
+		
+		shards = [_shards copy];
+		shardMask = shardCount - 1;
+	}
+	return self;
+}
+
+- (ZDCInFlightRegistryShard *)shardForOperationUUID:(NSUUID *)operationUUID
+{
+	// The hash of many Foundation objects is poorly distributed in the low bits.
+	// So we mix the bits before masking.
+	
+	NSUInteger hash = [operationUUID hash];
+	hash ^= (hash >> 16);
+	hash *= 0x45d9f3b;
+	hash ^= (hash >> 16);
+	
+	return shards[hash & shardMask];
+}
+
+/**
+ * See header file for description.
+ */
+- (void)addObject:(id)object forOperationUUID:(NSUUID *)operationUUID requestID:(NSString *)requestID
+{
+	NSParameterAssert(object != nil);
+	NSParameterAssert(operationUUID != nil);
+	NSParameterAssert(requestID != nil);
+	
+	ZDCInFlightRegistryShard *shard = [self shardForOperationUUID:operationUUID];
+	
+	YAPUnfairLockLock(&shard->lock);
+	{
+		NSMutableDictionary<NSString *, NSHashTable *> *requests = shard->table[operationUUID];
+		if (requests == nil)
+		{
+			requests = [[NSMutableDictionary alloc] initWithCapacity:1];
+			shard->table[operationUUID] = requests;
+		}
+		
+		NSHashTable *objects = requests[requestID];
+		if (objects == nil)
+		{
+			objects = [[NSHashTable alloc] initWithOptions: NSPointerFunctionsStrongMemory |
+			                                                NSPointerFunctionsObjectPointerPersonality
+			                                      capacity: 1];
+			requests[requestID] = objects;
+		}
+		
+		[objects addObject:object];
+	}
+	YAPUnfairLockUnlock(&shard->lock);
+}
+
+/**
+ * See header file for description.
+ */
+- (void)removeObject:(id)object forOperationUUID:(NSUUID *)operationUUID requestID:(NSString *)requestID
+{
+	NSParameterAssert(object != nil);
+	NSParameterAssert(operationUUID != nil);
+	
+	ZDCInFlightRegistryShard *shard = [self shardForOperationUUID:operationUUID];
+	
+	YAPUnfairLockLock(&shard->lock);
+	{
+		NSMutableDictionary<NSString *, NSHashTable *> *requests = shard->table[operationUUID];
+		
+		NSArray<NSString *> *matchingRequestIDs = nil;
+		if (requestID)
+			matchingRequestIDs = requests[requestID] ? @[ requestID ] : nil;
+		else
+			matchingRequestIDs = [requests allKeys];
+		
+		for (NSString *matchingRequestID in matchingRequestIDs)
+		{
+			NSHashTable *objects = requests[matchingRequestID];
+			
+			[objects removeObject:object];
+			if (objects.count == 0) {
+				[requests removeObjectForKey:matchingRequestID];
+			}
+		}
+		
+		if (requests && requests.count == 0) {
+			[shard->table removeObjectForKey:operationUUID];
+		}
+	}
+	YAPUnfairLockUnlock(&shard->lock);
+}
+
+/**
+ * See header file for description.
+ */
+- (NSArray *)objectsForOperationUUID:(NSUUID *)operationUUID requestID:(NSString *)requestID
+{
+	NSParameterAssert(operationUUID != nil);
+	NSParameterAssert(requestID != nil);
+	
+	ZDCInFlightRegistryShard *shard = [self shardForOperationUUID:operationUUID];
+	NSArray *result = nil;
+	
+	YAPUnfairLockLock(&shard->lock);
+	{
+		result = [shard->table[operationUUID][requestID] allObjects];
+	}
+	YAPUnfairLockUnlock(&shard->lock);
+	
+	return result ?: @[];
+}
+
+/**
+ * See header file for description.
+ */
+- (NSArray *)objectsForOperationUUID:(NSUUID *)operationUUID
+{
+	NSParameterAssert(operationUUID != nil);
+	
+	ZDCInFlightRegistryShard *shard = [self shardForOperationUUID:operationUUID];
+	NSMutableArray *result = [NSMutableArray array];
+	
+	YAPUnfairLockLock(&shard->lock);
+	{
+		for (NSHashTable *objects in [shard->table[operationUUID] objectEnumerator])
+		{
+			[result addObjectsFromArray:[objects allObjects]];
+		}
+	}
+	YAPUnfairLockUnlock(&shard->lock);
+	
+	return result;
+}
+
+@end
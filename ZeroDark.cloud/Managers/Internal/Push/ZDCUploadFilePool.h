@@ -0,0 +1,65 @@
+/**
+ * ZeroDark.cloud
+ * 
+ * Homepage      : https://www.zerodark.cloud
+ * GitHub        : https://github.com/4th-ATechnologies/ZeroDark.cloud
+ * Documentation : https://zerodarkcloud.readthedocs.io/en/latest/
+ * API Reference : https://apis.zerodark.cloud
+**/
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Background NSURLSession's only support file upload tasks.
+ * So small uploads (e.g. rcrd files) must first be written to a temp file.
+ *
+ * This class maintains a pool of reusable temp files for this purpose.
+ * Reusing a file avoids the filesystem metadata work of creating & deleting a file for every upload.
+ * And the SHA-256 (required by AWS) is calculated while the data is being written,
+ * so the data is only traversed once.
+ *
+ * Only files created by this instance (during this app launch) are ever recycled.
+ * Any other URL given to `recycleFileURL:` is simply deleted.
+ */
+@interface ZDCUploadFilePool : NSObject
+
+/**
+ * @param directoryURL
+ *   The directory in which to create the temp files.
+ *
+ * @param maxIdleFiles
+ *   The maximum number of (empty) files to keep around for reuse.
+ */
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL maxIdleFiles:(NSUInteger)maxIdleFiles;
+
+/**
+ * Checks out a file from the pool (or creates a new one), and writes the data to it.
+ *
+ * @param data
+ *   The data to write.
+ *
+ * @param outSHA256Hash
+ *   On success, the SHA-256 of the data (as a lowercase hex string).
+ *
+ * @param outError
+ *   Set if an error occurs while writing.
+ *
+ * @return
+ *   The fileURL that was written to.
+ *   The caller owns this file until it's passed to `recycleFileURL:`.
+ *   Returns nil if any error occurs (the partially written file is never handed out).
+ */
+- (nullable NSURL *)writeData:(NSData *)data
+          sha256Hash:(NSString *_Nullable *_Nullable)outSHA256Hash
+               error:(NSError *_Nullable *_Nullable)outError;
+
+/**
+ * Returns the file to the pool (or deletes it, if the pool is full, or the file didn't come from the pool).
+ */
+- (void)recycleFileURL:(NSURL *)fileURL;
+
+@end
+
+NS_ASSUME_NONNULL_END
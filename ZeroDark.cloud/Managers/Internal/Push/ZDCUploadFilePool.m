@@ -0,0 +1,210 @@
+/**
+ * ZeroDark.cloud
+ * 
+ * Homepage      : https://www.zerodark.cloud
+ * GitHub        : https://github.com/4th-ATechnologies/ZeroDark.cloud
+ * Documentation : https://zerodarkcloud.readthedocs.io/en/latest/
+ * API Reference : https://apis.zerodark.cloud
+**/
+
+#import "ZDCUploadFilePool.h"
+
+#import "ZDCLogging.h"
+
+// Categories
+#import "NSData+AWSUtilities.h"
+
+// Libraries
+#import <CommonCrypto/CommonDigest.h>
+#import <YapDatabase/YapDatabaseAtomic.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// Log Levels: off, error, warn, info, verbose
+// Log Flags : trace
+#if DEBUG
+  static const int zdcLogLevel = ZDCLogLevelWarning;
+#else
+  static const int zdcLogLevel = ZDCLogLevelWarning;
+#endif
+#pragma unused(zdcLogLevel)
+
+/**
+ * The data is written (and hashed) in chunks of this size,
+ * so each chunk is still in the cache when it's hashed.
+ */
+static NSUInteger const kWriteChunkSize = (1024 * 64);
+
+@implementation ZDCUploadFilePool
+{
+	NSURL *directoryURL;
+	NSUInteger maxIdleFiles;
+	
+	YAPUnfairLock lock;
+	NSMutableArray<NSURL *> *idleFileURLs; // must be accessed within lock
+	NSMutableSet<NSURL *> *poolFileURLs;   // must be accessed within lock
+}
+
+- (instancetype)initWithDirectoryURL:(NSURL *)inDirectoryURL maxIdleFiles:(NSUInteger)inMaxIdleFiles
+{
+	if ((self = [super init]))
+	{
+		directoryURL = [inDirectoryURL copy];
+		maxIdleFiles = inMaxIdleFiles;
+		
+		lock = YAP_UNFAIR_LOCK_INIT;
+		idleFileURLs = [[NSMutableArray alloc] init];
+		poolFileURLs = [[NSMutableSet alloc] init];
+	}
+	return self;
+}
+
+- (NSURL *)checkoutFileURL
+{
+	NSURL *fileURL = nil;
+	
+	YAPUnfairLockLock(&lock);
+	{
+		fileURL = [idleFileURLs lastObject];
+		if (fileURL)
+		{
+			[idleFileURLs removeLastObject];
+		}
+		else
+		{
+			NSString *fileName = [NSString stringWithFormat:@"upload-%@", [[NSUUID UUID] UUIDString]];
+			
+			fileURL = [directoryURL URLByAppendingPathComponent:fileName isDirectory:NO];
+			[poolFileURLs addObject:fileURL];
+		}
+	}
+	YAPUnfairLockUnlock(&lock);
+	
+	return fileURL;
+}
+
+/**
+ * See header file for description.
+ */
+- (NSURL *)writeData:(NSData *)data
+          sha256Hash:(NSString **)outSHA256Hash
+               error:(NSError **)outError
+{
+	NSURL *fileURL = [self checkoutFileURL];
+	
+	NSString *sha256Hash = nil;
+	NSError *error = nil;
+	
+	// Idle files have already been truncated (in recycleFileURL:).
+	// So we don't need O_TRUNC here, and the file is written with: open, write, close.
+	
+	int fd = open([fileURL fileSystemRepresentation], (O_WRONLY | O_CREAT), 0600);
+	if (fd < 0)
+	{
+		error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+	}
+	else
+	{
+		CC_SHA256_CTX ctx;
+		CC_SHA256_Init(&ctx);
+		
+		const uint8_t *bytes = (const uint8_t *)data.bytes;
+		NSUInteger length = data.length;
+		NSUInteger offset = 0;
+		
+		while (offset < length)
+		{
+			NSUInteger chunkLength = MIN(kWriteChunkSize, (length - offset));
+			
+			ssize_t written = write(fd, (bytes + offset), chunkLength);
+			if (written < 0)
+			{
+				if (errno == EINTR) continue;
+				
+				error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+				break;
+			}
+			
+			CC_SHA256_Update(&ctx, (bytes + offset), (CC_LONG)written);
+			offset += (NSUInteger)written;
+		}
+		
+		close(fd);
+		
+		if (!error)
+		{
+			uint8_t hashBytes[CC_SHA256_DIGEST_LENGTH];
+			CC_SHA256_Final(hashBytes, &ctx);
+			
+			NSData *hash = [NSData dataWithBytesNoCopy:(void *)hashBytes length:CC_SHA256_DIGEST_LENGTH freeWhenDone:NO];
+			sha256Hash = [hash lowercaseHexString];
+		}
+	}
+	
+	if (error)
+	{
+		// Don't hand out a partially written file.
+		// The caller must not upload it, so we take it back now.
+		
+		[self recycleFileURL:fileURL];
+		fileURL = nil;
+	}
+	
+	if (outSHA256Hash) *outSHA256Hash = sha256Hash;
+	if (outError) *outError = error;
+	return fileURL;
+}
+
+/**
+ * See header file for description.
+ */
+- (void)recycleFileURL:(NSURL *)fileURL
+{
+	if (fileURL == nil) return;
+	
+	BOOL isPoolFile = NO;
+	
+	YAPUnfairLockLock(&lock);
+	{
+		isPoolFile = [poolFileURLs containsObject:fileURL];
+	}
+	YAPUnfairLockUnlock(&lock);
+	
+	BOOL reuse = NO;
+	if (isPoolFile)
+	{
+		// Truncate the file, so it doesn't hold on to the disk space (or the data) while idle.
+		reuse = (truncate([fileURL fileSystemRepresentation], 0) == 0);
+	}
+	
+	if (reuse)
+	{
+		YAPUnfairLockLock(&lock);
+		{
+			if (idleFileURLs.count < maxIdleFiles) {
+				[idleFileURLs addObject:fileURL];
+			}
+			else {
+				[poolFileURLs removeObject:fileURL];
+				reuse = NO;
+			}
+		}
+		YAPUnfairLockUnlock(&lock);
+	}
+	else if (isPoolFile)
+	{
+		YAPUnfairLockLock(&lock);
+		{
+			[poolFileURLs removeObject:fileURL];
+		}
+		YAPUnfairLockUnlock(&lock);
+	}
+	
+	if (!reuse)
+	{
+		[[NSFileManager defaultManager] removeItemAtURL:fileURL error:nil];
+	}
+}
+
+@end
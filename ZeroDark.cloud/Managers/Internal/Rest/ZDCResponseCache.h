@@ -0,0 +1,62 @@
+/**
+ * ZeroDark.cloud
+ *
+ * Homepage      : https://www.zerodark.cloud
+ * GitHub        : https://github.com/4th-ATechnologies/ZeroDark.cloud
+ * Documentation : https://zerodarkcloud.readthedocs.io/en/latest/
+ * API Reference : https://apis.zerodark.cloud
+**/
+
+#import <Foundation/Foundation.h>
+#import <YapDatabase/YapDatabase.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Shared cache layer for idempotent GET endpoints, backed by the kZDCCollection_CachedResponse collection.
+ *
+ * - Fresh entries (younger than `ttl`) are served from the database, without touching the network.
+ * - Stale entries with an eTag are revalidated via "If-None-Match".
+ *   A 304 response simply extends the freshness of the existing entry.
+ * - Concurrent requests for the same cacheKey are coalesced into a single network request.
+ * - The number of entries is bounded. When exceeded, the entries closest to their uncacheDate are evicted first.
+ *
+ * Only entries written by this class are ever evicted.
+ * Other entries in the collection (e.g. config & billing) are left alone.
+ */
+@interface ZDCResponseCache : NSObject
+
+/**
+ * @param roConnection
+ *   Used to read cached entries.
+ *
+ * @param rwConnection
+ *   Used to write (and evict) cached entries.
+ */
+- (instancetype)initWithReadConnection:(YapDatabaseConnection *)roConnection
+                       writeConnection:(YapDatabaseConnection *)rwConnection;
+
+/**
+ * Serves the response from the cache if possible, and otherwise invokes the networkBlock.
+ *
+ * The networkBlock performs the actual request. It's handed the eTag of the stale entry (if any),
+ * and must invoke the `done` block with the response & the raw response data.
+ * Only 200 responses for which `isCacheable(data)` returns YES are stored.
+ *
+ * The completionBlock is invoked on a background queue.
+ * When the result is served from the cache, the response parameter is nil.
+ */
+- (void)cachedResponseForKey:(NSString *)cacheKey
+                         ttl:(NSTimeInterval)ttl
+                 isCacheable:(nullable BOOL (^)(NSData *data))isCacheable
+                networkBlock:(void (^)(NSString *_Nullable eTag,
+                                       void (^done)(NSURLResponse *_Nullable response,
+                                                    NSData *_Nullable data,
+                                                    NSError *_Nullable error)))networkBlock
+             completionBlock:(void (^)(NSURLResponse *_Nullable response,
+                                       NSData *_Nullable data,
+                                       NSError *_Nullable error))completionBlock;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,233 @@
+/**
+ * ZeroDark.cloud
+ *
+ * Homepage      : https://www.zerodark.cloud
+ * GitHub        : https://github.com/4th-ATechnologies/ZeroDark.cloud
+ * Documentation : https://zerodarkcloud.readthedocs.io/en/latest/
+ * API Reference : https://apis.zerodark.cloud
+**/
+
+#import "ZDCResponseCache.h"
+
+#import "ZDCAsyncCompletionDispatch.h"
+#import "ZDCCachedResponse.h"
+#import "ZDCConstants.h"
+
+// Categories
+#import "NSURLResponse+ZeroDark.h"
+
+// Stale entries that have an eTag are kept around this long, so they can be revalidated via "If-None-Match".
+static NSTimeInterval const kCacheRevalidationWindow = (60 * 60 * 24);           // 24 hours
+
+// Upper bound on the number of (shared cache) entries in the kZDCCollection_CachedResponse collection.
+static NSUInteger const kCacheMaxEntries = 512;
+
+// Prefix for the keys of the shared cache entries.
+// Other entries in the collection (e.g. config & billing) are never touched by eviction.
+static NSString *const kCacheKeyPrefix = @"cache|";
+
+@implementation ZDCResponseCache {
+@private
+	
+	YapDatabaseConnection *roConnection;
+	YapDatabaseConnection *rwConnection;
+	
+	ZDCAsyncCompletionDispatch *asyncCompletionDispatch;
+	
+	NSMutableDictionary<NSString*, NSDate*> *cacheIndex; // only accessed within rwConnection transactions
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wimplicit-retain-self"
+
+- (instancetype)initWithReadConnection:(YapDatabaseConnection *)inRoConnection
+                       writeConnection:(YapDatabaseConnection *)inRwConnection
+{
+	if ((self = [super init]))
+	{
+		roConnection = inRoConnection;
+		rwConnection = inRwConnection;
+		
+		asyncCompletionDispatch = [[ZDCAsyncCompletionDispatch alloc] init];
+	}
+	return self;
+}
+
+/**
+ * See header file for description.
+ */
+- (void)cachedResponseForKey:(NSString *)cacheKey
+                         ttl:(NSTimeInterval)ttl
+                 isCacheable:(nullable BOOL (^)(NSData *data))isCacheable
+                networkBlock:(void (^)(NSString *_Nullable eTag,
+                                       void (^done)(NSURLResponse *_Nullable response,
+                                                    NSData *_Nullable data,
+                                                    NSError *_Nullable error)))networkBlock
+             completionBlock:(void (^)(NSURLResponse *_Nullable response,
+                                       NSData *_Nullable data,
+                                       NSError *_Nullable error))completionBlock
+{
+	NSString *requestKey = [NSString stringWithFormat:@"%@|%@", NSStringFromSelector(_cmd), cacheKey];
+	dispatch_queue_t bgQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+	
+	NSUInteger requestCount =
+	  [asyncCompletionDispatch pushCompletionQueue: bgQueue
+	                               completionBlock: completionBlock
+	                                        forKey: requestKey];
+	
+	if (requestCount > 1)
+	{
+		// There's a previous request currently in-flight.
+		// The <completionQueue, completionBlock> have been added to the existing request's list.
+		return;
+	}
+	
+	void (^InvokeCompletionBlocks)(NSURLResponse*, NSData*, NSError*) =
+	^(NSURLResponse *response, NSData *data, NSError *error) {
+		
+		NSArray<dispatch_queue_t> * completionQueues = nil;
+		NSArray<id>               * completionBlocks = nil;
+		[asyncCompletionDispatch popCompletionQueues: &completionQueues
+		                            completionBlocks: &completionBlocks
+		                                      forKey: requestKey];
+		
+		for (NSUInteger i = 0; i < completionBlocks.count; i++)
+		{
+			dispatch_queue_t completionQueue = completionQueues[i];
+			void (^completionBlock)(NSURLResponse*, NSData*, NSError*) = completionBlocks[i];
+			
+			dispatch_async(completionQueue, ^{ @autoreleasepool {
+				completionBlock(response, data, error);
+			}});
+		}
+	};
+	
+	NSString *storageKey = [kCacheKeyPrefix stringByAppendingString:cacheKey];
+	__block ZDCCachedResponse *cachedResponse = nil;
+	
+	[roConnection asyncReadWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		cachedResponse = [transaction objectForKey:storageKey inCollection:kZDCCollection_CachedResponse];
+		
+	} completionQueue:bgQueue completionBlock:^{
+		
+		NSDate *now = [NSDate date];
+		NSString *staleETag = nil;
+		
+		if (cachedResponse.data && ([cachedResponse.uncacheDate timeIntervalSinceDate:now] > 0))
+		{
+			NSDate *staleDate = cachedResponse.staleDate ?: cachedResponse.uncacheDate;
+			if ([staleDate timeIntervalSinceDate:now] > 0)
+			{
+				InvokeCompletionBlocks(nil, cachedResponse.data, nil);
+				return;
+			}
+			
+			staleETag = cachedResponse.eTag;
+		}
+		
+		networkBlock(staleETag, ^(NSURLResponse *response, NSData *data, NSError *error) {
+			
+			NSInteger statusCode = response.httpStatusCode;
+			
+			if (staleETag && (statusCode == 304))
+			{
+				// Not Modified - due to If-None-Match header.
+				// The entry we have is still valid, so we just need to extend its freshness.
+				
+				[self storeCachedResponseData: cachedResponse.data
+				                         eTag: staleETag
+				                 lastModified: cachedResponse.lastModified
+				                          ttl: ttl
+				                       forKey: storageKey];
+				
+				InvokeCompletionBlocks(nil, cachedResponse.data, nil);
+				return;
+			}
+			
+			if (!error && (statusCode == 200) && data && (!isCacheable || isCacheable(data)))
+			{
+				[self storeCachedResponseData: data
+				                         eTag: response.eTag
+				                 lastModified: response.lastModified
+				                          ttl: ttl
+				                       forKey: storageKey];
+			}
+			
+			InvokeCompletionBlocks(response, data, error);
+		});
+	}];
+}
+
+/**
+ * Writes the entry to the kZDCCollection_CachedResponse collection,
+ * and evicts entries if the shared cache has grown beyond kCacheMaxEntries.
+ *
+ * Eviction works from an in-memory index of <storageKey, uncacheDate>,
+ * so we never have to enumerate (or deserialize) the objects in the collection.
+ * Only keys with the kCacheKeyPrefix are indexed, so entries stored by other code are never evicted.
+ */
+- (void)storeCachedResponseData:(NSData *)data
+                           eTag:(nullable NSString *)eTag
+                   lastModified:(nullable NSDate *)lastModified
+                            ttl:(NSTimeInterval)ttl
+                         forKey:(NSString *)storageKey
+{
+	// Entries without an eTag can't be revalidated, so there's no point in keeping them once they're stale.
+	NSTimeInterval timeout = eTag ? (ttl + kCacheRevalidationWindow) : ttl;
+	
+	ZDCCachedResponse *cachedResponse = [[ZDCCachedResponse alloc] initWithData:data timeout:timeout];
+	cachedResponse.staleDate = [NSDate dateWithTimeIntervalSinceNow:ttl];
+	cachedResponse.eTag = eTag;
+	cachedResponse.lastModified = lastModified;
+	
+	[rwConnection asyncReadWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		if (cacheIndex == nil)
+		{
+			// First write since launch.
+			// Index the existing entries by key only. Their uncacheDate is unknown,
+			// so we treat them as the oldest entries (first in line for eviction).
+			
+			cacheIndex = [[NSMutableDictionary alloc] init];
+			
+			[transaction enumerateKeysInCollection: kZDCCollection_CachedResponse
+			                            usingBlock:^(NSString *key, BOOL *stop)
+			{
+				if ([key hasPrefix:kCacheKeyPrefix]) {
+					cacheIndex[key] = [NSDate distantPast];
+				}
+			}];
+		}
+		
+		[transaction setObject:cachedResponse forKey:storageKey inCollection:kZDCCollection_CachedResponse];
+		cacheIndex[storageKey] = cachedResponse.uncacheDate ?: [NSDate distantFuture];
+		
+		NSUInteger count = cacheIndex.count;
+		if (count <= kCacheMaxEntries) {
+			return;
+		}
+		
+		// Evict the entries that are closest to being uncached anyway.
+		// (Entries that were already removed by the uncache action are simply dropped from the index.)
+		// We trim down to 3/4 capacity, so we're not doing this on every single insert.
+		
+		NSMutableArray<NSString *> *keys = [[cacheIndex allKeys] mutableCopy];
+		[keys removeObject:storageKey];
+		
+		[keys sortUsingComparator:^NSComparisonResult(NSString *key1, NSString *key2) {
+			
+			return [cacheIndex[key1] compare:cacheIndex[key2]];
+		}];
+		
+		NSUInteger evictCount = MIN(keys.count, count - ((kCacheMaxEntries * 3) / 4));
+		NSArray<NSString *> *evictKeys = [keys subarrayWithRange:NSMakeRange(0, evictCount)];
+		
+		[transaction removeObjectsForKeys:evictKeys inCollection:kZDCCollection_CachedResponse];
+		[cacheIndex removeObjectsForKeys:evictKeys];
+	}];
+}
+
+#pragma clang diagnostic pop
+
+@end
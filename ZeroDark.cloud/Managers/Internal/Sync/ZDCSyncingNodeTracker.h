@@ -0,0 +1,119 @@
+/**
+ * ZeroDark.cloud
+ *
+ * Homepage      : https://www.zerodark.cloud
+ * GitHub        : https://github.com/4th-ATechnologies/ZeroDark.cloud
+ * Documentation : https://zerodarkcloud.readthedocs.io/en/latest/
+ * API Reference : https://apis.zerodark.cloud
+**/
+
+#import <Foundation/Foundation.h>
+#import <YapDatabase/YapDatabaseCloudCore.h>
+
+#import "ZDCCloudOperation.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Incrementally tracks the syncingNodeIDs for a single localUser.
+ *
+ * Every source (a queued operation, or an active download) holds a reference to
+ * the ancestry of its node: [nodeID, parentID, grandparentID, ..., rootID]
+ * The syncingNodeIDs are the nodeIDs with a non-zero reference count.
+ *
+ * Resolving an ancestry requires a database read, which the SyncManager performs asynchronously.
+ * So a new source is first marked as pending, and is only retained once it's resolved.
+ * If the source goes away while it's still pending, the resolved ancestry is simply ignored.
+ *
+ * This class is not thread-safe. The SyncManager only accesses it from within its internal queue.
+ */
+@interface ZDCSyncingNodeTracker : NSObject
+
+/** The distinct nodeIDs currently referenced by at least one source. */
+@property (nonatomic, readonly) NSSet<NSString *> *syncingNodeIDs;
+
+/** The number of sources currently referencing the given nodeID. */
+- (NSUInteger)referenceCountForNodeID:(NSString *)nodeID;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Operations
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Compares the given operations (i.e. the contents of the pipeline) against the tracked operations.
+ *
+ * - operations that are completed or skipped (or are missing from the list) are released
+ * - operations that aren't yet tracked are marked as pending, and returned
+ *
+ * @param operations
+ *   Every operation currently in the pipeline.
+ *
+ * @param statusBlock
+ *   Returns the pipeline's status for the given operation.
+ *
+ * @param changedPtr
+ *   Set to YES if the syncingNodeIDs changed as a result.
+ *
+ * @return
+ *   The operations that need to be resolved (opUUID -> nodeID).
+ *   Pass the resolved ancestries to `resolveOperations:`.
+ */
+- (NSDictionary<NSUUID *, NSString *> *)
+  updateWithOperations:(NSArray<ZDCCloudOperation *> *)operations
+           statusBlock:(YDBCloudCoreOperationStatus (^NS_NOESCAPE)(NSUUID *opUUID))statusBlock
+               changed:(BOOL *_Nullable)changedPtr;
+
+/**
+ * Retains the ancestry of every operation that's still pending.
+ * Returns YES if the syncingNodeIDs changed as a result.
+ */
+- (BOOL)resolveOperations:(NSDictionary<NSUUID *, NSArray<NSString *> *> *)ancestries;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Downloads
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Returns YES if the download is new (and now pending),
+ * in which case the ancestry must be passed to `resolveDownloadForNodeID:ancestry:`.
+ */
+- (BOOL)startDownloadForNodeID:(NSString *)nodeID;
+
+/**
+ * Releases the download (or cancels the pending resolution).
+ * Returns YES if the syncingNodeIDs changed as a result.
+ */
+- (BOOL)stopDownloadForNodeID:(NSString *)nodeID;
+
+/**
+ * Retains the ancestry of the download, if it's still pending.
+ * Returns YES if the syncingNodeIDs changed as a result.
+ */
+- (BOOL)resolveDownloadForNodeID:(NSString *)nodeID ancestry:(NSArray<NSString *> *)ancestry;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Moves
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Returns the nodeIDs whose ancestry may be affected by the given (modified or deleted) nodes.
+ * That is, every source whose tracked ancestry includes one of the changed nodes.
+ *
+ * Pending sources are always included, since the resolution that's in flight may have read the old ancestry.
+ *
+ * @param changedNodeIDs
+ *   The nodes that were modified or deleted. Pass nil if every node may have changed.
+ */
+- (NSSet<NSString *> *)nodeIDsAffectedByChangedNodeIDs:(nullable NSSet<NSString *> *)changedNodeIDs;
+
+/**
+ * Replaces the tracked ancestry of every source for the given nodeIDs.
+ * Sources whose ancestry didn't change (e.g. the node was only renamed) are left alone.
+ *
+ * Returns YES if the syncingNodeIDs changed as a result.
+ */
+- (BOOL)updateAncestries:(NSDictionary<NSString *, NSArray<NSString *> *> *)ancestries;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,320 @@
+/**
+ * ZeroDark.cloud
+ *
+ * Homepage      : https://www.zerodark.cloud
+ * GitHub        : https://github.com/4th-ATechnologies/ZeroDark.cloud
+ * Documentation : https://zerodarkcloud.readthedocs.io/en/latest/
+ * API Reference : https://apis.zerodark.cloud
+**/
+
+#import "ZDCSyncingNodeTracker.h"
+
+@implementation ZDCSyncingNodeTracker {
+	
+	NSCountedSet<NSString *> *counts;
+	NSSet<NSString *> *syncingNodeIDs; // cached snapshot of counts (nil if stale)
+	
+	NSMutableDictionary<NSUUID *, NSArray<NSString *> *> *ops;
+	NSMutableDictionary<NSUUID *, NSString *> *pendingOps;
+	
+	NSMutableDictionary<NSString *, NSArray<NSString *> *> *downloads;
+	NSMutableSet<NSString *> *pendingDownloads;
+}
+
+- (instancetype)init
+{
+	if ((self = [super init]))
+	{
+		counts = [[NSCountedSet alloc] init];
+		
+		ops = [[NSMutableDictionary alloc] init];
+		pendingOps = [[NSMutableDictionary alloc] init];
+		
+		downloads = [[NSMutableDictionary alloc] init];
+		pendingDownloads = [[NSMutableSet alloc] init];
+	}
+	return self;
+}
+
+- (NSSet<NSString *> *)syncingNodeIDs
+{
+	if (syncingNodeIDs == nil) {
+		syncingNodeIDs = [[NSSet alloc] initWithSet:counts];
+	}
+	return syncingNodeIDs;
+}
+
+- (NSUInteger)referenceCountForNodeID:(NSString *)nodeID
+{
+	return [counts countForObject:nodeID];
+}
+
+/**
+ * Adds a reference to each nodeID in the given ancestry.
+ * Returns YES if the set of syncingNodeIDs changed as a result.
+ */
+- (BOOL)retainAncestry:(NSArray<NSString *> *)ancestry
+{
+	BOOL changed = NO;
+	for (NSString *nodeID in ancestry)
+	{
+		if ([counts countForObject:nodeID] == 0) {
+			changed = YES;
+		}
+		[counts addObject:nodeID];
+	}
+	
+	if (changed) {
+		syncingNodeIDs = nil;
+	}
+	return changed;
+}
+
+/**
+ * Removes a reference from each nodeID in the given ancestry.
+ * Returns YES if the set of syncingNodeIDs changed as a result.
+ */
+- (BOOL)releaseAncestry:(NSArray<NSString *> *)ancestry
+{
+	BOOL changed = NO;
+	for (NSString *nodeID in ancestry)
+	{
+		[counts removeObject:nodeID];
+		if ([counts countForObject:nodeID] == 0) {
+			changed = YES;
+		}
+	}
+	
+	if (changed) {
+		syncingNodeIDs = nil;
+	}
+	return changed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Operations
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * See header file for description.
+ */
+- (NSDictionary<NSUUID *, NSString *> *)
+  updateWithOperations:(NSArray<ZDCCloudOperation *> *)operations
+           statusBlock:(YDBCloudCoreOperationStatus (^NS_NOESCAPE)(NSUUID *opUUID))statusBlock
+               changed:(BOOL *)changedPtr
+{
+	NSMutableSet<NSUUID *> *active_opUUIDs = [NSMutableSet setWithCapacity:(ops.count + pendingOps.count)];
+	NSMutableDictionary<NSUUID *, NSString *> *added_ops = [NSMutableDictionary dictionary];
+	
+	for (ZDCCloudOperation *op in operations)
+	{
+		NSString *nodeID = op.nodeID;
+		if (nodeID == nil) continue;
+		
+		// Ignore any operations that have been marked as completed or skipped.
+		// This happens due to various optimizations.
+		
+		NSUUID *opUUID = op.uuid;
+		YDBCloudCoreOperationStatus status = statusBlock(opUUID);
+		
+		if (status == YDBCloudOperationStatus_Completed || status == YDBCloudOperationStatus_Skipped) {
+			continue;
+		}
+		
+		[active_opUUIDs addObject:opUUID];
+		
+		if (ops[opUUID] == nil && pendingOps[opUUID] == nil)
+		{
+			added_ops[opUUID] = nodeID;
+		}
+	}
+	
+	// Release operations that are no longer active
+	
+	BOOL changed = NO;
+	
+	for (NSUUID *opUUID in [ops allKeys])
+	{
+		if (![active_opUUIDs containsObject:opUUID])
+		{
+			if ([self releaseAncestry:ops[opUUID]]) {
+				changed = YES;
+			}
+			[ops removeObjectForKey:opUUID];
+		}
+	}
+	
+	for (NSUUID *opUUID in [pendingOps allKeys])
+	{
+		if (![active_opUUIDs containsObject:opUUID]) {
+			[pendingOps removeObjectForKey:opUUID];
+		}
+	}
+	
+	[pendingOps addEntriesFromDictionary:added_ops];
+	
+	if (changedPtr) *changedPtr = changed;
+	return added_ops;
+}
+
+/**
+ * See header file for description.
+ */
+- (BOOL)resolveOperations:(NSDictionary<NSUUID *, NSArray<NSString *> *> *)ancestries
+{
+	BOOL changed = NO;
+	
+	for (NSUUID *opUUID in ancestries)
+	{
+		// If the operation was completed/skipped while it was being resolved,
+		// then it's no longer in the pending set, and we can ignore it.
+		
+		if (pendingOps[opUUID] == nil) {
+			continue;
+		}
+		
+		[pendingOps removeObjectForKey:opUUID];
+		
+		NSArray<NSString *> *ancestry = ancestries[opUUID];
+		ops[opUUID] = ancestry;
+		
+		if ([self retainAncestry:ancestry]) {
+			changed = YES;
+		}
+	}
+	
+	return changed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Downloads
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * See header file for description.
+ */
+- (BOOL)startDownloadForNodeID:(NSString *)nodeID
+{
+	if (downloads[nodeID] != nil || [pendingDownloads containsObject:nodeID]) {
+		return NO;
+	}
+	
+	[pendingDownloads addObject:nodeID];
+	return YES;
+}
+
+/**
+ * See header file for description.
+ */
+- (BOOL)stopDownloadForNodeID:(NSString *)nodeID
+{
+	if ([pendingDownloads containsObject:nodeID])
+	{
+		[pendingDownloads removeObject:nodeID];
+		return NO;
+	}
+	
+	NSArray<NSString *> *ancestry = downloads[nodeID];
+	if (ancestry == nil) {
+		return NO;
+	}
+	
+	[downloads removeObjectForKey:nodeID];
+	return [self releaseAncestry:ancestry];
+}
+
+/**
+ * See header file for description.
+ */
+- (BOOL)resolveDownloadForNodeID:(NSString *)nodeID ancestry:(NSArray<NSString *> *)ancestry
+{
+	if (![pendingDownloads containsObject:nodeID]) {
+		return NO;
+	}
+	
+	[pendingDownloads removeObject:nodeID];
+	downloads[nodeID] = ancestry;
+	
+	return [self retainAncestry:ancestry];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Moves
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * See header file for description.
+ */
+- (NSSet<NSString *> *)nodeIDsAffectedByChangedNodeIDs:(NSSet<NSString *> *)changedNodeIDs
+{
+	NSMutableSet<NSString *> *result = [NSMutableSet set];
+	
+	if (changedNodeIDs && ![changedNodeIDs intersectsSet:counts] && (pendingOps.count + pendingDownloads.count) == 0) {
+		return result;
+	}
+	
+	void (^check)(NSArray<NSString *> *) = ^(NSArray<NSString *> *ancestry){
+		
+		if (changedNodeIDs == nil) {
+			[result addObject:ancestry.firstObject];
+			return;
+		}
+		for (NSString *nodeID in ancestry)
+		{
+			if ([changedNodeIDs containsObject:nodeID]) {
+				[result addObject:ancestry.firstObject];
+				return;
+			}
+		}
+	};
+	
+	for (NSArray<NSString *> *ancestry in [ops objectEnumerator]) {
+		check(ancestry);
+	}
+	for (NSArray<NSString *> *ancestry in [downloads objectEnumerator]) {
+		check(ancestry);
+	}
+	
+	[result addObjectsFromArray:[pendingOps allValues]];
+	[result unionSet:pendingDownloads];
+	
+	return result;
+}
+
+/**
+ * See header file for description.
+ */
+- (BOOL)updateAncestries:(NSDictionary<NSString *, NSArray<NSString *> *> *)ancestries
+{
+	__block BOOL changed = NO;
+	
+	// Retain before release, so nodeIDs that remain in the ancestry never (temporarily) drop to zero.
+	
+	void (^update)(NSMutableDictionary *) = ^(NSMutableDictionary<id, NSArray<NSString *> *> *sources){
+		
+		for (id key in [sources allKeys])
+		{
+			NSArray<NSString *> *oldAncestry = sources[key];
+			NSArray<NSString *> *newAncestry = ancestries[oldAncestry.firstObject];
+			
+			if (newAncestry == nil || [newAncestry isEqualToArray:oldAncestry]) {
+				continue;
+			}
+			
+			BOOL retainChanged = [self retainAncestry:newAncestry];
+			BOOL releaseChanged = [self releaseAncestry:oldAncestry];
+			
+			if (retainChanged || releaseChanged) {
+				changed = YES;
+			}
+			sources[key] = newAncestry;
+		}
+	};
+	
+	update(ops);
+	update(downloads);
+	
+	return changed;
+}
+
+@end
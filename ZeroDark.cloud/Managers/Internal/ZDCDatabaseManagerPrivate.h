@@ -10,6 +10,14 @@
 #import "ZDCDatabaseManager.h"
 #import "ZeroDarkCloud.h"
 
+@class YapDatabaseHooks;
+
+/**
+ * Internal YapDatabaseHooks extension.
+ * Used to notify the NodeManager of node modifications within a read-write transaction.
+ */
+extern NSString *const Ext_Hooks;
+
 @interface ZDCDatabaseManager (Private)
 
 /**
@@ -17,6 +25,14 @@
  */
 - (instancetype)initWithOwner:(ZeroDarkCloud *)owner;
 
+/**
+ * Returns a new instance of the hooks extension, which forwards node modifications to the NodeManager.
+ * The DatabaseManager registers it under Ext_Hooks.
+ *
+ * Used by the unit tests to register the same hooks on a standalone database.
+ */
++ (YapDatabaseHooks *)hooksExtension;
+
 /**
  * Attempts to create the YapDatabase instance using the given encrytionKey.
  * Returns NO if it fails.
@@ -0,0 +1,29 @@
+/**
+ * ZeroDark.cloud
+ * 
+ * Homepage      : https://www.zerodark.cloud
+ * GitHub        : https://github.com/4th-ATechnologies/ZeroDark.cloud
+ * Documentation : https://zerodarkcloud.readthedocs.io/en/latest/
+ * API Reference : https://apis.zerodark.cloud
+**/
+
+#import "ZDCNodeManager.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface ZDCNodeManager (Private)
+
+/**
+ * The NodeManager caches the ancestry (parents, path components & trunk) of nodes.
+ * Committed changes are picked up via YapDatabaseModifiedNotification.
+ *
+ * But a read-write transaction also needs to see its own (uncommitted) changes.
+ * So the DatabaseManager's hooks extension invokes these methods (from within the read-write transaction)
+ * whenever a node is inserted, modified or removed.
+ */
+- (void)didModifyNodeIDs:(NSArray<NSString *> *)nodeIDs transaction:(YapDatabaseReadWriteTransaction *)transaction;
+- (void)didRemoveAllNodesInTransaction:(YapDatabaseReadWriteTransaction *)transaction;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -10,7 +10,9 @@
 #import "ZDCUserManager.h"
 #import "ZeroDarkCloud.h"
 
+@class ZDCBlockchainProof;
 @class ZDCSearchResult;
+@class ZDCUserProfile;
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -21,6 +23,40 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (instancetype)initWithOwner:(ZeroDarkCloud *)owner;
 
+/**
+ * Used by the unit tests, which don't have a ZeroDarkCloud instance.
+ * The users are read from the roConnection, and downloaded users are stored via the rwConnection.
+ *
+ * The tests override the network operations below.
+ */
+- (instancetype)initWithOwner:(nullable ZeroDarkCloud *)owner
+                 roConnection:(YapDatabaseConnection *)roConnection
+                 rwConnection:(YapDatabaseConnection *)rwConnection;
+
+/**
+ * The network operations performed when downloading a user,
+ * in the order they're performed by `fetchUserWithID:::` & `fetchUsersWithIDs:::`.
+ */
+
+- (void)_fetchRemoteUser:(NSString *)remoteUserID
+             requesterID:(NSString *)localUserID
+         completionQueue:(dispatch_queue_t)completionQueue
+         completionBlock:(void (^)(ZDCUser *_Nullable user, NSError *_Nullable error))completionBlock;
+
+- (void)_fetchFilteredAuth0Profile:(NSString *)remoteUserID
+                       requesterID:(NSString *)localUserID
+                   completionQueue:(dispatch_queue_t)completionQueue
+                   completionBlock:(void (^)(ZDCUserProfile *_Nullable profile, NSError *_Nullable error))completionBlock;
+
+- (void)_fetchPubKeyForUser:(ZDCUser *)user
+                requesterID:(NSString *)localUserID
+            completionQueue:(dispatch_queue_t)completionQueue
+            completionBlock:(void (^)(ZDCPublicKey *_Nullable pubKey, NSError *_Nullable error))completionBlock;
+
+- (void)_fetchBlockchainProofForUserID:(NSString *)userID
+                       completionQueue:(dispatch_queue_t)completionQueue
+                       completionBlock:(void (^)(ZDCBlockchainProof *_Nullable proof, NSError *_Nullable error))completionBlock;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -199,6 +199,20 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (nullable NSString *)cloudNameForNode:(ZDCNode *)node transaction:(YapDatabaseReadTransaction *)transaction;
 
+/**
+ * Calculates the cloudName for every direct child of the given node, in a single pass.
+ *
+ * This is more efficient than invoking `cloudNameForNode:transaction:` for each child,
+ * since the parent (and its dirSalt) is only fetched once.
+ * If the given node is a pointer, the children of its target are used.
+ *
+ * @return
+ *   A dictionary mapping nodeID -> cloudName.
+ *   Children for which a cloudName cannot be calculated are omitted.
+ */
+- (NSDictionary<NSString*, NSString*> *)cloudNamesForChildrenOfNode:(ZDCNode *)parentNode
+                                                        transaction:(YapDatabaseReadTransaction *)transaction;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -24,7 +24,68 @@
   static const int zdcLogLevel = ZDCLogLevelWarning;
 #endif
 
-@implementation ZDCCloudPathManager
+/**
+ * Max number of {parentDirSalt, name} -> cloudName mappings kept in memory.
+ */
+static NSUInteger const kCloudNameCacheCountLimit = 2000;
+
+/**
+ * Key for the cloudName cache.
+ * The name is expected to already be normalized (lowercased).
+ */
+@interface ZDCCloudNameCacheKey : NSObject
+
+- (instancetype)initWithName:(NSString *)name parentDirSalt:(NSData *)parentDirSalt;
+
+@property (nonatomic, copy, readonly) NSString *name;
+@property (nonatomic, copy, readonly) NSData *parentDirSalt;
+
+@end
+
+@implementation ZDCCloudNameCacheKey {
+	
+	NSUInteger hash;
+}
+
+@synthesize name = name;
+@synthesize parentDirSalt = parentDirSalt;
+
+- (instancetype)initWithName:(NSString *)inName parentDirSalt:(NSData *)inParentDirSalt
+{
+	if ((self = [super init]))
+	{
+		name = [inName copy];
+		parentDirSalt = [inParentDirSalt copy];
+		
+		hash = name.hash ^ parentDirSalt.hash;
+	}
+	return self;
+}
+
+- (NSUInteger)hash
+{
+	return hash;
+}
+
+- (BOOL)isEqual:(id)another
+{
+	if (![another isKindOfClass:[ZDCCloudNameCacheKey class]]) return NO;
+	
+	__unsafe_unretained ZDCCloudNameCacheKey *key = (ZDCCloudNameCacheKey *)another;
+	
+	return [name isEqualToString:key->name] && [parentDirSalt isEqualToData:key->parentDirSalt];
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation ZDCCloudPathManager {
+	
+	NSCache<ZDCCloudNameCacheKey*, NSString*> *cloudNameCache;
+}
 
 static ZDCCloudPathManager *sharedInstance = nil;
 
@@ -42,6 +103,22 @@ static ZDCCloudPathManager *sharedInstance = nil;
 	return sharedInstance;
 }
 
+- (instancetype)init
+{
+	if ((self = [super init]))
+	{
+		// Deriving a cloudName requires a KDF (Skein MAC) + zBase32 encoding.
+		// And the same {name, parentDirSalt} pairs get hashed over & over again:
+		// by the fsCloudName view (sorting), conflict resolution, push path preparation, etc.
+		//
+		// NSCache is thread-safe, and evicts under memory pressure.
+		
+		cloudNameCache = [[NSCache alloc] init];
+		cloudNameCache.countLimit = kCloudNameCacheCountLimit;
+	}
+	return self;
+}
+
 /**
  * See header file for description.
  * Or view the api's online (for both Swift & Objective-C):
@@ -263,7 +340,48 @@ static ZDCCloudPathManager *sharedInstance = nil;
 }
 
 /**
- * Private method - declared in ZDCCloudPathManagerPrivate.h
+ * See header file for description.
+ * Or view the api's online (for both Swift & Objective-C):
+ * https://apis.zerodark.cloud/Classes/ZDCCloudPathManager.html
+ */
+- (NSDictionary<NSString*, NSString*> *)cloudNamesForChildrenOfNode:(ZDCNode *)parentNode
+                                                        transaction:(YapDatabaseReadTransaction *)transaction
+{
+	ZDCNodeManager *nodeManager = [ZDCNodeManager sharedInstance];
+	
+	// Children are attached to the target node (if parentNode is a pointer).
+	//
+	ZDCNode *targetNode = [nodeManager targetNodeForNode:parentNode transaction:transaction];
+	if (targetNode.uuid == nil) {
+		return @{};
+	}
+	
+	NSData *parentDirSalt = targetNode.dirSalt;
+	if (parentDirSalt == nil) {
+		ZDCLogWarn(@"Cannot derive cloudNames for children of node(%@): node.dirSalt is nil", targetNode.name);
+	}
+	
+	NSMutableDictionary<NSString*, NSString*> *cloudNames = [NSMutableDictionary dictionary];
+	
+	[nodeManager enumerateNodesWithParentID: targetNode.uuid
+	                            transaction: transaction
+	                             usingBlock:^(ZDCNode *node, BOOL *stop)
+	{
+		NSString *cloudName = node.explicitCloudName;
+		if (cloudName == nil && parentDirSalt) {
+			cloudName = [self cloudNameForName:node.name withParentDirSalt:parentDirSalt];
+		}
+		
+		if (cloudName) {
+			cloudNames[node.uuid] = cloudName;
+		}
+	}];
+	
+	return cloudNames;
+}
+
+/**
+ * Derives the cloudName for the given name (memoized).
  */
 - (NSString *)cloudNameForName:(NSString *)name withParentDirSalt:(NSData *)parentDirSalt
 {
@@ -273,7 +391,23 @@ static ZDCCloudPathManager *sharedInstance = nil;
 	//
 	NSString *nameToHash = [name lowercaseString];
 	
-	return [nameToHash KDFWithSeedKey:parentDirSalt label:@"file_salt_label"];
+	if (nameToHash == nil || parentDirSalt == nil) {
+		return nil;
+	}
+	
+	ZDCCloudNameCacheKey *cacheKey =
+	  [[ZDCCloudNameCacheKey alloc] initWithName:nameToHash parentDirSalt:parentDirSalt];
+	
+	NSString *cloudName = [cloudNameCache objectForKey:cacheKey];
+	if (cloudName == nil)
+	{
+		cloudName = [nameToHash KDFWithSeedKey:parentDirSalt label:@"file_salt_label"];
+		if (cloudName) {
+			[cloudNameCache setObject:cloudName forKey:cacheKey];
+		}
+	}
+	
+	return cloudName;
 }
 
 @end
@@ -12,9 +12,11 @@
 #import "ZDCConstants.h"
 #import "ZDCCachedResponse.h"
 #import "ZDCCloudPrivate.h"
+#import "ZDCCompactCoder.h"
 #import "ZDCLocalUserPrivate.h"
 #import "ZDCLocalUserManagerPrivate.h"
 #import "ZDCLogging.h"
+#import "ZDCNodeManagerPrivate.h"
 #import "ZDCNodePrivate.h"
 #import "ZDCTask.h"
 #import "ZDCUserPrivate.h"
@@ -51,6 +53,7 @@ NSString *const Ext_View_SplitKeys            = @"ZeroDark:splitKeys";
 NSString *const Ext_View_SplitKeys_Date  		 = @"ZeroDark:splitKeys.createDate";
 NSString *const Ext_CloudCore_Prefix          = @"ZeroDark:cloud_";
 NSString *const Ext_ActionManager             = @"ZeroDark:action";
+NSString *const Ext_Hooks                     = @"ZeroDark:hooks";
 
 
 
@@ -76,6 +79,8 @@ NSString *const Index_Users_Column_RandomUUID = @"random_uuid";
 	
 	YAPUnfairLock spinlock;
 	NSMutableDictionary<YapCollectionKey*, ZDCCloud*> *registeredCloudDict;
+	
+	BOOL compactSerialization; // set once, in setupDatabase:
 }
 
 - (instancetype)init
@@ -219,11 +224,25 @@ NSString *const Index_Users_Column_RandomUUID = @"random_uuid";
  * The serializer block converts objects into encrypted data blobs.
  *
  * (All of the objects used by the ZeroDarkCloud framework support the NSCoding protocol.)
+ *
+ * If enabled via `-[ZDCDatabaseConfig compactSerialization]`,
+ * hot classes (nodes & operations) are written using the compact binary format (see ZDCCompactCoder),
+ * which is considerably smaller & faster than a keyed archive. Everything else uses NSKeyedArchiver.
  */
 - (YapDatabaseSerializer)databaseSerializer
 {
+	const BOOL useCompactCoder = compactSerialization;
+	
 	YapDatabaseSerializer serializer = ^(NSString *collection, NSString *key, id object){
 		
+		if (useCompactCoder && [ZDCCompactCoder supportsRootObject:object])
+		{
+			NSData *data = [ZDCCompactCoder archivedDataWithRootObject:object];
+			if (data) {
+				return data;
+			}
+		}
+		
 		return [NSKeyedArchiver archivedDataWithRootObject:object];
 	};
 	
@@ -234,12 +253,20 @@ NSString *const Index_Users_Column_RandomUUID = @"random_uuid";
  * The deserializer block converts encrypted data blobs back into objects.
  *
  * (All of the objects used by the ZeroDarkCloud framework support the NSCoding protocol.)
+ *
+ * Both formats are always read, regardless of `-[ZDCDatabaseConfig compactSerialization]`.
+ * So rows written in either format remain readable if the setting is later toggled.
  */
 - (YapDatabaseDeserializer)databaseDeserializer
 {
 	YapDatabaseDeserializer deserializer = ^(NSString *collection, NSString *key, NSData *data){
 		
-		id object = [NSKeyedUnarchiver unarchiveObjectWithData:data];
+		id object = nil;
+		if ([ZDCCompactCoder isCompactData:data])
+			object = [ZDCCompactCoder unarchiveObjectWithData:data];
+		else
+			object = [NSKeyedUnarchiver unarchiveObjectWithData:data];
+		
 		if ([object isKindOfClass:[ZDCObject class]])
 		{
 			[(ZDCObject *)object makeImmutable];
@@ -287,6 +314,8 @@ NSString *const Index_Users_Column_RandomUUID = @"random_uuid";
 	
 	[NSKeyedUnarchiver setClass:[ZDCTrunkNode class] forClassName:@"ZDCContainerNode"];
 	
+	compactSerialization = config.compactSerialization;
+	
 	NSURL *databaseURL = zdc.databasePath;
 	ZDCLogVerbose(@"databaseURL = %@", databaseURL);
 	
@@ -318,6 +347,7 @@ NSString *const Index_Users_Column_RandomUUID = @"random_uuid";
 	NSArray<NSString*> *collections = @[
 		kZDCCollection_CachedResponse,
 		kZDCCollection_CloudNodes,
+		kZDCCollection_CloudDataManifests,
 		kZDCCollection_Nodes,
 		kZDCCollection_Prefs,
 		kZDCCollection_PublicKeys,
@@ -384,6 +414,7 @@ NSString *const Index_Users_Column_RandomUUID = @"random_uuid";
 	
 	// Setup all the extensions
 	
+	[self setupHooks];
 	[self setupRelationship];
 	[self setupIndex_Nodes];
 	[self setupIndex_Users];
@@ -428,6 +459,73 @@ NSString *const Index_Users_Column_RandomUUID = @"random_uuid";
 	return YES;
 }
 
+/**
+ * See header file for description.
+ */
++ (YapDatabaseHooks *)hooksExtension
+{
+	YapDatabaseHooks *ext = [[YapDatabaseHooks alloc] init];
+	
+	ext.didModifyRow = ^(YapDatabaseReadWriteTransaction *transaction, NSString *collection, NSString *key,
+	                     YapProxyObject *proxyObject, YapDatabaseHooksBitMask flags)
+	{
+		if ([collection isEqualToString:kZDCCollection_Nodes])
+		{
+			[[ZDCNodeManager sharedInstance] didModifyNodeIDs:@[key] transaction:transaction];
+		}
+	};
+	
+	ext.didRemoveRow = ^(YapDatabaseReadWriteTransaction *transaction, NSString *collection, NSString *key) {
+		
+		if ([collection isEqualToString:kZDCCollection_Nodes])
+		{
+			[[ZDCNodeManager sharedInstance] didModifyNodeIDs:@[key] transaction:transaction];
+		}
+	};
+	
+	ext.didRemoveRows = ^(YapDatabaseReadWriteTransaction *transaction, NSDictionary<NSString*, NSArray<NSString*>*> *keys) {
+		
+		NSArray<NSString*> *nodeIDs = keys[kZDCCollection_Nodes];
+		if (nodeIDs.count > 0)
+		{
+			[[ZDCNodeManager sharedInstance] didModifyNodeIDs:nodeIDs transaction:transaction];
+		}
+	};
+	
+	ext.didRemoveAllRows = ^(YapDatabaseReadWriteTransaction *transaction) {
+		
+		[[ZDCNodeManager sharedInstance] didRemoveAllNodesInTransaction:transaction];
+	};
+	
+	return ext;
+}
+
+- (void)setupHooks
+{
+	ZDCLogAutoTrace();
+	
+	//
+	// HOOKS
+	//
+	// The NodeManager caches node ancestry (parentID chains, path components, trunk).
+	// Within a read-write transaction, it needs to know which nodes have been modified,
+	// so that it doesn't return ancestry that's been invalidated by the (uncommitted) transaction.
+	//
+	
+	YapDatabaseHooks *ext = [[self class] hooksExtension];
+	
+	NSString *extName = Ext_Hooks;
+	[database asyncRegisterExtension: ext
+	                        withName: extName
+	                 completionQueue: dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0)
+	                 completionBlock:^(BOOL ready)
+	{
+		if (!ready) {
+			ZDCLogError(@"Error registering \"%@\" !!!", extName);
+		}
+	}];
+}
+
 - (void)setupRelationship
 {
 	ZDCLogAutoTrace();
@@ -1642,7 +1740,8 @@ NSString *const Index_Users_Column_RandomUUID = @"random_uuid";
 	
 	ZDCCloud *ext =
 	  [[ZDCCloud alloc] initWithLocalUserID: localUserID
-	                                 treeID: treeID];
+	                                 treeID: treeID
+	                   compactSerialization: compactSerialization];
 	
 	id <YapDatabaseCloudCorePipelineDelegate> pipelineDelegate =
 	  (id <YapDatabaseCloudCorePipelineDelegate>)zdc;
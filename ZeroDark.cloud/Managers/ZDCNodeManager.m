@@ -7,7 +7,7 @@
  * API Reference : https://apis.zerodark.cloud
 **/
 
-#import "ZDCNodeManager.h"
+#import "ZDCNodeManagerPrivate.h"
 
 #import "ZDCCloudNodeManager.h"
 #import "ZDCCloudPathManager.h"
@@ -31,6 +31,8 @@
 #if TARGET_OS_IPHONE
 #import <MobileCoreServices/MobileCoreServices.h>
 #endif
+#import <YapDatabase/YapCollectionKey.h>
+#import <YapDatabase/YapDatabaseAtomic.h>
 #import <YapDatabase/YapDatabaseView.h>
 #import <YapDatabase/YapDatabaseAutoView.h>
 
@@ -43,7 +45,232 @@
 #endif
 #pragma unused(zdcLogLevel)
 
-@implementation ZDCNodeManager
+/**
+ * Upper bound on the number of cached ancestry entries (per database).
+ * If exceeded, the cache is simply flushed, and rebuilt on demand.
+ */
+static NSUInteger const kMaxAncestryCacheCount = 5000;
+
+/**
+ * The ancestry of a single node, as it exists in the database at a particular snapshot.
+ *
+ * Entries are built recursively (a node's entry is derived from its parent's entry),
+ * so resolving the path of a deep node only walks the portion of the tree that isn't already cached.
+ */
+@interface ZDCNodeAncestry : NSObject
+
+- (instancetype)initWithNode:(ZDCNode *)node
+                     isGraft:(BOOL)isGraft
+                      parent:(nullable ZDCNode *)parent
+              parentAncestry:(nullable ZDCNodeAncestry *)parentAncestry;
+
+/** Path components from the trunk down to (and including) the node. */
+@property (nonatomic, readonly) NSArray<NSString *> *pathComponents;
+
+@property (nonatomic, readonly) ZDCTreesystemTrunk trunk;
+@property (nonatomic, readonly, nullable) NSString *trunkNodeID;
+
+/** Ancestor nodeIDs, ordered from the root down to the node's (resolved) parent. */
+@property (nonatomic, readonly) NSArray<NSString *> *parentIDs;
+
+/**
+ * Every nodeID that was read in order to build this entry (including missing parents).
+ * If any of these nodes change, the entry is stale.
+ */
+@property (nonatomic, readonly) NSSet<NSString *> *dependencies;
+
+/**
+ * Grafted parents are resolved via an index query (findNodeWithPointeeID:),
+ * so the entry also depends on nodes that aren't in the dependencies set.
+ */
+@property (nonatomic, readonly) BOOL hasGraft;
+
+@end
+
+@implementation ZDCNodeAncestry
+
+@synthesize pathComponents = pathComponents;
+@synthesize trunk = trunk;
+@synthesize trunkNodeID = trunkNodeID;
+@synthesize parentIDs = parentIDs;
+@synthesize dependencies = dependencies;
+@synthesize hasGraft = hasGraft;
+
+- (instancetype)initWithNode:(ZDCNode *)node
+                     isGraft:(BOOL)isGraft
+                      parent:(nullable ZDCNode *)parent
+              parentAncestry:(nullable ZDCNodeAncestry *)parentAncestry
+{
+	if ((self = [super init]))
+	{
+		if ([node isKindOfClass:[ZDCTrunkNode class]])
+		{
+			pathComponents = @[];
+			trunk = [(ZDCTrunkNode *)node trunk];
+			trunkNodeID = node.uuid;
+		}
+		else
+		{
+			NSArray<NSString *> *parentComponents = parentAncestry.pathComponents ?: @[];
+			if (isGraft) {
+				pathComponents = parentComponents;
+			} else {
+				pathComponents = [parentComponents arrayByAddingObject:(node.name ?: @"")];
+			}
+			
+			trunk = parentAncestry ? parentAncestry.trunk : ZDCTreesystemTrunk_Detached;
+			trunkNodeID = parentAncestry.trunkNodeID;
+		}
+		
+		NSMutableSet<NSString *> *deps = [NSMutableSet setWithCapacity:(parentAncestry.dependencies.count + 2)];
+		if (node.uuid) {
+			[deps addObject:node.uuid];
+		}
+		
+		if (parent)
+		{
+			NSArray<NSString *> *grandparentIDs = parentAncestry.parentIDs ?: @[];
+			parentIDs = [grandparentIDs arrayByAddingObject:parent.uuid];
+			
+			[deps addObject:parent.uuid];
+			if (parentAncestry) {
+				[deps unionSet:parentAncestry.dependencies];
+			}
+		}
+		else
+		{
+			parentIDs = @[];
+			
+			// The parent may simply not be in the database yet (e.g. still being pulled).
+			// Track it, so the entry is invalidated when the parent shows up.
+			if (node.parentID && !isGraft) {
+				[deps addObject:node.parentID];
+			}
+		}
+		
+		dependencies = [deps copy];
+		hasGraft = isGraft || parentAncestry.hasGraft;
+	}
+	return self;
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The ancestry cache for a single database.
+ *
+ * The cache is stamped with a database snapshot, and is only consulted by transactions at that same snapshot.
+ * It's advanced (incrementally) via YapDatabaseModifiedNotification,
+ * by dropping only those entries that depend on a changed node.
+ *
+ * A read-write transaction sees its own uncommitted changes, which the snapshot doesn't reflect.
+ * So the DatabaseManager's hooks extension reports every node modification as it happens,
+ * and entries depending on those (dirty) nodes are bypassed for the remainder of that transaction.
+ */
+@interface ZDCNodeAncestryCache : NSObject {
+@public
+	
+	BOOL hasSnapshot;
+	uint64_t snapshot;
+	NSMutableDictionary<NSString*, ZDCNodeAncestry*> *entries;
+	
+	__weak YapDatabaseReadWriteTransaction *dirtyTransaction;
+	NSMutableSet<NSString*> *dirtyNodeIDs;
+	BOOL dirtyAll;
+}
+
+- (BOOL)isDirty:(ZDCNodeAncestry *)ancestry forTransaction:(YapDatabaseReadTransaction *)transaction;
+
+- (void)markDirty:(nullable NSArray<NSString *> *)nodeIDs transaction:(YapDatabaseReadWriteTransaction *)transaction;
+
+- (void)advanceToSnapshot:(uint64_t)newSnapshot
+           changedNodeIDs:(NSSet<NSString *> *)changedNodeIDs
+               removedAll:(BOOL)removedAll;
+
+@end
+
+@implementation ZDCNodeAncestryCache
+
+- (instancetype)init
+{
+	if ((self = [super init]))
+	{
+		entries = [[NSMutableDictionary alloc] init];
+		dirtyNodeIDs = [[NSMutableSet alloc] init];
+	}
+	return self;
+}
+
+- (BOOL)isDirty:(ZDCNodeAncestry *)ancestry forTransaction:(YapDatabaseReadTransaction *)transaction
+{
+	if (transaction != dirtyTransaction) return NO;
+	if (dirtyAll) return YES;
+	if (dirtyNodeIDs.count == 0) return NO;
+	
+	return ancestry.hasGraft || [ancestry.dependencies intersectsSet:dirtyNodeIDs];
+}
+
+- (void)markDirty:(nullable NSArray<NSString *> *)nodeIDs transaction:(YapDatabaseReadWriteTransaction *)transaction
+{
+	if (transaction != dirtyTransaction)
+	{
+		// Only 1 read-write transaction can be in progress at a time (per database).
+		// So a new transaction means the previous one has completed.
+		
+		dirtyTransaction = transaction;
+		[dirtyNodeIDs removeAllObjects];
+		dirtyAll = NO;
+	}
+	
+	if (nodeIDs) {
+		[dirtyNodeIDs addObjectsFromArray:nodeIDs];
+	} else {
+		dirtyAll = YES;
+	}
+}
+
+- (void)advanceToSnapshot:(uint64_t)newSnapshot
+           changedNodeIDs:(NSSet<NSString *> *)changedNodeIDs
+               removedAll:(BOOL)removedAll
+{
+	if (removedAll || !hasSnapshot || (newSnapshot != (snapshot + 1)))
+	{
+		// We can't tell exactly what changed between our snapshot & the new one.
+		[entries removeAllObjects];
+	}
+	else if (changedNodeIDs.count > 0)
+	{
+		NSMutableArray<NSString *> *staleIDs = [NSMutableArray array];
+		
+		[entries enumerateKeysAndObjectsUsingBlock:^(NSString *nodeID, ZDCNodeAncestry *ancestry, BOOL *stop) {
+			
+			if (ancestry.hasGraft || [ancestry.dependencies intersectsSet:changedNodeIDs]) {
+				[staleIDs addObject:nodeID];
+			}
+		}];
+		
+		[entries removeObjectsForKeys:staleIDs];
+	}
+	
+	snapshot = newSnapshot;
+	hasSnapshot = YES;
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+@implementation ZDCNodeManager {
+	
+	YAPUnfairLock spinlock;
+	NSMapTable<YapDatabase*, ZDCNodeAncestryCache*> *ancestryCaches;
+}
 
 static ZDCNodeManager *sharedInstance = nil;
 
@@ -61,6 +288,21 @@ static ZDCNodeManager *sharedInstance = nil;
 	return sharedInstance;
 }
 
+- (instancetype)init
+{
+	if ((self = [super init]))
+	{
+		spinlock = YAP_UNFAIR_LOCK_INIT;
+		ancestryCaches = [NSMapTable weakToStrongObjectsMapTable];
+		
+		[[NSNotificationCenter defaultCenter] addObserver: self
+		                                         selector: @selector(databaseModified:)
+		                                             name: YapDatabaseModifiedNotification
+		                                           object: nil];
+	}
+	return self;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Containers
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -97,36 +339,23 @@ static ZDCNodeManager *sharedInstance = nil;
 	ZDCLogAutoTrace();
 	NSParameterAssert(transaction != nil);
 	
-	ZDCTrunkNode *trunkNode = nil;
-	do {
+	if (node == nil) return nil;
 		
-		if ([node isKindOfClass:[ZDCTrunkNode class]])
-		{
-			trunkNode = (ZDCTrunkNode *)node;
-			break;
-		}
-		else
-		{
-			if ([node.parentID hasSuffix:@"|graft"])
-			{
-				NSString *localUserID = nil;
-				NSString *treeID = nil;
-				[ZDCNode getLocalUserID:&localUserID treeID:&treeID fromParentID:node.parentID];
-				
-				node = [self findNodeWithPointeeID: node.uuid
-				                       localUserID: localUserID
-				                            treeID: treeID
-				                       transaction: transaction];
-			}
-			else
-			{
-				node = [transaction objectForKey:node.parentID inCollection:kZDCCollection_Nodes];
-			}
-		}
+	if ([node isKindOfClass:[ZDCTrunkNode class]]) {
+		return (ZDCTrunkNode *)node;
+	}
 		
-	} while (node);
+	ZDCNodeAncestry *ancestry = [self ancestryForNode:node transaction:transaction];
+	if (ancestry.trunkNodeID == nil) {
+		return nil;
+	}
+	
+	ZDCNode *trunkNode = [transaction objectForKey:ancestry.trunkNodeID inCollection:kZDCCollection_Nodes];
+	if ([trunkNode isKindOfClass:[ZDCTrunkNode class]]) {
+		return (ZDCTrunkNode *)trunkNode;
+	}
 	
-	return trunkNode;
+	return nil;
 }
 
 /**
@@ -232,47 +461,17 @@ static ZDCNodeManager *sharedInstance = nil;
 	ZDCLogAutoTrace();
 	NSParameterAssert(transaction != nil);
 	
-	ZDCTrunkNode *trunkNode = nil;
-	NSMutableArray<NSString *> *pathComponents = [NSMutableArray arrayWithCapacity:8];
+	NSArray<NSString *> *pathComponents = @[];
+	ZDCTreesystemTrunk trunk = ZDCTreesystemTrunk_Detached;
 	
-	while (node)
+	if (node)
 	{
-		if ([node isKindOfClass:[ZDCTrunkNode class]])
-		{
-			trunkNode = (ZDCTrunkNode *)node;
-			break;
-		}
-		else if (node)
-		{
-			if (![node.parentID hasSuffix:@"|graft"])
-			{
-				[pathComponents insertObject:(node.name ?: @"") atIndex:0];
-			}
-		}
-		else
-		{
-			break;
-		}
+		ZDCNodeAncestry *ancestry = [self ancestryForNode:node transaction:transaction];
 		
-		if ([node.parentID hasSuffix:@"|graft"])
-		{
-			NSString *localUserID = nil;
-			NSString *treeID = nil;
-			[ZDCNode getLocalUserID:&localUserID treeID:&treeID fromParentID:node.parentID];
-			
-			node = [self findNodeWithPointeeID: node.uuid
-			                       localUserID: localUserID
-			                            treeID: treeID
-			                       transaction: transaction];
-		}
-		else
-		{
-			node = [transaction objectForKey:node.parentID inCollection:kZDCCollection_Nodes];
-		}
+		pathComponents = ancestry.pathComponents;
+		trunk = ancestry.trunk;
 	}
 	
-	ZDCTreesystemTrunk trunk = (trunkNode ? trunkNode.trunk : ZDCTreesystemTrunk_Detached);
-	
 	ZDCTreesystemPath *path =
 	  [[ZDCTreesystemPath alloc] initWithPathComponents: pathComponents
 	                                              trunk: trunk];
@@ -290,78 +489,280 @@ static ZDCNodeManager *sharedInstance = nil;
 	ZDCLogAutoTrace();
 	NSParameterAssert(transaction != nil);
 	
-	NSMutableArray *parents = [NSMutableArray arrayWithCapacity:8];
+	if (node == nil) return @[];
+	
+	ZDCNodeAncestry *ancestry = [self ancestryForNode:node transaction:transaction];
+	return [ancestry.parentIDs mutableCopy];
+}
+
+/**
+ * See header file for description.
+ * Or view the api's online (for both Swift & Objective-C):
+ * https://apis.zerodark.cloud/Classes/ZDCRestManager.html
+ */
+- (BOOL)isNode:(NSString *)inNodeID
+ aDescendantOf:(NSString *)potentialParentID
+   transaction:(YapDatabaseReadTransaction *)transaction
+{
+	ZDCLogAutoTrace();
+	NSParameterAssert(transaction != nil);
+	
+	ZDCNode *node = [transaction objectForKey:inNodeID inCollection:kZDCCollection_Nodes];
+	if (node == nil) return NO;
 	
+	if ([node.parentID isEqualToString:potentialParentID]) {
+		return YES;
+	}
+		
+	ZDCNodeAncestry *ancestry = [self ancestryForNode:node transaction:transaction];
+	return [ancestry.parentIDs containsObject:potentialParentID];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Ancestry Cache
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Returns the (resolved) parent of the given node.
+ * Grafted nodes are resolved to the pointer node that references them.
+ */
+- (nullable ZDCNode *)parentForNode:(ZDCNode *)node
+                            isGraft:(BOOL *)isGraftPtr
+                        transaction:(YapDatabaseReadTransaction *)transaction
+{
 	NSString *parentID = node.parentID;
+	BOOL isGraft = [parentID hasSuffix:@"|graft"];
+	
 	ZDCNode *parent = nil;
-	do
+	if (isGraft)
+	{
+		NSString *localUserID = nil;
+		NSString *treeID = nil;
+		[ZDCNode getLocalUserID:&localUserID treeID:&treeID fromParentID:parentID];
+			
+		parent = [self findNodeWithPointeeID: node.uuid
+		                         localUserID: localUserID
+		                              treeID: treeID
+		                         transaction: transaction];
+	}
+	else if (parentID)
 	{
-		if ([parentID hasSuffix:@"|graft"])
+		parent = [transaction objectForKey:parentID inCollection:kZDCCollection_Nodes];
+	}
+	
+	if (isGraftPtr) *isGraftPtr = isGraft;
+	return parent;
+}
+
+/**
+ * Returns the ancestry of the given node.
+ *
+ * The node itself isn't looked up in the cache (and its entry isn't stored),
+ * since the caller may be passing a modified copy that differs from what's in the database.
+ * Only the ancestors (fetched from the database) are cached.
+ */
+- (ZDCNodeAncestry *)ancestryForNode:(ZDCNode *)node transaction:(YapDatabaseReadTransaction *)transaction
+{
+	BOOL isGraft = NO;
+	ZDCNode *parent = nil;
+	ZDCNodeAncestry *parentAncestry = nil;
+	
+	if (![node isKindOfClass:[ZDCTrunkNode class]])
+	{
+		parent = [self parentForNode:node isGraft:&isGraft transaction:transaction];
+		if (parent)
 		{
-			NSString *localUserID = nil;
-			NSString *treeID = nil;
-			[ZDCNode getLocalUserID:&localUserID treeID:&treeID fromParentID:node.parentID];
+			NSMutableSet<NSString *> *visiting = [NSMutableSet setWithCapacity:8];
+			if (node.uuid) {
+				[visiting addObject:node.uuid];
+			}
 			
-			parent = [self findNodeWithPointeeID: node.uuid
-			                         localUserID: localUserID
-			                              treeID: treeID
-			                         transaction: transaction];
+			parentAncestry = [self storedAncestryForNode:parent visiting:visiting transaction:transaction];
 		}
-		else
+	}
+	
+	return [[ZDCNodeAncestry alloc] initWithNode: node
+	                                     isGraft: isGraft
+	                                      parent: parent
+	                              parentAncestry: parentAncestry];
+}
+
+/**
+ * Returns the ancestry of a node that was fetched from the database, consulting & populating the cache.
+ */
+- (nullable ZDCNodeAncestry *)storedAncestryForNode:(ZDCNode *)node
+                                           visiting:(NSMutableSet<NSString *> *)visiting
+                                        transaction:(YapDatabaseReadTransaction *)transaction
+{
+	NSString *nodeID = node.uuid;
+	
+	ZDCNodeAncestry *ancestry = [self cachedAncestryForNodeID:nodeID transaction:transaction];
+	if (ancestry) {
+		return ancestry;
+	}
+	
+	if ([visiting containsObject:nodeID])
+	{
+		// The parentID chain contains a cycle.
+		// This should never happen, but we don't want to recurse forever if it does.
+		ZDCLogWarn(@"Cycle detected in node ancestry: %@", nodeID);
+		return nil;
+	}
+	[visiting addObject:nodeID];
+	
+	BOOL isGraft = NO;
+	ZDCNode *parent = nil;
+	ZDCNodeAncestry *parentAncestry = nil;
+	
+	if (![node isKindOfClass:[ZDCTrunkNode class]])
+	{
+		parent = [self parentForNode:node isGraft:&isGraft transaction:transaction];
+		if (parent) {
+			parentAncestry = [self storedAncestryForNode:parent visiting:visiting transaction:transaction];
+		}
+	}
+	
+	ancestry = [[ZDCNodeAncestry alloc] initWithNode: node
+	                                         isGraft: isGraft
+	                                          parent: parent
+	                                  parentAncestry: parentAncestry];
+	
+	if (parent == nil || parentAncestry != nil) // don't cache partial results (cycle)
+	{
+		[self cacheAncestry:ancestry forNodeID:nodeID transaction:transaction];
+	}
+	
+	return ancestry;
+}
+
+- (nullable ZDCNodeAncestry *)cachedAncestryForNodeID:(NSString *)nodeID
+                                          transaction:(YapDatabaseReadTransaction *)transaction
+{
+	if (nodeID == nil) return nil;
+	
+	YapDatabaseConnection *connection = transaction.connection;
+	uint64_t snapshot = connection.snapshot;
+	
+	ZDCNodeAncestry *ancestry = nil;
+	
+	YAPUnfairLockLock(&spinlock);
+	{
+		ZDCNodeAncestryCache *cache = [ancestryCaches objectForKey:connection.database];
+		if (cache && cache->hasSnapshot && cache->snapshot == snapshot)
 		{
-			parent = [transaction objectForKey:parentID inCollection:kZDCCollection_Nodes];
+			ancestry = cache->entries[nodeID];
+			if (ancestry && [cache isDirty:ancestry forTransaction:transaction]) {
+				ancestry = nil;
+			}
 		}
+	}
+	YAPUnfairLockUnlock(&spinlock);
+	
+	return ancestry;
+}
+
+- (void)cacheAncestry:(ZDCNodeAncestry *)ancestry
+            forNodeID:(NSString *)nodeID
+          transaction:(YapDatabaseReadTransaction *)transaction
+{
+	if (nodeID == nil) return;
+	
+	YapDatabaseConnection *connection = transaction.connection;
+	uint64_t snapshot = connection.snapshot;
+	
+	YAPUnfairLockLock(&spinlock);
+	{
+		ZDCNodeAncestryCache *cache = [ancestryCaches objectForKey:connection.database];
 		
-		if (parent && ![parent.uuid hasSuffix:@"|graft"])
+		// If the transaction is behind (or ahead of) the cache, the entry doesn't describe the cache's snapshot.
+		// And if the entry was built from uncommitted changes, it doesn't describe any snapshot.
+		//
+		if (cache && cache->hasSnapshot && cache->snapshot == snapshot &&
+		    ![cache isDirty:ancestry forTransaction:transaction])
 		{
-			[parents insertObject:parent.uuid atIndex:0];
+			if (cache->entries.count >= kMaxAncestryCacheCount) {
+				[cache->entries removeAllObjects];
+			}
+			cache->entries[nodeID] = ancestry;
 		}
-		
-		parentID = parent.parentID;
-	
-	} while (parentID);
+	}
+	YAPUnfairLockUnlock(&spinlock);
+}
+
+/**
+ * Invoked via the DatabaseManager's hooks extension.
+ */
+- (void)didModifyNodeIDs:(NSArray<NSString *> *)nodeIDs transaction:(YapDatabaseReadWriteTransaction *)transaction
+{
+	if (nodeIDs.count == 0) return;
 	
-	return parents;
+	YAPUnfairLockLock(&spinlock);
+	{
+		ZDCNodeAncestryCache *cache = [ancestryCaches objectForKey:transaction.connection.database];
+		[cache markDirty:nodeIDs transaction:transaction];
+	}
+	YAPUnfairLockUnlock(&spinlock);
 }
 
 /**
- * See header file for description.
- * Or view the api's online (for both Swift & Objective-C):
- * https://apis.zerodark.cloud/Classes/ZDCRestManager.html
+ * Invoked via the DatabaseManager's hooks extension.
  */
-- (BOOL)isNode:(NSString *)inNodeID
- aDescendantOf:(NSString *)potentialParentID
-   transaction:(YapDatabaseReadTransaction *)transaction
+- (void)didRemoveAllNodesInTransaction:(YapDatabaseReadWriteTransaction *)transaction
 {
-	ZDCLogAutoTrace();
-	NSParameterAssert(transaction != nil);
+	YAPUnfairLockLock(&spinlock);
+	{
+		ZDCNodeAncestryCache *cache = [ancestryCaches objectForKey:transaction.connection.database];
+		[cache markDirty:nil transaction:transaction];
+	}
+	YAPUnfairLockUnlock(&spinlock);
+}
+
+- (void)databaseModified:(NSNotification *)notification
+{
+	YapDatabase *database = notification.object;
+	NSDictionary *userInfo = notification.userInfo;
+	
+	if (![database isKindOfClass:[YapDatabase class]]) return;
+	
+	NSNumber *snapshotNum = userInfo[YapDatabaseSnapshotKey];
+	if (snapshotNum == nil) return;
 	
-	NSString *nodeID = inNodeID;
-	while (nodeID)
+	BOOL removedAll = [userInfo[YapDatabaseAllKeysRemovedKey] boolValue];
+	if (!removedAll) {
+		removedAll = [userInfo[YapDatabaseRemovedCollectionsKey] containsObject:kZDCCollection_Nodes];
+	}
+	
+	NSMutableSet<NSString *> *changedNodeIDs = [NSMutableSet set];
+	if (!removedAll)
 	{
-		ZDCNode *node = [transaction objectForKey:nodeID inCollection:kZDCCollection_Nodes];
-		if (node)
+		for (YapCollectionKey *ck in userInfo[YapDatabaseObjectChangesKey])
 		{
-			if ([node.parentID isEqualToString:potentialParentID])
-				return YES;
+			if ([ck.collection isEqualToString:kZDCCollection_Nodes]) {
+				[changedNodeIDs addObject:ck.key];
+			}
 		}
-		
-		nodeID = node.parentID;
-		if ([nodeID hasSuffix:@"|graft"])
+		for (YapCollectionKey *ck in userInfo[YapDatabaseRemovedKeysKey])
 		{
-			NSString *localUserID = nil;
-			NSString *treeID = nil;
-			[ZDCNode getLocalUserID:&localUserID treeID:&treeID fromParentID:nodeID];
-			
-			node = [self findNodeWithPointeeID: nodeID
-										  localUserID: localUserID
-												 treeID: treeID
-										  transaction: transaction];
-			nodeID = node.uuid;
+			if ([ck.collection isEqualToString:kZDCCollection_Nodes]) {
+				[changedNodeIDs addObject:ck.key];
+			}
 		}
 	}
 	
-	return NO;
+	YAPUnfairLockLock(&spinlock);
+	{
+		ZDCNodeAncestryCache *cache = [ancestryCaches objectForKey:database];
+		if (cache == nil)
+		{
+			cache = [[ZDCNodeAncestryCache alloc] init];
+			[ancestryCaches setObject:cache forKey:database];
+		}
+		
+		[cache advanceToSnapshot: [snapshotNum unsignedLongLongValue]
+		          changedNodeIDs: changedNodeIDs
+		              removedAll: removedAll];
+	}
+	YAPUnfairLockUnlock(&spinlock);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -909,7 +1310,6 @@ static ZDCNodeManager *sharedInstance = nil;
 	__block ZDCNode *matchingNode = nil;
 	
 	YapDatabaseAutoViewTransaction *treesystemViewTransaction = nil;
-	YapDatabaseAutoViewTransaction *flatViewTransaction = nil;
 	
 	if ((treesystemViewTransaction = [transaction ext:Ext_View_Treesystem_CloudName]))
 	{
@@ -952,70 +1352,33 @@ static ZDCNodeManager *sharedInstance = nil;
 			matchingNode = [treesystemViewTransaction objectAtIndex:index inGroup:parentID];
 		}
 	}
-	else if ((flatViewTransaction = [transaction ext:Ext_View_Flat]))
+	else
 	{
 		// Backup Plan (defensive programming)
 		//
-		// Treesystem View extension isn't ready yet.
+		// Treesystem CloudName View extension isn't ready yet.
 		// It must be still initializing / updating.
 		//
-		// Scan all nodes belonging to the user and look for a match (slow but functional).
+		// Calculate the cloudName of every child (in a single pass) and look for a match (slower but functional).
 		
-		ZDCTrunkNode *trunkNode = [self trunkNodeForNode:parentNode transaction:transaction];
-		
-		NSString *group =
-		  [ZDCDatabaseManager groupForLocalUserID: trunkNode.localUserID
-		                                   treeID: trunkNode.treeID];
+		NSDictionary<NSString*, NSString*> *cloudNames =
+		  [cloudPathManager cloudNamesForChildrenOfNode:parentNode transaction:transaction];
 		
-		[flatViewTransaction enumerateKeysAndObjectsInGroup: group
-		                                         usingBlock:
-		    ^(NSString *collection, NSString *key, id object, NSUInteger index, BOOL *stop)
+		NSString *matchingNodeID = [[cloudNames keysOfEntriesPassingTest:
+		  ^BOOL (NSString *nodeID, NSString *nodeCloudName, BOOL *stop)
 		{
-			__unsafe_unretained ZDCNode *node = (ZDCNode *)object;
-			
-			if ([node.parentID isEqualToString:parentID])
+			if ([nodeCloudName isEqualToString:cloudName])
 			{
-				// Remember:
-				// - [nil localizedCaseInsensitiveCompare:anything] == 0
-				// - NSOrderedSame == 0
-				
-				NSString *nodeCloudName = [cloudPathManager cloudNameForNode:node transaction:transaction];
-				if (nodeCloudName && ([nodeCloudName compare:cloudName] == NSOrderedSame))
-				{
-					matchingNode = node;
-					*stop = YES;
-				}
+				*stop = YES;
+				return YES;
 			}
-		}];
-	}
-	else
-	{
-		// Last resort (super defensive programming)
-		//
-		// None of the extensions we want are ready yet.
-		// It must be still initializing / updating.
-		//
-		// Scan the entire nodes collection and look for a match (slowest but functional).
-		
-		[transaction enumerateKeysAndObjectsInCollection:kZDCCollection_Nodes
-		                                      usingBlock:^(NSString *key, id object, BOOL *stop)
-		{
-			__unsafe_unretained ZDCNode *node = (ZDCNode *)object;
+			return NO;
 			
-			if ([node.parentID isEqualToString:parentID])
-			{
-				// Remember:
-				// - [nil localizedCaseInsensitiveCompare:anything] == 0
-				// - NSOrderedSame == 0
-				
-				NSString *nodeCloudName = [cloudPathManager cloudNameForNode:node transaction:transaction];
-				if (nodeCloudName && ([nodeCloudName compare:cloudName] == NSOrderedSame))
-				{
-					matchingNode = node;
-					*stop = YES;
-				}
-			}
-		}];
+		}] anyObject];
+			
+		if (matchingNodeID) {
+			matchingNode = [transaction objectForKey:matchingNodeID inCollection:kZDCCollection_Nodes];
+		}
 	}
 	
 	return matchingNode;
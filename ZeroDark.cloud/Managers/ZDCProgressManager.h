@@ -91,6 +91,9 @@ typedef void (^UploadCompletionBlock)(BOOL success);
  * - Time remaining calculations:
  *   - Estimated time remaining based on averaged throughput & remaining bytes.
  *   - Available via progress.userInfo[NSProgressEstimatedTimeRemainingKey]
+ *
+ * If a transfer stalls (no bytes for a few seconds), these values are left at their last estimates,
+ * and are updated again once the transfer resumes.
  */
 @interface ZDCProgressManager : NSObject
 
@@ -590,6 +593,31 @@ typedef void (^UploadCompletionBlock)(BOOL success);
 - (void)removeUploadProgressForOperationUUID:(NSUUID *)operationID
                                  withSuccess:(BOOL)success;
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Throughput
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Returns the combined throughput (in bytes per second) of all in-flight transfers of the given type.
+ *
+ * The throughput of an individual transfer is available via its NSProgress:
+ * `progress.userInfo[NSProgressThroughputKey]`
+ *
+ * @return The aggregate throughput, or nil if nothing is currently transferring.
+ *         If every in-flight transfer of the given type is stalled, the last estimate is returned.
+ */
+- (nullable NSNumber *)throughputForProgressType:(ZDCProgressType)progressType;
+
+/**
+ * Returns the estimated time remaining (in seconds) for all in-flight transfers of the given type.
+ *
+ * The estimate of an individual transfer is available via its NSProgress:
+ * `progress.userInfo[NSProgressEstimatedTimeRemainingKey]`
+ *
+ * @return The aggregate estimate, or nil if nothing is currently transferring.
+ */
+- (nullable NSNumber *)estimatedTimeRemainingForProgressType:(ZDCProgressType)progressType;
+
 @end
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
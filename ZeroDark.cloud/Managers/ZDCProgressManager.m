@@ -15,6 +15,8 @@
 #import "ZDCLogging.h"
 #import "ZDCProgress.h"
 
+#import <YapDatabase/YapDatabaseAtomic.h>
+
 // Log Levels: off, error, warn, info, verbose
 // Log Flags : trace
 #if DEBUG
@@ -30,7 +32,21 @@
 /* extern */ NSString *const ZDCProgressTypeKey = @"ZDCProgressType";
 /* extern */ NSString *const ZDCNodeMetaComponentsKey = @"ZDCNodeMetaComponents";
 
-/* private*/ NSString *kProgress_UserInfo_ZDCNetworkSpeedInfo = @"ZDCNetworkSpeedInfo";
+static void *ZDCProgressManagerKVOContext = &ZDCProgressManagerKVOContext;
+
+static NSTimeInterval const kSampleIntervalInSeconds = 0.5;
+
+/**
+ * If a transfer doesn't report any bytes for this many consecutive samples,
+ * it's considered stalled, and is dropped from the sampler until it reports bytes again.
+ * (This matches the "neutral sample" threshold used by the moving average.)
+ *
+ * A stalled transfer keeps its last published throughput & time remaining.
+ * These are updated again once the transfer resumes (or cleared when it's removed).
+ */
+static NSUInteger const kMaxIdleSamples = 6;
+
+static NSUInteger const kProgressTypeCount = 3; // ZDCProgressType_MetaDownload ... ZDCProgressType_Upload
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -74,26 +90,171 @@
 
 @interface ZDCNetworkSpeedInfo : NSObject
 
-@property (nonatomic, assign, readwrite) int64_t last_totalUnitCount;
-@property (nonatomic, assign, readwrite) int64_t last_completedUnitCount;
 @property (nonatomic, assign, readwrite) int64_t last_bytesPerSecond;
 @property (nonatomic, assign, readwrite) BOOL    last_bytesPerSecondValid;
 @property (nonatomic, strong, readwrite) NSDate *last_date;
 @property (nonatomic, assign, readwrite) uint64_t sampleCount_positive;
 @property (nonatomic, assign, readwrite) uint64_t sampleCount_neutral;
 
+- (void)reset;
+- (void)pause;
+
 @end
 
 @implementation ZDCNetworkSpeedInfo
 
-@synthesize last_totalUnitCount;
-@synthesize last_completedUnitCount;
 @synthesize last_bytesPerSecond;
 @synthesize last_bytesPerSecondValid;
 @synthesize last_date;
 @synthesize sampleCount_positive;
 @synthesize sampleCount_neutral;
 
+- (void)reset
+{
+	last_bytesPerSecond = 0;
+	last_bytesPerSecondValid = NO;
+	last_date = nil;
+	sampleCount_positive = 0;
+	sampleCount_neutral = 0;
+}
+
+/**
+ * Keeps the current average, but forgets when the last sample was taken.
+ * So the time spent paused isn't folded into the average when sampling resumes.
+ */
+- (void)pause
+{
+	last_date = nil;
+}
+
+/**
+ * Adds a sample to the exponential moving average.
+ *
+ * @return
+ *   The smoothed bytesPerSecond, or a negative value if there aren't enough samples yet.
+ */
+- (double)addSampleWithBytes:(int64_t)bytesDiff date:(NSDate *)current_date
+{
+	NSTimeInterval secondsDiff = 0;
+	if (last_date)
+	{
+		secondsDiff = [current_date timeIntervalSinceDate:last_date];
+	}
+	
+	if (last_date == nil)
+	{
+		// First sample (or first sample after a pause).
+		// We need another sample before we can calculate a new rate.
+		
+		last_date = current_date;
+		return last_bytesPerSecondValid ? (double)last_bytesPerSecond : -1.0;
+	}
+	
+	if (secondsDiff <= 0 || // sanity check
+	    bytesDiff < 0)      // sanity check
+	{
+		[self reset];
+		last_date = current_date;
+		
+		return -1.0;
+	}
+	
+	int64_t current_bytesPerSecond = (int64_t)(bytesDiff / secondsDiff);
+	int64_t previous_bytesPerSecond = last_bytesPerSecondValid ? last_bytesPerSecond : current_bytesPerSecond;
+	
+	// Using exponential moving average
+	//
+	// averageSpeed = SMOOTHING_FACTOR * lastSpeed + (1-SMOOTHING_FACTOR) * averageSpeed;
+	//
+	// A higher SMOOTHING_FACTOR discounts older observations faster.
+	// So we start with a higher SMOOTHING_FACTOR, and decrease it as we get more samples.
+	
+	double smoothing_factor;
+	if (sampleCount_positive < 8)
+		smoothing_factor = 0.05;
+	else if (sampleCount_positive < 16)
+		smoothing_factor = 0.03;
+	else
+		smoothing_factor = 0.001;
+	
+	double bytesPerSecond =
+	    (smoothing_factor * current_bytesPerSecond)
+	  + ((1.0 - smoothing_factor) * previous_bytesPerSecond);
+	
+	last_bytesPerSecond = (int64_t)bytesPerSecond;
+	last_bytesPerSecondValid = YES;
+	last_date = current_date;
+	
+	if (bytesDiff > 0)
+	{
+		sampleCount_positive++;
+		sampleCount_neutral = 0;
+	}
+	else
+	{
+		sampleCount_neutral++;
+		if ((sampleCount_neutral > kMaxIdleSamples) && (sampleCount_positive > 0)) {
+			sampleCount_positive = 0;
+		}
+	}
+	
+	return bytesPerSecond;
+}
+
+@end
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark -
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Tracks a single monitored NSProgress.
+ *
+ * Properties marked "eventLock" are updated from whatever thread the progress is updated on (via KVO).
+ * Properties marked "timerQueue" are only touched by the sampler.
+ */
+@interface ZDCMonitoredProgress : NSObject
+
+@property (nonatomic, strong, readonly) NSProgress *progress;
+@property (nonatomic, assign, readonly) ZDCProgressType progressType;
+
+@property (nonatomic, assign, readwrite) int64_t lastCompletedUnitCount; // eventLock
+@property (nonatomic, assign, readwrite) int64_t lastTotalUnitCount;     // eventLock
+@property (nonatomic, assign, readwrite) int64_t pendingBytes;           // eventLock
+@property (nonatomic, assign, readwrite) BOOL    pendingReset;           // eventLock
+@property (nonatomic, assign, readwrite) BOOL    isActive;               // eventLock
+
+@property (nonatomic, strong, readonly)  ZDCNetworkSpeedInfo *speedInfo; // timerQueue
+@property (nonatomic, assign, readwrite) NSUInteger idleSamples;         // timerQueue
+@property (nonatomic, assign, readwrite) BOOL isComplete;                // timerQueue
+
+- (int64_t)remainingBytes; // eventLock
+
+@end
+
+@implementation ZDCMonitoredProgress
+
+@synthesize progress = _progress;
+@synthesize progressType = _progressType;
+@synthesize speedInfo = _speedInfo;
+
+- (instancetype)initWithProgress:(NSProgress *)progress type:(ZDCProgressType)progressType
+{
+	if ((self = [super init]))
+	{
+		_progress = progress;
+		_progressType = progressType;
+		_speedInfo = [[ZDCNetworkSpeedInfo alloc] init];
+	}
+	return self;
+}
+
+- (int64_t)remainingBytes
+{
+	if (self.lastTotalUnitCount <= 0) return 0;
+	return MAX(0, self.lastTotalUnitCount - self.lastCompletedUnitCount);
+}
+
 @end
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -108,8 +269,17 @@
 	void *IsOnQueueKey;
 	
 	dispatch_queue_t timerQueue;
-	dispatch_source_t timer;
-	NSMutableArray<NSProgress *> *monitoring;
+	dispatch_source_t timer; // must be accessed from within timerQueue
+	BOOL timerSuspended;     // must be accessed from within timerQueue
+	ZDCNetworkSpeedInfo *aggregateSpeedInfo[kProgressTypeCount]; // must be accessed from within timerQueue
+	
+	YAPUnfairLock eventLock;
+	NSMapTable<NSProgress *, ZDCMonitoredProgress *> *monitoring;        // must be accessed within eventLock
+	NSMutableArray<ZDCMonitoredProgress *> *activeMonitoring;            // must be accessed within eventLock
+	BOOL samplerRunning;                                                 // must be accessed within eventLock
+	int64_t aggregatePendingBytes[kProgressTypeCount];                   // must be accessed within eventLock
+	int64_t aggregateThroughput[kProgressTypeCount];                     // must be accessed within eventLock
+	NSTimeInterval aggregateTimeRemaining[kProgressTypeCount];           // must be accessed within eventLock
 	
 	NSMutableDictionary<NSString *, ZDCProgressItem *> * metaDownloadDict;
 	NSMutableDictionary<NSString *, ZDCProgressItem *> * dataDownloadDict;
@@ -137,7 +307,15 @@
 		dispatch_queue_set_specific(queue, IsOnQueueKey, IsOnQueueKey, NULL);
 		
 		timerQueue = dispatch_queue_create("ZDCProgressManager-Timer", DISPATCH_QUEUE_SERIAL);
-		monitoring = [[NSMutableArray alloc] init];
+		for (NSUInteger i = 0; i < kProgressTypeCount; i++) {
+			aggregateSpeedInfo[i] = [[ZDCNetworkSpeedInfo alloc] init];
+		}
+		
+		eventLock = YAP_UNFAIR_LOCK_INIT;
+		monitoring = [NSMapTable mapTableWithKeyOptions: NSPointerFunctionsStrongMemory |
+		                                                 NSPointerFunctionsObjectPointerPersonality
+		                                   valueOptions: NSPointerFunctionsStrongMemory];
+		activeMonitoring = [[NSMutableArray alloc] init];
 		
 		metaDownloadDict = [[NSMutableDictionary alloc] init];
 		dataDownloadDict = [[NSMutableDictionary alloc] init];
@@ -150,6 +328,25 @@
 	return self;
 }
 
+- (void)dealloc
+{
+	for (NSProgress *progress in [monitoring keyEnumerator])
+	{
+		[progress removeObserver: self
+		              forKeyPath: NSStringFromSelector(@selector(completedUnitCount))
+		                 context: ZDCProgressManagerKVOContext];
+	}
+	
+	if (timer)
+	{
+		// It's a programmer error to release a suspended dispatch source.
+		if (timerSuspended) {
+			dispatch_resume(timer);
+		}
+		dispatch_source_cancel(timer);
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Utilities
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -171,34 +368,92 @@
 		dispatch_async(dispatch_get_main_queue(), block);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Throughput
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * See header file for description.
+ * Or view the api's online (for both Swift & Objective-C):
+ * https://apis.zerodark.cloud/Classes/ZDCProgressManager.html
+ */
+- (nullable NSNumber *)throughputForProgressType:(ZDCProgressType)progressType
+{
+	if ((NSUInteger)progressType >= kProgressTypeCount) return nil;
+	
+	YAPUnfairLockLock(&eventLock);
+	int64_t bytesPerSecond = aggregateThroughput[progressType];
+	YAPUnfairLockUnlock(&eventLock);
+	
+	return (bytesPerSecond > 0) ? @(bytesPerSecond) : nil;
+}
+
+/**
+ * See header file for description.
+ * Or view the api's online (for both Swift & Objective-C):
+ * https://apis.zerodark.cloud/Classes/ZDCProgressManager.html
+ */
+- (nullable NSNumber *)estimatedTimeRemainingForProgressType:(ZDCProgressType)progressType
+{
+	if ((NSUInteger)progressType >= kProgressTypeCount) return nil;
+	
+	YAPUnfairLockLock(&eventLock);
+	int64_t bytesPerSecond = aggregateThroughput[progressType];
+	NSTimeInterval timeRemaining = aggregateTimeRemaining[progressType];
+	YAPUnfairLockUnlock(&eventLock);
+	
+	return (bytesPerSecond > 0) ? @(timeRemaining) : nil;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Monitoring
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/**
+ * Throughput calculations are event driven:
+ *
+ * - Each monitored NSProgress is observed (via KVO) for changes to completedUnitCount.
+ *   The observer simply pushes the byte delta into the aggregator (a few integer ops within an unfair lock).
+ * - A sampler (timer) periodically folds the accumulated deltas into the moving averages,
+ *   both per-progress & aggregate (per ZDCProgressType), and publishes the results.
+ *
+ * Originally we attempted to calculate the throughput directly within the KVO callback.
+ * But this had accuracy problems, as updates arrive at irregular intervals.
+ * Sampling the accumulated deltas at a fixed interval fixes this,
+ * and also coalesces the (potentially very chatty) progress updates into a single update per interval.
+ *
+ * The sampler only visits progress items that have recently transferred bytes.
+ * Items that stall (or finish) are dropped from the sampler,
+ * and once nothing is active the timer is suspended entirely. The next byte delta resumes it.
+ */
 - (void)startMonitoringProgress:(NSProgress *)progress
 {
 	if (progress == nil) return;
 	NSAssert(dispatch_get_specific(IsOnQueueKey), @"Invoked on incorrect queue");
 	
-	NSUInteger index = [monitoring indexOfObjectIdenticalTo:progress];
-	if (index == NSNotFound)
-	{
-		/* This was the original idea.
-		 * However, it didn't work very well due to throughput accuracy issues.
-		 * It ended up being far more accurate to simply use a timer, and check a few times per second.
-		 *
-		[progress addObserver:self
-					  forKeyPath:NSStringFromSelector(@selector(fractionCompleted))
-						  options:0
-						  context:NULL];
-		*/
-		
-		[monitoring addObject:progress];
-		if (monitoring.count == 1)
-		{
-			[self startTimer];
-		}
-	}
+	YAPUnfairLockLock(&eventLock);
+	BOOL alreadyMonitoring = ([monitoring objectForKey:progress] != nil);
+	YAPUnfairLockUnlock(&eventLock);
+		
+	if (alreadyMonitoring) return;
+	
+	ZDCProgressType progressType = (ZDCProgressType)[progress.userInfo[ZDCProgressTypeKey] integerValue];
+	
+	ZDCMonitoredProgress *entry = [[ZDCMonitoredProgress alloc] initWithProgress:progress type:progressType];
+	entry.lastCompletedUnitCount = progress.completedUnitCount;
+	entry.lastTotalUnitCount = progress.totalUnitCount;
+	
+	YAPUnfairLockLock(&eventLock);
+	[monitoring setObject:entry forKey:progress];
+	YAPUnfairLockUnlock(&eventLock);
+	
+	[progress addObserver: self
+	           forKeyPath: NSStringFromSelector(@selector(completedUnitCount))
+	              options: 0
+	              context: ZDCProgressManagerKVOContext];
+	
+	// Include the item in the next sample (so the remaining bytes are reflected in the aggregate ETA).
+	[self activateMonitoredProgress:entry];
 }
 
 - (void)stopMonitoringProgress:(NSProgress *)progress
@@ -206,204 +461,456 @@
 	if (progress == nil) return;
 	NSAssert(dispatch_get_specific(IsOnQueueKey), @"Invoked on incorrect queue");
 	
-	NSUInteger index = [monitoring indexOfObjectIdenticalTo:progress];
-	if (index != NSNotFound)
+	BOOL lastOfType = NO;
+	
+	YAPUnfairLockLock(&eventLock);
+	
+	ZDCMonitoredProgress *entry = [monitoring objectForKey:progress];
+	if (entry)
 	{
-		/* See comment in `startMonitoringProgress:`
-		 *
-		[progress removeObserver:self forKeyPath:NSStringFromSelector(@selector(fractionCompleted))];
-		*/
+		[monitoring removeObjectForKey:progress];
+		
+		if (entry.isActive)
+		{
+			entry.isActive = NO;
+			[activeMonitoring removeObjectIdenticalTo:entry];
+		}
+		
+		lastOfType = YES;
+		for (ZDCMonitoredProgress *other in [monitoring objectEnumerator])
+		{
+			if (other.progressType == entry.progressType) {
+				lastOfType = NO;
+				break;
+			}
+		}
 		
-		[monitoring removeObjectAtIndex:index];
-		if (monitoring.count == 0)
+		if (lastOfType)
 		{
-			[self stopTimer];
+			// The aggregate values may have been retained for a stalled transfer (see timerFire).
+			// With nothing left in flight, they no longer apply.
+			
+			aggregateThroughput[entry.progressType] = 0;
+			aggregateTimeRemaining[entry.progressType] = 0;
 		}
 	}
+	
+	YAPUnfairLockUnlock(&eventLock);
+	
+	if (entry)
+	{
+		[progress removeObserver: self
+		              forKeyPath: NSStringFromSelector(@selector(completedUnitCount))
+		                 context: ZDCProgressManagerKVOContext];
+		
+		// Values retained while stalled (see timerFire) no longer apply.
+		[self publishThroughput:-1 timeRemaining:0 forProgress:progress];
+	}
+	
+	if (lastOfType)
+	{
+		ZDCProgressType progressType = entry.progressType;
+		
+		__weak typeof(self) weakSelf = self;
+		dispatch_async(timerQueue, ^{ @autoreleasepool {
+			
+			__strong typeof(self) strongSelf = weakSelf;
+			if (strongSelf) {
+				[strongSelf->aggregateSpeedInfo[progressType] reset];
+			}
+		}});
+	}
 }
 
 /**
- * We use the timer to ensure regular calculation updates.
- * Otherwise, we're only updating the calculation when bytes go across the network.
- * But if the network connection slows to a halt, we want our calculations to continue updating.
-**/
-- (void)startTimer
+ * Invoked on whatever thread updated the progress.
+ * So this needs to be as cheap as possible.
+ */
+- (void)observeValueForKeyPath:(NSString *)keyPath
+                      ofObject:(id)object
+                        change:(NSDictionary *)change
+                       context:(void *)context
 {
-	NSAssert(dispatch_get_specific(IsOnQueueKey), @"Invoked on incorrect queue");
+	if (context != ZDCProgressManagerKVOContext)
+	{
+		[super observeValueForKeyPath:keyPath ofObject:object change:change context:context];
+		return;
+	}
+	
+	NSProgress *progress = (NSProgress *)object;
+	
+	int64_t current_completedUnitCount = progress.completedUnitCount;
+	int64_t current_totalUnitCount = progress.totalUnitCount;
 	
+	ZDCMonitoredProgress *entry = nil;
+	int64_t bytesDiff = 0;
+	
+	YAPUnfairLockLock(&eventLock);
+	{
+		entry = [monitoring objectForKey:progress];
+		if (entry)
+		{
+			bytesDiff = current_completedUnitCount - entry.lastCompletedUnitCount;
+			
+			if (bytesDiff < 0 || current_totalUnitCount != entry.lastTotalUnitCount)
+			{
+				// Progress was reset (e.g. upload restarted), or the total changed
+				entry.pendingBytes = 0;
+				entry.pendingReset = YES;
+			}
+			else
+			{
+				entry.pendingBytes += bytesDiff;
+				aggregatePendingBytes[entry.progressType] += bytesDiff;
+			}
+			
+			entry.lastCompletedUnitCount = current_completedUnitCount;
+			entry.lastTotalUnitCount = current_totalUnitCount;
+		}
+	}
+	YAPUnfairLockUnlock(&eventLock);
+	
+	if (entry && (bytesDiff != 0 || entry.pendingReset))
+	{
+		[self activateMonitoredProgress:entry];
+	}
+}
+
+/**
+ * Adds the entry to the list of items visited by the sampler,
+ * and resumes the sampler if needed.
+ */
+- (void)activateMonitoredProgress:(ZDCMonitoredProgress *)entry
+{
+	BOOL needsResume = NO;
+	
+	YAPUnfairLockLock(&eventLock);
+	{
+		if (!entry.isActive && ([monitoring objectForKey:entry.progress] == entry))
+		{
+			entry.isActive = YES;
+			[activeMonitoring addObject:entry];
+		}
+		
+		if (!samplerRunning && (activeMonitoring.count > 0))
+		{
+			samplerRunning = YES;
+			needsResume = YES;
+		}
+	}
+	YAPUnfairLockUnlock(&eventLock);
+	
+	if (needsResume)
+	{
+		__weak typeof(self) weakSelf = self;
+		dispatch_async(timerQueue, ^{ @autoreleasepool {
+			
+			[weakSelf resumeTimer];
+		}});
+	}
+}
+
+- (void)resumeTimer
+{
 	if (timer == NULL)
 	{
 		timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, timerQueue);
 		
 		__weak typeof(self) weakSelf = self;
-		dispatch_source_set_event_handler(timer, ^{
+		dispatch_source_set_event_handler(timer, ^{ @autoreleasepool {
 			
 			[weakSelf timerFire];
-		});
+		}});
 		
-		NSTimeInterval fireIntervalInSeconds = 0.5; // seconds
+		timerSuspended = YES; // dispatch sources are created in a suspended state
+	}
 		
-		dispatch_time_t start = dispatch_time(DISPATCH_TIME_NOW, (uint64_t)(fireIntervalInSeconds * NSEC_PER_SEC));
+	if (timerSuspended)
+	{
+		dispatch_time_t start = dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kSampleIntervalInSeconds * NSEC_PER_SEC));
 		
-		uint64_t interval = (uint64_t)(fireIntervalInSeconds * NSEC_PER_SEC);
+		uint64_t interval = (uint64_t)(kSampleIntervalInSeconds * NSEC_PER_SEC);
 		uint64_t leeway = (uint64_t)(0.1 * NSEC_PER_SEC);
 		
 		dispatch_source_set_timer(timer, start, interval, leeway);
 		dispatch_resume(timer);
+		
+		timerSuspended = NO;
 	}
 }
 
-- (void)stopTimer
+- (void)suspendTimer
 {
-	NSAssert(dispatch_get_specific(IsOnQueueKey), @"Invoked on incorrect queue");
-	
-	if (timer)
+	if (timer && !timerSuspended)
 	{
-		timer = NULL;
+		dispatch_suspend(timer);
+		timerSuspended = YES;
 	}
 }
 
 - (void)timerFire
 {
-	__block NSArray<NSProgress *> *_monitoring = nil;
-	
-	dispatch_sync(queue, ^{ @autoreleasepool {
-	#pragma clang diagnostic push
-	#pragma clang diagnostic ignored "-Wimplicit-retain-self"
-		
-		_monitoring = [monitoring copy];
-		
-	#pragma clang diagnostic pop
-	}});
+	NSDate *now = [NSDate date];
 	
-	for (NSProgress *progress in _monitoring)
-	{
-		[self observeValueForKeyPath:nil ofObject:progress change:nil context:NULL];
-	}
-}
-
-- (void)observeValueForKeyPath:(NSString *)keyPath
-                      ofObject:(id)object
-                        change:(NSDictionary *)change
-                       context:(void *)context
-{
-	NSAssert([object isKindOfClass:[NSProgress class]], @"Bad object");
+	// Step 1 of 3:
+	//
+	// Drain the pending byte deltas (within the lock).
 	
-	NSProgress *progress = (NSProgress *)object;
+	NSArray<ZDCMonitoredProgress *> *active = nil;
+	int64_t *activeBytes = NULL;
+	int64_t *activeRemaining = NULL;
+	BOOL *activeReset = NULL;
 	
-	int64_t current_totalUnitCount = progress.totalUnitCount;
-	int64_t current_completedUnitCount = progress.completedUnitCount;
-	NSDate *current_date = [NSDate date];
+	int64_t aggregateBytes[kProgressTypeCount];
+	int64_t aggregateRemaining[kProgressTypeCount];
 	
-	if ((current_totalUnitCount > 0) && (current_completedUnitCount >= current_totalUnitCount))
+	YAPUnfairLockLock(&eventLock);
 	{
-		// Progress is >= 100%
-		// So there's no need to keep monitoring the throughput.
+		active = [activeMonitoring copy];
 		
-		[progress setUserInfoObject:nil forKey:kProgress_UserInfo_ZDCNetworkSpeedInfo];
-		[progress setUserInfoObject:nil forKey:NSProgressThroughputKey];
-		[progress setUserInfoObject:nil forKey:NSProgressEstimatedTimeRemainingKey];
+		NSUInteger count = active.count;
+		if (count > 0)
+		{
+			activeBytes     = (int64_t *)malloc(sizeof(int64_t) * count);
+			activeRemaining = (int64_t *)malloc(sizeof(int64_t) * count);
+			activeReset     = (BOOL *)malloc(sizeof(BOOL) * count);
+		}
 		
-		dispatch_async(queue, ^{ @autoreleasepool { // we're currently on the timerQueue
-			[self stopMonitoringProgress:progress];
-		}});
-		return;
+		NSUInteger i = 0;
+		for (ZDCMonitoredProgress *entry in active)
+		{
+			activeBytes[i] = entry.pendingBytes;
+			activeRemaining[i] = entry.remainingBytes;
+			activeReset[i] = entry.pendingReset;
+			
+			entry.pendingBytes = 0;
+			entry.pendingReset = NO;
+			i++;
+		}
+		
+		for (NSUInteger type = 0; type < kProgressTypeCount; type++)
+		{
+			aggregateBytes[type] = aggregatePendingBytes[type];
+			aggregatePendingBytes[type] = 0;
+			aggregateRemaining[type] = 0;
+		}
+		
+		// The aggregate ETA needs the remaining bytes of every in-flight item,
+		// including those that are currently stalled.
+		
+		for (ZDCMonitoredProgress *entry in [monitoring objectEnumerator])
+		{
+			aggregateRemaining[entry.progressType] += entry.remainingBytes;
+		}
 	}
+	YAPUnfairLockUnlock(&eventLock);
+
+	// Step 2 of 3:
+	//
+	// Update the moving averages (outside the lock).
 	
-	ZDCNetworkSpeedInfo *nsi = progress.userInfo[kProgress_UserInfo_ZDCNetworkSpeedInfo];
+	NSMutableArray<ZDCMonitoredProgress *> *inactive = nil;
+	NSMutableArray<NSProgress *> *completed = nil;
 	
-	if (nsi == nil)
+	NSUInteger i = 0;
+	for (ZDCMonitoredProgress *entry in active)
 	{
-		nsi = [[ZDCNetworkSpeedInfo alloc] init];
-		nsi.last_totalUnitCount = current_totalUnitCount;
-		nsi.last_completedUnitCount = current_completedUnitCount;
+		int64_t bytesDiff = activeBytes[i];
+		int64_t bytesRemaining = activeRemaining[i];
+		BOOL reset = activeReset[i];
+		i++;
 		
-		[progress setUserInfoObject:nsi forKey:kProgress_UserInfo_ZDCNetworkSpeedInfo];
-	}
-	else
-	{
-		NSTimeInterval secondsDiff = 0;
-		if (nsi.last_date)
+		NSProgress *progress = entry.progress;
+	
+		if (entry.isComplete)
 		{
-			secondsDiff = [current_date timeIntervalSinceDate:nsi.last_date];
+			if (inactive == nil) inactive = [NSMutableArray array];
+			[inactive addObject:entry];
+			continue;
 		}
 		
-		int64_t bytesDiff = current_completedUnitCount - nsi.last_completedUnitCount;
-		
-		if (nsi.last_date == nil ||                            // first sample
-		    secondsDiff < 0      ||                            // sanity check
-		    bytesDiff < 0        ||                            // sanity check
-		    nsi.last_totalUnitCount != current_totalUnitCount) // sanity check
+		if ((progress.totalUnitCount > 0) && (bytesRemaining == 0))
 		{
-			nsi.last_totalUnitCount = current_totalUnitCount;
-			nsi.last_completedUnitCount = current_completedUnitCount;
-			nsi.last_bytesPerSecond = 0;
-			nsi.last_bytesPerSecondValid = NO;
-			nsi.last_date = current_date;
-			nsi.sampleCount_positive = 0;
-			nsi.sampleCount_neutral = 0;
+			// Progress is >= 100%
+			// So there's no need to keep monitoring the throughput.
+		
+			entry.isComplete = YES;
+			[self publishThroughput:-1 timeRemaining:0 forProgress:progress];
+		
+			if (inactive == nil) inactive = [NSMutableArray array];
+			[inactive addObject:entry];
 			
-			[progress setUserInfoObject:nil forKey:NSProgressThroughputKey];
-			[progress setUserInfoObject:nil forKey:NSProgressEstimatedTimeRemainingKey];
+			if (completed == nil) completed = [NSMutableArray array];
+			[completed addObject:progress];
+			continue;
+		}
+	
+		if (reset)
+		{
+			[entry.speedInfo reset];
+			entry.idleSamples = 0;
+			[self publishThroughput:-1 timeRemaining:0 forProgress:progress];
+		}
+	
+		double bytesPerSecond = [entry.speedInfo addSampleWithBytes:bytesDiff date:now];
+		
+		if (bytesDiff > 0)
+			entry.idleSamples = 0;
+		else
+			entry.idleSamples++;
+		
+		if (bytesPerSecond > 0)
+		{
+			NSTimeInterval timeRemaining = (double)bytesRemaining / bytesPerSecond;
+			[self publishThroughput:(int64_t)bytesPerSecond timeRemaining:timeRemaining forProgress:progress];
 		}
 		else
 		{
-			int64_t current_bytesPerSecond = (int64_t)(bytesDiff / secondsDiff);
-			int64_t last_bytesPerSecond =
-				nsi.last_bytesPerSecondValid ? nsi.last_bytesPerSecond : current_bytesPerSecond;
+			[self publishThroughput:-1 timeRemaining:0 forProgress:progress];
+		}
+		
+		if (entry.idleSamples > kMaxIdleSamples)
+		{
+			// Stalled.
+			// Stop sampling it until it reports bytes again.
+			// The last published values are left alone until then (see kMaxIdleSamples).
 			
-			// Using exponential moving average
-			//
-			// averageSpeed = SMOOTHING_FACTOR * lastSpeed + (1-SMOOTHING_FACTOR) * averageSpeed;
-			//
-			// A higher SMOOTHING_FACTOR discounts older observations faster.
-			// So we start with a higher SMOOTHING_FACTOR, and decrease it as we get more samples.
+			[entry.speedInfo pause];
 			
-			double smoothing_factor;
-			if (nsi.sampleCount_positive < 8)
-				smoothing_factor = 0.05;
-			else if (nsi.sampleCount_positive < 16)
-				smoothing_factor = 0.03;
-			else
-				smoothing_factor = 0.001;
+			if (inactive == nil) inactive = [NSMutableArray array];
+			[inactive addObject:entry];
+		}
+	}
+	
+	if (activeBytes) free(activeBytes);
+	if (activeRemaining) free(activeRemaining);
+	if (activeReset) free(activeReset);
+	
+	int64_t throughput[kProgressTypeCount];
+	NSTimeInterval timeRemaining[kProgressTypeCount];
+	
+	for (NSUInteger type = 0; type < kProgressTypeCount; type++)
+	{
+		ZDCNetworkSpeedInfo *nsi = aggregateSpeedInfo[type];
+		double bytesPerSecond = -1;
 			
-			double bytesPerSecond =
-			    (smoothing_factor * current_bytesPerSecond)
-			  + ((1.0 - smoothing_factor) * last_bytesPerSecond);
+		if (aggregateRemaining[type] > 0)
+			bytesPerSecond = [nsi addSampleWithBytes:aggregateBytes[type] date:now];
+		else
+			[nsi reset];
+		
+		if (bytesPerSecond > 0)
+		{
+			throughput[type] = (int64_t)bytesPerSecond;
+			timeRemaining[type] = (double)aggregateRemaining[type] / bytesPerSecond;
+		}
+		else
+		{
+			throughput[type] = 0;
+			timeRemaining[type] = 0;
+		}
+	}
 			
-			nsi.last_completedUnitCount = current_completedUnitCount;
-			nsi.last_bytesPerSecond = (int64_t)bytesPerSecond;
-			nsi.last_bytesPerSecondValid = YES;
-			nsi.last_date = current_date;
+	// Step 3 of 3:
+	//
+	// Publish the aggregate values, drop inactive items, and suspend the timer if nothing is active.
+	
+	BOOL shouldSuspend = NO;
+	
+	YAPUnfairLockLock(&eventLock);
+	{
+		for (NSUInteger type = 0; type < kProgressTypeCount; type++)
+		{
+			aggregateThroughput[type] = throughput[type];
+			aggregateTimeRemaining[type] = timeRemaining[type];
+		}
+		
+		for (ZDCMonitoredProgress *entry in inactive)
+		{
+			// Watch out for race condition:
+			// Bytes may have arrived after we drained the pending count.
 			
-			if (bytesDiff > 0)
+			if (entry.isActive && (entry.pendingBytes == 0) && !entry.pendingReset)
 			{
-				nsi.sampleCount_positive++;
-				nsi.sampleCount_neutral = 0;
+				entry.isActive = NO;
+				[activeMonitoring removeObjectIdenticalTo:entry];
 			}
-			else
+		}
+		
+		if (activeMonitoring.count == 0)
+		{
+			// Nothing is actively transferring.
+			// Types with stalled transfers keep their last aggregate values (same as the transfers themselves).
+			// Otherwise there's no meaningful aggregate throughput.
+			
+			for (NSUInteger type = 0; type < kProgressTypeCount; type++)
 			{
-				nsi.sampleCount_neutral++;
-				if ((nsi.sampleCount_neutral > 6) && (nsi.sampleCount_positive > 0)) {
-					nsi.sampleCount_positive = 0;
+				if (aggregateRemaining[type] == 0)
+				{
+					aggregateThroughput[type] = 0;
+					aggregateTimeRemaining[type] = 0;
 				}
 			}
 			
-			if (bytesPerSecond > 0)
-			{
-				int64_t bytesRemaining = current_totalUnitCount - current_completedUnitCount;
-				NSTimeInterval timeRemaining = (double)bytesRemaining / (double)bytesPerSecond;
-				
-				[progress setUserInfoObject:@((int64_t)bytesPerSecond) forKey:NSProgressThroughputKey];
-				[progress setUserInfoObject:@(timeRemaining)           forKey:NSProgressEstimatedTimeRemainingKey];
-			}
+			samplerRunning = NO;
+			shouldSuspend = YES;
+		}
+	}
+	YAPUnfairLockUnlock(&eventLock);
+	
+	if (shouldSuspend)
+	{
+		for (NSUInteger type = 0; type < kProgressTypeCount; type++)
+		{
+			if (aggregateRemaining[type] > 0)
+				[aggregateSpeedInfo[type] pause];
 			else
-			{
-				[progress setUserInfoObject:nil forKey:NSProgressThroughputKey];
-				[progress setUserInfoObject:nil forKey:NSProgressEstimatedTimeRemainingKey];
+				[aggregateSpeedInfo[type] reset];
+		}
+		
+		[self suspendTimer];
+	}
+	
+	if (completed.count > 0)
+	{
+		dispatch_async(queue, ^{ @autoreleasepool { // we're currently on the timerQueue
+			
+			for (NSProgress *progress in completed) {
+				[self stopMonitoringProgress:progress];
 			}
+		}});
+	}
+}
+
+/**
+ * Updates the progress.userInfo (which triggers KVO notifications for any observers).
+ * To avoid spamming observers, we only touch the userInfo if the values actually changed.
+ */
+- (void)publishThroughput:(int64_t)bytesPerSecond
+            timeRemaining:(NSTimeInterval)timeRemaining
+              forProgress:(NSProgress *)progress
+{
+	NSDictionary *userInfo = progress.userInfo;
+	
+	NSNumber *oldThroughput = userInfo[NSProgressThroughputKey];
+	NSNumber *oldTimeRemaining = userInfo[NSProgressEstimatedTimeRemainingKey];
+	
+	if (bytesPerSecond > 0)
+	{
+		NSNumber *newThroughput = @(bytesPerSecond);
+		NSNumber *newTimeRemaining = @(timeRemaining);
+				
+		if (![oldThroughput isEqualToNumber:newThroughput] || ![oldTimeRemaining isEqualToNumber:newTimeRemaining])
+		{
+			[progress setUserInfoObject:newThroughput    forKey:NSProgressThroughputKey];
+			[progress setUserInfoObject:newTimeRemaining forKey:NSProgressEstimatedTimeRemainingKey];
 		}
 	}
+	else if (oldThroughput || oldTimeRemaining)
+	{
+		[progress setUserInfoObject:nil forKey:NSProgressThroughputKey];
+		[progress setUserInfoObject:nil forKey:NSProgressEstimatedTimeRemainingKey];
+	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
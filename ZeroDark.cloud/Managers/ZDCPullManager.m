@@ -59,6 +59,9 @@
 
 static NSUInteger const kMaxFailCount = 8;
 
+static NSUInteger const kMaxConcurrentChanges = 8;  // quick pull: number of changes processed concurrently
+static NSUInteger const kMaxChangesLookahead  = 64; // quick pull: how far ahead we look for independent changes
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark -
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -69,6 +72,7 @@ static NSUInteger const kMaxFailCount = 8;
 	__weak ZeroDarkCloud *zdc;
 	
 	dispatch_queue_t concurrentQueue;
+	dispatch_queue_t quickPullQueue;
 	
 	ZDCPullStateManager *pullStateManager;
 }
@@ -88,6 +92,7 @@ static NSUInteger const kMaxFailCount = 8;
 		zdc = owner;
 		
 		concurrentQueue = dispatch_queue_create("ZDCPullManager.concurrent", DISPATCH_QUEUE_CONCURRENT);
+		quickPullQueue = dispatch_queue_create("ZDCPullManager.quickPull", DISPATCH_QUEUE_SERIAL);
 		pullStateManager = [[ZDCPullStateManager alloc] init];
 	}
 	return self;
@@ -347,6 +352,14 @@ static NSUInteger const kMaxFailCount = 8;
 		
 		ZDCLogTrace(@"[%@] FinishPull: %@", pullState.localUserID, result);
 		
+		if ([self->pullStateManager isPullCancelled:pullState])
+		{
+			// The pull was aborted, or already finished.
+			// During a quick pull, changes are processed concurrently,
+			// so multiple tasks may fail (and invoke this block).
+			return;
+		}
+		
 		NSAssert(result != nil, @"Bad parameter for block: ZDCPullTaskResult");
 		if (result.pullResult == ZDCPullResult_Success) {
 			NSAssert(transaction != nil, @"Bad parameter for block: transaction is nil (with success status)");
@@ -477,20 +490,16 @@ static NSUInteger const kMaxFailCount = 8;
 		}
 		else
 		{
-			// Process next item in pendingChanges.
+			// Process the items in pendingChanges.
 			//
-			// When this method completes:
+			// When the last of them completes:
 			// - it will invoke continuePull again
 			
-			pullState.hasProcessedChanges = YES;
-			
-			NSOrderedSet<NSString *> *changeIDs = nil;
-			ZDCChangeItem *change = [pullInfo popNextPendingChange:&changeIDs];
+			pullState.changeList = pullInfo;
 			
-			[self processPendingChange: change
-			                 changeIDs: changeIDs
-			                 pullState: pullState
-			           finalCompletion: finalCompletionBlock];
+			[self processPendingChangesWithPullState: pullState
+			                       finishedChangeIDs: nil
+			                         finalCompletion: finalCompletionBlock];
 		}
 	}
 	else
@@ -864,6 +873,127 @@ static NSUInteger const kMaxFailCount = 8;
 	}
 }
 
+/**
+ * Starts processing as many pending changes as possible (up to kMaxConcurrentChanges at a time).
+ *
+ * Changes are scanned in order. A change is started if it doesn't depend on any change before it
+ * that's still pending or active (see `[ZDCPullState startPendingChangesInList:...]`).
+ * Since the ZDCChangeList supports processing changes out-of-order,
+ * the latestChangeID_local only advances as the changes at the front of the list complete.
+ *
+ * This method is invoked after the processing of each change completes.
+ * When there's nothing left to process (and nothing active), we continue the pull.
+ *
+ * @param finishedChangeIDs
+ *   The changes that just completed (if any).
+ *
+ * @param finalCompletionBlock
+ *   The block to invoke after the entire sync process is complete.
+ *   If this method fails, it will invoke the block.
+ *   However, if it succeeds, it will continue on to the next step in the state diagram.
+**/
+- (void)processPendingChangesWithPullState:(ZDCPullState *)pullState
+                         finishedChangeIDs:(nullable NSOrderedSet<NSString *> *)finishedChangeIDs
+                           finalCompletion:(ZDCPullTaskCompletion)finalCompletionBlock
+{
+	// All scheduling decisions are made on a serial queue.
+	// This ensures only one completion can decide that we're done.
+	
+	dispatch_async(quickPullQueue, ^{ @autoreleasepool {
+		
+		if (finishedChangeIDs) {
+			[pullState finishChangeIDs:finishedChangeIDs];
+		}
+		
+		if (pullState.isQuickPullHalted || [self->pullStateManager isPullCancelled:pullState])
+		{
+			return;
+		}
+		
+		// Note: pullState.changeList is updated within the same transaction that processes a change.
+		// So it's never older than the most recent commit.
+		
+		ZDCChangeList *pullInfo = pullState.changeList;
+		
+		NSUInteger activeCount = pullState.activeChangesCount;
+		NSUInteger maxCount = (activeCount < kMaxConcurrentChanges) ? (kMaxConcurrentChanges - activeCount) : 0;
+		
+		NSArray<NSOrderedSet<NSString *> *> *changeIDsList = nil;
+		BOOL hasPendingChange = NO;
+		
+		NSArray<ZDCChangeItem *> *changes =
+		  [pullState startPendingChangesInList: pullInfo
+		                              maxCount: maxCount
+		                             lookahead: kMaxChangesLookahead
+		                             changeIDs: &changeIDsList
+		                      hasPendingChange: &hasPendingChange];
+		
+		if (changes.count > 0)
+		{
+			pullState.hasProcessedChanges = YES;
+			
+			for (NSUInteger i = 0; i < changes.count; i++)
+			{
+				ZDCChangeItem *change = changes[i];
+				NSOrderedSet<NSString *> *changeIDs = changeIDsList[i];
+				
+				dispatch_async(self->concurrentQueue, ^{ @autoreleasepool {
+					
+					[self processPendingChange: change
+					                 changeIDs: changeIDs
+					                 pullState: pullState
+					           finalCompletion: finalCompletionBlock];
+				}});
+			}
+		}
+		else if (pullState.activeChangesCount == 0)
+		{
+			if (hasPendingChange)
+			{
+				// Defensive programming.
+				// With nothing active, the first pending change can always be started.
+				
+				ZDCLogWarn(@"[%@] Unable to schedule pending changes", pullState.localUserID);
+				
+				[self fallbackToFullPullWithPullState: pullState
+				                      finalCompletion: finalCompletionBlock];
+			}
+			else
+			{
+				dispatch_async(self->concurrentQueue, ^{ @autoreleasepool {
+					
+					[self continuePullWithPullInfo: pullInfo
+					                     pullState: pullState
+					               finalCompletion: finalCompletionBlock];
+				}});
+			}
+		}
+	}});
+}
+
+/**
+ * Invoked (within the read-write transaction) after a pending change has been processed successfully.
+ * Updates the ZDCChangeList accordingly.
+**/
+- (ZDCChangeList *)didProcessChangeIDs:(NSOrderedSet<NSString *> *)changeIDs
+                             pullState:(ZDCPullState *)pullState
+                           transaction:(YapDatabaseReadWriteTransaction *)transaction
+{
+	ZDCChangeList *pullInfo =
+	  [transaction objectForKey: pullState.localUserID
+	               inCollection: kZDCCollection_PullState];
+	
+	pullInfo = [pullInfo copy];
+	[pullInfo didProcessChangeIDs:[changeIDs set]];
+	
+	[transaction setObject: pullInfo
+	                forKey: pullState.localUserID
+	          inCollection: kZDCCollection_PullState];
+	
+	pullState.changeList = pullInfo;
+	return pullInfo;
+}
+
 /**
  * @param finalCompletionBlock
  *   The block to invoke after the entire sync process is complete.
@@ -1017,22 +1147,13 @@ static NSUInteger const kMaxFailCount = 8;
 			return;
 		}
 		
-		ZDCChangeList *pullInfo =
-		  [transaction objectForKey: pullState.localUserID
-		               inCollection: kZDCCollection_PullState];
-		
-		pullInfo = [pullInfo copy];
-		[pullInfo didProcessChangeIDs:[changeIDs set]];
-		
-		[transaction setObject: pullInfo
-		                forKey: pullState.localUserID
-		          inCollection: kZDCCollection_PullState];
+		[self didProcessChangeIDs:changeIDs pullState:pullState transaction:transaction];
 		
 		[transaction addCompletionQueue:concurrentQueue completionBlock:^{
 			
-			[self continuePullWithPullInfo: pullInfo
-			                     pullState: pullState
-			               finalCompletion: finalCompletionBlock];
+			[self processPendingChangesWithPullState: pullState
+			                       finishedChangeIDs: changeIDs
+			                         finalCompletion: finalCompletionBlock];
 		}];
 	}};
 	
@@ -1301,22 +1422,13 @@ static NSUInteger const kMaxFailCount = 8;
 				return;
 			}
 	
-			ZDCChangeList *pullInfo =
-			  [transaction objectForKey: pullState.localUserID
-			               inCollection: kZDCCollection_PullState];
-	
-			pullInfo = [pullInfo copy];
-			[pullInfo didProcessChangeIDs:[changeIDs set]];
-	
-			[transaction setObject: pullInfo
-								 forKey: pullState.localUserID
-						 inCollection: kZDCCollection_PullState];
+			[self didProcessChangeIDs:changeIDs pullState:pullState transaction:transaction];
 	
 			[transaction addCompletionQueue:concurrentQueue completionBlock:^{
 	
-				[self continuePullWithPullInfo: pullInfo
-				                     pullState: pullState
-				               finalCompletion: finalCompletionBlock];
+				[self processPendingChangesWithPullState: pullState
+				                       finishedChangeIDs: changeIDs
+				                         finalCompletion: finalCompletionBlock];
 			}];
 		};
 		
@@ -1640,22 +1752,13 @@ static NSUInteger const kMaxFailCount = 8;
 			return;
 		}
 		
-		ZDCChangeList *pullInfo =
-		  [transaction objectForKey: pullState.localUserID
-		               inCollection: kZDCCollection_PullState];
-		
-		pullInfo = [pullInfo copy];
-		[pullInfo didProcessChangeIDs:[changeIDs set]];
-		
-		[transaction setObject: pullInfo
-		                forKey: pullState.localUserID
-		          inCollection: kZDCCollection_PullState];
+		[self didProcessChangeIDs:changeIDs pullState:pullState transaction:transaction];
 		
 		[transaction addCompletionQueue:concurrentQueue completionBlock:^{
 		
-			[self continuePullWithPullInfo: pullInfo
-			                     pullState: pullState
-			               finalCompletion: finalCompletionBlock];
+			[self processPendingChangesWithPullState: pullState
+			                       finishedChangeIDs: changeIDs
+			                         finalCompletion: finalCompletionBlock];
 		}];
 	}};
 	
@@ -1928,22 +2031,13 @@ static NSUInteger const kMaxFailCount = 8;
 		
 		// Done !
 		
-		ZDCChangeList *pullInfo =
-		  [transaction objectForKey: pullState.localUserID
-		               inCollection: kZDCCollection_PullState];
-		
-		pullInfo = [pullInfo copy];
-		[pullInfo didProcessChangeIDs:[changeIDs set]];
-		
-		[transaction setObject: pullInfo
-		                forKey: pullState.localUserID
-		          inCollection: kZDCCollection_PullState];
+		[self didProcessChangeIDs:changeIDs pullState:pullState transaction:transaction];
 		
 		[transaction addCompletionQueue:concurrentQueue completionBlock:^{
 		
-			[self continuePullWithPullInfo: pullInfo
-			                     pullState: pullState
-			               finalCompletion: finalCompletionBlock];
+			[self processPendingChangesWithPullState: pullState
+			                       finishedChangeIDs: changeIDs
+			                         finalCompletion: finalCompletionBlock];
 		}];
 	}];
 }
@@ -2042,18 +2136,9 @@ static NSUInteger const kMaxFailCount = 8;
           finalCompletion:(ZDCPullTaskCompletion)finalCompletionBlock
     transactionCompletion:(dispatch_block_t)transactionCompletionBlock
 {
-	NSString *const localUserID = pullState.localUserID;
-	
-	__block ZDCChangeList *pullInfo = nil;
-	
 	[[self rwConnection] asyncReadWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
 		
-		pullInfo = [transaction objectForKey:localUserID inCollection:kZDCCollection_PullState];
-		
-		pullInfo = [pullInfo copy];
-		[pullInfo didProcessChangeIDs:[changeIDs set]];
-		
-		[transaction setObject:pullInfo forKey:localUserID inCollection:kZDCCollection_PullState];
+		[self didProcessChangeIDs:changeIDs pullState:pullState transaction:transaction];
 		
 		if (transactionCompletionBlock){
 			[transaction addCompletionQueue:concurrentQueue completionBlock:transactionCompletionBlock];
@@ -2061,9 +2146,9 @@ static NSUInteger const kMaxFailCount = 8;
 		
 	} completionQueue:concurrentQueue completionBlock:^{
 		
-		[self continuePullWithPullInfo: pullInfo
-		                     pullState: pullState
-		               finalCompletion: finalCompletionBlock];
+		[self processPendingChangesWithPullState: pullState
+		                       finishedChangeIDs: changeIDs
+		                         finalCompletion: finalCompletionBlock];
 	}];
 }
 
@@ -2081,6 +2166,9 @@ static NSUInteger const kMaxFailCount = 8;
 	NSString *const localUserID = pullState.localUserID;
 	ZDCLogTrace(@"[%@] FallbackToFullPull", localUserID);
 	
+	// Any changes still being processed (concurrently) must not continue the quick pull.
+	pullState.isQuickPullHalted = YES;
+	
 	[[self rwConnection] asyncReadWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
 		
 		[transaction removeObjectForKey:localUserID inCollection:kZDCCollection_PullState];
@@ -5320,16 +5408,17 @@ static NSUInteger const kMaxFailCount = 8;
 **/
 - (void)fetchUnknownUsers:(ZDCPullState *)pullState
 {
-	for (NSString *remoteUserID in pullState.unknownUserIDs)
+	NSArray<NSString *> *unknownUserIDs = [pullState.unknownUserIDs allObjects];
+	if (unknownUserIDs.count == 0) return;
+	
+	[zdc.userManager fetchUsersWithIDs: unknownUserIDs
+	                       requesterID: pullState.localUserID
+	                   completionQueue: concurrentQueue
+	                   completionBlock:^(NSDictionary<NSString*, ZDCUser*> *remoteUsers,
+	                                     NSDictionary<NSString*, NSError*> *errors)
 	{
-		[zdc.userManager fetchUserWithID: remoteUserID
-		                     requesterID: pullState.localUserID
-		                 completionQueue: concurrentQueue
-		                 completionBlock:^(ZDCUser *remoteUser, NSError *error)
-		{
-			// Ignore...
-		}];
-	}
+		// Ignore...
+	}];
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -15,17 +15,21 @@
 #import "S3Request.h"
 #import "S3ResponseParser.h"
 #import "ZDCCloudOperationPrivate.h"
+#import "ZDCCloudDataManifest.h"
 #import "ZDCCloudNodeManager.h"
 #import "ZDCConstantsPrivate.h"
 #import "ZDCDatabaseManagerPrivate.h"
 #import "ZDCLogging.h"
 #import "ZDCNodePrivate.h"
 #import "ZDCDataPromisePrivate.h"
+#import "ZDCInFlightRegistry.h"
 #import "ZDCMultipollContext.h"
 #import "ZDCPollContext.h"
+#import "ZDCPollGroupContext.h"
 #import "ZDCChangeList.h"
 #import "ZDCTaskContext.h"
 #import "ZDCTouchContext.h"
+#import "ZDCUploadFilePool.h"
 #import "ZeroDarkCloudPrivate.h"
 
 // Categories
@@ -73,6 +77,22 @@ static NSString *const key_tasks_initiate = @"initiate";
 static NSString *const key_tasks_complete = @"complete";
 static NSString *const key_tasks_abort    = @"abort";
 
+// Polls are consolidated into multipoll requests (one per localUserID/region per tick).
+// This is the max number of requestIDs we'll put into a single request.
+static const NSUInteger multipoll_maxRequestIDs = 1000;
+
+// Small uploads (rcrd files, small node data, etc) are written to pooled temp files.
+// This is the max number of idle temp files kept around for reuse.
+static const NSUInteger kMaxIdleUploadFiles = 32;
+
+// If one of those temp files can't be written (e.g. the disk is full),
+// the operation is handed back to the pipeline, and retried after this delay (in seconds).
+static const NSTimeInterval kUploadFileRetryDelay = 30.0;
+
+// Node data (provided in-memory by the delegate) at or below this size is encrypted in-memory (on iOS),
+// and then written to a pooled temp file, instead of encrypting straight to a new file.
+static const NSUInteger kMaxInMemoryEncryptSize = (1024 * 512);
+
 typedef NS_ENUM(NSInteger, ZDCErrCode) {
 	ZDCErrCode_unknown_user_owner                        = 10000,
 	ZDCErrCode_unknown_user_caller                       = 10001,
@@ -119,19 +139,23 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 	dispatch_queue_t serialQueue;
 	dispatch_queue_t concurrentQueue;
 	
+	// Reusable temp files for small uploads (iOS background sessions only support file upload tasks).
+	// ZDCUploadFilePool is thread-safe.
+	//
+	ZDCUploadFilePool *uploadFilePool;
+	
 	// Tracks all in-flight tasks:
-	// - key   : YapCollectionKey(localUserID, treeID)
-	// - value : list of associated in-flight context objects
+	// - key   : (ZDCCloudOperation.uuid, requestID)
+	// - value : set of associated in-flight context objects
 	//
 	// The in-flight tasks could be any valid task type:
 	// - ZDCTaskContext
 	// - ZDCPollContext
 	// - ZDCTouchContext
 	//
-	// NSMutableDictionary is NOT thread-safe,
-	// and must only be accessed from within the `serialQueue`.
+	// ZDCInFlightRegistry is thread-safe (and doesn't require the `serialQueue`).
 	//
-	NSMutableDictionary<YapCollectionKey*, NSMutableArray<id>*> *inFlightContexts;
+	ZDCInFlightRegistry<id> *inFlightContexts;
 	
 	// Tracks multipart tasks:
 	// - key   : ZDCOperation.uuid
@@ -157,6 +181,19 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 	// and must only be accessed from within the `serialQueue`.
 	//
 	NSMutableSet<NSUUID *> *recentlySkipped;
+	
+	// Tracks poll contexts waiting for the next multipoll tick:
+	// - key   : YapCollectionKey(localUserID, region)
+	// - value : list of pending poll contexts (ZDCPollContext or ZDCMultipollContext)
+	//
+	// And the number of poll contexts currently in-flight (per same key).
+	// This is used to adapt the tick rate.
+	//
+	// NSMutableDictionary is NOT thread-safe,
+	// and must only be accessed from within the `serialQueue`.
+	//
+	NSMutableDictionary<YapCollectionKey*, NSMutableArray<ZDCPollContext*>*> *pendingPolls;
+	NSMutableDictionary<YapCollectionKey*, NSNumber*> *inFlightPollCounts;
 }
 
 #pragma clang diagnostic push
@@ -176,6 +213,11 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 		serialQueue     = dispatch_queue_create("ZDCPushManager.serial", DISPATCH_QUEUE_SERIAL);
 		concurrentQueue = dispatch_queue_create("ZDCPushManager.concurrent", DISPATCH_QUEUE_CONCURRENT);
 		
+		inFlightContexts = [[ZDCInFlightRegistry alloc] init];
+		
+		uploadFilePool = [[ZDCUploadFilePool alloc] initWithDirectoryURL: [ZDCDirectoryManager tempDirectoryURL]
+		                                                    maxIdleFiles: kMaxIdleUploadFiles];
+		
 		[[NSNotificationCenter defaultCenter] addObserver: self
 		                                         selector: @selector(didSkipOperations:)
 		                                             name: ZDCSkippedOperationsNotification
@@ -509,101 +551,105 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 	return (ZDCCloudOperation *)[[self pipelineForContext:context] operationWithUUID:context.operationUUID];
 }
 
-- (void)stashContext:(id)context
+#if TARGET_OS_IPHONE
+
+/**
+ * Writes the (small) upload data to a pooled temp file,
+ * and configures the context to upload from it.
+ *
+ * Returns NO if the file couldn't be written (e.g. the disk is full).
+ * In which case the operation has already been handed back to the pipeline (after a delay).
+ */
+- (BOOL)writeUploadData:(NSData *)data forContext:(ZDCTaskContext *)context
 {
-	NSParameterAssert(context != nil);
+	NSString *sha256Hash = nil;
+	NSError *error = nil;
+	NSURL *fileURL = [uploadFilePool writeData:data sha256Hash:&sha256Hash error:&error];
 	
-	NSString *localUserID = nil;
-	NSString *treeID = nil;
+	if (fileURL == nil)
+	{
+		ZDCLogError(@"Error writing upload file for operation (%@): %@", context.operationUUID, error);
+		
+		[self retryOperationWithContext:context delay:kUploadFileRetryDelay];
+		return NO;
+	}
 	
+	context.sha256Hash = sha256Hash;
+	context.uploadFileURL = fileURL;
+	context.deleteUploadFileURL = YES;
+	return YES;
+}
+
+#endif
+
+/**
+ * Returns the underlying ZDCTaskContext for any valid in-flight context type.
+ */
+- (ZDCTaskContext *)taskContextForInFlightContext:(id)context
+{
 	if ([context isKindOfClass:[ZDCTaskContext class]])
 	{
-		ZDCTaskContext *ctx = (ZDCTaskContext *)context;
-		
-		localUserID = ctx.localUserID;
-		treeID      = ctx.treeID;
+		return (ZDCTaskContext *)context;
 	}
 	else if ([context isKindOfClass:[ZDCPollContext class]])
 	{
-		ZDCTaskContext *ctx = [(ZDCPollContext *)context taskContext];
-		
-		localUserID = ctx.localUserID;
-		treeID      = ctx.treeID;
+		return [(ZDCPollContext *)context taskContext];
 	}
 	else if ([context isKindOfClass:[ZDCTouchContext class]])
 	{
-		ZDCTaskContext *ctx = [[(ZDCTouchContext *)context pollContext] taskContext];
-		
-		localUserID = ctx.localUserID;
-		treeID      = ctx.treeID;
+		return [[(ZDCTouchContext *)context pollContext] taskContext];
 	}
 	
-	NSAssert(localUserID != nil, @"Invalid context");
-	NSAssert(treeID      != nil, @"Invalid context");
+	return nil;
+}
+
+/**
+ * Registers the in-flight context under the (operationUUID, requestID) of its request.
+ * The requestID is recorded in the task context, so the matching entry can be removed upon completion.
+ */
+- (void)stashContext:(id)context requestID:(NSString *)requestID
+{
+	NSParameterAssert(context != nil);
+	NSParameterAssert(requestID != nil);
 	
-	YapCollectionKey *tuple = YapCollectionKeyCreate(localUserID, treeID);
+	ZDCTaskContext *taskContext = [self taskContextForInFlightContext:context];
+	NSUUID *operationUUID = taskContext.operationUUID;
 	
-	dispatch_sync(serialQueue, ^{ @autoreleasepool {
-		
-		if (inFlightContexts == nil) {
-			inFlightContexts = [[NSMutableDictionary alloc] init];
-		}
-		
-		NSMutableArray<id> *inFlightArray = inFlightContexts[tuple];
-		if (inFlightArray == nil) {
-			inFlightArray = inFlightContexts[tuple] = [[NSMutableArray alloc] init];
-		}
-		
-		[inFlightArray addObject:context];
-	}});
+	NSAssert(operationUUID != nil, @"Invalid context");
+	if (operationUUID == nil) return;
+	
+	taskContext.requestID = requestID;
+	[inFlightContexts addObject:context forOperationUUID:operationUUID requestID:requestID];
 }
 
 - (void)unstashContext:(id)context
 {
 	NSParameterAssert(context != nil);
 	
-	NSString *localUserID = nil;
-	NSString *treeID = nil;
+	ZDCTaskContext *taskContext = [self taskContextForInFlightContext:context];
+	NSUUID *operationUUID = taskContext.operationUUID;
 	
-	if ([context isKindOfClass:[ZDCTaskContext class]])
-	{
-		ZDCTaskContext *ctx = (ZDCTaskContext *)context;
-		
-		localUserID = ctx.localUserID;
-		treeID      = ctx.treeID;
-	}
-	else if ([context isKindOfClass:[ZDCPollContext class]])
-	{
-		ZDCTaskContext *ctx = [(ZDCPollContext *)context taskContext];
-		
-		localUserID = ctx.localUserID;
-		treeID      = ctx.treeID;
-	}
-	else if ([context isKindOfClass:[ZDCTouchContext class]])
-	{
-		ZDCTaskContext *ctx = [[(ZDCTouchContext *)context pollContext] taskContext];
-		
-		localUserID = ctx.localUserID;
-		treeID      = ctx.treeID;
-	}
+	NSAssert(operationUUID != nil, @"Invalid context");
+	if (operationUUID == nil) return;
 	
-	NSAssert(localUserID != nil, @"Invalid context");
-	NSAssert(treeID      != nil, @"Invalid context");
+	// Note: The requestID is nil if the context was restored from a task that was started
+	// by a previous version of the framework (prior to recording it), in which case we check every request.
 	
-	YapCollectionKey *tuple = YapCollectionKeyCreate(localUserID, treeID);
+	[inFlightContexts removeObject:context forOperationUUID:operationUUID requestID:taskContext.requestID];
+}
 	
-	dispatch_sync(serialQueue, ^{ @autoreleasepool {
-		
-		if (inFlightContexts == nil) {
-			inFlightContexts = [[NSMutableDictionary alloc] init];
-		}
-		
-		NSMutableArray<id> *inFlightArray = inFlightContexts[tuple];
-		if (inFlightArray)
+/**
+ * Cancels the progress of every in-flight context associated with the given operations.
+ */
+- (void)cancelInFlightContextsForOperationUUIDs:(NSSet<NSUUID *> *)opUUIDs
+{
+	for (NSUUID *opUUID in opUUIDs)
+	{
+		for (id ctx in [inFlightContexts objectsForOperationUUID:opUUID])
 		{
-			[inFlightArray removeObjectIdenticalTo:context];
+			[[self taskContextForInFlightContext:ctx].progress cancel];
 		}
-	}});
+	}
 }
 
 - (void)incrementSuspendCountForLocalUserID:(NSString *)localUserID treeID:(NSString *)treeID
@@ -762,8 +808,6 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 	if (localUserID == nil) return;
 	if (treeID == nil) return;
 	
-	YapCollectionKey *tuple = YapCollectionKeyCreate(localUserID, treeID);
-	
 	ZDCCloud *ext = [zdc.databaseManager cloudExtForUserID:localUserID treeID:treeID];
 	YapDatabaseCloudCorePipeline *pipeline = [ext defaultPipeline];
 	NSArray<ZDCCloudOperation *> *operations = (NSArray<ZDCCloudOperation *> *)[pipeline activeOperations];
@@ -776,10 +820,10 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 	//
 	// When cancelling operations:
 	// 1. Set `abortRequested` flag
-	// 2. Within serialQueue, find matching context's, and invoke [context.progress cancel]
+	// 2. Within inFlightContexts, find matching context's, and invoke [context.progress cancel]
 	//
 	// When checking to see if an operation has been cancelled:
-	// 1. Within serialQueue, add context (with non-nil context.progress)
+	// 1. Within inFlightContexts, add context (with non-nil context.progress)
 	// 2. Check `abortRequested` flag
 	
 	NSMutableSet<NSUUID*> *opUUIDsToAbort = [NSMutableSet setWithCapacity:operations.count];
@@ -790,32 +834,7 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 		[opUUIDsToAbort addObject:op.uuid];
 	}
 	
-	dispatch_sync(serialQueue, ^{ @autoreleasepool {
-		
-		NSArray<id> *inFlightArray = inFlightContexts[tuple];
-		for (id ctx in inFlightArray)
-		{
-			ZDCTaskContext *context = nil;
-			
-			if ([ctx isKindOfClass:[ZDCTaskContext class]])
-			{
-				context = (ZDCTaskContext *)ctx;
-			}
-			else if ([ctx isKindOfClass:[ZDCPollContext class]])
-			{
-				context = ((ZDCPollContext *)ctx).taskContext;
-			}
-			else if ([ctx isKindOfClass:[ZDCTouchContext class]])
-			{
-				context = ((ZDCTouchContext *)ctx).pollContext.taskContext;
-			}
-			
-			if ([opUUIDsToAbort containsObject:context.operationUUID])
-			{
-				[context.progress cancel];
-			}
-		}
-	}});
+	[self cancelInFlightContextsForOperationUUIDs:opUUIDsToAbort];
 }
 
 /**
@@ -833,10 +852,10 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 	//
 	// When cancelling operations:
 	// 1. Set `abortRequested` flag
-	// 2. Within serialQueue, find matching context's, and invoke [context.progress cancel]
+	// 2. Within inFlightContexts, find matching context's, and invoke [context.progress cancel]
 	//
 	// When checking to see if an operation has been cancelled:
-	// 1. Within serialQueue, add context (with non-nil context.progress)
+	// 1. Within inFlightContexts, add context (with non-nil context.progress)
 	// 2. Check `abortRequested` flag
 	
 	NSMutableSet<NSUUID*> *opUUIDsToAbort = [NSMutableSet setWithCapacity:operations.count];
@@ -847,35 +866,7 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 		[opUUIDsToAbort addObject:op.uuid];
 	}
 	
-	dispatch_sync(serialQueue, ^{ @autoreleasepool {
-		
-		for (YapCollectionKey *tuple in inFlightContexts)
-		{
-			NSArray<id> *inFlightArray = inFlightContexts[tuple];
-			for (id ctx in inFlightArray)
-			{
-				ZDCTaskContext *context = nil;
-				
-				if ([ctx isKindOfClass:[ZDCTaskContext class]])
-				{
-					context = (ZDCTaskContext *)ctx;
-				}
-				else if ([ctx isKindOfClass:[ZDCPollContext class]])
-				{
-					context = ((ZDCPollContext *)ctx).taskContext;
-				}
-				else if ([ctx isKindOfClass:[ZDCTouchContext class]])
-				{
-					context = ((ZDCTouchContext *)ctx).pollContext.taskContext;
-				}
-				
-				if ([opUUIDsToAbort containsObject:context.operationUUID])
-				{
-					[context.progress cancel];
-				}
-			}
-		}
-	}});
+	[self cancelInFlightContextsForOperationUUIDs:opUUIDsToAbort];
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1107,6 +1098,16 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 		              context: context
 		       responseObject: responseObject];
 	}
+	else if ([inContext isKindOfClass:[ZDCPollGroupContext class]])
+	{
+		ZDCPollGroupContext *context = (ZDCPollGroupContext *)inContext;
+		
+		[self pollGroupDidComplete: task
+		                 inSession: session
+		                 withError: error
+		                   context: context
+		            responseObject: responseObject];
+	}
 	else if ([inContext isKindOfClass:[ZDCTaskContext class]])
 	{
 		ZDCTaskContext *context = (ZDCTaskContext *)inContext;
@@ -1356,34 +1357,21 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 			return;
 		}
 		
-		context.sha256Hash = [AWSPayload signatureForPayload:fileData];
-			
 	#if TARGET_OS_IPHONE
 			
 		// Background NSURLSession's don't support data tasks !
 		//
-		// So we write the data to a temporary location on disk, in order to use a file task.
-		
-		NSString *fileName = [operation.uuid UUIDString];
+		// So we write the data to a (pooled) temporary file on disk, in order to use a file task.
+		// The SHA-256 is calculated while writing.
 		
-		NSURL *tempDir = [ZDCDirectoryManager tempDirectoryURL];
-		NSURL *tempFileURL = [tempDir URLByAppendingPathComponent:fileName isDirectory:NO];
-		
-		NSError *error = nil;
-		[fileData writeToURL:tempFileURL options:0 error:&error];
-		
-		if (error)
+		if ([self writeUploadData:fileData forContext:context])
 		{
-			ZDCLogError(@"Error writing operation.data (%@): %@", tempFileURL.path, error);
+			[self startPutOperation:operation withContext:context];
 		}
 		
-		context.uploadFileURL = tempFileURL;
-		context.deleteUploadFileURL = YES;
-		
-		[self startPutOperation:operation withContext:context];
-		
 	#else // macOS
 			
+		context.sha256Hash = [AWSPayload signatureForPayload:fileData];
 		context.uploadData = fileData;
 		
 		[self startPutOperation:operation withContext:context];
@@ -1727,9 +1715,37 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 		{
 			// The delegate gave us raw data (not encrypted).
 			// We need to encrypt it by storing it in a CloudFile.
+			//
+			// Since this is a single (non-multipart) upload of in-memory data,
+			// the data section may be compressed (if enabled via ZDCConfig.cloudFileCompression).
+			
+			const ZDCCloudFileCompression compression = zdc.cloudFileCompression;
 			
 		#if TARGET_OS_IPHONE
 			
+			if (data.data.length <= kMaxInMemoryEncryptSize)
+			{
+				// Small data: encrypt in-memory.
+				// The result is written to a pooled temp file (and hashed) in a single pass.
+				
+				NSError *error = nil;
+				NSData *cryptoData =
+				  [ZDCFileConversion encryptCleartextData: data.data
+				                       toCloudFileWithKey: node.encryptionKey
+				                                 metadata: rawMetadata
+				                                thumbnail: rawThumbnail
+				                              compression: compression
+				                                    error: &error];
+				
+				if (error) {
+					[self skipOperationWithContext:context];
+				}
+				else {
+					continueWithFileData(cryptoData);
+				}
+				return;
+			}
+			
 			// iOS is going to ultimately force us to write the data to disk.
 			// So we might as well do so here.
 			
@@ -1737,6 +1753,7 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 			                     toCloudFileWithKey: node.encryptionKey
 			                               metadata: rawMetadata
 			                              thumbnail: rawThumbnail
+			                            compression: compression
 			                        completionQueue: concurrentQueue
 			                        completionBlock:^(ZDCCryptoFile *cryptoFile, NSError *error)
 			{
@@ -1759,6 +1776,7 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 			                       toCloudFileWithKey: node.encryptionKey
 			                                 metadata: rawMetadata
 			                                thumbnail: rawThumbnail
+			                              compression: compression
 			                                    error: &error];
 			
 			if (error) {
@@ -2046,7 +2064,7 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 			[zdc.progressManager setUploadProgress:progress forOperation:operation];
 		}
 		
-		[self stashContext:context];
+		[self stashContext:context requestID:requestID];
 		[zdc.networkTools addRecentRequestID:requestID forUser:context.localUserID];
 		
 		if (operation.ephemeralInfo.abortRequested)
@@ -2082,7 +2100,7 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 #if TARGET_OS_IPHONE
 	if (context.uploadFileURL && context.deleteUploadFileURL)
 	{
-		[[NSFileManager defaultManager] removeItemAtURL:context.uploadFileURL error:nil];
+		[uploadFilePool recycleFileURL:context.uploadFileURL];
 	}
 #endif
 	
@@ -2491,6 +2509,29 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 			
 			[transaction setObject:node forKey:node.uuid inCollection:kZDCCollection_Nodes];
 			
+			if (operation.putType == ZDCCloudOperationPutType_Node_Data)
+			{
+				// Remember the layout of the cloud file we just uploaded,
+				// so the next multipart upload of this node can skip the parts that don't change.
+				
+				ZDCCloudOperation_MultipartInfo *multipartInfo = operation.multipartInfo;
+				if (multipartInfo && eTag)
+				{
+					ZDCCloudDataManifest *manifest =
+					  [[ZDCCloudDataManifest alloc] initWithNodeID: node.uuid
+					                                          eTag: eTag
+					                                 cloudFileSize: multipartInfo.cloudFileSize
+					                                     chunkSize: multipartInfo.chunkSize
+					                                     checksums: multipartInfo.checksums];
+					
+					[transaction setObject:manifest forKey:node.uuid inCollection:kZDCCollection_CloudDataManifests];
+				}
+				else
+				{
+					[transaction removeObjectForKey:node.uuid inCollection:kZDCCollection_CloudDataManifests];
+				}
+			}
+			
 			if (node.isPointer && operation.putType == ZDCCloudOperationPutType_Node_Rcrd)
 			{
 				needsTriggerPull = YES;
@@ -2665,6 +2706,15 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 			break;
 		}
 		
+		if ([operation.multipartInfo.copyParts containsIndex:context.multipart_index])
+		{
+			// This part is unchanged since the last upload.
+			// It gets copied server-side from the existing cloud file, so there's nothing to read or hash locally.
+			
+			[self startMultipartOperation:operation withContext:context];
+			continue;
+		}
+		
 		ZDCData *nodeData = operation.ephemeralInfo.multipartData;
 		
 		uint64_t offset_min = context.multipart_index * operation.multipartInfo.chunkSize;
@@ -2781,6 +2831,9 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 	else if (context.multipart_abort) {
 		[self startMultipartAbort:operation withContext:context];
 	}
+	else if ([operation.multipartInfo.copyParts containsIndex:context.multipart_index]) {
+		[self startMultipartCopy:operation withContext:context];
+	}
 	else {
 		[self startMultipartIndex:operation withContext:context];
 	}
@@ -2872,7 +2925,7 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 		context.progress = [session uploadProgressForTask:task];
 		[self refreshProgressForMultipartOperation:operation];
 	
-		[self stashContext:context];
+		[self stashContext:context requestID:[self requestIDForOperation:operation]];
 		
 		if (operation.ephemeralInfo.abortRequested)
 		{
@@ -3017,7 +3070,7 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 		context.progress = [session uploadProgressForTask:task];
 		[self refreshProgressForMultipartOperation:operation];
 		
-		[self stashContext:context];
+		[self stashContext:context requestID:[self requestIDForOperation:operation]];
 		
 		if (operation.ephemeralInfo.abortRequested)
 		{
@@ -3036,12 +3089,19 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 	}];
 }
 
-- (void)startMultipartComplete:(ZDCCloudOperation *)operation withContext:(ZDCTaskContext *)context
+/**
+ * Handles a part that's unchanged since the previous upload of the node's data.
+ * The part is copied server-side (S3 UploadPartCopy) from the existing cloud file.
+ *
+ * The copy is conditional on the existing cloud file's eTag.
+ * If the file has since been changed (or moved/deleted), S3 rejects the copy,
+ * and we fall back to uploading the part normally. (See multipartTaskDidComplete.)
+ */
+- (void)startMultipartCopy:(ZDCCloudOperation *)operation withContext:(ZDCTaskContext *)context
 {
 	ZDCLogAutoTrace();
 	NSAssert(operation.type == ZDCCloudOperationType_Put, @"Invalid operation type");
 	NSAssert(operation.multipartInfo, @"Invalid operation type");
-	NSAssert(context.multipart_complete, @"Invalid context type");
 	
 	[zdc.awsCredentialsManager getAWSCredentialsForUser: context.localUserID
 	                                    completionQueue: concurrentQueue
@@ -3065,82 +3125,77 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 		}
 		
 		ZDCSessionInfo *sessionInfo = [zdc.sessionManager sessionInfoForUserID:context.localUserID];
-		
+	
 	#if TARGET_OS_IPHONE
 		AFURLSessionManager *session = sessionInfo.backgroundSession;
 	#else
 		AFURLSessionManager *session = sessionInfo.session;
 	#endif
 		
-		NSUInteger capacity = operation.multipartInfo.eTags.count;
-		NSMutableArray<NSString *> *eTags = [NSMutableArray arrayWithCapacity:capacity];
+		ZDCCloudOperation_MultipartInfo *multipartInfo = operation.multipartInfo;
 		
-		NSArray<NSNumber *> *orderedKeys =
-		  [[operation.multipartInfo.eTags allKeys] sortedArrayUsingSelector:@selector(compare:)];
-		for (NSNumber *key in orderedKeys)
-		{
-			NSString *eTag = operation.multipartInfo.eTags[key];
-			[eTags addObject:eTag];
-		}
+		// We use zero based indexing.
+		// AWS uses one based indexing.
+		//
+		NSUInteger aws_part = context.multipart_index + 1;
 		
-		// We don't directly hit S3.
-		// Instead we go through our own server, in order to avoid pitfalls with S3.
+		uint64_t offset = context.multipart_index * multipartInfo.chunkSize;
+		uint64_t length = MIN(multipartInfo.chunkSize, (multipartInfo.cloudFileSize - offset));
 		
+		NSURLComponents *urlComponents = nil;
 		NSMutableURLRequest *request =
-		  [zdc.restManager multipartComplete: operation.multipartInfo.stagingPath
-		                        withUploadID: operation.multipartInfo.uploadID
-		                               eTags: eTags
-		                            inBucket: operation.cloudLocator.bucket
-		                              region: operation.cloudLocator.region
-		                      forLocalUserID: operation.localUserID
-		                            withAuth: auth];
+		  [S3Request multipartCopy: multipartInfo.stagingPath
+		              withUploadID: multipartInfo.uploadID
+		                      part: aws_part
+		                fromSource: operation.cloudLocator.cloudPath.path
+		                     range: NSMakeRange((NSUInteger)offset, (NSUInteger)length)
+		                   ifMatch: multipartInfo.copySourceETag
+		                  inBucket: operation.cloudLocator.bucket
+		                    region: operation.cloudLocator.region
+		          outUrlComponents: &urlComponents];
 		
-		NSURLSessionTask *task = nil;
+		[AWSSignature signRequest: request
+		               withRegion: operation.cloudLocator.region
+		                  service: AWSService_S3
+		              accessKeyID: auth.aws_accessKeyID
+		                   secret: auth.aws_secret
+		                  session: auth.aws_session];
+		
+		// For multipart copy tasks, the eTag for the part is in the response XML (not the response headers).
+	
 	#if TARGET_OS_IPHONE
 		
-		// Background NSURLSession's do NOT support dataTask's.
+		// Background NSURLSession's don't really support data tasks.
 		//
-		// So we write the data to a temporary location on disk, in order to use a file task.
-		
-		NSString *fileName = [[NSUUID UUID] UUIDString];
-		
-		NSURL *tempDir = [ZDCDirectoryManager tempDirectoryURL];
-		NSURL *tempFileURL = [tempDir URLByAppendingPathComponent:fileName isDirectory:NO];
-		
-		NSError *writeError = nil;
-		[request.HTTPBody writeToURL:tempFileURL options:0 error:&writeError];
-		
-		if (writeError)
-		{
-			ZDCLogError(@"Error writing operation.data (%@): %@", tempFileURL.path, writeError);
-		}
-		
-		request.HTTPBody = nil;
-		
-		context.uploadFileURL = tempFileURL;
-		context.deleteUploadFileURL = YES;
-		
-		task = [session uploadTaskWithRequest: request
-		                             fromFile: context.uploadFileURL
-		                             progress: nil
-		                    completionHandler: nil];
+		// So we have to download the tiny response to a file instead.
 		
-	#else
+		NSURLSessionDownloadTask *task =
+		  [session downloadTaskWithRequest: request
+		                          progress: nil
+		                       destination: nil
+		                 completionHandler: nil];
 	
+	#else
+		
+		__block NSURLSessionDataTask *task = nil;
 		task = [session dataTaskWithRequest: request
 		                     uploadProgress: nil
 		                   downloadProgress: nil
-		                  completionHandler: nil];
+		                  completionHandler:^(NSURLResponse *response, id responseObject, NSError *error)
+		{
+			[self multipartTaskDidComplete: task
+			                     inSession: session.session
+			                     withError: error
+			                       context: context
+			                responseObject: responseObject];
+		}];
 	
 	#endif
 		
 		context.progress = [session uploadProgressForTask:task];
 		[self refreshProgressForMultipartOperation:operation];
 		
-		NSString *requestID = [self requestIDForOperation:operation];
-		
-		[self stashContext:context];
-		[zdc.networkTools addRecentRequestID:requestID forUser:context.localUserID];
+		[self stashContext:context requestID:[self requestIDForOperation:operation]];
 		
 		if (operation.ephemeralInfo.abortRequested)
 		{
@@ -3153,18 +3208,25 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 		}
 		else
 		{
+		#if TARGET_OS_IPHONE
 			[zdc.sessionManager associateContext:context withTask:task inSession:session.session];
+		#else
+			// When SessionManager gets called for the completion of a dataTask,
+			// it's not given the `responseObject`, which we need in this case.
+			// So we're handling the completion manually.
+		#endif
+			
 			[task resume];
 		}
 	}];
 }
 
-- (void)startMultipartAbort:(ZDCCloudOperation *)operation withContext:(ZDCTaskContext *)context
+- (void)startMultipartComplete:(ZDCCloudOperation *)operation withContext:(ZDCTaskContext *)context
 {
 	ZDCLogAutoTrace();
 	NSAssert(operation.type == ZDCCloudOperationType_Put, @"Invalid operation type");
 	NSAssert(operation.multipartInfo, @"Invalid operation type");
-	NSAssert(context.multipart_abort, @"Invalid context type");
+	NSAssert(context.multipart_complete, @"Invalid context type");
 	
 	[zdc.awsCredentialsManager getAWSCredentialsForUser: context.localUserID
 	                                    completionQueue: concurrentQueue
@@ -3195,13 +3257,135 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 		AFURLSessionManager *session = sessionInfo.session;
 	#endif
 		
-		NSURLComponents *urlComponents = nil;
-		NSMutableURLRequest *request =
-		  [S3Request multipartAbort: operation.multipartInfo.stagingPath
-		               withUploadID: operation.multipartInfo.uploadID
-		                   inBucket: operation.cloudLocator.bucket
-		                     region: operation.cloudLocator.region
-		           outUrlComponents: &urlComponents];
+		NSUInteger capacity = operation.multipartInfo.eTags.count;
+		NSMutableArray<NSString *> *eTags = [NSMutableArray arrayWithCapacity:capacity];
+		
+		NSArray<NSNumber *> *orderedKeys =
+		  [[operation.multipartInfo.eTags allKeys] sortedArrayUsingSelector:@selector(compare:)];
+		for (NSNumber *key in orderedKeys)
+		{
+			NSString *eTag = operation.multipartInfo.eTags[key];
+			[eTags addObject:eTag];
+		}
+		
+		// We don't directly hit S3.
+		// Instead we go through our own server, in order to avoid pitfalls with S3.
+		
+		NSMutableURLRequest *request =
+		  [zdc.restManager multipartComplete: operation.multipartInfo.stagingPath
+		                        withUploadID: operation.multipartInfo.uploadID
+		                               eTags: eTags
+		                            inBucket: operation.cloudLocator.bucket
+		                              region: operation.cloudLocator.region
+		                      forLocalUserID: operation.localUserID
+		                            withAuth: auth];
+		
+		NSURLSessionTask *task = nil;
+	#if TARGET_OS_IPHONE
+		
+		// Background NSURLSession's do NOT support dataTask's.
+		//
+		// So we write the data to a temporary location on disk, in order to use a file task.
+		
+		NSError *writeError = nil;
+		NSURL *tempFileURL = [uploadFilePool writeData:request.HTTPBody sha256Hash:nil error:&writeError];
+		
+		if (tempFileURL == nil)
+		{
+			ZDCLogError(@"Error writing multipart-complete file (%@): %@", context.operationUUID, writeError);
+			
+			// Handled like any other client-side error (i.e. the operation is retried after a delay).
+			[self multipartTaskDidComplete:nil inSession:nil withError:writeError context:context responseObject:nil];
+			return;
+		}
+		
+		request.HTTPBody = nil;
+		
+		context.uploadFileURL = tempFileURL;
+		context.deleteUploadFileURL = YES;
+		
+		task = [session uploadTaskWithRequest: request
+		                             fromFile: context.uploadFileURL
+		                             progress: nil
+		                    completionHandler: nil];
+	
+	#else
+	
+		task = [session dataTaskWithRequest: request
+		                     uploadProgress: nil
+		                   downloadProgress: nil
+		                  completionHandler: nil];
+	
+	#endif
+		
+		context.progress = [session uploadProgressForTask:task];
+		[self refreshProgressForMultipartOperation:operation];
+		
+		NSString *requestID = [self requestIDForOperation:operation];
+		
+		[self stashContext:context requestID:requestID];
+		[zdc.networkTools addRecentRequestID:requestID forUser:context.localUserID];
+		
+		if (operation.ephemeralInfo.abortRequested)
+		{
+			operation.ephemeralInfo.abortRequested = NO;
+			[self multipartTaskDidComplete: task
+			                     inSession: session.session
+			                     withError: [self cancelledError]
+			                       context: context
+			                responseObject: nil];
+		}
+		else
+		{
+			[zdc.sessionManager associateContext:context withTask:task inSession:session.session];
+			[task resume];
+		}
+	}];
+}
+
+- (void)startMultipartAbort:(ZDCCloudOperation *)operation withContext:(ZDCTaskContext *)context
+{
+	ZDCLogAutoTrace();
+	NSAssert(operation.type == ZDCCloudOperationType_Put, @"Invalid operation type");
+	NSAssert(operation.multipartInfo, @"Invalid operation type");
+	NSAssert(context.multipart_abort, @"Invalid context type");
+	
+	[zdc.awsCredentialsManager getAWSCredentialsForUser: context.localUserID
+	                                    completionQueue: concurrentQueue
+	                                    completionBlock:^(ZDCLocalUserAuth *auth, NSError *error)
+	{
+		if (error)
+		{
+			if ([error.auth0API_error isEqualToString:kAuth0Error_RateLimit])
+			{
+				// Auth0 is just rate limiting us.
+				// Normal path will automatically execute exponential backoff.
+			}
+			else
+			{
+				// Auth0 is indicating our account may have been removed.
+				[zdc.networkTools handleAuthFailureForUser:context.localUserID withError:error];
+			}
+			
+			[self multipartTaskDidComplete:nil inSession:nil withError:error context:context responseObject:nil];
+			return;
+		}
+		
+		ZDCSessionInfo *sessionInfo = [zdc.sessionManager sessionInfoForUserID:context.localUserID];
+		
+	#if TARGET_OS_IPHONE
+		AFURLSessionManager *session = sessionInfo.backgroundSession;
+	#else
+		AFURLSessionManager *session = sessionInfo.session;
+	#endif
+		
+		NSURLComponents *urlComponents = nil;
+		NSMutableURLRequest *request =
+		  [S3Request multipartAbort: operation.multipartInfo.stagingPath
+		               withUploadID: operation.multipartInfo.uploadID
+		                   inBucket: operation.cloudLocator.bucket
+		                     region: operation.cloudLocator.region
+		           outUrlComponents: &urlComponents];
 		
 		[AWSSignature signRequest: request
 		               withRegion: operation.cloudLocator.region
@@ -3235,7 +3419,7 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 		context.progress = [session uploadProgressForTask:task];
 		[self refreshProgressForMultipartOperation:operation];
 		
-		[self stashContext:context];
+		[self stashContext:context requestID:[self requestIDForOperation:operation]];
 		
 		if (operation.ephemeralInfo.abortRequested)
 		{
@@ -3272,7 +3456,7 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 #if TARGET_OS_IPHONE
 	if (context.uploadFileURL && context.deleteUploadFileURL)
 	{
-		[[NSFileManager defaultManager] removeItemAtURL:context.uploadFileURL error:nil];
+		[uploadFilePool recycleFileURL:context.uploadFileURL];
 	}
 #endif
 	
@@ -3283,6 +3467,12 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 		error = nil; // we only care about non-server-response errors
 	}
 	
+	BOOL isCopyPart =
+	  !context.multipart_initiate &&
+	  !context.multipart_complete &&
+	  !context.multipart_abort    &&
+	  [operation.multipartInfo.copyParts containsIndex:context.multipart_index];
+	
 	// Known status codes:
 	//
 	// 200 - Success
@@ -3290,6 +3480,8 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 	// 404 - <multiple>
 	//  - Bucket not found (account has been deleted)
 	//  - Multipart has expired / aborted
+	//  - Copy source not found (multipart copy)
+	// 412 - Copy source eTag mismatch (multipart copy)
 	
 	if (error)
 	{
@@ -3320,6 +3512,40 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 		[pipeline setStatusAsPendingForOperationWithUUID:context.operationUUID];
 		return;
 	}
+	else if (isCopyPart && (statusCode == 404 || statusCode == 412))
+	{
+		// The existing cloud file (the source of the copy) has been modified, moved or deleted
+		// since we recorded its manifest. So we can't reuse any of its parts.
+		//
+		// Parts that have already been copied are still valid:
+		// their content matches our checksums, regardless of where it came from.
+		// So we simply upload the remaining parts the normal way.
+		
+		ZDCLogInfo(@"multipartTask: copy source unavailable (%ld): uploading remaining parts", (long)statusCode);
+		
+		[self removeTaskForMultipartOperation:context didSucceed:NO];
+		
+		[[self rwConnection] asyncReadWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+			
+			[transaction removeObjectForKey:operation.nodeID inCollection:kZDCCollection_CloudDataManifests];
+			
+			NSString *extName = [self extNameForContext:context];
+			ZDCCloudTransaction *ext = [transaction ext:extName];
+			
+			ZDCCloudOperation *op = (ZDCCloudOperation *)
+			  [[ext operationWithUUID:context.operationUUID inPipeline:context.pipeline] copy];
+			
+			op.multipartInfo.copyParts = nil;
+			op.multipartInfo.copySourceETag = nil;
+			
+			[ext modifyOperation:op];
+			
+		} completionQueue:dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0) completionBlock:^{
+			
+			[pipeline setStatusAsPendingForOperationWithUUID:context.operationUUID];
+		}];
+		return;
+	}
 	else if (statusCode != 200 && statusCode != 204)
 	{
 		// Request failed due to AWS S3 issue.
@@ -3480,7 +3706,39 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 	{
 		// Store eTag for part
 		
-		NSString *eTag = [response eTag];
+		NSString *eTag = nil;
+		
+		if (isCopyPart)
+		{
+			// For UploadPartCopy, the eTag is in the response XML.
+			
+			if ([responseObject isKindOfClass:[S3Response class]])
+			{
+				eTag = [(S3Response *)responseObject uploadPartCopy].eTag;
+			}
+			
+			if (eTag == nil)
+			{
+				// S3 may respond with a 200, and then report an error within the response body.
+				// (The copy may fail after S3 has already started the response.)
+				
+				[self removeTaskForMultipartOperation:context didSucceed:NO];
+				
+				NSUInteger successiveFailCount = [operation.ephemeralInfo s3_didFailWithStatusCode:@(statusCode)];
+				NSTimeInterval delay = [zdc.networkTools exponentialBackoffForFailCount:successiveFailCount];
+				
+				NSDate *holdDate = [NSDate dateWithTimeIntervalSinceNow:delay];
+				NSString *ctx = NSStringFromClass([self class]);
+				
+				[pipeline setHoldDate:holdDate forOperationWithUUID:context.operationUUID context:ctx];
+				[pipeline setStatusAsPendingForOperationWithUUID:context.operationUUID];
+				return;
+			}
+		}
+		else
+		{
+			eTag = [response eTag];
+		}
 		
 		[[self rwConnection] asyncReadWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
 			
@@ -3606,34 +3864,21 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 	}
 	else
 	{
-		context.sha256Hash = [AWSPayload signatureForPayload:rcrdData];
-		
 	#if TARGET_OS_IPHONE
 		
 		// Background NSURLSession's don't support data tasks !
 		//
-		// So we write the data to a temporary location on disk, in order to use a file task.
+		// So we write the data to a (pooled) temporary file on disk, in order to use a file task.
+		// The SHA-256 is calculated while writing.
 		
-		NSString *fileName = [operation.uuid UUIDString];
-		
-		NSURL *tempDir = [ZDCDirectoryManager tempDirectoryURL];
-		NSURL *tempFileURL = [tempDir URLByAppendingPathComponent:fileName isDirectory:NO];
-		
-		NSError *error = nil;
-		[rcrdData writeToURL:tempFileURL options:0 error:&error];
-		
-		if (error)
+		if ([self writeUploadData:rcrdData forContext:context])
 		{
-			ZDCLogError(@"Error writing operation.data (%@): %@", tempFileURL.path, error);
+			[self startMoveOperation:operation withContext:context];
 		}
-		
-		context.uploadFileURL = tempFileURL;
-		context.deleteUploadFileURL = YES;
-		
-		[self startMoveOperation:operation withContext:context];
 	
 	#else // macOS
 		
+		context.sha256Hash = [AWSPayload signatureForPayload:rcrdData];
 		context.uploadData = rcrdData;
 		
 		[self startMoveOperation:operation withContext:context];
@@ -3732,7 +3977,7 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 			[zdc.progressManager setUploadProgress:progress forOperation:operation];
 		}
 		
-		[self stashContext:context];
+		[self stashContext:context requestID:requestID];
 		[zdc.networkTools addRecentRequestID:requestID forUser:context.localUserID];
 		
 		if (operation.ephemeralInfo.abortRequested)
@@ -3768,7 +4013,7 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 #if TARGET_OS_IPHONE
 	if (context.uploadFileURL && context.deleteUploadFileURL)
 	{
-		[[NSFileManager defaultManager] removeItemAtURL:context.uploadFileURL error:nil];
+		[uploadFilePool recycleFileURL:context.uploadFileURL];
 	}
 #endif
 	
@@ -4154,6 +4399,13 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 	{
 		NSAssert(operation.deletedCloudIDs.count <= 1, @"Logic error");
 		
+		// Delete-leaf operations are NOT grouped into an S3 multi-object delete ([S3Request multiDeleteObjects:]).
+		// A delete must go through the staging area, where the server verifies the cloudID/eTag,
+		// and records the change for the other devices. Deleting the objects directly would skip all that.
+		//
+		// Deleting a directory already results in a single delete-node operation (covering the entire subtree).
+		// And the polls for many delete-leaf operations get folded into a single multipoll request.
+		
 		[self startDeleteLeafOperation:operation withContext:context];
 	}
 }
@@ -4242,7 +4494,7 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 			[zdc.progressManager setUploadProgress:progress forOperation:operation];
 		}
 		
-		[self stashContext:context];
+		[self stashContext:context requestID:requestID];
 		[zdc.networkTools addRecentRequestID:requestID forUser:context.localUserID];
 		
 		if (operation.ephemeralInfo.abortRequested)
@@ -4268,6 +4520,8 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 {
 	ZDCLogAutoTrace();
 	
+	[self unstashContext:context];
+	
 	NSURLResponse *response = task.response;
 	
 	YapDatabaseCloudCorePipeline *pipeline = [self pipelineForContext:context];
@@ -4558,34 +4812,21 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 	
 	if (fileData)
 	{
-		context.sha256Hash = [AWSPayload signatureForPayload:fileData];
-		
 	#if TARGET_OS_IPHONE
 		
 		// Background NSURLSession's don't support data tasks !
 		//
-		// So we write the data to a temporary location on disk, in order to use a file task.
-		
-		NSString *fileName = [operation.uuid UUIDString];
-		
-		NSURL *tempDir = [ZDCDirectoryManager tempDirectoryURL];
-		NSURL *tempFileURL = [tempDir URLByAppendingPathComponent:fileName isDirectory:NO];
+		// So we write the data to a (pooled) temporary file on disk, in order to use a file task.
+		// The SHA-256 is calculated while writing.
 		
-		NSError *error = nil;
-		[fileData writeToURL:tempFileURL options:0 error:&error];
-		
-		if (error)
+		if ([self writeUploadData:fileData forContext:context])
 		{
-			ZDCLogError(@"Error writing operation.data (%@): %@", tempFileURL.path, error);
+			[self startDeleteNodeOperation:operation withContext:context];
 		}
-		
-		context.uploadFileURL = tempFileURL;
-		context.deleteUploadFileURL = YES;
-		
-		[self startDeleteNodeOperation:operation withContext:context];
 	
 	#else // macOS
 		
+		context.sha256Hash = [AWSPayload signatureForPayload:fileData];
 		context.uploadData = fileData;
 		
 		[self startDeleteNodeOperation:operation withContext:context];
@@ -4679,7 +4920,7 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 			[zdc.progressManager setUploadProgress:progress forOperation:operation];
 		}
 		
-		[self stashContext:context];
+		[self stashContext:context requestID:requestID];
 		[zdc.networkTools addRecentRequestID:requestID forUser:context.localUserID];
 		
 		if (operation.ephemeralInfo.abortRequested)
@@ -4715,7 +4956,7 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 #if TARGET_OS_IPHONE
 	if (context.uploadFileURL && context.deleteUploadFileURL)
 	{
-		[[NSFileManager defaultManager] removeItemAtURL:context.uploadFileURL error:nil];
+		[uploadFilePool recycleFileURL:context.uploadFileURL];
 	}
 #endif
 	
@@ -5049,34 +5290,21 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 			return;
 		}
 		
-		context.sha256Hash = [AWSPayload signatureForPayload:fileData];
-		
 	#if TARGET_OS_IPHONE
 		
 		// Background NSURLSession's don't support data tasks !
 		//
-		// So we write the data to a temporary location on disk, in order to use a file task.
+		// So we write the data to a (pooled) temporary file on disk, in order to use a file task.
+		// The SHA-256 is calculated while writing.
 		
-		NSString *fileName = [operation.uuid UUIDString];
-		
-		NSURL *tempDir = [ZDCDirectoryManager tempDirectoryURL];
-		NSURL *tempFileURL = [tempDir URLByAppendingPathComponent:fileName isDirectory:NO];
-		
-		NSError *error = nil;
-		[fileData writeToURL:tempFileURL options:0 error:&error];
-		
-		if (error)
+		if ([self writeUploadData:fileData forContext:context])
 		{
-			ZDCLogError(@"Error writing operation.data (%@): %@", tempFileURL.path, error);
+			[self startCopyLeafOperation:operation withContext:context];
 		}
 		
-		context.uploadFileURL = tempFileURL;
-		context.deleteUploadFileURL = YES;
-		
-		[self startCopyLeafOperation:operation withContext:context];
-		
 	#else // macOS
 		
+		context.sha256Hash = [AWSPayload signatureForPayload:fileData];
 		context.uploadData = fileData;
 		
 		[self startCopyLeafOperation:operation withContext:context];
@@ -5227,7 +5455,7 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 			[zdc.progressManager setUploadProgress:progress forOperation:operation];
 		}
 		
-		[self stashContext:context];
+		[self stashContext:context requestID:requestID];
 		[zdc.networkTools addRecentRequestID:requestID forUser:context.localUserID];
 		
 		if (operation.ephemeralInfo.abortRequested)
@@ -5263,7 +5491,7 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 #if TARGET_OS_IPHONE
 	if (context.uploadFileURL && context.deleteUploadFileURL)
 	{
-		[[NSFileManager defaultManager] removeItemAtURL:context.uploadFileURL error:nil];
+		[uploadFilePool recycleFileURL:context.uploadFileURL];
 	}
 #endif
 	
@@ -5561,62 +5789,12 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 	
 	operation.ephemeralInfo.pollContext = nil;
 	
-	NSMutableArray *request_ids = [NSMutableArray arrayWithCapacity:2];
-	NSString *request_id = nil;
-	
-	if ((request_id = [self requestIDForStagingPath:operation.ephemeralInfo.continuation_rcrd])) {
-		[request_ids addObject:request_id];
-	}
-	if ((request_id = [self requestIDForStagingPath:operation.ephemeralInfo.continuation_data])) {
-		[request_ids addObject:request_id];
-	}
-	
-	NSDictionary *json_dict = @{
-		@"request_ids": request_ids
-	};
-	
-	NSError *json_error = nil;
-	NSData *json_data = [NSJSONSerialization dataWithJSONObject:json_dict options:0 error:&json_error];
-	
-	if (json_error) {
-		ZDCLogError(@"JSON serialization error: %@", json_error);
-	}
-	
-	//operation.ephemeralInfo.
+	// Start polling for the continuation requests.
+	// The requestIDs are extracted from the continuation staging paths by the poll aggregator.
 	
 	ZDCMultipollContext *multipollContext = [[ZDCMultipollContext alloc] init];
 	multipollContext.taskContext = context;
 	
-	multipollContext.sha256Hash = [AWSPayload signatureForPayload:json_data];
-	
-#if TARGET_OS_IPHONE
-	
-	// Background NSURLSession's don't support data tasks !
-	//
-	// So we write the data to a temporary location on disk, in order to use a file task.
-	
-	NSString *fileName = [operation.uuid UUIDString];
-	
-	NSURL *tempDir = [ZDCDirectoryManager tempDirectoryURL];
-	NSURL *tempFileURL = [tempDir URLByAppendingPathComponent:fileName isDirectory:NO];
-	
-	NSError *error = nil;
-	[json_data writeToURL:tempFileURL options:0 error:&error];
-	
-	if (error)
-	{
-		ZDCLogError(@"Error writing operation.data (%@): %@", tempFileURL.path, error);
-	}
-	
-	multipollContext.uploadFileURL = tempFileURL;
-	multipollContext.deleteUploadFileURL = YES;
-	
-#else // macOS
-	
-	multipollContext.uploadData = json_data;
-	
-#endif
-	
 	YapDatabaseCloudCorePipeline *pipeline = [self pipelineForContext:context];
 	[self startMultipollWithContext:multipollContext pipeline:pipeline];
 }
@@ -5776,6 +5954,16 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 #pragma mark Poll
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/**
+ * Polling is consolidated.
+ *
+ * Rather than issuing a separate poll request for every operation, the outstanding requestIDs are collected
+ * per (localUserID, region), and a single multipoll request is issued per tick.
+ * The results are then dispatched to each operation's completion handler.
+ *
+ * Each operation still manages its own backoff (via the pipeline's holdDate).
+ * The aggregator only decides how long to wait in order to gather other operations into the same request.
+ */
 - (void)startPollWithContext:(ZDCPollContext *)pollContext pipeline:(YapDatabaseCloudCorePipeline *)pipeline
 {
 	ZDCLogAutoTrace();
@@ -5800,348 +5988,209 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 		return;
 	}
 	
-	// Start the polling process.
+	[self enqueuePollContext:pollContext region:[self pollRegionForContext:pollContext operation:operation]];
+}
 	
-	[zdc.awsCredentialsManager getAWSCredentialsForUser: context.localUserID
-	                                    completionQueue: concurrentQueue
-	                                    completionBlock:^(ZDCLocalUserAuth *auth, NSError *error)
-	{
-		if (error)
-		{
-			if ([error.auth0API_error isEqualToString:kAuth0Error_RateLimit])
-			{
-				// Auth0 is just rate limiting us.
-				// Normal path will automatically execute exponential backoff.
-			}
-			else
-			{
-				// Auth0 is indicating our account may have been removed.
-				[zdc.networkTools handleAuthFailureForUser:context.localUserID withError:error];
-			}
-			
-			[self pollDidComplete:nil inSession:nil withError:error context:pollContext responseObject:nil];
-			return;
-		}
-		
-		ZDCSessionInfo *sessionInfo = [zdc.sessionManager sessionInfoForUserID:context.localUserID];
-		
-	#if TARGET_OS_IPHONE
-		AFURLSessionManager *session = sessionInfo.backgroundSession;
-	#else
-		AFURLSessionManager *session = sessionInfo.session;
-	#endif
-		ZDCSessionUserInfo *userInfo = sessionInfo.userInfo;
-		
-		AWSRegion region = operation.cloudLocator.region;
-		NSString *stage = userInfo.stage;
-		if (!stage)
-		{
-		#ifdef AWS_STAGE // See PrefixHeader.pch
-			stage = AWS_STAGE;
-		#else
-			stage = @"prod";
-		#endif
-		}
-		
-		NSString *path = [NSString stringWithFormat:@"/poll-request/%@", [self requestIDForOperation:operation]];
-		
-		NSURLComponents *urlComponents = [zdc.restManager apiGatewayForRegion:region stage:stage path:path];
-		
-		NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:[urlComponents URL]];
-		request.HTTPMethod = @"GET";
-		
-		[AWSSignature signRequest: request
-		               withRegion: region
-		                  service: AWSService_APIGateway
-		              accessKeyID: auth.aws_accessKeyID
-		                   secret: auth.aws_secret
-		                  session: auth.aws_session];
-		
-	#if TARGET_OS_IPHONE
-		
-		// Background NSURLSession's don't really support data tasks.
-		//
-		// So we have to download the tiny response to a file instead.
-		
-		NSURLSessionDownloadTask *task =
-		  [session downloadTaskWithRequest: request
-		                          progress: nil
-		                       destination: nil
-							  completionHandler: nil];
-		
-	#else
-		
-		__block NSURLSessionDataTask *task = nil;
-		task = [session dataTaskWithRequest: request
-		                     uploadProgress: nil
-		                   downloadProgress: nil
-		                  completionHandler:^(NSURLResponse *response, id responseObject, NSError *error)
-		{
-			[self pollDidComplete: task
-			            inSession: session.session
-			            withError: error
-			              context: pollContext
-			       responseObject: responseObject];
-		}];
-		
-	#endif
-		
-		[self stashContext:pollContext];
+/**
+ * The poll-request API is regional.
+ * We use the region in which the staging file was uploaded.
+ */
+- (AWSRegion)pollRegionForContext:(ZDCPollContext *)pollContext operation:(ZDCCloudOperation *)operation
+{
+	if ([pollContext isKindOfClass:[ZDCMultipollContext class]] && operation.dstCloudLocator) {
+		return operation.dstCloudLocator.region;
+	} else {
+		return operation.cloudLocator.region;
+	}
+}
+
+/**
+ * Returns the list of requestIDs we're waiting on for the given context.
+ *
+ * - ZDCPollContext      : the requestID of the operation itself
+ * - ZDCMultipollContext : the requestIDs of the (remaining) continuation staging paths
+ */
+- (NSArray<NSString *> *)pollRequestIDsForContext:(ZDCPollContext *)pollContext
+                                        operation:(ZDCCloudOperation *)operation
+{
+	if ([pollContext isKindOfClass:[ZDCMultipollContext class]])
+	{
+		NSMutableArray<NSString *> *requestIDs = [NSMutableArray arrayWithCapacity:2];
+		NSString *requestID = nil;
 		
-		if (operation.ephemeralInfo.abortRequested)
-		{
-			operation.ephemeralInfo.abortRequested = NO;
-			[self pollDidComplete: task
-			            inSession: session.session
-			            withError: [self cancelledError]
-			              context: pollContext
-			       responseObject: nil];
+		if ((requestID = [self requestIDForStagingPath:operation.ephemeralInfo.continuation_rcrd])) {
+			[requestIDs addObject:requestID];
 		}
-		else
-		{
-		#if TARGET_OS_IPHONE
-			[zdc.sessionManager associateContext:pollContext withTask:task inSession:session.session];
-		#else
-			// When SessionManager gets called for the completion of a dataTask,
-			// it's not given the `responseObject`, which we need in this case.
-			// So we're handling the completion manually.
-		#endif
-			
-			[task resume];
+		if ((requestID = [self requestIDForStagingPath:operation.ephemeralInfo.continuation_data])) {
+			[requestIDs addObject:requestID];
 		}
-	}];
+		
+		return requestIDs;
+	}
+	else
+	{
+		return @[ [self requestIDForOperation:operation] ];
+	}
 }
 
-- (void)pollDidComplete:(NSURLSessionTask *)task
-              inSession:(NSURLSession *)session
-              withError:(nullable NSError *)error
-                context:(ZDCPollContext *)pollContext
-         responseObject:(id)responseObject
+/**
+ * With only a handful of outstanding requests, we poll right away (no added latency).
+ * As the number grows, we wait a bit longer, so that more operations can share each request.
+ */
+- (NSTimeInterval)pollingTickForOutstandingCount:(NSUInteger)count
+{
+	if (count <= 1)   return 0.0; // seconds
+	if (count <= 10)  return 0.1;
+	if (count <= 100) return 0.5;
+	else              return 1.0;
+}
+
+- (void)enqueuePollContext:(ZDCPollContext *)pollContext region:(AWSRegion)region
 {
 	ZDCLogAutoTrace();
 	
-	[self unstashContext:pollContext];
+	NSString *localUserID = pollContext.taskContext.localUserID;
+	YapCollectionKey *tuple = YapCollectionKeyCreate(localUserID, [AWSRegions shortNameForRegion:region]);
 	
-	NSURLResponse *response = task.response;
-	ZDCTaskContext *context = pollContext.taskContext;
-	YapDatabaseCloudCorePipeline *pipeline = [self pipelineForContext:context];
-	ZDCCloudOperation *operation = [self operationForContext:context];
-	
-	NSInteger httpStatusCode = response.httpStatusCode;
-	
-	if (response && error)
-	{
-		error = nil; // we only care about non-server-response errors
-	}
-	
-	// Known status codes:
-	//
-	// 200 - Success : underlying status was fetched from redis
+	__block BOOL isNewBatch = NO;
+	__block BOOL isFullBatch = NO;
+	__block NSTimeInterval tick = 0.0;
 	
-	if (error || httpStatusCode != 200)
-	{
-		NSTimeInterval delay;
+	dispatch_sync(serialQueue, ^{ @autoreleasepool {
 		
-		if (error)
-		{
-			// Request failed due to network error.
-			//
-			// Most likely, the pipeline has already been suspended.
-			// This is courtesy of the AppDelegate, which does this when Reachability goes down.
-			// And the pipeline will be automatically resumed once we reconnect to the Internet.
-			//
-			// So we can simply hand the operation back to the pipeline.
-			// To be extra cautious (thread timing considerations), we do so after a short delay.
-			
-			delay = 2.0;
+		if (pendingPolls == nil) {
+			pendingPolls = [[NSMutableDictionary alloc] init];
 		}
-		else
+		
+		NSMutableArray<ZDCPollContext*> *batch = pendingPolls[tuple];
+		if (batch == nil)
 		{
-			// Request failed due to unknown server error.
-			//
-			// We expect the server to return some kind of status to us within the JSON response.
-			// Even if the server doesn't know about the request, it would return a 200 response,
-			// with a JSON payload that would indicate as much.
-			
-			NSInteger successiveFailCount = [operation.ephemeralInfo polling_didFail];
-			
-			delay = [self pollingBackoffForFailCount:successiveFailCount];
+			batch = pendingPolls[tuple] = [[NSMutableArray alloc] init];
+			isNewBatch = YES;
 		}
 		
-		NSDate *holdDate = [NSDate dateWithTimeIntervalSinceNow:delay];
-		NSString *ctx = NSStringFromClass([self class]);
+		[batch addObject:pollContext];
 		
-		[pipeline setHoldDate:holdDate forOperationWithUUID:context.operationUUID context:ctx];
-		[pipeline setStatusAsPendingForOperationWithUUID:context.operationUUID];
-		return;
-	}
-	
-	NSDictionary *stagingStatus = nil;
-	NSInteger stagingStatusCode = 0;
+		NSUInteger outstanding = batch.count + [inFlightPollCounts[tuple] unsignedIntegerValue];
+		tick = [self pollingTickForOutstandingCount:outstanding];
+		
+		isFullBatch = (batch.count >= multipoll_maxRequestIDs);
+	}});
 	
-	if ([responseObject isKindOfClass:[NSDictionary class]])
+	if (isFullBatch)
 	{
-		stagingStatus = (NSDictionary *)responseObject;
-		
-		id value = stagingStatus[@"status"];
-		
-		if ([value isKindOfClass:[NSNumber class]])
-			stagingStatusCode = [(NSNumber *)value integerValue];
-		else if ([value isKindOfClass:[NSString class]])
-			stagingStatusCode = [(NSString *)value integerValue];
+		[self flushPollsForTuple:tuple region:region];
 	}
-	
-	if (stagingStatusCode == 0)
+	else if (isNewBatch)
 	{
-		// The server hasn't processed the staging file yet.
-		
-		NSUInteger pollFailCount_total = [operation.ephemeralInfo polling_didFail];
-		
-		// The pollFailCount is never reset !
-		//
-		// So if the server keeps crashing on the same file,
-		// then the pollFailCount will just keep getting bigger and bigger.
-		//
-		// We need to watch out for this,
-		// because if when we invoke `startTouchWithContext:` there's no delay.
-		//
-		// In the past this bug meant that we would execute exponential delay...
-		// until the pollFailCount reached X.
-		// And then we would just send touch commands to the server as fast as possible.
-		
-		const NSUInteger pollingModulus = [self pollingModulus];
-		
-		BOOL pollFailCount_isLoop;
-		NSUInteger pollFailCount_modulus;
-		
-		if (pollFailCount_total < pollingModulus)
-		{
-			pollFailCount_isLoop = NO;
-			pollFailCount_modulus = pollFailCount_total;
-			
-			ZDCLogInfo(@"pollFailCount: %lu", (unsigned long)pollFailCount_total);
-		}
-		else
-		{
-			pollFailCount_isLoop = YES;
-			pollFailCount_modulus = pollFailCount_total % pollingModulus;
+		__weak typeof(self) weakSelf = self;
+		dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(tick * NSEC_PER_SEC)), concurrentQueue, ^{
 			
-			ZDCLogInfo(@"pollFailCount: %lu => %lu",
-			          (unsigned long)pollFailCount_total,
-			          (unsigned long)pollFailCount_modulus);
-		}
-		
-		if (!pollFailCount_isLoop || pollFailCount_modulus != 0)
-		{
-			// Keep polling...
-			//
-			// Note: Even though we use the modulus technique to continually push a new `touch` command to the server,
-			// we continue to force longer delays for polling. If the server is crashing, then there's no reason to
-			// decrease our wait time.
-			
-			NSTimeInterval delay = [self pollingBackoffForFailCount:pollFailCount_total]; // <- Yup (see comment above)
-			NSDate *holdDate = [NSDate dateWithTimeIntervalSinceNow:delay];
-			NSString *ctx = NSStringFromClass([self class]);
-			
-			[pipeline setHoldDate:holdDate forOperationWithUUID:operation.uuid context:ctx];
-			[pipeline setStatusAsPendingForOperationWithUUID:operation.uuid];
-			return;
-		}
-		else
-		{
-			// The server may have "dropped" the staging/touch file.
-			// This could happen if the redis server was restarted.
-			// Or it could be a bug in the server.
-			//
-			// Either way, our solution is to issue a "touch" request for our uploaded staging file.
-			
-			ZDCTouchContext *touchContext = [[ZDCTouchContext alloc] init];
-			touchContext.pollContext = pollContext;
-			
-			[self startTouchWithContext:touchContext pipeline:pipeline];
-			return;
-		}
+			[weakSelf flushPollsForTuple:tuple region:region];
+		});
 	}
+}
+
+- (void)flushPollsForTuple:(YapCollectionKey *)tuple region:(AWSRegion)region
+{
+	__block NSArray<ZDCPollContext*> *batch = nil;
 	
-	// We got a non-zero response from the poll.
-	// Which means we're done polling !
-	
-	[operation.ephemeralInfo polling_didSucceed];
+	dispatch_sync(serialQueue, ^{ @autoreleasepool {
+		
+		batch = [pendingPolls[tuple] copy];
+		pendingPolls[tuple] = nil;
+	}});
 	
-	if (![pollContext atomicMarkCompleted])
-	{
-		// Already processed (poll request vs push notification)
+	if (batch.count == 0) {
 		return;
 	}
 	
-	operation.ephemeralInfo.pollContext = nil;
+	NSString *localUserID = tuple.collection;
 	
-	switch(operation.type)
+	// Split the batch into requests of (at most) multipoll_maxRequestIDs,
+	// and filter out any operations that have disappeared or been aborted.
+	
+	NSMutableArray<ZDCPollContext*> *group = [NSMutableArray arrayWithCapacity:batch.count];
+	NSMutableArray<NSString*> *groupRequestIDs = [NSMutableArray arrayWithCapacity:batch.count];
+	
+	for (ZDCPollContext *pollContext in batch)
 	{
-		case ZDCCloudOperationType_Put:
-		{
-			[self putPollDidComplete:pollContext withStatus:stagingStatus];
-			break;
-		}
-		case ZDCCloudOperationType_Move:
-		{
-			[self movePollDidComplete:pollContext withStatus:stagingStatus];
-			break;
-		}
-		case ZDCCloudOperationType_DeleteLeaf:
-		{
-			[self deleteLeafPollDidComplete:pollContext withStatus:stagingStatus];
-			break;
-		}
-		case ZDCCloudOperationType_DeleteNode:
+		ZDCCloudOperation *operation = [self operationForContext:pollContext.taskContext];
+		
+		if (operation == nil)
 		{
-			[self deleteNodePollDidComplete:pollContext withStatus:stagingStatus];
-			break;
+			// The operation was removed from the pipeline while waiting for the tick.
+			continue;
 		}
-		case ZDCCloudOperationType_CopyLeaf:
+		
+		if (operation.ephemeralInfo.abortRequested)
 		{
-			[self copyLeafPollDidComplete:pollContext withStatus:stagingStatus];
-			break;
+			operation.ephemeralInfo.abortRequested = NO;
+			[self aggregatedPollDidComplete: nil
+			                      withError: [self cancelledError]
+			                   pollContexts: @[ pollContext ]
+			                 responseObject: nil];
+			continue;
 		}
-		default :
+		
+		NSArray<NSString*> *requestIDs = [self pollRequestIDsForContext:pollContext operation:operation];
+		
+		if ((groupRequestIDs.count + requestIDs.count) > multipoll_maxRequestIDs)
 		{
-			ZDCLogWarn(@"Unhandled poll response !");
-			break;
+			[self startAggregatedPoll:[group copy] requestIDs:[groupRequestIDs copy] region:region localUserID:localUserID];
+			
+			[group removeAllObjects];
+			[groupRequestIDs removeAllObjects];
 		}
+		
+		[group addObject:pollContext];
+		[groupRequestIDs addObjectsFromArray:requestIDs];
+	}
+	
+	if (group.count > 0)
+	{
+		[self startAggregatedPoll:group requestIDs:groupRequestIDs region:region localUserID:localUserID];
 	}
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-#pragma mark Multipoll
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-- (void)startMultipollWithContext:(ZDCMultipollContext *)multipollContext
-                         pipeline:(YapDatabaseCloudCorePipeline *)pipeline
+- (void)startAggregatedPoll:(NSArray<ZDCPollContext *> *)pollContexts
+                 requestIDs:(NSArray<NSString *> *)requestIDs
+                     region:(AWSRegion)region
+                localUserID:(NSString *)localUserID
 {
 	ZDCLogAutoTrace();
-	NSParameterAssert(multipollContext != nil);
-	NSParameterAssert(pipeline != nil);
+	ZDCLogVerbose(@"Multipoll: %lu context(s), %lu requestID(s)",
+	              (unsigned long)pollContexts.count, (unsigned long)requestIDs.count);
 	
-	ZDCTaskContext *taskContext = multipollContext.taskContext;
-	NSString *localUserID = taskContext.localUserID;
+	ZDCPollGroupContext *groupContext = [[ZDCPollGroupContext alloc] init];
+	groupContext.localUserID = localUserID;
+	groupContext.region = region;
+	groupContext.pollContexts = pollContexts;
 	
-	// Associate the pollContext with the operation.
-	// This lets us know to keep trying to the poll operation, instead of the staging operation.
+	YapCollectionKey *tuple = YapCollectionKeyCreate(localUserID, [AWSRegions shortNameForRegion:region]);
 	
-	ZDCCloudOperation *operation = [self operationForContext:taskContext];
-	operation.ephemeralInfo.multipollContext = multipollContext;
+	dispatch_sync(serialQueue, ^{ @autoreleasepool {
+		
+		if (inFlightPollCounts == nil) {
+			inFlightPollCounts = [[NSMutableDictionary alloc] init];
+		}
+		
+		NSUInteger count = [inFlightPollCounts[tuple] unsignedIntegerValue];
+		inFlightPollCounts[tuple] = @(count + pollContexts.count);
+	}});
 	
-	// Edge case check:
-	// If the operation was deleted (unceremoniously by rogue code) then the operation could be nil here.
-	// We need to guard against this, as it would cause a crash in the code below.
+	NSDictionary *json_dict = @{
+		@"request_ids": requestIDs
+	};
 	
-	if (operation == nil)
-	{
-		[self skipOperationWithContext:taskContext];
-		return;
+	NSError *json_error = nil;
+	NSData *json_data = [NSJSONSerialization dataWithJSONObject:json_dict options:0 error:&json_error];
+	
+	if (json_error) {
+		ZDCLogError(@"JSON serialization error: %@", json_error);
 	}
 	
-	// Start the polling process.
+	NSString *sha256Hash = [AWSPayload signatureForPayload:json_data];
 	
 	[zdc.awsCredentialsManager getAWSCredentialsForUser: localUserID
 	                                    completionQueue: concurrentQueue
@@ -6157,10 +6206,10 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 			else
 			{
 				// Auth0 is indicating our account may have been removed.
-				[zdc.networkTools handleAuthFailureForUser:taskContext.localUserID withError:error];
+				[zdc.networkTools handleAuthFailureForUser:localUserID withError:error];
 			}
 			
-			[self multipollDidComplete:nil inSession:nil withError:error context:multipollContext responseObject:nil];
+			[self pollGroupDidComplete:nil inSession:nil withError:error context:groupContext responseObject:nil];
 			return;
 		}
 		
@@ -6173,13 +6222,6 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 	#endif
 		ZDCSessionUserInfo *userInfo = sessionInfo.userInfo;
 		
-		AWSRegion region = AWSRegion_Invalid;
-		if (operation.dstCloudLocator) {
-			region = operation.dstCloudLocator.region;
-		} else {
-			region = operation.cloudLocator.region;
-		}
-		
 		NSString *stage = userInfo.stage;
 		if (!stage)
 		{
@@ -6202,73 +6244,353 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 		              accessKeyID: auth.aws_accessKeyID
 		                   secret: auth.aws_secret
 		                  session: auth.aws_session
-		               payloadSig: multipollContext.sha256Hash];
+		               payloadSig: sha256Hash];
 		
-		__block NSURLSessionUploadTask *task = nil;
 	#if TARGET_OS_IPHONE
 		
+		// Background NSURLSession's don't really support data tasks.
+		//
+		// So we have to download the (small) response to a file instead.
+		// The (small) request body travels with the request itself.
+		
+		request.HTTPBody = json_data;
+		
+		NSURLSessionDownloadTask *task =
+		  [session downloadTaskWithRequest: request
+		                          progress: nil
+		                       destination: nil
+		                 completionHandler: nil];
+		
+	#else // macOS
+		
+		__block NSURLSessionUploadTask *task = nil;
 		task = [session uploadTaskWithRequest: request
-		                             fromFile: multipollContext.uploadFileURL
+		                             fromData: json_data
 		                             progress: nil
-								  completionHandler:^(NSURLResponse *response, id responseObject, NSError *error)
+		                    completionHandler:^(NSURLResponse *response, id responseObject, NSError *error)
 		{
-			[self multipollDidComplete: task
+			[self pollGroupDidComplete: task
 			                 inSession: session.session
 			                 withError: error
-			                   context: multipollContext
+			                   context: groupContext
 			            responseObject: responseObject];
 		}];
 		
-	#else // macOS
+	#endif
+		
+		for (ZDCPollContext *pollContext in pollContexts)
+		{
+			// A poll checks on the request of its task, so it's registered under the same requestID.
+			// (Which is missing if the task was restored from a previous version of the framework.)
+			
+			ZDCTaskContext *taskContext = pollContext.taskContext;
+			NSString *requestID = taskContext.requestID ?: taskContext.operationUUID.UUIDString;
+			
+			[self stashContext:pollContext requestID:requestID];
+		}
+		
+	#if TARGET_OS_IPHONE
+		[zdc.sessionManager associateContext:groupContext withTask:task inSession:session.session];
+	#else
+		// When SessionManager gets called for the completion of a dataTask,
+		// it's not given the `responseObject`, which we need in this case.
+		// So we're handling the completion manually.
+	#endif
+			
+		[task resume];
+	}];
+}
+
+/**
+ * Invoked when an aggregated poll request completes.
+ *
+ * On iOS, this is forwarded to us from ZDCSessionManager (via the background session),
+ * and may arrive after the app has been relaunched.
+ */
+- (void)pollGroupDidComplete:(NSURLSessionTask *)task
+                   inSession:(NSURLSession *)session
+                   withError:(nullable NSError *)error
+                     context:(ZDCPollGroupContext *)groupContext
+              responseObject:(id)responseObject
+{
+	ZDCLogAutoTrace();
+	
+	NSArray<ZDCPollContext*> *pollContexts = groupContext.pollContexts;
+	YapCollectionKey *tuple =
+	  YapCollectionKeyCreate(groupContext.localUserID, [AWSRegions shortNameForRegion:groupContext.region]);
+	
+	dispatch_sync(serialQueue, ^{ @autoreleasepool {
+		
+		NSUInteger count = [inFlightPollCounts[tuple] unsignedIntegerValue];
+		if (count > pollContexts.count)
+			inFlightPollCounts[tuple] = @(count - pollContexts.count);
+		else
+			inFlightPollCounts[tuple] = nil;
+	}});
+	
+	[self aggregatedPollDidComplete: task
+	                      withError: error
+	                   pollContexts: pollContexts
+	                 responseObject: responseObject];
+}
+
+/**
+ * Fans the multipoll response back out to each individual operation.
+ */
+- (void)aggregatedPollDidComplete:(NSURLSessionTask *)task
+                        withError:(nullable NSError *)inError
+                     pollContexts:(NSArray<ZDCPollContext *> *)pollContexts
+                   responseObject:(id)responseObject
+{
+	ZDCLogAutoTrace();
+	
+	NSURLResponse *response = task.response;
+	NSInteger httpStatusCode = response.httpStatusCode;
+	
+	NSError *error = inError;
+	if (response && error)
+	{
+		error = nil; // we only care about non-server-response errors
+	}
+	
+	NSDictionary *results = nil;
+	if ([responseObject isKindOfClass:[NSDictionary class]])
+	{
+		results = (NSDictionary *)responseObject;
+	}
+	
+	for (ZDCPollContext *pollContext in pollContexts)
+	{
+		[self unstashContext:pollContext];
+		
+		ZDCTaskContext *context = pollContext.taskContext;
+		YapDatabaseCloudCorePipeline *pipeline = [self pipelineForContext:context];
+		ZDCCloudOperation *operation = [self operationForContext:context];
+		
+		if (operation == nil) {
+			continue;
+		}
+		
+		// Known status codes:
+		//
+		// 200 - Success : underlying status was fetched from redis
+		
+		if (error || httpStatusCode != 200)
+		{
+			NSTimeInterval delay;
+			
+			if (error)
+			{
+				// Request failed due to network error.
+				//
+				// Most likely, the pipeline has already been suspended.
+				// This is courtesy of the AppDelegate, which does this when Reachability goes down.
+				// And the pipeline will be automatically resumed once we reconnect to the Internet.
+				//
+				// So we can simply hand the operation back to the pipeline.
+				// To be extra cautious (thread timing considerations), we do so after a short delay.
+				
+				delay = 2.0;
+			}
+			else
+			{
+				// Request failed due to unknown server error.
+				//
+				// We expect the server to return some kind of status to us within the JSON response.
+				// Even if the server doesn't know about the request, it would return a 200 response,
+				// with a JSON payload that would indicate as much.
+				
+				NSInteger successiveFailCount = [operation.ephemeralInfo polling_didFail];
+				
+				delay = [self pollingBackoffForFailCount:successiveFailCount];
+			}
+			
+			NSDate *holdDate = [NSDate dateWithTimeIntervalSinceNow:delay];
+			NSString *ctx = NSStringFromClass([self class]);
+			
+			[pipeline setHoldDate:holdDate forOperationWithUUID:context.operationUUID context:ctx];
+			[pipeline setStatusAsPendingForOperationWithUUID:context.operationUUID];
+			continue;
+		}
+		
+		if ([pollContext isKindOfClass:[ZDCMultipollContext class]])
+		{
+			[self multipollContext: (ZDCMultipollContext *)pollContext
+			     didReceiveResults: results
+			             operation: operation
+			              pipeline: pipeline];
+			continue;
+		}
+		
+		NSString *requestID = [self requestIDForOperation:operation];
+		NSDictionary *stagingStatus = results[requestID];
+		NSInteger stagingStatusCode = 0;
+		
+		if ([stagingStatus isKindOfClass:[NSDictionary class]])
+		{
+			stagingStatusCode = [self statusCodeFromPollStatus:stagingStatus];
+		}
+		
+		if (stagingStatusCode == 0)
+		{
+			// The server hasn't processed the staging file yet.
+			
+			[self continuePollingOperation:operation withPollContext:pollContext pipeline:pipeline];
+			continue;
+		}
+		
+		// We got a non-zero response from the poll.
+		// Which means we're done polling !
 		
-		task = [session uploadTaskWithRequest: request
-											  fromData: multipollContext.uploadData
-											  progress: nil
-								  completionHandler:^(NSURLResponse *response, id responseObject, NSError *error)
-		{
-			[self multipollDidComplete: task
-			                 inSession: session.session
-			                 withError: error
-			                   context: multipollContext
-			            responseObject: responseObject];
-		}];
+		[operation.ephemeralInfo polling_didSucceed];
 		
-	#endif
+		if (![pollContext atomicMarkCompleted])
+		{
+			// Already processed (poll request vs push notification)
+			continue;
+		}
 		
-		[self stashContext:multipollContext];
+		operation.ephemeralInfo.pollContext = nil;
 		
-		if (operation.ephemeralInfo.abortRequested)
+		[self dispatchPollStatus:stagingStatus forPollContext:pollContext operation:operation];
+	}
+}
+
+/**
+ * Forwards the (final) poll status to the completion handler for the operation type.
+ */
+- (void)dispatchPollStatus:(NSDictionary *)pollStatus
+            forPollContext:(ZDCPollContext *)pollContext
+                 operation:(ZDCCloudOperation *)operation
+{
+	switch(operation.type)
+	{
+		case ZDCCloudOperationType_Put:
 		{
-			operation.ephemeralInfo.abortRequested = NO;
-			[self multipollDidComplete: task
-			                 inSession: session.session
-			                 withError: [self cancelledError]
-			                   context: multipollContext
-			            responseObject: nil];
+			[self putPollDidComplete:pollContext withStatus:pollStatus];
+			break;
 		}
-		else
+		case ZDCCloudOperationType_Move:
 		{
-			// When SessionManager gets called for the completion of a dataTask,
-			// it's not given the `responseObject`, which we need in this case.
-			// So we're handling the completion manually.
-			
-			[task resume];
+			[self movePollDidComplete:pollContext withStatus:pollStatus];
+			break;
 		}
-	}];
+		case ZDCCloudOperationType_DeleteLeaf:
+		{
+			[self deleteLeafPollDidComplete:pollContext withStatus:pollStatus];
+			break;
+		}
+		case ZDCCloudOperationType_DeleteNode:
+		{
+			[self deleteNodePollDidComplete:pollContext withStatus:pollStatus];
+			break;
+		}
+		case ZDCCloudOperationType_CopyLeaf:
+		{
+			[self copyLeafPollDidComplete:pollContext withStatus:pollStatus];
+			break;
+		}
+		default :
+		{
+			ZDCLogWarn(@"Unhandled poll response !");
+			break;
+		}
+	}
 }
 
-- (void)multipollDidComplete:(NSURLSessionTask *)task
-                   inSession:(NSURLSession *)session
-                   withError:(nullable NSError *)error
-                     context:(ZDCMultipollContext *)multipollContext
-              responseObject:(id)responseObject
+/**
+ * Invoked when a poll indicates the server hasn't processed our staging file yet.
+ * Either schedules another poll (with backoff), or issues a touch request.
+ */
+- (void)continuePollingOperation:(ZDCCloudOperation *)operation
+                 withPollContext:(ZDCPollContext *)pollContext
+                        pipeline:(YapDatabaseCloudCorePipeline *)pipeline
+{
+	NSUInteger pollFailCount_total = [operation.ephemeralInfo polling_didFail];
+	
+	// The pollFailCount is never reset !
+	//
+	// So if the server keeps crashing on the same file,
+	// then the pollFailCount will just keep getting bigger and bigger.
+	//
+	// We need to watch out for this,
+	// because if when we invoke `startTouchWithContext:` there's no delay.
+	//
+	// In the past this bug meant that we would execute exponential delay...
+	// until the pollFailCount reached X.
+	// And then we would just send touch commands to the server as fast as possible.
+	
+	const NSUInteger pollingModulus = [self pollingModulus];
+	
+	BOOL pollFailCount_isLoop;
+	NSUInteger pollFailCount_modulus;
+	
+	if (pollFailCount_total < pollingModulus)
+	{
+		pollFailCount_isLoop = NO;
+		pollFailCount_modulus = pollFailCount_total;
+		
+		ZDCLogInfo(@"pollFailCount: %lu", (unsigned long)pollFailCount_total);
+	}
+	else
+	{
+		pollFailCount_isLoop = YES;
+		pollFailCount_modulus = pollFailCount_total % pollingModulus;
+		
+		ZDCLogInfo(@"pollFailCount: %lu => %lu",
+		          (unsigned long)pollFailCount_total,
+		          (unsigned long)pollFailCount_modulus);
+	}
+	
+	if (!pollFailCount_isLoop || pollFailCount_modulus != 0)
+	{
+		// Keep polling...
+		//
+		// Note: Even though we use the modulus technique to continually push a new `touch` command to the server,
+		// we continue to force longer delays for polling. If the server is crashing, then there's no reason to
+		// decrease our wait time.
+		
+		NSTimeInterval delay = [self pollingBackoffForFailCount:pollFailCount_total]; // <- Yup (see comment above)
+		NSDate *holdDate = [NSDate dateWithTimeIntervalSinceNow:delay];
+		NSString *ctx = NSStringFromClass([self class]);
+		
+		[pipeline setHoldDate:holdDate forOperationWithUUID:operation.uuid context:ctx];
+		[pipeline setStatusAsPendingForOperationWithUUID:operation.uuid];
+	}
+	else
+	{
+		// The server may have "dropped" the staging/touch file.
+		// This could happen if the redis server was restarted.
+		// Or it could be a bug in the server.
+		//
+		// Either way, our solution is to issue a "touch" request for our uploaded staging file.
+		
+		ZDCTouchContext *touchContext = [[ZDCTouchContext alloc] init];
+		touchContext.pollContext = pollContext;
+		
+		[self startTouchWithContext:touchContext pipeline:pipeline];
+	}
+}
+
+/**
+ * Handles the completion of a single-request poll (GET /poll-request/{id}).
+ *
+ * New polls are always consolidated by the aggregator (see `startPollWithContext:pipeline:`).
+ * But on iOS, a poll issued by a previous version of the framework (via the background session)
+ * may still complete after the app is relaunched, and gets forwarded to us here.
+ */
+- (void)pollDidComplete:(NSURLSessionTask *)task
+              inSession:(NSURLSession *)session
+              withError:(nullable NSError *)error
+                context:(ZDCPollContext *)pollContext
+         responseObject:(id)responseObject
 {
 	ZDCLogAutoTrace();
 	
-	[self unstashContext:multipollContext];
+	[self unstashContext:pollContext];
 	
 	NSURLResponse *response = task.response;
-	ZDCTaskContext *context = multipollContext.taskContext;
+	ZDCTaskContext *context = pollContext.taskContext;
 	YapDatabaseCloudCorePipeline *pipeline = [self pipelineForContext:context];
 	ZDCCloudOperation *operation = [self operationForContext:context];
 	
@@ -6321,6 +6643,88 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 		return;
 	}
 	
+	NSDictionary *stagingStatus = nil;
+	NSInteger stagingStatusCode = 0;
+	
+	if ([responseObject isKindOfClass:[NSDictionary class]])
+	{
+		stagingStatus = (NSDictionary *)responseObject;
+		
+		id value = stagingStatus[@"status"];
+		
+		if ([value isKindOfClass:[NSNumber class]])
+			stagingStatusCode = [(NSNumber *)value integerValue];
+		else if ([value isKindOfClass:[NSString class]])
+			stagingStatusCode = [(NSString *)value integerValue];
+	}
+	
+	if (stagingStatusCode == 0)
+	{
+		// The server hasn't processed the staging file yet.
+		
+		[self continuePollingOperation:operation withPollContext:pollContext pipeline:pipeline];
+		return;
+	}
+	
+	// We got a non-zero response from the poll.
+	// Which means we're done polling !
+	
+	[operation.ephemeralInfo polling_didSucceed];
+	
+	if (![pollContext atomicMarkCompleted])
+	{
+		// Already processed (poll request vs push notification)
+		return;
+	}
+	
+	operation.ephemeralInfo.pollContext = nil;
+	
+	[self dispatchPollStatus:stagingStatus forPollContext:pollContext operation:operation];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Multipoll
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A multipoll waits on the continuation staging files of an operation (e.g. copy-leaf),
+ * and is consolidated with all other outstanding polls (see `startPollWithContext:pipeline:`).
+ */
+- (void)startMultipollWithContext:(ZDCMultipollContext *)multipollContext
+                         pipeline:(YapDatabaseCloudCorePipeline *)pipeline
+{
+	ZDCLogAutoTrace();
+	NSParameterAssert(multipollContext != nil);
+	NSParameterAssert(pipeline != nil);
+	
+	ZDCTaskContext *taskContext = multipollContext.taskContext;
+	
+	// Associate the pollContext with the operation.
+	// This lets us know to keep trying to the poll operation, instead of the staging operation.
+	
+	ZDCCloudOperation *operation = [self operationForContext:taskContext];
+	operation.ephemeralInfo.multipollContext = multipollContext;
+	
+	// Edge case check:
+	// If the operation was deleted (unceremoniously by rogue code) then the operation could be nil here.
+	// We need to guard against this, as it would cause a crash in the code below.
+	
+	if (operation == nil)
+	{
+		[self skipOperationWithContext:taskContext];
+		return;
+	}
+	
+	[self enqueuePollContext:multipollContext region:[self pollRegionForContext:multipollContext operation:operation]];
+}
+
+- (void)multipollContext:(ZDCMultipollContext *)multipollContext
+       didReceiveResults:(nullable NSDictionary *)results
+               operation:(ZDCCloudOperation *)operation
+                pipeline:(YapDatabaseCloudCorePipeline *)pipeline
+{
+	ZDCLogAutoTrace();
+	
 	NSString *stagingPath_rcrd = operation.ephemeralInfo.continuation_rcrd;
 	NSString *requestID_rcrd = [self requestIDForStagingPath:stagingPath_rcrd];
 	
@@ -6332,39 +6736,24 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 	NSInteger statusCode_rcrd = 0;
 	NSInteger statusCode_data = 0;
 	
-	if ([responseObject isKindOfClass:[NSDictionary class]])
+	if (requestID_rcrd)
 	{
-		NSDictionary *results = (NSDictionary *)responseObject;
+		NSDictionary *stagingStatus = results[requestID_rcrd];
 		
-		if (requestID_rcrd)
+		if ([stagingStatus isKindOfClass:[NSDictionary class]])
 		{
-			NSDictionary *stagingStatus = results[requestID_rcrd];
-			
-			if ([stagingStatus isKindOfClass:[NSDictionary class]])
-			{
-				id value = stagingStatus[@"status"];
-				
-				if ([value isKindOfClass:[NSNumber class]])
-					statusCode_rcrd = [(NSNumber *)value integerValue];
-				else if ([value isKindOfClass:[NSString class]])
-					statusCode_rcrd = [(NSString *)value integerValue];
-			}
+			statusCode_rcrd = [self statusCodeFromPollStatus:stagingStatus];
 		}
+	}
+		
+	if (requestID_data)
+	{
+		NSDictionary *stagingStatus = results[requestID_data];
 		
-		if (requestID_data)
+		if ([stagingStatus isKindOfClass:[NSDictionary class]])
 		{
-			NSDictionary *stagingStatus = results[requestID_data];
-			
-			if ([stagingStatus isKindOfClass:[NSDictionary class]])
-			{
-				stagingStatus_data = stagingStatus;
-				id value = stagingStatus[@"status"];
-				
-				if ([value isKindOfClass:[NSNumber class]])
-					statusCode_data = [(NSNumber *)value integerValue];
-				else if ([value isKindOfClass:[NSString class]])
-					statusCode_data = [(NSString *)value integerValue];
-			}
+			stagingStatus_data = stagingStatus;
+			statusCode_data = [self statusCodeFromPollStatus:stagingStatus];
 		}
 	}
 	
@@ -6375,72 +6764,8 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 	{
 		// The server hasn't processed any staging files since last check.
 		
-		NSUInteger pollFailCount_total = [operation.ephemeralInfo polling_didFail];
-		
-		// The pollFailCount is never reset !
-		//
-		// So if the server keeps crashing on the same file,
-		// then the pollFailCount will just keep getting bigger and bigger.
-		//
-		// We need to watch out for this,
-		// because if when we invoke `startTouchWithContext:` there's no delay.
-		//
-		// In the past this bug meant that we would execute exponential delay...
-		// until the pollFailCount reached X.
-		// And then we would just send touch commands to the server as fast as possible.
-		
-		const NSUInteger pollingModulus = [self pollingModulus];
-		
-		BOOL pollFailCount_isLoop;
-		NSUInteger pollFailCount_modulus;
-		
-		if (pollFailCount_total < pollingModulus)
-		{
-			pollFailCount_isLoop = NO;
-			pollFailCount_modulus = pollFailCount_total;
-			
-			ZDCLogInfo(@"pollFailCount: %lu", (unsigned long)pollFailCount_total);
-		}
-		else
-		{
-			pollFailCount_isLoop = YES;
-			pollFailCount_modulus = pollFailCount_total % pollingModulus;
-			
-			ZDCLogInfo(@"pollFailCount: %lu => %lu",
-			          (unsigned long)pollFailCount_total,
-			          (unsigned long)pollFailCount_modulus);
-		}
-		
-		if (!pollFailCount_isLoop || pollFailCount_modulus != 0)
-		{
-			// Keep polling...
-			//
-			// Note: Even though we use the modulus technique to continually push a new `touch` command to the server,
-			// we continue to force longer delays for polling. If the server is crashing, then there's no reason to
-			// decrease our wait time.
-			
-			NSTimeInterval delay = [self pollingBackoffForFailCount:pollFailCount_total]; // <- Yup (see comment above)
-			NSDate *holdDate = [NSDate dateWithTimeIntervalSinceNow:delay];
-			NSString *ctx = NSStringFromClass([self class]);
-			
-			[pipeline setHoldDate:holdDate forOperationWithUUID:operation.uuid context:ctx];
-			[pipeline setStatusAsPendingForOperationWithUUID:operation.uuid];
-			return;
-		}
-		else
-		{
-			// The server may have "dropped" the staging/touch file.
-			// This could happen if the redis server was restarted.
-			// Or it could be a bug in the server.
-			//
-			// Either way, our solution is to issue a "touch" request for our uploaded staging file.
-			
-			ZDCTouchContext *touchContext = [[ZDCTouchContext alloc] init];
-			touchContext.pollContext = multipollContext;
-			
-			[self startTouchWithContext:touchContext pipeline:pipeline];
-			return;
-		}
+		[self continuePollingOperation:operation withPollContext:multipollContext pipeline:pipeline];
+		return;
 	}
 	
 	// We got a non-zero response from the poll.
@@ -6632,7 +6957,7 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 		
 	#endif
 		
-		[self stashContext:touchContext];
+		[self stashContext:touchContext requestID:[self requestIDForOperation:operation]];
 		
 		if (operation.ephemeralInfo.abortRequested)
 		{
@@ -6766,7 +7091,14 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 	[operation.ephemeralInfo s3_didSucceed];
 	operation.ephemeralInfo.touchContext = nil;
 	
-	[self startPollWithContext:touchContext.pollContext pipeline:pipeline];
+	if ([touchContext.pollContext isKindOfClass:[ZDCMultipollContext class]])
+	{
+		[self startMultipollWithContext:(ZDCMultipollContext *)touchContext.pollContext pipeline:pipeline];
+	}
+	else
+	{
+		[self startPollWithContext:touchContext.pollContext pipeline:pipeline];
+	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -6883,34 +7215,21 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 				return;
 			}
 		
-			context.sha256Hash = [AWSPayload signatureForPayload:jsonData];
-			
 		#if TARGET_OS_IPHONE
 	
 			// Background NSURLSession's don't support data tasks !
 			//
-			// So we write the data to a temporary location on disk, in order to use a file task.
-	
-			NSString *fileName = [operation.uuid UUIDString];
+			// So we write the data to a (pooled) temporary file on disk, in order to use a file task.
+			// The SHA-256 is calculated while writing.
 	
-			NSURL *tempDir = [ZDCDirectoryManager tempDirectoryURL];
-			NSURL *tempFileURL = [tempDir URLByAppendingPathComponent:fileName isDirectory:NO];
-	
-			NSError *error = nil;
-			[jsonData writeToURL:tempFileURL options:0 error:&error];
-		
-			if (error)
+			if ([self writeUploadData:jsonData forContext:context])
 			{
-				ZDCLogError(@"Error writing operation.data (%@): %@", tempFileURL.path, error);
+				[self startAvatarOperation:operation withContext:context];
 			}
 		
-			context.uploadFileURL = tempFileURL;
-			context.deleteUploadFileURL = YES;
-		
-			[self startAvatarOperation:operation withContext:context];
-		
 		#else // macOS
 	
+			context.sha256Hash = [AWSPayload signatureForPayload:jsonData];
 			context.uploadData = jsonData;
 	
 			[self startAvatarOperation:operation withContext:context];
@@ -7067,7 +7386,7 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 			[zdc.progressManager setUploadProgress:progress forOperation:operation];
 		}
 		
-		[self stashContext:context];
+		[self stashContext:context requestID:[self requestIDForOperation:operation]];
 		
 		if (operation.ephemeralInfo.abortRequested)
 		{
@@ -7102,7 +7421,7 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 #if TARGET_OS_IPHONE
 	if (context.uploadFileURL && context.deleteUploadFileURL)
 	{
-		[[NSFileManager defaultManager] removeItemAtURL:context.uploadFileURL error:nil];
+		[uploadFilePool recycleFileURL:context.uploadFileURL];
 	}
 #endif
 	
@@ -7875,6 +8194,32 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 		
 		[[self rwConnection] asyncReadWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
 			
+			// If we still know the layout of the current cloud file,
+			// then any unchanged parts can be copied server-side (instead of uploaded).
+			
+			ZDCCloudDataManifest *manifest =
+			  [transaction objectForKey:node.uuid inCollection:kZDCCollection_CloudDataManifests];
+			
+			if (manifest)
+			{
+				ZDCNode *currentNode = [transaction objectForKey:node.uuid inCollection:kZDCCollection_Nodes];
+				
+				if (currentNode.eTag_data && [manifest.eTag isEqualToString:currentNode.eTag_data])
+				{
+					NSIndexSet *copyParts =
+					  [manifest reusablePartsWithChunkSize:chunkSize checksums:chunkChecksums];
+					
+					if (copyParts.count > 0)
+					{
+						ZDCLogVerbose(@"Multipart: reusing %lu of %lu parts from existing cloud file",
+						              (unsigned long)copyParts.count, (unsigned long)partsCount);
+						
+						multipartInfo.copyParts = copyParts;
+						multipartInfo.copySourceETag = manifest.eTag;
+					}
+				}
+			}
+			
 			NSString *extName = [self extNameForContext:context];
 			ZDCCloudTransaction *ext = [transaction ext:extName];
 			
@@ -8403,6 +8748,11 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 }
 
 - (void)retryOperationWithContext:(ZDCTaskContext *)context
+{
+	[self retryOperationWithContext:context delay:0.0];
+}
+
+- (void)retryOperationWithContext:(ZDCTaskContext *)context delay:(NSTimeInterval)delay
 {
 #ifndef NS_BLOCK_ASSERTIONS
 	NSParameterAssert(context != nil);
@@ -8419,11 +8769,21 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 #if TARGET_OS_IPHONE
 	if (context.uploadFileURL && context.deleteUploadFileURL)
 	{
-		[[NSFileManager defaultManager] removeItemAtURL:context.uploadFileURL error:nil];
+		[uploadFilePool recycleFileURL:context.uploadFileURL];
 	}
 #endif
 	
-	[[self pipelineForOperation:op] setStatusAsPendingForOperationWithUUID:op.uuid];
+	YapDatabaseCloudCorePipeline *pipeline = [self pipelineForOperation:op];
+	
+	if (delay > 0.0)
+	{
+		NSDate *holdDate = [NSDate dateWithTimeIntervalSinceNow:delay];
+		NSString *ctx = NSStringFromClass([self class]);
+		
+		[pipeline setHoldDate:holdDate forOperationWithUUID:op.uuid context:ctx];
+	}
+	
+	[pipeline setStatusAsPendingForOperationWithUUID:op.uuid];
 }
 
 - (void)skipOperationWithContext:(ZDCTaskContext *)context
@@ -8443,7 +8803,7 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 #if TARGET_OS_IPHONE
 	if (context.uploadFileURL && context.deleteUploadFileURL)
 	{
-		[[NSFileManager defaultManager] removeItemAtURL:context.uploadFileURL error:nil];
+		[uploadFilePool recycleFileURL:context.uploadFileURL];
 	}
 #endif
 	
@@ -8469,7 +8829,7 @@ typedef NS_ENUM(NSInteger, ZDCErrCode) {
 #if TARGET_OS_IPHONE
 	if (context.uploadFileURL && context.deleteUploadFileURL)
 	{
-		[[NSFileManager defaultManager] removeItemAtURL:context.uploadFileURL error:nil];
+		[uploadFilePool recycleFileURL:context.uploadFileURL];
 	}
 #endif
 	
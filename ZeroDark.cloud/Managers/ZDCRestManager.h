@@ -156,6 +156,9 @@ NS_ASSUME_NONNULL_BEGIN
  *
  * - region (NSString)
  * - bucket (NSString)
+ *
+ * Successful responses are cached in the database for a few minutes,
+ * and concurrent requests for the same <remoteUserID, requesterID> are coalesced.
 **/
 - (void)fetchInfoForRemoteUserID:(NSString *)remoteUserID
                      requesterID:(NSString *)localUserID
@@ -166,6 +169,9 @@ NS_ASSUME_NONNULL_BEGIN
  * Queries the server to see if the given user still exists.
  * Returns NO if the user has been deleted from the system.
  * E.g. user's free trial expired (without becoming a customer), or user stopped paying their bill.
+ *
+ * The answer is never cached, since a user may be deleted at any time.
+ * Concurrent requests for the same userID are coalesced.
 **/
 - (void)fetchUserExists:(NSString *)userID
         completionQueue:(nullable dispatch_queue_t)completionQueue
@@ -409,6 +415,9 @@ NS_ASSUME_NONNULL_BEGIN
  * - user's region
  * - user's bucket
  * - list of linked identities
+ *
+ * Successful responses are cached in the database for a few minutes,
+ * and concurrent requests for the same <remoteUserID, requesterID> are coalesced.
  */
 - (void)fetchFilteredAuth0Profile:(NSString *)remoteUserID
                       requesterID:(NSString *)localUserID
@@ -585,6 +594,8 @@ NS_ASSUME_NONNULL_BEGIN
  *   Invoked with the results of the query.
  *   If the merkleTree parameter is non-nil, you'll want to (1) verify the included publicKey info,
  *   and (2) verify the merkleTree file itself (via `merkleTree.hashAndVerify()`).
+ *   The response parameter will be nil if the file was served from the local cache.
+ *   (The file is named after its merkleTreeRoot, so its content never changes.)
  */
 - (void)fetchMerkleTreeFile:(NSString *)merkleTreeRoot
             completionQueue:(nullable dispatch_queue_t)completionQueue
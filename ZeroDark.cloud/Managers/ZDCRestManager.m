@@ -21,6 +21,7 @@
 #import "ZDCLocalUserPrivate.h"
 #import "ZDCLocalUserAuth.h"
 #import "ZDCLogging.h"
+#import "ZDCResponseCache.h"
 #import "ZDCUserBillPrivate.h"
 #import "ZeroDarkCloudPrivate.h"
 
@@ -54,6 +55,13 @@
   #endif
 #endif
 
+// Per-endpoint freshness for entries in the shared response cache.
+// See ZDCResponseCache.
+//
+static NSTimeInterval const kCacheTTL_RemoteUserInfo = (60 * 5);                 // 5 minutes
+static NSTimeInterval const kCacheTTL_Auth0Profile   = (60 * 5);                 // 5 minutes
+static NSTimeInterval const kCacheTTL_MerkleTreeFile = (60 * 60 * 24 * 30);      // 30 days (content-addressed)
+
 @implementation ZDCRestManager {
 @private
 	
@@ -63,6 +71,8 @@
 	
 	dispatch_queue_t billing_queue;
 	NSMutableDictionary<NSString*, ZDCUserBill*> *billing_history;
+	
+	ZDCResponseCache *responseCache;
 }
 
 #pragma clang diagnostic push
@@ -83,6 +93,10 @@
 		
 		billing_queue = dispatch_queue_create("ZDCRestManager", DISPATCH_QUEUE_SERIAL);
 		billing_history = [[NSMutableDictionary alloc] initWithCapacity:1];
+		
+		responseCache =
+		  [[ZDCResponseCache alloc] initWithReadConnection: zdc.databaseManager.roDatabaseConnection
+		                                   writeConnection: zdc.databaseManager.rwDatabaseConnection];
 	}
 	return self;
 }
@@ -148,6 +162,28 @@
 	return urlComponents;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Response Cache
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * AFNetworking sessions hand us a parsed responseObject.
+ * This converts it back to raw data, so it can be stored in the response cache.
+ */
+- (nullable NSData *)dataFromResponseObject:(id)responseObject
+{
+	if ([responseObject isKindOfClass:[NSData class]])
+	{
+		return (NSData *)responseObject;
+	}
+	else if ([NSJSONSerialization isValidJSONObject:responseObject])
+	{
+		return [NSJSONSerialization dataWithJSONObject:responseObject options:0 error:nil];
+	}
+	
+	return nil;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Configuration
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -876,107 +912,130 @@
 	NSParameterAssert(localUserID != nil);
 	NSParameterAssert(completionBlock != nil);
 	
+	remoteUserID = [remoteUserID copy]; // mutable string protection
+	localUserID = [localUserID copy];   // mutable string protection
+	
 	if (!completionQueue)
 		completionQueue = dispatch_get_main_queue();
 	
-	[zdc.awsCredentialsManager getAWSCredentialsForUser: localUserID
-	                                    completionQueue: dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0)
-	                                    completionBlock:^(ZDCLocalUserAuth *auth, NSError *error)
-	{
-		if (error)
-		{
-			dispatch_async(completionQueue, ^{
-				completionBlock(nil, error);
-			});
-			return;
-		}
-		
-		// Generate request
+	// Parses the response, and returns either the jsonDict or an error.
+	//
+	NSDictionary* (^ParseResponse)(NSData*, NSError**) = ^NSDictionary* (NSData *data, NSError **errPtr){
 		
-		ZDCSessionInfo *sessionInfo = [zdc.sessionManager sessionInfoForUserID:localUserID];
-	#if TARGET_OS_IPHONE
-		AFURLSessionManager *session = sessionInfo.foregroundSession;
-	#else
-		AFURLSessionManager *session = sessionInfo.session;
-	#endif
-		ZDCSessionUserInfo *userInfo = sessionInfo.userInfo;
+		NSError *jsonError = nil;
+		NSDictionary *jsonDict = nil;
 		
-		AWSRegion region = AWSRegion_Master; // Activation always goes through Oregon
+		id json = [NSJSONSerialization JSONObjectWithData:data options:0 error:&jsonError];
+		if ([json isKindOfClass:[NSDictionary class]])
+		{
+			jsonDict = (NSDictionary *)json;
+			
+			NSString *errorMessage = jsonDict[@"message"];
+			if (errorMessage)
+			{
+				NSUInteger statusCode = [jsonDict[@"statusCode"] unsignedIntegerValue];
+				jsonError = [NSError errorWithClass:[self class] code:statusCode description:errorMessage];
+				jsonDict = nil;
+			}
+		}
 		
-		NSString *stage = userInfo.stage;
-		if (!stage)
+		if (!jsonDict && !jsonError)
 		{
-			stage = DEFAULT_AWS_STAGE;
+			jsonError = [NSError errorWithClass:[self class] code:500 description:@"Invalid response from server"];
 		}
-
-		NSString *path = @"/users/info/";
 		
-		NSURLComponents *urlComponents = [self apiGatewayForRegion:region stage:stage path:path];
-
-		NSURLQueryItem *user_id = [NSURLQueryItem queryItemWithName:@"user_id" value:remoteUserID];
-		NSURLQueryItem *check_archive = [NSURLQueryItem queryItemWithName:@"check_archive" value:@"1"];
-		urlComponents.queryItems = @[ user_id, check_archive ];
-
-		NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:[urlComponents URL]];
-		request.HTTPMethod = @"GET";
+		if (errPtr) *errPtr = jsonError;
+		return jsonDict;
+	};
 	
-		[AWSSignature signRequest: request
-		               withRegion: region
-		                  service: AWSService_APIGateway
-		              accessKeyID: auth.aws_accessKeyID
-		                   secret: auth.aws_secret
-		                  session: auth.aws_session];
-		
-		// Send request
+	// The response depends on who is asking, so the requester is part of the key.
+	NSString *cacheKey =
+	  [NSString stringWithFormat:@"%@|%@|%@", NSStringFromSelector(_cmd), remoteUserID, localUserID];
 	
-		NSURLSessionDataTask *task =
-		  [session dataTaskWithRequest: request
-		                uploadProgress: nil
-		              downloadProgress: nil
-		             completionHandler:^(NSURLResponse *response, id responseObject, NSError *error)
+	[responseCache cachedResponseForKey: cacheKey
+	                                ttl: kCacheTTL_RemoteUserInfo
+	                        isCacheable:^BOOL (NSData *data)
+	{
+		return (ParseResponse(data, NULL) != nil);
+	}
+	                       networkBlock:^(NSString *eTag, void (^done)(NSURLResponse*, NSData*, NSError*))
+	{
+		[zdc.awsCredentialsManager getAWSCredentialsForUser: localUserID
+		                                    completionQueue: dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0)
+		                                    completionBlock:^(ZDCLocalUserAuth *auth, NSError *error)
 		{
-			NSError *jsonError = nil;
-			NSDictionary *jsonDict = nil;
-			
-			if ([responseObject isKindOfClass:[NSDictionary class]])
-			{
-				jsonDict = (NSDictionary *)responseObject;
-			}
-			else if ([responseObject isKindOfClass:[NSData class]])
+			if (error)
 			{
-				jsonDict = [NSJSONSerialization JSONObjectWithData:(NSData *)responseObject options:0 error:&jsonError];
+				done(nil, nil, error);
+				return;
 			}
 			
-			if (jsonDict && !error)
-			{
-				NSString *errorMessage = jsonDict[@"message"];
-				if (errorMessage)
-				{
-					NSUInteger statusCode = [jsonDict[@"statusCode"] unsignedIntegerValue];
-					jsonError = [NSError errorWithClass:[self class] code:statusCode description:errorMessage];
-				}
-			}
+			// Generate request
 			
-			if (!jsonDict && !error && !jsonError)
+			ZDCSessionInfo *sessionInfo = [zdc.sessionManager sessionInfoForUserID:localUserID];
+		#if TARGET_OS_IPHONE
+			AFURLSessionManager *session = sessionInfo.foregroundSession;
+		#else
+			AFURLSessionManager *session = sessionInfo.session;
+		#endif
+			ZDCSessionUserInfo *userInfo = sessionInfo.userInfo;
+		
+			AWSRegion region = AWSRegion_Master; // Activation always goes through Oregon
+		
+			NSString *stage = userInfo.stage;
+			if (!stage)
 			{
-				error = [NSError errorWithClass:[self class] code:500 description:@"Invalid response from server"];
+				stage = DEFAULT_AWS_STAGE;
 			}
 			
-			if (error || jsonError)
-			{
-				dispatch_async(completionQueue, ^{ @autoreleasepool {
-					completionBlock(nil, (error ?: jsonError));
-				}});
+			NSString *path = @"/users/info/";
+		
+			NSURLComponents *urlComponents = [self apiGatewayForRegion:region stage:stage path:path];
+
+			NSURLQueryItem *user_id = [NSURLQueryItem queryItemWithName:@"user_id" value:remoteUserID];
+			NSURLQueryItem *check_archive = [NSURLQueryItem queryItemWithName:@"check_archive" value:@"1"];
+			urlComponents.queryItems = @[ user_id, check_archive ];
+
+			NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:[urlComponents URL]];
+			request.HTTPMethod = @"GET";
+	
+			if (eTag) {
+				[request setValue:eTag forHTTPHeaderField:@"If-None-Match"];
 			}
-			else
+			
+			[AWSSignature signRequest: request
+			               withRegion: region
+			                  service: AWSService_APIGateway
+			              accessKeyID: auth.aws_accessKeyID
+			                   secret: auth.aws_secret
+			                  session: auth.aws_session];
+		
+			// Send request
+	
+			NSURLSessionDataTask *task =
+			  [session dataTaskWithRequest: request
+			                uploadProgress: nil
+			              downloadProgress: nil
+			             completionHandler:^(NSURLResponse *response, id responseObject, NSError *error)
 			{
-				dispatch_async(completionQueue, ^{ @autoreleasepool {
-					completionBlock(jsonDict, nil);
-				}});
-			}
+				done(response, [self dataFromResponseObject:responseObject], error);
+			}];
+		
+			[task resume];
 		}];
+	}
+	                    completionBlock:^(NSURLResponse *response, NSData *data, NSError *error)
+	{
+		NSDictionary *jsonDict = nil;
 		
-		[task resume];
+		if (!error)
+		{
+			jsonDict = ParseResponse(data ?: [NSData data], &error);
+		}
+		
+		dispatch_async(completionQueue, ^{ @autoreleasepool {
+			completionBlock(jsonDict, error);
+		}});
 	}];
 }
 
@@ -985,16 +1044,57 @@
  * Or view the api's online (for both Swift & Objective-C):
  * https://apis.zerodark.cloud/Classes/ZDCRestManager.html
  */
-- (void)fetchUserExists:(NSString *)userID
-        completionQueue:(nullable dispatch_queue_t)completionQueue
-        completionBlock:(void (^)(BOOL exists, NSError *_Nullable error))completionBlock
+- (void)fetchUserExists:(NSString *)inUserID
+        completionQueue:(nullable dispatch_queue_t)inCompletionQueue
+        completionBlock:(void (^)(BOOL exists, NSError *_Nullable error))inCompletionBlock
 {
 	ZDCLogAutoTrace();
 	
-	NSParameterAssert(userID != nil);
+	NSParameterAssert(inUserID != nil);
 	
-	if (!completionQueue && completionBlock)
-		completionQueue = dispatch_get_main_queue();
+	NSString *userID = [inUserID copy]; // mutable string protection
+	
+	if (!inCompletionBlock)
+		return;
+	
+	if (!inCompletionQueue)
+		inCompletionQueue = dispatch_get_main_queue();
+	
+	// The answer isn't cached: this method exists to notice that a user has been deleted.
+	// But concurrent requests for the same user are coalesced.
+	
+	NSString *requestKey = [NSString stringWithFormat:@"%@|%@", NSStringFromSelector(_cmd), userID];
+	
+	NSUInteger requestCount =
+	  [asyncCompletionDispatch pushCompletionQueue:inCompletionQueue
+	                               completionBlock:inCompletionBlock
+	                                        forKey:requestKey];
+	
+	if (requestCount > 1)
+	{
+		// There's a previous request currently in-flight.
+		// The <completionQueue, completionBlock> have been added to the existing request's list.
+		return;
+	}
+	
+	void (^InvokeCompletionBlocks)(BOOL, NSError*) = ^(BOOL exists, NSError *error) {
+		
+		NSArray<dispatch_queue_t> * completionQueues = nil;
+		NSArray<id>               * completionBlocks = nil;
+		[asyncCompletionDispatch popCompletionQueues:&completionQueues
+		                            completionBlocks:&completionBlocks
+		                                      forKey:requestKey];
+		
+		for (NSUInteger i = 0; i < completionBlocks.count; i++)
+		{
+			dispatch_queue_t completionQueue = completionQueues[i];
+			void (^completionBlock)(BOOL, NSError *) = completionBlocks[i];
+			
+			dispatch_async(completionQueue, ^{ @autoreleasepool {
+				completionBlock(exists, error);
+			}});
+		}
+	};
 	
 	// Generate request
 	
@@ -1028,7 +1128,7 @@
 		BOOL validResponse = NO;
 		BOOL exists = NO;
 		
-		if (json)
+		if ([json isKindOfClass:[NSDictionary class]])
 		{
 			id value = json[@"exists"];
 			
@@ -1049,12 +1149,7 @@
 			error = [NSError errorWithClass:[self class] code:500 description:@"Invalid response from server"];
 		}
 		
-		if (completionBlock)
-		{
-			dispatch_async(completionQueue, ^{ @autoreleasepool {
-				completionBlock(exists, error);
-			}});
-		}
+		InvokeCompletionBlocks(exists, error);
 	}];
 	
 	[task resume];
@@ -1495,17 +1590,13 @@
                             forLocalUserID:(NSString *)localUserID
                                   withAuth:(ZDCLocalUserAuth *)auth
 {
-	__block ZDCLocalUser *localUser = nil;
-	YapDatabaseConnection *roConnection = zdc.databaseManager.roDatabaseConnection;
-	[roConnection readWithBlock:^(YapDatabaseReadTransaction * _Nonnull transaction) {
-		
-		ZDCUser *user = [transaction objectForKey:localUserID inCollection:kZDCCollection_Users];
-		if ([user isKindOfClass:[ZDCLocalUser class]]) {
-			localUser = (ZDCLocalUser *)user;
-		}
-	}];
+	// The sessionManager keeps a per-user snapshot of {region, bucket, stage},
+	// which it refreshes in the background whenever the localUser changes.
+	// So we can avoid a synchronous database read here.
 	
-	NSString *stage = localUser.aws_stage;
+	ZDCSessionUserInfo *userInfo = [zdc.sessionManager sessionInfoForUserID:localUserID].userInfo;
+	
+	NSString *stage = userInfo.stage;
 	if (!stage)
 	{
 		stage = DEFAULT_AWS_STAGE;
@@ -1562,16 +1653,13 @@
                              forLocalUserID:(NSString *)localUserID
                                    withAuth:(ZDCLocalUserAuth *)auth
 {
-	__block ZDCLocalUser *localUser = nil;
-	[zdc.databaseManager.roDatabaseConnection readWithBlock:^(YapDatabaseReadTransaction *transaction) {
-		
-		ZDCUser *user = [transaction objectForKey:localUserID inCollection:kZDCCollection_Users];
-		if ([user isKindOfClass:[ZDCLocalUser class]]) {
-			localUser = (ZDCLocalUser *)user;
-		}
-	}];
+	// The sessionManager keeps a per-user snapshot of {region, bucket, stage},
+	// which it refreshes in the background whenever the localUser changes.
+	// So we can avoid a synchronous database read here.
 	
-	NSString *stage = localUser.aws_stage;
+	ZDCSessionUserInfo *userInfo = [zdc.sessionManager sessionInfoForUserID:localUserID].userInfo;
+	
+	NSString *stage = userInfo.stage;
 	if (!stage)
 	{
 		stage = DEFAULT_AWS_STAGE;
@@ -1827,69 +1915,119 @@
 		}
 	};
 	
-	[zdc.awsCredentialsManager getAWSCredentialsForUser: localUserID
-	                                    completionQueue: dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0)
-	                                    completionBlock:^(ZDCLocalUserAuth *auth, NSError *error)
-	{
-		if (error)
-		{
-			InvokeCompletionBlock(nil, nil, error);
-			return;
-		}
-		
-		ZDCSessionInfo *sessionInfo = [zdc.sessionManager sessionInfoForUserID:localUserID];
-	#if TARGET_OS_IPHONE
-		AFURLSessionManager *session = sessionInfo.foregroundSession;
-	#else
-		AFURLSessionManager *session = sessionInfo.session;
-	#endif
-		ZDCSessionUserInfo *userInfo = sessionInfo.userInfo;
+	// What region do we use ?
+	//
+	// Technically, any region should work.
+	// That is, we can perform the HTTP request from any AWS region we're running in.
+	// However, there are financial costs to consider.
+	// Amazon will charge us for the outgoing bandwidth.
+	//
+	// Interestingly, it appears that auth0 is itself running within AWS.
+	// And they appear to have setup our account in us-west-2.
+	// So there's a chance AWS won't charge us for outgoing bandwidth if our query doesn't leave their datacenter.
+	//
+	// Thus we're going to always direct the query to the us-west-2 center.
 		
-		// What region do we use ?
-		//
-		// Technically, any region should work.
-		// That is, we can perform the HTTP request from any AWS region we're running in.
-		// However, there are financial costs to consider.
-		// Amazon will charge us for the outgoing bandwidth.
-		//
-		// Interestingly, it appears that auth0 is itself running within AWS.
-		// And they appear to have setup our account in us-west-2.
-		// So there's a chance AWS won't charge us for outgoing bandwidth if our query doesn't leave their datacenter.
-		//
-		// Thus we're going to always direct the query to the us-west-2 center.
+	AWSRegion region = AWSRegion_Master;
+	NSString *path = [NSString stringWithFormat:@"/auth0/fetch/%@", remoteUserID];
+	
+	// The response depends on who is asking, so the requester is part of the key.
+	NSString *cacheKey =
+	  [NSString stringWithFormat:@"%@|%@|%@", NSStringFromSelector(_cmd), remoteUserID, localUserID];
+	
+	[responseCache cachedResponseForKey: cacheKey
+	                                ttl: kCacheTTL_Auth0Profile
+	                        isCacheable:^BOOL (NSData *data)
+	{
+		// The server reports some errors within a 200 response.
 		
-		AWSRegion region = AWSRegion_Master;
+		id json = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
 		
-		NSString *stage = userInfo.stage;
-		if (!stage)
-		{
-			stage = DEFAULT_AWS_STAGE;
+		if ([json isKindOfClass:[NSArray class]]) {
+			return YES;
 		}
+		if ([json isKindOfClass:[NSDictionary class]]) {
+			return (((NSDictionary *)json)[@"errorMessage"] == nil);
+		}
+		return NO;
+	}
+	                       networkBlock:^(NSString *eTag, void (^done)(NSURLResponse*, NSData*, NSError*))
+	{
+		[zdc.awsCredentialsManager getAWSCredentialsForUser: localUserID
+		                                    completionQueue: dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0)
+		                                    completionBlock:^(ZDCLocalUserAuth *auth, NSError *error)
+		{
+			if (error)
+			{
+				done(nil, nil, error);
+				return;
+			}
+			
+			ZDCSessionInfo *sessionInfo = [zdc.sessionManager sessionInfoForUserID:localUserID];
+		#if TARGET_OS_IPHONE
+			AFURLSessionManager *session = sessionInfo.foregroundSession;
+		#else
+			AFURLSessionManager *session = sessionInfo.session;
+		#endif
+			ZDCSessionUserInfo *userInfo = sessionInfo.userInfo;
+		
+			NSString *stage = userInfo.stage;
+			if (!stage)
+			{
+				stage = DEFAULT_AWS_STAGE;
+			}
 
-		NSString *path = [NSString stringWithFormat:@"/auth0/fetch/%@", remoteUserID];
+			NSURLComponents *urlComponents = [self apiGatewayForRegion:region stage:stage path:path];
 		
-		NSURLComponents *urlComponents = [self apiGatewayForRegion:region stage:stage path:path];
+			NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:[urlComponents URL]];
+			[request setHTTPMethod:@"GET"];
+			
+			if (eTag) {
+				[request setValue:eTag forHTTPHeaderField:@"If-None-Match"];
+			}
 		
-		NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:[urlComponents URL]];
-		[request setHTTPMethod:@"GET"];
+			[AWSSignature signRequest: request
+			               withRegion: region
+			                  service: AWSService_APIGateway
+			              accessKeyID: auth.aws_accessKeyID
+			                   secret: auth.aws_secret
+			                  session: auth.aws_session];
 		
-		[AWSSignature signRequest: request
-		               withRegion: region
-		                  service: AWSService_APIGateway
-		              accessKeyID: auth.aws_accessKeyID
-		                   secret: auth.aws_secret
-		                  session: auth.aws_session];
+			NSURLSessionDataTask *task =
+			  [session dataTaskWithRequest: request
+			                uploadProgress: nil
+			              downloadProgress: nil
+			             completionHandler:^(NSURLResponse *response, id responseObject, NSError *error)
+			{
+				done(response, [self dataFromResponseObject:responseObject], error);
+			}];
 		
-		NSURLSessionDataTask *task =
-		  [session dataTaskWithRequest: request
-		                uploadProgress: nil
-		              downloadProgress: nil
-		             completionHandler:^(NSURLResponse *response, id responseObject, NSError *error)
-		{
-			InvokeCompletionBlock(response, responseObject, error);
+			[task resume];
 		}];
+	}
+	                    completionBlock:^(NSURLResponse *response, NSData *data, NSError *error)
+	{
+		if (response == nil && data)
+		{
+			// Served from the cache.
+			// Our callers expect a standard 200 response.
+			
+			NSString *stage = [zdc.sessionManager sessionInfoForUserID:localUserID].userInfo.stage;
+			NSURL *url = [[self apiGatewayForRegion:region stage:(stage ?: DEFAULT_AWS_STAGE) path:path] URL];
+			
+			response = [[NSHTTPURLResponse alloc] initWithURL: url
+			                                       statusCode: 200
+			                                      HTTPVersion: @"HTTP/1.1"
+			                                     headerFields: nil];
+		}
 		
-		[task resume];
+		id responseObject = nil;
+		if (data)
+		{
+			responseObject = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] ?: data;
+		}
+		
+		InvokeCompletionBlock(response, responseObject, error);
 	}];
 }
 
@@ -3180,22 +3318,71 @@
 		merkleTreeRoot = [merkleTreeRoot substringFromIndex:2];
 	}
 	
-	NSURLComponents *urlComponents = [[NSURLComponents alloc] init];
-	urlComponents.scheme = @"https";
-	urlComponents.host = @"blockchain.storm4.cloud";
-	urlComponents.path = [NSString stringWithFormat:@"/%@.json", merkleTreeRoot];
+	// Parses the response, and returns either the merkleTree or an error.
+	//
+	ZDCMerkleTree* (^ParseResponse)(NSData*, NSError**) = ^ZDCMerkleTree* (NSData *data, NSError **errPtr){
+		
+		NSDictionary *jsonDict = nil;
+		if (data)
+		{
+			jsonDict = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+		}
+		
+		if (![jsonDict isKindOfClass:[NSDictionary class]])
+		{
+			NSString *msg = @"Server returned non-json-dictionary response";
+			if (errPtr) *errPtr = [NSError errorWithClass:[self class] code:500 description:msg];
+			
+			return nil;
+		}
+		
+		NSError *parseError = nil;
+		ZDCMerkleTree *merkleTree = [ZDCMerkleTree parseFile:jsonDict error:&parseError];
+		
+		if (errPtr) *errPtr = parseError;
+		return parseError ? nil : merkleTree;
+	};
 	
-	NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:[urlComponents URL]];
-	request.HTTPMethod = @"GET";
+	// The file is named after its merkle root, so its content never changes.
+	// Which makes it a perfect candidate for long-term caching.
 	
-	[request setValue:@"application/json" forHTTPHeaderField:@"Content-Type"];
+	NSString *cacheKey = [NSString stringWithFormat:@"%@|%@", NSStringFromSelector(_cmd), [merkleTreeRoot lowercaseString]];
 	
-	NSURLSessionConfiguration *sessionConfig = [NSURLSessionConfiguration ephemeralSessionConfiguration];
-	NSURLSession *session = [NSURLSession sessionWithConfiguration:sessionConfig];
+	[responseCache cachedResponseForKey: cacheKey
+	                                ttl: kCacheTTL_MerkleTreeFile
+	                        isCacheable:^BOOL (NSData *data)
+	{
+		return (ParseResponse(data, NULL) != nil);
+	}
+	                       networkBlock:^(NSString *eTag, void (^done)(NSURLResponse*, NSData*, NSError*))
+	{
+		NSURLComponents *urlComponents = [[NSURLComponents alloc] init];
+		urlComponents.scheme = @"https";
+		urlComponents.host = @"blockchain.storm4.cloud";
+		urlComponents.path = [NSString stringWithFormat:@"/%@.json", merkleTreeRoot];
 	
-	NSURLSessionDataTask *task =
-	  [session dataTaskWithRequest:request
-	             completionHandler:^(NSData *data, NSURLResponse *urlResponse, NSError *networkError)
+		NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:[urlComponents URL]];
+		request.HTTPMethod = @"GET";
+	
+		[request setValue:@"application/json" forHTTPHeaderField:@"Content-Type"];
+	
+		if (eTag) {
+			[request setValue:eTag forHTTPHeaderField:@"If-None-Match"];
+		}
+		
+		NSURLSessionConfiguration *sessionConfig = [NSURLSessionConfiguration ephemeralSessionConfiguration];
+		NSURLSession *session = [NSURLSession sessionWithConfiguration:sessionConfig];
+	
+		NSURLSessionDataTask *task =
+		  [session dataTaskWithRequest:request
+		             completionHandler:^(NSData *data, NSURLResponse *urlResponse, NSError *networkError)
+		{
+			done(urlResponse, data, networkError);
+		}];
+		
+		[task resume];
+	}
+	                    completionBlock:^(NSURLResponse *urlResponse, NSData *data, NSError *networkError)
 	{
 		if (networkError)
 		{
@@ -3203,42 +3390,28 @@
 			return;
 		}
 		  
-		NSInteger statusCode = [urlResponse httpStatusCode];
-		if (statusCode != 200)
+		if (urlResponse) // nil if served from the cache
 		{
-			NSString *msg = [NSString stringWithFormat:@"Server returned status code %ld", (long)statusCode];
-			NSError *error = [NSError errorWithClass:[self class] code:statusCode description:msg];
-			
-			InvokeCompletionBlock(urlResponse, nil, error);
-			return;
-		}
-		  
-		NSDictionary *jsonDict = nil;
-		if (data)
-		{
-			jsonDict = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
-		}
-		
-		if (![jsonDict isKindOfClass:[NSDictionary class]])
-		{
-			NSString *msg = @"Server returned non-json-dictionary response";
-			NSError *error = [NSError errorWithClass:[self class] code:500 description:msg];
+			NSInteger statusCode = [urlResponse httpStatusCode];
+			if (statusCode != 200)
+			{
+				NSString *msg = [NSString stringWithFormat:@"Server returned status code %ld", (long)statusCode];
+				NSError *error = [NSError errorWithClass:[self class] code:statusCode description:msg];
 			
-			InvokeCompletionBlock(urlResponse, nil, error);
-			return;
+				InvokeCompletionBlock(urlResponse, nil, error);
+				return;
+			}
 		}
 		  
 		NSError *parseError = nil;
-		ZDCMerkleTree *merkleTree = [ZDCMerkleTree parseFile:jsonDict error:&parseError];
+		ZDCMerkleTree *merkleTree = ParseResponse(data, &parseError);
 		  
-		if (parseError) {
-			InvokeCompletionBlock(urlResponse, nil, parseError);
-		} else {
+		if (merkleTree) {
 			InvokeCompletionBlock(urlResponse, merkleTree, nil);
+		} else {
+			InvokeCompletionBlock(urlResponse, nil, parseError);
 		}
 	}];
-		
-	[task resume];
 }
 
 #pragma clang diagnostic pop
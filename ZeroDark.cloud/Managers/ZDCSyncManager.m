@@ -11,6 +11,7 @@
 
 #import "ZDCLogging.h"
 #import "ZeroDarkCloudPrivate.h"
+#import "ZDCSyncingNodeTracker.h"
 
 // Categories
 #import "NSDate+ZeroDark.h"
@@ -30,6 +31,7 @@
 /* extern */ NSString *const kZDCSyncStatusNotificationInfo = @"ZDCSyncStatusNotificationInfo";
 
 static NSTimeInterval const ZDCDefaultPullInterval = 60 * 15; // 15 minutes (in the absence of push notifications)
+static NSTimeInterval const ZDCSyncingNodeIDsCoalesceInterval = 0.1; // seconds
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark -
@@ -99,13 +101,19 @@ static NSTimeInterval const ZDCDefaultPullInterval = 60 * 15; // 15 minutes (in
 @property (nonatomic, strong, readwrite) dispatch_source_t timer;
 @property (nonatomic, assign, readwrite) BOOL timerSuspended;
 
-@property (nonatomic, strong, readwrite) NSSet<NSString *> *syncingNodeIDs;
+// Syncing nodeIDs are tracked incrementally (see "Node State").
+
+@property (nonatomic, strong, readonly) ZDCSyncingNodeTracker *syncingNodes;
+
+@property (nonatomic, assign, readwrite) BOOL syncingOpsRefreshScheduled;
+@property (nonatomic, assign, readwrite) BOOL syncingNodeIDsNotificationScheduled;
 
 @end
 
 @implementation ZDCLocalUserSyncState
 
 @synthesize localUserID = localUserID;
+@synthesize syncingNodes = syncingNodes;
 
 - (instancetype)initWithLocalUserID:(NSString *)inLocalUserID
 {
@@ -114,6 +122,8 @@ static NSTimeInterval const ZDCDefaultPullInterval = 60 * 15; // 15 minutes (in
 		localUserID = [inLocalUserID copy];
 		
 		self.isPushingSuspended = YES; // to match initial suspend in DatabaseManager
+		
+		syncingNodes = [[ZDCSyncingNodeTracker alloc] init];
 	}
 	return self;
 }
@@ -517,6 +527,49 @@ static NSTimeInterval const ZDCDefaultPullInterval = 60 * 15; // 15 minutes (in
 	{
 		[self refreshLocalUsers];
 	}
+	
+	// If a tracked node is moved (parentID changed) or deleted,
+	// then the ancestry we're tracking for it (and its descendants) is stale.
+	
+	if (notification.object != zdc.databaseManager.database) {
+		return;
+	}
+	
+	NSDictionary *userInfo = notification.userInfo;
+	
+	BOOL removedAll = [userInfo[YapDatabaseAllKeysRemovedKey] boolValue];
+	if (!removedAll) {
+		removedAll = [userInfo[YapDatabaseRemovedCollectionsKey] containsObject:kZDCCollection_Nodes];
+	}
+	
+	NSMutableSet<NSString *> *changedNodeIDs = nil;
+	if (!removedAll)
+	{
+		changedNodeIDs = [NSMutableSet set];
+		
+		for (YapCollectionKey *ck in userInfo[YapDatabaseObjectChangesKey])
+		{
+			if ([ck.collection isEqualToString:kZDCCollection_Nodes]) {
+				[changedNodeIDs addObject:ck.key];
+			}
+		}
+		for (YapCollectionKey *ck in userInfo[YapDatabaseRemovedKeysKey])
+		{
+			if ([ck.collection isEqualToString:kZDCCollection_Nodes]) {
+				[changedNodeIDs addObject:ck.key];
+			}
+		}
+		
+		if (changedNodeIDs.count == 0) {
+			return;
+		}
+	}
+	
+	__weak typeof(self) weakSelf = self;
+	dispatch_async(queue, ^{ @autoreleasepool {
+		
+		[weakSelf refreshSyncingAncestriesForChangedNodeIDs:changedNodeIDs];
+	}});
 }
 
 - (void)pipelineActiveStatusChanged:(NSNotification *)notification
@@ -597,7 +650,7 @@ static NSTimeInterval const ZDCDefaultPullInterval = 60 * 15; // 15 minutes (in
 	}
 	
 	NSString *localUserID = sender_cloudExt.localUserID;
-	[self refreshSyncingNodeIDsForLocalUserID:localUserID treeID:treeID];
+	[self scheduleSyncingOpsRefreshForLocalUserID:localUserID treeID:treeID];
 }
 
 - (void)progressListChanged:(NSNotification *)notification
@@ -606,7 +659,24 @@ static NSTimeInterval const ZDCDefaultPullInterval = 60 * 15; // 15 minutes (in
 	
 	ZDCProgressManagerChanges *changes = notification.userInfo[kZDCProgressManagerChanges];
 	
-	[self refreshSyncingNodeIDsForLocalUserID:changes.localUserID treeID:zdc.primaryTreeID];
+	// Upload progress doesn't affect the syncingNodeIDs.
+	// The corresponding operation is already in the pipeline (and thus already tracked).
+	//
+	if (changes.progressType == ZDCProgressType_Upload) {
+		return;
+	}
+	
+	NSString *localUserID = changes.localUserID;
+	NSString *nodeID = changes.nodeID;
+	NSString *treeID = zdc.primaryTreeID;
+	
+	if (localUserID == nil || nodeID == nil) return;
+	
+	__weak typeof(self) weakSelf = self;
+	dispatch_async(queue, ^{ @autoreleasepool {
+		
+		[weakSelf refreshSyncingDownloadForNodeID:nodeID localUserID:localUserID treeID:treeID];
+	}});
 }
 
 #if TARGET_OS_IPHONE
@@ -842,10 +912,10 @@ static NSTimeInterval const ZDCDefaultPullInterval = 60 * 15; // 15 minutes (in
 			
 			syncState.timerSuspended = YES;
 			
-			[self refreshSyncingNodeIDsForLocalUserID:localUserID treeID:treeID];
-			
 			syncStates[localUserID] = syncState;
 			isNewSyncState = YES;
+			
+			[self seedSyncingNodeIDsForLocalUserID:localUserID treeID:treeID];
 		}
 		
 		BOOL wasDisabled = syncState.isEnabled == NO;
@@ -1655,7 +1725,7 @@ static NSTimeInterval const ZDCDefaultPullInterval = 60 * 15; // 15 minutes (in
 		ZDCLocalUserSyncState *syncState = syncStates[localUserID];
 		if (syncState)
 		{
-			result = syncState.syncingNodeIDs;
+			result = syncState.syncingNodes.syncingNodeIDs;
 		}
 		
 	#pragma clang diagnostic pop
@@ -1670,109 +1740,281 @@ static NSTimeInterval const ZDCDefaultPullInterval = 60 * 15; // 15 minutes (in
 }
 
 /**
- * Internal method that actually performs the calculation.
- * External classes should use the method above, which uses a recent cached calculation.
+ * Returns the ancestry of the given node: [nodeID, parentID, grandparentID, ..., rootID]
  */
-- (NSSet<NSString *> *)syncingNodeIDsForLocalUserID:(NSString *)localUserID
-                                             treeID:(NSString *)treeID
-                                        transaction:(YapDatabaseReadTransaction *)transaction
+- (NSArray<NSString *> *)ancestryForNodeID:(NSString *)nodeID transaction:(YapDatabaseReadTransaction *)transaction
+{
+	NSMutableArray<NSString *> *ancestry = [NSMutableArray arrayWithCapacity:8];
+	
+	NSString *currentNodeID = nodeID;
+	do {
+		
+		if ([ancestry containsObject:currentNodeID])
+			break;
+		else
+			[ancestry addObject:currentNodeID];
+		
+		ZDCNode *currentNode = [transaction objectForKey:currentNodeID inCollection:kZDCCollection_Nodes];
+		currentNodeID = currentNode.parentID;
+		
+	} while (currentNodeID != nil);
+	
+	return ancestry;
+}
+
+/**
+ * Invoked when a new syncState is created.
+ * Picks up any operations already in the pipeline, and any downloads already in flight.
+ */
+- (void)seedSyncingNodeIDsForLocalUserID:(NSString *)localUserID treeID:(NSString *)treeID
 {
-	NSMutableSet<NSString *> *active_nodeIDs = [NSMutableSet set];
+	ZDCLogAutoTrace();
+	NSAssert(dispatch_get_specific(IsOnQueueKey), @"Must be executed within queue");
 	
-	// Grab all nodeIDs being pushed (or scheduled to be pushed)
+	[self refreshSyncingOpsForLocalUserID:localUserID treeID:treeID];
+	
+	NSSet<NSString *> *download_nodeIDs = [zdc.progressManager allDownloadingNodeIDs:localUserID];
+	for (NSString *nodeID in download_nodeIDs)
+	{
+		[self refreshSyncingDownloadForNodeID:nodeID localUserID:localUserID treeID:treeID];
+	}
+}
+
+/**
+ * The pipeline's queue changes in bursts (e.g. a transaction adds several operations at once,
+ * and then each operation is started, completed, etc).
+ * So we coalesce the changes, and process them together.
+ */
+- (void)scheduleSyncingOpsRefreshForLocalUserID:(NSString *)localUserID treeID:(NSString *)treeID
+{
+	if (localUserID == nil) return;
+	
+	__weak typeof(self) weakSelf = self;
+	dispatch_async(queue, ^{ @autoreleasepool {
+		
+		__strong typeof(self) strongSelf = weakSelf;
+		if (strongSelf == nil) return;
+		
+		ZDCLocalUserSyncState *syncState = strongSelf->syncStates[localUserID];
+		if (syncState == nil || syncState.syncingOpsRefreshScheduled) {
+			return;
+		}
+		
+		syncState.syncingOpsRefreshScheduled = YES;
+		
+		dispatch_time_t when =
+		  dispatch_time(DISPATCH_TIME_NOW, (int64_t)(ZDCSyncingNodeIDsCoalesceInterval * NSEC_PER_SEC));
+		
+		dispatch_after(when, strongSelf->queue, ^{ @autoreleasepool {
+			
+			syncState.syncingOpsRefreshScheduled = NO;
+			[weakSelf refreshSyncingOpsForLocalUserID:localUserID treeID:treeID];
+		}});
+	}});
+}
+
+/**
+ * Compares the pipeline against the tracked operations:
+ *
+ * - operations that were added to the pipeline are resolved (parent chain lookup), and then retained
+ * - operations that were completed or skipped (or removed from the pipeline) are released
+ *
+ * Only the added operations require database access.
+ * Everything else is a dictionary lookup.
+ */
+- (void)refreshSyncingOpsForLocalUserID:(NSString *)localUserID treeID:(NSString *)treeID
+{
+	ZDCLogAutoTrace();
+	NSAssert(dispatch_get_specific(IsOnQueueKey), @"Must be executed within queue");
+	
+	ZDCLocalUserSyncState *syncState = syncStates[localUserID];
+	if (syncState == nil) return;
 	
 	YapDatabaseCloudCore *ext = [zdc.databaseManager cloudExtForUserID:localUserID treeID:treeID];
 	YapDatabaseCloudCorePipeline *pipeline = [ext defaultPipeline];
 	
+	NSMutableArray<ZDCCloudOperation *> *operations = [NSMutableArray array];
+	
 	[pipeline enumerateOperationsUsingBlock:
 		^(YapDatabaseCloudCoreOperation *operation, NSUInteger graphIdx, BOOL *stop)
 	{
-		__unsafe_unretained ZDCCloudOperation *op = (ZDCCloudOperation *)operation;
-		
-		NSString *nodeID = op.nodeID;
-		if (nodeID)
-		{
-			// Ignore any operations that have been marked as completed or skipped.
-			// This happens due to various optimizations.
-			
-			YDBCloudCoreOperationStatus status = [pipeline statusForOperationWithUUID:operation.uuid];
-			
-			if (status != YDBCloudOperationStatus_Completed && status != YDBCloudOperationStatus_Skipped)
-			{
-				[active_nodeIDs addObject:nodeID];
-			}
+		if ([operation isKindOfClass:[ZDCCloudOperation class]]) {
+			[operations addObject:(ZDCCloudOperation *)operation];
 		}
 	}];
 	
-	// Grab all nodeIDs being pulled.
-	//
-	// ...
-	// Todo: we need a way to track this information !
-	// ...
-	
-	// Grab all nodeIDs being downloaded.
+	BOOL changed = NO;
+	NSDictionary<NSUUID *, NSString *> *added_ops =
+	  [syncState.syncingNodes updateWithOperations: operations
+	                                   statusBlock:^YDBCloudCoreOperationStatus (NSUUID *opUUID)
+	{
+		return [pipeline statusForOperationWithUUID:opUUID];
+		
+	} changed:&changed];
 	
-	NSSet<NSString *> *download_nodeIDs = [zdc.progressManager allDownloadingNodeIDs:localUserID];
+	if (changed) {
+		[self scheduleSyncingNodeIDsChangedNotificationForLocalUserID:localUserID treeID:treeID];
+	}
 	
-	[active_nodeIDs unionSet:download_nodeIDs];
+	if (added_ops.count == 0) {
+		return;
+	}
 	
-	// Add all parent nodes
+	// Resolve & retain new operations
 	
-	NSMutableSet<NSString *> *all_nodeIDs = [NSMutableSet set];
+	NSMutableDictionary<NSUUID *, NSArray<NSString *> *> *added_ancestry =
+	  [NSMutableDictionary dictionaryWithCapacity:added_ops.count];
 	
-	for (NSString *nodeID in active_nodeIDs)
-	{
-		NSString *currentNodeID = nodeID;
-		do {
-			
-			if ([all_nodeIDs containsObject:currentNodeID])
-				break;
-			else
-				[all_nodeIDs addObject:currentNodeID];
+	__weak typeof(self) weakSelf = self;
+	[zdc.databaseManager.roDatabaseConnection asyncReadWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		__strong typeof(self) strongSelf = weakSelf;
+		if (strongSelf == nil) return;
+		
+		NSMutableDictionary<NSString *, NSArray<NSString *> *> *cache = [NSMutableDictionary dictionary];
+		
+		[added_ops enumerateKeysAndObjectsUsingBlock:^(NSUUID *opUUID, NSString *nodeID, BOOL *stop) {
 			
-			ZDCNode *currentNode = [transaction objectForKey:currentNodeID inCollection:kZDCCollection_Nodes];
-			currentNodeID = currentNode.parentID;
+			NSArray<NSString *> *ancestry = cache[nodeID];
+			if (ancestry == nil)
+			{
+				ancestry = [strongSelf ancestryForNodeID:nodeID transaction:transaction];
+				cache[nodeID] = ancestry;
+			}
 			
-		} while (currentNodeID != nil);
-	}
-	
-	return all_nodeIDs;
+			added_ancestry[opUUID] = ancestry;
+		}];
+		
+	} completionQueue:queue completionBlock:^{
+		
+		// If an operation was completed/skipped while we were resolving it,
+		// then it's no longer pending, and the tracker ignores it.
+		
+		if ([syncState.syncingNodes resolveOperations:added_ancestry]) {
+			[weakSelf scheduleSyncingNodeIDsChangedNotificationForLocalUserID:localUserID treeID:treeID];
+		}
+	}];
 }
 
-- (void)refreshSyncingNodeIDsForLocalUserID:(NSString *)localUserID treeID:(NSString *)treeID
+/**
+ * Invoked when a download (meta or data) is started or stopped for the given node.
+ */
+- (void)refreshSyncingDownloadForNodeID:(NSString *)nodeID
+                            localUserID:(NSString *)localUserID
+                                 treeID:(NSString *)treeID
 {
 	ZDCLogAutoTrace();
+	NSAssert(dispatch_get_specific(IsOnQueueKey), @"Must be executed within queue");
 	
-	if (localUserID == nil) return;
+	ZDCLocalUserSyncState *syncState = syncStates[localUserID];
+	if (syncState == nil) return;
 	
-	__block NSSet<NSString *> *newSyncingNodeIDs = nil;
+	BOOL isDownloading = ([zdc.progressManager downloadProgressForNodeID:nodeID] != nil);
+	
+	if (!isDownloading)
+	{
+		if ([syncState.syncingNodes stopDownloadForNodeID:nodeID]) {
+			[self scheduleSyncingNodeIDsChangedNotificationForLocalUserID:localUserID treeID:treeID];
+		}
+		return;
+	}
+	
+	if (![syncState.syncingNodes startDownloadForNodeID:nodeID]) {
+		return; // already tracked (or pending)
+	}
+	
+	__block NSArray<NSString *> *ancestry = nil;
 	
 	__weak typeof(self) weakSelf = self;
 	[zdc.databaseManager.roDatabaseConnection asyncReadWithBlock:^(YapDatabaseReadTransaction *transaction) {
 		
-		__strong typeof(self) strongSelf = weakSelf;
-		if (strongSelf == nil) return;
-		
-		newSyncingNodeIDs = [strongSelf syncingNodeIDsForLocalUserID:localUserID treeID:treeID transaction:transaction];
+		ancestry = [weakSelf ancestryForNodeID:nodeID transaction:transaction];
 		
 	} completionQueue:queue completionBlock:^{
 		
-		__strong typeof(self) strongSelf = weakSelf;
-		if (strongSelf == nil) return;
+		if (ancestry == nil) {
+			[syncState.syncingNodes stopDownloadForNodeID:nodeID];
+			return;
+		}
 		
-		ZDCLocalUserSyncState *syncState = strongSelf->syncStates[localUserID];
-		if (syncState)
-		{
-			NSSet<NSString *> *oldSyncingNodeIDs = syncState.syncingNodeIDs;
+		if ([syncState.syncingNodes resolveDownloadForNodeID:nodeID ancestry:ancestry]) {
+			[weakSelf scheduleSyncingNodeIDsChangedNotificationForLocalUserID:localUserID treeID:treeID];
+		}
+	}];
+}
+
+/**
+ * Invoked when nodes are modified or deleted.
+ *
+ * The tracked ancestries were resolved when each operation/download was added.
+ * If a node in one of those ancestries is subsequently moved (its parentID changes),
+ * or deleted, then the ancestry is re-resolved, and the difference is released/retained.
+ *
+ * The changedNodeIDs are nil if every node was removed.
+ */
+- (void)refreshSyncingAncestriesForChangedNodeIDs:(NSSet<NSString *> *)changedNodeIDs
+{
+	ZDCLogAutoTrace();
+	NSAssert(dispatch_get_specific(IsOnQueueKey), @"Must be executed within queue");
+	
+	NSString *treeID = zdc.primaryTreeID;
+	YapDatabaseConnection *roConnection = zdc.databaseManager.roDatabaseConnection;
+	dispatch_queue_t completionQueue = queue;
+	
+	__weak typeof(self) weakSelf = self;
+	[syncStates enumerateKeysAndObjectsUsingBlock:
+		^(NSString *localUserID, ZDCLocalUserSyncState *syncState, BOOL *stop)
+	{
+		NSSet<NSString *> *nodeIDs = [syncState.syncingNodes nodeIDsAffectedByChangedNodeIDs:changedNodeIDs];
+		if (nodeIDs.count == 0) {
+			return;
+		}
+		
+		NSMutableDictionary<NSString *, NSArray<NSString *> *> *ancestries =
+		  [NSMutableDictionary dictionaryWithCapacity:nodeIDs.count];
+		
+		[roConnection asyncReadWithBlock:^(YapDatabaseReadTransaction *transaction) {
+			
+			__strong typeof(self) strongSelf = weakSelf;
+			if (strongSelf == nil) return;
 			
-			if (!oldSyncingNodeIDs || ![oldSyncingNodeIDs isEqualToSet:newSyncingNodeIDs])
+			for (NSString *nodeID in nodeIDs)
 			{
-				syncState.syncingNodeIDs = newSyncingNodeIDs;
-				
-				[strongSelf postSyncingNodeIDsChangedNotification:localUserID treeID:treeID];
+				ancestries[nodeID] = [strongSelf ancestryForNodeID:nodeID transaction:transaction];
 			}
-		}
+			
+		} completionQueue:completionQueue completionBlock:^{
+			
+			if ([syncState.syncingNodes updateAncestries:ancestries]) {
+				[weakSelf scheduleSyncingNodeIDsChangedNotificationForLocalUserID:localUserID treeID:treeID];
+			}
+		}];
 	}];
 }
 
+/**
+ * Multiple changes within the coalesce interval result in a single notification.
+ */
+- (void)scheduleSyncingNodeIDsChangedNotificationForLocalUserID:(NSString *)localUserID treeID:(NSString *)treeID
+{
+	NSAssert(dispatch_get_specific(IsOnQueueKey), @"Must be executed within queue");
+	
+	ZDCLocalUserSyncState *syncState = syncStates[localUserID];
+	if (syncState == nil || syncState.syncingNodeIDsNotificationScheduled) {
+		return;
+	}
+	
+	syncState.syncingNodeIDsNotificationScheduled = YES;
+	
+	dispatch_time_t when =
+	  dispatch_time(DISPATCH_TIME_NOW, (int64_t)(ZDCSyncingNodeIDsCoalesceInterval * NSEC_PER_SEC));
+	
+	__weak typeof(self) weakSelf = self;
+	dispatch_after(when, queue, ^{ @autoreleasepool {
+		
+		syncState.syncingNodeIDsNotificationScheduled = NO;
+		[weakSelf postSyncingNodeIDsChangedNotification:localUserID treeID:treeID];
+	}});
+}
+
 @end
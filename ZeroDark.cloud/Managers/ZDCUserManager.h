@@ -29,6 +29,11 @@ NS_ASSUME_NONNULL_BEGIN
  * The download involves the following steps:
  * - Fetching the user's general information (region & bucket)
  * - Fetching the user's linked identities
+ * - Fetching the user's public key
+ * - Checking the user's public key against the blockchain
+ *
+ * If any of the first 3 steps fail, the download fails (and nothing is stored in the database).
+ * A blockchain network error isn't fatal, as the check is retried later.
  *
  * @param remoteUserID
  *   The userID of the user to fetch.
@@ -49,6 +54,43 @@ NS_ASSUME_NONNULL_BEGIN
         completionQueue:(nullable dispatch_queue_t)completionQueue
         completionBlock:(nullable void (^)(ZDCUser *_Nullable remoteUser, NSError *_Nullable error))completionBlock;
 
+/**
+ * Fetches multiple ZDCUser's from the database. Any that are missing are automatically downloaded.
+ *
+ * This is more efficient than invoking `fetchUserWithID:requesterID:completionQueue:completionBlock:` for each user.
+ * The downloads are performed concurrently (with a bounded number of users in flight at any one time),
+ * and all the downloaded users (along with their public keys) are stored in the database within a single transaction.
+ * Users that are already being downloaded (via either method) aren't downloaded twice.
+ *
+ * The download of each user involves the following steps:
+ * - Fetching the user's general information (region & bucket)
+ * - Fetching the user's linked identities
+ * - Fetching the user's public key
+ * - Checking the user's public key against the blockchain
+ *
+ * Each user succeeds or fails independently, exactly as with `fetchUserWithID:::`.
+ *
+ * @param remoteUserIDs
+ *   The userIDs of the users to fetch. (Duplicates are ignored.)
+ *
+ * @param localUserID
+ *   The localUserID who's making the request.
+ *   The network requests need to come from a localUser, as they need to be authenticated.
+ *
+ * @param completionQueue
+ *   The dispatch_queue on which to invoke the completionBlock.
+ *   If nil, the main thread will automatically be used.
+ *
+ * @param completionBlock
+ *   The block to invoke when every user has either been fetched, or has failed.
+ *   Both dictionaries are keyed by userID. (Anonymous userIDs are reported as kZDCAnonymousUserID.)
+ */
+- (void)fetchUsersWithIDs:(NSArray<NSString *> *)remoteUserIDs
+              requesterID:(NSString *)localUserID
+          completionQueue:(nullable dispatch_queue_t)completionQueue
+          completionBlock:(nullable void (^)(NSDictionary<NSString*, ZDCUser*> *remoteUsers,
+                                             NSDictionary<NSString*, NSError*> *errors))completionBlock;
+
 /**
  * In some situations, a user's public key may be missing.
  *
@@ -35,6 +35,11 @@
 #endif
 #pragma unused(zdcLogLevel)
 
+/**
+ * The maximum number of users that `fetchUsersWithIDs:::` downloads concurrently.
+ */
+static NSUInteger const kMaxConcurrentUserFetches = 8;
+
 
 @interface ZDCUserDisplay ()
 @property (nonatomic, readwrite, copy) NSString *displayName;
@@ -66,6 +71,7 @@
 	__weak ZeroDarkCloud *zdc;
 	
 	YapDatabaseConnection *internal_roConnection;
+	YapDatabaseConnection *internal_rwConnection;
 	ZDCAsyncCompletionDispatch *asyncCompletionDispatch;
 }
 
@@ -75,12 +81,22 @@
 }
 
 - (instancetype)initWithOwner:(ZeroDarkCloud *)inOwner
+{
+	return [self initWithOwner: inOwner
+	              roConnection: [inOwner.databaseManager internal_roConnection]
+	              rwConnection: [inOwner.databaseManager rwDatabaseConnection]];
+}
+
+- (instancetype)initWithOwner:(ZeroDarkCloud *)inOwner
+                 roConnection:(YapDatabaseConnection *)roConnection
+                 rwConnection:(YapDatabaseConnection *)rwConnection
 {
 	if ((self = [super init]))
 	{
 		zdc = inOwner;
 		
-		internal_roConnection = [zdc.databaseManager internal_roConnection];
+		internal_roConnection = roConnection;
+		internal_rwConnection = rwConnection;
 		asyncCompletionDispatch = [[ZDCAsyncCompletionDispatch alloc] init];
 	}
 	return self;
@@ -146,6 +162,113 @@
 	}];
 }
 
+/**
+ * See header file for description.
+ * Or view the api's online (for both Swift & Objective-C):
+ * https://apis.zerodark.cloud/Classes/ZDCUserManager.html
+ */
+- (void)fetchUsersWithIDs:(NSArray<NSString *> *)inRemoteUserIDs
+              requesterID:(NSString *)localUserID
+          completionQueue:(nullable dispatch_queue_t)completionQueue
+          completionBlock:(nullable void (^)(NSDictionary<NSString*, ZDCUser*> *remoteUsers,
+                                             NSDictionary<NSString*, NSError*> *errors))completionBlock
+{
+	ZDCLogAutoTrace();
+	
+	NSParameterAssert(inRemoteUserIDs != nil);
+	NSParameterAssert(localUserID != nil);
+	
+	localUserID = [localUserID copy];
+	
+	// Standardize the anonymous userIDs, and remove duplicates.
+	
+	NSMutableOrderedSet<NSString *> *remoteUserIDs = [NSMutableOrderedSet orderedSetWithCapacity:inRemoteUserIDs.count];
+	for (NSString *remoteUserID in inRemoteUserIDs)
+	{
+		if ([ZDCUser isAnonymousID:remoteUserID])
+			[remoteUserIDs addObject:kZDCAnonymousUserID];
+		else
+			[remoteUserIDs addObject:[remoteUserID copy]];
+	}
+	
+	NSMutableDictionary<NSString*, ZDCUser*> *results = [NSMutableDictionary dictionaryWithCapacity:remoteUserIDs.count];
+	NSMutableDictionary<NSString*, NSError*> *errors = [NSMutableDictionary dictionary];
+	
+	__weak typeof(self) weakSelf = self;
+	
+	[internal_roConnection asyncReadWithBlock:^(YapDatabaseReadTransaction *transaction) {
+		
+		for (NSString *remoteUserID in remoteUserIDs)
+		{
+			ZDCUser *user = [transaction objectForKey:remoteUserID inCollection:kZDCCollection_Users];
+			if (user) {
+				results[remoteUserID] = user;
+			}
+		}
+		
+	} completionQueue:dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0) completionBlock:^{
+		
+		__strong typeof(self) strongSelf = weakSelf;
+		if (strongSelf == nil) return;
+		
+		// Results are collected on a serial queue.
+		dispatch_queue_t resultsQueue = dispatch_queue_create("ZDCUserManager.fetchUsers", DISPATCH_QUEUE_SERIAL);
+		dispatch_group_t group = dispatch_group_create();
+		
+		NSMutableArray<NSString *> *ownedUserIDs = [NSMutableArray array];
+		
+		for (NSString *remoteUserID in remoteUserIDs)
+		{
+			if (results[remoteUserID]) continue;
+			
+			dispatch_group_enter(group);
+			
+			// We share the request key with `_fetchRemoteUserWithID:::`.
+			// So if the user is already being downloaded (by either method), we simply wait for the result.
+			
+			NSString *requestKey = [strongSelf fetchRemoteUserRequestKey:remoteUserID];
+			
+			void (^userCompletionBlock)(ZDCUser*, NSError*) = ^(ZDCUser *user, NSError *error){
+				
+				if (user)
+					results[remoteUserID] = user;
+				else if (error)
+					errors[remoteUserID] = error;
+				
+				dispatch_group_leave(group);
+			};
+			
+			NSUInteger requestCount =
+			  [strongSelf->asyncCompletionDispatch pushCompletionQueue: resultsQueue
+			                                           completionBlock: userCompletionBlock
+			                                                    forKey: requestKey];
+			
+			if (requestCount == 1) {
+				[ownedUserIDs addObject:remoteUserID];
+			}
+		}
+		
+		if (ownedUserIDs.count > 0)
+		{
+			[strongSelf _fetchRemoteUsersWithIDs: ownedUserIDs
+			                         requesterID: localUserID];
+		}
+		
+		dispatch_group_notify(group, resultsQueue, ^{
+			
+			if (completionBlock)
+			{
+				NSDictionary<NSString*, ZDCUser*> *remoteUsers = [results copy];
+				NSDictionary<NSString*, NSError*> *remoteErrors = [errors copy];
+				
+				dispatch_async(completionQueue ?: dispatch_get_main_queue(), ^{ @autoreleasepool {
+					completionBlock(remoteUsers, remoteErrors);
+				}});
+			}
+		});
+	}];
+}
+
 /**
  * See header file for description.
  * Or view the api's online (for both Swift & Objective-C):
@@ -262,6 +385,7 @@
 
 /**
  * Internal method that handles the download flow.
+ * Consolidates concurrent requests for the same user, and then downloads it via `_fetchRemoteUsersWithIDs::`.
  */
 - (void)_fetchRemoteUserWithID:(NSString *)remoteUserID
                    requesterID:(NSString *)localUserID
@@ -279,18 +403,16 @@
 	// For example:
 	// "1ymbquw673gttwpb" => "anonymoususerid1"
 	//
-	BOOL isAnonymousUser = NO;
 	if ([ZDCUser isAnonymousID:remoteUserID])
 	{
 		remoteUserID = kZDCAnonymousUserID;
-		isAnonymousUser = YES;
 	}
 	
 	if (inCompletionBlock == nil) {
 		inCompletionBlock = ^(ZDCUser *user, NSError *error){};
 	}
 	
-	NSString *const requestKey = [NSString stringWithFormat:@"%@|%@", NSStringFromSelector(_cmd), remoteUserID];
+	NSString *const requestKey = [self fetchRemoteUserRequestKey:remoteUserID];
 	
 	NSUInteger requestCount =
 	  [asyncCompletionDispatch pushCompletionQueue: inCompletionQueue
@@ -304,44 +426,118 @@
 		return;
 	}
 	
-	__weak typeof(self) weakSelf = self;
+	// A single user is simply a batch of one.
+	// This way both methods share the same steps (and the same failure handling).
 	
-	void (^InvokeCompletionBlocks)(ZDCUser*, NSError*) = ^(ZDCUser *user, NSError *error){ @autoreleasepool {
-		
-		__strong typeof(self) strongSelf = weakSelf;
-		if (strongSelf == nil) return;
+	[self _fetchRemoteUsersWithIDs:@[ remoteUserID ] requesterID:localUserID];
+}
+
+/**
+ * The request key used (by both `_fetchRemoteUserWithID:::` & `_fetchRemoteUsersWithIDs::`)
+ * to consolidate concurrent downloads of the same user.
+ */
+- (NSString *)fetchRemoteUserRequestKey:(NSString *)remoteUserID
+{
+	SEL selector = @selector(_fetchRemoteUserWithID:requesterID:completionQueue:completionBlock:);
+	return [NSString stringWithFormat:@"%@|%@", NSStringFromSelector(selector), remoteUserID];
+}
+
+/**
+ * Pops & invokes all the completionBlocks that are waiting on the given request.
+ */
+- (void)invokeCompletionBlocksForRequestKey:(NSString *)requestKey user:(ZDCUser *)user error:(NSError *)error
+{
+	NSArray<dispatch_queue_t> * completionQueues = nil;
+	NSArray<id>               * completionBlocks = nil;
+	[asyncCompletionDispatch popCompletionQueues: &completionQueues
+	                            completionBlocks: &completionBlocks
+	                                      forKey: requestKey];
+	
+	for (NSUInteger i = 0; i < completionBlocks.count; i++)
+	{
+		dispatch_queue_t completionQueue = completionQueues[i];
+		void (^completionBlock)(ZDCUser*, NSError*) = completionBlocks[i];
 		
-		NSArray<dispatch_queue_t> * completionQueues = nil;
-		NSArray<id>               * completionBlocks = nil;
-		[strongSelf->asyncCompletionDispatch popCompletionQueues: &completionQueues
-		                                        completionBlocks: &completionBlocks
-		                                                  forKey: requestKey];
+		dispatch_async(completionQueue, ^{ @autoreleasepool {
+			completionBlock(user, error);
+		}});
+	}
+}
+
+/**
+ * Internal method that handles the download flow for one or more users.
+ * Used by both `fetchUserWithID:::` (as a batch of one) & `fetchUsersWithIDs:::`.
+ *
+ * Up to kMaxConcurrentUserFetches users are in flight at any one time,
+ * and each runs through the steps independently (so the steps are pipelined across users).
+ * Once every user has completed, the results are stored in the database within a single transaction.
+ *
+ * The caller must have already registered each remoteUserID with the asyncCompletionDispatch
+ * (using `fetchRemoteUserRequestKey:`), and be the owner of each request.
+ */
+- (void)_fetchRemoteUsersWithIDs:(NSArray<NSString *> *)remoteUserIDs
+                     requesterID:(NSString *)localUserID
+{
+	ZDCLogAutoTrace();
+	
+	NSParameterAssert(remoteUserIDs.count > 0);
+	NSParameterAssert(localUserID != nil);
+	
+	__weak typeof(self) weakSelf = self;
+	
+	dispatch_queue_t concurrentQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+	dispatch_queue_t batchQueue = dispatch_queue_create("ZDCUserManager.batch", DISPATCH_QUEUE_SERIAL);
+	
+	// The following variables are only accessed from within the batchQueue.
+	
+	NSMutableDictionary<NSString*, ZDCUser*> *fetchedUsers = [NSMutableDictionary dictionaryWithCapacity:remoteUserIDs.count];
+	NSMutableDictionary<NSString*, ZDCPublicKey*> *fetchedPubKeys = [NSMutableDictionary dictionaryWithCapacity:remoteUserIDs.count];
+	NSMutableDictionary<NSString*, NSError*> *errors = [NSMutableDictionary dictionary];
+	
+	__block NSUInteger nextIndex = 0;
+	__block NSUInteger activeCount = 0;
+	
+	__block void (^startNext)(void);
+	__block void (^fetchBasicInfo)(NSString *remoteUserID);
+	__block void (^fetchAuth0Info)(ZDCUser *user);
+	__block void (^fetchPubKey)(ZDCUser *user);
+	__block void (^fetchBlockchainProof)(ZDCUser *user, ZDCPublicKey *pubKey);
+	__block void (^didFinishUser)(NSString *remoteUserID, ZDCUser *user, ZDCPublicKey *pubKey, NSError *error);
+	__block void (^storeUsersInDatabase)(void);
+	
+	// Starts downloading the next user(s), if we're below the concurrency limit.
+	// Must be invoked on the batchQueue.
+	//
+	startNext = ^void (){ @autoreleasepool {
 		
-		for (NSUInteger i = 0; i < completionBlocks.count; i++)
+		while ((activeCount < kMaxConcurrentUserFetches) && (nextIndex < remoteUserIDs.count))
 		{
-			dispatch_queue_t completionQueue = completionQueues[i];
-			void (^completionBlock)(ZDCUser*, NSError*) = completionBlocks[i];
+			NSString *remoteUserID = remoteUserIDs[nextIndex];
+			nextIndex++;
+			activeCount++;
 			
-			dispatch_async(completionQueue, ^{ @autoreleasepool {
-				completionBlock(user, error);
-			}});
+			dispatch_async(concurrentQueue, ^{
+				
+				if ([remoteUserID isEqualToString:kZDCAnonymousUserID])
+				{
+					ZDCUser *user = [[ZDCUser alloc] initWithUUID:kZDCAnonymousUserID];
+					didFinishUser(remoteUserID, user, nil, nil);
+				}
+				else
+				{
+					fetchBasicInfo(remoteUserID);
+				}
+			});
 		}
 	}};
-
-	__block void (^fetchBasicInfo)(void);
-	__block void (^fetchAuth0Info)(ZDCUser *user);
-	__block void (^storeUserInDatabase)(ZDCUser *user);
-	__block void (^createAnonymousUser)(void);
-	
-	dispatch_queue_t concurrentQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
 	
-	// STEP 1 of 3:
+	// STEP 1 of 5:
 	//
 	// Fetch basic info about the user including:
 	// - region
 	// - bucket
 	//
-	fetchBasicInfo = ^void (){ @autoreleasepool {
+	fetchBasicInfo = ^void (NSString *remoteUserID){ @autoreleasepool {
 		
 		[weakSelf _fetchRemoteUser: remoteUserID
 		               requesterID: localUserID
@@ -350,119 +546,232 @@
 		{
 			if (error)
 			{
-				InvokeCompletionBlocks(nil, error);
+				didFinishUser(remoteUserID, nil, nil, error);
+				return;
+			}
+			
+			if (user.accountDeleted)
+			{
+				// Nothing else to fetch
+				didFinishUser(remoteUserID, user, nil, nil);
 				return;
 			}
 			
 			fetchAuth0Info(user);
 		}];
 	}};
-
-	// STEP 2 of 3:
+	
+	// STEP 2 of 5:
 	//
 	// Fetch auth0 user profiles
 	//
 	fetchAuth0Info = ^void (ZDCUser *user){ @autoreleasepool {
-
-		ZDCLogVerbose(@"fetchAuth0Info() - %@", remoteUserID);
-		NSAssert(user != nil, @"Bad state");
 		
-		[weakSelf _fetchFilteredAuth0Profile: remoteUserID
+		ZDCLogVerbose(@"fetchAuth0Info() - %@", user.uuid);
+		
+		[weakSelf _fetchFilteredAuth0Profile: user.uuid
 		                         requesterID: localUserID
 		                     completionQueue: concurrentQueue
 		                     completionBlock:^(ZDCUserProfile *profile, NSError *error)
 		{
 			if (error)
 			{
-				InvokeCompletionBlocks(nil, error);
+				didFinishUser(user.uuid, nil, nil, error);
 				return;
 			}
 			
 			user.identities = profile.identities;
 			user.lastRefresh_profile = [NSDate date];
 			
-			storeUserInDatabase(user);
+			fetchPubKey(user);
 		}];
 	}};
-
-	// STEP 3 of 3:
+	
+	// STEP 3 of 5:
 	//
-	// Store the user in the database (if needed).
+	// Fetch the user's pubKey.
+	// We don't store a user without its pubKey, so errors here are fatal (same as the previous steps).
 	//
-	storeUserInDatabase = ^void (ZDCUser *user){ @autoreleasepool {
+	fetchPubKey = ^void (ZDCUser *user){ @autoreleasepool {
 		
-		ZDCLogVerbose(@"storeUserInDatabase() - %@", remoteUserID);
-		NSAssert(user != nil, @"Bad state");
+		ZDCLogVerbose(@"fetchPubKey() - %@", user.uuid);
 		
-		YapDatabaseConnection *rwConnection = nil;
+		[weakSelf _fetchPubKeyForUser: user
+		                  requesterID: localUserID
+		              completionQueue: concurrentQueue
+		              completionBlock:^(ZDCPublicKey *pubKey, NSError *error)
 		{
-			__strong typeof(self) strongSelf = weakSelf;
-			if (strongSelf) {
-				rwConnection = strongSelf->zdc.databaseManager.rwDatabaseConnection;
+			if (error || !pubKey)
+			{
+				if (error == nil) {
+					error = [ZDCUserManager errorWithStatusCode:0 description:@"Missing public key"];
+				}
+				
+				didFinishUser(user.uuid, nil, nil, error);
+				return;
 			}
-		}
+			
+			fetchBlockchainProof(user, pubKey);
+		}];
+	}};
+	
+	// STEP 4 of 5:
+	//
+	// Attempt to verify the pubKey against the blockchain information.
+	// (EthereumRPC batches the queries from concurrent users.)
+	//
+	fetchBlockchainProof = ^void (ZDCUser *user, ZDCPublicKey *pubKey){ @autoreleasepool {
 		
-		__block ZDCUser *databaseUser = nil;
+		ZDCLogVerbose(@"fetchBlockchainProof() - %@", user.uuid);
 		
-		[rwConnection asyncReadWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+		[weakSelf _fetchBlockchainProofForUserID: user.uuid
+		                         completionQueue: concurrentQueue
+		                         completionBlock:^(ZDCBlockchainProof *proof, NSError *blockchainError)
+		{
+			BOOL accountBlocked = NO;
+			BOOL didRefreshBlockchain = NO;
 			
-			ZDCUser *existingUser = [transaction objectForKey:remoteUserID inCollection:kZDCCollection_Users];
-			if (existingUser)
+			if (blockchainError)
 			{
-				databaseUser = existingUser;
+				BlockchainErrorCode code = blockchainError.code;
+				switch (code)
+				{
+					case BlockchainErrorCode_NoBlockchainEntry     : didRefreshBlockchain = YES; break;
+					case BlockchainErrorCode_NetworkError          : break;
+					case BlockchainErrorCode_MissingMerkleTreeFile : break;
+					case BlockchainErrorCode_MerkleTreeTampering   : didRefreshBlockchain = accountBlocked = YES; break;
+				}
 			}
 			else
 			{
-				[transaction setObject:user forKey:user.uuid inCollection:kZDCCollection_Users];
-				databaseUser = user;
+				didRefreshBlockchain = YES;
+				
+				if (![pubKey.pubKey isEqual:proof.merkleTreeFile_pubKey] ||
+				    ![pubKey.keyID isEqual:proof.merkleTreeFile_keyID]  )
+				{
+					accountBlocked = YES;
+				}
 			}
 			
-		/*	ZDCPublicKey *existingPubKey =
-			  [transaction objectForKey: databaseUser.publicKeyID
-			               inCollection: kZDCCollection_PublicKeys];
+			user.publicKeyID = pubKey.uuid;
+			user.blockchainProof = proof;
+			user.accountBlocked = accountBlocked;
+			
+			if (didRefreshBlockchain) {
+				user.lastRefresh_blockchain = [NSDate date];
+			}
 			
-			if (!existingPubKey && pubKey)
+			didFinishUser(user.uuid, user, pubKey, nil);
+		}];
+	}};
+	
+	didFinishUser = ^void (NSString *remoteUserID, ZDCUser *user, ZDCPublicKey *pubKey, NSError *error){
+		
+		dispatch_async(batchQueue, ^{ @autoreleasepool {
+			
+			if (user) fetchedUsers[remoteUserID] = user;
+			if (pubKey) fetchedPubKeys[remoteUserID] = pubKey;
+			if (error) errors[remoteUserID] = error;
+			
+			activeCount--;
+			
+			if (nextIndex < remoteUserIDs.count) {
+				startNext();
+			}
+			else if (activeCount == 0)
 			{
-				[transaction setObject:pubKey forKey:pubKey.uuid inCollection:kZDCCollection_PublicKeys];
+				void (^finish)(void) = storeUsersInDatabase;
+				
+				// Break the retain cycles between the blocks
+				startNext = nil;
+				fetchBasicInfo = nil;
+				fetchAuth0Info = nil;
+				fetchPubKey = nil;
+				fetchBlockchainProof = nil;
+				didFinishUser = nil;
+				storeUsersInDatabase = nil;
+				
+				finish();
+			}
+		}});
+	};
+	
+	// STEP 5 of 5:
+	//
+	// Store all the users & pubKeys in the database (if needed).
+	//
+	storeUsersInDatabase = ^void (){ @autoreleasepool {
+		
+		ZDCLogVerbose(@"storeUsersInDatabase() - %lu users", (unsigned long)fetchedUsers.count);
+		
+		YapDatabaseConnection *rwConnection = nil;
+		{
+			__strong typeof(self) strongSelf = weakSelf;
+			if (strongSelf) {
+				rwConnection = strongSelf->internal_rwConnection;
+			}
+		}
+		
+		NSMutableDictionary<NSString*, ZDCUser*> *databaseUsers =
+		  [NSMutableDictionary dictionaryWithCapacity:fetchedUsers.count];
+		
+		[rwConnection asyncReadWriteWithBlock:^(YapDatabaseReadWriteTransaction *transaction) {
+			
+			[fetchedUsers enumerateKeysAndObjectsUsingBlock:^(NSString *remoteUserID, ZDCUser *user, BOOL *stop) {
+				
+				ZDCPublicKey *pubKey = fetchedPubKeys[remoteUserID];
+				ZDCUser *existingUser = [transaction objectForKey:remoteUserID inCollection:kZDCCollection_Users];
 				
-				if (![pubKey.uuid isEqualToString:databaseUser.publicKeyID])
+				if (existingUser)
 				{
-					// Two possibilities here:
-					// - databaseUser.publicKey is nil
-					// - databaseUser.publicKey is invalid
+					// The user was added to the database while we were downloading.
+					// We don't overwrite it, but we can fill in a missing pubKey.
 					
-					databaseUser = [databaseUser copy];
-					databaseUser.publicKeyID = pubKey.uuid;
+					if (pubKey && !existingUser.isLocal && !existingUser.publicKeyID)
+					{
+						[transaction setObject:pubKey forKey:pubKey.uuid inCollection:kZDCCollection_PublicKeys];
+						
+						existingUser = [existingUser copy];
+						existingUser.publicKeyID = pubKey.uuid;
+						existingUser.blockchainProof = user.blockchainProof;
+						existingUser.accountBlocked = user.accountBlocked;
+						existingUser.lastRefresh_blockchain = user.lastRefresh_blockchain;
+						
+						[transaction setObject:existingUser forKey:remoteUserID inCollection:kZDCCollection_Users];
+					}
 					
-					[transaction setObject: databaseUser
-					                forKey: databaseUser.uuid
-					          inCollection: kZDCCollection_Users];
+					databaseUsers[remoteUserID] = existingUser;
 				}
-			}
-		*/
+				else
+				{
+					if (pubKey) {
+						[transaction setObject:pubKey forKey:pubKey.uuid inCollection:kZDCCollection_PublicKeys];
+					}
+					
+					[transaction setObject:user forKey:remoteUserID inCollection:kZDCCollection_Users];
+					databaseUsers[remoteUserID] = user;
+				}
+			}];
 			
 		} completionQueue:concurrentQueue completionBlock:^{
-
-			InvokeCompletionBlocks(databaseUser, nil);
+			
+			__strong typeof(self) strongSelf = weakSelf;
+			
+			for (NSString *remoteUserID in remoteUserIDs)
+			{
+				NSString *requestKey = [strongSelf fetchRemoteUserRequestKey:remoteUserID];
+				
+				[strongSelf invokeCompletionBlocksForRequestKey: requestKey
+				                                           user: databaseUsers[remoteUserID]
+				                                          error: errors[remoteUserID]];
+			}
 		}];
 	}};
 	
-	// Alternative flow for anonymous userID's
-	//
-	createAnonymousUser = ^{ @autoreleasepool {
-		
-		ZDCUser *user = [[ZDCUser alloc] initWithUUID:kZDCAnonymousUserID];
-		
-		// Next step
-		storeUserInDatabase(user);
-	}};
-	
-	if (isAnonymousUser) {
-		createAnonymousUser();
-	}
-	else {
-		fetchBasicInfo();
-	}
+	// Start process
+	dispatch_async(batchQueue, ^{
+		startNext();
+	});
 }
 
 - (void)_fetchPublicKey:(ZDCUser *)inRemoteUser
@@ -1065,6 +1374,26 @@
 	}];
 }
 
+- (void)_fetchPubKeyForUser:(ZDCUser *)user
+                requesterID:(NSString *)localUserID
+            completionQueue:(dispatch_queue_t)completionQueue
+            completionBlock:(void (^)(ZDCPublicKey *_Nullable pubKey, NSError *_Nullable error))completionBlock
+{
+	[zdc.restManager fetchPubKeyForUser: user
+	                        requesterID: localUserID
+	                    completionQueue: completionQueue
+	                    completionBlock: completionBlock];
+}
+
+- (void)_fetchBlockchainProofForUserID:(NSString *)userID
+                       completionQueue:(dispatch_queue_t)completionQueue
+                       completionBlock:(void (^)(ZDCBlockchainProof *_Nullable proof, NSError *_Nullable error))completionBlock
+{
+	[zdc.blockchainManager fetchBlockchainProofForUserID: userID
+	                                     completionQueue: completionQueue
+	                                     completionBlock: completionBlock];
+}
+
 - (void)_fetchFilteredAuth0Profile:(NSString *)remoteUserID
                        requesterID:(NSString *)localUserID
                    completionQueue:(dispatch_queue_t)completionQueue
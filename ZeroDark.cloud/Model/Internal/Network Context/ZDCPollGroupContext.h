@@ -0,0 +1,32 @@
+/**
+ * ZeroDark.cloud
+ *
+ * Homepage      : https://www.zerodark.cloud
+ * GitHub        : https://github.com/4th-ATechnologies/ZeroDark.cloud
+ * Documentation : https://zerodarkcloud.readthedocs.io/en/latest/
+ * API Reference : https://apis.zerodark.cloud
+**/
+
+#import <Foundation/Foundation.h>
+
+#import "AWSRegions.h"
+#import "ZDCPollContext.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Utility class used by the PushManager.
+ *
+ * Represents a single (aggregated) poll request, covering multiple operations.
+ * It gets associated with the background task, so the poll can be recovered after an app relaunch.
+**/
+@interface ZDCPollGroupContext : ZDCObject <NSCoding, NSCopying>
+
+@property (nonatomic, copy, readwrite) NSString *localUserID;
+@property (nonatomic, assign, readwrite) AWSRegion region;
+
+@property (nonatomic, copy, readwrite) NSArray<ZDCPollContext *> *pollContexts;
+
+@end
+
+NS_ASSUME_NONNULL_END
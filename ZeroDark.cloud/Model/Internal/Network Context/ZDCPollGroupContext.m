@@ -0,0 +1,74 @@
+/**
+ * ZeroDark.cloud
+ *
+ * Homepage      : https://www.zerodark.cloud
+ * GitHub        : https://github.com/4th-ATechnologies/ZeroDark.cloud
+ * Documentation : https://zerodarkcloud.readthedocs.io/en/latest/
+ * API Reference : https://apis.zerodark.cloud
+**/
+
+#import "ZDCPollGroupContext.h"
+
+static int const kCurrentVersion = 0;
+#pragma unused(kCurrentVersion)
+
+static NSString *const k_version      = @"version";
+static NSString *const k_localUserID  = @"localUserID";
+static NSString *const k_regionStr    = @"regionStr";
+static NSString *const k_pollContexts = @"pollContexts";
+
+
+@implementation ZDCPollGroupContext
+
+@synthesize localUserID = localUserID;
+@synthesize region = region;
+@synthesize pollContexts = pollContexts;
+
+- (id)initWithCoder:(NSCoder *)decoder
+{
+	if ((self = [super init]))
+	{
+		localUserID = [decoder decodeObjectForKey:k_localUserID];
+		region = [AWSRegions regionForName:[decoder decodeObjectForKey:k_regionStr]];
+		pollContexts = [decoder decodeObjectForKey:k_pollContexts];
+	}
+	return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder
+{
+	if (kCurrentVersion != 0) {
+		[coder encodeInt:kCurrentVersion forKey:k_version];
+	}
+	
+	[coder encodeObject:localUserID forKey:k_localUserID];
+	[coder encodeObject:[AWSRegions shortNameForRegion:region] forKey:k_regionStr];
+	[coder encodeObject:pollContexts forKey:k_pollContexts];
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+	ZDCPollGroupContext *copy = [super copyWithZone:zone]; // [ZDCObject copyWithZone:]
+	
+	copy->localUserID = localUserID;
+	copy->region = region;
+	copy->pollContexts = pollContexts;
+	
+	return copy;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark ZDCObject
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (void)makeImmutable
+{
+	[super makeImmutable];
+	
+	for (ZDCPollContext *pollContext in pollContexts)
+	{
+		[pollContext makeImmutable];
+	}
+}
+
+@end
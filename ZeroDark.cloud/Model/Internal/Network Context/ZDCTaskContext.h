@@ -53,6 +53,9 @@
 @property (nonatomic, copy, readwrite) NSSet<NSUUID *> *duplicateOpUUIDs;
 @property (nonatomic, copy, readwrite) NSString *sha256Hash;
 
+// The requestID of the in-flight request (set by the PushManager when the task is started)
+@property (nonatomic, copy, readwrite) NSString *requestID;
+
 // Ephemeral properties
 
 @property (nonatomic, strong, readwrite) NSProgress *progress;
@@ -29,6 +29,7 @@ static NSString *const k_uploadFileURL        = @"uploadFileURL";
 static NSString *const k_deleteUploadFileURL  = @"deleteUploadFileURL";
 static NSString *const k_duplicateOpUUIDs     = @"matchingOpUUIDs";
 static NSString *const k_sha256Hash           = @"sha256Hash";
+static NSString *const k_requestID            = @"requestID";
 
 
 @implementation ZDCTaskContext
@@ -58,6 +59,7 @@ static NSString *const k_sha256Hash           = @"sha256Hash";
 
 @synthesize duplicateOpUUIDs = duplicateOpUUIDs;
 @synthesize sha256Hash = sha256Hash;
+@synthesize requestID = requestID;
 @synthesize progress = progress;
 
 
@@ -101,6 +103,7 @@ static NSString *const k_sha256Hash           = @"sha256Hash";
 		
 		duplicateOpUUIDs = [decoder decodeObjectForKey:k_duplicateOpUUIDs];
 		sha256Hash = [decoder decodeObjectForKey:k_sha256Hash];
+		requestID = [decoder decodeObjectForKey:k_requestID];
 	}
 	return self;
 }
@@ -131,6 +134,7 @@ static NSString *const k_sha256Hash           = @"sha256Hash";
 	
 	[coder encodeObject:duplicateOpUUIDs forKey:k_duplicateOpUUIDs];
 	[coder encodeObject:sha256Hash forKey:k_sha256Hash];
+	[coder encodeObject:requestID forKey:k_requestID];
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -164,6 +168,7 @@ static NSString *const k_sha256Hash           = @"sha256Hash";
 	
 	copy->duplicateOpUUIDs = duplicateOpUUIDs;
 	copy->sha256Hash = sha256Hash;
+	copy->requestID = requestID;
 	copy->progress = progress;
 	
 	return copy;
@@ -78,4 +78,19 @@
  */
 - (ZDCChangeItem *)popNextPendingChange:(NSOrderedSet<NSString *> **)outChangeIDs;
 
+/**
+ * Same as `popNextPendingChange:`, but starts at the given pending change (instead of the first one).
+ * This allows changes to be processed out-of-order (e.g. concurrently).
+ *
+ * It's the caller's responsibility to ensure the given change doesn't depend on any of the changes before it.
+ * The optimization engine only merges changes for the same fileID (or avatar path).
+ */
+- (ZDCChangeItem *)popPendingChange:(ZDCChangeItem *)change changeIDs:(NSOrderedSet<NSString *> **)outChangeIDs;
+
+/**
+ * Enumerates the pending changes (in order),
+ * excluding any changes that have already been processed (out-of-order).
+ */
+- (void)enumeratePendingChangesUsingBlock:(void (^NS_NOESCAPE)(ZDCChangeItem *change, BOOL *stop))block;
+
 @end
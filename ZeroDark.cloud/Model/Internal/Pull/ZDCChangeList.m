@@ -21,16 +21,34 @@ static NSString *const k_skippedPendingChangeIDs  = @"skippedPendingChangeIDs";
 //
 @property (nonatomic, copy, readwrite) NSArray<ZDCChangeItem *> *pendingChanges;
 @property (nonatomic, copy, readwrite) NSSet<NSString *> *skippedPendingChangeIDs;
+
+// The changes at indexes [0, pendingChangesOffset) have already been processed.
+// This allows us to pop changes off the front without rewriting the array.
+// (Not persisted - the array is trimmed during encoding.)
+//
+@property (nonatomic, assign, readwrite) NSUInteger pendingChangesOffset;
 @end
 
 
 @implementation ZDCChangeList
+{
+	// Index of pendingChanges, rebuilt whenever the array is replaced.
+	// The values are indexes into pendingChanges (in ascending order).
+	//
+	// These are never mutated after being built,
+	// so they can be safely shared between copies.
+	
+	NSDictionary<NSString *, NSArray<NSNumber *> *> *changeIndexesByFileID;
+	NSDictionary<NSString *, NSArray<NSNumber *> *> *avatarChangeIndexesByPath;
+	NSDictionary<NSString *, NSNumber *> *changeIndexesByID;
+}
 
 @synthesize latestChangeID_local = latestChangeID_local;
 @synthesize latestChangeID_remote = latestChangeID_remote;
 
 @synthesize pendingChanges = pendingChanges;
 @synthesize skippedPendingChangeIDs = skippedPendingChangeIDs;
+@synthesize pendingChangesOffset = pendingChangesOffset;
 
 - (instancetype)initWithLatestChangeID_remote:(NSString *)_latestChangeID_remote
 {
@@ -78,6 +96,8 @@ static NSString *const k_skippedPendingChangeIDs  = @"skippedPendingChangeIDs";
 		}
 		
 		skippedPendingChangeIDs = [decoder decodeObjectForKey:k_skippedPendingChangeIDs];
+		
+		[self indexPendingChanges];
 	}
 	return self;
 }
@@ -91,7 +111,7 @@ static NSString *const k_skippedPendingChangeIDs  = @"skippedPendingChangeIDs";
 	[coder encodeObject:latestChangeID_local forKey:k_latestChangeID_local];
 	[coder encodeObject:latestChangeID_remote forKey:k_latestChangeID_remote];
 	
-	[coder encodeObject:pendingChanges forKey:k_pendingChanges];
+	[coder encodeObject:[self remainingPendingChanges] forKey:k_pendingChanges];
 	[coder encodeObject:skippedPendingChangeIDs forKey:k_skippedPendingChangeIDs];
 }
 
@@ -108,10 +128,118 @@ static NSString *const k_skippedPendingChangeIDs  = @"skippedPendingChangeIDs";
 	
 	copy->pendingChanges = pendingChanges;
 	copy->skippedPendingChangeIDs = skippedPendingChangeIDs;
+	copy->pendingChangesOffset = pendingChangesOffset;
+	
+	copy->changeIndexesByFileID = changeIndexesByFileID;
+	copy->avatarChangeIndexesByPath = avatarChangeIndexesByPath;
+	copy->changeIndexesByID = changeIndexesByID;
 	
 	return copy;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Index
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Replacing the array resets the offset & rebuilds the index.
+ */
+- (void)setPendingChanges:(NSArray<ZDCChangeItem *> *)inPendingChanges
+{
+	pendingChanges = [inPendingChanges copy];
+	pendingChangesOffset = 0;
+	
+	[self indexPendingChanges];
+}
+
+- (void)indexPendingChanges
+{
+	NSString *const kUpdateAvatar = @"update-avatar";
+	
+	NSUInteger count = pendingChanges.count;
+	
+	NSMutableDictionary<NSString *, NSMutableArray<NSNumber *> *> *byFileID =
+	  [NSMutableDictionary dictionaryWithCapacity:count];
+	NSMutableDictionary<NSString *, NSMutableArray<NSNumber *> *> *avatarByPath =
+	  [NSMutableDictionary dictionary];
+	NSMutableDictionary<NSString *, NSNumber *> *byID =
+	  [NSMutableDictionary dictionaryWithCapacity:count];
+	
+	for (NSUInteger i = 0; i < count; i++)
+	{
+		ZDCChangeItem *change = pendingChanges[i];
+		NSNumber *index = @(i);
+		
+		NSString *fileID = change.fileID;
+		if (fileID)
+		{
+			NSMutableArray<NSNumber *> *indexes = byFileID[fileID];
+			if (indexes == nil) {
+				indexes = byFileID[fileID] = [NSMutableArray arrayWithCapacity:1];
+			}
+			[indexes addObject:index];
+		}
+		
+		NSString *path = change.path;
+		if (path && [change.command isEqualToString:kUpdateAvatar])
+		{
+			NSMutableArray<NSNumber *> *indexes = avatarByPath[path];
+			if (indexes == nil) {
+				indexes = avatarByPath[path] = [NSMutableArray arrayWithCapacity:1];
+			}
+			[indexes addObject:index];
+		}
+		
+		NSString *changeID = change.uuid;
+		if (changeID) {
+			byID[changeID] = index;
+		}
+	}
+	
+	changeIndexesByFileID = byFileID;
+	avatarChangeIndexesByPath = avatarByPath;
+	changeIndexesByID = byID;
+}
+
+/**
+ * Returns the changes that haven't been popped off the front yet.
+ */
+- (NSArray<ZDCChangeItem *> *)remainingPendingChanges
+{
+	if (pendingChangesOffset == 0) {
+		return pendingChanges;
+	}
+	
+	NSUInteger count = pendingChanges.count;
+	if (pendingChangesOffset >= count) {
+		return @[];
+	}
+	
+	return [pendingChanges subarrayWithRange:NSMakeRange(pendingChangesOffset, count - pendingChangesOffset)];
+}
+
+/**
+ * Returns the indexes (within the given bucket) that come after the given index.
+ */
+- (NSArray<NSNumber *> *)indexes:(NSArray<NSNumber *> *)bucket after:(NSUInteger)index
+{
+	NSRange range = NSMakeRange(0, bucket.count);
+	NSUInteger pos =
+	  [bucket indexOfObject: @(index)
+	          inSortedRange: range
+	                options: NSBinarySearchingInsertionIndex | NSBinarySearchingLastEqual
+	        usingComparator:^NSComparisonResult(NSNumber *a, NSNumber *b)
+	{
+		return [a compare:b];
+	}];
+	
+	if (pos >= bucket.count) {
+		return @[];
+	}
+	
+	return [bucket subarrayWithRange:NSMakeRange(pos, bucket.count - pos)];
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma mark Standard API
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -119,8 +247,9 @@ static NSString *const k_skippedPendingChangeIDs  = @"skippedPendingChangeIDs";
 - (BOOL)hasPendingChange
 {
 	BOOL found = NO;
-	for (ZDCChangeItem *change in pendingChanges)
+	for (NSUInteger i = pendingChangesOffset; i < pendingChanges.count; i++)
 	{
+		ZDCChangeItem *change = pendingChanges[i];
 		NSString *changeID = change.uuid;
 		if (![skippedPendingChangeIDs containsObject:changeID])
 		{
@@ -151,7 +280,7 @@ static NSString *const k_skippedPendingChangeIDs  = @"skippedPendingChangeIDs";
 		self.pendingChanges = changes;
 		self.latestChangeID_remote = latestChangeID;
 	}
-	else if (pendingChanges.count == 0)
+	else if (pendingChangesOffset >= pendingChanges.count)
 	{
 		// Defensive programming.
 		// We seem to have gotten into a bad state.
@@ -176,7 +305,7 @@ static NSString *const k_skippedPendingChangeIDs  = @"skippedPendingChangeIDs";
 		ZDCChangeItem *lastChange = [pendingChanges lastObject];
 		NSString *lastChangeID = lastChange.uuid;
 		
-		NSMutableArray<ZDCChangeItem *> *newPendingChanges = [pendingChanges mutableCopy];
+		NSMutableArray<ZDCChangeItem *> *newPendingChanges = [[self remainingPendingChanges] mutableCopy];
 		BOOL found = NO;
 		
 		for (ZDCChangeItem *change in changes)
@@ -203,41 +332,42 @@ static NSString *const k_skippedPendingChangeIDs  = @"skippedPendingChangeIDs";
 - (void)didProcessChangeIDs:(NSSet<NSString *> *)processedChangeIDs
 {
 	NSString *newLatestChangeID_local = latestChangeID_local;
-	NSMutableArray<ZDCChangeItem *> *newPendingChanges = [pendingChanges mutableCopy];
+	NSUInteger newOffset = pendingChangesOffset;
 	
 	NSMutableSet<NSString *> *newSkippedPendingChangeIDs = [skippedPendingChangeIDs mutableCopy];
 	if (newSkippedPendingChangeIDs == nil) {
 		newSkippedPendingChangeIDs = [[NSMutableSet alloc] init];
 	}
 	
-	NSUInteger i = 0;
-	while (i < newPendingChanges.count)
+	// Mark every processed change (that's still pending) as skipped.
+	// The ones at the front of the list get removed below.
+	
+	for (NSString *changeID in processedChangeIDs)
 	{
-		ZDCChangeItem *change = newPendingChanges[i];
-		NSString *changeID = change.uuid;
-		
-		if ([processedChangeIDs containsObject:changeID] ||
-		    [skippedPendingChangeIDs containsObject:changeID])
+		NSNumber *index = changeIndexesByID[changeID];
+		if (index && index.unsignedIntegerValue >= pendingChangesOffset)
 		{
-			if (i == 0)
-			{
-				[newPendingChanges removeObjectAtIndex:i];
-				[newSkippedPendingChangeIDs removeObject:changeID];
-				newLatestChangeID_local = changeID;
-			}
-			else
-			{
-				[newSkippedPendingChangeIDs addObject:changeID];
-				i++;
-			}
+			[newSkippedPendingChangeIDs addObject:changeID];
 		}
-		else
-		{
-			i++;
+	}
+	
+	// Pop every processed/skipped change off the front of the list.
+	
+	while (newOffset < pendingChanges.count)
+	{
+		ZDCChangeItem *change = pendingChanges[newOffset];
+		NSString *changeID = change.uuid;
+		
+		if (![newSkippedPendingChangeIDs containsObject:changeID]) {
+			break;
 		}
+		
+		[newSkippedPendingChangeIDs removeObject:changeID];
+		newLatestChangeID_local = changeID;
+		newOffset++;
 	}
 	
-	self.pendingChanges = newPendingChanges;
+	self.pendingChangesOffset = newOffset;
 	self.skippedPendingChangeIDs = newSkippedPendingChangeIDs;
 	self.latestChangeID_local = newLatestChangeID_local;
 }
@@ -254,17 +384,14 @@ static NSString *const k_skippedPendingChangeIDs  = @"skippedPendingChangeIDs";
 			self.latestChangeID_remote = newChangeID;
 		}
 		
-		if (pendingChanges.count > 0)
+		if (pendingChangesOffset < pendingChanges.count)
 		{
-			ZDCChangeItem *firstChange = [pendingChanges firstObject];
+			ZDCChangeItem *firstChange = pendingChanges[pendingChangesOffset];
 			NSString *firstChangeID = firstChange.uuid;
 			
 			if ([firstChangeID isEqualToString:oldChangeID])
 			{
-				NSMutableArray<ZDCChangeItem *> *newPendingChanges = [pendingChanges mutableCopy];
-				[newPendingChanges removeObjectAtIndex:0];
-				
-				self.pendingChanges = newPendingChanges;
+				self.pendingChangesOffset = pendingChangesOffset + 1;
 			}
 		}
 	}
@@ -287,7 +414,7 @@ static NSString *const k_skippedPendingChangeIDs  = @"skippedPendingChangeIDs";
 	
 	if ([latestChangeID_local isEqualToString:oldChangeID])
 	{
-		if (pendingChanges.count == 0)
+		if (pendingChangesOffset >= pendingChanges.count)
 		{
 			self.pendingChanges = @[ change ];
 		}
@@ -299,7 +426,7 @@ static NSString *const k_skippedPendingChangeIDs  = @"skippedPendingChangeIDs";
 		
 		if ([lastChangeID isEqualToString:oldChangeID])
 		{
-			NSMutableArray<ZDCChangeItem *> *newPendingChanges = [pendingChanges mutableCopy];
+			NSMutableArray<ZDCChangeItem *> *newPendingChanges = [[self remainingPendingChanges] mutableCopy];
 			[newPendingChanges addObject:change];
 			
 			self.pendingChanges = newPendingChanges;
@@ -324,6 +451,45 @@ static NSString *const k_skippedPendingChangeIDs  = @"skippedPendingChangeIDs";
  * You should ALWAYS use the returned outChangeIDs when invoking `didProcessChangeIDs`.
 **/
 - (ZDCChangeItem *)popNextPendingChange:(NSOrderedSet<NSString *> **)outChangeIDs
+{
+	return [self popPendingChangeAtIndex:pendingChangesOffset changeIDs:outChangeIDs];
+}
+
+/**
+ * See header file for description.
+ */
+- (ZDCChangeItem *)popPendingChange:(ZDCChangeItem *)change changeIDs:(NSOrderedSet<NSString *> **)outChangeIDs
+{
+	NSNumber *index = change.uuid ? changeIndexesByID[change.uuid] : nil;
+	if (index == nil || index.unsignedIntegerValue < pendingChangesOffset)
+	{
+		if (outChangeIDs) *outChangeIDs = nil;
+		return nil;
+	}
+	
+	return [self popPendingChangeAtIndex:index.unsignedIntegerValue changeIDs:outChangeIDs];
+}
+
+/**
+ * See header file for description.
+ */
+- (void)enumeratePendingChangesUsingBlock:(void (^NS_NOESCAPE)(ZDCChangeItem *change, BOOL *stop))block
+{
+	BOOL stop = NO;
+	for (NSUInteger i = pendingChangesOffset; i < pendingChanges.count; i++)
+	{
+		ZDCChangeItem *change = pendingChanges[i];
+		
+		if ([skippedPendingChangeIDs containsObject:change.uuid]) {
+			continue;
+		}
+		
+		block(change, &stop);
+		if (stop) break;
+	}
+}
+
+- (ZDCChangeItem *)popPendingChangeAtIndex:(NSUInteger)nextIndex changeIDs:(NSOrderedSet<NSString *> **)outChangeIDs
 {
 	// We implement minor optimizations available during a quick sync.
 	// At this point in time, it only implements the low-hanging fruit.
@@ -333,13 +499,14 @@ static NSString *const k_skippedPendingChangeIDs  = @"skippedPendingChangeIDs";
 	// This is due largely to the complexity of analyzing all the possible
 	// combinations of changes that could potentially be in the queue.
 	
-	ZDCChangeItem *nextChange = [pendingChanges firstObject];
-	if (nextChange == nil)
+	if (nextIndex >= pendingChanges.count)
 	{
 		if (outChangeIDs) *outChangeIDs = nil;
 		return nil;
 	}
 	
+	ZDCChangeItem *nextChange = pendingChanges[nextIndex];
+	
 	NSMutableOrderedSet *allChangeIDs = [[NSMutableOrderedSet alloc] init]; // all changes for node (rcrd & data)
 	NSMutableOrderedSet *effectiveChangeIDs = [[NSMutableOrderedSet alloc] init]; // only changes for mergedChange
 	
@@ -356,17 +523,29 @@ static NSString *const k_skippedPendingChangeIDs  = @"skippedPendingChangeIDs";
 	NSString *requiredFileID = nextChange.fileID;
 	ZDCMutableChangeItem *mergedChange = [nextChange mutableCopy];
 	
-	for (NSUInteger i = 1; i < pendingChanges.count; i++)
+	// Only changes for the same fileID can be merged with this one.
+	// So rather than scanning the entire list, we only visit the fileID's bucket.
+	//
+	// Changes without a fileID (e.g. update-avatar) are bucketed by path instead.
+	
+	NSArray<NSNumber *> *candidateIndexes = nil;
+	if (requiredFileID)
 	{
-		ZDCChangeItem *change = pendingChanges[i];
+		candidateIndexes = [self indexes:changeIndexesByFileID[requiredFileID] after:nextIndex];
+	}
+	else if ([nextChange.command isEqualToString:kUpdateAvatar] && nextChange.path)
+	{
+		candidateIndexes = [self indexes:avatarChangeIndexesByPath[nextChange.path] after:nextIndex];
+	}
+	else
+	{
+		// Other commands without a fileID (e.g. update-auth0) are not mergeable.
+		candidateIndexes = @[];
+	}
 		
-		if (requiredFileID && ![change.fileID isEqualToString:requiredFileID])
-		{
-			// Change is for a different fileID.
-			// Thus it can't be merged with this one.
-			
-			continue;
-		}
+	for (NSNumber *candidateIndex in candidateIndexes)
+	{
+		ZDCChangeItem *change = pendingChanges[candidateIndex.unsignedIntegerValue];
 		
 		NSString *commandA = mergedChange.command;
 		NSString *commandB =       change.command;
@@ -640,7 +819,7 @@ static NSString *const k_skippedPendingChangeIDs  = @"skippedPendingChangeIDs";
 			break;
 		}
 		
-	} // end: for (NSUInteger i = 1; i < pendingChanges.count; i++)
+	} // end: for (NSNumber *candidateIndex in candidateIndexes)
 	
 	if (outChangeIDs) *outChangeIDs = effectiveChangeIDs;
 	return [mergedChange copy];
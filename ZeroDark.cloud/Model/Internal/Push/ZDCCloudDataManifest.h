@@ -0,0 +1,63 @@
+/**
+ * ZeroDark.cloud
+ *
+ * Homepage      : https://www.zerodark.cloud
+ * GitHub        : https://github.com/4th-ATechnologies/ZeroDark.cloud
+ * Documentation : https://zerodarkcloud.readthedocs.io/en/latest/
+ * API Reference : https://apis.zerodark.cloud
+**/
+
+#import <Foundation/Foundation.h>
+#import <YapDatabase/YapDatabaseRelationship.h>
+#import <ZDCSyncableObjC/ZDCObject.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Describes the layout of a node's DATA cloud file, as it was last uploaded via multipart.
+ *
+ * The PushManager stores one of these (keyed by nodeID) after a multipart upload completes.
+ * The next time the node's data is pushed (again via multipart, with the same chunkSize),
+ * any part whose checksum hasn't changed is copied server-side from the existing cloud file
+ * (S3 UploadPartCopy), instead of being encrypted, hashed & uploaded again.
+ *
+ * The manifest only describes the cloud file with the matching eTag.
+ * It's automatically deleted when the corresponding node is deleted.
+ */
+@interface ZDCCloudDataManifest : ZDCObject <NSCoding, NSCopying, YapDatabaseRelationshipNode>
+
+- (instancetype)initWithNodeID:(NSString *)nodeID
+                          eTag:(NSString *)eTag
+                 cloudFileSize:(uint64_t)cloudFileSize
+                     chunkSize:(uint64_t)chunkSize
+                     checksums:(NSDictionary<NSNumber*, NSString*> *)checksums;
+
+/** The node this manifest belongs to. */
+@property (nonatomic, copy, readonly) NSString *nodeID;
+
+/** The eTag of the cloud file that was uploaded. */
+@property (nonatomic, copy, readonly) NSString *eTag;
+
+/** The size of the uploaded cloud file (in bytes). */
+@property (nonatomic, assign, readonly) uint64_t cloudFileSize;
+
+/** The size of each part (excluding the last) of the multipart upload. */
+@property (nonatomic, assign, readonly) uint64_t chunkSize;
+
+/** Maps from part index (zero-based) to the lowercase hex SHA-256 of the part. */
+@property (nonatomic, copy, readonly) NSDictionary<NSNumber*, NSString*> *checksums;
+
+/**
+ * Compares the given (pending) multipart layout against the manifest.
+ *
+ * @return
+ *   The indexes (zero-based) of the parts whose content is identical in both layouts,
+ *   and which can therefore be copied from the existing cloud file.
+ *   Returns an empty set if the chunkSize differs (the parts wouldn't line up).
+ */
+- (NSIndexSet *)reusablePartsWithChunkSize:(uint64_t)chunkSize
+                                 checksums:(NSDictionary<NSNumber*, NSString*> *)checksums;
+
+@end
+
+NS_ASSUME_NONNULL_END
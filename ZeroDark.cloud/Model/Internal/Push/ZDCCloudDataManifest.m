@@ -0,0 +1,148 @@
+/**
+ * ZeroDark.cloud
+ *
+ * Homepage      : https://www.zerodark.cloud
+ * GitHub        : https://github.com/4th-ATechnologies/ZeroDark.cloud
+ * Documentation : https://zerodarkcloud.readthedocs.io/en/latest/
+ * API Reference : https://apis.zerodark.cloud
+**/
+
+#import "ZDCCloudDataManifest.h"
+#import "ZDCConstants.h"
+
+static int const kCurrentVersion = 0;
+#pragma unused(kCurrentVersion)
+
+static NSString *const k_version       = @"version";
+static NSString *const k_nodeID        = @"nodeID";
+static NSString *const k_eTag          = @"eTag";
+static NSString *const k_cloudFileSize = @"cloudFileSize";
+static NSString *const k_chunkSize     = @"chunkSize";
+static NSString *const k_checksums     = @"checksums";
+
+
+@implementation ZDCCloudDataManifest
+
+@synthesize nodeID = nodeID;
+@synthesize eTag = eTag;
+@synthesize cloudFileSize = cloudFileSize;
+@synthesize chunkSize = chunkSize;
+@synthesize checksums = checksums;
+
+- (instancetype)initWithNodeID:(NSString *)inNodeID
+                          eTag:(NSString *)inETag
+                 cloudFileSize:(uint64_t)inCloudFileSize
+                     chunkSize:(uint64_t)inChunkSize
+                     checksums:(NSDictionary<NSNumber*, NSString*> *)inChecksums
+{
+	if ((self = [super init]))
+	{
+		nodeID = [inNodeID copy];
+		eTag = [inETag copy];
+		cloudFileSize = inCloudFileSize;
+		chunkSize = inChunkSize;
+		checksums = [inChecksums copy];
+	}
+	return self;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark NSCoding
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (id)initWithCoder:(NSCoder *)decoder
+{
+	if ((self = [super init]))
+	{
+		nodeID = [decoder decodeObjectForKey:k_nodeID];
+		eTag = [decoder decodeObjectForKey:k_eTag];
+		
+		cloudFileSize = (uint64_t)[decoder decodeInt64ForKey:k_cloudFileSize];
+		chunkSize = (uint64_t)[decoder decodeInt64ForKey:k_chunkSize];
+		
+		checksums = [decoder decodeObjectForKey:k_checksums];
+	}
+	return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder
+{
+	if (kCurrentVersion != 0) {
+		[coder encodeInt:kCurrentVersion forKey:k_version];
+	}
+	
+	[coder encodeObject:nodeID forKey:k_nodeID];
+	[coder encodeObject:eTag forKey:k_eTag];
+	
+	[coder encodeInt64:(int64_t)cloudFileSize forKey:k_cloudFileSize];
+	[coder encodeInt64:(int64_t)chunkSize forKey:k_chunkSize];
+	
+	[coder encodeObject:checksums forKey:k_checksums];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark NSCopying
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (id)copyWithZone:(NSZone *)zone
+{
+	ZDCCloudDataManifest *copy = [super copyWithZone:zone]; // [ZDCObject copyWithZone:]
+	
+	copy->nodeID = nodeID;
+	copy->eTag = eTag;
+	copy->cloudFileSize = cloudFileSize;
+	copy->chunkSize = chunkSize;
+	copy->checksums = checksums;
+	
+	return copy;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Logic
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * See header file for description.
+ */
+- (NSIndexSet *)reusablePartsWithChunkSize:(uint64_t)inChunkSize
+                                 checksums:(NSDictionary<NSNumber*, NSString*> *)inChecksums
+{
+	NSMutableIndexSet *reusable = [NSMutableIndexSet indexSet];
+	
+	if (inChunkSize != chunkSize || chunkSize == 0) {
+		return reusable;
+	}
+	
+	// Since the chunkSize is the same, part N covers the same byte range in both files.
+	// So a matching checksum means matching content (including the length of the last part).
+	
+	[inChecksums enumerateKeysAndObjectsUsingBlock:^(NSNumber *part, NSString *checksum, BOOL *stop) {
+		
+		NSString *existing = checksums[part];
+		if (existing && [existing isEqualToString:checksum])
+		{
+			[reusable addIndex:[part unsignedIntegerValue]];
+		}
+	}];
+	
+	return reusable;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark YapDatabaseRelationshipNode protocol
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+- (NSArray<YapDatabaseRelationshipEdge *> *)yapDatabaseRelationshipEdges
+{
+	if (nodeID == nil) return nil;
+	
+	YapDatabaseRelationshipEdge *nodeEdge =
+	  [YapDatabaseRelationshipEdge edgeWithName: @"node"
+	                             destinationKey: nodeID
+	                                 collection: kZDCCollection_Nodes
+	                            nodeDeleteRules: YDB_DeleteSourceIfDestinationDeleted];
+	
+	return @[nodeEdge];
+}
+
+@end
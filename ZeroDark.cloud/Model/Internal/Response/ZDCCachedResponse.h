@@ -17,4 +17,14 @@
 @property (nonatomic, copy, readwrite) NSString *eTag;
 @property (nonatomic, copy, readwrite) NSDate *lastModified;
 
+/**
+ * If set, the cached data should no longer be served directly after this date.
+ * Instead it should be revalidated with the server (e.g. via "If-None-Match").
+ *
+ * The entry remains in the database until the uncacheDate,
+ * so the staleDate is generally earlier than the uncacheDate.
+ * If nil, the data is considered fresh until the uncacheDate.
+ */
+@property (nonatomic, copy, readwrite) NSDate *staleDate;
+
 @end
@@ -5,6 +5,7 @@ static NSString *const k_data         = @"data";
 static NSString *const k_uncacheDate  = @"uncacheDate";
 static NSString *const k_eTag         = @"eTag";
 static NSString *const k_lastModified = @"lastModified";
+static NSString *const k_staleDate    = @"staleDate";
 
 /**
  * Stores cached NSURLResponses in the (encrypted) database.
@@ -18,6 +19,7 @@ static NSString *const k_lastModified = @"lastModified";
 @synthesize uncacheDate = uncacheDate;
 @synthesize eTag = eTag;
 @synthesize lastModified = lastModified;
+@synthesize staleDate = staleDate;
 
 - (instancetype)initWithData:(NSData *)inData timeout:(NSTimeInterval)inTimeout
 {
@@ -37,6 +39,7 @@ static NSString *const k_lastModified = @"lastModified";
 		uncacheDate = [decoder decodeObjectForKey:k_uncacheDate];
 		eTag = [decoder decodeObjectForKey:k_eTag];
 		lastModified = [decoder decodeObjectForKey:k_lastModified];
+		staleDate = [decoder decodeObjectForKey:k_staleDate];
 	}
 	return self;
 }
@@ -47,6 +50,7 @@ static NSString *const k_lastModified = @"lastModified";
 	[coder encodeObject:uncacheDate  forKey:k_uncacheDate];
 	[coder encodeObject:eTag         forKey:k_eTag];
 	[coder encodeObject:lastModified forKey:k_lastModified];
+	[coder encodeObject:staleDate    forKey:k_staleDate];
 }
 
 - (id)copyWithZone:(NSZone *)zone
@@ -57,6 +61,7 @@ static NSString *const k_lastModified = @"lastModified";
 	copy->uncacheDate = uncacheDate;
 	copy->eTag = eTag;
 	copy->lastModified = lastModified;
+	copy->staleDate = staleDate;
 	
 	return copy;
 }
@@ -44,9 +44,31 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  * The size (in bytes) of the main data section within the cloud's data file.
  * This corresponds to `[ZeroDarkCloudDelegate dataForNode:atPath:transaction:]`.
+ *
+ * If the data section is compressed, this is the size after decompression
+ * (i.e. the size of the data your app provided). See `compressedDataSize`.
  */
 @property (nonatomic, assign, readonly) uint64_t dataSize;
 
+/**
+ * The compression scheme applied to the data section within the cloud's data file.
+ * Files written without compression report ZDCCloudFileCompression_None.
+ */
+@property (nonatomic, assign, readonly) ZDCCloudFileCompression compression;
+
+/**
+ * The size of each compressed block, expressed as a power of 2.
+ * Only valid if `compression` is something other than ZDCCloudFileCompression_None.
+ */
+@property (nonatomic, assign, readonly) uint8_t compressionBlockShift;
+
+/**
+ * The size (in bytes) the data section actually occupies within the cloud's data file.
+ * If the data section is compressed, this includes the block index.
+ * Otherwise it's the same as `dataSize`.
+ */
+@property (nonatomic, assign, readonly) uint64_t compressedDataSize;
+
 /**
  * It is often the case that a node's data will be updated in the cloud,
  * however the underlying thumbanil isn't changed.
@@ -66,6 +88,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 /**
  * Returns a raw struct version, which is used when storing the data in the cloudFile header.
+ * All the header fields (including the compression fields added in version 1) round-trip.
  */
 - (ZDCCloudFileHeader)rawHeader;
 
@@ -11,7 +11,7 @@
 
 // Encoding/Decoding Keys
 
-static int const kCurrentVersion = 0;
+static int const kCurrentVersion = 1;
 #pragma unused(kCurrentVersion)
 
 static NSString *const k_version           = @"version";
@@ -19,14 +19,24 @@ static NSString *const k_metadataSize      = @"metadataSize";
 static NSString *const k_thumbnailSize     = @"thumbnailSize";
 static NSString *const k_dataSize          = @"dataSize";
 static NSString *const k_thumbnailxxHash64 = @"thumbnailxxHash64";
+static NSString *const k_headerVersion     = @"headerVersion";
+static NSString *const k_compression       = @"compression";
+static NSString *const k_compressionShift  = @"compressionBlockShift";
+static NSString *const k_compressedSize    = @"compressedDataSize";
 static NSString *const k_eTag              = @"eTag";
 static NSString *const k_lastModified      = @"lastModified";
 
-@implementation ZDCCloudDataInfo
+@implementation ZDCCloudDataInfo {
+	
+	uint8_t headerVersion;
+}
 
 @synthesize metadataSize = metadataSize;
 @synthesize thumbnailSize = thumbnailSize;
 @synthesize dataSize = dataSize;
+@synthesize compression = compression;
+@synthesize compressionBlockShift = compressionBlockShift;
+@synthesize compressedDataSize = compressedDataSize;
 @synthesize thumbnailxxHash64 = thumbnailxxHash64;
 @synthesize eTag = eTag;
 @synthesize lastModified = lastModified;
@@ -39,7 +49,25 @@ static NSString *const k_lastModified      = @"lastModified";
 	{
 		metadataSize = header.metadataSize;
 		thumbnailSize = header.thumbnailSize;
-		dataSize = header.dataSize;
+		
+		headerVersion = header.version;
+		
+		if (header.version >= 1 && header.compression != ZDCCloudFileCompression_None)
+		{
+			// The header's dataSize is the size of the compressed section.
+			
+			dataSize = header.uncompressedDataSize;
+			compression = header.compression;
+			compressionBlockShift = header.compressionBlockShift;
+			compressedDataSize = header.dataSize;
+		}
+		else
+		{
+			dataSize = header.dataSize;
+			compression = ZDCCloudFileCompression_None;
+			compressionBlockShift = 0;
+			compressedDataSize = header.dataSize;
+		}
 		
 		thumbnailxxHash64 = header.thumbnailxxHash64;
 		
@@ -56,19 +84,32 @@ static NSString *const k_lastModified      = @"lastModified";
 /**
  * Version History:
  *
- * < will be documented here >
+ * 1: Added headerVersion, compression, compressionBlockShift & compressedDataSize.
+ *    For compressed files, dataSize is the decompressed size.
 **/
 
 - (id)initWithCoder:(NSCoder *)decoder
 {
 	if ((self = [super init]))
 	{
-	//	int version = [decoder decodeIntForKey:k_version];
+		int version = [decoder decodeIntForKey:k_version];
 		
 		metadataSize  = (uint64_t)[decoder decodeInt64ForKey:k_metadataSize];
 		thumbnailSize = (uint64_t)[decoder decodeInt64ForKey:k_thumbnailSize];
 		dataSize      = (uint64_t)[decoder decodeInt64ForKey:k_dataSize];
 		
+		if (version >= 1)
+		{
+			headerVersion         = (uint8_t)[decoder decodeIntForKey:k_headerVersion];
+			compression           = (ZDCCloudFileCompression)[decoder decodeIntForKey:k_compression];
+			compressionBlockShift = (uint8_t)[decoder decodeIntForKey:k_compressionShift];
+			compressedDataSize    = (uint64_t)[decoder decodeInt64ForKey:k_compressedSize];
+		}
+		else
+		{
+			compressedDataSize = dataSize;
+		}
+		
 		thumbnailxxHash64 = (uint64_t)[decoder decodeInt64ForKey:k_thumbnailxxHash64];
 		
 		eTag = [decoder decodeObjectForKey:k_eTag];
@@ -87,6 +128,11 @@ static NSString *const k_lastModified      = @"lastModified";
 	[coder encodeInt64:(int64_t)thumbnailSize forKey:k_thumbnailSize];
 	[coder encodeInt64:(int64_t)dataSize      forKey:k_dataSize];
 	
+	[coder encodeInt:headerVersion                  forKey:k_headerVersion];
+	[coder encodeInt:compression                    forKey:k_compression];
+	[coder encodeInt:compressionBlockShift          forKey:k_compressionShift];
+	[coder encodeInt64:(int64_t)compressedDataSize  forKey:k_compressedSize];
+	
 	[coder encodeInt64:(int64_t)thumbnailxxHash64 forKey:k_thumbnailxxHash64];
 	
 	[coder encodeObject:eTag forKey:k_eTag];
@@ -115,10 +161,18 @@ static NSString *const k_lastModified      = @"lastModified";
 	
 	header.metadataSize = metadataSize;
 	header.thumbnailSize = thumbnailSize;
-	header.dataSize = dataSize;
+	header.dataSize = compressedDataSize;
 	
 	header.thumbnailxxHash64 = thumbnailxxHash64;
 	
+	header.version = headerVersion;
+	if (compression != ZDCCloudFileCompression_None)
+	{
+		header.compression = compression;
+		header.compressionBlockShift = compressionBlockShift;
+		header.uncompressedDataSize = dataSize;
+	}
+	
 	return header;
 }
 
@@ -116,6 +116,28 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, copy, readwrite, nullable) NSData *rawThumbnail;
 
+/**
+ * You can optionally compress the data section of the cloudFile (prior to encryption).
+ * This is worthwhile for compressible content, such as JSON, text & message bodies.
+ *
+ * The data is compressed in fixed-size blocks, and prefixed with a block index,
+ * so readers retain random access into the data. (CloudFile2CleartextInputStream decompresses transparently.)
+ * Compressed cloudFiles are written with header version 1.
+ *
+ * Compression is only applied when the instance was initialized with cleartextData (via initWithCleartextData::),
+ * and only if the data actually shrinks. Otherwise this property is reset to ZDCCloudFileCompression_None,
+ * and a standard (version 0) cloudFile is produced.
+ *
+ * @note Older versions of the framework don't understand version 1 cloudFiles.
+ *       Only enable compression once all the clients that read the node support it.
+ *       The PushManager only sets this when `-[ZDCConfig cloudFileCompression]` is enabled.
+ *
+ * @warning You must set this value BEFORE opening the stream.
+ *
+ * The default value is ZDCCloudFileCompression_None.
+ */
+@property (nonatomic, assign, readwrite) ZDCCloudFileCompression compression;
+
 /**
  * This property MUST be set before you can invoke 'read:maxLength'.
  *
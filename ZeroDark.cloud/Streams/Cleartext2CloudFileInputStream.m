@@ -2,6 +2,7 @@
 
 #import "CacheFile2CleartextInputStream.h"
 #import "ZDCConstants.h"
+#import "ZDCBlockCompression.h"
 #import "ZDCCloudFileHeader.h"
 #import "ZDCInterruptingInputStream.h"
 #import "ZDCLogging.h"
@@ -71,6 +72,8 @@ typedef NS_ENUM(NSInteger, ZDCCloudFileEncryptState) {
 	NSData *                 metaData;
 	NSData *                 thumbData;
 	
+	NSData *                 compressedData; // data section, if compression applied
+	
 	uint8_t *                inBuffer;
 	NSUInteger               inBufferMallocSize;
 	uint64_t                 inBufferLength;
@@ -98,6 +101,8 @@ typedef NS_ENUM(NSInteger, ZDCCloudFileEncryptState) {
 @synthesize rawMetadata = rawMetadata;
 @synthesize rawThumbnail = rawThumbnail;
 
+@synthesize compression = compression;
+
 @synthesize cleartextFileSize = cleartextFileSize;
 @synthesize cleartextFileSizeUnknown = cleartextFileSizeUnknown;
 
@@ -214,6 +219,17 @@ typedef NS_ENUM(NSInteger, ZDCCloudFileEncryptState) {
 		copy->rawMetadata = rawMetadata;
 		copy->rawThumbnail = rawThumbnail;
 		
+		if (compressedData)
+		{
+			// No need to compress the data again
+			
+			copy->compression = compression;
+			copy->compressedData = compressedData;
+			
+			copy->inputStream = [NSInputStream inputStreamWithData:compressedData];
+			copy->inputStream.delegate = copy;
+		}
+		
 		if (!cleartextFileSizeImplicitlySet) {
 			copy->cleartextFileSize = cleartextFileSize;
 		}
@@ -268,9 +284,56 @@ typedef NS_ENUM(NSInteger, ZDCCloudFileEncryptState) {
 		return thumbData;
 }
 
+- (void)setCompression:(ZDCCloudFileCompression)inCompression
+{
+	NSAssert(streamStatus == NSStreamStatusNotOpen, @"You must set compression BEFORE opening the stream");
+	
+	compression = ZDCCloudFileCompression_None;
+	compressedData = nil;
+	
+	if (inCompression == ZDCCloudFileCompression_None || cleartextData == nil) {
+		return;
+	}
+	
+	NSError *error = nil;
+	NSData *section =
+	  [ZDCBlockCompression compressData: cleartextData
+	                        compression: inCompression
+	                         blockShift: kZDCCloudFileDefaultCompressionBlockShift
+	                              error: &error];
+	
+	if (error)
+	{
+		ZDCLogWarn(@"Unable to compress cleartextData: %@", error);
+	}
+	else if (section.length < cleartextData.length)
+	{
+		compression = inCompression;
+		compressedData = section;
+		
+		// From here on, the compressed section is the data we encrypt
+		
+		inputStream = [NSInputStream inputStreamWithData:compressedData];
+		inputStream.delegate = self;
+	}
+}
+
+/**
+ * The size of the data section (which is what we read from the inputStream).
+ * This is the cleartextFileSize, unless compression was applied.
+ */
+- (NSNumber *)dataSectionSize
+{
+	if (compressedData)
+		return @(compressedData.length);
+	else
+		return cleartextFileSize;
+}
+
 - (NSNumber *)encryptedFileSize
 {
-	if (cleartextFileSize == nil) {
+	NSNumber *dataSectionSize = [self dataSectionSize];
+	if (dataSectionSize == nil) {
 		return nil;
 	}
 	
@@ -279,7 +342,7 @@ typedef NS_ENUM(NSInteger, ZDCCloudFileEncryptState) {
 	totalFileSize += sizeof(ZDCCloudFileHeader);
 	totalFileSize += metaData.length;
 	totalFileSize += thumbData.length;
-	totalFileSize += [cleartextFileSize unsignedLongLongValue];
+	totalFileSize += [dataSectionSize unsignedLongLongValue];
 	totalFileSize += [self padLength];
 	
 	return @(totalFileSize);
@@ -315,7 +378,8 @@ typedef NS_ENUM(NSInteger, ZDCCloudFileEncryptState) {
 
 - (NSUInteger)padLength
 {
-	if (cleartextFileSize == nil) {
+	NSNumber *dataSectionSize = [self dataSectionSize];
+	if (dataSectionSize == nil) {
 		return 0;
 	}
 	
@@ -329,7 +393,7 @@ typedef NS_ENUM(NSInteger, ZDCCloudFileEncryptState) {
 		total += sizeof(ZDCCloudFileHeader);
 		total += metaData.length;
 		total += thumbData.length;
-		total += [cleartextFileSize unsignedLongLongValue];
+		total += [dataSectionSize unsignedLongLongValue];
 		
 		padLength = keyLength - (total % keyLength);
 		if (padLength == 0)
@@ -430,7 +494,7 @@ typedef NS_ENUM(NSInteger, ZDCCloudFileEncryptState) {
 	NSRange headerRange = NSMakeRange(0, sizeof(ZDCCloudFileHeader));
 	NSRange metaRange   = NSMakeRange(NSMaxRange(headerRange), metaData.length);
 	NSRange thumbRange  = NSMakeRange(NSMaxRange(metaRange), thumbData.length);
-	NSRange fileRange   = NSMakeRange(NSMaxRange(thumbRange), [cleartextFileSize unsignedIntegerValue]);
+	NSRange fileRange   = NSMakeRange(NSMaxRange(thumbRange), [[self dataSectionSize] unsignedIntegerValue]);
 	NSRange padRange    = NSMakeRange(NSMaxRange(fileRange), [self padLength]);
 	
 	if (nearestBlockOffset < NSMaxRange(headerRange))
@@ -944,13 +1008,26 @@ typedef NS_ENUM(NSInteger, ZDCCloudFileEncryptState) {
 				
 				uint64_t metaDataSize  = metaData.length;
 				uint64_t thumbnailSize = thumbData.length;
-				uint64_t inStreamSize  = [cleartextFileSize unsignedLongLongValue];
+				uint64_t inStreamSize  = [[self dataSectionSize] unsignedLongLongValue];
 				
 				uint64_t thumbnailxxHash64 = 0;
 				if (thumbData.length > 0) {
 					thumbnailxxHash64 = [thumbData xxHash64];
 				}
 				
+				// Uncompressed files are still written as version 0 (readable by older clients)
+				
+				uint8_t  version = 0;
+				uint8_t  blockShift = 0;
+				uint64_t uncompressedSize = 0;
+				
+				if (compressedData)
+				{
+					version = 1;
+					blockShift = kZDCCloudFileDefaultCompressionBlockShift;
+					uncompressedSize = cleartextData.length;
+				}
+				
 				// write header
 				uint8_t *p0 = inBuffer + inBufferLength;
 				uint8_t *p = p0;
@@ -959,7 +1036,10 @@ typedef NS_ENUM(NSInteger, ZDCCloudFileEncryptState) {
 				S4_Store64(thumbnailSize,                  &p);
 				S4_Store64(inStreamSize,                   &p);
 				S4_Store64(thumbnailxxHash64,              &p);
-				S4_Store8(0,                               &p); // version
+				S4_Store8(version,                         &p); // version
+				S4_Store8(compression,                     &p); // compression
+				S4_Store8(blockShift,                      &p); // compressionBlockShift
+				S4_Store64(uncompressedSize,               &p); // uncompressedDataSize
 				S4_StorePad(0, kZDCCloudFileReservedBytes, &p); // reserved
 				
 				NSAssert((p - p0) == headerSize, @"Missing bytes in header ?");
@@ -1059,9 +1139,10 @@ typedef NS_ENUM(NSInteger, ZDCCloudFileEncryptState) {
 				
 				BOOL inputStreamEOF = (inFromStream == 0) && shouldRead;
 				
-				if (cleartextFileSize)
+				NSNumber *dataSectionSize = [self dataSectionSize];
+				if (dataSectionSize)
 				{
-					uint64_t expectedFileSize = [cleartextFileSize unsignedLongLongValue];
+					uint64_t expectedFileSize = [dataSectionSize unsignedLongLongValue];
 					
 					if ((stateOffset < expectedFileSize) && inputStreamEOF)
 					{
@@ -1097,7 +1178,7 @@ typedef NS_ENUM(NSInteger, ZDCCloudFileEncryptState) {
 						encryptState = ZDCCloudFileEncryptState_Pad;
 					}
 				}
-				else // if (cleartextFileSize == nil)
+				else // if (dataSectionSize == nil)
 				{
 					// We didn't know what the cleartextFileSize would be in advance.
 					
@@ -1647,7 +1728,10 @@ cleanup:
 	S4_Store64(header.thumbnailSize,           &p);
 	S4_Store64(header.dataSize,                &p);
 	S4_Store64(header.thumbnailxxHash64,       &p);
-	S4_Store8(0,                               &p); // version
+	S4_Store8(header.version,                  &p); // version
+	S4_Store8(header.compression,              &p); // compression
+	S4_Store8(header.compressionBlockShift,    &p); // compressionBlockShift
+	S4_Store64(header.uncompressedDataSize,    &p); // uncompressedDataSize
 	S4_StorePad(0, kZDCCloudFileReservedBytes, &p); // reserved
 	
 	NSAssert((p - inBuffer) == headerSize, @"Missing bytes in header ?");
@@ -1,5 +1,6 @@
 #import "CloudFile2CleartextInputStream.h"
 
+#import "ZDCBlockCompression.h"
 #import "ZDCConstants.h"
 #import "ZDCLogging.h"
 
@@ -63,6 +64,17 @@
 	NSNumber *             pendingSeek_ignore;
 	
 	NSNumber *             pendingSeek_section;
+	
+	// Only used if the data section is compressed (header version 1):
+	// The reader sees the decompressed data, and we read the stored (compressed) blocks on demand.
+	
+	ZDCBlockCompression *  blockIndex;
+	uint8_t *              storedBlock;
+	uint64_t               storedBlockMallocSize;
+	uint8_t *              block;
+	uint64_t               blockLength;
+	uint64_t               blockNumber;        // UINT64_MAX if block is empty
+	uint64_t               uncompressedOffset; // reader's offset within the decompressed data
 }
 
 @dynamic cleartextFileSize;
@@ -228,7 +240,10 @@
 
 - (NSNumber *)cleartextFileSize
 {
-	return @(cloudFileHeader.dataSize);
+	if (cloudFileHeader.compression != ZDCCloudFileCompression_None)
+		return @(cloudFileHeader.uncompressedDataSize);
+	else
+		return @(cloudFileHeader.dataSize);
 }
 
 - (ZDCCloudFileHeader)cloudFileHeader
@@ -564,6 +579,26 @@
 	pendingSeek_ignore = nil;
 	pendingSeek_section = nil;
 	
+	if (storedBlock)
+	{
+		ZERO(storedBlock, (size_t)storedBlockMallocSize);
+		
+		free(storedBlock);
+		storedBlock = NULL;
+		storedBlockMallocSize = 0;
+	}
+	if (block)
+	{
+		ZERO(block, (size_t)blockIndex.blockSize);
+		
+		free(block);
+		block = NULL;
+		blockLength = 0;
+	}
+	
+	blockIndex = nil;
+	uncompressedOffset = 0;
+	
 	[inputStream close];
 	streamStatus = NSStreamStatusClosed;
 }
@@ -584,7 +619,11 @@
 	
 	if ([key isEqualToString:NSStreamFileCurrentOffsetKey])
 	{
-		if (pendingSeek_offset || pendingSeek_ignore)
+		if ([self isReadingCompressedData])
+		{
+			return @([self rangeForSection:ZDCCloudFileSection_Data].location + uncompressedOffset);
+		}
+		else if (pendingSeek_offset || pendingSeek_ignore)
 		{
 			uint64_t offset = (pendingSeek_offset != nil) ? pendingSeek_offset.unsignedLongLongValue : totalBytesOutToReader;
 			uint64_t ignore = (pendingSeek_ignore != nil) ? pendingSeek_ignore.unsignedLongLongValue : 0;
@@ -625,6 +664,8 @@
 		pendingSeek_offset  = nil; // seeking to section implicitly cancels seeking to offset
 		pendingSeek_ignore  = nil;
 		
+		uncompressedOffset = 0;
+		
 		if (streamStatus == NSStreamStatusOpen) {
 			[self seekToPendingOffset];
 		}
@@ -639,6 +680,15 @@
 			return NO;
 		}
 		
+		if ([self isReadingCompressedData])
+		{
+			// The offset refers to the decompressed data.
+			// The corresponding block gets read (and decompressed) on demand.
+			
+			uncompressedOffset = MIN([(NSNumber *)property unsignedLongLongValue], cloudFileHeader.uncompressedDataSize);
+			return YES;
+		}
+		
 		NSNumber *oldOffset = [self propertyForKey:NSStreamFileCurrentOffsetKey];
 		NSNumber *newOffset = (NSNumber *)property;
 		
@@ -669,6 +719,17 @@
 {
 	ZDCLogAutoTrace();
 	
+	if ([self isReadingCompressedData])
+		return [self readCompressed:requestBuffer maxLength:requestBufferMallocSize];
+	else
+		return [self readStored:requestBuffer maxLength:requestBufferMallocSize];
+}
+
+/**
+ * Reads the cloud file as stored (i.e. decrypted, but not decompressed).
+ */
+- (NSInteger)readStored:(uint8_t *)requestBuffer maxLength:(NSUInteger)requestBufferMallocSize
+{
 	if (streamStatus == NSStreamStatusNotOpen ||
 	    streamStatus == NSStreamStatusError   ||
 	    streamStatus == NSStreamStatusClosed)
@@ -1042,6 +1103,41 @@
 				
 				cloudFileHeader.version = S4_Load8(&p);
 				
+				if (cloudFileHeader.version > kZDCCloudFileCurrentVersion)
+				{
+					// Written by a newer version of the framework.
+					// We refuse to guess at the layout, rather than handing garbage to the reader.
+					
+					NSString *desc =
+					  [NSString stringWithFormat:@"Unsupported cloud file version (%u)", cloudFileHeader.version];
+					
+					streamError = [self errorWithDescription:desc];
+					streamStatus = NSStreamStatusError;
+					[self sendEvent:NSStreamEventErrorOccurred];
+					
+					return -1;
+				}
+				
+				if (cloudFileHeader.version >= 1)
+				{
+					cloudFileHeader.compression           = S4_Load8(&p);
+					cloudFileHeader.compressionBlockShift = S4_Load8(&p);
+					cloudFileHeader.uncompressedDataSize  = S4_Load64(&p);
+					
+					if ((cloudFileHeader.compression != ZDCCloudFileCompression_None) &&
+					    ![ZDCBlockCompression isSupportedCompression:cloudFileHeader.compression])
+					{
+						NSString *desc =
+						  [NSString stringWithFormat:@"Unsupported cloud file compression (%u)", cloudFileHeader.compression];
+						
+						streamError = [self errorWithDescription:desc];
+						streamStatus = NSStreamStatusError;
+						[self sendEvent:NSStreamEventErrorOccurred];
+						
+						return -1;
+					}
+				}
+				
 				hasReadHeader = YES;
 				
 				// Note: We do NOT modify overflowBufferOffset here.
@@ -1202,6 +1298,194 @@ done:
 	return -1;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Compressed Data
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Returns YES if the reader is positioned within a compressed data section.
+ * In which case reads & offsets refer to the decompressed data.
+ */
+- (BOOL)isReadingCompressedData
+{
+	return hasReadHeader
+	    && (cloudFileHeader.compression != ZDCCloudFileCompression_None)
+	    && (cloudFileSection == ZDCCloudFileSection_Data)
+	    && (pendingSeek_section == nil)
+	    && (streamStatus == NSStreamStatusOpen);
+}
+
+- (NSInteger)readCompressed:(uint8_t *)requestBuffer maxLength:(NSUInteger)requestBufferMallocSize
+{
+	if (blockIndex == nil)
+	{
+		if (![self readBlockIndex]) {
+			return -1;
+		}
+	}
+	
+	uint64_t const uncompressedSize = blockIndex.uncompressedSize;
+	uint64_t const blockSize = blockIndex.blockSize;
+	
+	NSUInteger requestBufferOffset = 0;
+	
+	while ((requestBufferOffset < requestBufferMallocSize) && (uncompressedOffset < uncompressedSize))
+	{
+		uint64_t const neededBlock = uncompressedOffset / blockSize;
+		
+		if (neededBlock != blockNumber)
+		{
+			if (![self readBlock:neededBlock])
+			{
+				if (requestBufferOffset > 0)
+					return requestBufferOffset;
+				else
+					return -1;
+			}
+		}
+		
+		uint64_t const offsetInBlock = uncompressedOffset - (neededBlock * blockSize);
+		uint64_t const bytesToCopy = MIN(blockLength - offsetInBlock, requestBufferMallocSize - requestBufferOffset);
+		
+		memcpy(/* dst: */(requestBuffer + requestBufferOffset),
+		       /* src: */(block + offsetInBlock),
+		       /* num: */(size_t)bytesToCopy);
+		
+		requestBufferOffset += bytesToCopy;
+		uncompressedOffset  += bytesToCopy;
+	}
+	
+	if ((requestBufferOffset == 0) && (requestBufferMallocSize > 0))
+	{
+		// We've output all the decompressed data.
+		// Since padding is never output, the data section is the last thing in the file.
+		
+		[self nextCloudFileSection];
+		
+		if (streamStatus < NSStreamStatusAtEnd)
+		{
+			streamStatus = NSStreamStatusAtEnd;
+			[self sendEvent:NSStreamEventEndEncountered];
+		}
+	}
+	
+	return requestBufferOffset;
+}
+
+/**
+ * Reads & parses the block index, which is stored at the beginning of the (compressed) data section.
+ */
+- (BOOL)readBlockIndex
+{
+	uint64_t const indexLength = [ZDCBlockCompression indexLengthForHeader:cloudFileHeader];
+	
+	NSMutableData *index = [NSMutableData dataWithLength:(NSUInteger)indexLength];
+	
+	if (![self readStoredDataRange:NSMakeRange(0, (NSUInteger)indexLength) into:index.mutableBytes]) {
+		return NO;
+	}
+	
+	NSError *error = nil;
+	blockIndex = [[ZDCBlockCompression alloc] initWithIndex:index header:cloudFileHeader error:&error];
+	
+	if (blockIndex == nil)
+	{
+		streamError = error;
+		streamStatus = NSStreamStatusError;
+		[self sendEvent:NSStreamEventErrorOccurred];
+		
+		return NO;
+	}
+	
+	block = malloc((size_t)blockIndex.blockSize);
+	blockLength = 0;
+	blockNumber = UINT64_MAX;
+	
+	return YES;
+}
+
+/**
+ * Reads the given (stored) block, and decompresses it into the `block` buffer.
+ * Only the bytes of that block are read from the underlying stream.
+ */
+- (BOOL)readBlock:(uint64_t)neededBlock
+{
+	NSRange const storedRange = [blockIndex storedRangeOfBlock:neededBlock];
+	
+	if (storedBlockMallocSize < storedRange.length)
+	{
+		storedBlockMallocSize = storedRange.length;
+		
+		if (storedBlock)
+			storedBlock = reallocf(storedBlock, (size_t)storedBlockMallocSize);
+		else
+			storedBlock = malloc((size_t)storedBlockMallocSize);
+	}
+	
+	if (![self readStoredDataRange:storedRange into:storedBlock]) {
+		return NO;
+	}
+	
+	blockNumber = UINT64_MAX;
+	
+	NSError *error = nil;
+	if (![blockIndex decompressBlock:neededBlock from:storedBlock into:block error:&error])
+	{
+		streamError = error;
+		streamStatus = NSStreamStatusError;
+		[self sendEvent:NSStreamEventErrorOccurred];
+		
+		return NO;
+	}
+	
+	blockNumber = neededBlock;
+	blockLength = [blockIndex uncompressedLengthOfBlock:neededBlock];
+	
+	return YES;
+}
+
+/**
+ * Reads the given range of the stored data section.
+ * If the range immediately follows the previous read, no seek is required.
+ */
+- (BOOL)readStoredDataRange:(NSRange)range into:(uint8_t *)buffer
+{
+	if ((sectionBytesOffset != range.location) || (pendingSeek_ignore != nil))
+	{
+		pendingSeek_offset = @(range.location);
+		[self seekToPendingOffset];
+		
+		if (streamStatus == NSStreamStatusError) {
+			return NO;
+		}
+	}
+	
+	NSUInteger total = 0;
+	while (total < range.length)
+	{
+		NSInteger bytesRead = [self readStored:(buffer + total) maxLength:(range.length - total)];
+		
+		if (bytesRead < 0)
+		{
+			return NO;
+		}
+		else if (bytesRead == 0)
+		{
+			NSString *msg = @"CloudFile ended prematurely";
+			
+			streamError = [self errorWithDescription:msg code:ZDCStreamUnexpectedFileSize];
+			streamStatus = NSStreamStatusError;
+			[self sendEvent:NSStreamEventErrorOccurred];
+			
+			return NO;
+		}
+		
+		total += bytesRead;
+	}
+	
+	return YES;
+}
+
 - (BOOL)getBuffer:(uint8_t **)buffer length:(NSUInteger *)len
 {
 	// Not appropriate for this kind of stream; return NO.
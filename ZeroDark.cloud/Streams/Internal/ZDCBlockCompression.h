@@ -0,0 +1,103 @@
+/**
+ * ZeroDark.cloud
+ *
+ * Homepage      : https://www.zerodark.cloud
+ * GitHub        : https://github.com/4th-ATechnologies/ZeroDark.cloud
+ * Documentation : https://zerodarkcloud.readthedocs.io/en/latest/
+ * API Reference : https://apis.zerodark.cloud
+**/
+
+#import <Foundation/Foundation.h>
+#import "ZDCCloudFileHeader.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Reads & writes the block-compressed data section of a cloud file (header version 1).
+ *
+ * The layout of the data section is documented alongside ZDCCloudFileCompression (in ZDCCloudFileHeader.h).
+ *
+ * An instance represents a parsed block index,
+ * and allows the reader to locate & decompress any block independently.
+ */
+@interface ZDCBlockCompression : NSObject
+
+/**
+ * Returns YES if the given compression scheme is supported (and isn't ZDCCloudFileCompression_None).
+ */
++ (BOOL)isSupportedCompression:(ZDCCloudFileCompression)compression;
+
+/**
+ * Returns the number of blocks needed to store `uncompressedSize` bytes.
+ */
++ (uint64_t)blockCountForUncompressedSize:(uint64_t)uncompressedSize blockShift:(uint8_t)blockShift;
+
+/**
+ * Compresses the given cleartext, and returns a data section (block index + compressed blocks).
+ *
+ * Blocks that don't shrink are stored uncompressed.
+ * It's the caller's job to decide if the result is worth using (i.e. `result.length < data.length`).
+ */
++ (nullable NSData *)compressData:(NSData *)data
+                      compression:(ZDCCloudFileCompression)compression
+                       blockShift:(uint8_t)blockShift
+                            error:(NSError *_Nullable *_Nullable)errorPtr;
+
+/**
+ * Decompresses an entire data section (as generated by `compressData:compression:blockShift:error:`).
+ */
++ (nullable NSData *)decompressData:(NSData *)section
+                             header:(ZDCCloudFileHeader)header
+                              error:(NSError *_Nullable *_Nullable)errorPtr;
+
+/**
+ * Returns the size (in bytes) of the block index at the beginning of the data section.
+ */
++ (uint64_t)indexLengthForHeader:(ZDCCloudFileHeader)header;
+
+/**
+ * Parses the block index (the first `indexLengthForHeader:` bytes of the data section).
+ *
+ * The index is validated against the header.
+ * That is, the block lengths must add up to header.dataSize.
+ */
+- (nullable instancetype)initWithIndex:(NSData *)index
+                                header:(ZDCCloudFileHeader)header
+                                 error:(NSError *_Nullable *_Nullable)errorPtr;
+
+/** Number of blocks in the data section. */
+@property (nonatomic, readonly) uint64_t blockCount;
+
+/** Size of each (decompressed) block, excluding the last block, which may be shorter. */
+@property (nonatomic, readonly) uint64_t blockSize;
+
+/** The size of the data after decompression. */
+@property (nonatomic, readonly) uint64_t uncompressedSize;
+
+/**
+ * Returns the range of the stored block (compressed or not), relative to the start of the data section.
+ */
+- (NSRange)storedRangeOfBlock:(uint64_t)blockIndex;
+
+/**
+ * Returns the size of the block after decompression.
+ */
+- (NSUInteger)uncompressedLengthOfBlock:(uint64_t)blockIndex;
+
+/**
+ * Decompresses a single block.
+ *
+ * @param src
+ *   The stored block, with length `[self storedRangeOfBlock:blockIndex].length`.
+ *
+ * @param dst
+ *   A buffer with at least `uncompressedLengthOfBlock:blockIndex` bytes of space.
+ */
+- (BOOL)decompressBlock:(uint64_t)blockIndex
+                   from:(const uint8_t *)src
+                   into:(uint8_t *)dst
+                  error:(NSError *_Nullable *_Nullable)errorPtr;
+
+@end
+
+NS_ASSUME_NONNULL_END
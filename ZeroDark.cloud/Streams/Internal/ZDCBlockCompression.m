@@ -0,0 +1,389 @@
+/**
+ * ZeroDark.cloud
+ *
+ * Homepage      : https://www.zerodark.cloud
+ * GitHub        : https://github.com/4th-ATechnologies/ZeroDark.cloud
+ * Documentation : https://zerodarkcloud.readthedocs.io/en/latest/
+ * API Reference : https://apis.zerodark.cloud
+**/
+
+#import "ZDCBlockCompression.h"
+
+#import <S4Crypto/S4Crypto.h>
+#import <compression.h>
+
+/**
+ * Each index entry is a uint32.
+ * The high bit indicates the block was stored uncompressed.
+ */
+static uint32_t const kBlockStoredRawFlag = 0x80000000;
+static uint32_t const kBlockLengthMask    = 0x7FFFFFFF;
+
+/**
+ * Sanity limits on the blockShift.
+ * The upper limit ensures a block length always fits within kBlockLengthMask.
+ */
+static uint8_t const kMinBlockShift = 10; // 1 KiB
+static uint8_t const kMaxBlockShift = 24; // 16 MiB
+
+
+@implementation ZDCBlockCompression
+{
+	ZDCCloudFileCompression compression;
+	
+	uint64_t blockCount;
+	uint64_t blockSize;
+	uint64_t uncompressedSize;
+	
+	uint64_t *blockOffsets; // blockCount + 1 entries, relative to start of data section
+	BOOL *blockStoredRaw;   // blockCount entries
+}
+
+@synthesize blockCount = blockCount;
+@synthesize blockSize = blockSize;
+@synthesize uncompressedSize = uncompressedSize;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Utilities
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
++ (NSError *)errorWithDescription:(NSString *)description
+{
+	NSDictionary *userInfo = nil;
+	if (description) {
+		userInfo = @{ NSLocalizedDescriptionKey: description };
+	}
+	
+	NSString *domain = NSStringFromClass([self class]);
+	return [NSError errorWithDomain:domain code:0 userInfo:userInfo];
+}
+
++ (compression_algorithm)algorithmForCompression:(ZDCCloudFileCompression)compression
+{
+	switch (compression)
+	{
+		case ZDCCloudFileCompression_LZ4   : return COMPRESSION_LZ4_RAW;
+		case ZDCCloudFileCompression_ZLIB  : return COMPRESSION_ZLIB;
+		case ZDCCloudFileCompression_LZFSE : return COMPRESSION_LZFSE;
+		default                            : return (compression_algorithm)0;
+	}
+}
+
+/**
+ * See header file for description.
+ */
++ (BOOL)isSupportedCompression:(ZDCCloudFileCompression)compression
+{
+	return ([self algorithmForCompression:compression] != 0);
+}
+
+/**
+ * See header file for description.
+ */
++ (uint64_t)blockCountForUncompressedSize:(uint64_t)uncompressedSize blockShift:(uint8_t)blockShift
+{
+	uint64_t const blockSize = (1ULL << blockShift);
+	
+	return (uncompressedSize + blockSize - 1) / blockSize;
+}
+
+/**
+ * See header file for description.
+ */
++ (uint64_t)indexLengthForHeader:(ZDCCloudFileHeader)header
+{
+	if (header.compressionBlockShift < kMinBlockShift || header.compressionBlockShift > kMaxBlockShift) {
+		return 0;
+	}
+	
+	uint64_t blockCount = [self blockCountForUncompressedSize: header.uncompressedDataSize
+	                                               blockShift: header.compressionBlockShift];
+	
+	return blockCount * sizeof(uint32_t);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Compression
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * See header file for description.
+ */
++ (nullable NSData *)compressData:(NSData *)data
+                      compression:(ZDCCloudFileCompression)compression
+                       blockShift:(uint8_t)blockShift
+                            error:(NSError *_Nullable *_Nullable)errorPtr
+{
+	compression_algorithm const algorithm = [self algorithmForCompression:compression];
+	if (algorithm == 0)
+	{
+		if (errorPtr) *errorPtr = [self errorWithDescription:@"Unsupported compression"];
+		return nil;
+	}
+	
+	if (blockShift < kMinBlockShift || blockShift > kMaxBlockShift)
+	{
+		if (errorPtr) *errorPtr = [self errorWithDescription:@"Unsupported compression blockShift"];
+		return nil;
+	}
+	
+	uint64_t const blockSize = (1ULL << blockShift);
+	uint64_t const blockCount = [self blockCountForUncompressedSize:data.length blockShift:blockShift];
+	
+	// Layout: [index][block 0][block 1]...
+	//
+	// We don't know the size of the compressed blocks in advance.
+	// So we reserve space for the index, and fill it in as we go.
+	
+	NSUInteger const indexLength = (NSUInteger)(blockCount * sizeof(uint32_t));
+	
+	NSMutableData *section = [NSMutableData dataWithCapacity:(indexLength + data.length)];
+	[section setLength:indexLength];
+	
+	size_t const scratchSize = compression_encode_scratch_buffer_size(algorithm);
+	void *scratch = (scratchSize > 0) ? malloc(scratchSize) : NULL;
+	
+	uint8_t *dst = malloc((size_t)blockSize);
+	
+	const uint8_t *src = (const uint8_t *)data.bytes;
+	
+	for (uint64_t blockIndex = 0; blockIndex < blockCount; blockIndex++)
+	{
+		uint64_t const offset = blockIndex * blockSize;
+		size_t const length = (size_t)MIN(blockSize, (uint64_t)data.length - offset);
+		
+		// If the compressed output doesn't fit in (length - 1) bytes, the block didn't shrink.
+		// In which case compression_encode_buffer returns zero, and we store the block as-is.
+		
+		size_t compressedLength = 0;
+		if (length > 1) {
+			compressedLength = compression_encode_buffer(dst, length - 1, (src + offset), length, scratch, algorithm);
+		}
+		
+		uint32_t entry = 0;
+		if (compressedLength > 0)
+		{
+			[section appendBytes:dst length:compressedLength];
+			entry = (uint32_t)compressedLength;
+		}
+		else
+		{
+			[section appendBytes:(src + offset) length:length];
+			entry = (uint32_t)length | kBlockStoredRawFlag;
+		}
+		
+		uint8_t *p = (uint8_t *)section.mutableBytes + (blockIndex * sizeof(uint32_t));
+		S4_Store32(entry, &p);
+	}
+	
+	free(dst);
+	if (scratch) {
+		free(scratch);
+	}
+	
+	if (errorPtr) *errorPtr = nil;
+	return section;
+}
+
+/**
+ * See header file for description.
+ */
++ (nullable NSData *)decompressData:(NSData *)section
+                             header:(ZDCCloudFileHeader)header
+                              error:(NSError *_Nullable *_Nullable)errorPtr
+{
+	NSError *error = nil;
+	NSMutableData *result = nil;
+	
+	uint64_t const indexLength = [self indexLengthForHeader:header];
+	if (section.length < indexLength)
+	{
+		error = [self errorWithDescription:@"Compressed data section is truncated"];
+		goto done;
+	}
+	
+	{ // Scoping
+		
+		NSData *index = [section subdataWithRange:NSMakeRange(0, (NSUInteger)indexLength)];
+		
+		ZDCBlockCompression *reader = [[self alloc] initWithIndex:index header:header error:&error];
+		if (error) goto done;
+		
+		result = [NSMutableData dataWithLength:(NSUInteger)reader.uncompressedSize];
+		
+		const uint8_t *src = (const uint8_t *)section.bytes;
+		uint8_t *dst = (uint8_t *)result.mutableBytes;
+		
+		for (uint64_t blockIndex = 0; blockIndex < reader.blockCount; blockIndex++)
+		{
+			NSRange storedRange = [reader storedRangeOfBlock:blockIndex];
+			if (NSMaxRange(storedRange) > section.length)
+			{
+				error = [self errorWithDescription:@"Compressed data section is truncated"];
+				goto done;
+			}
+			
+			BOOL ok = [reader decompressBlock: blockIndex
+			                             from: (src + storedRange.location)
+			                             into: (dst + (blockIndex * reader.blockSize))
+			                            error: &error];
+			if (!ok) goto done;
+		}
+	}
+	
+done:
+	
+	if (errorPtr) *errorPtr = error;
+	return error ? nil : result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Decompression
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * See header file for description.
+ */
+- (nullable instancetype)initWithIndex:(NSData *)index
+                                header:(ZDCCloudFileHeader)header
+                                 error:(NSError *_Nullable *_Nullable)errorPtr
+{
+	Class cls = [self class];
+	
+	if (![cls isSupportedCompression:header.compression])
+	{
+		if (errorPtr) *errorPtr = [cls errorWithDescription:@"Unsupported compression"];
+		return nil;
+	}
+	
+	uint64_t const indexLength = [cls indexLengthForHeader:header];
+	if ((indexLength == 0 && header.uncompressedDataSize > 0) || (index.length < indexLength))
+	{
+		if (errorPtr) *errorPtr = [cls errorWithDescription:@"Compressed data section has an invalid block index"];
+		return nil;
+	}
+	
+	if ((self = [super init]))
+	{
+		compression = header.compression;
+		
+		blockSize = (1ULL << header.compressionBlockShift);
+		blockCount = indexLength / sizeof(uint32_t);
+		uncompressedSize = header.uncompressedDataSize;
+		
+		blockOffsets = malloc((size_t)((blockCount + 1) * sizeof(uint64_t)));
+		blockStoredRaw = malloc((size_t)MAX(blockCount, 1) * sizeof(BOOL));
+		
+		uint8_t *p = (uint8_t *)index.bytes;
+		uint64_t offset = indexLength;
+		
+		for (uint64_t blockIndex = 0; blockIndex < blockCount; blockIndex++)
+		{
+			uint32_t const entry = S4_Load32(&p);
+			uint32_t const length = (entry & kBlockLengthMask);
+			
+			blockOffsets[blockIndex] = offset;
+			blockStoredRaw[blockIndex] = ((entry & kBlockStoredRawFlag) != 0);
+			
+			if (blockStoredRaw[blockIndex] && (length != [self uncompressedLengthOfBlock:blockIndex]))
+			{
+				if (errorPtr) *errorPtr = [cls errorWithDescription:@"Compressed data section has an invalid block index"];
+				return nil;
+			}
+			
+			offset += length;
+		}
+		
+		blockOffsets[blockCount] = offset;
+		
+		if (offset != header.dataSize)
+		{
+			if (errorPtr) *errorPtr = [cls errorWithDescription:@"Compressed data section has an invalid block index"];
+			return nil;
+		}
+	}
+	
+	if (errorPtr) *errorPtr = nil;
+	return self;
+}
+
+- (void)dealloc
+{
+	if (blockOffsets) {
+		free(blockOffsets);
+	}
+	if (blockStoredRaw) {
+		free(blockStoredRaw);
+	}
+}
+
+/**
+ * See header file for description.
+ */
+- (NSRange)storedRangeOfBlock:(uint64_t)blockIndex
+{
+	if (blockIndex >= blockCount) {
+		return NSMakeRange(NSNotFound, 0);
+	}
+	
+	uint64_t const offset = blockOffsets[blockIndex];
+	uint64_t const length = blockOffsets[blockIndex + 1] - offset;
+	
+	return NSMakeRange((NSUInteger)offset, (NSUInteger)length);
+}
+
+/**
+ * See header file for description.
+ */
+- (NSUInteger)uncompressedLengthOfBlock:(uint64_t)blockIndex
+{
+	if (blockIndex >= blockCount) {
+		return 0;
+	}
+	
+	uint64_t const offset = blockIndex * blockSize;
+	return (NSUInteger)MIN(blockSize, uncompressedSize - offset);
+}
+
+/**
+ * See header file for description.
+ */
+- (BOOL)decompressBlock:(uint64_t)blockIndex
+                   from:(const uint8_t *)src
+                   into:(uint8_t *)dst
+                  error:(NSError *_Nullable *_Nullable)errorPtr
+{
+	NSRange const storedRange = [self storedRangeOfBlock:blockIndex];
+	NSUInteger const expectedLength = [self uncompressedLengthOfBlock:blockIndex];
+	
+	if (storedRange.location == NSNotFound)
+	{
+		if (errorPtr) *errorPtr = [[self class] errorWithDescription:@"Block index out of range"];
+		return NO;
+	}
+	
+	if (blockStoredRaw[blockIndex])
+	{
+		memcpy(dst, src, expectedLength);
+	}
+	else
+	{
+		compression_algorithm const algorithm = [[self class] algorithmForCompression:compression];
+		
+		// Note: libcompression allocates scratch space itself when we pass NULL.
+		
+		size_t const decodedLength =
+		  compression_decode_buffer(dst, expectedLength, src, storedRange.length, NULL, algorithm);
+		
+		if (decodedLength != expectedLength)
+		{
+			if (errorPtr) *errorPtr = [[self class] errorWithDescription:@"Compressed block is corrupt"];
+			return NO;
+		}
+	}
+	
+	if (errorPtr) *errorPtr = nil;
+	return YES;
+}
+
+@end
@@ -16,10 +16,52 @@
  */
 #define kZDCCloudFileContextMagic 0x286F202928206F29
 
+/**
+ * The most recent header version understood by this version of the framework.
+ *
+ * - version 0: data section contains the raw cleartext
+ * - version 1: data section may be block-compressed (see `compression`)
+ *
+ * Files without compression are still written as version 0,
+ * so they remain readable by older versions of the framework.
+ */
+#define kZDCCloudFileCurrentVersion 1
+
 /**
  * Number of additional bytes added to header for future extensibility.
  */
-#define kZDCCloudFileReservedBytes 23
+#define kZDCCloudFileReservedBytes 13
+
+/**
+ * The default block size used when compressing the data section (as a power of 2).
+ * 16 => 64 KiB
+ */
+#define kZDCCloudFileDefaultCompressionBlockShift 16
+
+/**
+ * Compression schemes that may be applied to the data section of a cloud file.
+ *
+ * When compression is used, the data section is split into fixed-size blocks (`1 << compressionBlockShift`),
+ * and each block is compressed independently (prior to encryption).
+ * The data section then looks like this:
+ *
+ * - block index: one uint32 per block, containing the compressed length of the block.
+ *   If the high bit is set, the block was stored uncompressed (because it didn't compress).
+ * - the compressed blocks, in order
+ *
+ * The index allows readers to locate any block without decompressing the blocks before it,
+ * which preserves random access into the data.
+ */
+typedef uint8_t ZDCCloudFileCompression;
+
+/** The data section contains raw cleartext (default). */
+#define ZDCCloudFileCompression_None  0
+/** The data section is block-compressed using LZ4 (raw block format). */
+#define ZDCCloudFileCompression_LZ4   1
+/** The data section is block-compressed using zlib (raw deflate). */
+#define ZDCCloudFileCompression_ZLIB  2
+/** The data section is block-compressed using LZFSE. */
+#define ZDCCloudFileCompression_LZFSE 3
 
 /**
  * ZeroDark.cloud uses 2 different types of encrypted files:
@@ -47,6 +89,10 @@
  *
  * The output will be an encrypted file whose size is rounded up to the nearest kZDCNode_TweakBlockSizeInBytes.
  * When attempting decryption, we can verify the decryption key is correct by inspecting the decrypted header.
+ *
+ * The header is serialized (big endian) in the following order:
+ * magic, metadataSize, thumbnailSize, dataSize, thumbnailxxHash64,
+ * version, compression, compressionBlockShift, uncompressedDataSize, reserved.
  */
 struct ZDCCloudFileHeader {
 	
@@ -67,8 +113,11 @@ struct ZDCCloudFileHeader {
 	uint64_t thumbnailSize;
 	
 	/**
-	 * Indicates the size of the data (in cleartext).
+	 * Indicates the size of the data section (in cleartext).
 	 * This value excludes the padding that may have been applied.
+	 *
+	 * If the data section is compressed, this is the size of the compressed section (including the block index).
+	 * The size of the decompressed data is stored in `uncompressedDataSize`.
 	 */
 	uint64_t dataSize;
 	
@@ -81,11 +130,34 @@ struct ZDCCloudFileHeader {
 	 */
 	uint64_t thumbnailxxHash64;
 	
+	/**
+	 * The size of the data after decompression.
+	 * Only valid if `compression` is something other than ZDCCloudFileCompression_None.
+	 *
+	 * @note Added in version 1.
+	 */
+	uint64_t uncompressedDataSize;
+	
 	/**
 	 * Refers to the version of this header.
 	 */
 	uint8_t  version;
 	
+	/**
+	 * The compression scheme applied to the data section.
+	 *
+	 * @note Added in version 1.
+	 */
+	ZDCCloudFileCompression compression;
+	
+	/**
+	 * The size of each compressed block, expressed as a power of 2.
+	 * Only valid if `compression` is something other than ZDCCloudFileCompression_None.
+	 *
+	 * @note Added in version 1.
+	 */
+	uint8_t  compressionBlockShift;
+	
 	/**
 	 * Reserved for future extensibility.
 	 */
@@ -14,6 +14,35 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+/**
+ * Controls how a file is read & hashed.
+ * The results (final checksums & per-chunk checksums) are identical regardless of the mode.
+ */
+typedef NS_ENUM(NSInteger, ZDCFileChecksumMode) {
+	
+	/**
+	 * Uses ZDCFileChecksumMode_Parallel for large files (when there's work that can be split up),
+	 * and ZDCFileChecksumMode_Sequential otherwise.
+	 */
+	ZDCFileChecksumMode_Automatic = 0,
+	
+	/**
+	 * The file is read once (via dispatch_io),
+	 * and every instruction is fed serially from a single queue.
+	 */
+	ZDCFileChecksumMode_Sequential,
+	
+	/**
+	 * The work is split into independent extents (1 per chunk, or 1 per instruction without a chunkSize),
+	 * which are read (via pread) & hashed concurrently across all available cores.
+	 * Independent instructions (e.g. different algorithms) are also processed concurrently.
+	 *
+	 * Callbacks are still delivered in order (per instruction),
+	 * but are delivered after all the hashing has completed.
+	 */
+	ZDCFileChecksumMode_Parallel
+};
+
 /**
  * ZDCFileChecksum can generate 1 or more checksums of a file in a single pass.
  * It supports all the algorithms in the S4Crypto library.
@@ -98,6 +127,31 @@ NS_ASSUME_NONNULL_BEGIN
                         withInstructions:(NSArray<ZDCFileChecksumInstruction *> *)instructions
                                    error:(NSError **)errorPtr;
 
+/**
+ * Starts a checksum process to read given file, and calculate the checksum(s).
+ *
+ * @param fileURL
+ *   A valid file URL.
+ *
+ * @param instructions
+ *   A list of checksum operations to perform.
+ *
+ * @param mode
+ *   Allows you to force sequential or parallel processing.
+ *   The other variant of this method uses ZDCFileChecksumMode_Automatic.
+ *
+ * @param errorPtr
+ *   If an error occurs while validating the parameters, or trying to setup the IO,
+ *   then nil will be returned, and this param (if non-nil) will be set with an error explaining the problem.
+ *
+ * @return progress
+ *   The progress can be used to monitor the process, or to cancel it (via [progress cancel]).
+ */
++ (nullable NSProgress *)checksumFileURL:(NSURL *)fileURL
+                        withInstructions:(NSArray<ZDCFileChecksumInstruction *> *)instructions
+                                    mode:(ZDCFileChecksumMode)mode
+                                   error:(NSError **)errorPtr;
+
 /**
  * Starts a checksum process to read given file, and calculate the checksum(s).
  * 
@@ -16,6 +16,8 @@
 #import "NSError+S4.h"
 
 #import <S4Crypto/S4Crypto.h>
+#import <stdatomic.h>
+#import <sys/stat.h>
 
 #if DEBUG && robbie_hanson
   static const int zdcLogLevel = ZDCLogLevelVerbose | ZDCLogFlagTrace;
@@ -26,6 +28,26 @@
 #endif
 #pragma unused(zdcLogLevel)
 
+/**
+ * In automatic mode, files smaller than this are always processed sequentially.
+ */
+static uint64_t const kParallelMode_minFileSize = (1024 * 1024 * 8); // 8 MiB
+
+/**
+ * In parallel mode, the max number of bytes read (per pread) by a single task.
+ */
+static uint64_t const kParallelMode_readSize = (1024 * 1024 * 1); // 1 MiB
+
+/**
+ * A unit of work for the parallel mode:
+ * a single digest, calculated over a contiguous extent of the file.
+ */
+typedef struct {
+	NSUInteger instructionIndex;
+	uint64_t chunkIndex;
+	uint64_t offset;
+	uint64_t length;
+} ZDCFileChecksumTask;
 
 @interface ZDCFileChecksumInstruction () {
 @public
@@ -142,6 +164,20 @@
 + (NSProgress *)checksumFileURL:(NSURL *)fileURL
                withInstructions:(NSArray<ZDCFileChecksumInstruction *> *)inInstructions
                           error:(NSError **)errorPtr
+{
+	return [self checksumFileURL: fileURL
+	            withInstructions: inInstructions
+	                        mode: ZDCFileChecksumMode_Automatic
+	                       error: errorPtr];
+}
+
+/**
+ * See header file for description.
+**/
++ (NSProgress *)checksumFileURL:(NSURL *)fileURL
+               withInstructions:(NSArray<ZDCFileChecksumInstruction *> *)inInstructions
+                           mode:(ZDCFileChecksumMode)mode
+                          error:(NSError **)errorPtr
 {
 	if (fileURL == nil)
 	{
@@ -297,6 +333,15 @@
 		progress.totalUnitCount = 0;
 	}
 	
+	if ([self shouldUseParallelMode:mode instructions:instructions fileSize:fileSize])
+	{
+		[self parallelChecksumFileURL: fileURL
+		                 instructions: instructions
+		                     minRange: minRange
+		                     progress: progress];
+		return progress;
+	}
+	
 	// Setup helper blocks
 	
 	void (^InvokeAllCallbackBlocksWithError)(NSError *) =
@@ -769,6 +814,367 @@
 	return progress;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Parallel Mode
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
++ (BOOL)shouldUseParallelMode:(ZDCFileChecksumMode)mode
+                 instructions:(NSArray<ZDCFileChecksumInstruction *> *)instructions
+                     fileSize:(NSNumber *)fileSize
+{
+	if (mode == ZDCFileChecksumMode_Parallel) return YES;
+	if (mode == ZDCFileChecksumMode_Sequential) return NO;
+	
+	// Automatic mode:
+	//
+	// For small files, the overhead of splitting up the work isn't worth it.
+	// And a single (non-chunked) digest is inherently sequential.
+	
+	if (fileSize == nil || [fileSize unsignedLongLongValue] < kParallelMode_minFileSize) {
+		return NO;
+	}
+	
+	if (instructions.count > 1) {
+		return YES;
+	}
+	
+	return (instructions.firstObject.chunkSize != nil);
+}
+
+/**
+ * Parallel version of the file checksum.
+ *
+ * Each chunk (or each whole-range instruction) becomes an independent task,
+ * which reads its own extent of the file (via pread), and hashes it on its own context.
+ * Tasks from all instructions are processed concurrently (via dispatch_apply).
+ *
+ * IMPORTANT:
+ *   Chunk boundaries are calculated exactly as they are in the sequential mode.
+ *   That is, relative to the start of the combined range of all the instructions (minRange.location).
+ *   This ensures the per-chunk results are identical.
+ *
+ * Note: We use pread rather than mmap.
+ * If a mapped file gets truncated while we're reading it, the result is SIGBUS (i.e. crash).
+ * And we're often checksumming files that may be modified underneath us (see ZDCInterruptingInputStream).
+ */
++ (void)parallelChecksumFileURL:(NSURL *)fileURL
+                   instructions:(NSArray<ZDCFileChecksumInstruction *> *)instructions
+                       minRange:(NSRange)minRange
+                       progress:(NSProgress *)progress
+{
+	dispatch_queue_t bgQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+	dispatch_async(bgQueue, ^{ @autoreleasepool {
+		
+		void (^InvokeAllCallbackBlocksWithError)(NSError *) = ^void (NSError *error){
+			
+			for (ZDCFileChecksumInstruction *instruction in instructions)
+			{
+				if (instruction->error) continue;
+				
+				instruction->error = error;
+				dispatch_async(instruction.callbackQueue, ^{ @autoreleasepool {
+					
+					instruction.callbackBlock(nil, instruction->chunkIndex, YES, instruction->error);
+				}});
+			}
+		};
+		
+		int fd = open([[fileURL path] UTF8String], O_RDONLY);
+		if (fd < 0)
+		{
+			NSError *error = [self errorWithDescription:@"Unable to open file."];
+			
+			InvokeAllCallbackBlocksWithError(error);
+			return;
+		}
+		
+		struct stat st;
+		if (fstat(fd, &st) != 0)
+		{
+			close(fd);
+			
+			NSError *error = [NSError errorWithPOSIXCode:errno];
+			InvokeAllCallbackBlocksWithError(error);
+			return;
+		}
+		
+		const uint64_t fileSize = (uint64_t)st.st_size;
+		const uint64_t fileStart = minRange.location;
+		
+		// Split the work into tasks.
+		//
+		// Whole-range tasks are (potentially) the longest running,
+		// so we list them first to ensure they get started first.
+		
+		NSMutableData *tasksData = [NSMutableData data];
+		NSMutableData *chunkedTasksData = [NSMutableData data];
+		
+		NSUInteger instructionCount = instructions.count;
+		uint64_t *taskCounts = calloc(instructionCount, sizeof(uint64_t));
+		uint64_t totalBytes = 0;
+		
+		for (NSUInteger i = 0; i < instructionCount; i++)
+		{
+			ZDCFileChecksumInstruction *instruction = instructions[i];
+			
+			uint64_t start = 0;
+			uint64_t end = fileSize;
+			
+			if (instruction.range)
+			{
+				NSRange range = [instruction.range rangeValue];
+				
+				start = MIN((uint64_t)range.location, fileSize);
+				end = MIN((uint64_t)NSMaxRange(range), fileSize);
+				
+				if (start >= end)
+				{
+					// Range is out-of-bounds.
+					// This is reported below, after we know the file size.
+					continue;
+				}
+			}
+			
+			uint64_t chunkSize = [instruction.chunkSize unsignedLongLongValue];
+			if (chunkSize == 0)
+			{
+				ZDCFileChecksumTask task = {
+					.instructionIndex = i,
+					.chunkIndex = 0,
+					.offset = start,
+					.length = (end - start)
+				};
+				[tasksData appendBytes:&task length:sizeof(task)];
+				taskCounts[i] = 1;
+			}
+			else if (start == end)
+			{
+				// Edge case:
+				// - we're hashing an empty file
+				// - this instruction is for the entire file
+				//
+				// The sequential mode emits a single (empty) chunk in this case.
+				
+				ZDCFileChecksumTask task = {
+					.instructionIndex = i,
+					.chunkIndex = 0,
+					.offset = start,
+					.length = 0
+				};
+				[chunkedTasksData appendBytes:&task length:sizeof(task)];
+				taskCounts[i] = 1;
+			}
+			else
+			{
+				uint64_t offset = start;
+				uint64_t chunkIndex = 0;
+				
+				while (offset < end)
+				{
+					uint64_t chunkEnd = fileStart + (((offset - fileStart) / chunkSize) + 1) * chunkSize;
+					uint64_t length = MIN(chunkEnd, end) - offset;
+					
+					ZDCFileChecksumTask task = {
+						.instructionIndex = i,
+						.chunkIndex = chunkIndex,
+						.offset = offset,
+						.length = length
+					};
+					[chunkedTasksData appendBytes:&task length:sizeof(task)];
+					
+					offset += length;
+					chunkIndex++;
+				}
+				taskCounts[i] = chunkIndex;
+			}
+			
+			totalBytes += (end - start);
+		}
+		
+		[tasksData appendData:chunkedTasksData];
+		
+		const size_t taskCount = tasksData.length / sizeof(ZDCFileChecksumTask);
+		ZDCFileChecksumTask *tasks = malloc(MAX(tasksData.length, sizeof(ZDCFileChecksumTask)));
+		memcpy(tasks, tasksData.bytes, tasksData.length);
+		
+		tasksData = nil;
+		chunkedTasksData = nil;
+		
+		// Every task writes its digest into its own slot.
+		// So there's no need for synchronization between tasks.
+		
+		const size_t maxHashSize = 128; // Skein-1024
+		uint8_t *results = malloc(MAX(taskCount, 1) * maxHashSize);
+		size_t *resultSizes = calloc(MAX(taskCount, 1), sizeof(size_t));
+		S4Err *resultErrs = calloc(MAX(taskCount, 1), sizeof(S4Err));
+		BOOL *resultTruncated = calloc(MAX(taskCount, 1), sizeof(BOOL));
+		
+		progress.totalUnitCount = (int64_t)totalBytes;
+		__block atomic_uint_fast64_t completedBytes = 0;
+		__block atomic_bool aborted = false;
+		
+		dispatch_apply(taskCount, bgQueue, ^(size_t taskIdx) { @autoreleasepool {
+			
+			if (atomic_load(&aborted)) return;
+			
+			const ZDCFileChecksumTask task = tasks[taskIdx];
+			ZDCFileChecksumInstruction *instruction = instructions[task.instructionIndex];
+			
+			HASH_ContextRef hashRef = kInvalidHASH_ContextRef;
+			S4Err err = HASH_Init(instruction.algorithm, &hashRef);
+			
+			size_t bufferSize = (size_t)MIN(task.length, kParallelMode_readSize);
+			void *buffer = (bufferSize > 0) ? malloc(bufferSize) : NULL;
+			
+			uint64_t offset = task.offset;
+			uint64_t left = task.length;
+			
+			while ((err == kS4Err_NoErr) && (left > 0))
+			{
+				if (progress.cancelled)
+				{
+					atomic_store(&aborted, true);
+					break;
+				}
+				
+				size_t sizeToRead = (size_t)MIN(left, (uint64_t)bufferSize);
+				ssize_t bytesRead = pread(fd, buffer, sizeToRead, (off_t)offset);
+				
+				if (bytesRead <= 0)
+				{
+					if (bytesRead < 0 && errno == EINTR) continue;
+					
+					// The file was truncated (or some other IO error occurred).
+					resultTruncated[taskIdx] = YES;
+					break;
+				}
+				
+				err = HASH_Update(hashRef, buffer, (size_t)bytesRead);
+				
+				offset += bytesRead;
+				left -= bytesRead;
+				
+				uint64_t completed = atomic_fetch_add(&completedBytes, (uint64_t)bytesRead) + bytesRead;
+				progress.completedUnitCount = (int64_t)completed;
+			}
+			
+			if (err == kS4Err_NoErr && !resultTruncated[taskIdx] && !atomic_load(&aborted))
+			{
+				size_t hashSize = 0;
+				err = HASH_GetSize(hashRef, &hashSize);
+				
+				if (err == kS4Err_NoErr)
+				{
+					NSAssert(hashSize <= maxHashSize, @"Unexpected hash size");
+					
+					err = HASH_Final(hashRef, results + (taskIdx * maxHashSize));
+					resultSizes[taskIdx] = hashSize;
+				}
+			}
+			
+			if (err != kS4Err_NoErr)
+			{
+				ZDCLogWarn(@"HASH: err = %d", err);
+				resultErrs[taskIdx] = err;
+			}
+			
+			if (hashRef != kInvalidHASH_ContextRef) {
+				HASH_Free(hashRef);
+			}
+			if (buffer) {
+				free(buffer);
+			}
+		}});
+		
+		close(fd);
+		
+		if (atomic_load(&aborted) || progress.cancelled)
+		{
+			InvokeAllCallbackBlocksWithError([self abortedByUserError]);
+		}
+		else
+		{
+			// Deliver the results.
+			// Tasks for the same instruction are listed in chunk order.
+			
+			for (size_t taskIdx = 0; taskIdx < taskCount; taskIdx++)
+			{
+				const ZDCFileChecksumTask task = tasks[taskIdx];
+				ZDCFileChecksumInstruction *instruction = instructions[task.instructionIndex];
+				
+				if (instruction->error) continue;
+				
+				if (resultErrs[taskIdx] != kS4Err_NoErr)
+				{
+					instruction->error = [NSError errorWithS4Error:resultErrs[taskIdx]];
+				}
+				else if (resultTruncated[taskIdx])
+				{
+					instruction->error = [self errorWithDescription:@"File modified during read."];
+				}
+				
+				if (instruction->error)
+				{
+					dispatch_async(instruction.callbackQueue, ^{ @autoreleasepool {
+						
+						instruction.callbackBlock(nil, task.chunkIndex, YES, instruction->error);
+					}});
+					continue;
+				}
+				
+				NSData *hash = [NSData dataWithBytes:(results + (taskIdx * maxHashSize)) length:resultSizes[taskIdx]];
+				
+				uint64_t chunkIndex = task.chunkIndex;
+				BOOL done = (instruction.chunkSize != nil) ? NO : YES;
+				
+				dispatch_async(instruction.callbackQueue, ^{ @autoreleasepool {
+					
+					instruction.callbackBlock(hash, chunkIndex, done, nil);
+				}});
+				instruction->chunkIndex = chunkIndex + 1;
+			}
+			
+			for (NSUInteger i = 0; i < instructionCount; i++)
+			{
+				ZDCFileChecksumInstruction *instruction = instructions[i];
+				if (instruction->error) continue;
+				
+				if (taskCounts[i] == 0)
+				{
+					NSString *msg = [NSString stringWithFormat:
+					  @"Range is out-of-bounds for file/stream with length %llu", (unsigned long long)fileSize];
+					
+					instruction->error = [self errorWithDescription:msg];
+					dispatch_async(instruction.callbackQueue, ^{ @autoreleasepool {
+						
+						instruction.callbackBlock(nil, 0, YES, instruction->error);
+					}});
+				}
+				else if (instruction.chunkSize != nil)
+				{
+					// Fire last callback for chunk'd instruction.
+					
+					uint64_t chunkIndex = instruction->chunkIndex;
+					dispatch_async(instruction.callbackQueue, ^{ @autoreleasepool {
+						
+						instruction.callbackBlock(nil, chunkIndex, YES, nil);
+					}});
+					instruction->chunkIndex++;
+				}
+			}
+		}
+		
+		progress.completedUnitCount = progress.totalUnitCount;
+		
+		free(tasks);
+		free(taskCounts);
+		free(results);
+		free(resultSizes);
+		free(resultErrs);
+		free(resultTruncated);
+	}});
+}
+
 /**
  * See header file for description.
 **/
@@ -396,6 +396,24 @@ NS_ASSUME_NONNULL_BEGIN
                      completionQueue:(nullable dispatch_queue_t)completionQueue
                      completionBlock:(void (^)(ZDCCryptoFile *_Nullable cryptoFile, NSError *_Nullable error))completionBlock;
 
+/**
+ * Same as `encryptCleartextData:toCloudFileWithKey:metadata:thumbnail:completionQueue:completionBlock:`,
+ * but optionally compresses the data section.
+ *
+ * @param compression
+ *   The compression to apply to the data section (see `-[Cleartext2CloudFileInputStream compression]`).
+ *   If the data doesn't shrink, a standard (uncompressed) cloudfile is produced.
+ *
+ * @note Older versions of the framework can't read compressed cloudfiles.
+ */
++ (NSProgress *)encryptCleartextData:(NSData *)cleartextData
+                  toCloudFileWithKey:(NSData *)encryptionKey
+                            metadata:(nullable NSData *)metadata
+                           thumbnail:(nullable NSData *)thumbnail
+                         compression:(ZDCCloudFileCompression)compression
+                     completionQueue:(nullable dispatch_queue_t)completionQueue
+                     completionBlock:(void (^)(ZDCCryptoFile *_Nullable cryptoFile, NSError *_Nullable error))completionBlock;
+
 /**
  * Converts from "unencrypted/cleartext format" to "cloud file format".
  *
@@ -501,6 +519,23 @@ NS_ASSUME_NONNULL_BEGIN
                                 thumbnail:(nullable NSData *)thumbnail
                                     error:(NSError *_Nullable *_Nullable)outError;
 
+/**
+ * Same as `encryptCleartextData:toCloudFileWithKey:metadata:thumbnail:error:`,
+ * but optionally compresses the data section.
+ *
+ * @param compression
+ *   The compression to apply to the data section (see `-[Cleartext2CloudFileInputStream compression]`).
+ *   If the data doesn't shrink, a standard (uncompressed) cloudfile is produced.
+ *
+ * @note Older versions of the framework can't read compressed cloudfiles.
+ */
++ (nullable NSData *)encryptCleartextData:(NSData *)cleartextData
+                       toCloudFileWithKey:(NSData *)encryptionKey
+                                 metadata:(nullable NSData *)metadata
+                                thumbnail:(nullable NSData *)thumbnail
+                              compression:(ZDCCloudFileCompression)compression
+                                    error:(NSError *_Nullable *_Nullable)outError;
+
 /**
  * Creates and returns a "pump".
  *
@@ -994,6 +1029,22 @@ NS_ASSUME_NONNULL_BEGIN
                 toKey:(NSData *)dstEncryptionKey
                 error:(NSError *_Nullable *_Nullable)outError;
 
+/**
+ * Re-Encrypts an encrypted file (either in CacheFile or CloudFile format) in place.
+ *
+ * Since the layout of the file doesn't change, each block is decrypted & re-encrypted where it sits.
+ * This avoids writing a second (full size) copy of the file.
+ *
+ * @warning If an error occurs, the file may be left partially re-encrypted (i.e. unreadable with either key).
+ *          Only use this method when the file is disposable (e.g. a freshly downloaded temp file).
+ *
+ * @return Returns YES on success, NO otherwise.
+ */
++ (BOOL)reEncryptFileInPlace:(NSURL *)fileURL
+                     fromKey:(NSData *)srcEncryptionKey
+                       toKey:(NSData *)dstEncryptionKey
+                       error:(NSError *_Nullable *_Nullable)outError;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -17,10 +17,17 @@
 #import "ZDCDirectoryManager.h"
 #import "ZDCLogging.h"
 
+#import "NSData+S4.h"
+#import "NSError+POSIX.h"
 #import "NSError+S4.h"
 #import "OSImage+ZeroDark.h"
 
 #import <S4Crypto/S4Crypto.h>
+#import <YapDatabase/YapDatabaseAtomic.h>
+
+#import <fcntl.h>
+#import <stdatomic.h>
+#import <sys/stat.h>
 
 // Log Levels: off, error, warn, info, verbose
 // Log Flags : trace
@@ -32,6 +39,22 @@
 
 #define CKS4ERR  if ((err != kS4Err_NoErr)) { goto S4ErrOccurred; }
 
+/**
+ * The transcoder (crypto -> crypto) processes the destination file in chunks of this size.
+ * Chunks are processed concurrently. Must be a multiple of kZDCNode_TweakBlockSizeInBytes.
+ */
+static uint64_t const kTranscodeChunkSize = (1024 * 256); // 256 KiB
+
+/**
+ * Describes the destination of a transcode, in terms of cleartext:
+ * [prefix][source cleartext: srcOffset ..< (srcOffset + length)][padding: padLength]
+ */
+typedef struct {
+	uint64_t srcOffset;
+	uint64_t length;
+	uint64_t padLength;
+} ZDCTranscodeLayout;
+
 @implementation ZDCFileConversion
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -765,6 +788,26 @@ done:
                            thumbnail:(nullable NSData *)thumbnail
                      completionQueue:(nullable dispatch_queue_t)completionQueue
                      completionBlock:(void (^)(ZDCCryptoFile *cryptoFile, NSError *error))completionBlock
+{
+	return [self encryptCleartextData: cleartextData
+	               toCloudFileWithKey: encryptionKey
+	                         metadata: metadata
+	                        thumbnail: thumbnail
+	                      compression: ZDCCloudFileCompression_None
+	                  completionQueue: completionQueue
+	                  completionBlock: completionBlock];
+}
+
+/**
+ * See header file for description.
+ */
++ (NSProgress *)encryptCleartextData:(NSData *)cleartextData
+                  toCloudFileWithKey:(NSData *)encryptionKey
+                            metadata:(nullable NSData *)metadata
+                           thumbnail:(nullable NSData *)thumbnail
+                         compression:(ZDCCloudFileCompression)compression
+                     completionQueue:(nullable dispatch_queue_t)completionQueue
+                     completionBlock:(void (^)(ZDCCryptoFile *cryptoFile, NSError *error))completionBlock
 {
 	ZDCLogAutoTrace();
 	
@@ -783,6 +826,7 @@ done:
 
 		inStream.rawMetadata = metadata;
 		inStream.rawThumbnail = thumbnail;
+		inStream.compression = compression;
 		
 		NSURL *outFileURL = [ZDCDirectoryManager generateTempURL];
 		NSOutputStream *outStream = [NSOutputStream outputStreamWithURL:outFileURL append:NO];
@@ -882,6 +926,24 @@ done:
                                  metadata:(nullable NSData *)metadata
                                 thumbnail:(nullable NSData *)thumbnail
                                     error:(NSError *_Nullable *_Nullable)outError
+{
+	return [self encryptCleartextData: cleartextData
+	               toCloudFileWithKey: encryptionKey
+	                         metadata: metadata
+	                        thumbnail: thumbnail
+	                      compression: ZDCCloudFileCompression_None
+	                            error: outError];
+}
+
+/**
+ * See header file for description.
+ */
++ (nullable NSData *)encryptCleartextData:(NSData *)cleartextData
+                       toCloudFileWithKey:(NSData *)encryptionKey
+                                 metadata:(nullable NSData *)metadata
+                                thumbnail:(nullable NSData *)thumbnail
+                              compression:(ZDCCloudFileCompression)compression
+                                    error:(NSError *_Nullable *_Nullable)outError
 {
 	ZDCLogAutoTrace();
 	
@@ -891,6 +953,7 @@ done:
 	
 	inStream.rawMetadata = metadata;
 	inStream.rawThumbnail = thumbnail;
+	inStream.compression = compression;
 	
 	NSOutputStream *outStream = [NSOutputStream outputStreamToMemory];
 	
@@ -2309,7 +2372,7 @@ done:
 		}
 		
 	} while (!done);
-	
+
 done:
 
 	if (inStream) {
@@ -2356,6 +2419,9 @@ done:
 	cacheFileEncryptionKey = [cacheFileEncryptionKey copy]; // mutable data protection
 	cloudFileEncryptionKey = [cloudFileEncryptionKey copy]; // mutable data protection
 	
+	rawMetadata = [rawMetadata copy];   // mutable data protection
+	rawThumbnail = [rawThumbnail copy]; // mutable data protection
+	
 	if (!completionQueue && completionBlock)
 		completionQueue = dispatch_get_main_queue();
 	
@@ -2364,216 +2430,137 @@ done:
 	dispatch_queue_t bgQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
 	dispatch_async(bgQueue, ^{ @autoreleasepool {
 		
-		__block CacheFile2CleartextInputStream *clearStream = nil;
-		__block Cleartext2CloudFileInputStream *inStream = nil;
-		__block NSOutputStream *outStream = nil;
-		
-		__block uint8_t *buffer = NULL;
-		__block NSUInteger bufferSize = 0;
-		
-		__block BOOL outFileCreated = NO;
-		
-		// Create temp output file location
+		// Hold onto the retainToken until we're done reading the input file
+		__block id token = retainToken;
 		
+		NSError *error = nil;
 		NSURL *outFileURL = [ZDCDirectoryManager generateTempURL];
 		
-		// Setup routine for completion and errors
-		
-		void (^NotifyAndCleanup)(NSError *error);
-		NotifyAndCleanup = ^(NSError *error) {
-			
-			[inStream close];
-			[outStream close];
-			
-			if (buffer) {
-				ZERO(buffer, bufferSize);
-				free(buffer);
-				buffer = NULL;
-			}
-			
-			if (completionBlock)
-			{
-				dispatch_async(completionQueue, ^{ @autoreleasepool {
-					completionBlock(outFileURL, error);
-				}});
-			}
-			
-			if (outFileCreated && error) {
-				[[NSFileManager defaultManager] removeItemAtURL:outFileURL error:nil];
-			}
-		};
-		
 		if (progress.cancelled)
 		{
-			NSError *error = [self errorUserCanceled];
-			NotifyAndCleanup(error);
-			return;
+			error = [self errorUserCanceled];
 		}
-		
-		// Create streams
-		
-		clearStream = [[CacheFile2CleartextInputStream alloc] initWithCacheFileURL: inFileURL
-		                                                             encryptionKey: cacheFileEncryptionKey];
-		clearStream.retainToken = retainToken;
-		
-		if (clearStream == nil)
+		else
 		{
-			NSError *error = [self errorCreatingStreamForFile:inFileURL];
-			NotifyAndCleanup(error);
-			return;
+			error = [self _convertCacheFile: inFileURL
+			                        fromKey: cacheFileEncryptionKey
+			                    toCloudFile: outFileURL
+			                          toKey: cloudFileEncryptionKey
+			                       metadata: rawMetadata
+			                      thumbnail: rawThumbnail
+			                       progress: progress];
 		}
 		
-		inStream = [[Cleartext2CloudFileInputStream alloc] initWithCleartextFileStream: clearStream
-		                                                                 encryptionKey: cloudFileEncryptionKey];
+		token = nil;
 		
-		inStream.rawMetadata = rawMetadata;
-		inStream.rawThumbnail = rawThumbnail;
-		
-		if (inStream == nil)
+		if (completionBlock)
 		{
-			NSError *error = [self errorCreatingStreamForFile:inFileURL];
-			NotifyAndCleanup(error);
-			return;
+			dispatch_async(completionQueue, ^{ @autoreleasepool {
+				completionBlock(outFileURL, error);
+			}});
 		}
+	}});
+			
+	return progress;
+}
 		
-		outStream = [NSOutputStream outputStreamWithURL:outFileURL append:NO];
++ (nullable NSError *)_convertCacheFile:(NSURL *)inFileURL
+                                fromKey:(NSData *)inEncryptionKey
+                            toCloudFile:(NSURL *)outFileURL
+                                  toKey:(NSData *)outEncryptionKey
+                               metadata:(nullable NSData *)rawMetadata
+                              thumbnail:(nullable NSData *)rawThumbnail
+                               progress:(nullable NSProgress *)progress
+{
+	NSError *error = nil;
+	NSData *cacheHeader = nil;
 		
-		if (outStream == nil)
-		{
-			NSError *error = [self errorCreatingStreamForFile:outFileURL];
-			NotifyAndCleanup(error);
-			return;
-		}
+	NSMutableData *prefix = nil;
+	ZDCTranscodeLayout layout;
 		
-		// Open streams
+	uint64_t fileSize = 0;
+	uint64_t dataSize = 0;
+	
+	// Decrypt (only) the cache file header
+	
+	cacheHeader = [self _decryptRange: NSMakeRange(0, sizeof(ZDCCacheFileHeader))
+	                           ofFile: inFileURL
+	                          withKey: inEncryptionKey
+	                         fileSize: &fileSize
+	                            error: &error];
+	if (error) goto done;
+	
+	{ // Scoping
 		
-		[inStream open];
+		uint8_t *p = (uint8_t *)cacheHeader.bytes;
 		
-		if (inStream.streamStatus != NSStreamStatusOpen || inStream.streamError)
+		uint64_t magic = S4_Load64(&p);
+		if (magic != kZDCCacheFileContextMagic)
 		{
-			NSError *error = [self errorOpeningStream:inStream forFile:inFileURL];
-			NotifyAndCleanup(error);
-			return;
+			error = [self errorWithDescription:@"File signature incorrect."];
+			goto done;
 		}
 		
-		[outStream open];
-		
-		if (outStream.streamStatus != NSStreamStatusOpen || outStream.streamError)
-		{
-			NSError *error = [self errorOpeningStream:outStream forFile:outFileURL];
-			NotifyAndCleanup(error);
-			return;
-		}
+		dataSize = S4_Load64(&p);
+	}
 		
-		outFileCreated = YES;
+	if ((fileSize < sizeof(ZDCCacheFileHeader)) || (dataSize > (fileSize - sizeof(ZDCCacheFileHeader))))
+	{
+		error = [self errorWithDescription:@"Cache file header is corrupt (dataSize exceeds fileSize)."];
+		goto done;
+	}
 		
-		// Prepare for IO
+	// Generate the cloud file prefix: header + metadata + thumbnail
 		
-		NSUInteger fileSize = [inStream.encryptedFileSize unsignedIntegerValue]; // size of cloud file
+	{ // Scoping
 		
-		if (fileSize > 0) {
-			progress.totalUnitCount = fileSize;
+		uint64_t thumbnailxxHash64 = 0;
+		if (rawThumbnail.length > 0) {
+			thumbnailxxHash64 = [rawThumbnail xxHash64];
 		}
 		
-		NSArray<NSString *> *keys = @[ NSURLPreferredIOBlockSizeKey ];
-		
-		NSDictionary *resourceValues = [inFileURL resourceValuesForKeys:keys error:nil];
-		NSNumber *number = nil;
-		
-		number = resourceValues[NSURLPreferredIOBlockSizeKey];
-		if (number != nil) {
-			bufferSize = [number unsignedIntegerValue];
-		}
-		else {
-			bufferSize = (1024 * 32); // Pick a sane default chunk size
+		prefix = [NSMutableData dataWithLength:sizeof(ZDCCloudFileHeader)];
+		
+		uint8_t *p = prefix.mutableBytes;
+		S4_Store64(kZDCCloudFileContextMagic,      &p);
+		S4_Store64(rawMetadata.length,             &p);
+		S4_Store64(rawThumbnail.length,            &p);
+		S4_Store64(dataSize,                       &p);
+		S4_Store64(thumbnailxxHash64,              &p);
+		S4_Store8(0,                               &p); // version
+		S4_Store8(ZDCCloudFileCompression_None,    &p); // compression
+		S4_Store8(0,                               &p); // compressionBlockShift
+		S4_Store64(0,                              &p); // uncompressedDataSize
+		S4_StorePad(0, kZDCCloudFileReservedBytes, &p); // reserved
+		
+		if (rawMetadata.length > 0) {
+			[prefix appendData:rawMetadata];
 		}
-		
-		if (fileSize > 0) { // Don't over-allocate buffer
-			bufferSize = MIN(bufferSize, fileSize);
+		if (rawThumbnail.length > 0) {
+			[prefix appendData:rawThumbnail];
 		}
+	}
+	
+	layout.srcOffset = sizeof(ZDCCacheFileHeader);
+	layout.length = dataSize;
+	layout.padLength = [self padLengthForSize:(prefix.length + dataSize) key:outEncryptionKey];
 		
-	#pragma clang diagnostic push
-	#pragma clang diagnostic ignored "-Wambiguous-macro"
-		bufferSize = MAX(bufferSize, kZDCNode_TweakBlockSizeInBytes);
-	#pragma clang diagnostic pop
-		
-		buffer = malloc((size_t)bufferSize);
-		
-		// Start IO
-		
-		NSUInteger totalBytesWritten = 0;
-		
-		BOOL done = NO;
-		do {
-			
-			// Read a chunk from the input stream
-			
-			NSInteger bytesRead = [inStream read:buffer maxLength:bufferSize];
-			
-			if (bytesRead < 0)
-			{
-				// Error reading
-				
-				NSError *error = [self errorReadingWritingStream:inStream forFile:inFileURL];
-				NotifyAndCleanup(error);
-				return;
-			}
-			else if (bytesRead == 0)
-			{
-				// End of stream
-				
-				done = YES;
-			}
-			else // if (bytesRead > 0)
-			{
-				// Write chunk to the output stream.
-				// To be safe, we do this in loop (just in case).
-				
-				NSUInteger loopBytesWritten = 0;
-				do {
-					
-					NSInteger bytesWritten = [outStream write:(buffer + loopBytesWritten)
-					                                maxLength:(bytesRead - loopBytesWritten)];
-					
-					if (bytesWritten <= 0)
-					{
-						// Error writing
-						
-						NSError *error = [self errorReadingWritingStream:outStream forFile:outFileURL];
-						NotifyAndCleanup(error);
-						return;
-					}
-					else
-					{
-						// Update totals and continue
-						
-						loopBytesWritten += bytesWritten;
-						totalBytesWritten += bytesWritten;
-					}
-					
-				} while (loopBytesWritten < bytesRead);
-				
-				if (fileSize > 0) {
-					progress.completedUnitCount = MIN(totalBytesWritten, fileSize);
-				}
-				
-				if (progress.cancelled)
-				{
-					NSError *error = [self errorUserCanceled];
-					NotifyAndCleanup(error);
-					return;
-				}
-			}
-			
-		} while (!done);
-		
-		// Done !
+	error = [self _transcodeFile: inFileURL
+	                     fromKey: inEncryptionKey
+	                      toFile: outFileURL
+	                       toKey: outEncryptionKey
+	                      prefix: prefix
+	                      layout: layout
+	                     inPlace: NO
+	                    progress: progress];
 		
-		NotifyAndCleanup(nil);
+done:
 		
-	}});
+	if (prefix) {
+		ZERO(prefix.mutableBytes, prefix.length);
+	}
 	
-	return progress;
+	return error;
 }
 
 /**
@@ -2601,310 +2588,215 @@ done:
 	dispatch_queue_t bgQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
 	dispatch_async(bgQueue, ^{ @autoreleasepool {
 		
-		__block CloudFile2CleartextInputStream *clearStream = nil;
-		__block Cleartext2CacheFileInputStream *inStream = nil;
-		__block NSOutputStream *outStream = nil;
-		
-		__block uint8_t *buffer = NULL;
-		__block NSUInteger bufferSize = 0;
-		
-		__block uint8_t *sectionBuffer = NULL;
-		__block NSUInteger sectionBufferMallocSize = 0;
-		__block NSUInteger sectionBufferLength = 0;
+		// Hold onto the retainToken until we're done reading the input file
+		__block id token = retainToken;
 		
 		__block ZDCCloudFileHeader header;
-		__block NSData *metadata = nil;
-		__block NSData *thumbnail = nil;
-		__block BOOL outFileCreated = NO;
-		
 		bzero(&header, sizeof(header));
 		
-		// Create temp output file location
+		NSData *metadata = nil;
+		NSData *thumbnail = nil;
 		
+		NSError *error = nil;
 		NSURL *outFileURL = [ZDCDirectoryManager generateTempURL];
 		
-		// Setup routine for completion and errors
-		
-		void (^NotifyAndCleanup)(NSError *error);
-		NotifyAndCleanup = ^(NSError *error) {
-			
-			[inStream close];
-			[outStream close];
-			
-			if (buffer) {
-				ZERO(buffer, bufferSize);
-				free(buffer);
-				buffer = NULL;
-			}
-			
-			if (sectionBuffer) {
-				ZERO(sectionBuffer, sectionBufferMallocSize);
-				free(sectionBuffer);
-				sectionBuffer = NULL;
-			}
-			
-			if (completionBlock)
-			{
-				dispatch_async(completionQueue, ^{ @autoreleasepool {
-					completionBlock(header, metadata, thumbnail, outFileURL, error);
-				}});
-			}
-			
-			if (outFileCreated && error) {
-				[[NSFileManager defaultManager] removeItemAtURL:outFileURL error:nil];
-			}
-		};
-		
 		if (progress.cancelled)
 		{
-			NSError *error = [self errorUserCanceled];
-			NotifyAndCleanup(error);
-			return;
+			error = [self errorUserCanceled];
 		}
-		
-		// Instantiate streams
-		
-		clearStream = [[CloudFile2CleartextInputStream alloc] initWithCloudFileURL: inFileURL
-		                                                             encryptionKey: cloudFileEncryptionKey];
-		clearStream.retainToken = retainToken;
-		
-		if (clearStream == nil)
+		else
 		{
-			NSError *error = [self errorCreatingStreamForFile:inFileURL];
-			NotifyAndCleanup(error);
-			return;
+			error = [self _convertCloudFile: inFileURL
+			                        fromKey: cloudFileEncryptionKey
+			                    toCacheFile: outFileURL
+			                          toKey: cacheFileEncryptionKey
+			                         header: &header
+			                       metadata: &metadata
+			                      thumbnail: &thumbnail
+			                       progress: progress];
 		}
 		
-		inStream =
-		  [[Cleartext2CacheFileInputStream alloc] initWithCleartextFileStream: clearStream
-		                                                        encryptionKey: cacheFileEncryptionKey];
+		token = nil;
 		
-		if (inStream == nil)
+		if (completionBlock)
 		{
-			NSError *error = [self errorCreatingStreamForFile:inFileURL];
-			NotifyAndCleanup(error);
-			return;
+			dispatch_async(completionQueue, ^{ @autoreleasepool {
+				completionBlock(header, metadata, thumbnail, outFileURL, error);
+			}});
 		}
+	}});
+			
+	return progress;
+}
 		
-		outStream = [NSOutputStream outputStreamWithURL:outFileURL append:NO];
++ (nullable NSError *)_convertCloudFile:(NSURL *)inFileURL
+                                fromKey:(NSData *)inEncryptionKey
+                            toCacheFile:(NSURL *)outFileURL
+                                  toKey:(NSData *)outEncryptionKey
+                                 header:(ZDCCloudFileHeader *)headerOut
+                               metadata:(NSData *_Nullable *_Nonnull)metadataOut
+                              thumbnail:(NSData *_Nullable *_Nonnull)thumbnailOut
+                               progress:(nullable NSProgress *)progress
+{
+	NSError *error = nil;
+	NSData *cloudHeader = nil;
 		
-		if (outStream == nil)
-		{
-			NSError *error = [self errorCreatingStreamForFile:outFileURL];
-			NotifyAndCleanup(error);
-			return;
-		}
+	ZDCCloudFileHeader header;
+	bzero(&header, sizeof(header));
 		
-		// Open streams
+	NSMutableData *prefix = nil;
+	ZDCTranscodeLayout layout;
+	
+	uint64_t fileSize = 0;
+	uint64_t dataOffset = 0;
+	
+	// Decrypt (only) the cloud file header
+	
+	cloudHeader = [self _decryptRange: NSMakeRange(0, sizeof(ZDCCloudFileHeader))
+	                           ofFile: inFileURL
+	                          withKey: inEncryptionKey
+	                         fileSize: &fileSize
+	                            error: &error];
+	if (error) goto done;
+	
+	{ // Scoping
 		
-		[inStream open];
+		uint8_t *p = (uint8_t *)cloudHeader.bytes;
 		
-		if (inStream.streamStatus != NSStreamStatusOpen || inStream.streamError)
+		header.magic = S4_Load64(&p);
+		if (header.magic != kZDCCloudFileContextMagic)
 		{
-			NSError *error = [self errorOpeningStream:inStream forFile:inFileURL];
-			NotifyAndCleanup(error);
-			return;
+			error = [self errorWithDescription:@"File signature incorrect."];
+			goto done;
 		}
 		
-		[outStream open];
+		header.metadataSize  = S4_Load64(&p);
+		header.thumbnailSize = S4_Load64(&p);
+		header.dataSize      = S4_Load64(&p);
 		
-		if (outStream.streamStatus != NSStreamStatusOpen || outStream.streamError)
+		header.thumbnailxxHash64 = S4_Load64(&p);
+		
+		header.version = S4_Load8(&p);
+		
+		if (header.version > kZDCCloudFileCurrentVersion)
 		{
-			NSError *error = [self errorOpeningStream:outStream forFile:outFileURL];
-			NotifyAndCleanup(error);
-			return;
+			NSString *desc = [NSString stringWithFormat:@"Unsupported cloud file version (%u)", header.version];
+			
+			error = [self errorWithDescription:desc];
+			goto done;
 		}
 		
-		outFileCreated = YES;
+		if (header.version >= 1)
+		{
+			header.compression           = S4_Load8(&p);
+			header.compressionBlockShift = S4_Load8(&p);
+			header.uncompressedDataSize  = S4_Load64(&p);
+		}
+	}
+			
+	// Sanity check the header (watch out for overflow)
+	{
+		uint64_t available = (fileSize > sizeof(ZDCCloudFileHeader)) ? (fileSize - sizeof(ZDCCloudFileHeader)) : 0;
 		
-		// Prepare for IO
+		if ((header.metadataSize > available) ||
+		    (header.thumbnailSize > (available - header.metadataSize)) ||
+		    (header.dataSize > (available - header.metadataSize - header.thumbnailSize)))
+		{
+			error = [self errorWithDescription:@"Cloud file header is corrupt (section sizes exceed fileSize)."];
+			goto done;
+		}
 		
-		NSUInteger fileSize = 0;
+		dataOffset = sizeof(ZDCCloudFileHeader) + header.metadataSize + header.thumbnailSize;
+	}
 		
-		NSArray<NSString *> *keys = @[ NSURLPreferredIOBlockSizeKey, NSURLFileSizeKey];
+	// Decrypt the metadata & thumbnail sections (they're returned to the caller)
+	
+	if (header.metadataSize > 0)
+	{
+		NSRange range = NSMakeRange(sizeof(ZDCCloudFileHeader), (NSUInteger)header.metadataSize);
 		
-		NSDictionary *resourceValues = [inFileURL resourceValuesForKeys:keys error:nil];
-		NSNumber *number = nil;
+		*metadataOut = [self _decryptRange:range ofFile:inFileURL withKey:inEncryptionKey fileSize:NULL error:&error];
+		if (error) goto done;
+	}
+	
+	if (header.thumbnailSize > 0)
+	{
+		NSRange range = NSMakeRange(sizeof(ZDCCloudFileHeader) + (NSUInteger)header.metadataSize,
+		                            (NSUInteger)header.thumbnailSize);
 		
-		number = resourceValues[NSURLFileSizeKey];
-		if (number != nil) {
-			fileSize = [number unsignedIntegerValue];
-		}
-		
-		if (fileSize > 0) {
-			progress.totalUnitCount = fileSize;
-		}
-		
-		number = resourceValues[NSURLPreferredIOBlockSizeKey];
-		if (number != nil) {
-			bufferSize = [number unsignedIntegerValue];
-		}
-		else {
-			bufferSize = (1024 * 32); // Pick a sane default chunk size
-		}
-		
-		if (fileSize > 0) { // Don't over-allocate buffer
-			bufferSize = MIN(bufferSize, fileSize);
-		}
-		
-	#pragma clang diagnostic push
-	#pragma clang diagnostic ignored "-Wambiguous-macro"
-		bufferSize = MAX(bufferSize, kZDCNode_TweakBlockSizeInBytes);
-	#pragma clang diagnostic pop
-		
-		buffer = malloc((size_t)bufferSize);
-		
-		// Read the following sections of the cloud file:
-		// - header
-		// - metadata
-		// - thumbnail
-		
-		{ // Scope limiting
-			
-			do {
-			
-				ZDCCloudFileSection sectionRead = clearStream.cloudFileSection;
-				NSInteger bytesRead = [clearStream read:buffer maxLength:bufferSize];
-				
-				if (bytesRead < 0)
-				{
-					// Error reading
-					
-					NSError *error = [self errorReadingWritingStream:inStream forFile:inFileURL];
-					NotifyAndCleanup(error);
-					return;
-				}
-				else if (bytesRead > 0)
-				{
-					if (sectionRead == ZDCCloudFileSection_Metadata ||
-					    sectionRead == ZDCCloudFileSection_Thumbnail)
-					{
-						if (sectionBuffer == NULL)
-						{
-						#pragma clang diagnostic push
-						#pragma clang diagnostic ignored "-Wambiguous-macro"
-							sectionBufferMallocSize = (NSUInteger)MAX(header.metadataSize, header.thumbnailSize);
-						#pragma clang diagnostic pop
-							
-							// Protect against rogue header sections
-							sectionBufferMallocSize = MIN(sectionBufferMallocSize, (1024 * 1024 * 16));
-							
-							sectionBuffer = malloc((size_t)sectionBufferMallocSize);
-						}
-						
-						NSUInteger sectionBufferSpace = sectionBufferMallocSize - sectionBufferLength;
-						
-						if (sectionBufferSpace < bytesRead)
-						{
-							sectionBufferMallocSize += (bytesRead - sectionBufferSpace);
-							sectionBuffer = reallocf(sectionBuffer, (size_t)sectionBufferMallocSize);
-						}
-						
-						memcpy((sectionBuffer + sectionBufferLength), buffer, bytesRead);
-						sectionBufferLength += bytesRead;
-					}
-				}
-				else // if (bytesRead == 0) (end of section)
-				{
-					if (sectionRead == ZDCCloudFileSection_Header)
-					{
-						header = clearStream.cloudFileHeader;
-					}
-					else if (sectionRead == ZDCCloudFileSection_Metadata)
-					{
-						metadata = [NSData dataWithBytes:sectionBuffer length:(NSUInteger)sectionBufferLength];
-					}
-					else if (sectionRead == ZDCCloudFileSection_Thumbnail)
-					{
-						thumbnail = [NSData dataWithBytesNoCopy:sectionBuffer length:(NSUInteger)sectionBufferLength];
-					}
-					
-					sectionBufferLength = 0;
-				}
-				
-			} while (clearStream.cloudFileSection < ZDCCloudFileSection_Data);
-			
-		}
-		
-		// Read the data section of the cloud file
-		
-		uint64_t cleartextFileSize = clearStream.cloudFileHeader.dataSize;
-		inStream.cleartextFileSize = @(cleartextFileSize);
-		
-		NSUInteger totalBytesWritten = 0;
-		
-		BOOL done = NO;
-		do {
-			
-			// Read a chunk from the input stream
-			
-			ZDCCloudFileSection section = clearStream.cloudFileSection;
-			NSInteger bytesRead = [inStream read:buffer maxLength:bufferSize];
-			
-			if (bytesRead < 0)
-			{
-				// Error reading
-				
-				NSError *error = [self errorReadingWritingStream:inStream forFile:inFileURL];
-				NotifyAndCleanup(error);
-				return;
-			}
-			else if (bytesRead == 0)
-			{
-				// End of stream
-				
-				done = YES;
-			}
-			else if (section == ZDCCloudFileSection_Data)
-			{
-				// Write chunk to the output stream.
-				// To be safe, we do this in loop (just in case).
-				
-				NSUInteger loopBytesWritten = 0;
-				do {
-					
-					NSInteger bytesWritten = [outStream write:(buffer + loopBytesWritten)
-					                                maxLength:(bytesRead - loopBytesWritten)];
-					
-					if (bytesWritten <= 0)
-					{
-						// Error writing
-						
-						NSError *error = [self errorReadingWritingStream:outStream forFile:outFileURL];
-						NotifyAndCleanup(error);
-						return;
-					}
-					else
-					{
-						// Update totals and continue
-						
-						loopBytesWritten += bytesWritten;
-						totalBytesWritten += bytesWritten;
-					}
-					
-				} while (loopBytesWritten < bytesRead);
-				
-				if (fileSize > 0) {
-					progress.completedUnitCount = MIN(totalBytesWritten, fileSize);
-				}
-				
-				if (progress.cancelled)
-				{
-					NSError *error = [self errorUserCanceled];
-					NotifyAndCleanup(error);
-					return;
-				}
-			}
-			
-		} while (!done);
-		
-		
-		// Done !
-		
-		NotifyAndCleanup(nil);
-	}});
+		*thumbnailOut = [self _decryptRange:range ofFile:inFileURL withKey:inEncryptionKey fileSize:NULL error:&error];
+		if (error) goto done;
+	}
 	
-	return progress;
+	if (header.compression != ZDCCloudFileCompression_None)
+	{
+		// Cache files store the raw cleartext.
+		// So a compressed data section can't be transcoded block-for-block.
+		// Instead we stream it through CloudFile2CleartextInputStream, which decompresses it for us.
+		
+		error = [self _convertCompressedCloudFile: inFileURL
+		                                  fromKey: inEncryptionKey
+		                              toCacheFile: outFileURL
+		                                    toKey: outEncryptionKey
+		                        cleartextFileSize: header.uncompressedDataSize
+		                                 progress: progress];
+		goto done;
+	}
+	
+	// Generate the cache file header
+	
+	prefix = [NSMutableData dataWithLength:sizeof(ZDCCacheFileHeader)];
+	{
+		uint8_t *p = prefix.mutableBytes;
+		S4_Store64(kZDCCacheFileContextMagic,      &p);
+		S4_Store64(header.dataSize,                &p);
+		S4_StorePad(0, kZDCCacheFileReservedBytes, &p); // reserved
+	}
+	
+	layout.srcOffset = dataOffset;
+	layout.length = header.dataSize;
+	layout.padLength = [self padLengthForSize:(prefix.length + header.dataSize) key:outEncryptionKey];
+	
+	error = [self _transcodeFile: inFileURL
+	                     fromKey: inEncryptionKey
+	                      toFile: outFileURL
+	                       toKey: outEncryptionKey
+	                      prefix: prefix
+	                      layout: layout
+	                     inPlace: NO
+	                    progress: progress];
+
+done:
+	
+	*headerOut = header;
+	return error;
+}
+
++ (nullable NSError *)_convertCompressedCloudFile:(NSURL *)inFileURL
+                                          fromKey:(NSData *)inEncryptionKey
+                                      toCacheFile:(NSURL *)outFileURL
+                                            toKey:(NSData *)outEncryptionKey
+                                cleartextFileSize:(uint64_t)cleartextFileSize
+                                         progress:(nullable NSProgress *)progress
+{
+	CloudFile2CleartextInputStream *cloudStream =
+	  [[CloudFile2CleartextInputStream alloc] initWithCloudFileURL: inFileURL
+	                                                 encryptionKey: inEncryptionKey];
+	
+	[cloudStream setProperty:@(ZDCCloudFileSection_Data) forKey:ZDCStreamCloudFileSection];
+	
+	Cleartext2CacheFileInputStream *cacheStream =
+	  [[Cleartext2CacheFileInputStream alloc] initWithCleartextFileStream: cloudStream
+	                                                        encryptionKey: outEncryptionKey];
+	
+	cacheStream.cleartextFileSize = @(cleartextFileSize);
+	
+	NSOutputStream *outStream = [NSOutputStream outputStreamWithURL:outFileURL append:NO];
+	
+	return [self _pipeCacheFileStream: cacheStream
+	                   toOutputStream: outStream
+	                     withProgress: progress
+	             preferredIOBlockSize: nil];
 }
 
 /**
@@ -2975,7 +2867,26 @@ done:
 	                 toKey: dstEncryptionKey
 	              progress: nil];
 	
-	if (outError) *outError = nil;
+	if (outError) *outError = error;
+	return (error == nil);
+}
+
+/**
+ * See header file for description.
+ */
++ (BOOL)reEncryptFileInPlace:(NSURL *)fileURL
+                     fromKey:(NSData *)srcEncryptionKey
+                       toKey:(NSData *)dstEncryptionKey
+                       error:(NSError *_Nullable *_Nullable)outError
+{
+	NSError *error =
+	  [self _reEncryptFile: fileURL
+	               fromKey: srcEncryptionKey
+	                toFile: fileURL
+	                 toKey: dstEncryptionKey
+	              progress: nil];
+	
+	if (outError) *outError = error;
 	return (error == nil);
 }
 
@@ -2985,330 +2896,604 @@ done:
                                toKey:(NSData *)outEncryptionKey
                             progress:(nullable NSProgress *)progress
 {
-	NSError *error = nil;
-	
-	NSInputStream *inStream = nil;
-	NSOutputStream *outStream = nil;
+	if (inEncryptionKey.length != outEncryptionKey.length)
+	{
+		return [self errorWithDescription:@"Key length mismatch !"];
+	}
 	
-	NSUInteger fileSize = 0;
+	NSNumber *fileSize = nil;
+	[inFileURL getResourceValue:&fileSize forKey:NSURLFileSizeKey error:nil];
 	
-	NSArray<NSString *> *keys = nil;
-	NSDictionary *resourceValues = nil;
-	NSNumber *number = nil;
-	
-	TBC_ContextRef decryptTBC = kInvalidTBC_ContextRef;
-	TBC_ContextRef encryptTBC = kInvalidTBC_ContextRef;
+	if (fileSize == nil)
+	{
+		return [self errorCreatingStreamForFile:inFileURL];
+	}
 	
-	NSUInteger bufferMallocSize = 0;
+	// The entire file is re-keyed as-is, including any padding.
+	// (The key lengths match, so the layout doesn't change.)
 	
-	uint8_t *readBuffer = NULL;
-	NSUInteger readBufferOffset = 0;
+	ZDCTranscodeLayout layout = {
+		.srcOffset = 0,
+		.length    = [fileSize unsignedLongLongValue],
+		.padLength = 0
+	};
 	
-	uint8_t *decryptBuffer = NULL;
-	uint8_t *encryptBuffer = NULL;
+	BOOL inPlace = [[inFileURL URLByStandardizingPath] isEqual:[outFileURL URLByStandardizingPath]];
 	
-	BOOL outFileCreated = NO;
+	return [self _transcodeFile: inFileURL
+	                    fromKey: inEncryptionKey
+	                     toFile: outFileURL
+	                      toKey: outEncryptionKey
+	                     prefix: nil
+	                     layout: layout
+	                    inPlace: inPlace
+	                   progress: progress];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Transcode (Crypto -> Crypto)
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
++ (Cipher_Algorithm)cipherAlgorithmForKey:(NSData *)key
+{
+	switch (key.length * 8) // numBytes * 8 = numBits
+	{
+		case  256 : return kCipher_Algorithm_3FISH256;
+		case  512 : return kCipher_Algorithm_3FISH512;
+		case 1024 : return kCipher_Algorithm_3FISH1024;
+		default   : return kCipher_Algorithm_Invalid;
+	}
+}
+
+/**
+ * Matches the padding generated by Cleartext2CacheFileInputStream & Cleartext2CloudFileInputStream.
+ * That is, we always pad (even if already aligned), up to the next multiple of the key length.
+ */
++ (uint64_t)padLengthForSize:(uint64_t)size key:(NSData *)key
+{
+	uint64_t const keyLength = key.length;
+	if (keyLength == 0) return 0; // watch out for EXC_ARITHMETIC
 	
-	NSUInteger const keyLength = inEncryptionKey.length; // == outEncryptionKey.length (verified above)
+	uint64_t padLength = keyLength - (size % keyLength);
+	if (padLength == 0) {
+		padLength = keyLength;
+	}
 	
-	Cipher_Algorithm cipherAlgorithm;
-	switch (keyLength * 8) // numBytes * 8 = numBits
+	return padLength;
+}
+
+/**
+ * Reads whole tweak blocks from the file (via pread), and decrypts them into `clearBuffer`.
+ *
+ * - blockOffset must be a multiple of kZDCNode_TweakBlockSizeInBytes
+ * - length must be a multiple of the key length (the last block of a file may be short)
+ */
++ (nullable NSError *)_decryptBlocks:(size_t)length
+                            atOffset:(uint64_t)blockOffset
+                              fromFD:(int)fd
+                                 TBC:(TBC_ContextRef)TBC
+                           keyLength:(NSUInteger)keyLength
+                        cipherBuffer:(uint8_t *)cipherBuffer
+                         clearBuffer:(uint8_t *)clearBuffer
+{
+	size_t total = 0;
+	while (total < length)
 	{
-		case  256 : cipherAlgorithm = kCipher_Algorithm_3FISH256;  break;
-		case  512 : cipherAlgorithm = kCipher_Algorithm_3FISH512;  break;
-		case 1024 : cipherAlgorithm = kCipher_Algorithm_3FISH1024; break;
-		default   : cipherAlgorithm = kCipher_Algorithm_Invalid;   break;
+		ssize_t bytesRead = pread(fd, (cipherBuffer + total), (length - total), (off_t)(blockOffset + total));
+		
+		if (bytesRead < 0)
+		{
+			if (errno == EINTR) continue;
+			return [NSError errorWithPOSIXCode:errno];
+		}
+		else if (bytesRead == 0)
+		{
+			return [self errorWithDescription:@"Unexpected EOF"];
+		}
+		
+		total += bytesRead;
 	}
 	
-	if (inEncryptionKey.length != outEncryptionKey.length)
+	S4Err err = kS4Err_NoErr;
+	
+	for (size_t offset = 0; offset < length; offset += keyLength)
 	{
-		error = [self errorWithDescription:@"Key length mismatch !"];
-		goto done;
+		if (((blockOffset + offset) % kZDCNode_TweakBlockSizeInBytes) == 0)
+		{
+			uint64_t blockNumber = (uint64_t)((blockOffset + offset) / kZDCNode_TweakBlockSizeInBytes);
+			uint64_t tweek[2]    = {blockNumber,0};
+			
+			err = TBC_SetTweek(TBC, tweek, sizeof(uint64_t) * 2); CKS4ERR;
+		}
+		
+		err = TBC_Decrypt(TBC, (cipherBuffer + offset), (clearBuffer + offset)); CKS4ERR;
 	}
+	
+	return nil;
+
+S4ErrOccurred:
+	
+	return [NSError errorWithS4Error:err];
+}
+
+/**
+ * Decrypts an arbitrary range of cleartext from an encrypted file (either cache or cloud file format).
+ * Only the tweak blocks that overlap the range are read.
+ */
++ (nullable NSData *)_decryptRange:(NSRange)range
+                            ofFile:(NSURL *)fileURL
+                           withKey:(NSData *)encryptionKey
+                          fileSize:(uint64_t *_Nullable)fileSizeOut
+                             error:(NSError *_Nullable *_Nonnull)errorOut
+{
+	NSError *error = nil;
+	NSMutableData *result = nil;
+	
+	int fd = -1;
+	TBC_ContextRef TBC = kInvalidTBC_ContextRef;
+	uint8_t *cipherBuffer = NULL;
+	uint8_t *clearBuffer = NULL;
+	size_t bufferSize = 0;
+	
+	uint64_t fileSize = 0;
+	uint64_t blockStart = 0;
+	uint64_t blockEnd = 0;
+	
+	NSUInteger const keyLength = encryptionKey.length;
+	Cipher_Algorithm const cipherAlgorithm = [self cipherAlgorithmForKey:encryptionKey];
+	
 	if (cipherAlgorithm == kCipher_Algorithm_Invalid)
 	{
 		error = [self errorWithDescription:@"Invalid key length !"];
 		goto done;
 	}
 	
-	// Create streams
-	
-	inStream = [NSInputStream inputStreamWithURL:inFileURL];
-
-	if (inStream == nil)
+	fd = open(fileURL.path.UTF8String, O_RDONLY);
+	if (fd < 0)
 	{
-		error = [self errorCreatingStreamForFile:inFileURL];
+		error = [self errorCreatingStreamForFile:fileURL];
 		goto done;
 	}
+	
+	{ // Scoping
 
-	outStream = [NSOutputStream outputStreamWithURL:outFileURL append:NO];
+		struct stat st;
+		if (fstat(fd, &st) != 0)
+		{
+			error = [NSError errorWithPOSIXCode:errno];
+			goto done;
+		}
 
-	if (outStream == nil)
-	{
-		error = [self errorCreatingStreamForFile:outFileURL];
-		goto done;
+		fileSize = (uint64_t)st.st_size;
 	}
 
-	// Open streams
-
-	[inStream open];
-
-	if (inStream.streamStatus != NSStreamStatusOpen || inStream.streamError)
+	blockStart = (range.location / kZDCNode_TweakBlockSizeInBytes) * kZDCNode_TweakBlockSizeInBytes;
+	blockEnd = ((NSMaxRange(range) + kZDCNode_TweakBlockSizeInBytes - 1) / kZDCNode_TweakBlockSizeInBytes)
+	         * kZDCNode_TweakBlockSizeInBytes;
+	blockEnd = MIN(blockEnd, fileSize);
+	
+	if ((NSMaxRange(range) > blockEnd) || (((blockEnd - blockStart) % keyLength) != 0))
 	{
-		error = [self errorOpeningStream:inStream forFile:inFileURL];
+		error = [self errorWithDescription:@"Unexpected EOF"];
 		goto done;
 	}
 
-	[outStream open];
+	{ // Scoping
 
-	if (outStream.streamStatus != NSStreamStatusOpen || outStream.streamError)
-	{
-		error = [self errorOpeningStream:outStream forFile:outFileURL];
-		goto done;
+		S4Err err = TBC_Init(cipherAlgorithm, encryptionKey.bytes, keyLength, &TBC);
+		if (err != kS4Err_NoErr)
+		{
+			error = [NSError errorWithS4Error:err];
+			goto done;
+		}
 	}
-
-	outFileCreated = YES;
-
-	// Prepare for IO
-
-	keys = @[ NSURLFileSizeKey, NSURLPreferredIOBlockSizeKey];
-	resourceValues = [inFileURL resourceValuesForKeys:keys error:nil];
-
-	number = resourceValues[NSURLFileSizeKey];
-	if (number != nil) {
-		fileSize = [number unsignedIntegerValue];
+			
+	bufferSize = (size_t)(blockEnd - blockStart);
+	cipherBuffer = malloc(MAX(bufferSize, 1));
+	clearBuffer = malloc(MAX(bufferSize, 1));
+			
+	error = [self _decryptBlocks: bufferSize
+	                    atOffset: blockStart
+	                      fromFD: fd
+	                         TBC: TBC
+	                   keyLength: keyLength
+	                cipherBuffer: cipherBuffer
+	                 clearBuffer: clearBuffer];
+	if (error) goto done;
+				
+	result = [NSMutableData dataWithBytes:(clearBuffer + (range.location - blockStart)) length:range.length];
+					
+done:
+	
+	if (fd >= 0) {
+		close(fd);
 	}
-
-	if (fileSize > 0) {
-		progress.totalUnitCount = fileSize;
+				
+	if (TBC_ContextRefIsValid(TBC)) {
+		TBC_Free(TBC);
 	}
-
-	number = resourceValues[NSURLPreferredIOBlockSizeKey];
-	if (number != nil) {
-		bufferMallocSize = [number unsignedIntegerValue];
+				
+	if (cipherBuffer) {
+		free(cipherBuffer);
 	}
-	else {
-		bufferMallocSize = (1024 * 32); // Pick a sane default chunk size
+	if (clearBuffer) {
+		ZERO(clearBuffer, bufferSize);
+		free(clearBuffer);
 	}
+				
+	if (fileSizeOut) *fileSizeOut = fileSize;
+	*errorOut = error;
+				
+	return error ? nil : result;
+}
 
-	if (fileSize > 0) { // Don't over-allocate buffer
-		bufferMallocSize = MIN(bufferMallocSize, fileSize);
+/**
+ * Converts an encrypted file directly into another encrypted file, block by block.
+ *
+ * The destination file (in cleartext) is defined as:
+ * [prefix][source cleartext: layout.srcOffset ..< (layout.srcOffset + layout.length)][padding]
+ *
+ * This covers every conversion we support:
+ * - cache -> cloud : prefix = cloud header + metadata + thumbnail, src = cache file data section
+ * - cloud -> cache : prefix = cache header, src = cloud file data section
+ * - re-encrypt     : no prefix, src = entire file (including its padding)
+ *
+ * Compared to piping a decryption stream into an encryption stream,
+ * there are no intermediate buffers (or stream state machines) in between.
+ * The destination is split into chunks, and the chunks are transcoded concurrently (via dispatch_apply).
+ * Each chunk reads the source tweak blocks it needs (via pread), decrypts them, copies the cleartext
+ * into position, encrypts with the destination key, and writes the result (via pwrite).
+ * The output file is preallocated to its final size.
+ *
+ * In-place:
+ *   If the data section lives at the same offset in both layouts (layout.srcOffset == prefix.length),
+ *   then every chunk reads exactly the (1024-aligned) region of the file that it writes.
+ *   So the transcode can safely be performed in place (srcFileURL == dstFileURL).
+ *   However, if an error occurs mid-way, the file will be left partially converted (i.e. corrupt).
+ */
++ (nullable NSError *)_transcodeFile:(NSURL *)srcFileURL
+                             fromKey:(NSData *)srcKey
+                              toFile:(NSURL *)dstFileURL
+                               toKey:(NSData *)dstKey
+                              prefix:(nullable NSData *)prefix
+                              layout:(ZDCTranscodeLayout)layout
+                             inPlace:(BOOL)inPlace
+                            progress:(nullable NSProgress *)progress
+{
+	NSError *error = nil;
+	
+	int srcFD = -1;
+	int dstFD = -1;
+	BOOL dstFileCreated = NO;
+	
+	uint64_t srcFileSize = 0;
+	
+	NSUInteger const srcKeyLength = srcKey.length;
+	NSUInteger const dstKeyLength = dstKey.length;
+	
+	Cipher_Algorithm const srcAlgorithm = [self cipherAlgorithmForKey:srcKey];
+	Cipher_Algorithm const dstAlgorithm = [self cipherAlgorithmForKey:dstKey];
+	
+	uint64_t const prefixLength = prefix.length;
+	uint64_t const dataEnd = prefixLength + layout.length;
+	uint64_t const dstFileSize = dataEnd + layout.padLength;
+	
+	if (srcAlgorithm == kCipher_Algorithm_Invalid || dstAlgorithm == kCipher_Algorithm_Invalid)
+	{
+		error = [self errorWithDescription:@"Invalid key length !"];
+		goto done;
 	}
-
-	// Ensure bufferSize is a perfect multiple of kZDCNode_TweakBlockSizeInBytes
-	//
-	if (bufferMallocSize <= kZDCNode_TweakBlockSizeInBytes)
+	if ((dstFileSize % dstKeyLength) != 0)
 	{
-		bufferMallocSize = kZDCNode_TweakBlockSizeInBytes;
+		error = [self errorWithDescription:@"Unexpected EOF (non-keyLength boundry)"];
+		goto done;
 	}
-	else if ((bufferMallocSize % kZDCNode_TweakBlockSizeInBytes) != 0)
+	if (inPlace && (layout.srcOffset != prefixLength))
 	{
-		// round down to the closest blockSize multiplier
+		error = [self errorWithDescription:@"Layout doesn't support in-place conversion"];
+		goto done;
+	}
+	
+	// Open files
+	
+	if (inPlace)
+	{
+		srcFD = dstFD = open(srcFileURL.path.UTF8String, O_RDWR);
+		if (srcFD < 0)
+		{
+			error = [self errorCreatingStreamForFile:srcFileURL];
+			goto done;
+		}
+	}
+	else
+	{
+		srcFD = open(srcFileURL.path.UTF8String, O_RDONLY);
+		if (srcFD < 0)
+		{
+			error = [self errorCreatingStreamForFile:srcFileURL];
+			goto done;
+		}
 		
-		NSUInteger multiplier = (NSUInteger)(bufferMallocSize / kZDCNode_TweakBlockSizeInBytes);
-		bufferMallocSize =  multiplier * kZDCNode_TweakBlockSizeInBytes;
+		dstFD = open(dstFileURL.path.UTF8String, (O_WRONLY | O_CREAT | O_TRUNC), 0644);
+		if (dstFD < 0)
+		{
+			error = [self errorCreatingStreamForFile:dstFileURL];
+			goto done;
+		}
+		
+		dstFileCreated = YES;
 	}
-
-	readBuffer    = malloc((size_t)bufferMallocSize);
-	decryptBuffer = malloc((size_t)bufferMallocSize);
-	encryptBuffer = malloc((size_t)bufferMallocSize);
-
-	// Start IO
-
-	uint64_t totalBytesReEncrypted = 0;
-	uint64_t totalBytesWritten = 0;
 	
-	BOOL done = NO;
-	do {
+	{ // Scoping
 		
-		// Read a chunk from the input stream
+		struct stat st;
+		if (fstat(srcFD, &st) != 0)
+		{
+			error = [NSError errorWithPOSIXCode:errno];
+			goto done;
+		}
 		
-		NSInteger bytesRead = [inStream read:(readBuffer + readBufferOffset)
-		                           maxLength:(bufferMallocSize - readBufferOffset)];
+		srcFileSize = (uint64_t)st.st_size;
+	}
+	
+	if ((layout.srcOffset > srcFileSize) || (layout.length > (srcFileSize - layout.srcOffset)))
+	{
+		error = [self errorWithDescription:@"Unexpected EOF"];
+		goto done;
+	}
+	
+	// Preallocate the output file.
+	//
+	// Note: When converting in place, we only grow the file here.
+	// If the output is smaller, we truncate at the end (we still need to read the tail).
+	
+	if (!inPlace || (dstFileSize > srcFileSize))
+	{
+	#if defined(F_PREALLOCATE)
+		fstore_t store = {
+			.fst_flags   = F_ALLOCATECONTIG,
+			.fst_posmode = F_PEOFPOSMODE,
+			.fst_offset  = 0,
+			.fst_length  = (off_t)(dstFileSize - (inPlace ? srcFileSize : 0))
+		};
+		if (fcntl(dstFD, F_PREALLOCATE, &store) == -1)
+		{
+			store.fst_flags = F_ALLOCATEALL;
+			fcntl(dstFD, F_PREALLOCATE, &store); // best effort
+		}
+	#endif
 		
-		if (bytesRead < 0)
+		if (ftruncate(dstFD, (off_t)dstFileSize) != 0)
 		{
-			// Error reading
-			
-			error = [self errorReadingWritingStream:inStream forFile:inFileURL];
+			error = [NSError errorWithPOSIXCode:errno];
 			goto done;
 		}
-		else if (bytesRead == 0)
+	}
+			
+	// Transcode chunks (concurrently)
+			
+	if (dstFileSize > 0)
+	{
+		size_t const chunkCount = (size_t)((dstFileSize + kTranscodeChunkSize - 1) / kTranscodeChunkSize);
+				
+		uint8_t padNumber = 0;
 		{
-			// End of stream
+			uint64_t number = layout.padLength;
+			while (number > UINT8_MAX) {
+				number -= UINT8_MAX;
+			}
+			padNumber = (uint8_t)number;
+		}
+		
+		progress.totalUnitCount = (int64_t)dstFileSize;
+		
+		__block YAPUnfairLock errorLock = YAP_UNFAIR_LOCK_INIT;
+		__block NSError *firstError = nil;
+		__block atomic_uint_fast64_t completedBytes = 0;
+		__block atomic_bool aborted = false;
+		
+		const uint8_t *prefixBytes = prefix.bytes;
+		
+		dispatch_queue_t bgQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+		dispatch_apply(chunkCount, bgQueue, ^(size_t chunkIdx) { @autoreleasepool {
+			
+			if (atomic_load(&aborted)) return;
 			
-			if (readBufferOffset != 0)
+			if (progress.cancelled)
 			{
-				error = [self errorWithDescription:@"Unexpected EOF (non-keyLength boundry)"];
-				goto done;
+				atomic_store(&aborted, true);
+				return;
 			}
 			
-			done = YES;
-		}
-		else // if (bytesRead > 0)
-		{
-			readBufferOffset += bytesRead;
+			uint64_t const dstStart = (uint64_t)chunkIdx * kTranscodeChunkSize;
+			uint64_t const dstEnd = MIN(dstStart + kTranscodeChunkSize, dstFileSize);
+			size_t const dstLength = (size_t)(dstEnd - dstStart);
+			
+			// A chunk's data section maps onto (at most) one extra source tweak block,
+			// since the source cleartext may not be aligned the same way.
+			size_t const srcBufferSize = dstLength + (kZDCNode_TweakBlockSizeInBytes * 2);
+			
+			uint8_t *clearBuffer  = malloc(dstLength);
+			uint8_t *cipherBuffer = malloc(srcBufferSize);
+			uint8_t *srcClearBuffer = NULL;
+			size_t srcClearLength = 0;
+			
+			TBC_ContextRef decryptTBC = kInvalidTBC_ContextRef;
+			TBC_ContextRef encryptTBC = kInvalidTBC_ContextRef;
 			
-			// Decrypt as much as we can.
-			//
-			// On each iteration through the loop we need to:
-			// - decrypt a block (of keyLength), and store in decryptBuffer
-			// - encrypt a block (of keyLength), and store in encryptBuffer
+			NSError *chunkError = nil;
+			S4Err err = kS4Err_NoErr;
 			
-			if (!TBC_ContextRefIsValid(decryptTBC))
+			// Step 1 of 4: prefix (cleartext supplied by the caller)
+			
+			if (dstStart < prefixLength)
 			{
-				S4Err err = TBC_Init(cipherAlgorithm, inEncryptionKey.bytes, inEncryptionKey.length, &decryptTBC);
-				if (err != kS4Err_NoErr)
-				{
-					error = [NSError errorWithS4Error:err];
-					goto done;
-				}
+				uint64_t end = MIN(dstEnd, prefixLength);
+				memcpy(clearBuffer, (prefixBytes + dstStart), (size_t)(end - dstStart));
 			}
-			if (!TBC_ContextRefIsValid(encryptTBC))
+			
+			// Step 2 of 4: data (decrypted from the source file)
+			
+			uint64_t const dataStart = MAX(dstStart, prefixLength);
+			uint64_t const dataStop = MIN(dstEnd, dataEnd);
+			
+			if (dataStart < dataStop)
 			{
-				S4Err err = TBC_Init(cipherAlgorithm,
-				                     outEncryptionKey.bytes,
-				                     outEncryptionKey.length,
-				                     &encryptTBC);
+				uint64_t const srcStart = layout.srcOffset + (dataStart - prefixLength);
+				uint64_t const srcStop = srcStart + (dataStop - dataStart);
+				
+				uint64_t const blockStart = (srcStart / kZDCNode_TweakBlockSizeInBytes) * kZDCNode_TweakBlockSizeInBytes;
+				uint64_t blockEnd = ((srcStop + kZDCNode_TweakBlockSizeInBytes - 1) / kZDCNode_TweakBlockSizeInBytes)
+				                  * kZDCNode_TweakBlockSizeInBytes;
+				blockEnd = MIN(blockEnd, srcFileSize);
+				
+				size_t const blockLength = (size_t)(blockEnd - blockStart);
 				
-				if (err != kS4Err_NoErr)
+				if ((blockLength % srcKeyLength) != 0)
 				{
-					error = [NSError errorWithS4Error:err];
-					goto done;
+					chunkError = [self errorWithDescription:@"Unexpected EOF (non-keyLength boundry)"];
+					goto chunkDone;
 				}
+				
+				err = TBC_Init(srcAlgorithm, srcKey.bytes, srcKeyLength, &decryptTBC); CKS4ERR;
+				
+				srcClearLength = blockLength;
+				srcClearBuffer = malloc(MAX(srcClearLength, 1));
+				
+				chunkError = [self _decryptBlocks: blockLength
+				                         atOffset: blockStart
+				                           fromFD: srcFD
+				                              TBC: decryptTBC
+				                        keyLength: srcKeyLength
+				                     cipherBuffer: cipherBuffer
+				                      clearBuffer: srcClearBuffer];
+				if (chunkError) goto chunkDone;
+				
+				memcpy((clearBuffer + (dataStart - dstStart)),
+				       (srcClearBuffer + (srcStart - blockStart)),
+				       (size_t)(srcStop - srcStart));
 			}
 			
-			NSUInteger loopBytesReEncrypted = 0;
+			// Step 3 of 4: padding
 			
-			while ((loopBytesReEncrypted < readBufferOffset) &&
-			       ((readBufferOffset - loopBytesReEncrypted) >= keyLength))
+			uint64_t const padStart = MAX(dstStart, dataEnd);
+			if (padStart < dstEnd)
 			{
-				S4Err err = kS4Err_NoErr;
-				
-				if (((totalBytesReEncrypted % kZDCNode_TweakBlockSizeInBytes) == 0))
+				memset((clearBuffer + (padStart - dstStart)), padNumber, (size_t)(dstEnd - padStart));
+			}
+			
+			// Step 4 of 4: encrypt & write
+			
+			err = TBC_Init(dstAlgorithm, dstKey.bytes, dstKeyLength, &encryptTBC); CKS4ERR;
+			
+			for (size_t offset = 0; offset < dstLength; offset += dstKeyLength)
+			{
+				if (((dstStart + offset) % kZDCNode_TweakBlockSizeInBytes) == 0)
 				{
-					uint64_t blockNumber = (uint64_t)(totalBytesReEncrypted / kZDCNode_TweakBlockSizeInBytes);
+					uint64_t blockNumber = (uint64_t)((dstStart + offset) / kZDCNode_TweakBlockSizeInBytes);
 					uint64_t tweek[2]    = {blockNumber,0};
 					
-					err = TBC_SetTweek(decryptTBC, tweek, sizeof(uint64_t) * 2); CKS4ERR;
 					err = TBC_SetTweek(encryptTBC, tweek, sizeof(uint64_t) * 2); CKS4ERR;
 				}
 				
-				err = TBC_Decrypt(decryptTBC, (readBuffer + loopBytesReEncrypted),
-				                              (decryptBuffer + loopBytesReEncrypted)); CKS4ERR;
-				
-				err = TBC_Encrypt(encryptTBC, (decryptBuffer + loopBytesReEncrypted),
-				                              (encryptBuffer + loopBytesReEncrypted)); CKS4ERR;
-				
-				loopBytesReEncrypted += keyLength;
-				totalBytesReEncrypted += keyLength;
-				
-				continue;
-			S4ErrOccurred:
-				{
-					error = [NSError errorWithS4Error:err];
-					goto done;
-				}
+				err = TBC_Encrypt(encryptTBC, (clearBuffer + offset), (cipherBuffer + offset)); CKS4ERR;
 			}
 			
-			// Write chunk(s) to the output stream.
-			// To be safe, we do this in loop (just in case).
-			
-			NSUInteger loopBytesWritten = 0;
-			while (loopBytesWritten < loopBytesReEncrypted)
-			{
-				NSInteger bytesWritten = [outStream write:(encryptBuffer + loopBytesWritten)
-														  maxLength:(loopBytesReEncrypted - loopBytesWritten)];
+			{ // Scoping
 				
-				if (bytesWritten <= 0)
+				size_t totalWritten = 0;
+				while (totalWritten < dstLength)
 				{
-					// Error writing
+					ssize_t bytesWritten = pwrite(dstFD, (cipherBuffer + totalWritten), (dstLength - totalWritten),
+					                              (off_t)(dstStart + totalWritten));
+					if (bytesWritten <= 0)
+					{
+						if (bytesWritten < 0 && errno == EINTR) continue;
 					
-					error = [self errorReadingWritingStream:outStream forFile:outFileURL];
-					goto done;
-				}
-				else
-				{
-					// Update totals and continue
+						chunkError = [self errorWithDescription:@"Error writing file"];
+						goto chunkDone;
+					}
 					
-					loopBytesWritten += bytesWritten;
-					totalBytesWritten += bytesWritten;
+					totalWritten += bytesWritten;
 				}
 			}
 			
-			// If the input stream gave us an odd number of bytes,
-			// we may not have been able to re-encrypt all of it.
-			//
-			// - move any leftover bytes to the beginning of the readBuffer.
-			// - reset offset values
+			{ // Scoping
 			
-			uint64_t leftover = readBufferOffset - loopBytesReEncrypted;
-			if ((leftover > 0) && (loopBytesReEncrypted > 0)) // (loopBytesReEncrypted == 0) => no action required
-			{
-				// We cannot use memcpy because the src & dst may overlap.
-				// We MUST used memmove.
-				//
-				// memmove(void *dst, const void *src, size_t len)
-				
-				memmove(readBuffer, (readBuffer + readBufferOffset - leftover), leftover);
-				
-				readBufferOffset = (NSUInteger)leftover;
+				uint64_t completed = atomic_fetch_add(&completedBytes, (uint64_t)dstLength) + dstLength;
+				progress.completedUnitCount = (int64_t)completed;
 			}
-			else
+			
+			goto chunkDone;
+			
+		S4ErrOccurred:
+			
+			chunkError = [NSError errorWithS4Error:err];
+		
+		chunkDone:
+			
+			if (chunkError)
 			{
-				readBufferOffset = 0;
+				atomic_store(&aborted, true);
+				
+				YAPUnfairLockLock(&errorLock);
+				{
+					if (firstError == nil) {
+						firstError = chunkError;
+					}
+				}
+				YAPUnfairLockUnlock(&errorLock);
 			}
 			
-			// Update progress
-			
-			if (fileSize > 0) {
-				progress.completedUnitCount = MIN(totalBytesWritten, fileSize);
+			if (TBC_ContextRefIsValid(decryptTBC)) {
+				TBC_Free(decryptTBC);
+			}
+			if (TBC_ContextRefIsValid(encryptTBC)) {
+				TBC_Free(encryptTBC);
 			}
 			
-			if (progress.cancelled)
-			{
-				error = [self errorUserCanceled];
-				goto done;
+			ZERO(clearBuffer, dstLength);
+			free(clearBuffer);
+			free(cipherBuffer);
+			
+			if (srcClearBuffer) {
+				ZERO(srcClearBuffer, srcClearLength);
+				free(srcClearBuffer);
 			}
-		}
+		}});
 		
-	} while (!done);
-	
-done:
-	
-	[inStream close];
-	[outStream close];
-	
-	if (TBC_ContextRefIsValid(decryptTBC)) {
-		TBC_Free(decryptTBC);
-		decryptTBC = kInvalidTBC_ContextRef;
+		if (firstError)
+		{
+			error = firstError;
+			goto done;
+		}
+		if (atomic_load(&aborted) || progress.cancelled)
+		{
+			error = [self errorUserCanceled];
+			goto done;
+		}
 	}
 	
-	if (TBC_ContextRefIsValid(encryptTBC)) {
-		TBC_Free(encryptTBC);
-		encryptTBC = kInvalidTBC_ContextRef;
+	if (inPlace && (dstFileSize < srcFileSize))
+	{
+		if (ftruncate(dstFD, (off_t)dstFileSize) != 0)
+		{
+			error = [NSError errorWithPOSIXCode:errno];
+			goto done;
+		}
 	}
 	
-	if (readBuffer) {
-		ZERO(readBuffer, bufferMallocSize);
-		free(readBuffer);
-		readBuffer = NULL;
-	}
+done:
 	
-	if (decryptBuffer) {
-		ZERO(decryptBuffer, bufferMallocSize);
-		free(decryptBuffer);
-		decryptBuffer = NULL;
+	if (srcFD >= 0) {
+		close(srcFD);
 	}
-	
-	if (encryptBuffer) {
-		ZERO(encryptBuffer, bufferMallocSize);
-		free(encryptBuffer);
-		encryptBuffer = NULL;
+	if (dstFD >= 0 && dstFD != srcFD) {
+		close(dstFD);
 	}
 	
-	if (outFileCreated && error) {
-		[[NSFileManager defaultManager] removeItemAtURL:outFileURL error:nil];
+	if (dstFileCreated && error) {
+		[[NSFileManager defaultManager] removeItemAtURL:dstFileURL error:nil];
 	}
 	
 	return error;
@@ -10,6 +10,9 @@ NS_ASSUME_NONNULL_BEGIN
  *
  * That is, it allows you to open an encrypted file on disk,
  * and read from that file (using random access) as if the file were cleartext (not encrypted).
+ *
+ * Decrypted blocks are kept in a small LRU cache, so repeated & overlapping reads don't re-decrypt the file.
+ * And when a sequential access pattern is detected, the reader automatically reads ahead.
  */
 @interface ZDCFileReader : NSObject
 
@@ -7,6 +7,7 @@
 #import "NSError+POSIX.h"
 #import "NSError+S4.h"
 
+#import <YapDatabase/YapCache.h>
 
 #if DEBUG
   static const int zdcLogLevel = ZDCLogLevelWarning;
@@ -15,10 +16,37 @@
 #endif
 #pragma unused(zdcLogLevel)
 
+/**
+ * Decrypted cleartext is cached in blocks of this size, indexed by cleartext offset.
+ *
+ * Note that these blocks are NOT aligned with the cipher blocks of the underlying file.
+ * In a cloud file the data section is preceded by the header, metadata & thumbnail sections,
+ * so cleartext offsets are shifted relative to the encryption boundaries.
+ * (And in a compressed cloud file, cleartext offsets don't map linearly to cipher blocks at all.)
+ * So filling a single cached block may require the stream to decrypt two cipher blocks.
+ *
+ * The tweak block size is used simply because it's a reasonable granularity for caching.
+ */
+static NSUInteger const kBlockSize = kZDCNode_TweakBlockSizeInBytes;
+
+static NSUInteger const kBlockCacheCountLimit = 256; // 256 KiB of decrypted cleartext
+static NSUInteger const kMaxBlocksPerRead     = 64;  // Must be well below kBlockCacheCountLimit
+static NSUInteger const kReadAheadBlockCount  = 32;
+static NSUInteger const kSequentialThreshold  = 2;   // Number of back-to-back reads before we read ahead
+
+
 @implementation ZDCFileReader
 {
 	NSData *encryptionKey;
 	NSInputStream * stream;
+	
+	YapCache<NSNumber*, NSData*> *blockCache; // key=blockIndex, value=decrypted block (short only if last)
+	
+	uint64_t streamOffset;   // cleartext offset of underlying stream (only if streamOffsetValid)
+	BOOL streamOffsetValid;
+	
+	uint64_t lastReadEnd;    // for detecting sequential access patterns
+	NSUInteger sequentialCount;
 }
 
 /**
@@ -66,6 +94,8 @@
 				stream = s;
 			}
 		}
+		
+		blockCache = [[YapCache alloc] initWithCountLimit:kBlockCacheCountLimit];
 	}
 	return self;
 }
@@ -143,6 +173,122 @@
 		return -1;
 	}
 	
+	if (errorOut) *errorOut = nil;
+	
+	// Clamp the range to the cleartext size (if known).
+	// If unknown, a short block read from the stream tells us where EOF is.
+	
+	uint64_t fileSize = UINT64_MAX;
+	
+	NSNumber *cleartextFileSize = self.cleartextFileSize;
+	if (cleartextFileSize && stream.streamStatus != NSStreamStatusNotOpen)
+	{
+		fileSize = [cleartextFileSize unsignedLongLongValue];
+	}
+	
+	if (range.length == 0 || (uint64_t)range.location >= fileSize) {
+		return 0;
+	}
+	
+	uint64_t const rangeStart = range.location;
+	uint64_t const rangeEnd = MIN(rangeStart + range.length, fileSize);
+	
+	// Sequential access pattern detection:
+	// If the caller keeps reading where the previous read left off,
+	// we start reading ahead so the stream is hit with fewer (and larger) reads.
+	
+	if (rangeStart == lastReadEnd)
+		sequentialCount++;
+	else
+		sequentialCount = 0;
+	
+	BOOL const readAhead = (sequentialCount >= kSequentialThreshold);
+	
+	uint64_t const lastBlockIndex = (rangeEnd - 1) / kBlockSize;
+	uint64_t const maxBlockIndex = (fileSize == UINT64_MAX) ? UINT64_MAX : ((fileSize - 1) / kBlockSize);
+	
+	uint64_t blockIndex = rangeStart / kBlockSize;
+	NSUInteger copied = 0;
+	
+	while (blockIndex <= lastBlockIndex)
+	{
+		NSData *block = [blockCache objectForKey:@(blockIndex)];
+		if (block == nil)
+		{
+			// Cache miss.
+			// Read the contiguous run of missing blocks (plus read-ahead) in a single pass over the stream.
+			
+			uint64_t runEnd = blockIndex;
+			while ((runEnd < lastBlockIndex) &&
+			       (runEnd - blockIndex + 1 < kMaxBlocksPerRead) &&
+			       ([blockCache objectForKey:@(runEnd + 1)] == nil))
+			{
+				runEnd++;
+			}
+			
+			if (readAhead && (runEnd == lastBlockIndex))
+			{
+				runEnd = MIN(runEnd + kReadAheadBlockCount, maxBlockIndex);
+				runEnd = MIN(runEnd, blockIndex + kMaxBlocksPerRead + kReadAheadBlockCount - 1);
+			}
+			
+			NSError *error = nil;
+			ssize_t result = [self readBlocksFromIndex:blockIndex count:(NSUInteger)(runEnd - blockIndex + 1) error:&error];
+			
+			if (result < 0)
+			{
+				if (errorOut) *errorOut = error;
+				return -1;
+			}
+			
+			block = [blockCache objectForKey:@(blockIndex)];
+			if (block == nil) {
+				break; // EOF
+			}
+		}
+		
+		uint64_t const blockOffset = blockIndex * kBlockSize;
+		uint64_t const readOffset = rangeStart + copied;
+		
+		NSUInteger const offsetInBlock = (NSUInteger)(readOffset - blockOffset);
+		if (offsetInBlock >= block.length) {
+			break; // EOF
+		}
+		
+		NSUInteger const bytesToCopy =
+		  (NSUInteger)MIN((uint64_t)(block.length - offsetInBlock), rangeEnd - readOffset);
+		
+		memcpy((uint8_t *)buffer + copied, (const uint8_t *)block.bytes + offsetInBlock, bytesToCopy);
+		copied += bytesToCopy;
+		
+		if (block.length < kBlockSize) {
+			break; // Short block == last block in file
+		}
+		
+		blockIndex++;
+	}
+	
+	lastReadEnd = rangeStart + copied;
+	return (ssize_t)copied;
+}
+
+- (void)close
+{
+	[stream close];
+	
+	[blockCache removeAllObjects];
+	streamOffsetValid = NO;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma mark Block Cache
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Ensures the underlying stream is readable.
+ */
+- (BOOL)prepareStreamWithError:(NSError **)errorOut
+{
 	// Watch out for edge case:
 	// Once a normal stream hits EOF, it still allows seeking, but won't allow any more reading.
 	// The only way around this is to re-create the underlying stream.
@@ -162,16 +308,17 @@
 			NSError *error = [self errorWithDescription:desc code:1002];
 			
 			if (errorOut) *errorOut = error;
-			return -1;
+			return NO;
 		}
 		
 		stream = streamCopy;
+		streamOffsetValid = NO;
 		[stream open];
 		
 		if (stream.streamStatus == NSStreamStatusError)
 		{
 			if (errorOut) *errorOut = stream.streamError;
-			return -1;
+			return NO;
 		}
 		
 		if ([stream isKindOfClass:[CloudFile2CleartextInputStream class]])
@@ -180,25 +327,72 @@
 		}
 	}
 	
-	NSUInteger fileOffset = range.location;
-	[stream setProperty:@(fileOffset) forKey:NSStreamFileCurrentOffsetKey];
+	if (errorOut) *errorOut = nil;
+	return YES;
+}
 	
-	NSInteger result = [stream read:(uint8_t *)buffer maxLength:range.length];
+/**
+ * Reads (and decrypts) the given run of blocks from the underlying stream, and adds them to the block cache.
+ *
+ * The block offset is computed directly from the index.
+ * We only seek if the stream isn't already positioned there,
+ * so sequential runs are serviced without touching the stream's offset at all.
+ *
+ * @return
+ *   The number of cleartext bytes read, 0 on EOF, or -1 on error.
+ */
+- (ssize_t)readBlocksFromIndex:(uint64_t)blockIndex count:(NSUInteger)blockCount error:(NSError **)errorOut
+{
+	if (![self prepareStreamWithError:errorOut]) {
+		return -1;
+	}
+
+	uint64_t const offset = blockIndex * kBlockSize;
+	if (!streamOffsetValid || streamOffset != offset)
+	{
+		[stream setProperty:@(offset) forKey:NSStreamFileCurrentOffsetKey];
+		
+		streamOffset = offset;
+		streamOffsetValid = YES;
+	}
+	
+	NSUInteger const length = blockCount * kBlockSize;
+	NSMutableData *data = [NSMutableData dataWithLength:length];
+	uint8_t *bytes = (uint8_t *)data.mutableBytes;
 	
-	if (errorOut)
+	NSUInteger total = 0;
+	while (total < length)
 	{
+		NSInteger result = [stream read:(bytes + total) maxLength:(length - total)];
 		if (result < 0)
-			*errorOut = stream.streamError;
-		else
-			*errorOut = nil;
+		{
+			streamOffsetValid = NO;
+			
+			if (errorOut) *errorOut = stream.streamError;
+			return -1;
+		}
+		if (result == 0) {
+			break; // EOF
+		}
+		
+		total += result;
 	}
 	
-	return (ssize_t)result;
-}
-
-- (void)close
-{
-	[stream close];
+	streamOffset += total;
+	
+	for (NSUInteger i = 0; i < blockCount; i++)
+	{
+		NSUInteger const blockStart = i * kBlockSize;
+		if (blockStart >= total) break;
+		
+		NSUInteger const blockLength = MIN(kBlockSize, total - blockStart);
+		NSData *block = [data subdataWithRange:NSMakeRange(blockStart, blockLength)];
+		
+		[blockCache setObject:block forKey:@(blockIndex + i)];
+	}
+	
+	if (errorOut) *errorOut = nil;
+	return (ssize_t)total;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -14,42 +14,216 @@
 #import "NSError+S4.h"
 #import "NSString+ZeroDark.h"
 
-@implementation NSString (BIP39Encoder)
+#import <YapDatabase/YapDatabaseAtomic.h>
 
-+ (NSString *)binaryStringRepresentationOfInt:(long)value numberOfDigits:(unsigned int)length
+/**
+ * A full mnemonic is at most 264 bits (33 bytes).
+ * The 11-bit index helpers below always touch 3 bytes at a time, so buffers get 2 bytes of padding.
+ */
+#define kBIP39PackedBufferSize (33 + 2)
+
+/**
+ * Writes an 11-bit word index into a (zeroed) big-endian bit buffer.
+ */
+static inline void BIP39WriteIndex(uint8_t *buffer, NSUInteger bitOffset, NSUInteger index)
 {
-    NSMutableString *string = [NSMutableString new];
+	uint8_t *p = buffer + (bitOffset >> 3);
+	uint32_t chunk = (uint32_t)(index & 0x7FF) << (13 - (bitOffset & 7));
     
-    for(int i = 0; i < length; i ++) {
-        NSString *part = [NSString stringWithFormat:@"%i", value & (1 << i) ? 1 : 0];
-        [string insertString:part atIndex:0];
-    }
+	p[0] |= (uint8_t)(chunk >> 16);
+	p[1] |= (uint8_t)(chunk >> 8);
+	p[2] |= (uint8_t)(chunk);
+}
     
-    return string;
+/**
+ * Reads an 11-bit word index from a big-endian bit buffer.
+ */
+static inline NSUInteger BIP39ReadIndex(const uint8_t *buffer, NSUInteger bitOffset)
+{
+	const uint8_t *p = buffer + (bitOffset >> 3);
+	uint32_t chunk = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | (uint32_t)p[2];
+	
+	return (NSUInteger)((chunk >> (13 - (bitOffset & 7))) & 0x7FF);
+}
+
+/**
+ * Returns the top `count` bits (count <= 8) starting at the given bit offset (which must be byte aligned).
+ */
+static inline uint8_t BIP39ChecksumBits(const uint8_t *buffer, NSUInteger bitOffset, NSUInteger count)
+{
+	return (uint8_t)(buffer[bitOffset >> 3] >> (8 - count));
+}
+
+/**
+ * Precomputed lookup tables for a single word list.
+ *
+ * Folding a word (case & diacritic insensitive) is expensive,
+ * so each list is read & folded once per languageID, and then shared (immutable after init).
+ * Lookups are then a hash table hit (full words) or a binary search (prefixes).
+ */
+@interface BIP39WordIndex : NSObject
+
+- (instancetype)initWithWords:(NSArray<NSString*> *)words locale:(NSLocale *)locale;
+
+@property (nonatomic, readonly) NSArray<NSString*> *words;
+
+- (NSString *)foldedString:(NSString *)str;
+
+/** Exact (literal) match. Returns NSNotFound if missing. */
+- (NSUInteger)indexOfWord:(NSString *)word;
+
+/** Match against the folded words. Returns the first matching index, or NSNotFound. */
+- (NSUInteger)indexOfFoldedWord:(NSString *)folded;
+
+/** Returns the first index (in list order) whose folded word has the given prefix, or NSNotFound. */
+- (NSUInteger)indexOfFirstFoldedWordWithPrefix:(NSString *)prefix;
+
+@end
+
+@implementation BIP39WordIndex {
+	
+	NSLocale *locale;
+	NSArray<NSString*> *foldedWords;
+	NSDictionary<NSString*, NSNumber*> *exactTable;   // word -> index
+	NSDictionary<NSString*, NSNumber*> *foldedTable;  // precomposed folded word -> index
+	
+	uint16_t *sortedIndexes; // indexes, sorted (literally) by folded word
+}
+
+@synthesize words = words;
+
+- (instancetype)initWithWords:(NSArray<NSString*> *)inWords locale:(NSLocale *)inLocale
+{
+	if ((self = [super init]))
+	{
+		words = [inWords copy];
+		locale = inLocale;
+		
+		NSUInteger count = words.count;
+		
+		NSMutableArray<NSString*> *folded = [NSMutableArray arrayWithCapacity:count];
+		NSMutableDictionary<NSString*, NSNumber*> *exact = [NSMutableDictionary dictionaryWithCapacity:count];
+		NSMutableDictionary<NSString*, NSNumber*> *foldedKeys = [NSMutableDictionary dictionaryWithCapacity:count];
+		
+		[words enumerateObjectsUsingBlock:^(NSString *word, NSUInteger idx, BOOL *stop) {
+			
+			NSString *foldedWord = [self foldedString:word];
+			[folded addObject:foldedWord];
+			
+			// First occurrence wins, matching the old linear scans.
+			
+			if (exact[word] == nil) {
+				exact[word] = @(idx);
+			}
+			
+			NSString *key = foldedWord.precomposedStringWithCanonicalMapping;
+			if (foldedKeys[key] == nil) {
+				foldedKeys[key] = @(idx);
+			}
+		}];
+		
+		foldedWords = [folded copy];
+		exactTable = [exact copy];
+		foldedTable = [foldedKeys copy];
+		
+		sortedIndexes = malloc(sizeof(uint16_t) * MAX(count, 1));
+		for (NSUInteger i = 0; i < count; i++) {
+			sortedIndexes[i] = (uint16_t)i;
+		}
+		
+		NSArray<NSString*> *sortKeys = foldedWords;
+		qsort_b(sortedIndexes, count, sizeof(uint16_t), ^int(const void *a, const void *b) {
+			
+			uint16_t idxA = *(const uint16_t *)a;
+			uint16_t idxB = *(const uint16_t *)b;
+			
+			NSComparisonResult result = [sortKeys[idxA] compare:sortKeys[idxB] options:NSLiteralSearch];
+			if (result == NSOrderedSame) {
+				return (idxA < idxB) ? -1 : 1;
+			}
+			return (result == NSOrderedAscending) ? -1 : 1;
+		});
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	free(sortedIndexes);
+}
+
+- (NSString *)foldedString:(NSString *)str
+{
+	return [str stringByFoldingWithOptions:(NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch)
+	                                locale:locale];
 }
 
-//
-//- (NSString *)sanitizeStringWithLocaleIdentifier:(NSString*)localeIdentifier
-//{
-//	localeIdentifier = [localeIdentifier stringByReplacingOccurrencesOfString:@"-" withString:@"_"];
-//
-//	NSLocale *usLocale = [[NSLocale alloc] initWithLocaleIdentifier:localeIdentifier];
-//
-//	// Replace accents, umlauts etc with equivalent letter i.e 'é' becomes 'e'.
-//	// Always use en_GB (or a locale without the characters you wish to strip) as locale,
-//	// no matter which language we're taking as input.
-//	NSString *processedString = [self stringByFoldingWithOptions: NSDiacriticInsensitiveSearch locale: usLocale];
-//
-//	// remove non-letters
-//	processedString = [[processedString componentsSeparatedByCharactersInSet:[[NSCharacterSet letterCharacterSet] invertedSet]] componentsJoinedByString:@""];
-//
-//	// trim whitespace
-//	processedString = [processedString stringByTrimmingCharactersInSet: [NSCharacterSet whitespaceCharacterSet]];
-//	return processedString;
-//}
+- (NSUInteger)indexOfWord:(NSString *)word
+{
+	NSNumber *index = word ? exactTable[word] : nil;
+	return index ? index.unsignedIntegerValue : NSNotFound;
+}
+
+- (NSUInteger)indexOfFoldedWord:(NSString *)folded
+{
+	NSNumber *index = foldedTable[folded.precomposedStringWithCanonicalMapping];
+	if (index) {
+		return index.unsignedIntegerValue;
+	}
+	
+	// Not in the table.
+	// Fall back to the (slower) localized comparison,
+	// so we accept exactly what we used to accept.
+	// This only runs for words that are (almost certainly) invalid.
+	
+	return [foldedWords indexOfObjectPassingTest:^BOOL(NSString *test, NSUInteger idx, BOOL *stop) {
+		
+		return ([test localizedCaseInsensitiveCompare:folded] == NSOrderedSame);
+	}];
+}
+
+- (NSUInteger)indexOfFirstFoldedWordWithPrefix:(NSString *)prefix
+{
+	NSUInteger count = foldedWords.count;
+	
+	// Binary search for the first (sorted) folded word >= prefix.
+	// All words with the prefix are contiguous from there.
+	
+	NSUInteger lo = 0;
+	NSUInteger hi = count;
+	while (lo < hi)
+	{
+		NSUInteger mid = lo + ((hi - lo) / 2);
+		NSString *candidate = foldedWords[sortedIndexes[mid]];
+		
+		if ([candidate compare:prefix options:NSLiteralSearch] == NSOrderedAscending)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	
+	// Multiple words may share the prefix.
+	// Return whichever comes first in the list (not in sorted order).
+	
+	NSUInteger result = NSNotFound;
+	for (NSUInteger i = lo; i < count; i++)
+	{
+		NSUInteger idx = sortedIndexes[i];
+		if (![foldedWords[idx] hasPrefix:prefix]) {
+			break;
+		}
+		
+		if (result == NSNotFound || idx < result) {
+			result = idx;
+		}
+	}
+	
+	return result;
+}
 
 @end
 
+#pragma mark -
 
 @implementation BIP39Mnemonic
 
@@ -140,8 +314,8 @@
 	return url;
 }
 
-+(nullable NSArray<NSString*> *) wordListForLanguageID:(NSString* _Nullable)languageID
-											 error:(NSError *_Nullable *_Nullable)errorOut
++ (nullable NSArray<NSString*> *)loadWordListForLanguageID:(NSString* _Nullable)languageID
+                                                      error:(NSError *_Nullable *_Nullable)errorOut
 {
 	NSError * error = nil;
 
@@ -166,6 +340,7 @@
 	if (wordTable.count != 2048) {
 		NSString *msg = @"Invalid language file - must contain at least 2048 words";
 		error = [self errorWithDescription:msg];
+		wordTable = nil;
 		goto done;
 	}
 
@@ -176,14 +351,89 @@ done:
 	return wordTable;
 }
 
+/**
+ * Returns the (cached) word index for the given language.
+ * The first request for a language reads & folds the word list. Subsequent requests are a dictionary lookup.
+ */
++ (nullable BIP39WordIndex *)wordIndexForLanguageID:(NSString* _Nullable)languageID
+                                              error:(NSError *_Nullable *_Nullable)errorOut
+{
+	static YAPUnfairLock lock = YAP_UNFAIR_LOCK_INIT;
+	static NSMutableDictionary<NSString*, BIP39WordIndex*> *cache = nil;
+
+	NSString *identifier = languageID;
+	if (!identifier) {
+		identifier = [self languageIDForLocaleIdentifier:[NSLocale currentLocale].localeIdentifier];
+	}
+
+	BIP39WordIndex *wordIndex = nil;
+	if (identifier)
+	{
+		YAPUnfairLockLock(&lock);
+		{
+			wordIndex = cache[identifier];
+		}
+		YAPUnfairLockUnlock(&lock);
+
+		if (wordIndex)
+		{
+			if (errorOut) *errorOut = nil;
+			return wordIndex;
+		}
+	}
+
+	NSError *error = nil;
+	NSArray<NSString*> *words = [self loadWordListForLanguageID:identifier error:&error];
+
+	if (words)
+	{
+		NSLocale *locale = identifier ? [NSLocale localeWithLocaleIdentifier:identifier] : nil;
+		wordIndex = [[BIP39WordIndex alloc] initWithWords:words locale:locale];
+
+		if (identifier)
+		{
+			YAPUnfairLockLock(&lock);
+			{
+				// Another thread may have beaten us to it. Either index is fine, but only keep one.
+				BIP39WordIndex *existing = cache[identifier];
+				if (existing)
+				{
+					wordIndex = existing;
+				}
+				else
+				{
+					if (cache == nil) {
+						cache = [[NSMutableDictionary alloc] init];
+					}
+					cache[identifier] = wordIndex;
+				}
+			}
+			YAPUnfairLockUnlock(&lock);
+		}
+	}
+
+	if (errorOut) *errorOut = error;
+	return wordIndex;
+}
+
++(nullable NSArray<NSString*> *) wordListForLanguageID:(NSString* _Nullable)languageID
+											 error:(NSError *_Nullable *_Nullable)errorOut
+{
+	NSError *error = nil;
+	BIP39WordIndex *wordIndex = [self wordIndexForLanguageID:languageID error:&error];
+
+	if (errorOut) *errorOut = error;
+	return wordIndex.words;
+}
+
 + (nullable NSString *)matchingMnemonicForString:(NSString*)word
 									  languageID:(NSString* _Nullable)languageID
 										   error:(NSError *_Nullable *_Nullable)errorOut
 {
 	NSLocale* matchingLocale = [NSLocale localeWithLocaleIdentifier:languageID];
-	NSArray<NSString*> *wordTable = nil;
+	BIP39WordIndex *wordIndex = nil;
 
-	__block NSString* mnemonic = NULL;
+	NSString* mnemonic = NULL;
 	NSError * error = nil;
  
 	if(!matchingLocale)
@@ -193,31 +443,22 @@ done:
 		goto done;
 	}
 
-	wordTable = [self wordListForLanguageID:languageID error:&error];
+	wordIndex = [self wordIndexForLanguageID:languageID error:&error];
 	if (error) {
 		goto done;
 	}
 
-	if([wordTable containsObject:word])
+	if([wordIndex indexOfWord:word] != NSNotFound)
 		mnemonic = word;
 	else if(word.length > 3)
 	{
-		NSString *normalized = [word stringByFoldingWithOptions: NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch
-														 locale: matchingLocale];
-
+		NSString *normalized = [wordIndex foldedString:word];
 
-		[wordTable enumerateObjectsUsingBlock:^(NSString * entry, NSUInteger idx, BOOL * _Nonnull stop) {
-
-			NSString* test  = [entry stringByFoldingWithOptions:
-							   (NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch)
-														 locale: matchingLocale];
-
-			if([test hasPrefix:normalized])
-			{
-				mnemonic = entry;
-				*stop = YES;
-			}
-		}];
+		NSUInteger index = [wordIndex indexOfFirstFoldedWordWithPrefix:normalized];
+		if (index != NSNotFound)
+		{
+			mnemonic = wordIndex.words[index];
+		}
 	}
 
 done:
@@ -315,14 +556,11 @@ done:
 
 	NSLocale* matchingLocale = [NSLocale localeWithLocaleIdentifier:languageID];
 
-	uint8_t dataBytes[33] = {0};  // key + checksum; 33 bytes == 264 bits
+	uint8_t dataBytes[kBIP39PackedBufferSize] = {0};  // key + checksum; 33 bytes == 264 bits (+ padding)
 	uint8_t hashBuf[32] = {0};
 
-	NSArray<NSString*> *wordTable = nil;
-	NSMutableString *bitString = nil;
-	NSString *checksumBits_calc = nil;
-	NSString *checksumBits_input = nil;
-
+	BIP39WordIndex *wordIndex = nil;
+	NSUInteger bitOffset = 0;
 
 	if(!matchingLocale)
 	{
@@ -357,39 +595,23 @@ done:
 		goto done;
 	}
 
-	wordTable = [self wordListForLanguageID:languageID error:&error];
+	wordIndex = [self wordIndexForLanguageID:languageID error:&error];
 	if (error) {
 		goto done;
 	}
 
-	bitString = [NSMutableString stringWithCapacity:264];
+	// Pack the 11-bit word indexes directly into the byte buffer (big-endian bit order)
 
 	for (NSString *word in mnemonic)
 	{
-		NSString *normalized = [word stringByFoldingWithOptions: NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch
-														 locale: matchingLocale];
-
-		NSUInteger index = [wordTable indexOfObjectPassingTest:
-							^BOOL(NSString *entry, NSUInteger idx, BOOL *stop)
-							{
-								NSString* test  = [entry stringByFoldingWithOptions:
-												   (NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch)
-																			 locale: matchingLocale];
-
-								if([test localizedCaseInsensitiveCompare:normalized] == NSOrderedSame)
-								{
-									*stop = YES;
-									return YES;
-								}
-
-								return NO;
-							}];
+		NSString *normalized = [wordIndex foldedString:word];
+		NSUInteger index = [wordIndex indexOfFoldedWord:normalized];
 
 		// if we didnt find an index then we have bad mnemonic word
 		ASSERTERR(index != NSNotFound, kS4Err_BadParams);
 
-		NSString *bits = [NSString binaryStringRepresentationOfInt:index numberOfDigits:11];
-		[bitString appendString:bits];
+		BIP39WriteIndex(dataBytes, bitOffset, index);
+		bitOffset += 11;
 	}
 
 	// From BIP32:
@@ -416,14 +638,7 @@ done:
 		case 24 : ent = 256; cs = 8; break;
 	}
 
-	ASSERTERR(bitString.length == (ent + cs), kS4Err_BadParams);
-	// fill encrypted_key with decoded bytes from mnemonicArray offset - include checksum byte
-
-	for (int index = 0; index < ((ent + cs)/ 8); index++)
-	{
-		NSString *bits = [bitString substringWithRange:NSMakeRange(index*8,8)];
-		dataBytes[index] = strtol(bits.UTF8String, NULL, 2);
-	}
+	ASSERTERR(bitOffset == (ent + cs), kS4Err_BadParams);
 
 	// caclulate checksum
 	err = HASH_DO(
@@ -433,13 +648,7 @@ done:
 	CKERR;
 
 	// check for proper checksum
-	checksumBits_calc = [self bitArrayFromData:[NSData dataWithBytesNoCopy:hashBuf
-																	length:sizeof(hashBuf)
-															  freeWhenDone:NO]];
-	checksumBits_calc = [checksumBits_calc substringToIndex:cs];
-	checksumBits_input = [bitString substringFromIndex:ent];
-
-	if (![checksumBits_calc isEqualToString:checksumBits_input])
+	if (BIP39ChecksumBits(hashBuf, 0, cs) != BIP39ChecksumBits(dataBytes, ent, cs))
 	{
 		err = kS4Err_BadIntegrity;
 	}
@@ -466,7 +675,7 @@ done:
 	NSError * error = nil;
 	S4Err     err = kS4Err_NoErr;
 	NSMutableArray *words = nil;
-	NSArray<NSString*> *wordTable = nil;
+	BIP39WordIndex *wordIndex = nil;
 	uint8_t hashBuf[32] = {0};
 
 	if ((data.length % 4) != 0)
@@ -483,7 +692,7 @@ done:
 		goto done;
 	}
 
-	wordTable = [self wordListForLanguageID:languageID error:&error];
+	wordIndex = [self wordIndexForLanguageID:languageID error:&error];
 	if (error) {
 		goto done;
 	}
@@ -498,24 +707,19 @@ done:
  	{ // Scoping
 		words = [NSMutableArray arrayWithCapacity:24];
 
-		// Convert encypted key and checksum to bit array
-		NSString *bitString = [self bitArrayFromData:data];
-
-		NSString *checksumBits = [self bitArrayFromData:[NSData dataWithBytesNoCopy:hashBuf
-																		length:sizeof(hashBuf)
-																  freeWhenDone:NO]];
+		// Append the checksum bits to the keyData.
+		// The checksum is (ENT / 32) bits, which always fits within the first byte of the hash.
+		uint8_t dataBytes[kBIP39PackedBufferSize] = {0};
+		[data getBytes:dataBytes length:data.length];
+		dataBytes[data.length] = hashBuf[0];
 
-		// Append the checksum bits to the keyData
-		NSRange checksumRange = NSMakeRange(0, bitString.length / 32);
+		NSUInteger totalBits = (data.length * 8) + (data.length * 8 / 32);
 
-		bitString = [bitString stringByAppendingString:[checksumBits substringWithRange:checksumRange]];
-
-		for (int i = 0; i < (int)bitString.length / 11; i++)
+		for (NSUInteger bitOffset = 0; (bitOffset + 11) <= totalBits; bitOffset += 11)
 		{
-			NSString *bits = [bitString substringWithRange:NSMakeRange(i * 11, 11)];
-			NSUInteger wordNumber = strtol(bits.UTF8String, NULL, 2);
+			NSUInteger wordNumber = BIP39ReadIndex(dataBytes, bitOffset);
 
-			[words addObject:wordTable[wordNumber]];
+			[words addObject:wordIndex.words[wordNumber]];
 		}
 	}
 
@@ -563,8 +767,9 @@ done:
 	NSError * error = nil;
 	S4Err     err = kS4Err_NoErr;
 	uint8_t   unlocking_key[32] = {0};
+	uint8_t   packed[kBIP39PackedBufferSize] = {0};
 	
-	NSArray<NSString*> *wordTable = nil;
+	BIP39WordIndex *wordIndex = nil;
 
 	NSData *saltData = nil;
 	NSMutableData *encrypted_key = nil;
@@ -590,7 +795,7 @@ done:
 	}
 	passphrase = [passphrase decomposedStringWithCompatibilityMapping]; // Normalization Form KD
 
-	wordTable = [self wordListForLanguageID:languageID error:&error];
+	wordIndex = [self wordIndexForLanguageID:languageID error:&error];
 	if (error) {
 		goto done;
 	}
@@ -626,27 +831,25 @@ done:
 		
 		words = [NSMutableArray arrayWithCapacity:24];
 		
-		// Convert encypted key and checksum to bit array
-		NSString *bitString = [self bitArrayFromData:encrypted_key];
-		NSString *checksumBits = [self bitArrayFromData:hash];
+		// Append the checksum bits to the encrypted key.
+		// Note: the full (32 byte) encrypted_key buffer is always encoded, so the checksum is always 8 bits.
+		memcpy(packed, encrypted_key.bytes, encrypted_key.length);
+		packed[encrypted_key.length] = ((const uint8_t *)hash.bytes)[0];
 		
-		// Append the checksum bits to the keyData
-		NSRange checksumRange = NSMakeRange(0, bitString.length / 32);
+		NSUInteger totalBits = (encrypted_key.length * 8) + (encrypted_key.length * 8 / 32);
 		
-		bitString = [bitString stringByAppendingString:[checksumBits substringWithRange:checksumRange]];
-        
-		for (int i = 0; i < (int)bitString.length / 11; i++)
+		for (NSUInteger bitOffset = 0; (bitOffset + 11) <= totalBits; bitOffset += 11)
 		{
-			NSString *bits = [bitString substringWithRange:NSMakeRange(i * 11, 11)];
-			NSUInteger wordNumber = strtol(bits.UTF8String, NULL, 2);
+			NSUInteger wordNumber = BIP39ReadIndex(packed, bitOffset);
 			
-			[words addObject:wordTable[wordNumber]];
+			[words addObject:wordIndex.words[wordNumber]];
 		}
 	}
     
 done:
     
 	ZERO(unlocking_key, sizeof(unlocking_key));
+	ZERO(packed, sizeof(packed));
 	ZERO(encrypted_key.bytes, encrypted_key.length);
 	
 	if (IsS4Err(err)) {
@@ -692,14 +895,13 @@ done:
 	uint8_t unlocking_key[32] = {0};
 	uint8_t decrypted_key[32] = {0};
 	uint8_t hashBuf[32] = {0};
-	uint8_t encrypted_key[33] = {0};  // key + checksum; 33 bytes == 264 bits
+	uint8_t encrypted_key[kBIP39PackedBufferSize] = {0};  // key + checksum; 33 bytes == 264 bits (+ padding)
 	
-	NSArray<NSString*> *wordTable = nil;
+	BIP39WordIndex *wordIndex = nil;
 	
 	NSData *saltData = nil;
-	NSMutableString *bitString = nil;
-	NSString *checksumBits_calc = nil;
-	NSString *checksumBits_input = nil;
+	NSUInteger bitOffset = 0;
+	uint8_t checksum_input = 0;
 	NSData *result = nil;
 
 	if(!matchingLocale)
@@ -739,42 +941,25 @@ done:
 		goto done;
 	}
 
-	wordTable = [self wordListForLanguageID:languageID error:&error];
+	wordIndex = [self wordIndexForLanguageID:languageID error:&error];
 	if (error) {
 		goto done;
 	}
 
 	saltData = [[@"mnemonic" stringByAppendingString:passphrase] dataUsingEncoding:NSUTF8StringEncoding];
     
-	// search the wordlist for a words that matches the first four chars
-	bitString = [NSMutableString stringWithCapacity:264];
+	// Pack the 11-bit word indexes directly into encrypted_key (big-endian bit order)
 
 	for (NSString *word in mnemonic)
 	{
-		NSString *normalized = [word stringByFoldingWithOptions: NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch
-														 locale: matchingLocale];
-
-		NSUInteger index = [wordTable indexOfObjectPassingTest:
-							^BOOL(NSString *entry, NSUInteger idx, BOOL *stop)
-							{
-								NSString* test  = [entry stringByFoldingWithOptions:
-												   (NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch)
-																			 locale: matchingLocale];
-
-								if([test localizedCaseInsensitiveCompare:normalized] == NSOrderedSame)
-								{
-									*stop = YES;
-									return YES;
-								}
-
-								return NO;
-							}];
+		NSString *normalized = [wordIndex foldedString:word];
+		NSUInteger index = [wordIndex indexOfFoldedWord:normalized];
 
 		// if we didnt find an index then we have bad mnemonic word
 		ASSERTERR(index != NSNotFound, kS4Err_BadParams);
 
-		NSString *bits = [NSString binaryStringRepresentationOfInt:index numberOfDigits:11];
-		[bitString appendString:bits];
+		BIP39WriteIndex(encrypted_key, bitOffset, index);
+		bitOffset += 11;
 	}
 
 /*	for (NSString *word in mnemonic)
@@ -846,15 +1031,12 @@ done:
 		case 24 : ent = 256; cs = 8; break;
 	}
 	
-	ASSERTERR(bitString.length == (ent + cs), kS4Err_BadParams);
+	ASSERTERR(bitOffset == (ent + cs), kS4Err_BadParams);
 	
-	// fill encrypted_key with decoded bytes from mnemonicArray offset - include checksum byte
-    
-	for (int index = 0; index < ((ent + cs)/ 8); index++)
-	{
-		NSString *bits = [bitString substringWithRange:NSMakeRange(index*8,8)];
-		encrypted_key[index] = strtol(bits.UTF8String, NULL, 2);
-	}
+	// Pull out the checksum bits, and clear them from the buffer.
+	// Only the entropy bytes are fed to the cipher (the rest of the block must be zero).
+	checksum_input = BIP39ChecksumBits(encrypted_key, ent, cs);
+	ZERO(encrypted_key + (ent / 8), sizeof(encrypted_key) - (ent / 8));
 	
 	// calculate the unlocking key
 	err = PASS_TO_KEY(                                                // Create PBKDF2
@@ -880,13 +1062,7 @@ done:
 	CKERR;
 
 	// check for proper checksum
-	checksumBits_calc = [self bitArrayFromData:[NSData dataWithBytesNoCopy:hashBuf
-																	length:sizeof(hashBuf)
-															  		freeWhenDone:NO]];
-	checksumBits_calc = [checksumBits_calc substringToIndex:cs];
-	checksumBits_input = [bitString substringFromIndex:ent];
-
-	if (![checksumBits_calc isEqualToString:checksumBits_input])
+	if (BIP39ChecksumBits(hashBuf, 0, cs) != checksum_input)
 	{
 		err = kS4Err_BadIntegrity;
 	}
@@ -922,30 +1098,4 @@ done:
 	return [NSError errorWithDomain:domain code:0 userInfo:userInfo];
 }
 
-+ (NSString *)bitArrayFromData:(NSData *)data
-{
-	NSMutableString *bitString = [NSMutableString stringWithCapacity:(data.length * 4)];
-	
-	static const char *bit_rep[16] = {
-		[ 0] = "0000", [ 1] = "0001", [ 2] = "0010", [ 3] = "0011",
-		[ 4] = "0100", [ 5] = "0101", [ 6] = "0110", [ 7] = "0111",
-		[ 8] = "1000", [ 9] = "1001", [10] = "1010", [11] = "1011",
-		[12] = "1100", [13] = "1101", [14] = "1110", [15] = "1111",
-	};
-	
-	[data enumerateByteRangesUsingBlock:
-	  ^(const void *bytes, NSRange byteRange, BOOL *stop)
-	{
-		// To print raw byte values as hex
-		for (int i = 0; i < byteRange.length; ++i)
-		{
-			uint8_t byte =  ((uint8_t *)bytes)[i];
-			
-			[bitString appendFormat:@"%s%s", bit_rep[byte >> 4], bit_rep[byte & 0x0F]];
-		}
-	}];
-	
-	return bitString;
-}
-
 @end
@@ -0,0 +1,29 @@
+/**
+ * ZeroDark.cloud
+ *
+ * Homepage      : https://www.zerodark.cloud
+ * GitHub        : https://github.com/4th-ATechnologies/ZeroDark.cloud
+ * Documentation : https://zerodarkcloud.readthedocs.io/en/latest/
+ * API Reference : https://apis.zerodark.cloud
+**/
+
+#import "ZDCPasswordStrengthCalculator.h"
+
+@class BBDictionaryMatcher;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface ZDCPasswordStrengthCalculator ()
+
+/**
+ * Scores the password using the given dictionary matchers,
+ * instead of the ones loaded from the framework's frequency_lists.zdcdict.
+ *
+ * Used by the unit tests to compare the packed dictionaries against the original JSON lists.
+ */
++ (ZDCPasswordStrength *)strengthForPassword:(NSString *)password
+                          dictionaryMatchers:(NSArray<BBDictionaryMatcher *> *)matchers;
+
+@end
+
+NS_ASSUME_NONNULL_END
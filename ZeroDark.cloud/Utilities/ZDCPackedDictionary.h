@@ -0,0 +1,58 @@
+/**
+ * ZeroDark.cloud
+ *
+ * Homepage      : https://www.zerodark.cloud
+ * GitHub        : https://github.com/4th-ATechnologies/ZeroDark.cloud
+ * Documentation : https://zerodarkcloud.readthedocs.io/en/latest/
+ * API Reference : https://apis.zerodark.cloud
+**/
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * A read-only word => rank dictionary, backed by a memory-mapped file.
+ *
+ * The file is generated from frequency_lists.json by `Scripts/compile_frequency_lists.py` (and checked in).
+ * Words are stored sorted, so lookups are a binary search directly against the mapped bytes.
+ * Nothing is parsed or copied onto the heap, and pages are only faulted in as they're touched.
+ */
+@interface ZDCPackedDictionary : NSObject
+
+/**
+ * Maps the given file, and returns all the dictionaries it contains.
+ * Returns nil if the file is missing, or isn't a valid (supported) dictionary file.
+ */
++ (nullable NSArray<ZDCPackedDictionary *> *)dictionariesWithContentsOfURL:(NSURL *)url
+                                                                     error:(NSError *_Nullable *_Nullable)errorOut;
+
+/** The name of the dictionary (e.g. "english", "passwords") */
+@property (nonatomic, readonly) NSString *name;
+
+/** The number of words in the dictionary. */
+@property (nonatomic, readonly) NSUInteger count;
+
+/** The length (in UTF-8 bytes) of the longest word in the dictionary. */
+@property (nonatomic, readonly) NSUInteger maxWordLength;
+
+/**
+ * Returns the rank of the given word (1-based position within the original frequency list),
+ * or zero if the word isn't in the dictionary.
+ *
+ * @param bytes
+ *   UTF-8 encoded word (need not be NUL-terminated).
+ *
+ * @param length
+ *   The number of bytes.
+ */
+- (NSUInteger)rankOfWord:(const char *)bytes length:(NSUInteger)length;
+
+/**
+ * Convenience method.
+ */
+- (NSUInteger)rankOfWord:(NSString *)word;
+
+@end
+
+NS_ASSUME_NONNULL_END
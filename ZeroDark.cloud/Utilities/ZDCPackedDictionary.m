@@ -0,0 +1,204 @@
+/**
+ * ZeroDark.cloud
+ *
+ * Homepage      : https://www.zerodark.cloud
+ * GitHub        : https://github.com/4th-ATechnologies/ZeroDark.cloud
+ * Documentation : https://zerodarkcloud.readthedocs.io/en/latest/
+ * API Reference : https://apis.zerodark.cloud
+**/
+
+#import "ZDCPackedDictionary.h"
+
+/**
+ * See Scripts/compile_frequency_lists.py for a description of the file format.
+ */
+static const char kMagic[8] = { 'Z', 'D', 'C', 'D', 'I', 'C', 'T', '\0' };
+static const uint32_t kVersion = 1;
+
+static const NSUInteger kHeaderSize     = 16;
+static const NSUInteger kTableEntrySize = 24;
+
+static inline uint32_t ReadUInt32(const uint8_t *base, NSUInteger offset)
+{
+	uint32_t value;
+	memcpy(&value, base + offset, sizeof(value));
+	return CFSwapInt32LittleToHost(value);
+}
+
+static inline uint16_t ReadUInt16(const uint8_t *base, NSUInteger offset)
+{
+	uint16_t value;
+	memcpy(&value, base + offset, sizeof(value));
+	return CFSwapInt16LittleToHost(value);
+}
+
+@implementation ZDCPackedDictionary
+{
+	NSData *data; // memory-mapped
+	const uint8_t *bytes;
+	
+	NSUInteger indexOffset;
+	NSUInteger ranksOffset;
+}
+
+@synthesize name = name;
+@synthesize count = count;
+@synthesize maxWordLength = maxWordLength;
+
+/**
+ * See header file for description.
+ */
++ (nullable NSArray<ZDCPackedDictionary *> *)dictionariesWithContentsOfURL:(NSURL *)url
+                                                                     error:(NSError *_Nullable *_Nullable)errorOut
+{
+	NSError *error = nil;
+	NSData *data = [NSData dataWithContentsOfURL:url options:NSDataReadingMappedAlways error:&error];
+	
+	if (error)
+	{
+		if (errorOut) *errorOut = error;
+		return nil;
+	}
+	
+	const uint8_t *bytes = (const uint8_t *)data.bytes;
+	NSUInteger const length = data.length;
+	
+	if ((length < kHeaderSize) || (memcmp(bytes, kMagic, sizeof(kMagic)) != 0) || (ReadUInt32(bytes, 8) != kVersion))
+	{
+		if (errorOut) *errorOut = [self invalidFileError:@"Unrecognized file header."];
+		return nil;
+	}
+	
+	uint32_t const dictCount = ReadUInt32(bytes, 12);
+	
+	if (length < (kHeaderSize + ((uint64_t)dictCount * kTableEntrySize)))
+	{
+		if (errorOut) *errorOut = [self invalidFileError:@"File is truncated."];
+		return nil;
+	}
+	
+	NSMutableArray<ZDCPackedDictionary *> *dictionaries = [NSMutableArray arrayWithCapacity:dictCount];
+	
+	for (uint32_t i = 0; i < dictCount; i++)
+	{
+		NSUInteger const tableOffset = kHeaderSize + (i * kTableEntrySize);
+		
+		uint32_t const nameOffset    = ReadUInt32(bytes, tableOffset +  0);
+		uint32_t const nameLength    = ReadUInt32(bytes, tableOffset +  4);
+		uint32_t const wordCount     = ReadUInt32(bytes, tableOffset +  8);
+		uint32_t const maxLength     = ReadUInt32(bytes, tableOffset + 12);
+		uint32_t const indexOffset   = ReadUInt32(bytes, tableOffset + 16);
+		uint32_t const ranksOffset   = ReadUInt32(bytes, tableOffset + 20);
+		
+		// Sanity checks (we don't want a corrupt file to cause out-of-bounds reads)
+		
+		BOOL valid =
+		     ((uint64_t)nameOffset + nameLength <= length)
+		  && ((uint64_t)indexOffset + (((uint64_t)wordCount + 1) * sizeof(uint32_t)) <= length)
+		  && ((uint64_t)ranksOffset + ((uint64_t)wordCount * sizeof(uint16_t)) <= length);
+		
+		if (valid && (wordCount > 0))
+		{
+			uint32_t const firstWord = ReadUInt32(bytes, indexOffset);
+			uint32_t const sentinel = ReadUInt32(bytes, indexOffset + (wordCount * sizeof(uint32_t)));
+			
+			valid = (firstWord <= sentinel) && (sentinel <= length);
+		}
+		
+		NSString *dictName = nil;
+		if (valid)
+		{
+			dictName = [[NSString alloc] initWithBytes: bytes + nameOffset
+			                                    length: nameLength
+			                                  encoding: NSUTF8StringEncoding];
+		}
+		
+		if (dictName == nil)
+		{
+			if (errorOut) *errorOut = [self invalidFileError:@"Invalid dictionary table."];
+			return nil;
+		}
+		
+		ZDCPackedDictionary *dict = [[ZDCPackedDictionary alloc] init];
+		dict->data = data;
+		dict->bytes = bytes;
+		dict->name = dictName;
+		dict->count = wordCount;
+		dict->maxWordLength = maxLength;
+		dict->indexOffset = indexOffset;
+		dict->ranksOffset = ranksOffset;
+		
+		[dictionaries addObject:dict];
+	}
+	
+	if (errorOut) *errorOut = nil;
+	return dictionaries;
+}
+
++ (NSError *)invalidFileError:(NSString *)description
+{
+	NSDictionary *userInfo = @{ NSLocalizedDescriptionKey: description };
+	
+	NSString *domain = NSStringFromClass([self class]);
+	return [NSError errorWithDomain:domain code:1000 userInfo:userInfo];
+}
+
+/**
+ * See header file for description.
+ */
+- (NSUInteger)rankOfWord:(const char *)word length:(NSUInteger)wordLength
+{
+	if ((wordLength == 0) || (wordLength > maxWordLength)) {
+		return 0;
+	}
+	
+	NSUInteger low = 0;
+	NSUInteger high = count;
+	
+	while (low < high)
+	{
+		NSUInteger const mid = low + ((high - low) / 2);
+		
+		uint32_t const start = ReadUInt32(bytes, indexOffset + (mid * sizeof(uint32_t)));
+		uint32_t const end   = ReadUInt32(bytes, indexOffset + ((mid + 1) * sizeof(uint32_t)));
+		
+		NSUInteger const candidateLength = (end > start) ? (end - start - 1) : 0; // minus NUL terminator
+		
+		int cmp = memcmp(bytes + start, word, MIN(candidateLength, wordLength));
+		if (cmp == 0)
+		{
+			if (candidateLength < wordLength)
+				cmp = -1;
+			else if (candidateLength > wordLength)
+				cmp = 1;
+		}
+		
+		if (cmp == 0) {
+			return ReadUInt16(bytes, ranksOffset + (mid * sizeof(uint16_t)));
+		}
+		else if (cmp < 0) {
+			low = mid + 1;
+		}
+		else {
+			high = mid;
+		}
+	}
+	
+	return 0;
+}
+
+/**
+ * See header file for description.
+ */
+- (NSUInteger)rankOfWord:(NSString *)word
+{
+	const char *utf8 = [word UTF8String];
+	if (utf8 == NULL) return 0;
+	
+	// Don't use strlen: the word may contain embedded NUL characters.
+	NSUInteger utf8Length = [word lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+	
+	return [self rankOfWord:utf8 length:utf8Length];
+}
+
+@end
@@ -8,8 +8,10 @@
  **/
 
 #import "ZDCPasswordStrengthCalculator.h"
+#import "ZDCPasswordStrengthCalculatorPrivate.h"
 
 #import "ZDCLogging.h"
+#import "ZDCPackedDictionary.h"
 #import "ZeroDarkCloud.h"
 
 #import "BBEntropyCenter.h"
@@ -221,17 +223,30 @@ static NSDictionary *adjacencyGraphs = nil;
 	static dispatch_once_t onceToken;
 	dispatch_once(&onceToken, ^{
 		
+		// The precompiled (memory-mapped) dictionaries are generated from frequency_lists.json
+		// via Scripts/compile_frequency_lists.py, and avoid parsing ~1 MB of JSON into ~85,000 heap objects.
+		// Only the compiled file ships with the framework.
+		
 		NSMutableArray *matchers = [NSMutableArray array];
 		
-		NSString *jsonPath = [[ZeroDarkCloud frameworkBundle] pathForResource:@"frequency_lists" ofType:@"json"];
-		NSData *jsonData = [NSData dataWithContentsOfFile:jsonPath];
-		NSDictionary *dicts = (NSDictionary *)[NSJSONSerialization JSONObjectWithData:jsonData options:0 error:nil];
+		NSURL *packedURL = [[ZeroDarkCloud frameworkBundle] URLForResource:@"frequency_lists" withExtension:@"zdcdict"];
 		
-		for (NSString *dictName in dicts)
+		NSError *error = nil;
+		NSArray<ZDCPackedDictionary *> *dicts = nil;
+		
+		if (packedURL) {
+			dicts = [ZDCPackedDictionary dictionariesWithContentsOfURL:packedURL error:&error];
+		}
+		
+		if (dicts == nil)
 		{
-			NSArray *list = dicts[dictName];
+			// Without the dictionaries, the remaining matchers still produce a (more generous) score.
+			ZDCLogError(@"Unable to load frequency_lists.zdcdict: %@", error);
+		}
 			
-			BBDictionaryMatcher *matcher = [[BBDictionaryMatcher alloc] initWithDictionaryName:dictName andList:list];
+		for (ZDCPackedDictionary *dict in dicts)
+		{
+			BBDictionaryMatcher *matcher = [[BBDictionaryMatcher alloc] initWithPackedDictionary:dict];
 			if (matcher) {
 				[matchers addObject:matcher];
 			}
@@ -254,15 +269,15 @@ static NSDictionary *adjacencyGraphs = nil;
 	});
 }
 
-+ (NSArray *)match:(NSString *)password
++ (NSArray *)match:(NSString *)password dictionaryMatchers:(NSArray *)matchers
 {
 	NSMutableArray *result = [NSMutableArray array];
 	
-	for (BBDictionaryMatcher *matcher in dictionaryMatchers) {
+	for (BBDictionaryMatcher *matcher in matchers) {
 		[result addObjectsFromArray:[matcher match:password]];
 	}
 	
-	BBL33tMatcher *l33tMatcher = [[BBL33tMatcher alloc] initWithDictionaryMatchers:dictionaryMatchers];
+	BBL33tMatcher *l33tMatcher = [[BBL33tMatcher alloc] initWithDictionaryMatchers:matchers];
 	[result addObjectsFromArray:[l33tMatcher match:password]];
 	
 	BBSpatialMatcher *spatialMatcher = [[BBSpatialMatcher alloc] initWithAdjacencyGraphs:adjacencyGraphs];
@@ -286,12 +301,21 @@ static NSDictionary *adjacencyGraphs = nil;
 + (ZDCPasswordStrength*)strengthForPassword:(NSString*)password
 {
 	[self loadDictionaryMatchers];
+	
+	return [self strengthForPassword:password dictionaryMatchers:dictionaryMatchers];
+}
+
+/**
+ * See header file for description.
+ */
++ (ZDCPasswordStrength *)strengthForPassword:(NSString *)password dictionaryMatchers:(NSArray *)matchers
+{
 	[self loadAdjacencyGraphs];
 	
 	ZDCPasswordStrength *pws = [[ZDCPasswordStrength alloc] init];
 	pws.password = password;
 	
-	NSArray *matches = [self match:password];
+	NSArray *matches = [self match:password dictionaryMatchers:matchers];
 	[pws scoreMinimumEntropyWithMatches:matches];
 	
 	return pws;
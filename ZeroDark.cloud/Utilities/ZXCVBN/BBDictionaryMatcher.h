@@ -8,8 +8,14 @@
 
 #import "BBPatternMatcher.h"
 
+@class ZDCPackedDictionary;
+
 @interface BBDictionaryMatcher : NSObject <BBPatternMatcher>
 
 - (id)initWithDictionaryName:(NSString *)name andList:(NSArray *)list;
 
+// Performs lookups directly against the (memory-mapped) packed dictionary.
+// Produces exactly the same matches as a matcher created from the original list.
+- (id)initWithPackedDictionary:(ZDCPackedDictionary *)packedDictionary;
+
 @end
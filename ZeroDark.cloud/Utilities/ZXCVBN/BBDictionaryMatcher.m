@@ -9,11 +9,13 @@
 #import "BBDictionaryMatcher.h"
 
 #import "BBPattern.h"
+#import "ZDCPackedDictionary.h"
 
 @interface BBDictionaryMatcher ()
 
 @property (strong, nonatomic) NSString *name;
 @property (strong, nonatomic) NSDictionary *dictionary;
+@property (strong, nonatomic) ZDCPackedDictionary *packedDictionary;
 
 @end
 
@@ -35,7 +37,34 @@
     return self;
 }
 
+- (id)initWithPackedDictionary:(ZDCPackedDictionary *)packedDictionary {
+    self = [super init];
+    if (self) {
+        self.name = packedDictionary.name;
+        self.packedDictionary = packedDictionary;
+    }
+    return self;
+}
+    
+- (BBPattern *)patternForPassword:(NSString *)password word:(NSString *)word rank:(NSNumber *)rank from:(int)i to:(int)j {
+    BBPattern *pattern = [[BBPattern alloc] init];
+    pattern.type = BBPatternTypeDictionary;
+    pattern.begin = i;
+    pattern.end = j;
+    pattern.token = [password substringWithRange:NSMakeRange(i, j - i + 1)];
+    pattern.userInfo = [NSDictionary dictionaryWithObjectsAndKeys:
+                        word, BBDictionaryPatternUserInfoKeyMatchedWord,
+                        rank, BBDictionaryPatternUserInfoKeyRank,
+                        self.name, BBDictionaryPatternUserInfoKeyDictionaryName,
+                        nil];
+    return pattern;
+}
+
 - (NSArray *)match:(NSString *)password {
+    if (self.packedDictionary) {
+        return [self matchPacked:password];
+    }
+    
     NSMutableArray *result = [NSMutableArray array];
     NSUInteger length = password.length;
     NSString *lower = [password lowercaseString];
@@ -45,17 +74,55 @@
             NSString *word = [lower substringWithRange:NSMakeRange(i, j - i + 1)];
             NSNumber *rank = [self.dictionary objectForKey:word];
             if (rank) {
-                BBPattern *pattern = [[BBPattern alloc] init];
-                pattern.type = BBPatternTypeDictionary;
-                pattern.begin = i;
-                pattern.end = j;
-                pattern.token = [password substringWithRange:NSMakeRange(i, j - i + 1)];
-                pattern.userInfo = [NSDictionary dictionaryWithObjectsAndKeys:
-                                    word, BBDictionaryPatternUserInfoKeyMatchedWord,
-                                    rank, BBDictionaryPatternUserInfoKeyRank,
-                                    self.name, BBDictionaryPatternUserInfoKeyDictionaryName,
-                                    nil];
-                [result addObject:pattern];
+                [result addObject:[self patternForPassword:password word:word rank:rank from:i to:j]];
+            }
+        }
+    }
+    
+    return result;
+}
+
+// Same algorithm as above, but without allocating a string for every substring.
+// For ASCII passwords (the common case) the lookups run directly against the lowercased bytes.
+- (NSArray *)matchPacked:(NSString *)password {
+    NSMutableArray *result = [NSMutableArray array];
+    NSUInteger length = password.length;
+    NSString *lower = [password lowercaseString];
+    
+    ZDCPackedDictionary *packed = self.packedDictionary;
+    NSUInteger maxWordLength = packed.maxWordLength;
+    
+    const char *ascii = NULL;
+    if (lower.length == length && [lower canBeConvertedToEncoding:NSASCIIStringEncoding]) {
+        ascii = [lower cStringUsingEncoding:NSASCIIStringEncoding];
+    }
+    
+    for (int i = 0; i < length; i++) {
+        for (int j = i; j < length; j++) {
+            NSUInteger wordLength = j - i + 1;
+            
+            // The UTF-8 length of a substring is never less than its UTF-16 length.
+            // So anything longer than the longest word can't possibly match.
+            if (wordLength > maxWordLength) {
+                break;
+            }
+            
+            NSUInteger rank;
+            NSString *word = nil;
+            
+            if (ascii) {
+                rank = [packed rankOfWord:(ascii + i) length:wordLength];
+            } else {
+                word = [lower substringWithRange:NSMakeRange(i, wordLength)];
+                rank = [packed rankOfWord:word];
+            }
+            
+            if (rank) {
+                if (word == nil) {
+                    word = [lower substringWithRange:NSMakeRange(i, wordLength)];
+                }
+                NSNumber *rankNumber = [NSNumber numberWithInt:(int)rank];
+                [result addObject:[self patternForPassword:password word:word rank:rankNumber from:i to:j]];
             }
         }
     }
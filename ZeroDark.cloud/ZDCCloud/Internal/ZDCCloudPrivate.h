@@ -37,9 +37,15 @@
  * @param treeID
  *   The treeID from which the stored push operations were created.
  *   Cross application operations are allowed.
+ *
+ * @param compactSerialization
+ *   If YES, operations are written using the compact binary format (see ZDCCompactCoder).
+ *   Otherwise they're written using NSKeyedArchiver. Either format is always readable.
+ *   This comes from `-[ZDCDatabaseConfig compactSerialization]`.
  */
 - (instancetype)initWithLocalUserID:(NSString *)localUserID
-                             treeID:(NSString *)treeID;
+                             treeID:(NSString *)treeID
+               compactSerialization:(BOOL)compactSerialization;
 
 @end
 
@@ -36,6 +36,15 @@
 
 @property (nonatomic, copy, readwrite) NSSet<NSUUID *> *duplicateOpUUIDs;
 
+/**
+ * Parts (zero-based) that are unchanged since the previous upload of the node's data.
+ * These are copied server-side from the existing cloud file (with the given eTag), rather than uploaded.
+ *
+ * See ZDCCloudDataManifest for more information.
+ */
+@property (nonatomic, copy, readwrite) NSIndexSet *copyParts;
+@property (nonatomic, copy, readwrite) NSString *copySourceETag;
+
 @property (nonatomic, assign, readwrite) BOOL needsAbort;
 @property (nonatomic, assign, readwrite) BOOL needsSkip;
 
@@ -27,6 +27,8 @@ static NSString *const k_chunkSize        = @"chunkSize";
 static NSString *const k_checksums        = @"checksums";
 static NSString *const k_eTags            = @"eTags";
 static NSString *const k_duplicateOpUUIDs = @"duplicateOpUUIDs";
+static NSString *const k_copyParts        = @"copyParts";
+static NSString *const k_copySourceETag   = @"copySourceETag";
 static NSString *const k_needsAbort       = @"needsAbort";
 static NSString *const k_needsSkip        = @"needsSkip";
 
@@ -48,6 +50,9 @@ static NSString *const k_needsSkip        = @"needsSkip";
 
 @synthesize duplicateOpUUIDs = duplicateOpUUIDs;
 
+@synthesize copyParts = copyParts;
+@synthesize copySourceETag = copySourceETag;
+
 @synthesize needsAbort = needsAbort;
 @synthesize needsSkip = needsSkip;
 
@@ -72,6 +77,9 @@ static NSString *const k_needsSkip        = @"needsSkip";
 		
 		duplicateOpUUIDs= [decoder decodeObjectForKey:k_duplicateOpUUIDs];
 		
+		copyParts = [decoder decodeObjectForKey:k_copyParts];
+		copySourceETag = [decoder decodeObjectForKey:k_copySourceETag];
+		
 		needsAbort = [decoder decodeBoolForKey:k_needsAbort];
 		needsSkip = [decoder decodeBoolForKey:k_needsSkip];
 	}
@@ -99,6 +107,9 @@ static NSString *const k_needsSkip        = @"needsSkip";
 	
 	[coder encodeObject:duplicateOpUUIDs forKey:k_duplicateOpUUIDs];
 	
+	[coder encodeObject:copyParts forKey:k_copyParts];
+	[coder encodeObject:copySourceETag forKey:k_copySourceETag];
+	
 	[coder encodeBool:needsAbort forKey:k_needsAbort];
 	[coder encodeBool:needsSkip forKey:k_needsSkip];
 }
@@ -122,6 +133,9 @@ static NSString *const k_needsSkip        = @"needsSkip";
 	
 	copy->duplicateOpUUIDs = duplicateOpUUIDs;
 	
+	copy->copyParts = copyParts;
+	copy->copySourceETag = copySourceETag;
+	
 	copy->needsAbort = needsAbort;
 	copy->needsSkip = needsSkip;
 	
@@ -154,6 +168,9 @@ static NSString *const k_needsSkip        = @"needsSkip";
 	
 	if (!YDB_IsEqualOrBothNil(duplicateOpUUIDs, another->duplicateOpUUIDs)) return NO;
 	
+	if (!YDB_IsEqualOrBothNil(copyParts, another->copyParts)) return NO;
+	if (!YDB_IsEqualOrBothNil(copySourceETag, another->copySourceETag)) return NO;
+	
 	if (needsAbort != another->needsAbort) return NO;
 	if (needsSkip != another->needsSkip) return NO;
 	
@@ -9,6 +9,7 @@
 
 #import "ZDCCloud.h"
 #import "ZDCCloudPrivate.h"
+#import "ZDCCompactCoder.h"
 
 
 @implementation ZDCCloud
@@ -18,6 +19,7 @@
 
 - (instancetype)initWithLocalUserID:(NSString *)inLocalUserID
                              treeID:(NSString *)inTreeID
+               compactSerialization:(BOOL)compactSerialization
 {
 	NSParameterAssert(inLocalUserID != nil);
 	NSParameterAssert(inTreeID != nil);
@@ -31,6 +33,29 @@
 	{
 		localUserID = [inLocalUserID copy];
 		treeID = [inTreeID copy];
+		
+		// Operations are optionally stored using the compact binary format (same as nodes).
+		// Either format is always read, regardless of the setting.
+		
+		[self setOperationSerializer:^NSData *(YapDatabaseCloudCoreOperation *operation) {
+			
+			NSData *data = nil;
+			if (compactSerialization) {
+				data = [ZDCCompactCoder archivedDataWithRootObject:operation];
+			}
+			if (data == nil) {
+				data = [NSKeyedArchiver archivedDataWithRootObject:operation];
+			}
+			
+			return data;
+			
+		} deserializer:^YapDatabaseCloudCoreOperation *(NSData *data) {
+			
+			if ([ZDCCompactCoder isCompactData:data])
+				return [ZDCCompactCoder unarchiveObjectWithData:data];
+			else
+				return [NSKeyedUnarchiver unarchiveObjectWithData:data];
+		}];
 	}
 	return self;
 }
@@ -303,9 +303,25 @@ NS_ASSUME_NONNULL_BEGIN
  * If you don't configure your own log handler, then a default handler is used, which:
  * - only logs errors & warnings
  * - uses os_log
+ *
+ * Log messages are formatted & delivered asynchronously, on a serial background queue.
+ * If the log buffer is full, logging an error or warning blocks the calling thread
+ * until the queued messages have been delivered. So your handler shouldn't synchronously wait on other threads.
  */
 + (void)setLogHandler:(void (^)(ZDCLogMessage *))logHandler;
 
+/**
+ * Log messages are delivered asynchronously.
+ * This method blocks until all pending log messages have been delivered to the log handler.
+ *
+ * Invoke this before your app terminates (or from a crash handler),
+ * if you need to ensure the most recent log messages have been captured.
+ *
+ * If invoked from within the log handler, this method returns immediately
+ * (the remaining messages are delivered once the handler returns).
+ */
++ (void)flushLogs;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -58,6 +58,7 @@ typedef void (^ZDCLogHandler)(ZDCLogMessage *);
 
 @property (nonatomic, readwrite, strong) NSURL *databasePath;
 @property (nonatomic, readwrite, copy) NSString *primaryTreeID;
+@property (nonatomic, readwrite, assign) ZDCCloudFileCompression cloudFileCompression;
 
 @property (nonatomic, readwrite, strong) AFNetworkReachabilityManager *reachability;
 
@@ -103,6 +104,7 @@ typedef void (^ZDCLogHandler)(ZDCLogMessage *);
 @synthesize delegate;
 @synthesize databasePath;
 @synthesize primaryTreeID;
+@synthesize cloudFileCompression;
 
 @dynamic isDatabaseUnlocked;
 
@@ -269,7 +271,20 @@ static YAPUnfairLock registrationLock = YAP_UNFAIR_LOCK_INIT;
 }
 
 /**
- * Used by the macros defined in ZDCLogging.h
+ * See header file for description.
+ * Or view the api's online (for both Swift & Objective-C):
+ * https://apis.zerodark.cloud/Classes/ZeroDarkCloud.html
+ */
++ (void)flushLogs
+{
+	ZDCLogFlush();
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+/**
+ * Deprecated - the macros defined in ZDCLogging.h now go through ZDCLogBuffer directly.
  */
 + (void)log:(ZDCLogLevel)level
        flag:(ZDCLogFlag)flag
@@ -278,23 +293,32 @@ static YAPUnfairLock registrationLock = YAP_UNFAIR_LOCK_INIT;
        line:(NSUInteger)line
      format:(NSString *)format, ...
 {
+	if (format == nil) return;
+	
 	va_list args;
-	if (format)
-	{
-		va_start(args, format);
-		NSString *message = [[NSString alloc] initWithFormat:format arguments:args];
-      va_end(args);
+	va_start(args, format);
+	NSString *message = [[NSString alloc] initWithFormat:format arguments:args];
+	va_end(args);
 		
-		ZDCLogMessage *logMessage =
-		  [[ZDCLogMessage alloc] initWithMessage: message
-		                                   level: level
-		                                    flag: flag
-		                                    file: [NSString stringWithFormat:@"%s", file]
-		                                function: [NSString stringWithFormat:@"%s", function]
-		                                    line: line];
+	ZDCLogMessage *logMessage =
+	  [[ZDCLogMessage alloc] initWithMessage: message
+	                                   level: level
+	                                    flag: flag
+	                                    file: [NSString stringWithUTF8String:file]
+	                                function: [NSString stringWithUTF8String:function]
+	                                    line: line];
 		
-		logHandler(logMessage);
-	}
+	ZDCLogEnqueueMessage(logMessage);
+}
+
+#pragma clang diagnostic pop
+
+/**
+ * Used by ZDCLogBuffer (which backs the macros defined in ZDCLogging.h)
+ */
++ (void)logMessage:(ZDCLogMessage *)logMessage
+{
+	logHandler(logMessage);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -356,6 +380,7 @@ static YAPUnfairLock registrationLock = YAP_UNFAIR_LOCK_INIT;
 		self.delegate = inDelegate;
 		self.databasePath = dbPath;
 		self.primaryTreeID = config.primaryTreeID;
+		self.cloudFileCompression = config.cloudFileCompression;
 		
 		self->databaseKeyCtx = kInvalidS4KeyContextRef;
 		